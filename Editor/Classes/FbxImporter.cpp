@@ -673,6 +673,7 @@ void UHFbxImporter::CreateUHMeshes(FbxNode* InNode, std::filesystem::path InPath
 		NewMesh->SetUV0Data(MeshUV0);
 		NewMesh->SetNormalData(MeshNormal);
 		NewMesh->SetTangentData(MeshTangent);
+		NewMesh->Optimize();
 
 		// at last, try to import material as well
 		UniquePtr<UHMaterial> NewMat = ImportMaterial(InNode, InTextureRefPath);
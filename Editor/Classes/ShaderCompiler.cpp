@@ -0,0 +1,188 @@
+#include "ShaderCompiler.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/Utility.h"
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+// bump this when the compile options below change, so all shaders are compiled again
+static const std::string GDXCOptionRevision = "1";
+static const std::string GDXCPath = "ThirdParty/DirectXShaderCompiler/bin/x64/dxc.exe";
+
+// run a process and collect its stdout/stderr, returns false if the process can't be launched
+bool RunCompilerProcess(const std::string& InExePath, std::string InCommandLine, std::string& OutOutput, DWORD& OutExitCode)
+{
+	HANDLE Std_OUT_Rd = NULL;
+	HANDLE Std_OUT_Wr = NULL;
+
+	SECURITY_ATTRIBUTES SecurityAttr;
+	ZeroMemory(&SecurityAttr, sizeof(SecurityAttr));
+	SecurityAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
+	SecurityAttr.bInheritHandle = TRUE;
+	SecurityAttr.lpSecurityDescriptor = NULL;
+
+	// Create a pipe for the child process's STDOUT, and ensure the read handle to the pipe is not inherited.
+	if (!CreatePipe(&Std_OUT_Rd, &Std_OUT_Wr, &SecurityAttr, 0))
+	{
+		return false;
+	}
+	SetHandleInformation(Std_OUT_Rd, HANDLE_FLAG_INHERIT, 0);
+
+	// processes are launched from several threads, limit the inherited handles to this pipe only
+	// otherwise a child could inherit the pipe of another compilation and keep it open after that one finished
+	SIZE_T AttrListSize = 0;
+	InitializeProcThreadAttributeList(NULL, 1, 0, &AttrListSize);
+	std::vector<uint8_t> AttrListBuffer(AttrListSize);
+	LPPROC_THREAD_ATTRIBUTE_LIST AttrList = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(AttrListBuffer.data());
+	InitializeProcThreadAttributeList(AttrList, 1, 0, &AttrListSize);
+	UpdateProcThreadAttribute(AttrList, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &Std_OUT_Wr, sizeof(HANDLE), NULL, NULL);
+
+	STARTUPINFOEXA StartInfo;
+	ZeroMemory(&StartInfo, sizeof(StartInfo));
+	StartInfo.StartupInfo.cb = sizeof(StartInfo);
+	StartInfo.StartupInfo.hStdError = Std_OUT_Wr;
+	StartInfo.StartupInfo.hStdOutput = Std_OUT_Wr;
+	StartInfo.StartupInfo.dwFlags |= STARTF_USESTDHANDLES;
+	StartInfo.lpAttributeList = AttrList;
+
+	PROCESS_INFORMATION ProcInfo;
+	ZeroMemory(&ProcInfo, sizeof(ProcInfo));
+
+	const BOOL bLaunched = CreateProcessA(InExePath.c_str()
+		, const_cast<char*>(InCommandLine.c_str())
+		, NULL
+		, NULL
+		, TRUE
+		, CREATE_NO_WINDOW | EXTENDED_STARTUPINFO_PRESENT
+		, NULL
+		, NULL
+		, &StartInfo.StartupInfo
+		, &ProcInfo);
+	CloseHandle(Std_OUT_Wr);
+	DeleteProcThreadAttributeList(AttrList);
+
+	if (!bLaunched)
+	{
+		CloseHandle(Std_OUT_Rd);
+		return false;
+	}
+
+	// read until the child closes its end of the pipe
+	DWORD DwRead;
+	CHAR Buff[2048];
+	while (ReadFile(Std_OUT_Rd, Buff, sizeof(Buff), &DwRead, NULL) && DwRead > 0)
+	{
+		OutOutput.append(Buff, DwRead);
+	}
+
+	WaitForSingleObject(ProcInfo.hProcess, INFINITE);
+	GetExitCodeProcess(ProcInfo.hProcess, &OutExitCode);
+
+	// Close process and thread handles.
+	CloseHandle(ProcInfo.hProcess);
+	CloseHandle(ProcInfo.hThread);
+	CloseHandle(Std_OUT_Rd);
+
+	return true;
+}
+
+bool UHDXCShaderCompiler::Compile(const UHShaderCompileRequest& InRequest, std::string& OutLog)
+{
+	// compile HLSL shader by calling dxc.exe, which supports Vulkan spir-v
+	// dxc.exe -spirv -T <target-prfile> -E <entry-point> <hlsl - src - file> -Fo <spirv - bin - file>
+	// setup dx layout as well, be careful that the path must include "" mark in case there are folders with whitespace name
+	const std::string QuoteMark = "\"";
+	std::string CompileCmd = " -spirv -T " + InRequest.ProfileName + " -E " + InRequest.EntryName + " "
+		+ QuoteMark + std::filesystem::absolute(InRequest.SourcePath).string() + QuoteMark
+		+ " -Fo " + QuoteMark + std::filesystem::absolute(InRequest.OutputPath).string() + QuoteMark
+		+ " -HV 2018 "
+		+ " -fvk-use-dx-layout "
+		+ " -fvk-use-dx-position-w "
+		+ " -fspv-target-env=vulkan1.1spirv1.4 ";
+
+	// mesh shader extension
+	if (UHUtilities::StringFind(InRequest.ProfileName, "as_") || UHUtilities::StringFind(InRequest.ProfileName, "ms_"))
+	{
+		CompileCmd += " -fspv-extension=SPV_EXT_mesh_shader ";
+		CompileCmd += " -fspv-extension=SPV_EXT_descriptor_indexing ";
+	}
+
+	// add define command lines
+	for (const std::string& Define : InRequest.Defines)
+	{
+		CompileCmd += " -D " + Define;
+	}
+
+	DWORD ExitCode = 1;
+	if (!RunCompilerProcess(GDXCPath, CompileCmd, OutLog, ExitCode))
+	{
+		OutLog += "Failed to launch " + GDXCPath + "\n";
+		return false;
+	}
+
+	return ExitCode == 0 && std::filesystem::exists(InRequest.OutputPath);
+}
+
+std::string UHDXCShaderCompiler::GetVersion()
+{
+	if (!Version.empty())
+	{
+		return Version;
+	}
+
+	// prefer the version reported by dxc, fall back to the executable's time stamp and size
+	std::string Output;
+	DWORD ExitCode = 1;
+	if (RunCompilerProcess(GDXCPath, " --version", Output, ExitCode) && ExitCode == 0 && !Output.empty())
+	{
+		Version = UHUtilities::RemoveChars(Output, "\r\n");
+	}
+	else if (std::filesystem::exists(GDXCPath))
+	{
+		Version = std::to_string(std::filesystem::last_write_time(GDXCPath).time_since_epoch().count())
+			+ "_" + std::to_string(std::filesystem::file_size(GDXCPath));
+	}
+	else
+	{
+		Version = "dxc";
+	}
+	Version += "_" + GDXCOptionRevision;
+
+	return Version;
+}
+
+UHStubShaderCompiler::UHStubShaderCompiler(uint32_t InCompileTimeMs)
+	: CompileTimeMs(InCompileTimeMs)
+{
+
+}
+
+bool UHStubShaderCompiler::Compile(const UHShaderCompileRequest& InRequest, std::string& OutLog)
+{
+	std::ifstream FileIn(InRequest.SourcePath, std::ios::in | std::ios::binary);
+	if (!FileIn.is_open())
+	{
+		OutLog = "Source " + InRequest.SourcePath.string() + " not found\n";
+		return false;
+	}
+	FileIn.close();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(CompileTimeMs));
+
+	std::ofstream FileOut(InRequest.OutputPath, std::ios::out | std::ios::binary);
+	FileOut << InRequest.SourcePath.string() << "\n" << InRequest.EntryName << "\n" << InRequest.ProfileName << "\n";
+	for (const std::string& Define : InRequest.Defines)
+	{
+		FileOut << Define << "\n";
+	}
+	FileOut.close();
+
+	return true;
+}
+
+std::string UHStubShaderCompiler::GetVersion()
+{
+	return "UHStubShaderCompiler_1";
+}
+#endif
\ No newline at end of file
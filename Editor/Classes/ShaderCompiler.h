@@ -0,0 +1,57 @@
+#pragma once
+#include "../../UnheardEngine.h"
+
+#if WITH_EDITOR
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// everything a compiler needs for building a shader, the source can also be a generated file
+struct UHShaderCompileRequest
+{
+	std::filesystem::path SourcePath;
+	std::filesystem::path OutputPath;
+	std::string EntryName;
+	std::string ProfileName;
+	std::vector<std::string> Defines;
+};
+
+// shader compiler interface, Compile is called from multiple compile workers at the same time
+class UHShaderCompiler
+{
+public:
+	virtual ~UHShaderCompiler() {}
+
+	// compile the request to its output path, compiler messages are returned in OutLog
+	virtual bool Compile(const UHShaderCompileRequest& InRequest, std::string& OutLog) = 0;
+
+	// version of the compiler and its options, it's a part of the cache key so upgrading the compiler invalidates the cache
+	// this is only called from the thread owning the importer
+	virtual std::string GetVersion() = 0;
+};
+
+// launches dxc.exe per shader, each compilation is a separate process so multiple shaders can be compiled concurrently
+class UHDXCShaderCompiler : public UHShaderCompiler
+{
+public:
+	virtual bool Compile(const UHShaderCompileRequest& InRequest, std::string& OutLog) override;
+	virtual std::string GetVersion() override;
+
+private:
+	std::string Version;
+};
+
+// doesn't compile anything but writes the request as the output after a simulated delay
+// it's for driving the shader cache and the compile workers without dxc
+class UHStubShaderCompiler : public UHShaderCompiler
+{
+public:
+	UHStubShaderCompiler(uint32_t InCompileTimeMs);
+
+	virtual bool Compile(const UHShaderCompileRequest& InRequest, std::string& OutLog) override;
+	virtual std::string GetVersion() override;
+
+private:
+	uint32_t CompileTimeMs;
+};
+#endif
\ No newline at end of file
@@ -6,307 +6,496 @@
 #include "../../Runtime/Classes/AssetPath.h"
 #include "../../Runtime/Classes/Material.h"
 #include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
-UHShaderImporter::UHShaderImporter()
+// bump this when the layout of the cache index changes
+static const uint32_t GShaderCacheVersion = 1;
+static const std::string GShaderCacheIndexName = "ShaderCacheIndex";
+static const std::string GShaderCompiledFolder = "Compiled/";
+
+void UHShaderCompileStats::Accumulate(const UHShaderCompileStats& InStats)
 {
-	ShaderIncludes.push_back("UHInputs.hlsli");
-	ShaderIncludes.push_back("UHCommon.hlsli");
-	ShaderIncludes.push_back("UHLightCommon.hlsli");
-	ShaderIncludes.push_back("UHMaterialCommon.hlsli");
-	ShaderIncludes.push_back("UHSphericalHamonricCommon.hlsli");
-	ShaderIncludes.push_back("RayTracing/UHRTCommon.hlsli");
-	ShaderIncludes.push_back("UHMeshShaderCommon.hlsli");
+	NumRequests += InStats.NumRequests;
+	NumHits += InStats.NumHits;
+	NumCompiled += InStats.NumCompiled;
+	NumFailed += InStats.NumFailed;
+	WallSeconds += InStats.WallSeconds;
 }
 
-void UHShaderImporter::LoadShaderCache()
+float UHShaderCompileStats::GetHitRate() const
+{
+	return (NumRequests > 0) ? static_cast<float>(NumHits) / NumRequests : 1.0f;
+}
+
+std::wstring UHShaderCompileStats::ToString() const
+{
+	return std::to_wstring(NumRequests) + L" requests, " + std::to_wstring(NumHits) + L" hits ("
+		+ UHUtilities::FloatToWString(GetHitRate() * 100.0f, 1) + L"%), " + std::to_wstring(NumCompiled) + L" compiled, "
+		+ std::to_wstring(NumFailed) + L" failed, wall time " + UHUtilities::FloatToWString(static_cast<float>(WallSeconds * 1000.0)) + L" ms";
+}
+
+std::string UHShaderIncludeGraph::ToNodeKey(const std::filesystem::path& InPath)
+{
+	// paths are case insensitive on Windows
+	return UHUtilities::ToLowerString(std::filesystem::absolute(InPath).lexically_normal().generic_string());
+}
+
+const UHShaderIncludeGraph::UHShaderFileNode& UHShaderIncludeGraph::RefreshNode(const std::string& InKey)
 {
-	if (!std::filesystem::exists(GRawShaderCachePath))
+	const std::filesystem::path FilePath(InKey);
+	std::error_code Error;
+	const int64_t LastWriteTime = std::filesystem::last_write_time(FilePath, Error).time_since_epoch().count();
+
+	const auto It = Nodes.find(InKey);
+	if (It != Nodes.end() && It->second.LastWriteTime == LastWriteTime)
 	{
-		std::filesystem::create_directories(GRawShaderCachePath);
+		return It->second;
 	}
 
-	// load every shader cache under the folder
-	for (std::filesystem::recursive_directory_iterator Idx(GRawShaderCachePath.c_str()), end; Idx != end; Idx++)
+	UHShaderFileNode Node;
+	Node.LastWriteTime = LastWriteTime;
+	Node.ContentHash = 0;
+
+	// a missing file is hashed as empty, its path is still a part of the includer's closure
+	std::ifstream FileIn(FilePath, std::ios::in | std::ios::binary);
+	if (FileIn.is_open())
 	{
-		if (std::filesystem::is_directory(Idx->path()) || !UHAssetPath::IsTheSameExtension(Idx->path(), GShaderAssetCacheExtension))
+		std::stringstream Buffer;
+		Buffer << FileIn.rdbuf();
+		const std::string Content = Buffer.str();
+		Node.ContentHash = std::hash<std::string>()(Content);
+
+		// collect #include "..." and #include <...>, the ones inside inactive #if blocks are collected as well
+		// which only makes the key more conservative
+		std::istringstream Lines(Content);
+		std::string Line;
+		while (std::getline(Lines, Line))
 		{
-			continue;
+			const size_t DirectivePos = Line.find_first_not_of(" \t");
+			if (DirectivePos == std::string::npos || Line.compare(DirectivePos, 8, "#include") != 0)
+			{
+				continue;
+			}
+
+			const size_t NameStart = Line.find_first_of("\"<", DirectivePos + 8);
+			if (NameStart == std::string::npos)
+			{
+				continue;
+			}
+
+			const size_t NameEnd = Line.find_first_of("\">", NameStart + 1);
+			if (NameEnd == std::string::npos)
+			{
+				continue;
+			}
+
+			// resolve relative to the including file first, then the working directory and the shader folder like dxc does
+			const std::string IncludeName = Line.substr(NameStart + 1, NameEnd - NameStart - 1);
+			const std::filesystem::path Candidates[] = { FilePath.parent_path() / IncludeName
+				, std::filesystem::path(IncludeName)
+				, std::filesystem::path(GRawShaderPath + IncludeName) };
+
+			std::filesystem::path IncludePath = Candidates[0];
+			for (const std::filesystem::path& Candidate : Candidates)
+			{
+				if (std::filesystem::exists(Candidate))
+				{
+					IncludePath = Candidate;
+					break;
+				}
+			}
+
+			Node.Includes.push_back(ToNodeKey(IncludePath));
 		}
+	}
 
-		std::ifstream FileIn(Idx->path().string().c_str(), std::ios::in | std::ios::binary);
+	Nodes[InKey] = Node;
+	return Nodes[InKey];
+}
 
-		// load cache
-		UHRawShaderAssetCache Cache;
+void UHShaderIncludeGraph::CollectClosure(const std::string& InKey, std::vector<std::string>& OutClosure, std::unordered_map<std::string, bool>& Visited)
+{
+	if (Visited[InKey])
+	{
+		return;
+	}
+	Visited[InKey] = true;
 
-		// load source path
-		std::string TempString;
-		UHUtilities::ReadStringData(FileIn, TempString);
-		Cache.SourcePath = TempString;
+	// copy the includes, refreshing other nodes could rehash the table
+	const std::vector<std::string> Includes = RefreshNode(InKey).Includes;
+	OutClosure.push_back(InKey);
 
-		// load last modified time of source
-		FileIn.read(reinterpret_cast<char*>(&Cache.SourcLastModifiedTime), sizeof(Cache.SourcLastModifiedTime));
+	for (const std::string& Include : Includes)
+	{
+		CollectClosure(Include, OutClosure, Visited);
+	}
+}
 
-		// load UHShaders path
-		UHUtilities::ReadStringData(FileIn, TempString);
-		Cache.UHShaderPath = TempString;
+size_t UHShaderIncludeGraph::GetClosureHash(const std::filesystem::path& InPath)
+{
+	std::vector<std::string> Closure;
+	std::unordered_map<std::string, bool> Visited;
+	CollectClosure(ToNodeKey(InPath), Closure, Visited);
 
-		// load entry name
-		UHUtilities::ReadStringData(FileIn, TempString);
-		Cache.EntryName = TempString;
+	// the closure is in a fixed depth-first order, so the same contents always give the same hash
+	size_t Hash = 0;
+	for (const std::string& Key : Closure)
+	{
+		UHUtilities::HashCombine(Hash, Nodes[Key].ContentHash);
+	}
 
-		// load profile name
-		UHUtilities::ReadStringData(FileIn, TempString);
-		Cache.ProfileName = TempString;
+	return Hash;
+}
 
-		// load shader defines
-		UHUtilities::ReadStringVectorData(FileIn, Cache.Defines);
+std::vector<std::string> UHShaderIncludeGraph::GetIncludeClosure(const std::filesystem::path& InPath)
+{
+	std::vector<std::string> Closure;
+	std::unordered_map<std::string, bool> Visited;
+	CollectClosure(ToNodeKey(InPath), Closure, Visited);
+	Closure.erase(Closure.begin());
+
+	return Closure;
+}
 
-		FileIn.close();
+UHShaderImporter::UHShaderImporter(UniquePtr<UHShaderCompiler> InCompiler, std::string InCachePath, int32_t InMaxConcurrentCompiles)
+	: Compiler(std::move(InCompiler))
+	, CachePath(InCachePath)
+	, MaxConcurrentCompiles(InMaxConcurrentCompiles)
+{
+	if (Compiler == nullptr)
+	{
+		Compiler = MakeUnique<UHDXCShaderCompiler>();
+	}
 
-		UHRawShadersCache.push_back(Cache);
+	if (MaxConcurrentCompiles <= 0)
+	{
+		MaxConcurrentCompiles = (std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
 	}
 }
 
-void WriteShaderCache(std::filesystem::path SourcePath, std::filesystem::path UHShaderPath, std::string EntryName, std::string ProfileName
-	, std::vector<std::string> Defines = std::vector<std::string>())
+void UHShaderImporter::LoadShaderCache()
 {
-	// find origin path and try to preserve file structure
-	std::string OriginSubpath = UHAssetPath::GetShaderOriginSubpath(SourcePath);
+	if (!std::filesystem::exists(CachePath + GShaderCompiledFolder))
+	{
+		std::filesystem::create_directories(CachePath + GShaderCompiledFolder);
+	}
 
-	// output shader cache with source file name + macro name
-	size_t MacroHash = UHUtilities::ShaderDefinesToHash(Defines);
-	std::string MacroHashName = (MacroHash != 0) ? "_" + std::to_string(MacroHash) : "";
-	std::string CacheName = SourcePath.stem().string();
+	std::ifstream FileIn(CachePath + GShaderCacheIndexName + GShaderAssetCacheExtension, std::ios::in | std::ios::binary);
+	if (!FileIn.is_open())
+	{
+		return;
+	}
 
-	if (!std::filesystem::exists(GRawShaderCachePath + OriginSubpath))
+	uint32_t Version = 0;
+	FileIn.read(reinterpret_cast<char*>(&Version), sizeof(Version));
+	if (Version != GShaderCacheVersion)
 	{
-		std::filesystem::create_directories(GRawShaderCachePath + OriginSubpath);
+		return;
 	}
 
-	std::ofstream FileOut(GRawShaderCachePath + OriginSubpath + CacheName + EntryName + MacroHashName + GShaderAssetCacheExtension, std::ios::out | std::ios::binary);
+	size_t NumRecords = 0;
+	FileIn.read(reinterpret_cast<char*>(&NumRecords), sizeof(NumRecords));
+
+	for (size_t Idx = 0; Idx < NumRecords && FileIn.good(); Idx++)
+	{
+		std::string RecordName;
+		std::string TempString;
+		UHRawShaderAssetCache Cache;
 
-	// get last modified time
-	int64_t SourcLastModifiedTime = std::filesystem::last_write_time(SourcePath).time_since_epoch().count();
+		UHUtilities::ReadStringData(FileIn, RecordName);
+		UHUtilities::ReadStringData(FileIn, TempString);
+		Cache.Request.SourcePath = TempString;
+		UHUtilities::ReadStringData(FileIn, TempString);
+		Cache.Request.OutputPath = TempString;
+		UHUtilities::ReadStringData(FileIn, Cache.Request.EntryName);
+		UHUtilities::ReadStringData(FileIn, Cache.Request.ProfileName);
+		UHUtilities::ReadStringVectorData(FileIn, Cache.Request.Defines);
+		FileIn.read(reinterpret_cast<char*>(&Cache.Key), sizeof(Cache.Key));
 
-	UHUtilities::WriteStringData(FileOut, SourcePath.string());
-	FileOut.write(reinterpret_cast<const char*>(&SourcLastModifiedTime), sizeof(SourcLastModifiedTime));
-	UHUtilities::WriteStringData(FileOut, UHShaderPath.string());
-	UHUtilities::WriteStringData(FileOut, EntryName);
-	UHUtilities::WriteStringData(FileOut, ProfileName);
-	UHUtilities::WriteStringVectorData(FileOut, Defines);
+		UHRawShadersCache[RecordName] = Cache;
+	}
 
-	FileOut.close();
+	FileIn.close();
 }
 
-void UHShaderImporter::WriteShaderIncludeCache()
+void UHShaderImporter::WriteShaderCache()
 {
-	if (!std::filesystem::exists(GRawShaderCachePath))
+	if (!std::filesystem::exists(CachePath))
 	{
-		std::filesystem::create_directories(GRawShaderCachePath);
+		std::filesystem::create_directories(CachePath);
 	}
 
-	// if shader includes are renamed, system will consider it's never cached and recompile every shaders.
-	for (const std::string& Include : ShaderIncludes)
+	std::ofstream FileOut(CachePath + GShaderCacheIndexName + GShaderAssetCacheExtension, std::ios::out | std::ios::binary);
+	FileOut.write(reinterpret_cast<const char*>(&GShaderCacheVersion), sizeof(GShaderCacheVersion));
+
+	const size_t NumRecords = UHRawShadersCache.size();
+	FileOut.write(reinterpret_cast<const char*>(&NumRecords), sizeof(NumRecords));
+
+	for (auto& Record : UHRawShadersCache)
 	{
-		std::filesystem::path Path = GRawShaderPath + Include;
-		WriteShaderCache(Path, "", "", "");
+		UHRawShaderAssetCache& Cache = Record.second;
+		UHUtilities::WriteStringData(FileOut, Record.first);
+		UHUtilities::WriteStringData(FileOut, Cache.Request.SourcePath.string());
+		UHUtilities::WriteStringData(FileOut, Cache.Request.OutputPath.string());
+		UHUtilities::WriteStringData(FileOut, Cache.Request.EntryName);
+		UHUtilities::WriteStringData(FileOut, Cache.Request.ProfileName);
+		UHUtilities::WriteStringVectorData(FileOut, Cache.Request.Defines);
+		FileOut.write(reinterpret_cast<const char*>(&Cache.Key), sizeof(Cache.Key));
 	}
+
+	FileOut.close();
 }
 
-bool UHShaderImporter::IsShaderIncludeCached()
+size_t UHShaderImporter::GetCacheKey(const UHShaderCompileRequest& InRequest)
 {
-	bool bIsCached = true;
-	for(const std::string& Include : ShaderIncludes)
+	// the output path isn't a part of the key, the same content compiled to another place is still a hit
+	size_t Key = IncludeGraph.GetClosureHash(InRequest.SourcePath);
+	UHUtilities::HashCombine(Key, InRequest.EntryName);
+	UHUtilities::HashCombine(Key, InRequest.ProfileName);
+	for (const std::string& Define : InRequest.Defines)
 	{
-		// mark if shader includes are changed
-		std::filesystem::path IncludeFilePath = GRawShaderPath + Include;
-		UHRawShaderAssetCache InCache{};
-		InCache.SourcePath = IncludeFilePath;
-		InCache.SourcLastModifiedTime = std::filesystem::last_write_time(IncludeFilePath).time_since_epoch().count();
-
-		bIsCached &= UHUtilities::FindByElement(UHRawShadersCache, InCache);
+		UHUtilities::HashCombine(Key, Define);
 	}
+	UHUtilities::HashCombine(Key, Compiler->GetVersion());
 
-	return bIsCached;
+	return Key;
 }
 
-bool UHShaderImporter::IsShaderCached(std::filesystem::path SourcePath, std::filesystem::path UHShaderPath, std::string EntryName, std::string ProfileName
-	, std::vector<std::string> Defines)
+std::filesystem::path UHShaderImporter::GetCompiledPath(size_t InKey) const
 {
-	if (!std::filesystem::exists(SourcePath))
-	{
-		return false;
-	}
-
-	UHRawShaderAssetCache InCache;
-	InCache.SourcePath = SourcePath;
-	InCache.UHShaderPath = UHShaderPath;
-	InCache.SourcLastModifiedTime = std::filesystem::last_write_time(SourcePath).time_since_epoch().count();
-	InCache.EntryName = EntryName;
-	InCache.ProfileName = ProfileName;
-	InCache.Defines = Defines;
+	std::stringstream KeyName;
+	KeyName << std::hex << std::setw(16) << std::setfill('0') << InKey;
+	return CachePath + GShaderCompiledFolder + KeyName.str() + GShaderAssetExtension;
+}
 
-	// the cache will also check the include files
-	return UHUtilities::FindByElement(UHRawShadersCache, InCache) && std::filesystem::exists(UHShaderPath) && IsShaderIncludeCached();
+std::string UHShaderImporter::GetTemplateRecordName(std::filesystem::path SourcePath, std::string EntryName, std::string ProfileName)
+{
+	return "Template:" + SourcePath.lexically_normal().generic_string() + ":" + EntryName + ":" + ProfileName;
 }
 
-bool UHShaderImporter::IsShaderTemplateCached(std::filesystem::path SourcePath, std::string EntryName, std::string ProfileName)
+UHShaderCompileStats UHShaderImporter::CompileShaders(const std::vector<UHShaderCompileRequest>& InRequests, bool bRemember)
 {
-	if (!std::filesystem::exists(SourcePath))
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	UHShaderCompileStats Stats;
+	Stats.NumRequests = static_cast<uint32_t>(InRequests.size());
+
+	struct UHPendingCompile
 	{
-		return false;
-	}
+		const UHShaderCompileRequest* Request;
+		size_t Key;
+		int32_t CompileIdx;
+		bool bSucceed;
+		std::string Log;
+	};
+
+	std::vector<UHPendingCompile> PendingCompiles;
+	std::vector<UHPendingCompile> DuplicateCompiles;
+	std::unordered_map<size_t, int32_t> PendingByKey;
+	bool bIsCacheChanged = false;
+
+	const auto RememberRequest = [this, bRemember, &bIsCacheChanged](const UHShaderCompileRequest& InRequest, size_t InKey)
+	{
+		if (!bRemember)
+		{
+			return;
+		}
 
-	// less info than regular shader
-	UHRawShaderAssetCache InCache{};
-	InCache.SourcePath = SourcePath;
-	InCache.SourcLastModifiedTime = std::filesystem::last_write_time(SourcePath).time_since_epoch().count();
-	InCache.EntryName = EntryName;
-	InCache.ProfileName = ProfileName;
+		UHRawShaderAssetCache& Cache = UHRawShadersCache[InRequest.OutputPath.lexically_normal().generic_string()];
+		if (Cache.Key != InKey || Cache.Request.SourcePath != InRequest.SourcePath)
+		{
+			Cache.Request = InRequest;
+			Cache.Key = InKey;
+			bIsCacheChanged = true;
+		}
+	};
 
-	return UHUtilities::FindByElement(UHRawShadersCache, InCache) && IsShaderIncludeCached();
-}
+	// look up the output record first, then the compiled shaders by key
+	for (const UHShaderCompileRequest& Request : InRequests)
+	{
+		const size_t Key = GetCacheKey(Request);
+		const auto Record = UHRawShadersCache.find(Request.OutputPath.lexically_normal().generic_string());
+		bool bIsHit = Record != UHRawShadersCache.end() && Record->second.Key == Key && std::filesystem::exists(Request.OutputPath);
 
-bool CompileShader(std::string CommandLine)
-{
-	HANDLE Std_OUT_Rd = NULL;
-	HANDLE Std_OUT_Wr = NULL;
-
-	// additional information
-	STARTUPINFOA StartInfo;
-	PROCESS_INFORMATION ProcInfo;
-	SECURITY_ATTRIBUTES SecurityAttr;
-
-	ZeroMemory(&SecurityAttr, sizeof(SecurityAttr));
-	SecurityAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
-	SecurityAttr.bInheritHandle = TRUE;
-	SecurityAttr.lpSecurityDescriptor = NULL;
-
-	// Create a pipe for the child process's STDOUT. 
-	CreatePipe(&Std_OUT_Rd, &Std_OUT_Wr, &SecurityAttr, 0);
-
-	// Ensure the read handle to the pipe for STDOUT is not inherited.
-	SetHandleInformation(Std_OUT_Rd, HANDLE_FLAG_INHERIT, 0);
-
-	// set the size of the structures
-	ZeroMemory(&StartInfo, sizeof(StartInfo));
-	StartInfo.cb = sizeof(StartInfo);
-	StartInfo.hStdError = Std_OUT_Wr;
-	StartInfo.hStdOutput = Std_OUT_Wr;
-	StartInfo.dwFlags |= STARTF_USESTDHANDLES;
-
-	ZeroMemory(&ProcInfo, sizeof(ProcInfo));
-
-	// start the program up
-	CreateProcessA("ThirdParty/DirectXShaderCompiler/bin/x64/dxc.exe",   // the exe path, got from DXC GitHub
-		const_cast<char*>(CommandLine.c_str()),        // Command line
-		NULL,           // Process handle not inheritable
-		NULL,           // Thread handle not inheritable
-		TRUE,          // Set handle inheritance to true so I can read std output
-		CREATE_NO_WINDOW,              // hide console
-		NULL,           // Use parent's environment block
-		NULL,           // Use parent's starting directory 
-		&StartInfo,            // Pointer to STARTUPINFO structure
-		&ProcInfo             // Pointer to PROCESS_INFORMATION structure (removed extra parentheses)
-	);
-	CloseHandle(Std_OUT_Wr);
-
-	DWORD DwRead;
-	CHAR Buff[2048];
-	Buff[2047] = '\0';
-	BOOL bSuccess = FALSE;
-
-	int32_t ErrorCount = 0;
-	while (true)
-	{
-		memset(Buff, 0, 2048);
-		bSuccess = ReadFile(Std_OUT_Rd, Buff, 2048, &DwRead, NULL);
-		if (!bSuccess || DwRead == 0)
+		const std::filesystem::path CompiledPath = GetCompiledPath(Key);
+		if (!bIsHit && std::filesystem::exists(CompiledPath))
 		{
-			break;
+			std::error_code Error;
+			std::filesystem::create_directories(Request.OutputPath.parent_path(), Error);
+			bIsHit = std::filesystem::copy_file(CompiledPath, Request.OutputPath, std::filesystem::copy_options::overwrite_existing, Error);
 		}
 
-		// Log chBuf
-		UHE_LOG(UHUtilities::ToStringW(Buff));
-		ErrorCount++;
-	}
+		if (bIsHit)
+		{
+			Stats.NumHits++;
+			RememberRequest(Request, Key);
+			continue;
+		}
 
-	// Close process and thread handles. 
-	CloseHandle(ProcInfo.hProcess);
-	CloseHandle(ProcInfo.hThread);
-	CloseHandle(Std_OUT_Rd);
+		UHPendingCompile Pending{ &Request, Key, UHINDEXNONE, false, "" };
+		if (PendingByKey.find(Key) != PendingByKey.end())
+		{
+			// the same content is requested to another output in this batch, copy it after compiling
+			Pending.CompileIdx = PendingByKey[Key];
+			DuplicateCompiles.push_back(Pending);
+			continue;
+		}
 
-	if (ErrorCount != 0)
-	{
-		assert(("Shader compilation failed, see output logs for details!", ErrorCount == 0));
-		return false;
+		PendingByKey[Key] = static_cast<int32_t>(PendingCompiles.size());
+		PendingCompiles.push_back(Pending);
+		UHE_LOG(L"Compiling " + Request.SourcePath.wstring() + L"...\n");
 	}
 
-	return true;
-}
+	// each worker picks the next pending shader until all are done, the compiler runs as a process so they don't block each other
+	if (PendingCompiles.size() > 0)
+	{
+		std::atomic<size_t> NextCompile = 0;
+		const auto CompileWorker = [this, &PendingCompiles, &NextCompile]()
+		{
+			for (size_t Idx = NextCompile++; Idx < PendingCompiles.size(); Idx = NextCompile++)
+			{
+				UHPendingCompile& Pending = PendingCompiles[Idx];
+				std::error_code Error;
+				std::filesystem::create_directories(Pending.Request->OutputPath.parent_path(), Error);
+
+				Pending.bSucceed = Compiler->Compile(*Pending.Request, Pending.Log);
+				if (Pending.bSucceed)
+				{
+					std::filesystem::copy_file(Pending.Request->OutputPath, GetCompiledPath(Pending.Key), std::filesystem::copy_options::overwrite_existing, Error);
+				}
+			}
+		};
+
+		const int32_t NumWorkers = (std::min)(MaxConcurrentCompiles, static_cast<int32_t>(PendingCompiles.size()));
+		std::vector<std::thread> Workers;
+		for (int32_t Idx = 1; Idx < NumWorkers; Idx++)
+		{
+			Workers.push_back(std::thread(CompileWorker));
+		}
 
-void UHShaderImporter::CompileHLSL(std::string InShaderName, std::filesystem::path InSource, std::string EntryName, std::string ProfileName
-	, std::vector<std::string> Defines)
-{
-	// compile HLSL shader by calling dxc.exe, which supports Vulkan spir-v
-	// after it compiled succeed, export it to UH asset folder
-	//dxc.exe -spirv -T <target-prfile> -E <entry-point> <hlsl - src - file> -Fo <spirv - bin - file>
+		// the caller works as well
+		CompileWorker();
+		for (std::thread& Worker : Workers)
+		{
+			Worker.join();
+		}
+	}
 
+	for (const UHPendingCompile& Pending : PendingCompiles)
+	{
+		if (!Pending.Log.empty())
+		{
+			UHE_LOG(Pending.Log);
+		}
 
-	// find origin path and try to preserve file structure
-	std::string OriginSubpath = UHAssetPath::GetShaderOriginSubpath(InSource);
+		if (Pending.bSucceed)
+		{
+			Stats.NumCompiled++;
+			RememberRequest(*Pending.Request, Pending.Key);
+		}
+		else
+		{
+			Stats.NumFailed++;
+			UHE_LOG(L"Failed to compile shader " + Pending.Request->SourcePath.wstring() + L"!\n");
+		}
+	}
 
-	// get macro hash name and setup output file name
-	size_t MacroHash = UHUtilities::ShaderDefinesToHash(Defines);
-	std::string MacroHashName = (MacroHash != 0) ? "_" + std::to_string(MacroHash) : "";
-	std::filesystem::path OutputShaderPath = GShaderAssetFolder + OriginSubpath + InShaderName + MacroHashName + GShaderAssetExtension;
+	for (const UHPendingCompile& Duplicate : DuplicateCompiles)
+	{
+		std::error_code Error;
+		if (PendingCompiles[Duplicate.CompileIdx].bSucceed
+			&& std::filesystem::copy_file(PendingCompiles[Duplicate.CompileIdx].Request->OutputPath, Duplicate.Request->OutputPath
+				, std::filesystem::copy_options::overwrite_existing, Error))
+		{
+			Stats.NumHits++;
+			RememberRequest(*Duplicate.Request, Duplicate.Key);
+		}
+		else
+		{
+			Stats.NumFailed++;
+		}
+	}
 
-	if (!std::filesystem::exists(GShaderAssetFolder + OriginSubpath))
+	if (bIsCacheChanged)
 	{
-		std::filesystem::create_directories(GShaderAssetFolder + OriginSubpath);
+		WriteShaderCache();
 	}
 
-	// check if shader is cached
-	if (IsShaderCached(InSource, OutputShaderPath, EntryName, ProfileName, Defines))
+	Stats.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	TotalStats.Accumulate(Stats);
+
+	// don't flood the log with single cache hits
+	if (Stats.NumRequests > 1 || Stats.NumHits < Stats.NumRequests)
 	{
-		return;
+		UHE_LOG(L"Shader cache: " + Stats.ToString() + L"\n");
 	}
 
-	// compile, setup dx layout as well, be careful that the path must include "" mark in case there are folders with whitespace name
-	const std::string QuoteMark = "\"";
-	std::string CompileCmd = " -spirv -T " + ProfileName + " -E " + EntryName + " "
-		+ QuoteMark + std::filesystem::absolute(InSource).string() + QuoteMark
-		+ " -Fo " + QuoteMark + std::filesystem::absolute(OutputShaderPath).string() + QuoteMark
-		+ " -HV 2018 "
-		+ " -fvk-use-dx-layout "
-		+ " -fvk-use-dx-position-w "
-		+ " -fspv-target-env=vulkan1.1spirv1.4 ";
-
-	// mesh shader extension
-	if (UHUtilities::StringFind(ProfileName, "as_") || UHUtilities::StringFind(ProfileName, "ms_"))
-	{
-		CompileCmd += " -fspv-extension=SPV_EXT_mesh_shader ";
-		CompileCmd += " -fspv-extension=SPV_EXT_descriptor_indexing ";
+	if (Stats.NumFailed != 0)
+	{
+		assert(("Shader compilation failed, see output logs for details!", Stats.NumFailed == 0));
 	}
 
-	// add define command lines
-	for (const std::string& Define : Defines)
+	return Stats;
+}
+
+UHShaderCompileStats UHShaderImporter::RecompileCachedShaders()
+{
+	std::vector<UHShaderCompileRequest> Requests;
+	for (const auto& Record : UHRawShadersCache)
 	{
-		CompileCmd += " -D " + Define;
+		// templates don't have an output, and the source could be removed since last time
+		const UHShaderCompileRequest& Request = Record.second.Request;
+		if (!Request.OutputPath.empty() && std::filesystem::exists(Request.SourcePath))
+		{
+			Requests.push_back(Request);
+		}
 	}
 
-	UHE_LOG(L"Compiling " + InSource.wstring() + L"...\n");
-	bool bCompileResult = CompileShader(CompileCmd);
+	return CompileShaders(Requests);
+}
 
-	if (!std::filesystem::exists(OutputShaderPath) || !bCompileResult)
+bool UHShaderImporter::IsShaderTemplateCached(std::filesystem::path SourcePath, std::string EntryName, std::string ProfileName)
+{
+	if (!std::filesystem::exists(SourcePath))
 	{
-		UHE_LOG(L"Failed to compile shader " + InSource.wstring() + L"!\n");
-		return;
+		return false;
 	}
 
-	// write shader cache
-	WriteShaderCache(InSource, OutputShaderPath, EntryName, ProfileName, Defines);
-	WriteShaderIncludeCache();
+	// the template key is built the same way but without defines, it changes when the template or any of its includes changes
+	UHShaderCompileRequest Request;
+	Request.SourcePath = SourcePath;
+	Request.EntryName = EntryName;
+	Request.ProfileName = ProfileName;
+
+	const auto Record = UHRawShadersCache.find(GetTemplateRecordName(SourcePath, EntryName, ProfileName));
+	return Record != UHRawShadersCache.end() && Record->second.Key == GetCacheKey(Request);
+}
+
+void UHShaderImporter::CompileHLSL(std::string InShaderName, std::filesystem::path InSource, std::string EntryName, std::string ProfileName
+	, std::vector<std::string> Defines)
+{
+	// find origin path and try to preserve file structure
+	std::string OriginSubpath = UHAssetPath::GetShaderOriginSubpath(InSource);
+
+	// get macro hash name and setup output file name, then export it to UH asset folder
+	size_t MacroHash = UHUtilities::ShaderDefinesToHash(Defines);
+	std::string MacroHashName = (MacroHash != 0) ? "_" + std::to_string(MacroHash) : "";
+
+	UHShaderCompileRequest Request;
+	Request.SourcePath = InSource;
+	Request.OutputPath = GShaderAssetFolder + OriginSubpath + InShaderName + MacroHashName + GShaderAssetExtension;
+	Request.EntryName = EntryName;
+	Request.ProfileName = ProfileName;
+	Request.Defines = Defines;
+
+	CompileShaders(std::vector<UHShaderCompileRequest>{ Request });
+}
+
+const UHShaderCompileStats& UHShaderImporter::GetTotalStats() const
+{
+	return TotalStats;
 }
 
 std::string UHShaderImporter::TranslateHLSL(std::string InShaderName, std::filesystem::path InSource, std::string EntryName, std::string ProfileName, UHMaterialCompileData InData
@@ -387,40 +576,31 @@ std::string UHShaderImporter::TranslateHLSL(std::string InShaderName, std::files
 		? GShaderAssetFolder + OutName + GShaderAssetExtension
 		: TempShaderPath + GShaderAssetExtension;
 
-	// compile, setup dx layout as well, be careful with path system, quotation mark is needed
-	const std::string QuoteMark = "\"";
-	std::string CompileCmd = " -spirv -T " + ProfileName + " -E " + EntryName + " "
-		+ QuoteMark + std::filesystem::absolute(TempShaderPath + GRawShaderExtension).string() + QuoteMark
-		+ " -Fo " + QuoteMark + std::filesystem::absolute(OutputShaderPath).string() + QuoteMark
-		+ " -HV 2018 "
-		+ " -fvk-use-dx-layout "
-		+ " -fvk-use-dx-position-w "
-		+ " -fspv-target-env=vulkan1.1spirv1.4 ";
-
-	// mesh shader extension
-	if (UHUtilities::StringFind(ProfileName, "as_") || UHUtilities::StringFind(ProfileName, "ms_"))
-	{
-		CompileCmd += " -fspv-extension=SPV_EXT_mesh_shader ";
-		CompileCmd += " -fspv-extension=SPV_EXT_descriptor_indexing ";
-	}
-
-	// add define command lines
-	for (const std::string& Define : Defines)
+	// compile the generated code through the cache, it's a hit if the material produced the same code before
+	// the generated file is temporary so it isn't remembered for recompiling
+	UHShaderCompileRequest Request;
+	Request.SourcePath = TempShaderPath + GRawShaderExtension;
+	Request.OutputPath = OutputShaderPath;
+	Request.EntryName = EntryName;
+	Request.ProfileName = ProfileName;
+	Request.Defines = Defines;
+
+	const UHShaderCompileStats Stats = CompileShaders(std::vector<UHShaderCompileRequest>{ Request }, false);
+	if (Stats.NumFailed > 0 || !std::filesystem::exists(OutputShaderPath))
 	{
-		CompileCmd += " -D " + Define;
-	}
-
-	UHE_LOG("Compiling " + OutputShaderPath + "...\n");
-	bool bCompileResult = CompileShader(CompileCmd);
-
-	if (!std::filesystem::exists(OutputShaderPath) || !bCompileResult)
-	{
-		UHE_LOG("Failed to compile shader " + OutputShaderPath + "!\n");
 		return "";
 	}
 
-	// write shader cache, the template doesn't need macro and output shader path
-	WriteShaderCache(InSource, "", EntryName, ProfileName);
+	// remember the template key, the template doesn't need macro and output shader path
+	UHShaderCompileRequest TemplateRequest;
+	TemplateRequest.SourcePath = InSource;
+	TemplateRequest.EntryName = EntryName;
+	TemplateRequest.ProfileName = ProfileName;
+
+	UHRawShaderAssetCache& TemplateCache = UHRawShadersCache[GetTemplateRecordName(InSource, EntryName, ProfileName)];
+	TemplateCache.Request = TemplateRequest;
+	TemplateCache.Key = GetCacheKey(TemplateRequest);
+	WriteShaderCache();
 
 	// return the output shader path
 	return OutputShaderPath;
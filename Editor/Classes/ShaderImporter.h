@@ -3,69 +3,117 @@
 
 #if WITH_EDITOR
 #include <filesystem>
+#include <unordered_map>
 #include <vector>
 #include "Runtime/Classes/Utility.h"
+#include "Runtime/Classes/AssetPath.h"
+#include "ShaderCompiler.h"
 
 class UHMaterial;
 struct UHMaterialCompileData;
 
-// shader asset cache
+// a compiled shader or a material template remembered by the importer, the key is the content hash it was built from
 struct UHRawShaderAssetCache
 {
 	UHRawShaderAssetCache()
-		: SourcLastModifiedTime(0)
+		: Key(0)
 	{
 
 	}
 
-	inline bool operator==(UHRawShaderAssetCache InCache)
+	UHShaderCompileRequest Request;
+	size_t Key;
+};
+
+// result of compiling shaders through the cache
+struct UHShaderCompileStats
+{
+	UHShaderCompileStats()
+		: NumRequests(0)
+		, NumHits(0)
+		, NumCompiled(0)
+		, NumFailed(0)
+		, WallSeconds(0.0)
 	{
-		bool bDefineEqual = Defines.size() == InCache.Defines.size();
-		if (bDefineEqual)
-		{
-			for (size_t Idx = 0; Idx < Defines.size(); Idx++)
-			{
-				bDefineEqual &= Defines[Idx] == InCache.Defines[Idx];
-			}
-		}
-
-		// cache is equal if source path, modified time, and UHMeshes path are matched
-		const bool bIsCacheEqual = (InCache.SourcePath == SourcePath)
-			&& (InCache.SourcLastModifiedTime == SourcLastModifiedTime)
-			&& (InCache.UHShaderPath == UHShaderPath)
-			&& (InCache.EntryName == EntryName)
-			&& (InCache.ProfileName == ProfileName);
-
-		return bIsCacheEqual && bDefineEqual;
+
 	}
 
-	std::filesystem::path SourcePath;
-	int64_t SourcLastModifiedTime;
-	std::filesystem::path UHShaderPath;
-	std::string EntryName;
-	std::string ProfileName;
-	std::vector<std::string> Defines;
+	void Accumulate(const UHShaderCompileStats& InStats);
+	float GetHitRate() const;
+	std::wstring ToString() const;
+
+	uint32_t NumRequests;
+	uint32_t NumHits;
+	uint32_t NumCompiled;
+	uint32_t NumFailed;
+	double WallSeconds;
+};
+
+// include dependency graph of shader sources
+// a file node keeps the content hash and resolved includes, it's parsed again only when the write time changes
+class UHShaderIncludeGraph
+{
+public:
+	// hash of the file content and everything it includes recursively
+	size_t GetClosureHash(const std::filesystem::path& InPath);
+
+	// all files included by the file recursively, the file itself isn't a part of it
+	std::vector<std::string> GetIncludeClosure(const std::filesystem::path& InPath);
+
+private:
+	struct UHShaderFileNode
+	{
+		int64_t LastWriteTime;
+		size_t ContentHash;
+		std::vector<std::string> Includes;
+	};
+
+	static std::string ToNodeKey(const std::filesystem::path& InPath);
+	const UHShaderFileNode& RefreshNode(const std::string& InKey);
+	void CollectClosure(const std::string& InKey, std::vector<std::string>& OutClosure, std::unordered_map<std::string, bool>& Visited);
+
+	std::unordered_map<std::string, UHShaderFileNode> Nodes;
 };
 
+// shader importer, the compiled shaders are stored by the hash of their source, include closure, entry, profile, defines and compiler version
+// so an output is reused whenever the same content is compiled again, and cache misses are compiled by several compiler processes at once
 class UHShaderImporter
 {
 public:
-	UHShaderImporter();
+	UHShaderImporter(UniquePtr<UHShaderCompiler> InCompiler = nullptr, std::string InCachePath = GRawShaderCachePath
+		, int32_t InMaxConcurrentCompiles = 0);
 
 	void LoadShaderCache();
-	void WriteShaderIncludeCache();
-	bool IsShaderIncludeCached();
-	bool IsShaderCached(std::filesystem::path SourcePath, std::filesystem::path UHShaderPath, std::string EntryName, std::string ProfileName
-		, std::vector<std::string> Defines);
+
+	// compile every shader compiled in previous sessions if its content changed, so later requests are cache hits
+	UHShaderCompileStats RecompileCachedShaders();
+
+	// compile all requests through the cache, the requests are remembered for RecompileCachedShaders if bRemember is set
+	UHShaderCompileStats CompileShaders(const std::vector<UHShaderCompileRequest>& InRequests, bool bRemember = true);
+
+	// false if the template or one of its includes is changed since the template was translated last time
 	bool IsShaderTemplateCached(std::filesystem::path SourcePath, std::string EntryName, std::string ProfileName);
 	void CompileHLSL(std::string InShaderName, std::filesystem::path InSource, std::string EntryName, std::string ProfileName
 		, std::vector<std::string> Defines);
 	std::string TranslateHLSL(std::string InShaderName, std::filesystem::path InSource, std::string EntryName, std::string ProfileName, UHMaterialCompileData InData
 		, std::vector<std::string> Defines);
 
+	const UHShaderCompileStats& GetTotalStats() const;
+
 private:
-	std::vector<UHRawShaderAssetCache> UHRawShadersCache;
-	std::vector<std::string> ShaderIncludes;
+	size_t GetCacheKey(const UHShaderCompileRequest& InRequest);
+	std::filesystem::path GetCompiledPath(size_t InKey) const;
+	static std::string GetTemplateRecordName(std::filesystem::path SourcePath, std::string EntryName, std::string ProfileName);
+	void WriteShaderCache();
+
+	UniquePtr<UHShaderCompiler> Compiler;
+	std::string CachePath;
+	int32_t MaxConcurrentCompiles;
+	UHShaderIncludeGraph IncludeGraph;
+	UHShaderCompileStats TotalStats;
+
+	// records by output path, or by GetTemplateRecordName for material templates
+	std::unordered_map<std::string, UHRawShaderAssetCache> UHRawShadersCache;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "TextureBatchImporter.h"
+
+#if WITH_EDITOR
+#include "TextureImporter.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/Texture2D.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+// bump this when the import result changes for the same source, so all textures are imported again
+static const uint64_t GTextureImportVersion = 1;
+
+void UHTextureBatchImportStats::Accumulate(const UHTextureBatchImportStats& InStats)
+{
+	NumImported += InStats.NumImported;
+	NumSkipped += InStats.NumSkipped;
+	NumFailed += InStats.NumFailed;
+	HashSeconds += InStats.HashSeconds;
+	DecodeSeconds += InStats.DecodeSeconds;
+	MipSeconds += InStats.MipSeconds;
+	CompressSeconds += InStats.CompressSeconds;
+	ExportSeconds += InStats.ExportSeconds;
+	ImportedTextures.insert(ImportedTextures.end(), InStats.ImportedTextures.begin(), InStats.ImportedTextures.end());
+	FailedSources.insert(FailedSources.end(), InStats.FailedSources.begin(), InStats.FailedSources.end());
+}
+
+UHTextureBatchImporter::UHTextureBatchImporter(uint64_t InMemoryBudget, int32_t InMaxConcurrentTextures)
+	: MemoryBudget(InMemoryBudget)
+	, NumThreads(std::clamp(InMaxConcurrentTextures, 1, MaxConcurrentTextures))
+	, ReservedBytes(0)
+	, PeakReservedBytes(0)
+{
+
+}
+
+bool UHTextureBatchImporter::IsSupportedImage(const std::filesystem::path& InPath)
+{
+	static const std::string SupportedExtensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff", ".exr" };
+	for (const std::string& Extension : SupportedExtensions)
+	{
+		if (UHAssetPath::IsTheSameExtension(InPath, Extension))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint64_t UHTextureBatchImporter::HashFileContent(const std::filesystem::path& InPath)
+{
+	uint64_t Hash = 14695981039346656037ull;
+	const auto HashBytes = [&Hash](const uint8_t* InData, size_t InSize)
+	{
+		for (size_t Idx = 0; Idx < InSize; Idx++)
+		{
+			Hash = (Hash ^ InData[Idx]) * 1099511628211ull;
+		}
+	};
+
+	HashBytes(reinterpret_cast<const uint8_t*>(&GTextureImportVersion), sizeof(GTextureImportVersion));
+
+	std::ifstream FileIn(InPath, std::ios::in | std::ios::binary);
+	std::vector<char> Buffer(1 << 20);
+	while (FileIn)
+	{
+		FileIn.read(Buffer.data(), Buffer.size());
+		HashBytes(reinterpret_cast<const uint8_t*>(Buffer.data()), static_cast<size_t>(FileIn.gcount()));
+	}
+
+	return Hash;
+}
+
+uint64_t UHTextureBatchImporter::EstimateMemoryUsage(uint32_t Width, uint32_t Height, bool bIsHDR)
+{
+	// raw data + mip chain + compressed output in the texture format, plus float source, intermediate and destination of the mip generator
+	const uint64_t TexelCount = static_cast<uint64_t>(Width) * Height;
+	const uint64_t ByteSize = bIsHDR ? 8 : 4;
+	return TexelCount * (ByteSize * 3 + sizeof(XMVECTOR) * 2);
+}
+
+void UHTextureBatchImporter::ReserveMemory(uint64_t InBytes)
+{
+	std::unique_lock<std::mutex> Lock(BudgetMutex);
+	BudgetCondition.wait(Lock, [&]() { return ReservedBytes == 0 || ReservedBytes + InBytes <= MemoryBudget; });
+	ReservedBytes += InBytes;
+	PeakReservedBytes = (std::max)(PeakReservedBytes, ReservedBytes);
+}
+
+void UHTextureBatchImporter::ReleaseMemory(uint64_t InBytes)
+{
+	{
+		std::unique_lock<std::mutex> Lock(BudgetMutex);
+		ReservedBytes -= InBytes;
+	}
+	BudgetCondition.notify_all();
+}
+
+UHTextureBatchImportStats UHTextureBatchImporter::ImportFolder(const std::filesystem::path& InSourceFolder, const std::filesystem::path& InOutputFolder
+	, bool bForce)
+{
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	// the sub folders of the source are kept in the output
+	std::vector<std::filesystem::path> SourcePaths;
+	std::vector<std::filesystem::path> OutputFolders;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(InSourceFolder))
+	{
+		if (Entry.is_regular_file() && IsSupportedImage(Entry.path()))
+		{
+			SourcePaths.push_back(Entry.path());
+			OutputFolders.push_back(InOutputFolder / std::filesystem::relative(Entry.path().parent_path(), InSourceFolder));
+			std::filesystem::create_directories(OutputFolders.back());
+		}
+	}
+
+	// UHObject registers itself to a global table which isn't thread safe, so textures are created and destroyed on this thread
+	// existing assets are imported by the batch threads later, which keeps their settings and UUID
+	std::vector<UniquePtr<UHTexture2D>> Textures(SourcePaths.size());
+	for (size_t Idx = 0; Idx < SourcePaths.size(); Idx++)
+	{
+		const std::string OutputPathName = (OutputFolders[Idx] / SourcePaths[Idx].stem()).string();
+		if (std::filesystem::exists(OutputPathName + GTextureAssetExtension))
+		{
+			Textures[Idx] = MakeUnique<UHTexture2D>();
+			continue;
+		}
+
+		// new textures use BC3 for LDR and BC6H for HDR
+		UHTextureSettings Settings;
+		Settings.bIsHDR = UHAssetPath::IsTheSameExtension(SourcePaths[Idx], ".exr");
+		Settings.CompressionSetting = Settings.bIsHDR ? UHTextureCompressionSettings::BC6H : UHTextureCompressionSettings::BC3;
+
+		UHTextureFormat Format = Settings.bIsHDR ? UHTextureFormat::UH_FORMAT_RGBA16F : UHTextureFormat::UH_FORMAT_RGBA8_SRGB;
+		CompressionSettingToFormat(Settings, Format);
+
+		std::string SavedPathName = UHUtilities::StringReplace(OutputPathName, "\\", "/");
+		SavedPathName = UHUtilities::StringReplace(SavedPathName, GTextureAssetFolder, "");
+		Textures[Idx] = MakeUnique<UHTexture2D>(SourcePaths[Idx].stem().string(), SavedPathName, VkExtent2D(), Format, Settings);
+	}
+
+	std::vector<UHTextureBatchImportStats> ThreadStats(NumThreads);
+	std::atomic<size_t> NextIndex = 0;
+	std::vector<std::thread> Threads;
+	for (int32_t ThreadIdx = 0; ThreadIdx < NumThreads; ThreadIdx++)
+	{
+		Threads.emplace_back([&, ThreadIdx]()
+			{
+				// WIC needs COM initialized on each thread
+				const HRESULT ComResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+				for (size_t Idx = NextIndex++; Idx < SourcePaths.size(); Idx = NextIndex++)
+				{
+					ImportTexture(SourcePaths[Idx], OutputFolders[Idx], Textures[Idx].get(), bForce, ThreadStats[ThreadIdx]);
+				}
+
+				if (SUCCEEDED(ComResult))
+				{
+					CoUninitialize();
+				}
+			});
+	}
+
+	for (std::thread& Thread : Threads)
+	{
+		Thread.join();
+	}
+	Textures.clear();
+
+	UHTextureBatchImportStats Stats;
+	for (const UHTextureBatchImportStats& ThreadStat : ThreadStats)
+	{
+		Stats.Accumulate(ThreadStat);
+	}
+	Stats.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	Stats.PeakReservedBytes = PeakReservedBytes;
+
+	return Stats;
+}
+
+void UHTextureBatchImporter::ImportTexture(const std::filesystem::path& InSourcePath, const std::filesystem::path& InOutputFolder, UHTexture2D* InTexture
+	, bool bForce, UHTextureBatchImportStats& OutStats)
+{
+	typedef std::chrono::steady_clock UHClock;
+	const std::string OutputPathName = (InOutputFolder / InSourcePath.stem()).string();
+	const std::string AssetPath = OutputPathName + GTextureAssetExtension;
+	const std::string HashPath = OutputPathName + GTextureHashExtension;
+
+	// step 1: compare the content hash with the one stored next to the asset
+	UHClock::time_point StepTime = UHClock::now();
+	const uint64_t SourceHash = HashFileContent(InSourcePath);
+	uint64_t StoredHash = 0;
+	{
+		std::ifstream HashIn(HashPath, std::ios::in | std::ios::binary);
+		HashIn.read(reinterpret_cast<char*>(&StoredHash), sizeof(StoredHash));
+	}
+	OutStats.HashSeconds += std::chrono::duration<double>(UHClock::now() - StepTime).count();
+
+	const bool bAssetExists = std::filesystem::exists(AssetPath);
+	if (!bForce && bAssetExists && StoredHash == SourceHash)
+	{
+		OutStats.NumSkipped++;
+		return;
+	}
+
+	UHTextureImporter Importer;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	bool bSucceeded = false;
+	try
+	{
+		bSucceeded = Importer.GetTextureSize(InSourcePath, Width, Height) && Width > 0 && Height > 0;
+		if (bSucceeded && bAssetExists)
+		{
+			// only the settings and UUID of the existing asset are needed
+			bSucceeded = InTexture->Import(AssetPath);
+			InTexture->SetTextureData(std::vector<uint8_t>());
+		}
+	}
+	catch (const std::exception& E)
+	{
+		UHE_LOG("Failed to read " + InSourcePath.string() + ": " + E.what() + "\n");
+		bSucceeded = false;
+	}
+
+	if (!bSucceeded)
+	{
+		UHE_LOG(L"Failed to read the image or the existing asset of " + InSourcePath.wstring() + L"\n");
+		OutStats.NumFailed++;
+		OutStats.FailedSources.push_back(InSourcePath);
+		return;
+	}
+
+	UHTextureSettings Settings = InTexture->GetTextureSettings();
+	Settings.bIsHDR = UHAssetPath::IsTheSameExtension(InSourcePath, ".exr");
+	InTexture->SetTextureSettings(Settings);
+
+	const uint64_t EstimatedBytes = EstimateMemoryUsage(Width, Height, Settings.bIsHDR);
+	ReserveMemory(EstimatedBytes);
+
+	UHTextureBuildStats BuildStats;
+	double DecodeSeconds = 0.0;
+	double ExportSeconds = 0.0;
+	try
+	{
+		// step 2: decode
+		StepTime = UHClock::now();
+		std::vector<uint8_t> RawData = Importer.LoadTexture(InSourcePath, Width, Height);
+		DecodeSeconds = std::chrono::duration<double>(UHClock::now() - StepTime).count();
+		bSucceeded = !RawData.empty();
+		if (!bSucceeded)
+		{
+			UHE_LOG(L"Failed to decode " + InSourcePath.wstring() + L"\n");
+		}
+
+		if (bSucceeded)
+		{
+			// step 3: mip generation and compression
+			InTexture->SetExtent(Width, Height);
+			InTexture->SetRawSourcePath(InSourcePath.string());
+			InTexture->BuildTextureData(true, RawData, &BuildStats);
+			RawData = std::vector<uint8_t>();
+
+			// step 4: export the asset and its hash
+			StepTime = UHClock::now();
+			InTexture->Export(OutputPathName);
+			std::ofstream HashOut(HashPath, std::ios::out | std::ios::binary);
+			HashOut.write(reinterpret_cast<const char*>(&SourceHash), sizeof(SourceHash));
+			ExportSeconds = std::chrono::duration<double>(UHClock::now() - StepTime).count();
+		}
+	}
+	catch (const std::exception& E)
+	{
+		UHE_LOG("Failed to import " + InSourcePath.string() + ": " + E.what() + "\n");
+		bSucceeded = false;
+	}
+
+	InTexture->SetTextureData(std::vector<uint8_t>());
+	ReleaseMemory(EstimatedBytes);
+
+	OutStats.DecodeSeconds += DecodeSeconds;
+	OutStats.MipSeconds += BuildStats.MipSeconds;
+	OutStats.CompressSeconds += BuildStats.CompressSeconds;
+	OutStats.ExportSeconds += ExportSeconds;
+
+	if (!bSucceeded)
+	{
+		OutStats.NumFailed++;
+		OutStats.FailedSources.push_back(InSourcePath);
+		return;
+	}
+
+	UHTextureImportRecord Record;
+	Record.SourcePath = InSourcePath;
+	Record.Width = Width;
+	Record.Height = Height;
+	Record.DecodeSeconds = DecodeSeconds;
+	Record.MipSeconds = BuildStats.MipSeconds;
+	Record.CompressSeconds = BuildStats.CompressSeconds;
+	Record.ExportSeconds = ExportSeconds;
+	OutStats.ImportedTextures.push_back(Record);
+	OutStats.NumImported++;
+}
+#endif
\ No newline at end of file
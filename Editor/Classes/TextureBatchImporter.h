@@ -0,0 +1,109 @@
+#pragma once
+#include "../../UnheardEngine.h"
+
+#if WITH_EDITOR
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class UHTexture2D;
+
+// stage times of an imported texture
+struct UHTextureImportRecord
+{
+	UHTextureImportRecord()
+		: Width(0)
+		, Height(0)
+		, DecodeSeconds(0.0)
+		, MipSeconds(0.0)
+		, CompressSeconds(0.0)
+		, ExportSeconds(0.0)
+	{
+
+	}
+
+	std::filesystem::path SourcePath;
+	uint32_t Width;
+	uint32_t Height;
+	double DecodeSeconds;
+	double MipSeconds;
+	double CompressSeconds;
+	double ExportSeconds;
+};
+
+// result of a batch import, the stage times are summed over all textures so they can exceed the wall time
+struct UHTextureBatchImportStats
+{
+	UHTextureBatchImportStats()
+		: NumImported(0)
+		, NumSkipped(0)
+		, NumFailed(0)
+		, HashSeconds(0.0)
+		, DecodeSeconds(0.0)
+		, MipSeconds(0.0)
+		, CompressSeconds(0.0)
+		, ExportSeconds(0.0)
+		, WallSeconds(0.0)
+		, PeakReservedBytes(0)
+	{
+
+	}
+
+	void Accumulate(const UHTextureBatchImportStats& InStats);
+
+	uint32_t NumImported;
+	uint32_t NumSkipped;
+	uint32_t NumFailed;
+	double HashSeconds;
+	double DecodeSeconds;
+	double MipSeconds;
+	double CompressSeconds;
+	double ExportSeconds;
+	double WallSeconds;
+	uint64_t PeakReservedBytes;
+
+	// imported textures and the sources failed to import, the errors are logged as well
+	std::vector<UHTextureImportRecord> ImportedTextures;
+	std::vector<std::filesystem::path> FailedSources;
+};
+
+// imports all images of a folder to .uhtexture assets without a graphic device
+// several textures are processed at the same time, and each one reserves its estimated memory from the budget before decoding,
+// a texture larger than the whole budget still runs but alone.
+// the content hash of the source is stored next to the asset, unchanged sources are skipped unless it's forced
+class UHTextureBatchImporter
+{
+public:
+	UHTextureBatchImporter(uint64_t InMemoryBudget, int32_t InMaxConcurrentTextures);
+
+	UHTextureBatchImportStats ImportFolder(const std::filesystem::path& InSourceFolder, const std::filesystem::path& InOutputFolder, bool bForce);
+
+	static bool IsSupportedImage(const std::filesystem::path& InPath);
+
+	// 64-bit FNV-1a of the file content, it's read in chunks so the whole file isn't loaded
+	static uint64_t HashFileContent(const std::filesystem::path& InPath);
+
+	// texture data is at most a few times of the raw size, and the mip generator keeps float copies of two mips
+	static uint64_t EstimateMemoryUsage(uint32_t Width, uint32_t Height, bool bIsHDR);
+
+	// each batch thread registers itself to the texture job system, keep the count below its external context limit
+	static const int32_t MaxConcurrentTextures = 6;
+
+private:
+	void ImportTexture(const std::filesystem::path& InSourcePath, const std::filesystem::path& InOutputFolder, UHTexture2D* InTexture
+		, bool bForce, UHTextureBatchImportStats& OutStats);
+
+	void ReserveMemory(uint64_t InBytes);
+	void ReleaseMemory(uint64_t InBytes);
+
+	uint64_t MemoryBudget;
+	int32_t NumThreads;
+
+	std::mutex BudgetMutex;
+	std::condition_variable BudgetCondition;
+	uint64_t ReservedBytes;
+	uint64_t PeakReservedBytes;
+};
+#endif
\ No newline at end of file
@@ -146,6 +146,43 @@ std::vector<uint8_t> UHTextureImporter::LoadTexture(std::filesystem::path Filena
 	return Texture;
 }
 
+bool UHTextureImporter::GetTextureSize(std::filesystem::path Filename, uint32_t& Width, uint32_t& Height)
+{
+	Width = 0;
+	Height = 0;
+
+	if (Filename.extension().string() == ".exr")
+	{
+		// only the header is read until readPixels() is called
+		Imf::RgbaInputFile File(Filename.string().c_str());
+		Imath::Box2i Dimension = File.dataWindow();
+		Width = Dimension.max.x - Dimension.min.x + 1;
+		Height = Dimension.max.y - Dimension.min.y + 1;
+		return true;
+	}
+
+	// WIC decodes the frame on demand, getting the size doesn't touch the pixels
+	ComPtr<IWICImagingFactory> WicFactory;
+	if (FAILED(CoCreateInstance(CLSID_WICImagingFactory2, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&WicFactory))))
+	{
+		return false;
+	}
+
+	ComPtr<IWICBitmapDecoder> Decoder;
+	if (FAILED(WicFactory->CreateDecoderFromFilename(Filename.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, Decoder.GetAddressOf())))
+	{
+		return false;
+	}
+
+	ComPtr<IWICBitmapFrameDecode> Frame;
+	if (FAILED(Decoder->GetFrame(0, Frame.GetAddressOf())))
+	{
+		return false;
+	}
+
+	return SUCCEEDED(Frame->GetSize(&Width, &Height));
+}
+
 void CompressionSettingToFormat(const UHTextureSettings& InSetting, UHTextureFormat& OutFormat)
 {
 	switch (InSetting.CompressionSetting)
@@ -169,6 +206,10 @@ void CompressionSettingToFormat(const UHTextureSettings& InSetting, UHTextureFor
 	case UHTextureCompressionSettings::BC6H:
 		OutFormat = UHTextureFormat::UH_FORMAT_BC6H;
 		break;
+
+	case UHTextureCompressionSettings::BC7:
+		OutFormat = (InSetting.bIsLinear) ? UHTextureFormat::UH_FORMAT_BC7_UNORM : UHTextureFormat::UH_FORMAT_BC7_SRGB;
+		break;
 	}
 }
 
@@ -14,6 +14,8 @@ using namespace Microsoft::WRL;
 
 class UHGraphic;
 
+void CompressionSettingToFormat(const UHTextureSettings& InSetting, UHTextureFormat& OutFormat);
+
 class UHTextureImporter
 {
 public:
@@ -22,6 +24,9 @@ public:
 
 	// load texture from file, reference: https://github.com/microsoft/Xbox-ATG-Samples/blob/main/PCSamples/IntroGraphics/SimpleTexturePC12/SimpleTexturePC12.cpp
 	std::vector<uint8_t> LoadTexture(std::filesystem::path Filename, uint32_t& Width, uint32_t& Height);
+
+	// read the image size only, the pixels aren't decoded
+	bool GetTextureSize(std::filesystem::path Filename, uint32_t& Width, uint32_t& Height);
 	UHTexture* ImportRawTexture(std::filesystem::path SourcePath, std::filesystem::path OutputFolder, UHTextureSettings InSettings);
 
 private:
@@ -17,6 +17,7 @@ UHMeshDialog::UHMeshDialog(UHAssetManager* InAsset, UHGraphic* InGfx, UHDeferred
 	, CurrentMeshIndex(UHINDEXNONE)
 	, CurrentTextureDS(nullptr)
 	, bCreateRendererAfterImport(false)
+	, bCompressVertexAfterImport(false)
 {
 	PreviewScene = MakeUnique<UHPreviewScene>(Gfx, UHPreviewSceneType::MeshPreview);
 	FBXImporterInterface = MakeUnique<UHFbxImporter>();
@@ -87,6 +88,7 @@ void UHMeshDialog::Update(bool& bIsDialogActive)
 		if (CurrentMeshIndex != UHINDEXNONE)
 		{
 			ImGui::Text(("Number of triangles: " + std::to_string(Meshes[CurrentMeshIndex]->GetIndicesCount() / 3)).c_str());
+			ImGui::Text((Meshes[CurrentMeshIndex]->GetVertexFormat() == UHVertexFormat::Compressed) ? "Vertex format: Compressed" : "Vertex format: Full");
 			ImGui::Image(CurrentTextureDS, ImVec2(512, 512));
 		}
 
@@ -100,6 +102,7 @@ void UHMeshDialog::Update(bool& bIsDialogActive)
 	{
 		ImGui::TableNextColumn();
 		ImGui::Checkbox("Create Renderer after import", &bCreateRendererAfterImport);
+		ImGui::Checkbox("Compress vertex data", &bCompressVertexAfterImport);
 		ImGui::NewLine();
 		if (ImGui::Button("Import"))
 		{
@@ -216,6 +219,7 @@ void UHMeshDialog::OnImport()
 		ImportMesh->SetSourcePath(std::filesystem::relative(MeshOutputPath, GMeshAssetFolder).string() + "/" + ImportMesh->GetName());
 		if (!std::filesystem::exists(OutPath))
 		{
+			ImportMesh->SetVertexFormat(bCompressVertexAfterImport ? UHVertexFormat::Compressed : UHVertexFormat::Full);
 			ImportMesh->Export(OutPath);
 			AssetMgr->AddImportedMesh(ImportMesh);
 		}
@@ -39,6 +39,7 @@ private:
 	std::string TextureReferencePath;
 
 	bool bCreateRendererAfterImport;
+	bool bCompressVertexAfterImport;
 };
 
 #endif
\ No newline at end of file
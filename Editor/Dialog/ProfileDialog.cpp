@@ -3,7 +3,8 @@
 #if WITH_EDITOR
 #include "../Editor/Profiler.h"
 #include "Runtime/Engine/Config.h"
-#include "Runtime/Classes/GPUQuery.h"
+#include "Runtime/Classes/GPUTimeline.h"
+#include <algorithm>
 
 UHProfileDialog::UHProfileDialog()
     : UHDialog(nullptr, nullptr)
@@ -11,7 +12,7 @@ UHProfileDialog::UHProfileDialog()
 
 }
 
-void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer* InGameTimer, UHConfigManager* InConfig)
+void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer* InGameTimer, UHConfigManager* InConfig, const UHGPUTimeline* InGPUTimeline)
 {
     if (!bIsOpened)
     {
@@ -20,10 +21,6 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
 
     // convert stats to string and display them
     const UHStatistics& Stats = InProfiler->GetStatistics();
-    const auto& CPUScopeStats = UHGameTimerScope::GetResiteredGameTime();
-    const auto& GPUScopeStats = UHGPUTimeQueryScope::GetResiteredGPUTime();
-
-    static std::vector<std::stringstream> CPUTimeStats;
 
     if (InGameTimer->GetTotalTime() > 1.0f)
     {
@@ -36,19 +33,22 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
         CPUStatTex << "Total CPU Time: " << std::fixed << std::setprecision(4) << Stats.TotalTime << " ms\n";
         CPUStatTex << "FPS: " << std::setprecision(4) << Stats.FPS << "\n\n";
 
-        // flush scoped time if there is any
-        CPUTimeStats.clear();
-        CPUTimeStats.resize(CPUScopeStats.size());
-        for (size_t Idx = 0; Idx < CPUScopeStats.size(); Idx++)
-        {
-            CPUTimeStats[Idx] << "(" + std::to_string(Idx + 1) + ") " << CPUScopeStats[Idx].first << ": " << std::setprecision(4) << CPUScopeStats[Idx].second << " ms\n";
-        }
+        // flush scoped time of the last frame if there is any
+        SyncCPUScopeStats();
 
         // other CPU stats
         CPUStatTex << "--Misc CPU stats--\n";
         CPUStatTex << "Number of total renderers: " << Stats.RendererCount << "\n";
         CPUStatTex << "Number of draw calls: " << Stats.DrawCallCount << "\n";
-        CPUStatTex << "Number of occlusion tests: " << Stats.OccludedCallCount << "\n";
+        CPUStatTex << "Number of occluded renderers: " << Stats.OccludedCallCount << "\n";
+
+        const char* BuildModeNames[] = { "None", "Refit", "Rebuild" };
+        CPUStatTex << "Number of ray tracing instances: " << Stats.RTInstanceCount << " (" << Stats.RTInstanceMasked << " masked out)\n";
+        CPUStatTex << "Ray tracing instance churn: +" << Stats.RTInstanceAdded << " -" << Stats.RTInstanceRemoved
+            << " ~" << Stats.RTInstanceUpdated << "\n";
+        CPUStatTex << "Ray tracing instance upload: " << Stats.RTInstanceUploadBytes << " bytes in "
+            << Stats.RTInstanceUploadRanges << " ranges\n";
+        CPUStatTex << "Top level AS build: " << BuildModeNames[UH_ENUM_VALUE(Stats.TopLevelASBuildMode)] << "\n";
         CPUStatTex << "Number of graphic states: " << Stats.PSOCount << "\n";
         CPUStatTex << "Shader Variants: " << Stats.ShaderCount << "\n";
         CPUStatTex << "Render Target in use: " << Stats.RTCount << "\n";
@@ -59,21 +59,10 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
         CPUStatTex << std::endl;
 
         // GPU stat section
-        float TotalGPUTime = 0.0f;
         GPUStatTex.str("");
         GPUStatTex.clear();
         GPUStatTex << "--GPU Profiles--\n";
-
-        // iterating all registered GPU time
-        for (size_t Idx = 0; Idx < GPUScopeStats.size(); Idx++)
-        {
-            GPUStatTex << GPUScopeStats[Idx]->GetDebugName() << ": " << std::fixed << std::setprecision(4)
-                << GPUScopeStats[Idx]->GetLastTimeStamp() << " ms\n";
-
-            TotalGPUTime += GPUScopeStats[Idx]->GetLastTimeStamp();
-        }
-
-        GPUStatTex << "Total GPU Time: " << TotalGPUTime << " ms\n";
+        SyncGPUScopeStats(InGPUTimeline);
         GPUStatTex << "Render Resolution: " << InConfig->RenderingSetting().RenderWidth << "x" << InConfig->RenderingSetting().RenderHeight;
 
         InGameTimer->Reset();
@@ -88,20 +77,41 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
         ImGui::TableNextColumn();
         ImGui::Text(CPUStatTex.str().c_str());
 
-        // print time-based cpu stat after regular stat
-        const auto& CPUScopeStats = UHGameTimerScope::GetResiteredGameTime();
-        for (size_t Idx = 0; Idx < CPUScopeStats.size(); Idx++)
+        // CPU profiler controls
+        bool bIsCPUProfilerEnabled = UHCPUProfiler::IsEnabled();
+        if (ImGui::Checkbox("CPU/GPU Profiler", &bIsCPUProfilerEnabled))
+        {
+            UHCPUProfiler::SetEnabled(bIsCPUProfilerEnabled);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export Chrome Trace"))
+        {
+            const std::filesystem::path TracePath = UHCPUProfiler::GetTraceFilePath();
+            std::vector<UHCPUProfileThreadCapture> GPULanes;
+            InGPUTimeline->CaptureLanes(GPULanes);
+            if (UHCPUProfiler::ExportChromeTrace(TracePath, GPULanes))
+            {
+                UHE_LOG("CPU profile is exported to " + TracePath.string() + "\n");
+            }
+        }
+
+        // print time-based cpu stat after regular stat, lanes are printed as headers
+        for (const UHCPUScopeStat& Stat : CPUScopeStats)
         {
             ImVec4 CPUTimeStatColor;
-            if (CPUScopeStats[Idx].second <= 0.1)
+            if (Stat.bIsLane)
+            {
+                CPUTimeStatColor = ImVec4(0, 1, 1, 1);
+            }
+            else if (Stat.TimeMs <= 0.1)
             {
                 CPUTimeStatColor = ImVec4(1, 1, 1, 1);
             }
-            else if (CPUScopeStats[Idx].second > 0.1)
+            else if (Stat.TimeMs > 0.1)
             {
                 CPUTimeStatColor = ImVec4(1, 1, 0, 1);
             }
-            else if (CPUScopeStats[Idx].second > 5)
+            else if (Stat.TimeMs > 5)
             {
                 CPUTimeStatColor = ImVec4(1, 0.6, 0, 1);
             }
@@ -109,7 +119,7 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
             {
                 CPUTimeStatColor = ImVec4(1, 0, 0, 1);
             }
-            ImGui::TextColored(CPUTimeStatColor, CPUTimeStats[Idx].str().c_str());
+            ImGui::TextColored(CPUTimeStatColor, Stat.Text.c_str());
         }
 
         ImGui::TableNextColumn();
@@ -120,4 +130,92 @@ void UHProfileDialog::SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer*
     ImGui::End();
 }
 
+void UHProfileDialog::SyncCPUScopeStats()
+{
+    std::vector<UHCPUProfileThreadCapture> Threads;
+    UHCPUProfiler::CaptureLastFrame(Threads);
+    const double MsPerCount = UHCPUProfiler::GetSecondsPerCount() * 1000.0;
+
+    // scopes of a lane are merged by name and depth, and listed in the order they begin
+    // e.g. jobs of a worker are shown as a single line with the number of jobs
+    CPUScopeStats.clear();
+    for (UHCPUProfileThreadCapture& Thread : Threads)
+    {
+        std::stable_sort(Thread.Events.begin(), Thread.Events.end(), [](const UHCPUProfileEvent& A, const UHCPUProfileEvent& B)
+            {
+                return A.BeginTime < B.BeginTime;
+            });
+
+        const size_t FirstStat = CPUScopeStats.size();
+        std::vector<std::pair<const char*, uint32_t>> StatKeys;
+        std::vector<uint32_t> StatCounts;
+        for (const UHCPUProfileEvent& Event : Thread.Events)
+        {
+            size_t StatIdx = 0;
+            while (StatIdx < StatKeys.size() && (StatKeys[StatIdx].first != Event.Name || StatKeys[StatIdx].second != Event.Depth))
+            {
+                StatIdx++;
+            }
+
+            if (StatIdx == StatKeys.size())
+            {
+                StatKeys.push_back(std::make_pair(Event.Name, Event.Depth));
+                StatCounts.push_back(0);
+                CPUScopeStats.push_back(UHCPUScopeStat{ "", 0.0f, false });
+            }
+
+            UHCPUScopeStat& Stat = CPUScopeStats[FirstStat + StatIdx];
+            StatCounts[StatIdx]++;
+            if (Event.Type == UHCPUProfileEventType::Counter)
+            {
+                // counters show the latest value
+                Stat.TimeMs = 0.0f;
+                Stat.Text = std::string(Event.Depth * 2, ' ') + Event.Name + " = " + std::to_string(static_cast<int64_t>(Event.Value)) + "\n";
+                continue;
+            }
+
+            Stat.TimeMs += static_cast<float>((Event.EndTime - Event.BeginTime) * MsPerCount);
+            std::stringstream StatText;
+            StatText << std::string(Event.Depth * 2, ' ') << Event.Name << ": " << std::fixed << std::setprecision(4) << Stat.TimeMs << " ms";
+            if (StatCounts[StatIdx] > 1)
+            {
+                StatText << " (" << StatCounts[StatIdx] << ")";
+            }
+            StatText << "\n";
+            Stat.Text = StatText.str();
+        }
+
+        if (CPUScopeStats.size() > FirstStat)
+        {
+            CPUScopeStats.insert(CPUScopeStats.begin() + FirstStat, UHCPUScopeStat{ "[" + Thread.ThreadName + "]\n", 0.0f, true });
+        }
+    }
+}
+
+void UHProfileDialog::SyncGPUScopeStats(const UHGPUTimeline* InGPUTimeline)
+{
+    if (!UHCPUProfiler::IsEnabled())
+    {
+        GPUStatTex << "Enable the profiler to record GPU timeline.\n";
+    }
+
+    // stats are grouped by queue already, scopes are indented by depth
+    std::vector<UHGPUScopeStats> GPUScopeStats;
+    InGPUTimeline->GetStats(GPUScopeStats);
+
+    uint32_t CurrentQueue = UINT32_MAX;
+    for (const UHGPUScopeStats& Stat : GPUScopeStats)
+    {
+        if (Stat.QueueIndex != CurrentQueue)
+        {
+            CurrentQueue = Stat.QueueIndex;
+            GPUStatTex << "[" << InGPUTimeline->GetQueueName(CurrentQueue) << "] last / p50 / p95 / p99 ms\n";
+        }
+
+        GPUStatTex << std::string(Stat.Depth * 2, ' ') << Stat.Name << ": " << std::fixed << std::setprecision(4)
+            << Stat.LastMs << " / " << Stat.P50Ms << " / " << Stat.P95Ms << " / " << Stat.P99Ms << "\n";
+    }
+    GPUStatTex << "\n";
+}
+
 #endif
\ No newline at end of file
@@ -4,10 +4,12 @@
 #if WITH_EDITOR
 #include <sstream>
 #include <iomanip>
+#include <vector>
 
 class UHProfiler;
 class UHGameTimer;
 class UHConfigManager;
+class UHGPUTimeline;
 
 class UHProfileDialog : public UHDialog
 {
@@ -15,10 +17,24 @@ public:
 	UHProfileDialog();
 
 	virtual void Update(bool& bIsDialogActive) override {}
-	void SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer* InGameTimer, UHConfigManager* InConfig);
+	void SyncProfileStatistics(UHProfiler* InProfiler, UHGameTimer* InGameTimer, UHConfigManager* InConfig, const UHGPUTimeline* InGPUTimeline);
 	
 
 private:
+	struct UHCPUScopeStat
+	{
+		std::string Text;
+		float TimeMs;
+		bool bIsLane;
+	};
+
+	// collect scope stats of the last frame from UHCPUProfiler
+	void SyncCPUScopeStats();
+
+	// print rolling GPU scope stats of all queues
+	void SyncGPUScopeStats(const UHGPUTimeline* InGPUTimeline);
+
+	std::vector<UHCPUScopeStat> CPUScopeStats;
 	std::stringstream CPUStatTex;
 	std::stringstream GPUStatTex;
 };
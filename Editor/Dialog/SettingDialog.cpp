@@ -72,6 +72,8 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
     ImGui::InputFloat("FPSLimit", &EngineSettings.FPSLimit);
     ImGui::InputFloat("MeshBufferMemoryBudgetMB*", &EngineSettings.MeshBufferMemoryBudgetMB);
     ImGui::InputFloat("ImageMemoryBudgetMB*", &EngineSettings.ImageMemoryBudgetMB);
+    ImGui::Checkbox("Enable Texture Streaming (Game only)*", &EngineSettings.bEnableTextureStreaming);
+    ImGui::InputFloat("TextureStreamingBudgetMB*", &EngineSettings.TextureStreamingBudgetMB);
     ImGui::NewLine();
 
     // rendering settings
@@ -114,8 +116,11 @@ void UHSettingDialog::Update(bool& bIsDialogActive)
         RenderingSettings.bEnableAsyncCompute ? (void)DeferredRenderer->CreateAsyncComputeQueue() : DeferredRenderer->ReleaseAsyncComputeQueue();
     }
 
-    ImGui::Checkbox("Enable Hardware Occlusion", &RenderingSettings.bEnableHardwareOcclusion);
-    ImGui::InputInt("Occlusion triangle threshold", &RenderingSettings.OcclusionTriangleThreshold);
+    ImGui::Checkbox("Enable Occlusion Culling", &RenderingSettings.bEnableOcclusionCulling);
+    ImGui::InputInt("Occluder triangle limit", &RenderingSettings.OccluderTriangleLimit);
+    ImGui::InputInt("Max software occluders", &RenderingSettings.MaxSoftwareOccluders);
+    ImGui::Checkbox("Enable GPU-Driven Rendering (Non-mesh shader)", &RenderingSettings.bEnableGPUDrivenRendering);
+    ImGui::Checkbox("Enable GPU Light Clustering", &RenderingSettings.bEnableGPULightClustering);
 
     ImGui::InputInt("Parallel Threads (Up to 16)*", &RenderingSettings.ParallelThreads);
     ImGui::InputFloat("Final Reflection Strength", &RenderingSettings.FinalReflectionStrength);
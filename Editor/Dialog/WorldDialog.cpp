@@ -7,6 +7,7 @@
 #include "../../Runtime/Components/Transform.h"
 #include "Runtime/Renderer/DeferredShadingRenderer.h"
 #include "../../Runtime/Components/GameScript.h"
+#include <algorithm>
 
 UHWorldDialog::UHWorldDialog(HWND InParentWnd, UHDeferredShadingRenderer* InRenderer)
 	: UHDialog(nullptr, InParentWnd)
@@ -16,6 +17,7 @@ UHWorldDialog::UHWorldDialog(HWND InParentWnd, UHDeferredShadingRenderer* InRend
 	, CurrComponent(nullptr)
 	, bResetWindow(false)
 	, bIsSizeChanged(false)
+	, bScrollToSelected(false)
 {
 
 }
@@ -57,6 +59,13 @@ void UHWorldDialog::Update(bool& bIsDialogActive)
 					ControlSceneObjectDoubleClick();
 				}
 			}
+
+			// scroll to the object selected outside of the list, e.g. picked in the viewport
+			if (bIsSelected && bScrollToSelected)
+			{
+				ImGui::SetScrollHereY();
+				bScrollToSelected = false;
+			}
 		}
 		ImGui::EndListBox();
 	}
@@ -114,6 +123,26 @@ bool UHWorldDialog::IsDialogSizeChanged() const
 	return bIsSizeChanged;
 }
 
+void UHWorldDialog::SelectComponent(UHComponent* InComponent)
+{
+	const auto It = std::find(SceneObjects.begin(), SceneObjects.end(), InComponent);
+	if (It == SceneObjects.end())
+	{
+		// clear selection when nothing is picked
+		CurrentSelected = UHINDEXNONE;
+		CurrComponent = nullptr;
+		if (UHScene* Scene = Renderer->GetCurrentScene())
+		{
+			Scene->SetCurrentSelectedComponent(nullptr);
+		}
+		return;
+	}
+
+	CurrentSelected = static_cast<int32_t>(std::distance(SceneObjects.begin(), It));
+	bScrollToSelected = true;
+	ControlSceneObjectSelect();
+}
+
 void UHWorldDialog::RefreshObjectList()
 {
 	// collect objects
@@ -18,6 +18,7 @@ public:
 	void ResetDialogWindow();
 	ImVec2 GetWindowSize() const;
 	bool IsDialogSizeChanged() const;
+	void SelectComponent(UHComponent* InComponent);
 
 private:
 	void RefreshObjectList();
@@ -31,6 +32,7 @@ private:
 	int32_t CurrentSelected;
 	bool bResetWindow;
 	bool bIsSizeChanged;
+	bool bScrollToSelected;
 
 	UHDeferredShadingRenderer* Renderer;
 	UHComponent* CurrComponent;
@@ -45,7 +45,7 @@ void UHEditor::OnEditorUpdate()
     Input->SetInputEnabled(true);
     ProfileTimer.Tick();
     SettingDialog->Update(bIsDialogActive);
-    ProfileDialog->SyncProfileStatistics(Profile, &ProfileTimer, Config);
+    ProfileDialog->SyncProfileStatistics(Profile, &ProfileTimer, Config, &DeferredRenderer->GetGPUTimeline());
     TextureDialog->Update(bIsDialogActive);
     MaterialDialog->Update(bIsDialogActive);
     CubemapDialog->Update(bIsDialogActive);
@@ -58,8 +58,7 @@ void UHEditor::OnEditorUpdate()
     }
 
     Input->SetInputEnabled(!bIsDialogActive);
-    UHGameTimerScope::ClearRegisteredGameTime();
-    UHGPUTimeQueryScope::ClearRegisteredGPUTime();
+    OnScenePicking();
 }
 
 void UHEditor::OnEditorMove()
@@ -149,6 +148,39 @@ void UHEditor::SelectDebugViewModeMenu(int32_t WmId)
     }
 }
 
+void UHEditor::OnScenePicking()
+{
+    // left click in the main window selects the closest renderer under the cursor, clicks on ImGui windows are skipped
+    if (!Input->IsLeftMouseDown() || ImGui::GetIO().WantCaptureMouse || Config->PresentationSetting().bFullScreen)
+    {
+        return;
+    }
+
+    UHScene* Scene = DeferredRenderer->GetCurrentScene();
+    UHCameraComponent* Camera = (Scene != nullptr) ? Scene->GetMainCamera() : nullptr;
+    if (Camera == nullptr)
+    {
+        return;
+    }
+
+    POINT CursorPos;
+    RECT ClientRect;
+    if (!GetCursorPos(&CursorPos) || !ScreenToClient(HWnd, &CursorPos) || !GetClientRect(HWnd, &ClientRect)
+        || !PtInRect(&ClientRect, CursorPos) || ClientRect.right <= 0 || ClientRect.bottom <= 0)
+    {
+        return;
+    }
+
+    // the ray goes through the pixel center, and the scene BVHs find the closest renderer bound along it
+    const float NDCX = (static_cast<float>(CursorPos.x) + 0.5f) / static_cast<float>(ClientRect.right) * 2.0f - 1.0f;
+    const float NDCY = (static_cast<float>(CursorPos.y) + 0.5f) / static_cast<float>(ClientRect.bottom) * 2.0f - 1.0f;
+
+    float HitDistance;
+    UHMeshRendererComponent* HitRenderer = Scene->RayCast(Camera->GetPosition(), Camera->GetRayDirection(NDCX, NDCY)
+        , Camera->GetCullingDistance(), HitDistance);
+    WorldDialog->SelectComponent(HitRenderer);
+}
+
 void UHEditor::OnSaveScene()
 {
     if (!std::filesystem::exists(GSceneAssetPath))
@@ -38,6 +38,7 @@ private:
 	void SelectDebugViewModeMenu(int32_t WmId);
 	void OnSaveScene();
 	void OnLoadScene();
+	void OnScenePicking();
 
 	HINSTANCE HInstance;
 	HWND HWnd;
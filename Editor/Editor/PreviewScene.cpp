@@ -37,7 +37,7 @@ UHPreviewScene::UHPreviewScene(UHGraphic* InGraphic, UHPreviewSceneType InType)
 	PreviewCamera = MakeUnique<UHCameraComponent>();
 	PreviewCamera->Update();
 
-	MeshPreviewData = Gfx->RequestRenderBuffer<float>(1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, "MeshPreviewData");
+	MeshPreviewData = Gfx->RequestRenderBuffer<UHMeshPreviewConstants>(1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, "MeshPreviewData");
 	MeshPreviewShader->BindConstant(MeshPreviewData, 0, 0, 0);
 }
 
@@ -72,9 +72,15 @@ void UHPreviewScene::Render(bool bIsActive)
 		MeshPreviewShader = MakeUnique<UHMeshPreviewShader>(Gfx, "MeshPreviewShader", PreviewRenderPass.RenderPass);
 	}
 
-	XMFLOAT4X4 ViewProj = PreviewCamera->GetViewProjMatrixNonJittered();
-	MeshPreviewData->UploadData(&ViewProj, 0);
+	const BoundingBox MeshBound = CurrentMesh->GetMeshBound();
+	UHMeshPreviewConstants PreviewConstants{};
+	PreviewConstants.ViewProj = PreviewCamera->GetViewProjMatrixNonJittered();
+	PreviewConstants.MeshBoundCenter = MeshBound.Center;
+	PreviewConstants.VertexFormat = UH_ENUM_VALUE_U(CurrentMesh->GetVertexFormat());
+	PreviewConstants.MeshBoundExtent = MeshBound.Extents;
+	MeshPreviewData->UploadData(&PreviewConstants, 0);
 	MeshPreviewShader->BindConstant(MeshPreviewData, 0, 0, 0);
+	MeshPreviewShader->BindStorage(CurrentMesh->GetPositionBuffer(), 1, 0, true);
 
 	VkCommandBuffer PreviewCmd = Gfx->BeginOneTimeCmd();
 	UHRenderBuilder PreviewBuilder(Gfx, PreviewCmd);
@@ -89,7 +95,7 @@ void UHPreviewScene::Render(bool bIsActive)
 	// render based on the preview scene type
 	PreviewBuilder.SetViewport(PreviewExtent);
 	PreviewBuilder.SetScissor(PreviewExtent);
-	PreviewBuilder.BindVertexBuffer(CurrentMesh->GetPositionBuffer()->GetBuffer());
+	PreviewBuilder.BindVertexBuffer(nullptr);
 	PreviewBuilder.BindIndexBuffer(CurrentMesh);
 	PreviewBuilder.BindDescriptorSet(MeshPreviewShader->GetPipelineLayout(), MeshPreviewShader->GetDescriptorSet(0));
 
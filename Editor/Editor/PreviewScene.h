@@ -36,7 +36,7 @@ private:
 	// shaders
 	UniquePtr<UHMeshPreviewShader> MeshPreviewShader;
 	UniquePtr<UHCameraComponent> PreviewCamera;
-	UniquePtr<UHRenderBuffer<float>> MeshPreviewData;
+	UniquePtr<UHRenderBuffer<UHMeshPreviewConstants>> MeshPreviewData;
 
 	UHMesh* CurrentMesh;
 	ImVec2 CurrentMousePos;
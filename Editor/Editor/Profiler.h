@@ -3,6 +3,7 @@
 #include "../../Runtime/Engine/GameTimer.h"
 #include <unordered_map>
 #include "../../Runtime/Renderer/RenderingTypes.h"
+#include "../../Runtime/Classes/TopLevelInstanceTracker.h"
 
 struct UHStatistics
 {
@@ -15,6 +16,14 @@ public:
 		, RendererCount(0)
 		, DrawCallCount(0)
 		, OccludedCallCount(0)
+		, RTInstanceCount(0)
+		, RTInstanceMasked(0)
+		, RTInstanceAdded(0)
+		, RTInstanceRemoved(0)
+		, RTInstanceUpdated(0)
+		, RTInstanceUploadBytes(0)
+		, RTInstanceUploadRanges(0)
+		, TopLevelASBuildMode(UHTopLevelBuildMode::None)
 		, PSOCount(0)
 		, ShaderCount(0)
 		, RTCount(0)
@@ -34,6 +43,14 @@ public:
 	int32_t RendererCount;
 	int32_t DrawCallCount;
 	int32_t OccludedCallCount;
+	int32_t RTInstanceCount;
+	int32_t RTInstanceMasked;
+	int32_t RTInstanceAdded;
+	int32_t RTInstanceRemoved;
+	int32_t RTInstanceUpdated;
+	int32_t RTInstanceUploadBytes;
+	int32_t RTInstanceUploadRanges;
+	UHTopLevelBuildMode TopLevelASBuildMode;
 	int32_t PSOCount;
 	int32_t ShaderCount;
 	int32_t RTCount;
@@ -0,0 +1,83 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../Classes/GeometryUtility.h"
+#include "../../Runtime/Engine/Asset.h"
+#include "../../Runtime/Classes/Scene.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include <chrono>
+#include <fstream>
+
+// exports the given number of small mesh assets to a temp folder and imports them, then saves a scene referencing all of them
+// and reloads it, reports the time of UHScene::OnPostLoad which resolves every reference by UUID
+void BenchmarkScenePostLoad(const uint32_t AssetCount)
+{
+	const std::filesystem::path BenchmarkFolder = std::filesystem::temp_directory_path() / "UHBenchmarkPostLoad";
+	std::filesystem::remove_all(BenchmarkFolder);
+	std::filesystem::create_directories(BenchmarkFolder);
+	const std::filesystem::path ScenePath = BenchmarkFolder / "BenchmarkScene.uhscene";
+
+	for (uint32_t Idx = 0; Idx < AssetCount; Idx++)
+	{
+		// every mesh gets its own UUID when it's created
+		UHMesh Mesh = UHGeometryHelper::CreateCubeMesh();
+		Mesh.SetName("BenchmarkMesh" + std::to_string(Idx));
+		Mesh.Export(BenchmarkFolder / (Mesh.GetName() + GMeshAssetExtension));
+	}
+
+	UniquePtr<UHAssetManager> AssetMgr = MakeUnique<UHAssetManager>();
+	const std::chrono::steady_clock::time_point ImportStartTime = std::chrono::steady_clock::now();
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(BenchmarkFolder))
+	{
+		if (Entry.path().extension().string() == GMeshAssetExtension)
+		{
+			AssetMgr->ImportAssetAsync(Entry.path());
+		}
+	}
+	AssetMgr->WaitAsyncLoads();
+	const double ImportSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - ImportStartTime).count();
+
+	// one renderer per imported mesh, the scene file stores the mesh UUIDs only
+	{
+		UHScene SourceScene;
+		for (UHMesh* Mesh : AssetMgr->GetUHMeshes())
+		{
+			UHMeshRendererComponent* Renderer = (UHMeshRendererComponent*)SourceScene.RequestComponent(UHMeshRendererComponent::ClassId);
+			Renderer->SetMesh(Mesh);
+		}
+
+		std::ofstream FileOut(ScenePath.string().c_str(), std::ios::out | std::ios::binary);
+		SourceScene.OnSave(FileOut);
+		FileOut.close();
+	}
+
+	UHScene Scene;
+	std::ifstream FileIn(ScenePath.string().c_str(), std::ios::in | std::ios::binary);
+	Scene.OnLoad(FileIn);
+	FileIn.close();
+
+	const std::chrono::steady_clock::time_point PostLoadStartTime = std::chrono::steady_clock::now();
+	Scene.OnPostLoad(AssetMgr.get());
+	const double PostLoadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - PostLoadStartTime).count();
+
+	uint32_t ResolvedCount = 0;
+	for (const UniquePtr<UHComponent>& Comp : Scene.GetAllCompoments())
+	{
+		if (Comp->GetObjectClassId() == UHMeshRendererComponent::ClassId && ((UHMeshRendererComponent*)Comp.get())->GetMesh() != nullptr)
+		{
+			ResolvedCount++;
+		}
+	}
+
+	const std::wstring Summary = L"Imported " + std::to_wstring(AssetMgr->GetUHMeshes().size()) + L" assets in " + std::to_wstring(ImportSeconds)
+		+ L" s, scene post load resolved " + std::to_wstring(ResolvedCount) + L"/" + std::to_wstring(AssetCount) + L" renderers in "
+		+ std::to_wstring(PostLoadSeconds * 1000.0) + L" ms\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+
+	AssetMgr->Release();
+	AssetMgr.reset();
+	std::filesystem::remove_all(BenchmarkFolder);
+}
+
+#endif
@@ -0,0 +1,342 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Engine/Engine.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include <shellapi.h>
+#include <atomic>
+
+// tests can check from worker threads
+static std::atomic<uint32_t> GNumToolCheckFailures(0);
+
+bool UHToolCheck(const bool bCondition, const wchar_t* InExpression, const wchar_t* InFile, const int32_t InLine)
+{
+	if (!bCondition)
+	{
+		GNumToolCheckFailures++;
+		const std::wstring Message = L"Check failed: " + std::wstring(InExpression) + L" at " + std::wstring(InFile) + L"("
+			+ std::to_wstring(InLine) + L")\n";
+		UHE_LOG(Message);
+		wprintf(L"%ls", Message.c_str());
+	}
+
+	return bCondition;
+}
+
+uint32_t GetNumToolCheckFailures()
+{
+	return GNumToolCheckFailures.load();
+}
+
+//
+//  FUNCTION: RunCommandLine(LPWSTR, int32_t&)
+//
+//  PURPOSE: Runs the command line tools, returns true if a tool is executed.
+//           The exit code is the number of failed checks of the tool.
+//
+//  -testjobsystem: stress tests parallel-for coverage, dependency ordering and external threads of the job system
+//  -benchmarkjobsystem [items]: runs uneven and light parallel stages with the job system and the previous UHThread path (default to 100000 items)
+//                               and reports the time per stage of both
+//  -testfrustumculling: validates the culling kernels against BoundingFrustum::Contains() and the range and camera inside tests
+//  -benchmarkfrustumculling [boxes]: culls increasing box counts up to the number (default to 1000000 boxes) with DirectXCollision
+//                                    and each culling kernel on one and all threads, and reports the time per box
+//  -benchmarkbvh [items]: builds, refits and queries the scene BVH with increasing item counts up to the number (default to 1000000 items)
+//                         and validates the frustum, sphere and ray queries against testing every item
+//  -optimizemeshes [folder]: re-optimizes all .uhmesh assets under the folder (default to mesh asset folder)
+//                            and reports ACMR before and after
+//  -benchmarkmeshload [folder]: imports all .uhmesh assets under the folder (default to mesh asset folder)
+//                               and reports load throughput and peak RSS
+//  -testmeshlets [folder]: validates the meshlet builder with a generated grid and the stored meshlets of all .uhmesh assets under the folder
+//                          (default to mesh asset folder), and reports the ACMR and ATVR of meshlets
+//  -testvertexcompression [folder]: checks the vertex compression codecs against their error bounds with generated streams
+//                                   and the compressed .uhmesh assets under the folder (default to mesh asset folder)
+//  -benchmarkpostload [count]: builds a scene referencing the number of mesh assets (default to 20000)
+//                              and reports the time of scene post load
+//  -importtextures [source folder] [output folder] [-force]: imports all images under the source folder (default to raw texture folder)
+//                                                            to the output folder (default to texture asset folder),
+//                                                            sources with unchanged content are skipped unless -force is given
+//  -simulatestreaming [frames] [budget MB]: runs the texture residency policy along a camera path (default to 3600 frames and 256 MB)
+//                                           and reports the budget vs. requested memory
+//  -benchmarkallocator [operations]: fuzzes the GPU memory sub-allocator on the CPU (default to 1000000 operations)
+//                                    and reports the throughput and fragmentation
+//  -benchmarkshadercache [compile ms]: compiles all shaders with a stub compiler through the shader cache (default to 50 ms per compile)
+//                                      and reports the cache hit rate and compile wall time of cold and warm passes
+//  -benchmarkinstancing [renderers]: batches the visible renderers of a forest-style scene (default to 100000 renderers)
+//                                    and reports the draw calls and recording time with and without instancing
+//  -benchmarkindirectdraw [renderers]: culls and compacts a city-style scene with the CPU reference of GPU culling (default to 100000 renderers)
+//                                      and validates the indirect draws against the camera frustum
+//  -benchmarkocclusion [boxes]: rasterizes walls into the software occlusion buffer and tests the number of boxes per view (default to 10000)
+//                               and reports the SSE vs. reference rasterization time and the false occlusion rate
+//  -benchmarktlas [renderers]: maintains top-level AS instances of a city-style scene with moving renderers (default to 100000 renderers)
+//                              and reports the upload size and update time of incremental vs. full instance updates
+//  -benchmarkprofiler [scopes]: records nested CPU profiler scopes on the main and worker threads (default to 1000000 scopes per thread)
+//                               and reports the cost per scope, then validates captures and the Chrome trace export
+//  -benchmarkgputimeline [frames]: feeds synthetic timestamp streams of two queues with clock drift and wrap around (default to 2000 frames)
+//                                  and validates the percentiles, the CPU time mapping and the trace export of the GPU timeline
+//  -benchmarkframe [renderers] [frames]: runs the CPU stages of frames on a headless engine with the null graphics backend along a camera path
+//                                        (default to 20000 renderers and 300 frames), and exports per-stage times and allocations to JSON,
+//                                        allocations are counted by debug builds or builds with WITH_ALLOCATION_COUNTING defined
+//  -benchmarklightcluster [lights]: assigns lights to clusters with increasing light counts up to the number (default to 65536 lights)
+//                                   and reports the SIMD vs. scalar time, then validates the ranges and the compact lists
+//
+bool RunCommandLine(LPWSTR lpCmdLine, int32_t& OutExitCode)
+{
+	int32_t ArgCount = 0;
+	LPWSTR* Args = CommandLineToArgvW(lpCmdLine, &ArgCount);
+	if (Args == nullptr)
+	{
+		return false;
+	}
+
+	bool bHasRun = false;
+	for (int32_t Idx = 0; Idx < ArgCount; Idx++)
+	{
+		const bool bTestJobSystem = _wcsicmp(Args[Idx], L"-testjobsystem") == 0;
+		const bool bBenchmarkJobSystem = _wcsicmp(Args[Idx], L"-benchmarkjobsystem") == 0;
+		const bool bTestFrustumCulling = _wcsicmp(Args[Idx], L"-testfrustumculling") == 0;
+		const bool bBenchmarkFrustumCulling = _wcsicmp(Args[Idx], L"-benchmarkfrustumculling") == 0;
+		const bool bBenchmarkBVH = _wcsicmp(Args[Idx], L"-benchmarkbvh") == 0;
+		const bool bOptimizeMeshes = _wcsicmp(Args[Idx], L"-optimizemeshes") == 0;
+		const bool bBenchmarkMeshLoad = _wcsicmp(Args[Idx], L"-benchmarkmeshload") == 0;
+		const bool bTestMeshlets = _wcsicmp(Args[Idx], L"-testmeshlets") == 0;
+		const bool bTestVertexCompression = _wcsicmp(Args[Idx], L"-testvertexcompression") == 0;
+		const bool bBenchmarkPostLoad = _wcsicmp(Args[Idx], L"-benchmarkpostload") == 0;
+		const bool bImportTextures = _wcsicmp(Args[Idx], L"-importtextures") == 0;
+		const bool bSimulateStreaming = _wcsicmp(Args[Idx], L"-simulatestreaming") == 0;
+		const bool bBenchmarkAllocator = _wcsicmp(Args[Idx], L"-benchmarkallocator") == 0;
+		const bool bBenchmarkShaderCache = _wcsicmp(Args[Idx], L"-benchmarkshadercache") == 0;
+		const bool bBenchmarkInstancing = _wcsicmp(Args[Idx], L"-benchmarkinstancing") == 0;
+		const bool bBenchmarkIndirectDraw = _wcsicmp(Args[Idx], L"-benchmarkindirectdraw") == 0;
+		const bool bBenchmarkOcclusion = _wcsicmp(Args[Idx], L"-benchmarkocclusion") == 0;
+		const bool bBenchmarkTopLevelAS = _wcsicmp(Args[Idx], L"-benchmarktlas") == 0;
+		const bool bBenchmarkProfiler = _wcsicmp(Args[Idx], L"-benchmarkprofiler") == 0;
+		const bool bBenchmarkGPUTimeline = _wcsicmp(Args[Idx], L"-benchmarkgputimeline") == 0;
+		const bool bBenchmarkFrame = _wcsicmp(Args[Idx], L"-benchmarkframe") == 0;
+		const bool bBenchmarkLightCluster = _wcsicmp(Args[Idx], L"-benchmarklightcluster") == 0;
+		if (!bTestJobSystem && !bBenchmarkJobSystem && !bTestFrustumCulling && !bBenchmarkFrustumCulling && !bBenchmarkBVH
+			&& !bOptimizeMeshes && !bBenchmarkMeshLoad && !bTestMeshlets && !bTestVertexCompression && !bBenchmarkPostLoad && !bImportTextures
+			&& !bSimulateStreaming && !bBenchmarkAllocator && !bBenchmarkShaderCache && !bBenchmarkInstancing && !bBenchmarkIndirectDraw && !bBenchmarkOcclusion && !bBenchmarkTopLevelAS
+			&& !bBenchmarkProfiler && !bBenchmarkGPUTimeline && !bBenchmarkFrame && !bBenchmarkLightCluster)
+		{
+			continue;
+		}
+
+		// report to the console which launched the engine, if any
+		FILE* ConsoleOut = nullptr;
+		if (AttachConsole(ATTACH_PARENT_PROCESS))
+		{
+			freopen_s(&ConsoleOut, "CONOUT$", "w", stdout);
+		}
+
+		std::filesystem::path MeshFolder = (Idx + 1 < ArgCount) ? std::filesystem::path(Args[Idx + 1]) : std::filesystem::path(GMeshAssetFolder);
+		if (bTestJobSystem)
+		{
+			TestJobSystem();
+		}
+		else if (bBenchmarkJobSystem)
+		{
+			const uint32_t NumItems = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 100000;
+			BenchmarkJobSystem((std::max)(NumItems, 1u));
+		}
+		else if (bTestFrustumCulling)
+		{
+			TestFrustumCulling();
+		}
+		else if (bBenchmarkFrustumCulling)
+		{
+			const uint32_t NumBoxes = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 1000000;
+			BenchmarkFrustumCulling((std::max)(NumBoxes, 1u));
+		}
+		else if (bBenchmarkBVH)
+		{
+			const uint32_t NumItems = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 1000000;
+			BenchmarkBVH((std::max)(NumItems, 1u));
+		}
+		else if (bImportTextures)
+		{
+			// folder arguments are optional, and -force can be anywhere after the flag
+			std::vector<std::filesystem::path> Folders;
+			bool bForce = false;
+			for (int32_t ArgIdx = Idx + 1; ArgIdx < ArgCount; ArgIdx++)
+			{
+				if (_wcsicmp(Args[ArgIdx], L"-force") == 0)
+				{
+					bForce = true;
+				}
+				else if (Args[ArgIdx][0] != L'-')
+				{
+					Folders.push_back(Args[ArgIdx]);
+				}
+			}
+
+			const std::filesystem::path SourceFolder = (Folders.size() > 0) ? Folders[0] : std::filesystem::path(GRawTextureAssetPath);
+			const std::filesystem::path OutputFolder = (Folders.size() > 1) ? Folders[1] : std::filesystem::path(GTextureAssetFolder);
+			if (!std::filesystem::is_directory(SourceFolder))
+			{
+				wprintf(L"%ls is not a folder!\n", SourceFolder.wstring().c_str());
+			}
+			else
+			{
+				ImportTextures(SourceFolder, OutputFolder, bForce);
+			}
+		}
+		else if (bBenchmarkAllocator)
+		{
+			const uint32_t NumOperations = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 1000000;
+			BenchmarkGPUAllocator((std::max)(NumOperations, 1u));
+		}
+		else if (bBenchmarkInstancing)
+		{
+			const uint32_t NumRenderers = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 100000;
+			BenchmarkInstancing((std::max)(NumRenderers, 1u));
+		}
+		else if (bBenchmarkIndirectDraw)
+		{
+			const uint32_t NumRenderers = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 100000;
+			BenchmarkIndirectDraw((std::max)(NumRenderers, 1u));
+		}
+		else if (bBenchmarkOcclusion)
+		{
+			const uint32_t NumBoxes = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 10000;
+			BenchmarkOcclusion((std::max)(NumBoxes, 1u));
+		}
+		else if (bBenchmarkTopLevelAS)
+		{
+			const uint32_t NumRenderers = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 100000;
+			BenchmarkTopLevelAS((std::max)(NumRenderers, 1u));
+		}
+		else if (bBenchmarkProfiler)
+		{
+			const uint32_t NumScopes = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 1000000;
+			BenchmarkCPUProfiler((std::max)(NumScopes, 2u));
+		}
+		else if (bBenchmarkGPUTimeline)
+		{
+			const uint32_t NumFrames = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 2000;
+			BenchmarkGPUTimeline((std::max)(NumFrames, 1u));
+		}
+		else if (bBenchmarkFrame)
+		{
+			const uint32_t NumRenderers = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 20000;
+			const uint32_t NumFrames = (Idx + 2 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 2])) : 300;
+			BenchmarkFrame((std::max)(NumRenderers, 1u), (std::max)(NumFrames, 1u));
+		}
+		else if (bBenchmarkLightCluster)
+		{
+			const uint32_t NumLights = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 65536;
+			BenchmarkLightClustering((std::max)(NumLights, 1u));
+		}
+		else if (bBenchmarkShaderCache)
+		{
+			const uint32_t CompileTimeMs = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 50;
+			BenchmarkShaderCache(CompileTimeMs);
+		}
+		else if (bSimulateStreaming)
+		{
+			const uint32_t NumFrames = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 3600;
+			const uint32_t BudgetMB = (Idx + 2 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 2])) : 256;
+			SimulateTextureStreaming((std::max)(NumFrames, 1u), static_cast<uint64_t>((std::max)(BudgetMB, 1u)) * 1048576);
+		}
+		else if (bBenchmarkPostLoad)
+		{
+			const uint32_t AssetCount = (Idx + 1 < ArgCount) ? static_cast<uint32_t>(_wtoi(Args[Idx + 1])) : 20000;
+			BenchmarkScenePostLoad((std::max)(AssetCount, 1u));
+		}
+		else if (!std::filesystem::is_directory(MeshFolder))
+		{
+			wprintf(L"%ls is not a folder!\n", MeshFolder.wstring().c_str());
+		}
+		else if (bOptimizeMeshes)
+		{
+			OptimizeMeshes(MeshFolder);
+		}
+		else if (bTestMeshlets)
+		{
+			TestMeshlets(MeshFolder);
+		}
+		else if (bTestVertexCompression)
+		{
+			TestVertexCompression(MeshFolder);
+		}
+		else
+		{
+			BenchmarkMeshLoad(MeshFolder);
+		}
+
+		if (ConsoleOut)
+		{
+			fclose(ConsoleOut);
+		}
+		bHasRun = true;
+		break;
+	}
+
+	LocalFree(Args);
+	OutExitCode = static_cast<int32_t>(GetNumToolCheckFailures());
+	return bHasRun;
+}
+
+//
+//  FUNCTION: RunEngineCommandLine(LPWSTR, UHEngine*, int32_t&)
+//
+//  PURPOSE: Runs the command line tools after the engine is initialized, returns true if a tool is executed.
+//           The exit code is the number of failed checks of the tool.
+//
+//  -benchmarkmaterialrefresh: refreshes a fixed scene of 2000 materials with the linear pools and the resource pools
+//                             and reports both, then refreshes shaders of all materials in the startup scene and reports the time,
+//                             this requests every material shader and graphic state from the pools again
+//  -benchmarkbc: compresses a fixed test set with CPU and GPU block compression, reports MPixels/s and PSNR
+//
+bool RunEngineCommandLine(LPWSTR lpCmdLine, UHEngine* InEngine, int32_t& OutExitCode)
+{
+	int32_t ArgCount = 0;
+	LPWSTR* Args = CommandLineToArgvW(lpCmdLine, &ArgCount);
+	if (Args == nullptr)
+	{
+		return false;
+	}
+
+	bool bHasRun = false;
+	for (int32_t Idx = 0; Idx < ArgCount; Idx++)
+	{
+		const bool bBenchmarkMaterialRefresh = _wcsicmp(Args[Idx], L"-benchmarkmaterialrefresh") == 0;
+		const bool bBenchmarkBC = _wcsicmp(Args[Idx], L"-benchmarkbc") == 0;
+		if (!bBenchmarkMaterialRefresh && !bBenchmarkBC)
+		{
+			continue;
+		}
+
+		FILE* ConsoleOut = nullptr;
+		if (AttachConsole(ATTACH_PARENT_PROCESS))
+		{
+			freopen_s(&ConsoleOut, "CONOUT$", "w", stdout);
+		}
+
+		if (bBenchmarkBC)
+		{
+			BenchmarkTextureCompression(InEngine->GetGfx());
+		}
+		else
+		{
+			BenchmarkMaterialRefreshPools(2000);
+
+			UHDeferredShadingRenderer* SceneRenderer = InEngine->GetSceneRenderer();
+			const size_t MaterialCount = SceneRenderer->GetCurrentScene() ? SceneRenderer->GetCurrentScene()->GetMaterials().size() : 0;
+			const double ElapsedMs = SceneRenderer->BenchmarkRefreshMaterialShaders();
+			wprintf(L"Refreshed shaders of %zu materials in %f ms\n", MaterialCount, ElapsedMs);
+		}
+
+		if (ConsoleOut)
+		{
+			fclose(ConsoleOut);
+		}
+		bHasRun = true;
+		break;
+	}
+
+	LocalFree(Args);
+	OutExitCode = static_cast<int32_t>(GetNumToolCheckFailures());
+	return bHasRun;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#include "../../UnheardEngine.h"
+
+#if WITH_EDITOR
+class UHEngine;
+class UHGraphic;
+
+// command line tools of the editor, RunCommandLine dispatches the tools which run without creating the engine
+// and RunEngineCommandLine dispatches the ones which need an initialized engine, both return true if a tool is executed
+// the exit code is the number of failed checks
+bool RunCommandLine(LPWSTR lpCmdLine, int32_t& OutExitCode);
+bool RunEngineCommandLine(LPWSTR lpCmdLine, UHEngine* InEngine, int32_t& OutExitCode);
+
+// checks a condition of the command line tests, a failure is reported with the expression and the location
+#define UH_TOOL_WIDEN_INTERNAL(x) L ## x
+#define UH_TOOL_WIDEN(x) UH_TOOL_WIDEN_INTERNAL(x)
+#define UH_TOOL_CHECK(Condition) UHToolCheck((Condition), UH_TOOL_WIDEN(#Condition), __FILEW__, __LINE__)
+bool UHToolCheck(const bool bCondition, const wchar_t* InExpression, const wchar_t* InFile, const int32_t InLine);
+uint32_t GetNumToolCheckFailures();
+
+// JobSystemTools.cpp
+void TestJobSystem();
+void BenchmarkJobSystem(const uint32_t NumItems);
+
+// MeshTools.cpp
+void OptimizeMeshes(const std::filesystem::path& MeshFolder);
+void BenchmarkMeshLoad(const std::filesystem::path& MeshFolder);
+void TestMeshlets(const std::filesystem::path& MeshFolder);
+void TestVertexCompression(const std::filesystem::path& MeshFolder);
+
+// AssetTools.cpp
+void BenchmarkScenePostLoad(const uint32_t AssetCount);
+
+// TextureTools.cpp
+void BenchmarkTextureCompression(UHGraphic* InGfx);
+void ImportTextures(const std::filesystem::path& SourceFolder, const std::filesystem::path& OutputFolder, const bool bForce);
+void SimulateTextureStreaming(const uint32_t NumFrames, const uint64_t BudgetBytes);
+
+// GPUMemoryTools.cpp
+void BenchmarkGPUAllocator(const uint32_t NumOperations);
+
+// ShaderTools.cpp
+void BenchmarkShaderCache(const uint32_t CompileTimeMs);
+void BenchmarkMaterialRefreshPools(const uint32_t NumMaterials);
+
+// InstancingTools.cpp
+void BenchmarkInstancing(const uint32_t NumRenderers);
+
+// CullingTools.cpp
+void TestFrustumCulling();
+void BenchmarkFrustumCulling(const uint32_t MaxBoxes);
+void BenchmarkBVH(const uint32_t MaxItems);
+void BenchmarkIndirectDraw(const uint32_t NumRenderers);
+void BenchmarkOcclusion(const uint32_t NumBoxes);
+
+// RayTracingTools.cpp
+void BenchmarkTopLevelAS(const uint32_t NumRenderers);
+
+// ProfilerTools.cpp
+void BenchmarkCPUProfiler(const uint32_t NumScopes);
+void BenchmarkGPUTimeline(const uint32_t NumFrames);
+
+// FrameTools.cpp
+void BenchmarkFrame(const uint32_t NumRenderers, const uint32_t NumFrames);
+
+// LightingTools.cpp
+void BenchmarkLightClustering(const uint32_t MaxLights);
+
+#endif
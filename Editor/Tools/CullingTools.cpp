@@ -0,0 +1,810 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/BoundingVolumeHierarchy.h"
+#include "../../Runtime/Classes/IndirectDrawBuilder.h"
+#include "../../Runtime/Classes/FrustumCulling.h"
+#include "../../Runtime/Classes/JobSystem.h"
+#include "../../Runtime/Classes/Material.h"
+#include "../../Runtime/Classes/MeshGeometryPool.h"
+#include "../../Runtime/Classes/SoftwareOcclusion.h"
+#include <chrono>
+
+// boxes close to a plane can be classified differently by DirectXCollision and the culling kernels due to float rounding
+// a mismatch is only an error when the box isn't within the tolerance of any plane
+static bool IsNearFrustumPlane(const UHCullingPlanes& InPlanes, const BoundingBox& InBox)
+{
+	for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes; PlaneIdx++)
+	{
+		const float Dist = InPlanes.NormalX[PlaneIdx] * InBox.Center.x + InPlanes.NormalY[PlaneIdx] * InBox.Center.y
+			+ InPlanes.NormalZ[PlaneIdx] * InBox.Center.z + InPlanes.Distance[PlaneIdx];
+		const float Radius = std::abs(InPlanes.NormalX[PlaneIdx]) * InBox.Extents.x + std::abs(InPlanes.NormalY[PlaneIdx]) * InBox.Extents.y
+			+ std::abs(InPlanes.NormalZ[PlaneIdx]) * InBox.Extents.z;
+		if (std::abs(Dist - Radius) <= 1e-4f * (std::max)(1.0f, std::abs(Dist) + Radius))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// boxes of a test scene, mostly small ones with a few huge ones and flat or zero-sized ones
+static std::vector<BoundingBox> CreateCullingTestBoxes(const uint32_t NumBoxes, uint32_t Seed)
+{
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	std::vector<BoundingBox> Boxes(NumBoxes);
+	for (BoundingBox& Box : Boxes)
+	{
+		Box.Center = XMFLOAT3((NextRandom() % 20001) * 0.1f - 1000.0f, (NextRandom() % 2001) * 0.1f - 100.0f, (NextRandom() % 20001) * 0.1f - 1000.0f);
+		const uint32_t SizeRoll = NextRandom() % 100;
+		const float Size = (SizeRoll == 0) ? 500.0f : (SizeRoll == 1) ? 0.0f : 0.5f + (NextRandom() % 200) * 0.1f;
+		Box.Extents = XMFLOAT3(Size, (SizeRoll == 2) ? 0.0f : Size * 0.5f, Size);
+	}
+
+	return Boxes;
+}
+
+// camera frustums of the culling test and benchmark, all yaws around the center with a few pitches, near and far planes
+static std::vector<BoundingFrustum> CreateCullingTestFrustums(const uint32_t NumViews)
+{
+	std::vector<BoundingFrustum> Frustums(NumViews);
+	for (uint32_t Idx = 0; Idx < NumViews; Idx++)
+	{
+		const float Yaw = XM_2PI * Idx / NumViews;
+		const float Pitch = XMConvertToRadians(static_cast<float>(Idx % 5) * 15.0f - 30.0f);
+		const float FarPlane = (Idx % 3 == 0) ? 300.0f : 2000.0f;
+		const XMFLOAT3 Position(std::sin(Yaw) * 200.0f, 20.0f, std::cos(Yaw) * 200.0f);
+
+		BoundingFrustum::CreateFromMatrix(Frustums[Idx], XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, FarPlane));
+		Frustums[Idx].Transform(Frustums[Idx], 1.0f, XMQuaternionRotationRollPitchYaw(Pitch, Yaw, 0.0f), XMLoadFloat3(&Position));
+	}
+
+	return Frustums;
+}
+
+// validates every culling kernel the CPU supports against BoundingFrustum::Contains(), the box distance and range tests
+// and the camera inside test of each box, the box count isn't a multiple of 32 so the last word is partial
+void TestFrustumCulling()
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	const uint32_t NumBoxes = 100003;
+	const float RangeRadius = 150.0f;
+	const std::vector<BoundingBox> Boxes = CreateCullingTestBoxes(NumBoxes, 12345);
+	const std::vector<BoundingFrustum> Frustums = CreateCullingTestFrustums(16);
+
+	UHCullingBounds Bounds;
+	Bounds.Resize(NumBoxes);
+	for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+	{
+		Bounds.SetBound(static_cast<int32_t>(Idx), Boxes[Idx]);
+	}
+
+	std::wstring Summary = L"Frustum culling test, " + std::to_wstring(NumBoxes) + L" boxes, " + std::to_wstring(Frustums.size()) + L" views\n";
+	for (int32_t Level = 0; Level <= UH_ENUM_VALUE(UHFrustumCulling::GetSIMDLevel()); Level++)
+	{
+		uint32_t NumVisible = 0;
+		uint32_t NumNearPlane = 0;
+		uint32_t NumVisibleErrors = 0;
+		uint32_t NumRangeErrors = 0;
+		uint32_t NumInsideErrors = 0;
+		uint32_t NumPreviousErrors = 0;
+		for (const BoundingFrustum& Frustum : Frustums)
+		{
+			const UHCullingPlanes Planes = UHFrustumCulling::BuildPlanes(Frustum);
+			const std::vector<uint32_t> LastBits = [&Bounds]()
+				{
+					std::vector<uint32_t> Bits(Bounds.VisibleBits.size());
+					for (size_t WordIdx = 0; WordIdx < Bits.size(); WordIdx++)
+					{
+						Bits[WordIdx] = Bounds.VisibleBits[WordIdx] | Bounds.InRangeBits[WordIdx];
+					}
+					return Bits;
+				}();
+
+			UHFrustumCulling::CullBounds(static_cast<UHCullingSIMDLevel>(Level), Planes, Frustum.Origin, RangeRadius, Bounds, 0, Bounds.GetWordCount());
+			NumPreviousErrors += (Bounds.PreviousBits != LastBits) ? 1 : 0;
+
+			for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+			{
+				const BoundingBox& Box = Boxes[Idx];
+				const bool bExpected = Frustum.Contains(Box) != DISJOINT;
+				const bool bVisible = Bounds.IsVisible(static_cast<int32_t>(Idx));
+				const bool bNearPlane = (bExpected != bVisible) && IsNearFrustumPlane(Planes, Box);
+				NumVisible += bVisible ? 1 : 0;
+				NumNearPlane += bNearPlane ? 1 : 0;
+				NumVisibleErrors += (bExpected != bVisible && !bNearPlane) ? 1 : 0;
+
+				// distance from the camera to the closest point of the box
+				const XMVECTOR Offset = XMVectorMax(XMVectorAbs(XMLoadFloat3(&Box.Center) - XMLoadFloat3(&Frustum.Origin)) - XMLoadFloat3(&Box.Extents)
+					, XMVectorZero());
+				const float SqrDist = XMVectorGetX(XMVector3LengthSq(Offset));
+				NumRangeErrors += (std::abs(Bounds.GetSquareDistance(static_cast<int32_t>(Idx)) - SqrDist) > 1e-3f * (std::max)(SqrDist, 1.0f)) ? 1 : 0;
+				if (std::abs(SqrDist - RangeRadius * RangeRadius) > 1.0f)
+				{
+					NumRangeErrors += (Bounds.IsInRange(static_cast<int32_t>(Idx)) != (SqrDist < RangeRadius * RangeRadius)) ? 1 : 0;
+				}
+				NumInsideErrors += (Bounds.IsCameraInside(static_cast<int32_t>(Idx)) != (Box.Contains(XMLoadFloat3(&Frustum.Origin)) != DISJOINT)) ? 1 : 0;
+			}
+		}
+
+		UH_TOOL_CHECK(NumVisibleErrors == 0);
+		UH_TOOL_CHECK(NumRangeErrors == 0);
+		UH_TOOL_CHECK(NumInsideErrors == 0);
+		UH_TOOL_CHECK(NumPreviousErrors == 0);
+		UH_TOOL_CHECK(NumVisible > 0 && NumVisible < NumBoxes * Frustums.size());
+
+		const wchar_t* LevelNames[] = { L"Scalar", L"SSE", L"AVX" };
+		Summary += std::wstring(LevelNames[Level]) + L": " + std::to_wstring(NumVisible) + L" visible, " + std::to_wstring(NumVisibleErrors)
+			+ L" visibility errors (" + std::to_wstring(NumNearPlane) + L" rounding differences on planes), " + std::to_wstring(NumRangeErrors)
+			+ L" range errors, " + std::to_wstring(NumInsideErrors) + L" camera inside errors\n";
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// culls up to the given number of boxes with DirectXCollision on an array of BoundingBox, which is what per-renderer culling did,
+// and with every kernel on one thread and on all workers of a job system, box counts grow by 10x from 1000
+// the visible count of every kernel must match DirectXCollision except boxes on the planes
+void BenchmarkFrustumCulling(const uint32_t MaxBoxes)
+{
+	const float RangeRadius = 150.0f;
+	const int32_t NumIterations = 20;
+	const std::vector<BoundingFrustum> Frustums = CreateCullingTestFrustums(NumIterations);
+	const std::vector<BoundingBox> AllBoxes = CreateCullingTestBoxes(MaxBoxes, 12345);
+
+	UHJobSystem JobSystem;
+	JobSystem.Initialize((std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 0));
+
+	const wchar_t* LevelNames[] = { L"Scalar", L"SSE", L"AVX" };
+	const int32_t MaxLevel = UH_ENUM_VALUE(UHFrustumCulling::GetSIMDLevel());
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	uint32_t NumErrors = 0;
+
+	std::wstring Summary = L"Frustum culling benchmark, " + std::to_wstring(JobSystem.GetNumWorkers()) + L" workers, time per box of "
+		+ std::to_wstring(NumIterations) + L" views\n";
+	for (uint32_t NumBoxes = (std::min)(1000u, MaxBoxes); ; NumBoxes = (std::min)(NumBoxes * 10, MaxBoxes))
+	{
+		const std::vector<BoundingBox> Boxes(AllBoxes.begin(), AllBoxes.begin() + NumBoxes);
+		UHCullingBounds Bounds;
+		Bounds.Resize(NumBoxes);
+		for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+		{
+			Bounds.SetBound(static_cast<int32_t>(Idx), Boxes[Idx]);
+		}
+
+		// the DirectXCollision reference, the visible flags are kept for validation
+		std::vector<std::vector<uint8_t>> Expected(NumIterations, std::vector<uint8_t>(NumBoxes));
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		for (int32_t Iter = 0; Iter < NumIterations; Iter++)
+		{
+			for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+			{
+				Expected[Iter][Idx] = Frustums[Iter].Contains(Boxes[Idx]) != DISJOINT;
+			}
+		}
+		const double ReferenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+		const double Divisor = static_cast<double>(NumBoxes) * NumIterations;
+		Summary += std::to_wstring(NumBoxes) + L" boxes: DirectXCollision " + std::to_wstring(ReferenceSeconds * 1e9 / Divisor) + L" ns";
+
+		// single thread then all workers for each kernel
+		for (int32_t Level = 0; Level <= MaxLevel; Level++)
+		{
+			for (int32_t Pass = 0; Pass < 2; Pass++)
+			{
+				const bool bParallel = Pass == 1;
+				uint32_t NumMismatches = 0;
+				StartTime = std::chrono::steady_clock::now();
+				for (int32_t Iter = 0; Iter < NumIterations; Iter++)
+				{
+					const UHCullingPlanes Planes = UHFrustumCulling::BuildPlanes(Frustums[Iter]);
+					if (bParallel)
+					{
+						JobSystem.ParallelFor(Bounds.GetWordCount(), 8, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+							{
+								UHFrustumCulling::CullBounds(static_cast<UHCullingSIMDLevel>(Level), Planes, Frustums[Iter].Origin, RangeRadius
+									, Bounds, Begin, End);
+							});
+					}
+					else
+					{
+						UHFrustumCulling::CullBounds(static_cast<UHCullingSIMDLevel>(Level), Planes, Frustums[Iter].Origin, RangeRadius
+							, Bounds, 0, Bounds.GetWordCount());
+					}
+
+					// validated out of the timing
+					const std::chrono::steady_clock::time_point ValidateStartTime = std::chrono::steady_clock::now();
+					for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+					{
+						const bool bVisible = Bounds.IsVisible(static_cast<int32_t>(Idx));
+						NumMismatches += (bVisible != (Expected[Iter][Idx] != 0) && !IsNearFrustumPlane(Planes, Boxes[Idx])) ? 1 : 0;
+					}
+					StartTime += std::chrono::steady_clock::now() - ValidateStartTime;
+				}
+				const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+				NumErrors += NumMismatches;
+				Summary += L", " + std::wstring(LevelNames[Level]) + (bParallel ? L" MT " : L" ") + std::to_wstring(Seconds * 1e9 / Divisor) + L" ns ("
+					+ std::to_wstring(ReferenceSeconds / (std::max)(Seconds, 1e-9)) + L"x)";
+			}
+		}
+		Summary += L"\n";
+
+		if (NumBoxes == MaxBoxes)
+		{
+			break;
+		}
+	}
+
+	JobSystem.Release();
+	UH_TOOL_CHECK(NumErrors == 0);
+	Summary += std::to_wstring(NumErrors) + L" mismatches against DirectXCollision\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// closest entry distance of a ray to a box by slab test, negative if missed, the brute force reference of BVH ray casts
+static float IntersectRayBound(const XMFLOAT3& InOrigin, const XMFLOAT3& InDirection, const BoundingBox& InBox, const float InMaxDistance)
+{
+	const float Origin[3] = { InOrigin.x, InOrigin.y, InOrigin.z };
+	const float Direction[3] = { InDirection.x, InDirection.y, InDirection.z };
+	const float Center[3] = { InBox.Center.x, InBox.Center.y, InBox.Center.z };
+	const float Extent[3] = { InBox.Extents.x, InBox.Extents.y, InBox.Extents.z };
+
+	// the entry distance is 0 when the origin is inside, which is the same as the BVH
+	float TMin = 0.0f;
+	float TMax = InMaxDistance;
+	for (int32_t Axis = 0; Axis < 3; Axis++)
+	{
+		const float T1 = (Center[Axis] - Extent[Axis] - Origin[Axis]) / Direction[Axis];
+		const float T2 = (Center[Axis] + Extent[Axis] - Origin[Axis]) / Direction[Axis];
+		TMin = (std::max)(TMin, (std::min)(T1, T2));
+		TMax = (std::min)(TMax, (std::max)(T1, T2));
+	}
+
+	return (TMin <= TMax) ? TMin : -1.0f;
+}
+
+// builds, refits and queries the scene BVH with item counts growing by 10x from 1000 up to the number,
+// frustum and sphere queries are compared with the linear culling, ray casts are compared with testing every box
+void BenchmarkBVH(const uint32_t MaxItems)
+{
+	const float SphereRadius = 150.0f;
+	const float RayDistance = 5000.0f;
+	const int32_t NumQueries = 20;
+	const int32_t NumRays = 1000;
+	const std::vector<BoundingFrustum> Frustums = CreateCullingTestFrustums(NumQueries);
+	const std::vector<BoundingBox> AllBoxes = CreateCullingTestBoxes(MaxItems, 12345);
+
+	uint32_t Seed = 67890;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	const auto ElapsedMs = [](const std::chrono::steady_clock::time_point& InStartTime)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - InStartTime).count();
+	};
+
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	uint32_t NumFrustumErrors = 0;
+	uint32_t NumSphereErrors = 0;
+	uint32_t NumRayErrors = 0;
+	std::wstring Summary = L"BVH benchmark, " + std::to_wstring(NumQueries) + L" frustum and sphere queries, " + std::to_wstring(NumRays) + L" rays\n";
+	for (uint32_t NumItems = (std::min)(1000u, MaxItems); ; NumItems = (std::min)(NumItems * 10, MaxItems))
+	{
+		std::vector<BoundingBox> Boxes(AllBoxes.begin(), AllBoxes.begin() + NumItems);
+		UHCullingBounds Bounds;
+		Bounds.Resize(NumItems);
+		std::vector<int32_t> Items(NumItems);
+		for (uint32_t Idx = 0; Idx < NumItems; Idx++)
+		{
+			Bounds.SetBound(static_cast<int32_t>(Idx), Boxes[Idx]);
+			Items[Idx] = static_cast<int32_t>(Idx);
+		}
+
+		UHBoundingVolumeHierarchy BVH;
+		std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		BVH.Build(Bounds, Items);
+		const double BuildMs = ElapsedMs(StartTime);
+
+		// move 1% of the items as moveable renderers would do in a frame, then refit with the dirty items and refit all
+		std::vector<int32_t> DirtyItems;
+		for (uint32_t Idx = 0; Idx < (std::max)(NumItems / 100, 1u); Idx++)
+		{
+			const int32_t Item = static_cast<int32_t>(NextRandom() % NumItems);
+			Boxes[Item].Center.x += (NextRandom() % 201) * 0.1f - 10.0f;
+			Boxes[Item].Center.z += (NextRandom() % 201) * 0.1f - 10.0f;
+			Bounds.SetBound(Item, Boxes[Item]);
+			DirtyItems.push_back(Item);
+		}
+
+		StartTime = std::chrono::steady_clock::now();
+		BVH.Refit(Bounds, DirtyItems);
+		const double RefitMs = ElapsedMs(StartTime);
+
+		StartTime = std::chrono::steady_clock::now();
+		BVH.RefitAll(Bounds);
+		const double RefitAllMs = ElapsedMs(StartTime);
+
+		// frustum queries of the refitted tree vs. the linear kernel, mismatches on planes are rounding differences
+		double LinearMs = 0.0;
+		double FrustumMs = 0.0;
+		std::vector<uint32_t> QueryBits(Bounds.GetWordCount());
+		for (const BoundingFrustum& Frustum : Frustums)
+		{
+			const UHCullingPlanes Planes = UHFrustumCulling::BuildPlanes(Frustum);
+			StartTime = std::chrono::steady_clock::now();
+			UHFrustumCulling::CullBounds(Planes, Frustum.Origin, SphereRadius, Bounds, 0, Bounds.GetWordCount());
+			LinearMs += ElapsedMs(StartTime);
+
+			StartTime = std::chrono::steady_clock::now();
+			std::fill(QueryBits.begin(), QueryBits.end(), 0);
+			BVH.QueryFrustum(Bounds, Planes, QueryBits);
+			FrustumMs += ElapsedMs(StartTime);
+
+			for (uint32_t Idx = 0; Idx < NumItems; Idx++)
+			{
+				const bool bQueried = (QueryBits[Idx / UHCullingBounds::BoxesPerWord] & (1u << (Idx % UHCullingBounds::BoxesPerWord))) != 0;
+				NumFrustumErrors += (bQueried != Bounds.IsVisible(static_cast<int32_t>(Idx)) && !IsNearFrustumPlane(Planes, Boxes[Idx])) ? 1 : 0;
+			}
+		}
+
+		// sphere queries vs. testing the distance of every box
+		double SphereMs = 0.0;
+		for (const BoundingFrustum& Frustum : Frustums)
+		{
+			StartTime = std::chrono::steady_clock::now();
+			std::fill(QueryBits.begin(), QueryBits.end(), 0);
+			BVH.QuerySphere(Bounds, Frustum.Origin, SphereRadius, QueryBits);
+			SphereMs += ElapsedMs(StartTime);
+
+			for (uint32_t Idx = 0; Idx < NumItems; Idx++)
+			{
+				const bool bQueried = (QueryBits[Idx / UHCullingBounds::BoxesPerWord] & (1u << (Idx % UHCullingBounds::BoxesPerWord))) != 0;
+				const float SqrDist = UHFrustumCulling::SquareDistanceToBox(Frustum.Origin, Boxes[Idx].Center, Boxes[Idx].Extents);
+				if (std::abs(SqrDist - SphereRadius * SphereRadius) > 1.0f)
+				{
+					NumSphereErrors += (bQueried != (SqrDist <= SphereRadius * SphereRadius)) ? 1 : 0;
+				}
+			}
+		}
+
+		// ray casts from the camera positions vs. testing every box, the closest distance must match
+		double RayMs = 0.0;
+		double BruteForceRayMs = 0.0;
+		uint32_t NumHits = 0;
+		for (int32_t RayIdx = 0; RayIdx < NumRays; RayIdx++)
+		{
+			const XMFLOAT3& Origin = Frustums[RayIdx % NumQueries].Origin;
+			XMFLOAT3 Direction((NextRandom() % 2001) * 0.001f - 1.0f, (NextRandom() % 2001) * 0.0002f - 0.3f, (NextRandom() % 2001) * 0.001f - 1.0f);
+			XMStoreFloat3(&Direction, XMVector3Normalize(XMLoadFloat3(&Direction)));
+
+			float HitDistance;
+			StartTime = std::chrono::steady_clock::now();
+			const int32_t HitItem = BVH.RayCast(Bounds, Origin, Direction, RayDistance, HitDistance);
+			RayMs += ElapsedMs(StartTime);
+
+			StartTime = std::chrono::steady_clock::now();
+			float ClosestDistance = RayDistance;
+			int32_t ClosestItem = UHINDEXNONE;
+			for (uint32_t Idx = 0; Idx < NumItems; Idx++)
+			{
+				const float Distance = IntersectRayBound(Origin, Direction, Boxes[Idx], ClosestDistance);
+				if (Distance >= 0.0f && (ClosestItem == UHINDEXNONE || Distance < ClosestDistance))
+				{
+					ClosestDistance = Distance;
+					ClosestItem = static_cast<int32_t>(Idx);
+				}
+			}
+			BruteForceRayMs += ElapsedMs(StartTime);
+
+			// items hit at the same distance can be picked either way
+			NumHits += (HitItem != UHINDEXNONE) ? 1 : 0;
+			NumRayErrors += ((HitItem == UHINDEXNONE) != (ClosestItem == UHINDEXNONE)) ? 1 : 0;
+			NumRayErrors += (HitItem != UHINDEXNONE && ClosestItem != UHINDEXNONE
+				&& std::abs(HitDistance - ClosestDistance) > 1e-3f * (std::max)(ClosestDistance, 1.0f)) ? 1 : 0;
+		}
+
+		Summary += std::to_wstring(NumItems) + L" items, " + std::to_wstring(BVH.GetNodeCount()) + L" nodes: build " + std::to_wstring(BuildMs)
+			+ L" ms, refit " + std::to_wstring(DirtyItems.size()) + L" items " + std::to_wstring(RefitMs) + L" ms, refit all " + std::to_wstring(RefitAllMs) + L" ms\n";
+		Summary += L"  frustum query " + std::to_wstring(FrustumMs / NumQueries) + L" ms (linear " + std::to_wstring(LinearMs / NumQueries)
+			+ L" ms), sphere query " + std::to_wstring(SphereMs / NumQueries) + L" ms, ray cast " + std::to_wstring(RayMs * 1000.0 / NumRays)
+			+ L" us (linear " + std::to_wstring(BruteForceRayMs * 1000.0 / NumRays) + L" us), " + std::to_wstring(NumHits) + L" hits\n";
+
+		if (NumItems == MaxItems)
+		{
+			break;
+		}
+	}
+
+	UH_TOOL_CHECK(NumFrustumErrors == 0);
+	UH_TOOL_CHECK(NumSphereErrors == 0);
+	UH_TOOL_CHECK(NumRayErrors == 0);
+	Summary += std::to_wstring(NumFrustumErrors) + L" frustum errors, " + std::to_wstring(NumSphereErrors) + L" sphere errors, "
+		+ std::to_wstring(NumRayErrors) + L" ray errors\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// culls a city-style scene with the CPU reference of GPU culling from several camera directions, the compacted commands are validated
+// against the frustum the camera component culls with, and the recorded draws are compared with drawing every visible renderer
+void BenchmarkIndirectDraw(const uint32_t NumRenderers)
+{
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	// 64 meshes shared by 8 materials, one tenth of renderers are translucent which aren't drawn indirectly
+	// meshes are ranges of a geometry pool, packed one after another
+	const uint32_t NumMeshes = 64;
+	const uint32_t NumMaterials = 8;
+	std::vector<UHMeshGeometryRange> MeshRanges(NumMeshes);
+	for (uint32_t Idx = 0; Idx < NumMeshes; Idx++)
+	{
+		MeshRanges[Idx].IndexCount = (500 + Idx * 200) * 3;
+		MeshRanges[Idx].FirstIndex = (Idx > 0) ? MeshRanges[Idx - 1].FirstIndex + MeshRanges[Idx - 1].IndexCount : 0;
+		MeshRanges[Idx].VertexOffset = static_cast<int32_t>(Idx * 1000);
+	}
+
+	std::vector<UniquePtr<UHMaterial>> Materials;
+	for (uint32_t Idx = 0; Idx < NumMaterials; Idx++)
+	{
+		Materials.push_back(MakeUnique<UHMaterial>());
+	}
+
+	std::vector<UHIndirectDrawItem> Items(NumRenderers);
+	UHCullingBounds Bounds;
+	Bounds.Resize(NumRenderers);
+	uint32_t NumDrawables = 0;
+	for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+	{
+		const uint32_t MeshIdx = NextRandom() % NumMeshes;
+		const bool bDrawable = NextRandom() % 10 != 0;
+		const UHMeshGeometryRange& Range = MeshRanges[MeshIdx];
+		Items[Idx] = UHIndirectDrawItem{ Materials[(MeshIdx + NextRandom() % 2) % NumMaterials].get(), Range.IndexCount, Range.FirstIndex
+			, Range.VertexOffset, bDrawable };
+		NumDrawables += bDrawable ? 1 : 0;
+
+		const XMFLOAT3 Center((NextRandom() % 20001) * 0.1f - 1000.0f, (NextRandom() % 501) * 0.1f, (NextRandom() % 20001) * 0.1f - 1000.0f);
+		const float Size = (NextRandom() % 100 == 0) ? 50.0f : 1.0f + (NextRandom() % 90) * 0.1f;
+		Bounds.SetBound(static_cast<int32_t>(Idx), BoundingBox(Center, XMFLOAT3(Size, Size, Size)));
+	}
+
+	// occlusion result from software occlusion culling, some of the renderers are hidden
+	std::vector<uint32_t> OcclusionResult(NumRenderers);
+	for (uint32_t& Result : OcclusionResult)
+	{
+		Result = (NextRandom() % 3 == 0) ? 0 : 1;
+	}
+
+	// instances start after the CPU instanced draws as the renderer does
+	const int32_t NumRuns = 20;
+	const uint32_t FirstInstance = NumRenderers * 2;
+	UHIndirectDrawBuilder Builder;
+	const std::chrono::steady_clock::time_point BuildStartTime = std::chrono::steady_clock::now();
+	for (int32_t Run = 0; Run < NumRuns; Run++)
+	{
+		Builder.Build(Items, FirstInstance);
+	}
+	const double BuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - BuildStartTime).count() / NumRuns;
+
+	const std::vector<UHIndirectDrawBucket>& Buckets = Builder.GetBuckets();
+	const std::vector<UHIndirectCullData>& CullData = Builder.GetCullData();
+	std::wstring Summary = L"Indirect draw benchmark, " + std::to_wstring(NumRenderers) + L" renderers, " + std::to_wstring(NumDrawables)
+		+ L" drawn indirectly, " + std::to_wstring(Buckets.size()) + L" buckets, build " + std::to_wstring(BuildSeconds * 1000.0) + L" ms\n";
+
+	// the same projection as the camera component, reversed-z with an infinite far plane
+	const float FovY = XMConvertToRadians(60.0f);
+	const float Aspect = 1.7778f;
+	const float NearPlane = 0.1f;
+	const float CullingDistance = 1000.0f;
+	XMFLOAT4X4 Proj;
+	XMStoreFloat4x4(&Proj, XMMatrixPerspectiveFovRH(FovY, Aspect, NearPlane + 1, NearPlane));
+	Proj(2, 2) = 0.0f;
+	Proj(3, 2) = NearPlane;
+
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	std::vector<UHDrawIndexedIndirectCommand> Commands;
+	std::vector<uint32_t> DrawCounts;
+	std::vector<uint32_t> Instances;
+	std::vector<uint32_t> SeenCounts(NumRenderers);
+	for (int32_t ViewIdx = 0; ViewIdx < 4; ViewIdx++)
+	{
+		const float Yaw = ViewIdx * XM_PIDIV2 + 0.3f;
+		const XMFLOAT3 Position(0.0f, 20.0f, 0.0f);
+		const XMFLOAT3 Forward(std::sin(Yaw), 0.0f, std::cos(Yaw));
+		const XMFLOAT3 Up(0.0f, 1.0f, 0.0f);
+		const XMMATRIX View = XMMatrixLookToRH(XMLoadFloat3(&Position), XMLoadFloat3(&Forward), -XMLoadFloat3(&Up));
+
+		UHIndirectCullView CullView;
+		XMStoreFloat4x4(&CullView.ViewProj, XMMatrixTranspose(XMLoadFloat4x4(&Proj)) * XMMatrixTranspose(View));
+		CullView.CameraPos = Position;
+		CullView.CameraDir = Forward;
+		CullView.CullingDistance = CullingDistance;
+		CullView.bEnableOcclusion = true;
+
+		const std::chrono::steady_clock::time_point CullStartTime = std::chrono::steady_clock::now();
+		for (int32_t Run = 0; Run < NumRuns; Run++)
+		{
+			Builder.CullAndCompact(CullView, Bounds, OcclusionResult, Commands, DrawCounts, Instances);
+		}
+		const double CullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - CullStartTime).count() / NumRuns;
+
+		// every compacted command must be within the bucket capacity, draw its renderer's mesh range in its own bucket
+		// and every renderer must be drawn once at most
+		uint32_t NumErrors = 0;
+		uint32_t NumVisible = 0;
+		uint32_t NumDraws = 0;
+		std::fill(SeenCounts.begin(), SeenCounts.end(), 0);
+		for (size_t BucketIdx = 0; BucketIdx < Buckets.size(); BucketIdx++)
+		{
+			const UHIndirectDrawBucket& Bucket = Buckets[BucketIdx];
+			NumErrors += (DrawCounts[BucketIdx] > Bucket.Capacity) ? 1 : 0;
+			NumDraws += (DrawCounts[BucketIdx] > 0) ? 1 : 0;
+
+			const uint32_t DrawCount = (std::min)(DrawCounts[BucketIdx], Bucket.Capacity);
+			NumVisible += DrawCount;
+			for (uint32_t Idx = 0; Idx < DrawCount; Idx++)
+			{
+				const uint32_t CommandIdx = Bucket.FirstCommand + Idx;
+				const UHDrawIndexedIndirectCommand& Command = Commands[CommandIdx];
+				if (Command.FirstInstance != FirstInstance + CommandIdx || Command.InstanceCount != 1)
+				{
+					NumErrors++;
+					continue;
+				}
+
+				const uint32_t RendererIdx = Instances[Command.FirstInstance];
+				NumErrors += (CullData[RendererIdx].BucketIndex != static_cast<int32_t>(BucketIdx)) ? 1 : 0;
+				NumErrors += (Command.IndexCount != Items[RendererIdx].IndexCount || Command.FirstIndex != Items[RendererIdx].FirstIndex
+					|| Command.VertexOffset != Items[RendererIdx].VertexOffset) ? 1 : 0;
+				SeenCounts[RendererIdx]++;
+			}
+		}
+
+		// compare with the frustum of the camera component, the box test is conservative so it can keep a few more renderers
+		// but it must never drop a visible one
+		BoundingFrustum Frustum;
+		BoundingFrustum::CreateFromMatrix(Frustum, XMMatrixPerspectiveFovLH(FovY, Aspect, NearPlane, CullingDistance));
+		Frustum.Transform(Frustum, 1.0f, XMQuaternionRotationRollPitchYaw(0.0f, Yaw, 0.0f), XMLoadFloat3(&Position));
+
+		uint32_t NumMissing = 0;
+		uint32_t NumConservative = 0;
+		for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+		{
+			const BoundingBox Bound = Bounds.GetBound(static_cast<int32_t>(Idx));
+			const bool bOccluded = OcclusionResult[Idx] == 0;
+			const bool bExpected = Items[Idx].bDrawable && !bOccluded && Frustum.Contains(Bound) != DISJOINT;
+
+			NumErrors += (SeenCounts[Idx] > 1) ? 1 : 0;
+			NumMissing += (bExpected && SeenCounts[Idx] == 0) ? 1 : 0;
+			NumConservative += (!bExpected && SeenCounts[Idx] > 0) ? 1 : 0;
+		}
+		UH_TOOL_CHECK(NumErrors == 0);
+		UH_TOOL_CHECK(NumMissing == 0);
+
+		Summary += L"View " + std::to_wstring(ViewIdx) + L": " + std::to_wstring(NumVisible) + L" commands in " + std::to_wstring(NumDraws)
+			+ L" non-empty buckets, culling " + std::to_wstring(CullSeconds * 1000.0) + L" ms, " + std::to_wstring(NumConservative)
+			+ L" conservative, " + std::to_wstring(NumMissing) + L" missing, " + std::to_wstring(NumErrors) + L" errors\n";
+		Summary += L"    Recorded draws: " + std::to_wstring(Buckets.size()) + L" indirect count vs " + std::to_wstring(NumVisible) + L" per renderer\n";
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+// rasterizes walls of a maze-style scene into the software occlusion buffer from several camera directions, compares the SSE rasterizer
+// with the scalar reference, and tests random boxes against the buffer, a culled box is falsely occluded if a ray from the camera
+// reaches any sample point on its faces without hitting a wall
+void BenchmarkOcclusion(const uint32_t NumBoxes)
+{
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+	const auto NextFloat = [&NextRandom]()
+	{
+		return (NextRandom() % 65536) / 65536.0f;
+	};
+
+	// walls are the same unit quad scaled and rotated around y, standing on the ground around the camera
+	UHOccluderMesh Quad;
+	Quad.Positions = { XMFLOAT3(-1, -1, 0), XMFLOAT3(1, -1, 0), XMFLOAT3(1, 1, 0), XMFLOAT3(-1, 1, 0) };
+	Quad.Indices = { 0, 1, 2, 0, 2, 3 };
+
+	const uint32_t NumWalls = 64;
+	std::vector<XMFLOAT4X4> WallWorlds(NumWalls);
+	std::vector<XMFLOAT4X4> WallInvWorlds(NumWalls);
+	for (uint32_t Idx = 0; Idx < NumWalls; Idx++)
+	{
+		const float Angle = NextFloat() * XM_2PI;
+		const float Distance = 10.0f + NextFloat() * 50.0f;
+		const float HalfWidth = 2.0f + NextFloat() * 8.0f;
+		const float HalfHeight = 1.0f + NextFloat() * 3.0f;
+		const XMMATRIX World = XMMatrixScaling(HalfWidth, HalfHeight, 1.0f) * XMMatrixRotationY(NextFloat() * XM_2PI)
+			* XMMatrixTranslation(std::sin(Angle) * Distance, HalfHeight, std::cos(Angle) * Distance);
+
+		// the rasterizer takes the transposed matrix as it's stored in object constants
+		XMStoreFloat4x4(&WallWorlds[Idx], XMMatrixTranspose(World));
+		XMStoreFloat4x4(&WallInvWorlds[Idx], XMMatrixInverse(nullptr, World));
+	}
+
+	const XMFLOAT3 Position(0.0f, 1.7f, 0.0f);
+	const auto IsRayBlocked = [&](const XMFLOAT3& InTarget)
+	{
+		for (uint32_t Idx = 0; Idx < NumWalls; Idx++)
+		{
+			const XMMATRIX InvWorld = XMLoadFloat4x4(&WallInvWorlds[Idx]);
+			XMFLOAT3 Start, End;
+			XMStoreFloat3(&Start, XMVector3TransformCoord(XMLoadFloat3(&Position), InvWorld));
+			XMStoreFloat3(&End, XMVector3TransformCoord(XMLoadFloat3(&InTarget), InvWorld));
+			if ((Start.z > 0.0f) == (End.z > 0.0f))
+			{
+				continue;
+			}
+
+			const float T = Start.z / (Start.z - End.z);
+			if (std::abs(Start.x + (End.x - Start.x) * T) <= 1.0f && std::abs(Start.y + (End.y - Start.y) * T) <= 1.0f)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	// the same projection as the camera component, reversed-z with an infinite far plane
+	const float FovY = XMConvertToRadians(60.0f);
+	const float Aspect = 1.7778f;
+	const float NearPlane = 0.1f;
+	XMFLOAT4X4 Proj;
+	XMStoreFloat4x4(&Proj, XMMatrixPerspectiveFovRH(FovY, Aspect, NearPlane + 1, NearPlane));
+	Proj(2, 2) = 0.0f;
+	Proj(3, 2) = NearPlane;
+
+	UHSoftwareOcclusion Occlusion;
+	UHSoftwareOcclusion Reference;
+	Occlusion.Resize(256, 144);
+	Reference.Resize(256, 144);
+
+	const int32_t NumRuns = 20;
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	std::wstring Summary = L"Occlusion benchmark, " + std::to_wstring(NumWalls) + L" walls, " + std::to_wstring(NumBoxes) + L" boxes per view, "
+		+ std::to_wstring(Occlusion.GetWidth()) + L"x" + std::to_wstring(Occlusion.GetHeight()) + L" depth buffer\n";
+
+	for (int32_t ViewIdx = 0; ViewIdx < 4; ViewIdx++)
+	{
+		const float Yaw = ViewIdx * XM_PIDIV2 + 0.3f;
+		const XMFLOAT3 Forward(std::sin(Yaw), 0.0f, std::cos(Yaw));
+		const XMFLOAT3 Up(0.0f, 1.0f, 0.0f);
+		const XMMATRIX View = XMMatrixLookToRH(XMLoadFloat3(&Position), XMLoadFloat3(&Forward), -XMLoadFloat3(&Up));
+
+		XMFLOAT4X4 ViewProj;
+		XMStoreFloat4x4(&ViewProj, XMMatrixTranspose(XMLoadFloat4x4(&Proj)) * XMMatrixTranspose(View));
+
+		const std::chrono::steady_clock::time_point ReferenceStartTime = std::chrono::steady_clock::now();
+		for (int32_t Run = 0; Run < NumRuns; Run++)
+		{
+			Reference.BeginFrame(ViewProj);
+			for (const XMFLOAT4X4& World : WallWorlds)
+			{
+				Reference.RasterizeOccluderReference(Quad, World);
+			}
+		}
+		const double ReferenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - ReferenceStartTime).count() / NumRuns;
+
+		const std::chrono::steady_clock::time_point RasterStartTime = std::chrono::steady_clock::now();
+		for (int32_t Run = 0; Run < NumRuns; Run++)
+		{
+			Occlusion.BeginFrame(ViewProj);
+			for (const XMFLOAT4X4& World : WallWorlds)
+			{
+				Occlusion.RasterizeOccluder(Quad, World);
+			}
+		}
+		const double RasterSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - RasterStartTime).count() / NumRuns;
+
+		float MaxDepthDiff = 0.0f;
+		const std::vector<float>& Depth = Occlusion.GetDepthBuffer();
+		const std::vector<float>& ReferenceDepth = Reference.GetDepthBuffer();
+		for (size_t Idx = 0; Idx < Depth.size(); Idx++)
+		{
+			MaxDepthDiff = (std::max)(MaxDepthDiff, std::abs(Depth[Idx] - ReferenceDepth[Idx]));
+		}
+
+		// boxes whose centers are in view, the rest is left to frustum culling in the renderer
+		std::vector<XMFLOAT3> Centers;
+		std::vector<XMFLOAT3> Extents;
+		while (Centers.size() < NumBoxes)
+		{
+			const float Angle = NextFloat() * XM_2PI;
+			const float Distance = 5.0f + NextFloat() * 80.0f;
+			const XMFLOAT3 Extent(0.2f + NextFloat() * 1.5f, 0.2f + NextFloat() * 1.5f, 0.2f + NextFloat() * 1.5f);
+			const XMFLOAT3 Center(std::sin(Angle) * Distance, Extent.y + NextFloat() * 3.0f, std::cos(Angle) * Distance);
+
+			XMFLOAT4 Clip;
+			XMStoreFloat4(&Clip, XMVector4Transform(XMVectorSet(Center.x, Center.y, Center.z, 1.0f), XMMatrixTranspose(XMLoadFloat4x4(&ViewProj))));
+			if (Clip.w > NearPlane && std::abs(Clip.x) <= Clip.w && std::abs(Clip.y) <= Clip.w)
+			{
+				Centers.push_back(Center);
+				Extents.push_back(Extent);
+			}
+		}
+
+		std::vector<bool> Visible(NumBoxes);
+		const std::chrono::steady_clock::time_point TestStartTime = std::chrono::steady_clock::now();
+		for (int32_t Run = 0; Run < NumRuns; Run++)
+		{
+			for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+			{
+				Visible[Idx] = Occlusion.IsBoxVisible(Centers[Idx], Extents[Idx]);
+			}
+		}
+		const double TestSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - TestStartTime).count() / NumRuns;
+
+		// ground truth of the culled boxes, 8x8 samples on each face
+		uint32_t NumOccluded = 0;
+		uint32_t NumFalseOccluded = 0;
+		for (uint32_t Idx = 0; Idx < NumBoxes; Idx++)
+		{
+			if (Visible[Idx])
+			{
+				continue;
+			}
+			NumOccluded++;
+
+			const float Center[3] = { Centers[Idx].x, Centers[Idx].y, Centers[Idx].z };
+			const float Extent[3] = { Extents[Idx].x, Extents[Idx].y, Extents[Idx].z };
+			bool bReached = false;
+			for (int32_t Face = 0; Face < 6 && !bReached; Face++)
+			{
+				const int32_t Axis = Face / 2;
+				const int32_t AxisU = (Axis + 1) % 3;
+				const int32_t AxisV = (Axis + 2) % 3;
+				for (int32_t Sample = 0; Sample < 64 && !bReached; Sample++)
+				{
+					float Point[3];
+					Point[Axis] = Center[Axis] + ((Face & 1) ? Extent[Axis] : -Extent[Axis]);
+					Point[AxisU] = Center[AxisU] + ((Sample % 8 + 0.5f) / 4.0f - 1.0f) * Extent[AxisU];
+					Point[AxisV] = Center[AxisV] + ((Sample / 8 + 0.5f) / 4.0f - 1.0f) * Extent[AxisV];
+					bReached = !IsRayBlocked(XMFLOAT3(Point[0], Point[1], Point[2]));
+				}
+			}
+			NumFalseOccluded += bReached ? 1 : 0;
+		}
+
+		const double FalseRate = static_cast<double>(NumFalseOccluded) / NumBoxes;
+		UH_TOOL_CHECK(MaxDepthDiff <= 1e-6f);
+		UH_TOOL_CHECK(FalseRate <= 0.001);
+
+		const UHSoftwareOcclusionStats& Stats = Occlusion.GetStats();
+		Summary += L"View " + std::to_wstring(ViewIdx) + L": " + std::to_wstring(Stats.NumRasterizedTriangles) + L" rasterized triangles, SSE "
+			+ std::to_wstring(RasterSeconds * 1000.0) + L" ms vs reference " + std::to_wstring(ReferenceSeconds * 1000.0) + L" ms, max depth diff "
+			+ std::to_wstring(MaxDepthDiff) + L"\n";
+		Summary += L"    " + std::to_wstring(NumOccluded) + L" boxes occluded, " + std::to_wstring(NumFalseOccluded) + L" falsely ("
+			+ std::to_wstring(FalseRate * 100.0) + L"%), box tests " + std::to_wstring(TestSeconds * 1000.0) + L" ms\n";
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
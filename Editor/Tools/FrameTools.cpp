@@ -0,0 +1,466 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../Classes/GeometryUtility.h"
+#include "../../Runtime/Engine/Engine.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/Material.h"
+#include "../../Runtime/Classes/Mesh.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+
+// allocations made while the frame benchmark measures a stage, debug builds count them with a debug heap hook
+// which is installed around each measured stage only, so nothing else pays for it
+// release builds don't have the debug heap, define WITH_ALLOCATION_COUNTING to count them with a replaced global operator new
+// it's opt-in since the replacement would apply to every allocation of the editor
+static std::atomic<uint64_t> GNumAllocations{ 0 };
+static std::atomic<uint64_t> GNumAllocatedBytes{ 0 };
+
+#if WITH_ALLOCATION_COUNTING
+static std::atomic<bool> GCountAllocations{ false };
+
+void* operator new(size_t Size)
+{
+	if (GCountAllocations.load(std::memory_order_relaxed))
+	{
+		GNumAllocations.fetch_add(1, std::memory_order_relaxed);
+		GNumAllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+	}
+
+	// the parentheses keep malloc from expanding to the debug heap macro, so leak reports don't point here
+	void* Ptr = (malloc)((Size > 0) ? Size : 1);
+	if (Ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return Ptr;
+}
+
+void operator delete(void* Ptr) noexcept
+{
+	(free)(Ptr);
+}
+#elif defined(_DEBUG)
+static _CRT_ALLOC_HOOK GPreviousAllocHook = nullptr;
+
+static int __cdecl CountAllocationHook(int AllocType, void* UserData, size_t Size, int BlockType, long RequestNumber
+	, const unsigned char* FileName, int LineNumber)
+{
+	// CRT internal blocks aren't made by the engine
+	if (BlockType != _CRT_BLOCK && (AllocType == _HOOK_ALLOC || AllocType == _HOOK_REALLOC))
+	{
+		GNumAllocations.fetch_add(1, std::memory_order_relaxed);
+		GNumAllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+	}
+
+	return GPreviousAllocHook ? GPreviousAllocHook(AllocType, UserData, Size, BlockType, RequestNumber, FileName, LineNumber) : TRUE;
+}
+#endif
+
+// starts or stops counting allocations, returns false if this build can't count them
+static bool SetAllocationCounting(const bool bEnabled)
+{
+#if WITH_ALLOCATION_COUNTING
+	GCountAllocations = bEnabled;
+	return true;
+#elif defined(_DEBUG)
+	if (bEnabled)
+	{
+		GPreviousAllocHook = _CrtSetAllocHook(CountAllocationHook);
+	}
+	else
+	{
+		_CrtSetAllocHook(GPreviousAllocHook);
+		GPreviousAllocHook = nullptr;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+// runs the CPU stages of frames on headless engines with the null graphics backend, the city-style scene has buildings, moving props
+// and point lights, and the camera circles around the city along a scripted path
+// the same scene and path run with the CPU, GPU-driven and mesh shader renderer paths, each on a fresh engine
+// per-stage times and allocations exclude the warmup frames, and the results are exported to JSON
+void BenchmarkFrame(const uint32_t NumRenderers, const uint32_t NumFrames)
+{
+	const std::filesystem::path BenchmarkFolder = std::filesystem::temp_directory_path() / "UHBenchmarkFrame";
+	std::filesystem::remove_all(BenchmarkFolder);
+	std::filesystem::create_directories(BenchmarkFolder);
+
+	// buildings of different heights, exporting builds the bounds and the meshlets which the mesh shader path needs
+	const uint32_t NumMeshes = 8;
+	std::vector<std::filesystem::path> MeshPaths;
+	for (uint32_t Idx = 0; Idx < NumMeshes; Idx++)
+	{
+		UHMesh Mesh = UHGeometryHelper::CreateCubeMesh();
+		std::vector<XMFLOAT3> Positions;
+		std::vector<uint32_t> Indices;
+		Mesh.GetCPUGeometry(Positions, Indices);
+		for (XMFLOAT3& Position : Positions)
+		{
+			Position.y = (Position.y + 0.5f) * (1.0f + Idx);
+		}
+		Mesh.SetPositionData(Positions);
+		Mesh.SetName("BenchmarkFrameMesh" + std::to_string(Idx));
+		MeshPaths.push_back(BenchmarkFolder / (Mesh.GetName() + GMeshAssetExtension));
+		Mesh.Export(MeshPaths.back());
+	}
+
+	struct UHFramePath
+	{
+		const char* Name;
+		bool bMeshShader;
+		bool bDrawIndirectFirstInstance;
+	};
+	const UHFramePath Paths[] = { { "CPU", false, false }, { "GPUDriven", false, true }, { "MeshShader", true, false } };
+	const int32_t NumPaths = static_cast<int32_t>(std::size(Paths));
+
+	// scene update is measured as the first stage, the total of a frame is the last one
+	const int32_t NumUpdateStages = UH_ENUM_VALUE(UHRendererUpdateStage::UpdateStageMax);
+	const int32_t NumStages = NumUpdateStages + 2;
+	std::vector<const char*> StageNames = { "SceneUpdate" };
+	for (int32_t Stage = 0; Stage < NumUpdateStages; Stage++)
+	{
+		StageNames.push_back(UHDeferredShadingRenderer::GetUpdateStageName(static_cast<UHRendererUpdateStage>(Stage)));
+	}
+	StageNames.push_back("Frame");
+
+	struct UHFrameStageStats
+	{
+		double MedianMs;
+		double P99Ms;
+		double MeanMs;
+		double MaxMs;
+		uint64_t MedianAllocations;
+		uint64_t MaxAllocations;
+		uint64_t MedianBytes;
+	};
+
+	struct UHFramePathResult
+	{
+		std::vector<UHFrameStageStats> Stages;
+		std::vector<uint32_t> NumVisible;
+		std::vector<uint32_t> NumToDraw;
+		double InitSeconds;
+	};
+
+	const uint32_t NumWarmupFrames = (std::min)(8u, NumFrames / 2);
+	const uint32_t NumMeasuredFrames = NumFrames - NumWarmupFrames;
+	const uint32_t NumPointLights = 256;
+	const uint32_t NumMaterials = 6;
+	const uint32_t NumWorkerThreads = 4;
+	uint32_t NumMovers = 0;
+	uint32_t NumErrors = 0;
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	bool bCountsAllocations = false;
+	std::vector<UHFramePathResult> Results(NumPaths);
+
+	for (int32_t PathIdx = 0; PathIdx < NumPaths; PathIdx++)
+	{
+		const UHFramePath& Path = Paths[PathIdx];
+		UHFramePathResult& Result = Results[PathIdx];
+		const std::chrono::steady_clock::time_point InitStartTime = std::chrono::steady_clock::now();
+
+		// every path builds the same scene from the same seed
+		uint32_t Seed = 12345;
+		const auto NextRandom = [&Seed]()
+		{
+			Seed = Seed * 1664525u + 1013904223u;
+			return Seed >> 8;
+		};
+
+		UniquePtr<UHEngine> Engine = MakeUnique<UHEngine>();
+		UHRenderingSettings& Settings = Engine->GetConfigManager()->RenderingSetting();
+		Settings.ParallelThreads = static_cast<int32_t>(NumWorkerThreads);
+		Settings.bEnableRayTracing = false;
+		Settings.bEnableOcclusionCulling = true;
+		Settings.bEnableGPUDrivenRendering = true;
+		bool bInitialized = Engine->InitHeadlessEngine(Path.bMeshShader, Path.bDrawIndirectFirstInstance);
+
+		std::vector<UniquePtr<UHMesh>> Meshes;
+		for (const std::filesystem::path& MeshPath : MeshPaths)
+		{
+			Meshes.push_back(MakeUnique<UHMesh>());
+			bInitialized &= Meshes.back()->Import(MeshPath);
+		}
+
+		// 4 opaque materials shared by buildings, one masked and one translucent
+		const UHBlendMode BlendModes[NumMaterials] = { UHBlendMode::Opaque, UHBlendMode::Opaque, UHBlendMode::Opaque, UHBlendMode::Opaque
+			, UHBlendMode::Masked, UHBlendMode::TranditionalAlpha };
+		std::vector<UniquePtr<UHMaterial>> Materials;
+		for (uint32_t Idx = 0; Idx < NumMaterials && bInitialized; Idx++)
+		{
+			UniquePtr<UHMaterial> Mat = MakeUnique<UHMaterial>();
+			Mat->SetGfxCache(Engine->GetGfx());
+			Mat->SetName("BenchmarkFrameMaterial" + std::to_string(Idx));
+			Mat->SetBlendMode(BlendModes[Idx]);
+
+			size_t BufferSize = 0;
+			Mat->GetCBufferDefineCode(BufferSize);
+			Mat->SetMaterialBufferSize(BufferSize);
+			Materials.push_back(std::move(Mat));
+		}
+
+		UHScene* Scene = nullptr;
+		UHCameraComponent* Camera = nullptr;
+		std::vector<UHMeshRendererComponent*> Movers;
+		std::vector<XMFLOAT3> MoverVelocities;
+		std::vector<UHPointLightComponent*> PointLights;
+		if (bInitialized)
+		{
+			UniquePtr<UHScene> NewScene = MakeUnique<UHScene>();
+			Camera = (UHCameraComponent*)NewScene->RequestComponent(UHCameraComponent::ClassId);
+			UHDirectionalLightComponent* DirLight = (UHDirectionalLightComponent*)NewScene->RequestComponent(UHDirectionalLightComponent::ClassId);
+			DirLight->SetRotation(XMFLOAT3(45.0f, 30.0f, 0.0f));
+
+			// one in twenty renderers is translucent and one in ten is masked, 2% of renderers keep moving
+			for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+			{
+				UHMeshRendererComponent* Renderer = (UHMeshRendererComponent*)NewScene->RequestComponent(UHMeshRendererComponent::ClassId);
+				const uint32_t MeshIdx = NextRandom() % NumMeshes;
+				const uint32_t MaterialRoll = NextRandom() % 20;
+				const uint32_t MaterialIdx = (MaterialRoll == 0) ? 5 : (MaterialRoll < 3) ? 4 : MeshIdx % 4;
+				Renderer->SetMesh(Meshes[MeshIdx].get());
+				Renderer->SetMaterial(Materials[MaterialIdx].get());
+				Renderer->SetPosition(XMFLOAT3((NextRandom() % 20001) * 0.1f - 1000.0f, 0.0f, (NextRandom() % 20001) * 0.1f - 1000.0f));
+
+				const float Width = 2.0f + (NextRandom() % 80) * 0.1f;
+				Renderer->SetScale(XMFLOAT3(Width, 1.0f + (NextRandom() % 40) * 0.1f, Width));
+				if (NextRandom() % 50 == 0)
+				{
+					Renderer->SetMoveable(true);
+					Movers.push_back(Renderer);
+					MoverVelocities.push_back(XMFLOAT3((NextRandom() % 201) * 0.002f - 0.2f, 0.0f, (NextRandom() % 201) * 0.002f - 0.2f));
+				}
+			}
+
+			for (uint32_t Idx = 0; Idx < NumPointLights; Idx++)
+			{
+				UHPointLightComponent* Light = (UHPointLightComponent*)NewScene->RequestComponent(UHPointLightComponent::ClassId);
+				Light->SetPosition(XMFLOAT3((NextRandom() % 20001) * 0.1f - 1000.0f, 5.0f, (NextRandom() % 20001) * 0.1f - 1000.0f));
+				Light->SetRadius(10.0f + (NextRandom() % 200) * 0.1f);
+				Light->SetLightColor(XMFLOAT3(1.0f, 0.8f, 0.6f));
+				PointLights.push_back(Light);
+			}
+
+			// bounds of renderers are calculated when they're updated, the same as loading a scene
+			for (const UniquePtr<UHComponent>& Comp : NewScene->GetAllCompoments())
+			{
+				Comp->Update();
+			}
+
+			Scene = NewScene.get();
+			bInitialized = Engine->InitHeadlessScene(std::move(NewScene));
+		}
+
+		Result.InitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - InitStartTime).count();
+		NumMovers = static_cast<uint32_t>(Movers.size());
+		if (!bInitialized)
+		{
+			NumErrors++;
+		}
+
+		std::vector<std::vector<double>> StageTimes(NumStages);
+		std::vector<std::vector<uint64_t>> StageAllocations(NumStages);
+		std::vector<std::vector<uint64_t>> StageBytes(NumStages);
+		UHDeferredShadingRenderer* SceneRenderer = Engine->GetSceneRenderer();
+		for (uint32_t Frame = 0; Frame < NumFrames && bInitialized; Frame++)
+		{
+			// the camera circles the city center and looks slightly down along the path
+			const float Angle = XM_2PI * static_cast<float>(Frame) / static_cast<float>(NumFrames);
+			Camera->SetPosition(XMFLOAT3(std::sin(Angle) * 400.0f, 40.0f, std::cos(Angle) * 400.0f));
+			Camera->SetRotation(XMFLOAT3(10.0f, XMConvertToDegrees(Angle) + 90.0f, 0.0f));
+
+			for (size_t Idx = 0; Idx < Movers.size(); Idx++)
+			{
+				Movers[Idx]->Translate(MoverVelocities[Idx], UHTransformSpace::World);
+			}
+
+			// a quarter of point lights flicker up and down
+			for (size_t Idx = 0; Idx < PointLights.size(); Idx += 4)
+			{
+				XMFLOAT3 Position = PointLights[Idx]->GetPosition();
+				Position.y = 5.0f + std::sin(Frame * 0.1f + static_cast<float>(Idx));
+				PointLights[Idx]->SetPosition(Position);
+			}
+
+			double FrameMs = 0.0;
+			uint64_t FrameAllocations = 0;
+			uint64_t FrameBytes = 0;
+			for (int32_t Stage = 0; Stage < NumStages - 1; Stage++)
+			{
+				const uint64_t AllocationsBefore = GNumAllocations.load();
+				const uint64_t BytesBefore = GNumAllocatedBytes.load();
+				bCountsAllocations = SetAllocationCounting(true);
+				const std::chrono::steady_clock::time_point StageStartTime = std::chrono::steady_clock::now();
+
+				if (Stage == 0)
+				{
+					Scene->Update();
+				}
+				else
+				{
+					SceneRenderer->RunUpdateStage(static_cast<UHRendererUpdateStage>(Stage - 1));
+				}
+
+				const double StageMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StageStartTime).count();
+				SetAllocationCounting(false);
+
+				if (Frame >= NumWarmupFrames)
+				{
+					StageTimes[Stage].push_back(StageMs);
+					StageAllocations[Stage].push_back(GNumAllocations.load() - AllocationsBefore);
+					StageBytes[Stage].push_back(GNumAllocatedBytes.load() - BytesBefore);
+					FrameMs += StageMs;
+					FrameAllocations += StageAllocations[Stage].back();
+					FrameBytes += StageBytes[Stage].back();
+				}
+			}
+
+			if (Frame >= NumWarmupFrames)
+			{
+				StageTimes[NumStages - 1].push_back(FrameMs);
+				StageAllocations[NumStages - 1].push_back(FrameAllocations);
+				StageBytes[NumStages - 1].push_back(FrameBytes);
+			}
+
+			const UHCullingBounds& Bounds = Scene->GetRendererBounds();
+			uint32_t NumVisible = 0;
+			for (int32_t Idx = 0; Idx < static_cast<int32_t>(Bounds.GetCount()); Idx++)
+			{
+				NumVisible += Bounds.IsVisible(Idx) ? 1 : 0;
+			}
+			Result.NumVisible.push_back(NumVisible);
+			Result.NumToDraw.push_back(static_cast<uint32_t>(SceneRenderer->GetNumRenderersToDraw()));
+
+			SceneRenderer->AdvanceFrameHeadless();
+			GFrameNumber++;
+		}
+
+		for (int32_t Stage = 0; Stage < NumStages && bInitialized; Stage++)
+		{
+			std::vector<double>& Times = StageTimes[Stage];
+			std::vector<uint64_t>& Allocations = StageAllocations[Stage];
+			std::vector<uint64_t>& Bytes = StageBytes[Stage];
+			UHFrameStageStats Stats{};
+			if (Times.size() > 0)
+			{
+				Stats.MeanMs = std::accumulate(Times.begin(), Times.end(), 0.0) / Times.size();
+				std::sort(Times.begin(), Times.end());
+				std::sort(Allocations.begin(), Allocations.end());
+				std::sort(Bytes.begin(), Bytes.end());
+				Stats.MedianMs = Times[Times.size() / 2];
+				Stats.P99Ms = Times[(std::min)(Times.size() - 1, Times.size() * 99 / 100)];
+				Stats.MaxMs = Times.back();
+				Stats.MedianAllocations = Allocations[Allocations.size() / 2];
+				Stats.MaxAllocations = Allocations.back();
+				Stats.MedianBytes = Bytes[Bytes.size() / 2];
+			}
+			Result.Stages.push_back(Stats);
+		}
+
+		Engine->ReleaseHeadlessEngine();
+		Engine.reset();
+		Materials.clear();
+		for (UniquePtr<UHMesh>& Mesh : Meshes)
+		{
+			Mesh->ReleaseCPUMeshData();
+			Mesh->Release();
+		}
+		Meshes.clear();
+	}
+	std::filesystem::remove_all(BenchmarkFolder);
+
+	// frustum visibility doesn't depend on the renderer path, and only software occlusion can skip visible renderers
+	// the mesh shader path leaves occlusion to the GPU, so it draws every visible renderer
+	uint32_t NumVisibleFrames = 0;
+	for (int32_t PathIdx = 0; PathIdx < NumPaths; PathIdx++)
+	{
+		const UHFramePathResult& Result = Results[PathIdx];
+		NumErrors += (Result.NumVisible != Results[0].NumVisible) ? 1 : 0;
+		for (size_t Frame = 0; Frame < Result.NumVisible.size(); Frame++)
+		{
+			NumErrors += (Result.NumToDraw[Frame] > Result.NumVisible[Frame]) ? 1 : 0;
+			NumErrors += (Paths[PathIdx].bMeshShader && Result.NumToDraw[Frame] != Result.NumVisible[Frame]) ? 1 : 0;
+			NumVisibleFrames += (PathIdx == 0 && Result.NumVisible[Frame] > 0) ? 1 : 0;
+		}
+	}
+	NumErrors += (NumVisibleFrames == 0) ? 1 : 0;
+
+	std::string Json = "{\n";
+	Json += "  \"renderers\": " + std::to_string(NumRenderers) + ",\n";
+	Json += "  \"movingRenderers\": " + std::to_string(NumMovers) + ",\n";
+	Json += "  \"pointLights\": " + std::to_string(NumPointLights) + ",\n";
+	Json += "  \"frames\": " + std::to_string(NumFrames) + ",\n";
+	Json += "  \"warmupFrames\": " + std::to_string(NumWarmupFrames) + ",\n";
+	Json += "  \"workerThreads\": " + std::to_string(NumWorkerThreads) + ",\n";
+	Json += "  \"allocationsCounted\": " + std::string(bCountsAllocations ? "true" : "false") + ",\n";
+	Json += "  \"errors\": " + std::to_string(NumErrors) + ",\n";
+	Json += "  \"paths\": [\n";
+
+	std::wstring Summary = L"Frame benchmark, " + std::to_wstring(NumRenderers) + L" renderers, " + std::to_wstring(NumMovers) + L" moving, "
+		+ std::to_wstring(NumPointLights) + L" point lights, " + std::to_wstring(NumMeasuredFrames) + L" measured frames after "
+		+ std::to_wstring(NumWarmupFrames) + L" warmup frames\n";
+	if (!bCountsAllocations)
+	{
+		Summary += L"Allocations aren't counted in this build, use a debug build or define WITH_ALLOCATION_COUNTING\n";
+	}
+	for (int32_t PathIdx = 0; PathIdx < NumPaths; PathIdx++)
+	{
+		const UHFramePathResult& Result = Results[PathIdx];
+		const uint64_t VisibleSum = std::accumulate(Result.NumVisible.begin(), Result.NumVisible.end(), 0ULL);
+		const uint64_t DrawSum = std::accumulate(Result.NumToDraw.begin(), Result.NumToDraw.end(), 0ULL);
+		const size_t NumResultFrames = (std::max)(Result.NumVisible.size(), static_cast<size_t>(1));
+
+		Json += "    {\n";
+		Json += "      \"name\": \"" + std::string(Paths[PathIdx].Name) + "\",\n";
+		Json += "      \"meshShader\": " + std::string(Paths[PathIdx].bMeshShader ? "true" : "false") + ",\n";
+		Json += "      \"drawIndirectFirstInstance\": " + std::string(Paths[PathIdx].bDrawIndirectFirstInstance ? "true" : "false") + ",\n";
+		Json += "      \"initSeconds\": " + std::to_string(Result.InitSeconds) + ",\n";
+		Json += "      \"averageVisibleRenderers\": " + std::to_string(static_cast<double>(VisibleSum) / NumResultFrames) + ",\n";
+		Json += "      \"averageRenderersToDraw\": " + std::to_string(static_cast<double>(DrawSum) / NumResultFrames) + ",\n";
+		Json += "      \"stages\": [\n";
+
+		Summary += UHUtilities::ToStringW(Paths[PathIdx].Name) + L" path, " + std::to_wstring(static_cast<double>(DrawSum) / NumResultFrames)
+			+ L" of " + std::to_wstring(static_cast<double>(VisibleSum) / NumResultFrames) + L" visible renderers drawn on average\n";
+		for (size_t Stage = 0; Stage < Result.Stages.size(); Stage++)
+		{
+			const UHFrameStageStats& Stats = Result.Stages[Stage];
+			Json += "        { \"name\": \"" + std::string(StageNames[Stage]) + "\", \"medianMs\": " + std::to_string(Stats.MedianMs)
+				+ ", \"p99Ms\": " + std::to_string(Stats.P99Ms) + ", \"meanMs\": " + std::to_string(Stats.MeanMs)
+				+ ", \"maxMs\": " + std::to_string(Stats.MaxMs) + ", \"medianAllocations\": " + std::to_string(Stats.MedianAllocations)
+				+ ", \"maxAllocations\": " + std::to_string(Stats.MaxAllocations) + ", \"medianAllocatedBytes\": " + std::to_string(Stats.MedianBytes)
+				+ ((Stage + 1 < Result.Stages.size()) ? " },\n" : " }\n");
+
+			Summary += L"  " + UHUtilities::ToStringW(StageNames[Stage]) + L": median " + std::to_wstring(Stats.MedianMs) + L" ms, p99 "
+				+ std::to_wstring(Stats.P99Ms) + L" ms";
+			Summary += bCountsAllocations ? L", " + std::to_wstring(Stats.MedianAllocations) + L" allocations (max "
+				+ std::to_wstring(Stats.MaxAllocations) + L")\n" : L"\n";
+		}
+
+		Json += "      ]\n";
+		Json += (PathIdx + 1 < NumPaths) ? "    },\n" : "    }\n";
+	}
+	Json += "  ]\n}\n";
+
+	const std::filesystem::path ResultPath = GProfileCapturePath + "FrameBenchmark.json";
+	std::error_code ErrorCode;
+	std::filesystem::create_directories(ResultPath.parent_path(), ErrorCode);
+	std::ofstream JsonOut(ResultPath, std::ios::out | std::ios::trunc);
+	JsonOut << Json;
+	JsonOut.close();
+	NumErrors += JsonOut.fail() ? 1 : 0;
+
+	UH_TOOL_CHECK(NumErrors == 0);
+	Summary += L"Results are exported to " + ResultPath.wstring() + L", " + std::to_wstring(NumErrors) + L" errors\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/TLSFAllocator.h"
+#include <chrono>
+
+// fuzzes the TLSF allocator with a random mix of GPU resource sizes and alignments, validating it along the way,
+// then reports the throughput and the fragmentation before and after defragmentation
+void BenchmarkGPUAllocator(const uint32_t NumOperations)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	const uint64_t PoolSize = 1024ull * 1048576;
+	UHTLSFAllocator Allocator;
+	Allocator.Initialize(PoolSize);
+
+	// mostly small buffers, with some textures up to 64 MB
+	std::vector<uint64_t> Offsets;
+	Offsets.reserve(NumOperations);
+	uint32_t NumAllocs = 0;
+	uint32_t NumFrees = 0;
+	uint32_t NumFailed = 0;
+
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for (uint32_t OpIdx = 0; OpIdx < NumOperations; OpIdx++)
+	{
+		if (Offsets.empty() || NextRandom() % 100 < 55)
+		{
+			const uint32_t SizeClass = NextRandom() % 100;
+			const uint64_t Size = (SizeClass < 70) ? 256 + NextRandom() % 65536
+				: (SizeClass < 97) ? 65536 + NextRandom() % (4 * 1048576) : 4 * 1048576 + NextRandom() % (60 * 1048576);
+			const uint64_t Alignment = 1ull << (4 + NextRandom() % 13);
+
+			const uint64_t Offset = Allocator.Allocate(Size, Alignment);
+			if (Offset != UHTLSFAllocator::InvalidOffset)
+			{
+				Offsets.push_back(Offset);
+				NumAllocs++;
+			}
+			else
+			{
+				NumFailed++;
+			}
+		}
+		else
+		{
+			const size_t Idx = NextRandom() % Offsets.size();
+			UH_TOOL_CHECK(Allocator.Free(Offsets[Idx]));
+			Offsets[Idx] = Offsets.back();
+			Offsets.pop_back();
+			NumFrees++;
+		}
+
+		// validation walks all blocks, only do it occasionally
+		if ((OpIdx & 4095) == 0)
+		{
+			UH_TOOL_CHECK(Allocator.Validate());
+		}
+	}
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	const auto GetFragmentation = [&Allocator]()
+	{
+		const uint64_t FreeSize = Allocator.GetSize() - Allocator.GetUsedSize();
+		return (FreeSize > 0) ? 1.0 - static_cast<double>(Allocator.GetLargestFreeSize()) / FreeSize : 0.0;
+	};
+
+	std::wstring Summary = L"GPU allocator benchmark, " + std::to_wstring(NumOperations) + L" operations on a "
+		+ std::to_wstring(PoolSize / 1048576) + L" MB pool\n"
+		+ std::to_wstring(NumAllocs) + L" allocations, " + std::to_wstring(NumFrees) + L" frees, " + std::to_wstring(NumFailed) + L" failed, "
+		+ std::to_wstring(Seconds * 1000000000.0 / NumOperations) + L" ns per operation\n"
+		+ L"Used " + std::to_wstring(Allocator.GetUsedSize() / 1048576) + L" MB in " + std::to_wstring(Allocator.GetAllocationCount())
+		+ L" allocations, " + std::to_wstring(Allocator.GetFreeBlockCount()) + L" free blocks, fragmentation " + std::to_wstring(GetFragmentation()) + L"\n";
+
+	// compact everything to see how much defragmentation recovers
+	std::vector<UHTLSFMove> Moves;
+	const std::chrono::steady_clock::time_point DefragStartTime = std::chrono::steady_clock::now();
+	Allocator.Defragment(~0u, Moves);
+	const double DefragSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - DefragStartTime).count();
+	UH_TOOL_CHECK(Allocator.Validate());
+
+	uint64_t MovedBytes = 0;
+	for (const UHTLSFMove& Move : Moves)
+	{
+		MovedBytes += Move.Size;
+	}
+
+	Summary += L"Defragmentation moved " + std::to_wstring(Moves.size()) + L" allocations (" + std::to_wstring(MovedBytes / 1048576) + L" MB) in "
+		+ std::to_wstring(DefragSeconds * 1000.0) + L" ms, " + std::to_wstring(Allocator.GetFreeBlockCount()) + L" free blocks, fragmentation "
+		+ std::to_wstring(GetFragmentation()) + L"\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
@@ -0,0 +1,223 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/InstanceBatcher.h"
+#include "../../Runtime/Classes/Material.h"
+#include "../../Runtime/Classes/Mesh.h"
+#include <chrono>
+#include <set>
+
+// builds the instanced batches of a forest-style scene, a few tree and rock meshes scattered around the camera plus some unique props,
+// and reports the draw calls and CPU recording time with and without batching, recording is emulated by writing commands to a list.
+// without an order window, each mesh and material pair must be drawn once, plus one draw for each renderer which can't be batched
+void BenchmarkInstancing(const uint32_t NumRenderers)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	// 8 tree meshes with 2 material variants, 4 rock meshes, the rest are unique props
+	const uint32_t NumTreeMeshes = 8;
+	const uint32_t NumRockMeshes = 4;
+	const uint32_t NumProps = (std::max)(NumRenderers / 100, 1u);
+	std::vector<UniquePtr<UHMesh>> Meshes;
+	for (uint32_t Idx = 0; Idx < NumTreeMeshes + NumRockMeshes + NumProps; Idx++)
+	{
+		Meshes.push_back(MakeUnique<UHMesh>("ForestMesh" + std::to_string(Idx)));
+	}
+
+	std::vector<UniquePtr<UHMaterial>> Materials;
+	for (uint32_t Idx = 0; Idx < 4; Idx++)
+	{
+		Materials.push_back(MakeUnique<UHMaterial>());
+	}
+
+	// renderers on a disc around the camera, the camera looks along +z with 90 degrees FOV, a few of them need their own draws
+	struct UHForestRenderer
+	{
+		const UHMesh* Mesh;
+		const UHMaterial* Material;
+		float SquareDistance;
+		bool bCanBatch;
+	};
+
+	std::vector<UHForestRenderer> VisibleRenderers;
+	for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+	{
+		const float X = (NextRandom() % 20001) * 0.1f - 1000.0f;
+		const float Z = (NextRandom() % 20001) * 0.1f - 1000.0f;
+		if (Z <= 0.0f || std::abs(X) > Z)
+		{
+			continue;
+		}
+
+		UHForestRenderer Renderer;
+		const uint32_t Kind = NextRandom() % 100;
+		if (Kind < 70)
+		{
+			Renderer.Mesh = Meshes[NextRandom() % NumTreeMeshes].get();
+			Renderer.Material = Materials[NextRandom() % 2].get();
+		}
+		else if (Kind < 99)
+		{
+			Renderer.Mesh = Meshes[NumTreeMeshes + NextRandom() % NumRockMeshes].get();
+			Renderer.Material = Materials[2].get();
+		}
+		else
+		{
+			Renderer.Mesh = Meshes[NumTreeMeshes + NumRockMeshes + NextRandom() % NumProps].get();
+			Renderer.Material = Materials[3].get();
+		}
+		Renderer.SquareDistance = X * X + Z * Z;
+		Renderer.bCanBatch = NextRandom() % 200 != 0;
+		VisibleRenderers.push_back(Renderer);
+	}
+
+	// front-to-back with the same counting sort granularity as the renderer
+	const int32_t MaxCountingElement = 4096;
+	const float MaxSquareDistance = 2.0f * 1000.0f * 1000.0f;
+	std::vector<std::vector<int32_t>> CountingRenderers(MaxCountingElement);
+	for (int32_t Idx = 0; Idx < static_cast<int32_t>(VisibleRenderers.size()); Idx++)
+	{
+		const int32_t CountingIndex = (std::min)(static_cast<int32_t>(VisibleRenderers[Idx].SquareDistance / MaxSquareDistance * MaxCountingElement)
+			, MaxCountingElement - 1);
+		CountingRenderers[CountingIndex].push_back(Idx);
+	}
+
+	// renderer index of an item is its front-to-back rank, so the order displacement of an instance is |draw position - renderer index|
+	std::vector<UHInstanceBatchItem> Items;
+	for (const std::vector<int32_t>& Bucket : CountingRenderers)
+	{
+		for (const int32_t RendererIdx : Bucket)
+		{
+			const UHForestRenderer& Renderer = VisibleRenderers[RendererIdx];
+			const UHInstanceBatchItem Item{ Renderer.Mesh, Renderer.Material, static_cast<uint32_t>(Items.size()), Renderer.bCanBatch };
+			Items.push_back(Item);
+		}
+	}
+
+	// the expected draw count without an order window
+	std::set<std::pair<const UHMesh*, const UHMaterial*>> UniquePairs;
+	size_t NumUnbatchable = 0;
+	for (const UHInstanceBatchItem& Item : Items)
+	{
+		if (Item.bCanBatch)
+		{
+			UniquePairs.insert(std::make_pair(Item.Mesh, Item.Material));
+		}
+		else
+		{
+			NumUnbatchable++;
+		}
+	}
+	const size_t NumExpectedDraws = UniquePairs.size() + NumUnbatchable;
+
+	// emulated command list, a draw binds state, vertex buffer, index buffer and descriptors like the passes do
+	struct UHEmulatedCommand
+	{
+		uint32_t Type;
+		const void* Object;
+		uint32_t Count;
+		uint32_t FirstInstance;
+	};
+	std::vector<UHEmulatedCommand> Commands;
+	Commands.reserve(Items.size() * 5);
+
+	const int32_t NumRuns = 20;
+	double UnbatchedSeconds = 0.0;
+	for (int32_t Run = 0; Run < NumRuns; Run++)
+	{
+		Commands.clear();
+		const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		for (const UHInstanceBatchItem& Item : Items)
+		{
+			Commands.push_back(UHEmulatedCommand{ 0, Item.Material, 0, 0 });
+			Commands.push_back(UHEmulatedCommand{ 1, Item.Mesh, 0, 0 });
+			Commands.push_back(UHEmulatedCommand{ 2, Item.Mesh, 0, 0 });
+			Commands.push_back(UHEmulatedCommand{ 3, Item.Material, Item.RendererIndex, 0 });
+			Commands.push_back(UHEmulatedCommand{ 4, Item.Mesh, 1, Item.RendererIndex });
+		}
+		UnbatchedSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	}
+
+	std::wstring Summary = L"Instancing benchmark, " + std::to_wstring(NumRenderers) + L" renderers, " + std::to_wstring(Items.size())
+		+ L" visible, " + std::to_wstring(Meshes.size()) + L" meshes\n"
+		+ L"Unbatched: " + std::to_wstring(Items.size()) + L" draw calls, recording " + std::to_wstring(UnbatchedSeconds * 1000.0 / NumRuns) + L" ms\n";
+
+	const int32_t OrderWindows[] = { 256, 1024, 8192, INT32_MAX };
+	for (const int32_t OrderWindow : OrderWindows)
+	{
+		UHInstanceBatcher Batcher(OrderWindow);
+		std::vector<UHInstanceBatch> Batches;
+		std::vector<uint32_t> Instances;
+		Batches.reserve(Items.size());
+		Instances.reserve(Items.size());
+
+		double BuildSeconds = 0.0;
+		double RecordSeconds = 0.0;
+		for (int32_t Run = 0; Run < NumRuns; Run++)
+		{
+			Batches.clear();
+			Instances.clear();
+			const std::chrono::steady_clock::time_point BuildStartTime = std::chrono::steady_clock::now();
+			Batcher.Build(Items, Batches, Instances);
+			BuildSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - BuildStartTime).count();
+
+			Commands.clear();
+			const std::chrono::steady_clock::time_point RecordStartTime = std::chrono::steady_clock::now();
+			for (const UHInstanceBatch& Batch : Batches)
+			{
+				const UHInstanceBatchItem& Item = Items[Batch.FirstItem];
+				Commands.push_back(UHEmulatedCommand{ 0, Item.Material, 0, 0 });
+				Commands.push_back(UHEmulatedCommand{ 1, Item.Mesh, 0, 0 });
+				Commands.push_back(UHEmulatedCommand{ 2, Item.Mesh, 0, 0 });
+				Commands.push_back(UHEmulatedCommand{ 3, Item.Material, Item.RendererIndex, 0 });
+				Commands.push_back(UHEmulatedCommand{ 4, Item.Mesh, Batch.InstanceCount, Batch.FirstInstance });
+			}
+			RecordSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - RecordStartTime).count();
+		}
+
+		double SumDisplacement = 0.0;
+		for (size_t Idx = 0; Idx < Instances.size(); Idx++)
+		{
+			SumDisplacement += std::abs(static_cast<double>(Idx) - static_cast<double>(Instances[Idx]));
+		}
+
+		// every visible renderer is drawn exactly once, and instances of a batch share the mesh and material of its first item
+		uint32_t NumTotalInstances = 0;
+		uint32_t NumMismatchedInstances = 0;
+		std::vector<uint8_t> IsDrawn(Items.size(), 0);
+		for (const UHInstanceBatch& Batch : Batches)
+		{
+			NumTotalInstances += Batch.InstanceCount;
+			const UHInstanceBatchItem& FirstItem = Items[Batch.FirstItem];
+			for (uint32_t InstanceIdx = Batch.FirstInstance; InstanceIdx < Batch.FirstInstance + Batch.InstanceCount; InstanceIdx++)
+			{
+				const UHInstanceBatchItem& Item = Items[Instances[InstanceIdx]];
+				NumMismatchedInstances += (Item.Mesh != FirstItem.Mesh || Item.Material != FirstItem.Material || IsDrawn[Instances[InstanceIdx]]) ? 1 : 0;
+				IsDrawn[Instances[InstanceIdx]] = 1;
+			}
+		}
+		UH_TOOL_CHECK(NumTotalInstances == Items.size() && Instances.size() == Items.size());
+		UH_TOOL_CHECK(NumMismatchedInstances == 0);
+		UH_TOOL_CHECK(OrderWindow == INT32_MAX ? Batches.size() == NumExpectedDraws : Batches.size() >= NumExpectedDraws);
+
+		Summary += L"Order window " + ((OrderWindow == INT32_MAX) ? std::wstring(L"unlimited") : std::to_wstring(OrderWindow)) + L": "
+			+ std::to_wstring(Batches.size()) + L" draw calls, " + std::to_wstring(static_cast<double>(Instances.size()) / (std::max)(Batches.size(), size_t(1)))
+			+ L" instances per draw, build " + std::to_wstring(BuildSeconds * 1000.0 / NumRuns) + L" ms, recording "
+			+ std::to_wstring(RecordSeconds * 1000.0 / NumRuns) + L" ms, mean front-to-back displacement "
+			+ std::to_wstring(SumDisplacement / (std::max)(Instances.size(), size_t(1))) + L"\n";
+	}
+
+	Summary += L"Expected " + std::to_wstring(NumExpectedDraws) + L" draw calls without an order window: " + std::to_wstring(UniquePairs.size())
+		+ L" mesh and material pairs, " + std::to_wstring(NumUnbatchable) + L" renderers which can't be batched\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
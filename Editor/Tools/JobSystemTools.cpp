@@ -0,0 +1,332 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/JobSystem.h"
+#include "../../Runtime/Classes/Thread.h"
+#include "../../Runtime/CoreGlobals.h"
+#include <chrono>
+
+// stress tests the job system with zero, one and all workers
+// every index of a parallel-for must be visited once with a valid worker index, jobs must never start before their dependency,
+// even when there are more deferred jobs than the job pool can hold, and short-lived external threads must get contexts of their own
+void TestJobSystem()
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	const int32_t MaxWorkers = (std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 1);
+	const int32_t WorkerCounts[] = { 0, 1, MaxWorkers };
+
+	class UHGateTask : public UHAsyncTask
+	{
+	public:
+		UHGateTask()
+			: bIsDone(false)
+		{
+		}
+
+		void DoTask(const int32_t ThreadIndex) override
+		{
+			// long enough for the dependent jobs to pile up
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			bIsDone = true;
+		}
+
+		std::atomic<bool> bIsDone;
+	};
+
+	class UHDependentTask : public UHAsyncTask
+	{
+	public:
+		void DoTask(const int32_t ThreadIndex) override
+		{
+			NumEarly->fetch_add(Gate->bIsDone.load() ? 0 : 1);
+			NumRun->fetch_add(1);
+		}
+
+		const UHGateTask* Gate;
+		std::atomic<uint32_t>* NumEarly;
+		std::atomic<uint32_t>* NumRun;
+	};
+
+	std::wstring Summary = L"Job system test, up to " + std::to_wstring(MaxWorkers) + L" workers\n";
+	for (const int32_t NumWorkers : WorkerCounts)
+	{
+		UHJobSystem JobSystem;
+		JobSystem.Initialize(NumWorkers);
+		const int32_t NumContexts = JobSystem.GetNumContexts();
+
+		// parallel-for coverage, grain sizes are smaller and larger than the counts
+		const int32_t Counts[] = { 1, 7, 1000, 100003 };
+		const int32_t Grains[] = { 1, 8, 5000 };
+		std::vector<std::atomic<uint32_t>> Visits(Counts[3]);
+		uint32_t NumCoverageErrors = 0;
+		for (const int32_t Count : Counts)
+		{
+			for (const int32_t Grain : Grains)
+			{
+				for (int32_t Idx = 0; Idx < Count; Idx++)
+				{
+					Visits[Idx] = 0;
+				}
+
+				std::atomic<uint32_t> NumBadWorkers(0);
+				JobSystem.ParallelFor(Count, Grain, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+					{
+						NumBadWorkers.fetch_add((WorkerIdx < 0 || WorkerIdx >= NumContexts) ? 1 : 0);
+						for (int32_t Idx = Begin; Idx < End; Idx++)
+						{
+							Visits[Idx]++;
+						}
+					});
+
+				for (int32_t Idx = 0; Idx < Count; Idx++)
+				{
+					NumCoverageErrors += (Visits[Idx] != 1) ? 1 : 0;
+				}
+				NumCoverageErrors += NumBadWorkers;
+			}
+		}
+		UH_TOOL_CHECK(NumCoverageErrors == 0);
+
+		// dependency ordering, the first round has more dependent jobs than a job page and the second more than the pool can ever hold
+		// so the pool grows in the first round and the scheduling thread has to help finishing jobs in the second
+		const int32_t DependentCounts[] = { 3000, static_cast<int32_t>(UHJobSystem::JobsPerPage * UHJobSystem::MaxJobPages) + 1000 };
+		uint32_t NumEarlyJobs = 0;
+		for (const int32_t NumDependents : DependentCounts)
+		{
+			UHGateTask Gate;
+			std::atomic<uint32_t> NumEarly(0);
+			std::atomic<uint32_t> NumRun(0);
+			std::vector<UHDependentTask> Dependents(NumDependents);
+
+			// a dependent parallel-for checks the gate as well
+			std::atomic<uint32_t> NumRangeVisits(0);
+			const UHParallelForFunction RangeFunction = [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+				{
+					NumEarly.fetch_add(Gate.bIsDone.load() ? 0 : 1);
+					NumRangeVisits.fetch_add(End - Begin);
+				};
+
+			UHJobCounter GateCounter;
+			UHJobCounter DependentCounter;
+			JobSystem.Schedule(&Gate, &GateCounter);
+			JobSystem.ScheduleParallelFor(10000, 16, &RangeFunction, &DependentCounter, &GateCounter);
+			for (UHDependentTask& Dependent : Dependents)
+			{
+				Dependent.Gate = &Gate;
+				Dependent.NumEarly = &NumEarly;
+				Dependent.NumRun = &NumRun;
+				JobSystem.Schedule(&Dependent, &DependentCounter, &GateCounter);
+			}
+			JobSystem.Wait(&DependentCounter);
+
+			UH_TOOL_CHECK(NumEarly == 0);
+			UH_TOOL_CHECK(NumRun == static_cast<uint32_t>(NumDependents));
+			UH_TOOL_CHECK(NumRangeVisits == 10000);
+			UH_TOOL_CHECK(GateCounter.IsDone() && DependentCounter.IsDone());
+			NumEarlyJobs += NumEarly;
+		}
+
+		// chained stages, every job of a stage checks the previous stage is complete
+		const int32_t NumStages = 64;
+		const int32_t JobsPerStage = 64;
+		std::vector<std::atomic<int32_t>> StageDone(NumStages);
+		std::vector<UHJobCounter> StageCounters(NumStages);
+		std::vector<UHParallelForFunction> StageFunctions(NumStages);
+		std::atomic<uint32_t> NumChainErrors(0);
+		for (int32_t Stage = 0; Stage < NumStages; Stage++)
+		{
+			StageDone[Stage] = 0;
+			StageFunctions[Stage] = [&, Stage](int32_t Begin, int32_t End, int32_t WorkerIdx)
+				{
+					NumChainErrors.fetch_add((Stage > 0 && StageDone[Stage - 1] != JobsPerStage) ? 1 : 0);
+					StageDone[Stage].fetch_add(End - Begin);
+				};
+			JobSystem.ScheduleParallelFor(JobsPerStage, 1, &StageFunctions[Stage], &StageCounters[Stage]
+				, (Stage > 0) ? &StageCounters[Stage - 1] : nullptr);
+		}
+		JobSystem.Wait(&StageCounters[NumStages - 1]);
+		UH_TOOL_CHECK(NumChainErrors == 0);
+
+		// more short-lived external threads than external contexts in total, they must give the contexts back when they exit
+		const int32_t NumRounds = 8;
+		const int32_t ThreadsPerRound = 12;
+		std::atomic<uint32_t> NumExternalErrors(0);
+		for (int32_t Round = 0; Round < NumRounds; Round++)
+		{
+			std::vector<std::thread> Threads;
+			for (int32_t ThreadIdx = 0; ThreadIdx < ThreadsPerRound; ThreadIdx++)
+			{
+				Threads.push_back(std::thread([&]()
+					{
+						std::vector<std::atomic<uint32_t>> ThreadVisits(1000);
+						JobSystem.ParallelFor(1000, 1, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+							{
+								for (int32_t Idx = Begin; Idx < End; Idx++)
+								{
+									ThreadVisits[Idx]++;
+								}
+							});
+
+						for (const std::atomic<uint32_t>& Visit : ThreadVisits)
+						{
+							NumExternalErrors.fetch_add((Visit != 1) ? 1 : 0);
+						}
+					}));
+			}
+
+			for (std::thread& Thread : Threads)
+			{
+				Thread.join();
+			}
+		}
+		UH_TOOL_CHECK(NumExternalErrors == 0);
+
+		JobSystem.Release();
+		Summary += std::to_wstring(NumWorkers) + L" workers: " + std::to_wstring(NumCoverageErrors) + L" parallel-for coverage errors, "
+			+ std::to_wstring(NumEarlyJobs) + L" jobs started before their dependency, " + std::to_wstring(NumChainErrors.load())
+			+ L" chain errors, " + std::to_wstring(NumExternalErrors.load()) + L" external thread errors\n";
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// runs parallel stages with the job system and with the previous UHThread path, which woke every thread with a fixed equal range
+// and waited them one by one, the first eighth of items are 16 times heavier like a few expensive meshes sorted together
+// the light stage has one item per worker and measures the round trip cost of a stage, results of both paths must match
+void BenchmarkJobSystem(const uint32_t NumItems)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	const int32_t NumWorkers = (std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 1);
+	const int32_t NumStages = 200;
+
+	std::vector<uint32_t> Weights(NumItems);
+	for (uint32_t Idx = 0; Idx < NumItems; Idx++)
+	{
+		Weights[Idx] = (Idx < NumItems / 8) ? 256 : 16;
+	}
+
+	std::vector<float> Results(NumItems);
+	const UHParallelForFunction WorkFunction = [&Weights, &Results](int32_t Begin, int32_t End, int32_t WorkerIdx)
+		{
+			for (int32_t Idx = Begin; Idx < End; Idx++)
+			{
+				float Value = static_cast<float>(Idx);
+				for (uint32_t Iter = 0; Iter < Weights[Idx]; Iter++)
+				{
+					Value = Value * 0.999f + 1.0f;
+				}
+				Results[Idx] = Value;
+			}
+		};
+
+	class UHRangeTask : public UHAsyncTask
+	{
+	public:
+		void DoTask(const int32_t ThreadIndex) override
+		{
+			(*Function)(Begin, End, ThreadIndex);
+		}
+
+		const UHParallelForFunction* Function;
+		int32_t Begin;
+		int32_t End;
+	};
+
+	// the previous path, the same loop as the renderer workers had
+	std::vector<UniquePtr<UHThread>> Threads(NumWorkers);
+	for (int32_t Idx = 0; Idx < NumWorkers; Idx++)
+	{
+		Threads[Idx] = MakeUnique<UHThread>();
+		UHThread* Thread = Threads[Idx].get();
+		Thread->BeginThread(std::thread([Thread, Idx]()
+			{
+				while (true)
+				{
+					Thread->WaitNotify();
+					if (Thread->IsTermindate())
+					{
+						break;
+					}
+
+					Thread->DoTask(Idx);
+					Thread->NotifyTaskDone();
+				}
+			}), GWorkerThreadAffinity + Idx);
+	}
+
+	std::vector<UHRangeTask> Tasks(NumWorkers);
+	const auto RunThreadStage = [&](const int32_t Count)
+		{
+			for (int32_t Idx = 0; Idx < NumWorkers; Idx++)
+			{
+				Tasks[Idx].Function = &WorkFunction;
+				Tasks[Idx].Begin = Count * Idx / NumWorkers;
+				Tasks[Idx].End = Count * (Idx + 1) / NumWorkers;
+				Threads[Idx]->ScheduleTask(&Tasks[Idx]);
+				Threads[Idx]->WakeThread();
+			}
+
+			for (int32_t Idx = 0; Idx < NumWorkers; Idx++)
+			{
+				Threads[Idx]->WaitTask();
+			}
+		};
+
+	UHJobSystem JobSystem;
+	JobSystem.Initialize(NumWorkers, GWorkerThreadAffinity);
+	const auto RunJobStage = [&](const int32_t Count)
+		{
+			JobSystem.ParallelFor(Count, 1, WorkFunction);
+		};
+
+	// index 0 for the UHThread path and 1 for the job system, the heavy stage first and then the light stage
+	double StageMs[2][2] = {};
+	double Checksums[2] = {};
+	const int32_t StageCounts[2] = { static_cast<int32_t>(NumItems), NumWorkers };
+	for (int32_t PathIdx = 0; PathIdx < 2; PathIdx++)
+	{
+		for (int32_t StageIdx = 0; StageIdx < 2; StageIdx++)
+		{
+			const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+			for (int32_t Stage = 0; Stage < NumStages; Stage++)
+			{
+				if (PathIdx == 0)
+				{
+					RunThreadStage(StageCounts[StageIdx]);
+				}
+				else
+				{
+					RunJobStage(StageCounts[StageIdx]);
+				}
+			}
+			StageMs[PathIdx][StageIdx] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count() / NumStages;
+
+			if (StageIdx == 0)
+			{
+				for (const float Result : Results)
+				{
+					Checksums[PathIdx] += Result;
+				}
+				std::fill(Results.begin(), Results.end(), 0.0f);
+			}
+		}
+	}
+
+	JobSystem.Release();
+	Threads.clear();
+
+	UH_TOOL_CHECK(Checksums[0] == Checksums[1]);
+	std::wstring Summary = L"Job system benchmark, " + std::to_wstring(NumItems) + L" items, " + std::to_wstring(NumWorkers) + L" workers, "
+		+ std::to_wstring(NumStages) + L" stages per run\n";
+	Summary += L"Heavy stage: UHThread " + std::to_wstring(StageMs[0][0]) + L" ms, job system " + std::to_wstring(StageMs[1][0]) + L" ms, "
+		+ std::to_wstring(StageMs[0][0] / (std::max)(StageMs[1][0], 1e-6)) + L"x\n";
+	Summary += L"Light stage: UHThread " + std::to_wstring(StageMs[0][1] * 1000.0) + L" us, job system " + std::to_wstring(StageMs[1][1] * 1000.0)
+		+ L" us, " + std::to_wstring(StageMs[0][1] / (std::max)(StageMs[1][1], 1e-6)) + L"x\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
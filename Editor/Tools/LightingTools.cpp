@@ -0,0 +1,204 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/LightClustering.h"
+#include "../../Runtime/Classes/FrustumCulling.h"
+#include <chrono>
+
+// assigns lights of a city-style scene to clusters with increasing light counts up to the given number
+// the SIMD kernels are compared with the scalar reference, and the ranges of sampled lights are validated against points on their spheres
+// every cluster a point falls in must list the light, the lists must be sorted and the counts must sum up to the number of indices
+void BenchmarkLightClustering(const uint32_t MaxLights)
+{
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+	const auto NextFloat = [&NextRandom]()
+	{
+		return (NextRandom() % 65536) / 65536.0f;
+	};
+
+	// the same view and projection as the camera component, reversed-z with an infinite far plane
+	const uint32_t Width = 1920;
+	const uint32_t Height = 1080;
+	const float FovY = XMConvertToRadians(60.0f);
+	const float NearPlane = 0.1f;
+	const float CullingDistance = 1000.0f;
+	XMFLOAT4X4 Proj;
+	XMStoreFloat4x4(&Proj, XMMatrixPerspectiveFovRH(FovY, static_cast<float>(Width) / Height, NearPlane + 1, NearPlane));
+	Proj(2, 2) = 0.0f;
+	Proj(3, 2) = NearPlane;
+
+	const XMFLOAT3 Position(0.0f, 1.7f, 0.0f);
+	const XMFLOAT3 Forward(0.0f, 0.0f, 1.0f);
+	const XMFLOAT3 Up(0.0f, 1.0f, 0.0f);
+	XMFLOAT4X4 View;
+	XMStoreFloat4x4(&View, XMMatrixLookToRH(XMLoadFloat3(&Position), XMLoadFloat3(&Forward), -XMLoadFloat3(&Up)));
+
+	const UHLightClusterView ClusterView = UHLightClustering::BuildView(Width, Height, View, Proj, NearPlane, CullingDistance);
+	const UHCullingSIMDLevel BestLevel = UHFrustumCulling::GetSIMDLevel();
+	const int32_t NumRuns = 10;
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	std::wstring Summary = L"Light clustering benchmark, " + std::to_wstring(Width) + L"x" + std::to_wstring(Height) + L", "
+		+ std::to_wstring(ClusterView.CountX) + L"x" + std::to_wstring(ClusterView.CountY) + L"x" + std::to_wstring(UHLightClusterView::NumSlices)
+		+ L" clusters, SIMD level " + std::to_wstring(UH_ENUM_VALUE(BestLevel)) + L"\n";
+
+	std::vector<uint32_t> LightCounts;
+	for (uint32_t Count = 1024; Count < MaxLights; Count *= 4)
+	{
+		LightCounts.push_back(Count);
+	}
+	LightCounts.push_back(MaxLights);
+
+	for (const uint32_t NumLights : LightCounts)
+	{
+		// a quarter of the lights are spot lights, all of them are scattered around the camera with a light per 144 square meters
+		const uint32_t NumSpotLights = NumLights / 4;
+		const uint32_t NumPointLights = NumLights - NumSpotLights;
+		const float AreaSize = 12.0f * std::sqrt(static_cast<float>(NumLights));
+		UHLightClusterSpheres Spheres;
+		Spheres.Resize(NumPointLights, NumSpotLights);
+		for (uint32_t Idx = 0; Idx < NumLights; Idx++)
+		{
+			const XMFLOAT3 LightPos((NextFloat() - 0.5f) * AreaSize, NextFloat() * 10.0f, (NextFloat() - 0.5f) * AreaSize);
+			const float Range = 2.0f + NextFloat() * 8.0f;
+			if (Idx < NumPointLights)
+			{
+				Spheres.SetSphere(Idx, LightPos, Range);
+				continue;
+			}
+
+			XMFLOAT3 Dir;
+			XMStoreFloat3(&Dir, XMVector3Normalize(XMVectorSet(NextFloat() - 0.5f, -NextFloat(), NextFloat() - 0.5f, 0.0f)));
+			const float Angle = XMConvertToRadians(10.0f + NextFloat() * 80.0f);
+			const XMFLOAT4 Bound = UHLightClustering::GetSpotLightBound(LightPos, Dir, Range, Angle);
+			Spheres.SetSphere(Idx, XMFLOAT3(Bound.x, Bound.y, Bound.z), Bound.w);
+		}
+
+		const uint32_t NumBatches = Spheres.GetPaddedCount() / UHLightClusterSpheres::LightsPerBatch;
+		const UHCullingSIMDLevel Levels[3] = { UHCullingSIMDLevel::Scalar, UHCullingSIMDLevel::SSE, UHCullingSIMDLevel::AVX };
+		double RangeSeconds[3] = { 0.0, 0.0, 0.0 };
+		UHLightClusterSpheres Reference;
+		uint32_t NumMismatches = 0;
+
+		for (int32_t LevelIdx = 0; LevelIdx < 3 && Levels[LevelIdx] <= BestLevel; LevelIdx++)
+		{
+			const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+			for (int32_t Run = 0; Run < NumRuns; Run++)
+			{
+				UHLightClustering::ComputeRanges(Levels[LevelIdx], ClusterView, Spheres, 0, NumBatches);
+			}
+			RangeSeconds[LevelIdx] = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count() / NumRuns;
+
+			if (LevelIdx == 0)
+			{
+				Reference = Spheres;
+				continue;
+			}
+
+			for (uint32_t Idx = 0; Idx < NumLights; Idx++)
+			{
+				const bool bSame = Spheres.MinX[Idx] == Reference.MinX[Idx] && Spheres.MaxX[Idx] == Reference.MaxX[Idx]
+					&& Spheres.MinY[Idx] == Reference.MinY[Idx] && Spheres.MaxY[Idx] == Reference.MaxY[Idx]
+					&& Spheres.MinZ[Idx] == Reference.MinZ[Idx] && Spheres.MaxZ[Idx] == Reference.MaxZ[Idx];
+				NumMismatches += bSame ? 0 : 1;
+			}
+		}
+
+		std::vector<UHLightClusterEntry> Entries;
+		std::vector<uint32_t> Indices;
+		uint32_t NumIndices = 0;
+		const std::chrono::steady_clock::time_point ListStartTime = std::chrono::steady_clock::now();
+		for (int32_t Run = 0; Run < NumRuns; Run++)
+		{
+			NumIndices = UHLightClustering::BuildLists(ClusterView, Spheres, Entries, Indices);
+		}
+		const double ListSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - ListStartTime).count() / NumRuns;
+
+		// lists must be sorted, in range and add up to the number of indices
+		uint32_t NumErrors = 0;
+		uint32_t NumCounted = 0;
+		uint32_t NumNonEmpty = 0;
+		uint32_t MaxPerCluster = 0;
+		for (uint32_t EntryIdx = 0; EntryIdx < Entries.size(); EntryIdx++)
+		{
+			const UHLightClusterEntry& Entry = Entries[EntryIdx];
+			const uint32_t TypeCount = (EntryIdx % UHLightClusterView::NumLightTypes == 0) ? NumPointLights : NumSpotLights;
+			NumCounted += Entry.Count;
+			NumNonEmpty += (Entry.Count > 0) ? 1 : 0;
+			MaxPerCluster = (std::max)(MaxPerCluster, Entry.Count);
+			for (uint32_t Ldx = 0; Ldx < Entry.Count; Ldx++)
+			{
+				const uint32_t LightIdx = Indices[Entry.Offset + Ldx];
+				NumErrors += (LightIdx >= TypeCount || (Ldx > 0 && LightIdx <= Indices[Entry.Offset + Ldx - 1])) ? 1 : 0;
+			}
+		}
+		NumErrors += (NumCounted != NumIndices) ? 1 : 0;
+
+		// points on the spheres of sampled lights must fall in the listed clusters
+		uint32_t NumMissing = 0;
+		const float HalfWidth = Width * 0.5f;
+		const float HalfHeight = Height * 0.5f;
+		for (uint32_t Idx = 0; Idx < NumLights; Idx += 37)
+		{
+			const bool bIsSpotLight = Idx >= NumPointLights;
+			const uint32_t TypeIdx = bIsSpotLight ? 1 : 0;
+			const uint32_t LightIdx = bIsSpotLight ? Idx - NumPointLights : Idx;
+			for (uint32_t Sample = 0; Sample < 64; Sample++)
+			{
+				// fibonacci points on the sphere, slightly inside so the rounding of the surface doesn't count
+				const float CosTheta = 1.0f - (Sample + 0.5f) / 32.0f;
+				const float SinTheta = std::sqrt((std::max)(1.0f - CosTheta * CosTheta, 0.0f));
+				const float Phi = Sample * 2.39996323f;
+				const float R = Spheres.Radius[Idx] * 0.999f;
+				const XMVECTOR Point = XMVectorSet(Spheres.CenterX[Idx] + R * SinTheta * std::cos(Phi), Spheres.CenterY[Idx] + R * CosTheta
+					, Spheres.CenterZ[Idx] + R * SinTheta * std::sin(Phi), 1.0f);
+
+				XMFLOAT3 ViewPos;
+				XMStoreFloat3(&ViewPos, XMVector3TransformCoord(Point, XMLoadFloat4x4(&View)));
+				ViewPos.z = -ViewPos.z;
+				if (ViewPos.z < NearPlane)
+				{
+					continue;
+				}
+
+				const float PixelX = ViewPos.x / ViewPos.z * ClusterView.ProjScaleX * HalfWidth + HalfWidth;
+				const float PixelY = ViewPos.y / ViewPos.z * ClusterView.ProjScaleY * HalfHeight + HalfHeight;
+				if (PixelX < 0.0f || PixelX >= Width || PixelY < 0.0f || PixelY >= Height)
+				{
+					continue;
+				}
+
+				const uint32_t ClusterX = static_cast<uint32_t>(PixelX) / UHLightClusterView::TileSize;
+				const uint32_t ClusterY = static_cast<uint32_t>(PixelY) / UHLightClusterView::TileSize;
+				const uint32_t ClusterZ = UHLightClustering::GetSlice(ClusterView, ViewPos.z);
+				const uint32_t ClusterIdx = ClusterX + (ClusterY + ClusterZ * ClusterView.CountY) * ClusterView.CountX;
+				const UHLightClusterEntry& Entry = Entries[ClusterIdx * UHLightClusterView::NumLightTypes + TypeIdx];
+				const uint32_t* ListBegin = Indices.data() + Entry.Offset;
+				NumMissing += std::binary_search(ListBegin, ListBegin + Entry.Count, LightIdx) ? 0 : 1;
+			}
+		}
+		UH_TOOL_CHECK(NumMismatches == 0);
+		UH_TOOL_CHECK(NumErrors == 0);
+		UH_TOOL_CHECK(NumMissing == 0);
+
+		const std::wstring AVXTime = (BestLevel >= UHCullingSIMDLevel::AVX) ? std::to_wstring(RangeSeconds[2] * 1000.0) + L" ms" : L"n/a";
+		const std::wstring SSETime = (BestLevel >= UHCullingSIMDLevel::SSE) ? std::to_wstring(RangeSeconds[1] * 1000.0) + L" ms" : L"n/a";
+		Summary += std::to_wstring(NumLights) + L" lights: ranges scalar " + std::to_wstring(RangeSeconds[0] * 1000.0) + L" ms, SSE " + SSETime
+			+ L", AVX " + AVXTime + L", lists " + std::to_wstring(ListSeconds * 1000.0) + L" ms\n";
+		Summary += L"    " + std::to_wstring(NumIndices) + L" indices, " + std::to_wstring(NumNonEmpty) + L" non-empty entries, max "
+			+ std::to_wstring(MaxPerCluster) + L" lights per entry, average " + std::to_wstring(NumNonEmpty > 0 ? static_cast<double>(NumIndices) / NumNonEmpty : 0.0)
+			+ L", " + std::to_wstring(NumMismatches) + L" SIMD mismatches, " + std::to_wstring(NumMissing) + L" missing, " + std::to_wstring(NumErrors)
+			+ L" errors\n";
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/Mesh.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include <psapi.h>
+#include <chrono>
+
+// re-optimizes all .uhmesh assets under the folder and reports the triangle weighted ACMR
+void OptimizeMeshes(const std::filesystem::path& MeshFolder)
+{
+	uint32_t MeshCount = 0;
+	uint64_t TriangleCount = 0;
+	double MissesBefore = 0.0;
+	double MissesAfter = 0.0;
+
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(MeshFolder))
+	{
+		if (Entry.path().extension().string() != GMeshAssetExtension)
+		{
+			continue;
+		}
+
+		UHMesh Mesh;
+		if (!Mesh.Import(Entry.path()))
+		{
+			continue;
+		}
+
+		const UHMeshOptimizeStats Stats = Mesh.Optimize();
+		Mesh.Export(Entry.path());
+
+		MeshCount++;
+		TriangleCount += Stats.TriangleCount;
+		MissesBefore += Stats.ACMRBefore * Stats.TriangleCount;
+		MissesAfter += Stats.ACMRAfter * Stats.TriangleCount;
+		wprintf(L"%ls: ACMR %.3f -> %.3f\n", Entry.path().wstring().c_str(), Stats.ACMRBefore, Stats.ACMRAfter);
+	}
+
+	const double Divisor = (std::max)(static_cast<double>(TriangleCount), 1.0);
+	const std::wstring Summary = L"Optimized " + std::to_wstring(MeshCount) + L" meshes, ACMR: "
+		+ std::to_wstring(MissesBefore / Divisor) + L" -> " + std::to_wstring(MissesAfter / Divisor) + L"\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// imports all .uhmesh assets under the folder and keeps them alive, then reports the throughput and peak RSS
+// chunked assets are mapped lazily, so the time doesn't include page faults that happen during GPU uploading
+void BenchmarkMeshLoad(const std::filesystem::path& MeshFolder)
+{
+	std::vector<std::filesystem::path> MeshPaths;
+	uint64_t TotalBytes = 0;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(MeshFolder))
+	{
+		if (Entry.path().extension().string() == GMeshAssetExtension)
+		{
+			MeshPaths.push_back(Entry.path());
+			TotalBytes += Entry.file_size();
+		}
+	}
+
+	std::vector<UniquePtr<UHMesh>> Meshes;
+	Meshes.reserve(MeshPaths.size());
+	uint32_t FailedCount = 0;
+
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for (const std::filesystem::path& MeshPath : MeshPaths)
+	{
+		UniquePtr<UHMesh> Mesh = MakeUnique<UHMesh>();
+		if (!Mesh->Import(MeshPath))
+		{
+			FailedCount++;
+			continue;
+		}
+		Meshes.push_back(std::move(Mesh));
+	}
+	const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+	PROCESS_MEMORY_COUNTERS MemoryCounters{};
+	GetProcessMemoryInfo(GetCurrentProcess(), &MemoryCounters, sizeof(MemoryCounters));
+
+	const double Divisor = (std::max)(Seconds, 1e-6);
+	const double MegaBytes = static_cast<double>(TotalBytes) / (1024.0 * 1024.0);
+	const std::wstring Summary = L"Loaded " + std::to_wstring(Meshes.size()) + L" meshes (" + std::to_wstring(FailedCount) + L" failed), "
+		+ std::to_wstring(MegaBytes) + L" MB in " + std::to_wstring(Seconds) + L" s, "
+		+ std::to_wstring(MegaBytes / Divisor) + L" MB/s, " + std::to_wstring(Meshes.size() / Divisor) + L" meshes/s, peak RSS: "
+		+ std::to_wstring(MemoryCounters.PeakWorkingSetSize / (1024 * 1024)) + L" MB\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// validates the meshlet builder with a generated grid, then the stored meshlets of all .uhmesh assets under the folder
+// and reports the triangle weighted ACMR and ATVR of meshlets
+void TestMeshlets(const std::filesystem::path& MeshFolder)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	// a grid of 256x256 quads, enough to fill many meshlets with shared vertices
+	const uint32_t GridSize = 256;
+	std::vector<XMFLOAT3> GridPositions;
+	std::vector<XMFLOAT3> GridNormals;
+	std::vector<uint32_t> GridIndices;
+	for (uint32_t Y = 0; Y <= GridSize; Y++)
+	{
+		for (uint32_t X = 0; X <= GridSize; X++)
+		{
+			GridPositions.push_back(XMFLOAT3(static_cast<float>(X), 0.0f, static_cast<float>(Y)));
+			GridNormals.push_back(XMFLOAT3(0.0f, 1.0f, 0.0f));
+		}
+	}
+
+	for (uint32_t Y = 0; Y < GridSize; Y++)
+	{
+		for (uint32_t X = 0; X < GridSize; X++)
+		{
+			const uint32_t V0 = Y * (GridSize + 1) + X;
+			const uint32_t V1 = V0 + 1;
+			const uint32_t V2 = V0 + GridSize + 1;
+			const uint32_t V3 = V2 + 1;
+			GridIndices.insert(GridIndices.end(), { V0, V2, V1, V1, V2, V3 });
+		}
+	}
+
+	std::vector<UHMeshlet> GridMeshlets;
+	std::vector<uint32_t> GridMeshletIndices;
+	UHMeshletBuilder::BuildMeshlets(GridPositions, GridNormals, GridIndices, UHMesh::MaxVertexPerMeshlet, UHMesh::MaxPrimitivePerMeshlet
+		, GridMeshlets, GridMeshletIndices);
+	UH_TOOL_CHECK(UHMeshletBuilder::ValidateMeshlets(GridMeshlets, GridMeshletIndices, GridIndices, static_cast<uint32_t>(GridPositions.size())
+		, UHMesh::MaxVertexPerMeshlet, UHMesh::MaxPrimitivePerMeshlet));
+
+	// all normals of the grid are the same, so every meshlet must be cullable by its normal cone
+	const UHMeshletStats GridStats = UHMeshletBuilder::CalculateStats(GridMeshlets, static_cast<uint32_t>(GridPositions.size()));
+	uint32_t NumWideCones = 0;
+	for (const UHMeshlet& Meshlet : GridMeshlets)
+	{
+		NumWideCones += (Meshlet.ConeCutoff >= 1.0f) ? 1 : 0;
+	}
+	UH_TOOL_CHECK(NumWideCones == 0);
+
+	std::wstring Summary = L"Grid: " + std::to_wstring(GridStats.MeshletCount) + L" meshlets, ACMR: " + std::to_wstring(GridStats.ACMR)
+		+ L", ATVR: " + std::to_wstring(GridStats.ATVR) + L"\n";
+
+	uint32_t MeshCount = 0;
+	uint32_t SkippedCount = 0;
+	uint64_t TriangleCount = 0;
+	double WeightedACMR = 0.0;
+	double WeightedATVR = 0.0;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(MeshFolder))
+	{
+		if (Entry.path().extension().string() != GMeshAssetExtension)
+		{
+			continue;
+		}
+
+		// legacy assets don't store meshlets, they're built when the GPU buffers are created
+		UHMesh Mesh;
+		if (!Mesh.Import(Entry.path()) || Mesh.GetMeshletCount() == 0)
+		{
+			SkippedCount++;
+			continue;
+		}
+
+		UHMeshletStats Stats;
+		const bool bIsValid = Mesh.ValidateMeshlets(Stats);
+		UH_TOOL_CHECK(bIsValid);
+		if (!bIsValid)
+		{
+			wprintf(L"Invalid meshlets in %ls\n", Entry.path().wstring().c_str());
+		}
+
+		MeshCount++;
+		TriangleCount += Stats.TriangleCount;
+		WeightedACMR += Stats.ACMR * Stats.TriangleCount;
+		WeightedATVR += Stats.ATVR * Stats.TriangleCount;
+	}
+
+	const double Divisor = (std::max)(static_cast<double>(TriangleCount), 1.0);
+	Summary += L"Validated " + std::to_wstring(MeshCount) + L" meshes (" + std::to_wstring(SkippedCount) + L" without meshlets), ACMR: "
+		+ std::to_wstring(WeightedACMR / Divisor) + L", ATVR: " + std::to_wstring(WeightedATVR / Divisor) + L"\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+static bool IsCompressionErrorInBounds(const UHVertexCompressionError& InError)
+{
+	return InError.MaxPositionError <= UHVertexCompression::GMaxSnormPositionError
+		&& InError.MaxUVError <= UHVertexCompression::GMaxHalfUVRelativeError
+		&& InError.MaxNormalAngle <= UHVertexCompression::GMaxOctNormalAngle
+		&& InError.MaxTangentAngle <= UHVertexCompression::GMaxOctTangentAngle
+		&& InError.NumTangentSignMismatch == 0;
+}
+
+static std::wstring ToCompressionErrorString(const UHVertexCompressionError& InError)
+{
+	return L"Position: " + std::to_wstring(InError.MaxPositionError) + L", UV0: " + std::to_wstring(InError.MaxUVError)
+		+ L", Normal: " + std::to_wstring(InError.MaxNormalAngle) + L" rad, Tangent: " + std::to_wstring(InError.MaxTangentAngle) + L" rad";
+}
+
+// checks the vertex compression codecs against their error bounds with generated streams
+// then measures the compressed .uhmesh assets under the folder against the same bounds
+void TestVertexCompression(const std::filesystem::path& MeshFolder)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	uint32_t Seed = 24680;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+	const auto NextFloat = [&NextRandom]()
+	{
+		// [-1, 1]
+		return (NextRandom() % 65536) / 32768.0f - 1.0f;
+	};
+
+	// positions in an off-center box with a flat axis, directions cover the axes as octahedral folding is the worst there
+	const uint32_t NumVertices = 100000;
+	std::vector<XMFLOAT3> Positions;
+	std::vector<XMFLOAT2> UV0;
+	std::vector<XMFLOAT3> Normals;
+	std::vector<XMFLOAT4> Tangents;
+	const XMFLOAT3 Axes[6] = { XMFLOAT3(1, 0, 0), XMFLOAT3(-1, 0, 0), XMFLOAT3(0, 1, 0), XMFLOAT3(0, -1, 0), XMFLOAT3(0, 0, 1), XMFLOAT3(0, 0, -1) };
+	for (uint32_t Idx = 0; Idx < NumVertices; Idx++)
+	{
+		Positions.push_back(XMFLOAT3(3.0f + NextFloat() * 10.0f, -2.0f + NextFloat() * 0.5f, 5.0f));
+		UV0.push_back(XMFLOAT2(NextFloat() * 4.0f, NextFloat() * 4.0f));
+
+		XMFLOAT3 Normal = (Idx < 6) ? Axes[Idx] : XMFLOAT3(NextFloat(), NextFloat(), NextFloat());
+		XMStoreFloat3(&Normal, XMVector3Normalize(XMLoadFloat3(&Normal)));
+		Normals.push_back(Normal);
+
+		XMFLOAT3 Tangent = (Idx < 6) ? Axes[5 - Idx] : XMFLOAT3(NextFloat(), NextFloat(), NextFloat());
+		XMStoreFloat3(&Tangent, XMVector3Normalize(XMLoadFloat3(&Tangent)));
+		Tangents.push_back(XMFLOAT4(Tangent.x, Tangent.y, Tangent.z, (NextRandom() & 1) ? 1.0f : -1.0f));
+	}
+
+	BoundingBox Bound;
+	BoundingBox::CreateFromPoints(Bound, Positions.size(), Positions.data(), sizeof(XMFLOAT3));
+
+	const UHVertexCompressionError Error = UHVertexCompression::MeasureError(Positions, Bound, UV0, Normals, Tangents);
+	UH_TOOL_CHECK(Error.MaxPositionError <= UHVertexCompression::GMaxSnormPositionError);
+	UH_TOOL_CHECK(Error.MaxUVError <= UHVertexCompression::GMaxHalfUVRelativeError);
+	UH_TOOL_CHECK(Error.MaxNormalAngle <= UHVertexCompression::GMaxOctNormalAngle);
+	UH_TOOL_CHECK(Error.MaxTangentAngle <= UHVertexCompression::GMaxOctTangentAngle);
+	UH_TOOL_CHECK(Error.NumTangentSignMismatch == 0);
+
+	// the corners of the bound are exact, and positions on the flat axis decode to the center
+	const XMFLOAT3 Corner(Bound.Center.x + Bound.Extents.x, Bound.Center.y - Bound.Extents.y, Bound.Center.z);
+	const XMFLOAT3 DecodedCorner = UHVertexCompression::DecodePosition(UHVertexCompression::EncodePosition(Corner, Bound), Bound);
+	UH_TOOL_CHECK(DecodedCorner.x == Corner.x && DecodedCorner.y == Corner.y && DecodedCorner.z == Corner.z);
+
+	std::vector<uint32_t> PackedPositions;
+	UHVertexCompression::EncodePositionStream(Positions, Bound, PackedPositions);
+	UH_TOOL_CHECK(PackedPositions.size() == Positions.size() * 2);
+
+	std::wstring Summary = L"Generated: " + ToCompressionErrorString(Error) + L"\n";
+
+	uint32_t MeshCount = 0;
+	uint32_t SkippedCount = 0;
+	UHVertexCompressionError MaxAssetError;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(MeshFolder))
+	{
+		if (Entry.path().extension().string() != GMeshAssetExtension)
+		{
+			continue;
+		}
+
+		UHMesh Mesh;
+		if (!Mesh.Import(Entry.path()) || Mesh.GetVertexFormat() != UHVertexFormat::Compressed)
+		{
+			SkippedCount++;
+			continue;
+		}
+
+		const UHVertexCompressionError AssetError = Mesh.MeasureCompressionError();
+		const bool bIsInBounds = IsCompressionErrorInBounds(AssetError);
+		UH_TOOL_CHECK(bIsInBounds);
+		if (!bIsInBounds)
+		{
+			wprintf(L"Compression error out of bounds in %ls, %ls\n", Entry.path().wstring().c_str(), ToCompressionErrorString(AssetError).c_str());
+		}
+
+		MeshCount++;
+		MaxAssetError.MaxPositionError = (std::max)(MaxAssetError.MaxPositionError, AssetError.MaxPositionError);
+		MaxAssetError.MaxUVError = (std::max)(MaxAssetError.MaxUVError, AssetError.MaxUVError);
+		MaxAssetError.MaxNormalAngle = (std::max)(MaxAssetError.MaxNormalAngle, AssetError.MaxNormalAngle);
+		MaxAssetError.MaxTangentAngle = (std::max)(MaxAssetError.MaxTangentAngle, AssetError.MaxTangentAngle);
+		MaxAssetError.NumTangentSignMismatch += AssetError.NumTangentSignMismatch;
+	}
+
+	Summary += L"Measured " + std::to_wstring(MeshCount) + L" compressed meshes (" + std::to_wstring(SkippedCount) + L" skipped), "
+		+ ToCompressionErrorString(MaxAssetError) + L"\n";
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
@@ -0,0 +1,605 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Engine/CPUProfiler.h"
+#include "../../Runtime/Classes/GPUTimeline.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+// measures the cost per scope of the CPU profiler with nested scopes, disabled, enabled and enabled on worker threads
+// the legacy cost is the previous editor scope timer, which built a string and pushed the time under a global lock
+// captures are taken while workers are recording, and every copied event must still be well-formed
+void BenchmarkCPUProfiler(const uint32_t NumScopes)
+{
+	const uint32_t NumIterations = (std::max)(NumScopes / 2, 1u);
+	const int32_t NumWorkers = 4;
+	const auto RecordScopes = [NumIterations]()
+	{
+		for (uint32_t Idx = 0; Idx < NumIterations; Idx++)
+		{
+			UHCPUProfileScope Outer("BenchmarkOuter");
+			UHCPUProfileScope Inner("BenchmarkInner");
+		}
+	};
+
+	const auto ToNsPerScope = [NumIterations](const std::chrono::steady_clock::time_point& StartTime)
+	{
+		const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+		return Seconds * 1e9 / (NumIterations * 2.0);
+	};
+
+	// disabled
+	UHCPUProfiler::SetEnabled(false);
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	RecordScopes();
+	const double DisabledNs = ToNsPerScope(StartTime);
+
+	// the cost of a timestamp for reference, each scope reads two
+	StartTime = std::chrono::steady_clock::now();
+	for (uint32_t Idx = 0; Idx < NumIterations * 2; Idx++)
+	{
+		UHCPUProfiler::GetTimeStamp();
+	}
+	const double TimeStampNs = ToNsPerScope(StartTime);
+
+	// legacy editor scope
+	std::mutex LegacyLock;
+	std::vector<std::pair<std::string, float>> LegacyTimes;
+	const auto RecordLegacyScope = [&LegacyLock, &LegacyTimes](std::string InName, int64_t InBeginTime)
+	{
+		const float Time = static_cast<float>((UHCPUProfiler::GetTimeStamp() - InBeginTime) * UHCPUProfiler::GetSecondsPerCount() * 1000.0);
+		std::unique_lock<std::mutex> Lock(LegacyLock);
+		LegacyTimes.push_back(std::make_pair(InName, Time));
+	};
+
+	StartTime = std::chrono::steady_clock::now();
+	for (uint32_t Idx = 0; Idx < NumIterations; Idx++)
+	{
+		const std::string OuterName = "BenchmarkOuter";
+		const int64_t OuterBeginTime = UHCPUProfiler::GetTimeStamp();
+		{
+			const std::string InnerName = "BenchmarkInner";
+			const int64_t InnerBeginTime = UHCPUProfiler::GetTimeStamp();
+			RecordLegacyScope(InnerName, InnerBeginTime);
+		}
+		RecordLegacyScope(OuterName, OuterBeginTime);
+
+		// the editor cleared the registered time every frame
+		if (LegacyTimes.size() >= 1024)
+		{
+			LegacyTimes.clear();
+		}
+	}
+	const double LegacyNs = ToNsPerScope(StartTime);
+
+	// enabled
+	UHCPUProfiler::SetEnabled(true);
+	StartTime = std::chrono::steady_clock::now();
+	RecordScopes();
+	const double EnabledNs = ToNsPerScope(StartTime);
+
+	// enabled on workers, the main thread keeps capturing meanwhile
+	const auto IsEventValid = [](const UHCPUProfileEvent& InEvent)
+	{
+		const bool bIsOuter = strcmp(InEvent.Name, "BenchmarkOuter") == 0 && InEvent.Depth == 0;
+		const bool bIsInner = strcmp(InEvent.Name, "BenchmarkInner") == 0 && InEvent.Depth == 1;
+		return InEvent.Type == UHCPUProfileEventType::Scope && (bIsOuter || bIsInner) && InEvent.EndTime >= InEvent.BeginTime;
+	};
+
+	std::atomic<int32_t> NumFinishedWorkers(0);
+	std::vector<double> WorkerNs(NumWorkers);
+	std::vector<std::thread> Workers;
+	for (int32_t Idx = 0; Idx < NumWorkers; Idx++)
+	{
+		Workers.push_back(std::thread([&, Idx]()
+		{
+			UHCPUProfiler::SetThreadName("Benchmark Worker " + std::to_string(Idx));
+			const std::chrono::steady_clock::time_point WorkerStartTime = std::chrono::steady_clock::now();
+			RecordScopes();
+			WorkerNs[Idx] = ToNsPerScope(WorkerStartTime);
+			NumFinishedWorkers++;
+
+			// lanes of exited threads are reused, so workers stay until all of them are finished to have their own lanes
+			while (NumFinishedWorkers.load() < NumWorkers)
+			{
+				std::this_thread::yield();
+			}
+		}));
+	}
+
+	std::vector<UHCPUProfileThreadCapture> Threads;
+	uint32_t NumCaptures = 0;
+	uint64_t NumErrors = 0;
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	while (NumFinishedWorkers.load() < NumWorkers)
+	{
+		UHCPUProfiler::Capture(Threads);
+		for (const UHCPUProfileThreadCapture& Thread : Threads)
+		{
+			for (const UHCPUProfileEvent& Event : Thread.Events)
+			{
+				NumErrors += IsEventValid(Event) ? 0 : 1;
+			}
+		}
+		NumCaptures++;
+	}
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+
+	// each worker lane has the latest events of a full ring, except the oldest one which might be overwritten when copying
+	// inner scopes end first, so an inner event must be inside the outer event after it
+	const size_t ExpectedEvents = (std::min)(static_cast<size_t>(NumIterations) * 2, static_cast<size_t>(UHCPUProfiler::EventsPerThread - 1));
+	UHCPUProfiler::Capture(Threads);
+	int32_t NumWorkerLanes = 0;
+	for (const UHCPUProfileThreadCapture& Thread : Threads)
+	{
+		if (Thread.ThreadName.find("Benchmark Worker") != 0)
+		{
+			continue;
+		}
+
+		NumWorkerLanes++;
+		NumErrors += (Thread.Events.size() != ExpectedEvents) ? 1 : 0;
+		for (size_t Idx = 0; Idx < Thread.Events.size(); Idx++)
+		{
+			const UHCPUProfileEvent& Event = Thread.Events[Idx];
+			NumErrors += IsEventValid(Event) ? 0 : 1;
+			if (Event.Depth == 1 && Idx + 1 < Thread.Events.size())
+			{
+				const UHCPUProfileEvent& Parent = Thread.Events[Idx + 1];
+				NumErrors += (Parent.Depth != 0 || Parent.BeginTime > Event.BeginTime || Parent.EndTime < Event.EndTime) ? 1 : 0;
+			}
+		}
+	}
+	NumErrors += (NumWorkerLanes != NumWorkers) ? 1 : 0;
+
+	// the last frame contains the scopes between the last two frame markers only
+	const uint32_t NumFrameScopes = 100;
+	UHCPUProfiler::BeginFrame();
+	for (uint32_t Idx = 0; Idx < NumFrameScopes; Idx++)
+	{
+		UHCPUProfileScope Scope("BenchmarkFrame");
+	}
+	UHCPUProfiler::AddCounter("BenchmarkCounter", NumFrameScopes);
+	UHCPUProfiler::BeginFrame();
+	{
+		UHCPUProfileScope Scope("BenchmarkNextFrame");
+	}
+
+	UHCPUProfiler::CaptureLastFrame(Threads);
+	uint32_t NumFrameEvents = 0;
+	for (const UHCPUProfileThreadCapture& Thread : Threads)
+	{
+		for (const UHCPUProfileEvent& Event : Thread.Events)
+		{
+			const bool bIsFrameScope = strcmp(Event.Name, "BenchmarkFrame") == 0;
+			const bool bIsCounter = Event.Type == UHCPUProfileEventType::Counter && Event.Value == NumFrameScopes;
+			NumFrameEvents++;
+			NumErrors += (bIsFrameScope || bIsCounter) ? 0 : 1;
+		}
+	}
+	NumErrors += (NumFrameEvents != NumFrameScopes + 1) ? 1 : 0;
+
+	// export and count the complete events in the file
+	uint64_t NumScopeEvents = 0;
+	UHCPUProfiler::Capture(Threads);
+	for (const UHCPUProfileThreadCapture& Thread : Threads)
+	{
+		for (const UHCPUProfileEvent& Event : Thread.Events)
+		{
+			NumScopeEvents += (Event.Type == UHCPUProfileEventType::Scope) ? 1 : 0;
+		}
+	}
+
+	const std::filesystem::path TracePath = GProfileCapturePath + "BenchmarkCPUTrace.json";
+	StartTime = std::chrono::steady_clock::now();
+	const bool bExported = UHCPUProfiler::ExportChromeTrace(TracePath);
+	const double ExportSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	UHCPUProfiler::SetEnabled(false);
+
+	std::ifstream TraceIn(TracePath);
+	std::stringstream TraceStream;
+	TraceStream << TraceIn.rdbuf();
+	const std::string Trace = TraceStream.str();
+	uint64_t NumExportedEvents = 0;
+	for (size_t Pos = Trace.find("\"ph\":\"X\""); Pos != std::string::npos; Pos = Trace.find("\"ph\":\"X\"", Pos + 1))
+	{
+		NumExportedEvents++;
+	}
+	NumErrors += (!bExported || Trace.find("{\"traceEvents\":[") != 0 || NumExportedEvents != NumScopeEvents) ? 1 : 0;
+	UH_TOOL_CHECK(NumErrors == 0);
+
+	double AverageWorkerNs = 0.0;
+	for (const double Ns : WorkerNs)
+	{
+		AverageWorkerNs += Ns / NumWorkers;
+	}
+
+	std::wstring Summary = L"CPU profiler benchmark, " + std::to_wstring(NumIterations * 2) + L" nested scopes per thread, "
+		+ std::to_wstring(NumWorkers) + L" workers\n";
+	Summary += L"Per scope: disabled " + std::to_wstring(DisabledNs) + L" ns, enabled " + std::to_wstring(EnabledNs) + L" ns, enabled on workers "
+		+ std::to_wstring(AverageWorkerNs) + L" ns, legacy " + std::to_wstring(LegacyNs) + L" ns\n";
+	Summary += L"Per timestamp: " + std::to_wstring(TimeStampNs) + L" ns\n";
+	Summary += L"Captures while recording: " + std::to_wstring(NumCaptures) + L", exported " + std::to_wstring(NumExportedEvents) + L" scopes in "
+		+ std::to_wstring(ExportSeconds * 1000.0) + L" ms to " + TracePath.wstring() + L"\n";
+	Summary += std::to_wstring(NumErrors) + L" errors\n";
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+// feeds the GPU timeline with synthetic timestamp streams of the graphics and async compute queues, which are resolved frames later like the recorder
+// percentiles are validated against a reference, and mapped scopes against the true CPU time with calibrated timestamps and with submit bounds only
+void BenchmarkGPUTimeline(const uint32_t NumFrames)
+{
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+	const auto RandomRange = [&NextRandom](double InMin, double InMax)
+	{
+		return InMin + (InMax - InMin) * (NextRandom() / 16777216.0);
+	};
+
+	// a synthetic device clock of 1 ns ticks which runs 80 ppm faster than the CPU clock
+	// both queues read the same clock, but the compute queue only has 32 valid bits so it wraps every 4.3 s, the first wrap is 0.5 s in
+	const int32_t NumQueues = 2;
+	const char* QueueNames[NumQueues] = { "GPU Graphics Queue", "GPU Async Compute Queue" };
+	const uint32_t QueueValidBits[NumQueues] = { 64, 32 };
+	const uint64_t QueueTickMasks[NumQueues] = { ~0ULL, (1ULL << 32) - 1 };
+	const double NsPerTick = 1.0;
+	const double DriftPPM = 80.0;
+	const double FrameSeconds = 1.0 / 60.0;
+	const uint64_t TickBase = (1ULL << 32) - 500000000ULL;
+	const double SecondsPerCount = UHCPUProfiler::GetSecondsPerCount();
+
+	UHCPUProfiler::SetEnabled(true);
+	const int64_t CPUBase = UHCPUProfiler::GetTimeStamp();
+	const auto ToTick = [&](double InSeconds)
+	{
+		return TickBase + static_cast<uint64_t>(InSeconds * 1e9 * (1.0 + DriftPPM * 1e-6) / NsPerTick);
+	};
+	const auto ToCPUTime = [&](double InSeconds)
+	{
+		return static_cast<double>(CPUBase) + InSeconds / SecondsPerCount;
+	};
+
+	// one timeline is calibrated with sampled clock pairs, the other one only has submit times as if calibrated timestamps are unavailable
+	UHGPUTimeline Calibrated;
+	UHGPUTimeline Bounded;
+	for (int32_t Queue = 0; Queue < NumQueues; Queue++)
+	{
+		Calibrated.AddQueue(QueueNames[Queue], NsPerTick, QueueValidBits[Queue], SecondsPerCount);
+		Bounded.AddQueue(QueueNames[Queue], NsPerTick, QueueValidBits[Queue], SecondsPerCount);
+	}
+
+	// frames of a queue, scopes are in the order they begin and the durations have 10% noise with 1% spikes
+	struct UHSyntheticScope
+	{
+		const char* Name;
+		uint32_t Depth;
+		double BeginSeconds;
+		double EndSeconds;
+	};
+
+	struct UHSyntheticFrame
+	{
+		double SubmitSeconds;
+		std::vector<UHSyntheticScope> Scopes;
+	};
+
+	const auto AddScope = [&](std::vector<UHSyntheticScope>& Scopes, const char* InName, uint32_t InDepth, double& InOutTime, double InMs)
+	{
+		const double Scale = (NextRandom() % 100 == 0) ? 4.0 : RandomRange(0.9, 1.1);
+		const double BeginTime = InOutTime;
+		InOutTime += InMs * 1e-3 * Scale;
+		Scopes.push_back(UHSyntheticScope{ InName, InDepth, BeginTime, InOutTime });
+	};
+
+	const auto GenerateGraphicsFrame = [&](double InSubmitSeconds)
+	{
+		UHSyntheticFrame Frame;
+		Frame.SubmitSeconds = InSubmitSeconds;
+		double Time = InSubmitSeconds + RandomRange(20e-6, 400e-6);
+		Frame.Scopes.push_back(UHSyntheticScope{ "SceneRendering", 0, Time, 0.0 });
+		AddScope(Frame.Scopes, "DepthPass", 1, Time, 0.8);
+		AddScope(Frame.Scopes, "BasePass", 1, Time, 3.0);
+
+		// a scope that appears twice in a frame is a single sample of the sum
+		const size_t LightPass = Frame.Scopes.size();
+		Frame.Scopes.push_back(UHSyntheticScope{ "LightPass", 1, Time, 0.0 });
+		AddScope(Frame.Scopes, "ShadowCascade", 2, Time, 0.5);
+		AddScope(Frame.Scopes, "ShadowCascade", 2, Time, 0.5);
+		Time += 0.4e-3;
+		Frame.Scopes[LightPass].EndSeconds = Time;
+
+		const size_t PostProcessing = Frame.Scopes.size();
+		Frame.Scopes.push_back(UHSyntheticScope{ "PostProcessing", 1, Time, 0.0 });
+		AddScope(Frame.Scopes, "ToneMappingPass", 2, Time, 0.3);
+		AddScope(Frame.Scopes, "TemporalAAPass", 2, Time, 0.6);
+		Frame.Scopes[PostProcessing].EndSeconds = Time;
+
+		AddScope(Frame.Scopes, "PresentToSwapChain", 1, Time, 0.2);
+		Frame.Scopes[0].EndSeconds = Time;
+		return Frame;
+	};
+
+	const auto GenerateComputeFrame = [&](double InSubmitSeconds)
+	{
+		UHSyntheticFrame Frame;
+		Frame.SubmitSeconds = InSubmitSeconds;
+		double Time = InSubmitSeconds + RandomRange(20e-6, 400e-6);
+		Frame.Scopes.push_back(UHSyntheticScope{ "AsyncCompute", 0, Time, 0.0 });
+		AddScope(Frame.Scopes, "UpdateTopLevelAS", 1, Time, 0.7);
+		AddScope(Frame.Scopes, "CollectLightPass", 1, Time, 0.2);
+		AddScope(Frame.Scopes, "GenerateSH9", 1, Time, 0.1);
+		Frame.Scopes[0].EndSeconds = Time;
+		return Frame;
+	};
+
+	// reference durations per frame and the true CPU time of every scope in submission order
+	std::map<std::tuple<uint32_t, const char*, uint32_t>, std::vector<float>> ReferenceDurations;
+	std::vector<std::pair<double, double>> TrueTimes[NumQueues];
+	std::deque<UHSyntheticFrame> PendingFrames[NumQueues];
+	std::vector<UHGPUTimelineScope> Scopes;
+	uint64_t NumScopes = 0;
+	uint32_t NumWraps = 0;
+	uint64_t FirstComputeTick = 0;
+	uint64_t LastComputeTick = 0;
+
+	// frames are resolved when their frame index is reused, the same as the recorder
+	for (uint32_t FrameIdx = 0; FrameIdx < NumFrames + GMaxFrameInFlight; FrameIdx++)
+	{
+		UHCPUProfileScope FrameScope("BenchmarkGPUTimelineFrame");
+		const double FrameBegin = FrameIdx * FrameSeconds;
+
+		if (FrameIdx >= GMaxFrameInFlight)
+		{
+			for (uint32_t Queue = 0; Queue < NumQueues; Queue++)
+			{
+				// sample the clocks with up to 2 us of error, the reported deviation covers it
+				const double SampleSeconds = FrameBegin + Queue * 1e-4;
+				const double SampledCPUTime = ToCPUTime(SampleSeconds + RandomRange(-2e-6, 2e-6));
+				Calibrated.AddCalibrationSample(Queue, ToTick(SampleSeconds) & QueueTickMasks[Queue], std::llround(SampledCPUTime), 2000);
+
+				const UHSyntheticFrame& Frame = PendingFrames[Queue].front();
+				Scopes.clear();
+				for (const UHSyntheticScope& Scope : Frame.Scopes)
+				{
+					const uint64_t BeginTick = ToTick(Scope.BeginSeconds);
+					const uint64_t EndTick = ToTick(Scope.EndSeconds);
+					Scopes.push_back(UHGPUTimelineScope{ Scope.Name, Scope.Depth, BeginTick & QueueTickMasks[Queue], EndTick & QueueTickMasks[Queue] });
+					TrueTimes[Queue].push_back(std::make_pair(ToCPUTime(Scope.BeginSeconds), ToCPUTime(Scope.EndSeconds)));
+				}
+
+				// sum the reference the same way, from the unwrapped ticks
+				std::map<std::tuple<uint32_t, const char*, uint32_t>, float> FrameSums;
+				for (const UHSyntheticScope& Scope : Frame.Scopes)
+				{
+					const double DurationMs = (ToTick(Scope.EndSeconds) - ToTick(Scope.BeginSeconds)) * NsPerTick * 1e-6;
+					FrameSums[std::make_tuple(Queue, Scope.Name, Scope.Depth)] += static_cast<float>(DurationMs);
+				}
+				for (const auto& Sum : FrameSums)
+				{
+					ReferenceDurations[Sum.first].push_back(Sum.second);
+				}
+
+				if (Queue == 1)
+				{
+					const uint64_t ComputeTick = ToTick(Frame.Scopes[0].BeginSeconds);
+					NumWraps += (FrameIdx > GMaxFrameInFlight && (ComputeTick & QueueTickMasks[Queue]) < (LastComputeTick & QueueTickMasks[Queue])) ? 1 : 0;
+					FirstComputeTick = (FrameIdx == GMaxFrameInFlight) ? ComputeTick : FirstComputeTick;
+					LastComputeTick = ComputeTick;
+				}
+
+				Bounded.AddSubmitBound(Queue, Scopes[0].BeginTick, std::llround(ToCPUTime(Frame.SubmitSeconds)));
+				Calibrated.SubmitFrame(Queue, Scopes);
+				Bounded.SubmitFrame(Queue, Scopes);
+				NumScopes += Scopes.size();
+				PendingFrames[Queue].pop_front();
+			}
+		}
+
+		if (FrameIdx < NumFrames)
+		{
+			PendingFrames[0].push_back(GenerateGraphicsFrame(FrameBegin + 8e-3));
+			PendingFrames[1].push_back(GenerateComputeFrame(FrameBegin + 2e-3));
+		}
+	}
+
+	uint64_t NumErrors = 0;
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	// the submit cost is measured separately, so it doesn't include generating frames
+	std::vector<UHGPUTimelineScope> CostScopes;
+	for (uint32_t Idx = 0; Idx < 12; Idx++)
+	{
+		CostScopes.push_back(UHGPUTimelineScope{ "BenchmarkCost", Idx % 3, Idx * 1000ULL, Idx * 1000ULL + 500 });
+	}
+	UHGPUTimeline CostTimeline;
+	CostTimeline.AddQueue("Cost", NsPerTick, 64, SecondsPerCount);
+	CostTimeline.AddCalibrationSample(0, 0, CPUBase, 0);
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for (uint32_t FrameIdx = 0; FrameIdx < NumFrames; FrameIdx++)
+	{
+		CostTimeline.SubmitFrame(0, CostScopes);
+	}
+	const double SubmitNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count() * 1e9 / (NumFrames * CostScopes.size());
+
+	// percentiles against the reference, the stats don't depend on calibration so both timelines are the same
+	std::vector<UHGPUScopeStats> Stats;
+	std::vector<UHGPUScopeStats> BoundedStats;
+	StartTime = std::chrono::steady_clock::now();
+	Calibrated.GetStats(Stats);
+	const double StatsUs = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count() * 1e6;
+	Bounded.GetStats(BoundedStats);
+
+	double MaxStatError = 0.0;
+	NumErrors += (Stats.size() != ReferenceDurations.size() || BoundedStats.size() != Stats.size()) ? 1 : 0;
+	for (size_t Idx = 0; Idx < Stats.size(); Idx++)
+	{
+		const UHGPUScopeStats& Stat = Stats[Idx];
+		const auto Reference = ReferenceDurations.find(std::make_tuple(Stat.QueueIndex, Stat.Name, Stat.Depth));
+		if (Reference == ReferenceDurations.end())
+		{
+			NumErrors++;
+			continue;
+		}
+
+		const std::vector<float>& Durations = Reference->second;
+		const size_t NumSamples = (std::min)(Durations.size(), static_cast<size_t>(UHGPUTimeline::HistoryLength));
+		std::vector<float> Sorted(Durations.end() - NumSamples, Durations.end());
+		std::sort(Sorted.begin(), Sorted.end());
+		const auto Percentile = [&Sorted](double InPercent)
+		{
+			const size_t Rank = static_cast<size_t>(std::ceil(InPercent * Sorted.size()));
+			return Sorted[(std::max)(Rank, static_cast<size_t>(1)) - 1];
+		};
+
+		double Sum = 0.0;
+		for (const float Duration : Sorted)
+		{
+			Sum += Duration;
+		}
+
+		const double Errors[] = { Stat.LastMs - Durations.back(), Stat.AverageMs - Sum / NumSamples, Stat.P50Ms - Percentile(0.50)
+			, Stat.P95Ms - Percentile(0.95), Stat.P99Ms - Percentile(0.99), Stat.MaxMs - Sorted.back() };
+		for (const double Error : Errors)
+		{
+			MaxStatError = (std::max)(MaxStatError, std::abs(Error));
+		}
+
+		NumErrors += (Stat.NumSamples != NumSamples) ? 1 : 0;
+		NumErrors += (BoundedStats[Idx].Name != Stat.Name || BoundedStats[Idx].P99Ms != Stat.P99Ms) ? 1 : 0;
+	}
+	NumErrors += (MaxStatError > 1e-3) ? 1 : 0;
+
+	// mapped times against the truth, lanes keep the latest scopes so they're compared from the back
+	// a child must stay inside its parent after mapping
+	const auto MeasureLanes = [&](const UHGPUTimeline& InTimeline, double& OutMaxErrorUs, double& OutMeanErrorUs)
+	{
+		std::vector<UHCPUProfileThreadCapture> Lanes;
+		InTimeline.CaptureLanes(Lanes);
+		NumErrors += (Lanes.size() != NumQueues) ? 1 : 0;
+
+		OutMaxErrorUs = 0.0;
+		OutMeanErrorUs = 0.0;
+		uint64_t NumEvents = 0;
+		for (size_t Queue = 0; Queue < Lanes.size(); Queue++)
+		{
+			const std::vector<UHCPUProfileEvent>& Events = Lanes[Queue].Events;
+			const std::vector<std::pair<double, double>>& Truth = TrueTimes[Queue];
+			NumErrors += (Events.size() != (std::min)(Truth.size(), static_cast<size_t>(UHGPUTimeline::MaxLaneEvents))) ? 1 : 0;
+
+			std::vector<const UHCPUProfileEvent*> Parents;
+			const size_t Count = (std::min)(Events.size(), Truth.size());
+			for (size_t Idx = 0; Idx < Count; Idx++)
+			{
+				const UHCPUProfileEvent& Event = Events[Events.size() - Count + Idx];
+				const std::pair<double, double>& TrueTime = Truth[Truth.size() - Count + Idx];
+				const double ErrorUs = (std::max)(std::abs(Event.BeginTime - TrueTime.first), std::abs(Event.EndTime - TrueTime.second)) * SecondsPerCount * 1e6;
+				OutMaxErrorUs = (std::max)(OutMaxErrorUs, ErrorUs);
+				OutMeanErrorUs += ErrorUs;
+				NumEvents++;
+
+				// the oldest scopes in a full lane can be children of dropped parents
+				if (Parents.size() == 0 && Event.Depth > 0)
+				{
+					continue;
+				}
+
+				while (Parents.size() > Event.Depth)
+				{
+					Parents.pop_back();
+				}
+
+				if (Event.Depth > 0)
+				{
+					const UHCPUProfileEvent* Parent = Parents.back();
+					NumErrors += (Parent->BeginTime > Event.BeginTime || Parent->EndTime < Event.EndTime) ? 1 : 0;
+				}
+				Parents.push_back(&Event);
+			}
+		}
+		OutMeanErrorUs /= (std::max)(NumEvents, static_cast<uint64_t>(1));
+	};
+
+	double CalibratedMaxUs = 0.0;
+	double CalibratedMeanUs = 0.0;
+	double BoundedMaxUs = 0.0;
+	double BoundedMeanUs = 0.0;
+	MeasureLanes(Calibrated, CalibratedMaxUs, CalibratedMeanUs);
+	MeasureLanes(Bounded, BoundedMaxUs, BoundedMeanUs);
+	NumErrors += (CalibratedMaxUs > 10.0 || BoundedMaxUs > 500.0) ? 1 : 0;
+
+	// the fitted slope follows the drift once the samples span a while, a faster device clock means fewer CPU counts per tick
+	const double FittedDriftPPM = Calibrated.GetCalibration(0).GetDriftPPM();
+	const double ExpectedDriftPPM = (1.0 / (1.0 + DriftPPM * 1e-6) - 1.0) * 1e6;
+	NumErrors += (NumFrames >= UHGPUClockCalibration::MaxSamples && std::abs(FittedDriftPPM - ExpectedDriftPPM) > 10.0) ? 1 : 0;
+
+	// every wrap of the compute queue is seen once
+	const uint32_t ExpectedWraps = static_cast<uint32_t>((LastComputeTick >> 32) - (FirstComputeTick >> 32));
+	NumErrors += (NumWraps != ExpectedWraps) ? 1 : 0;
+
+	// export with CPU scopes, GPU lanes are marked with the GPU category
+	std::vector<UHCPUProfileThreadCapture> Lanes;
+	Calibrated.CaptureLanes(Lanes);
+	size_t NumLaneEvents = 0;
+	for (const UHCPUProfileThreadCapture& Lane : Lanes)
+	{
+		NumLaneEvents += Lane.Events.size();
+	}
+
+	const std::filesystem::path TracePath = GProfileCapturePath + "BenchmarkGPUTrace.json";
+	const bool bExported = UHCPUProfiler::ExportChromeTrace(TracePath, Lanes);
+	UHCPUProfiler::SetEnabled(false);
+
+	std::ifstream TraceIn(TracePath);
+	std::stringstream TraceStream;
+	TraceStream << TraceIn.rdbuf();
+	const std::string Trace = TraceStream.str();
+	const auto CountInTrace = [&Trace](const std::string& InPattern)
+	{
+		size_t Count = 0;
+		for (size_t Pos = Trace.find(InPattern); Pos != std::string::npos; Pos = Trace.find(InPattern, Pos + 1))
+		{
+			Count++;
+		}
+		return Count;
+	};
+	const size_t NumGPUEvents = CountInTrace("\"cat\":\"GPU\"");
+	const size_t NumCPUFrames = CountInTrace("\"name\":\"BenchmarkGPUTimelineFrame\"");
+	// a full ring drops its oldest slot as it's the next one to be overwritten
+	const size_t ExpectedCPUFrames = (std::min)(static_cast<size_t>(NumFrames + GMaxFrameInFlight), static_cast<size_t>(UHCPUProfiler::EventsPerThread - 1));
+	NumErrors += (!bExported || NumGPUEvents != NumLaneEvents || NumCPUFrames != ExpectedCPUFrames
+		|| CountInTrace("\"GPU Async Compute Queue\"") != 1) ? 1 : 0;
+
+	UH_TOOL_CHECK(NumErrors == 0);
+
+	std::wstring Summary = L"GPU timeline benchmark, " + std::to_wstring(NumFrames) + L" frames, " + std::to_wstring(NumQueues) + L" queues, "
+		+ std::to_wstring(NumScopes) + L" scopes\n";
+	Summary += L"Submit: " + std::to_wstring(SubmitNs) + L" ns per scope, stats of " + std::to_wstring(Stats.size()) + L" scopes in "
+		+ std::to_wstring(StatsUs) + L" us, max percentile error " + std::to_wstring(MaxStatError) + L" ms\n";
+	Summary += L"Calibrated timestamps: max error " + std::to_wstring(CalibratedMaxUs) + L" us, mean " + std::to_wstring(CalibratedMeanUs)
+		+ L" us, drift " + std::to_wstring(FittedDriftPPM) + L" ppm (expected " + std::to_wstring(ExpectedDriftPPM) + L" ppm)\n";
+	Summary += L"Submit bounds only: max error " + std::to_wstring(BoundedMaxUs) + L" us, mean " + std::to_wstring(BoundedMeanUs) + L" us\n";
+	Summary += L"Compute queue wraps: " + std::to_wstring(NumWraps) + L", exported " + std::to_wstring(NumGPUEvents) + L" GPU scopes to "
+		+ TracePath.wstring() + L"\n";
+	Summary += std::to_wstring(NumErrors) + L" errors\n";
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
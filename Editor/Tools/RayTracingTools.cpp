@@ -0,0 +1,174 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../../Runtime/Classes/TopLevelInstanceTracker.h"
+#include <chrono>
+
+// simulates top-level AS instances of a city-style scene with moving renderers, the camera flies through it and then hovers
+// the tracker keeps instances compacted around the ray tracing culling distance and uploads dirty ranges only
+// it's compared with rewriting and uploading all instances every frame, and the uploaded copy is validated every frame
+// the flight must not rebuild the AS every frame, as renderers are added ahead of the camera with the nearby range
+void BenchmarkTopLevelAS(const uint32_t NumRenderers)
+{
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	// 2% of renderers keep moving, the others are static
+	std::vector<XMFLOAT3> Positions(NumRenderers);
+	std::vector<XMFLOAT3> Velocities(NumRenderers, XMFLOAT3());
+	std::vector<float> Sizes(NumRenderers);
+	std::vector<uint32_t> Movers;
+	for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+	{
+		Positions[Idx] = XMFLOAT3((NextRandom() % 20001) * 0.1f - 1000.0f, (NextRandom() % 501) * 0.1f, (NextRandom() % 20001) * 0.1f - 1000.0f);
+		Sizes[Idx] = 1.0f + (NextRandom() % 90) * 0.1f;
+		if (NextRandom() % 50 == 0)
+		{
+			Velocities[Idx] = XMFLOAT3((NextRandom() % 201) * 0.001f - 0.1f, 0.0f, (NextRandom() % 201) * 0.001f - 0.1f);
+			Movers.push_back(Idx);
+		}
+	}
+
+	const auto MakeInstance = [&Positions](uint32_t Idx)
+	{
+		VkAccelerationStructureInstanceKHR Instance{};
+		Instance.transform.matrix[0][0] = 1.0f;
+		Instance.transform.matrix[1][1] = 1.0f;
+		Instance.transform.matrix[2][2] = 1.0f;
+		Instance.transform.matrix[0][3] = Positions[Idx].x;
+		Instance.transform.matrix[1][3] = Positions[Idx].y;
+		Instance.transform.matrix[2][3] = Positions[Idx].z;
+		Instance.instanceCustomIndex = Idx;
+		Instance.mask = 0xff;
+		Instance.instanceShaderBindingTableRecordOffset = Idx % 8;
+		Instance.accelerationStructureReference = (Idx % 64 + 1) * 4096;
+		return Instance;
+	};
+
+	const float CullingRadius = 300.0f;
+	const auto GetState = [&Positions, CullingRadius](uint32_t Idx, const XMFLOAT3& CameraPos)
+	{
+		const float X = Positions[Idx].x - CameraPos.x;
+		const float Y = Positions[Idx].y - CameraPos.y;
+		const float Z = Positions[Idx].z - CameraPos.z;
+		return UHTopLevelInstanceTracker::GetRangeState(true, X * X + Y * Y + Z * Z, CullingRadius);
+	};
+
+	UHTopLevelInstanceTracker Tracker;
+	Tracker.Reset(NumRenderers);
+	for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+	{
+		Tracker.SetInstance(Idx, MakeInstance(Idx), BoundingBox(Positions[Idx], XMFLOAT3(Sizes[Idx], Sizes[Idx], Sizes[Idx])));
+	}
+
+	// the copy of the instance buffer, it only receives the dirty ranges
+	std::vector<VkAccelerationStructureInstanceKHR> UploadedInstances(NumRenderers);
+	std::vector<VkAccelerationStructureInstanceKHR> FullInstances(NumRenderers);
+	std::vector<VkAccelerationStructureInstanceKHR> FullUploadedInstances(NumRenderers);
+	std::vector<uint32_t> SeenCounts(NumRenderers);
+
+	const int32_t NumFrames = 600;
+	double TrackerSeconds = 0.0;
+	double FullSeconds = 0.0;
+	uint64_t TrackerBytes = 0;
+	uint64_t FullBytes = 0;
+	uint64_t NumChurns = 0;
+	uint32_t NumModes[3] = { 0, 0, 0 };
+	uint32_t NumFlightRebuilds = 0;
+	uint32_t NumErrors = 0;
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	for (int32_t Frame = 0; Frame < NumFrames; Frame++)
+	{
+		// the camera flies through the city in the first half, instances are added and removed while flying
+		const XMFLOAT3 CameraPos(-900.0f + 900.0f * (std::min)(Frame, NumFrames / 2) / (NumFrames / 2), 20.0f, 0.0f);
+		for (const uint32_t Idx : Movers)
+		{
+			Positions[Idx].x += Velocities[Idx].x;
+			Positions[Idx].z += Velocities[Idx].z;
+		}
+
+		// rewrite all instances and mask out the ones beyond culling distance
+		const std::chrono::steady_clock::time_point FullStartTime = std::chrono::steady_clock::now();
+		for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+		{
+			FullInstances[Idx] = MakeInstance(Idx);
+			FullInstances[Idx].mask = (GetState(Idx, CameraPos) == UHTopLevelInstanceState::Needed) ? 0xff : 0;
+		}
+		memcpy_s(FullUploadedInstances.data(), FullUploadedInstances.size() * sizeof(VkAccelerationStructureInstanceKHR)
+			, FullInstances.data(), FullInstances.size() * sizeof(VkAccelerationStructureInstanceKHR));
+		FullSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - FullStartTime).count();
+		FullBytes += NumRenderers * sizeof(VkAccelerationStructureInstanceKHR);
+
+		// the tracker receives moved renderers only, and checks the culling distance of all as the renderer does
+		const std::vector<VkAccelerationStructureInstanceKHR>& Instances = Tracker.GetInstances();
+		const std::chrono::steady_clock::time_point TrackerStartTime = std::chrono::steady_clock::now();
+		for (const uint32_t Idx : Movers)
+		{
+			Tracker.SetInstance(Idx, MakeInstance(Idx), BoundingBox(Positions[Idx], XMFLOAT3(Sizes[Idx], Sizes[Idx], Sizes[Idx])));
+		}
+		for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+		{
+			Tracker.SetState(Idx, GetState(Idx, CameraPos));
+		}
+		Tracker.Commit();
+		for (const UHTopLevelInstanceRange& Range : Tracker.GetDirtyRanges())
+		{
+			std::copy(Instances.begin() + Range.FirstSlot, Instances.begin() + Range.FirstSlot + Range.Count, UploadedInstances.begin() + Range.FirstSlot);
+		}
+		TrackerSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - TrackerStartTime).count();
+
+		const UHTopLevelInstanceStats& Stats = Tracker.GetStats();
+		TrackerBytes += Stats.UploadBytes;
+		NumChurns += Stats.NumAdded + Stats.NumRemoved;
+		NumModes[UH_ENUM_VALUE(Stats.BuildMode)]++;
+		NumFlightRebuilds += (Frame < NumFrames / 2 && Stats.BuildMode == UHTopLevelBuildMode::Rebuild) ? 1 : 0;
+
+		// every uploaded instance must be the latest one and masked out only when it's culled, nothing is uploaded twice
+		std::fill(SeenCounts.begin(), SeenCounts.end(), 0);
+		uint32_t NumMasked = 0;
+		for (uint32_t Slot = 0; Slot < Stats.NumInstances; Slot++)
+		{
+			const VkAccelerationStructureInstanceKHR& Uploaded = UploadedInstances[Slot];
+			const uint32_t RendererIdx = Uploaded.instanceCustomIndex;
+			VkAccelerationStructureInstanceKHR Expected = MakeInstance(RendererIdx);
+			Expected.mask = (GetState(RendererIdx, CameraPos) == UHTopLevelInstanceState::Culled) ? 0 : Expected.mask;
+			NumMasked += (Expected.mask == 0) ? 1 : 0;
+			NumErrors += (memcmp(&Uploaded, &Expected, sizeof(VkAccelerationStructureInstanceKHR)) != 0) ? 1 : 0;
+			NumErrors += (Tracker.GetRendererOfSlot(Slot) != RendererIdx || Tracker.GetSlotOfRenderer(RendererIdx) != static_cast<int32_t>(Slot)) ? 1 : 0;
+			SeenCounts[RendererIdx]++;
+		}
+		NumErrors += (NumMasked != Stats.NumMasked) ? 1 : 0;
+
+		// and every renderer within the culling distance must be in the AS
+		for (uint32_t Idx = 0; Idx < NumRenderers; Idx++)
+		{
+			NumErrors += (SeenCounts[Idx] > 1) ? 1 : 0;
+			NumErrors += (GetState(Idx, CameraPos) == UHTopLevelInstanceState::Needed && SeenCounts[Idx] == 0) ? 1 : 0;
+		}
+	}
+	UH_TOOL_CHECK(NumErrors == 0);
+	UH_TOOL_CHECK(NumFlightRebuilds <= NumFrames / 10);
+
+	std::wstring Summary = L"Top level AS benchmark, " + std::to_wstring(NumRenderers) + L" renderers, " + std::to_wstring(Movers.size())
+		+ L" moving, " + std::to_wstring(NumFrames) + L" frames\n";
+	Summary += L"Full rewrite: " + std::to_wstring(FullSeconds * 1000.0 / NumFrames) + L" ms, "
+		+ std::to_wstring(FullBytes / NumFrames / 1024) + L" KB uploaded per frame\n";
+	Summary += L"Incremental: " + std::to_wstring(TrackerSeconds * 1000.0 / NumFrames) + L" ms, "
+		+ std::to_wstring(TrackerBytes / NumFrames / 1024) + L" KB uploaded per frame, "
+		+ std::to_wstring(static_cast<double>(NumChurns) / NumFrames) + L" instances added/removed per frame\n";
+	Summary += L"Builds: " + std::to_wstring(NumModes[UH_ENUM_VALUE(UHTopLevelBuildMode::Rebuild)]) + L" rebuilds, "
+		+ std::to_wstring(NumModes[UH_ENUM_VALUE(UHTopLevelBuildMode::Refit)]) + L" refits, "
+		+ std::to_wstring(NumModes[UH_ENUM_VALUE(UHTopLevelBuildMode::None)]) + L" skipped, " + std::to_wstring(NumFlightRebuilds)
+		+ L" rebuilds while flying, " + std::to_wstring(NumErrors) + L" errors\n";
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
@@ -0,0 +1,400 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../Classes/ShaderImporter.h"
+#include "../../Runtime/Classes/AssetPath.h"
+#include "../../Runtime/Classes/GraphicState.h"
+#include "../../Runtime/Classes/Shader.h"
+#include "../../Runtime/Classes/Utility.h"
+#include "../../Runtime/Engine/ResourcePool.h"
+#include <chrono>
+#include <fstream>
+#include <unordered_map>
+
+// compiles all shaders under the shader folder with a stub compiler through the shader cache, in cold serial, cold parallel,
+// warm, outputs deleted and reloaded index passes, then reports the hit rate and the wall time of each pass.
+// the shaders are copied to the temp folder first, so the last pass can touch an include and check only its dependents recompile
+void BenchmarkShaderCache(const uint32_t CompileTimeMs)
+{
+	const std::string BenchmarkFolder = GTempFilePath + "ShaderCacheBenchmark/";
+	const std::string OutputFolder = BenchmarkFolder + "Output/";
+	const std::string SourceFolder = BenchmarkFolder + "Shaders/";
+	std::error_code Error;
+	std::filesystem::remove_all(BenchmarkFolder, Error);
+	std::filesystem::create_directories(SourceFolder, Error);
+	std::filesystem::copy(GRawShaderPath, SourceFolder, std::filesystem::copy_options::recursive, Error);
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	// every shader with and without a define, so both the permutations and the include closure are covered
+	std::vector<UHShaderCompileRequest> Requests;
+	for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(SourceFolder))
+	{
+		if (!Entry.is_regular_file() || !UHAssetPath::IsTheSameExtension(Entry.path(), GRawShaderExtension))
+		{
+			continue;
+		}
+
+		UHShaderCompileRequest Request;
+		Request.SourcePath = Entry.path();
+		Request.EntryName = "main";
+		Request.ProfileName = "ps_6_0";
+		Request.OutputPath = OutputFolder + Entry.path().stem().string() + std::to_string(Requests.size()) + GShaderAssetExtension;
+		Requests.push_back(Request);
+
+		Request.Defines.push_back("UH_BENCHMARK_PERMUTATION=1");
+		Request.OutputPath = OutputFolder + Entry.path().stem().string() + std::to_string(Requests.size()) + GShaderAssetExtension;
+		Requests.push_back(Request);
+	}
+
+	std::wstring Summary = L"Shader cache benchmark, " + std::to_wstring(Requests.size()) + L" requests, " + std::to_wstring(CompileTimeMs)
+		+ L" ms per compile\n";
+	const auto AddPass = [&Summary](const std::wstring& InName, const UHShaderCompileStats& InStats)
+	{
+		Summary += InName + L": " + InStats.ToString() + L"\n";
+	};
+
+	{
+		UHShaderImporter SerialImporter(MakeUnique<UHStubShaderCompiler>(CompileTimeMs), BenchmarkFolder + "SerialCache/", 1);
+		SerialImporter.LoadShaderCache();
+		AddPass(L"Cold, 1 worker", SerialImporter.CompileShaders(Requests));
+	}
+
+	const uint32_t NumRequests = static_cast<uint32_t>(Requests.size());
+	UH_TOOL_CHECK(NumRequests > 0);
+
+	std::filesystem::remove_all(OutputFolder, Error);
+	const std::string CachePath = BenchmarkFolder + "Cache/";
+	{
+		UHShaderImporter Importer(MakeUnique<UHStubShaderCompiler>(CompileTimeMs), CachePath);
+		Importer.LoadShaderCache();
+		const UHShaderCompileStats ColdStats = Importer.CompileShaders(Requests);
+		AddPass(L"Cold, " + std::to_wstring(std::thread::hardware_concurrency()) + L" workers", ColdStats);
+		UH_TOOL_CHECK(ColdStats.NumHits == 0 && ColdStats.NumFailed == 0);
+
+		const UHShaderCompileStats WarmStats = Importer.CompileShaders(Requests);
+		AddPass(L"Warm", WarmStats);
+		UH_TOOL_CHECK(WarmStats.NumRequests == NumRequests && WarmStats.NumHits == NumRequests);
+
+		std::filesystem::remove_all(OutputFolder, Error);
+		AddPass(L"Outputs deleted", Importer.CompileShaders(Requests));
+	}
+
+	{
+		UHShaderImporter ReloadedImporter(MakeUnique<UHStubShaderCompiler>(CompileTimeMs), CachePath);
+		ReloadedImporter.LoadShaderCache();
+		const UHShaderCompileStats ReloadedStats = ReloadedImporter.RecompileCachedShaders();
+		AddPass(L"Reloaded index", ReloadedStats);
+		UH_TOOL_CHECK(ReloadedStats.NumRequests == NumRequests && ReloadedStats.NumHits == NumRequests);
+
+		// touch the include with the fewest dependents, only the requests including it should compile again
+		UHShaderIncludeGraph IncludeGraph;
+		std::unordered_map<std::string, uint32_t> NumDependents;
+		for (const UHShaderCompileRequest& Request : Requests)
+		{
+			for (const std::string& Include : IncludeGraph.GetIncludeClosure(Request.SourcePath))
+			{
+				NumDependents[Include]++;
+			}
+		}
+
+		std::string TouchedInclude;
+		for (const std::pair<const std::string, uint32_t>& Include : NumDependents)
+		{
+			if (std::filesystem::exists(Include.first) && (TouchedInclude.empty() || Include.second < NumDependents[TouchedInclude]
+				|| (Include.second == NumDependents[TouchedInclude] && Include.first < TouchedInclude)))
+			{
+				TouchedInclude = Include.first;
+			}
+		}
+		UH_TOOL_CHECK(!TouchedInclude.empty());
+
+		if (!TouchedInclude.empty())
+		{
+			const std::filesystem::file_time_type LastWriteTime = std::filesystem::last_write_time(TouchedInclude, Error);
+			{
+				std::ofstream IncludeOut(TouchedInclude, std::ios::out | std::ios::app);
+				IncludeOut << "\n// touched by the shader cache benchmark\n";
+			}
+			std::filesystem::last_write_time(TouchedInclude, LastWriteTime + std::chrono::seconds(2), Error);
+
+			const UHShaderCompileStats TouchedStats = ReloadedImporter.CompileShaders(Requests);
+			AddPass(L"Include touched, " + std::to_wstring(NumDependents[TouchedInclude]) + L" dependents", TouchedStats);
+			UH_TOOL_CHECK(TouchedStats.NumHits == NumRequests - NumDependents[TouchedInclude] && TouchedStats.NumFailed == 0);
+		}
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// pools with the linear search before UHResourcePool, states are found by value and erased from the vector
+class UHLinearRefreshPools
+{
+public:
+	using StateRef = UHGraphicState*;
+
+	uint32_t RequestShader(UniquePtr<UHShader>& InShader, bool& bOutIsHit)
+	{
+		const int32_t Idx = UHUtilities::FindIndex(Shaders, *InShader);
+		bOutIsHit = (Idx != UHINDEXNONE);
+		if (bOutIsHit)
+		{
+			return Shaders[Idx]->GetId();
+		}
+
+		Shaders.push_back(std::move(InShader));
+		return Shaders.back()->GetId();
+	}
+
+	StateRef RequestState(const UHRenderPassInfo& InInfo, bool& bOutIsHit)
+	{
+		UniquePtr<UHGraphicState> NewState = MakeUnique<UHGraphicState>(InInfo);
+		const int32_t Idx = UHUtilities::FindIndex(States, *NewState);
+		bOutIsHit = (Idx != UHINDEXNONE);
+		if (bOutIsHit)
+		{
+			States[Idx]->IncreaseRefCount();
+			return States[Idx].get();
+		}
+
+		NewState->IncreaseRefCount();
+		States.push_back(std::move(NewState));
+		return States.back().get();
+	}
+
+	void ReleaseState(StateRef InState)
+	{
+		const int32_t Idx = UHUtilities::FindIndex(States, *InState);
+		if (Idx != UHINDEXNONE)
+		{
+			InState->DecreaseRefCount();
+			if (InState->GetRefCount() == 0)
+			{
+				UHUtilities::RemoveByIndex(States, Idx);
+			}
+		}
+	}
+
+	size_t GetNumStates() const
+	{
+		return States.size();
+	}
+
+private:
+	std::vector<UniquePtr<UHShader>> Shaders;
+	std::vector<UniquePtr<UHGraphicState>> States;
+};
+
+// the same requests through UHResourcePool as UHGraphic does, states are referenced by generation-checked handles
+class UHHandleRefreshPools
+{
+public:
+	using StateRef = UHResourceHandle;
+
+	uint32_t RequestShader(UniquePtr<UHShader>& InShader, bool& bOutIsHit)
+	{
+		const size_t Hash = InShader->GetHash();
+		const UHShader* CachedShader = Shaders.Find(Hash, *InShader);
+		bOutIsHit = (CachedShader != nullptr);
+		if (bOutIsHit)
+		{
+			return CachedShader->GetId();
+		}
+
+		const uint32_t ShaderID = InShader->GetId();
+		Shaders.Add(InShader, Hash);
+		return ShaderID;
+	}
+
+	StateRef RequestState(const UHRenderPassInfo& InInfo, bool& bOutIsHit)
+	{
+		UniquePtr<UHGraphicState> NewState = MakeUnique<UHGraphicState>(InInfo);
+		const size_t Hash = NewState->GetHash();
+		UHGraphicState* CachedState = States.Find(Hash, *NewState);
+		bOutIsHit = (CachedState != nullptr);
+		if (bOutIsHit)
+		{
+			CachedState->IncreaseRefCount();
+			return States.GetHandle(CachedState);
+		}
+
+		NewState->IncreaseRefCount();
+		return States.Add(NewState, Hash);
+	}
+
+	void ReleaseState(StateRef InHandle)
+	{
+		UHGraphicState* State = States.Get(InHandle);
+		if (State != nullptr)
+		{
+			State->DecreaseRefCount();
+			if (State->GetRefCount() == 0)
+			{
+				States.Remove(State);
+			}
+		}
+	}
+
+	UHGraphicState* GetState(StateRef InHandle) const
+	{
+		return States.Get(InHandle);
+	}
+
+	size_t GetNumStates() const
+	{
+		return States.Size();
+	}
+
+private:
+	UHResourcePool<UHShader> Shaders;
+	UHResourcePool<UHGraphicState> States;
+};
+
+// counters of a material refresh run, both paths must end up with the same ones
+struct UHMaterialRefreshStats
+{
+	UHMaterialRefreshStats()
+		: NumShaderHits(0)
+		, NumStateHits(0)
+		, NumStateMisses(0)
+		, NumStates(0)
+		, ElapsedMs(0.0)
+	{
+
+	}
+
+	uint32_t NumShaderHits;
+	uint32_t NumStateHits;
+	uint32_t NumStateMisses;
+	size_t NumStates;
+	double ElapsedMs;
+};
+
+// the fixed scene of the material refresh benchmark, every material has a pixel shader and a graphic state
+// in the depth, base and motion passes, and the passes share one vertex shader each
+static const uint32_t GNumMaterialRefreshPasses = 3;
+static const char* GMaterialRefreshPassNames[GNumMaterialRefreshPasses] = { "DepthPass", "BasePass", "MotionPass" };
+
+template <typename PoolsType>
+struct UHMaterialRefreshScene
+{
+	uint32_t VertexShaders[GNumMaterialRefreshPasses];
+	std::vector<typename PoolsType::StateRef> States;
+};
+
+static UniquePtr<UHShader> MakeRefreshShader(const uint32_t InPass, const bool bIsMaterialShader, const uint32_t InMaterial = 0)
+{
+	const std::string ShaderName = bIsMaterialShader
+		? "Materials/BenchmarkMaterial" + std::to_string(InMaterial) + "_" + GMaterialRefreshPassNames[InPass]
+		: GMaterialRefreshPassNames[InPass];
+
+	return MakeUnique<UHShader>(ShaderName, GRawShaderPath + GMaterialRefreshPassNames[InPass], "main"
+		, bIsMaterialShader ? "ps_6_0" : "vs_6_0", bIsMaterialShader, std::vector<std::string>());
+}
+
+// the render passes and layouts only need to be distinct keys, the states are never created on a device
+static UHRenderPassInfo MakeRefreshPassInfo(const uint32_t InMaterial, const uint32_t InPass, const uint32_t InVS, const uint32_t InPS)
+{
+	return UHRenderPassInfo(reinterpret_cast<VkRenderPass>(static_cast<uintptr_t>(InPass + 1)), UHDepthInfo()
+		, static_cast<UHCullMode>(InMaterial % static_cast<uint32_t>(UHCullMode::CullModeMax))
+		, (InMaterial % 4 == 0) ? UHBlendMode::Masked : UHBlendMode::Opaque
+		, InVS, InPS, 1, reinterpret_cast<VkPipelineLayout>(static_cast<uintptr_t>(InPass + 1)));
+}
+
+template <typename PoolsType>
+void BuildMaterialRefreshScene(PoolsType& InPools, const uint32_t NumMaterials, UHMaterialRefreshScene<PoolsType>& OutScene)
+{
+	bool bIsHit = false;
+	for (uint32_t Pass = 0; Pass < GNumMaterialRefreshPasses; Pass++)
+	{
+		UniquePtr<UHShader> Shader = MakeRefreshShader(Pass, false);
+		OutScene.VertexShaders[Pass] = InPools.RequestShader(Shader, bIsHit);
+	}
+
+	OutScene.States.resize(NumMaterials * GNumMaterialRefreshPasses);
+	for (uint32_t Mat = 0; Mat < NumMaterials; Mat++)
+	{
+		for (uint32_t Pass = 0; Pass < GNumMaterialRefreshPasses; Pass++)
+		{
+			UniquePtr<UHShader> Shader = MakeRefreshShader(Pass, true, Mat);
+			const uint32_t PixelShader = InPools.RequestShader(Shader, bIsHit);
+			OutScene.States[Mat * GNumMaterialRefreshPasses + Pass]
+				= InPools.RequestState(MakeRefreshPassInfo(Mat, Pass, OutScene.VertexShaders[Pass], PixelShader), bIsHit);
+		}
+	}
+}
+
+// refresh every material the way RecreateMaterialState does, the pixel shader is found in the pool
+// and the old state is released before the state of the new pass info is requested
+template <typename PoolsType>
+UHMaterialRefreshStats RefreshMaterialScene(PoolsType& InPools, UHMaterialRefreshScene<PoolsType>& InScene)
+{
+	UHMaterialRefreshStats Stats;
+	const uint32_t NumMaterials = static_cast<uint32_t>(InScene.States.size()) / GNumMaterialRefreshPasses;
+
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for (uint32_t Mat = 0; Mat < NumMaterials; Mat++)
+	{
+		for (uint32_t Pass = 0; Pass < GNumMaterialRefreshPasses; Pass++)
+		{
+			bool bIsHit = false;
+			UniquePtr<UHShader> Shader = MakeRefreshShader(Pass, true, Mat);
+			const uint32_t PixelShader = InPools.RequestShader(Shader, bIsHit);
+			Stats.NumShaderHits += bIsHit ? 1 : 0;
+
+			typename PoolsType::StateRef& State = InScene.States[Mat * GNumMaterialRefreshPasses + Pass];
+			InPools.ReleaseState(State);
+			State = InPools.RequestState(MakeRefreshPassInfo(Mat, Pass, InScene.VertexShaders[Pass], PixelShader), bIsHit);
+			Stats.NumStateHits += bIsHit ? 1 : 0;
+			Stats.NumStateMisses += bIsHit ? 0 : 1;
+		}
+	}
+	Stats.ElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+	Stats.NumStates = InPools.GetNumStates();
+
+	return Stats;
+}
+
+// refreshes the shaders and states of a fixed scene of NumMaterials materials with the linear pools and the resource pools,
+// reports both timings and checks they see the same traffic and the handles released by the refresh don't resolve anymore
+void BenchmarkMaterialRefreshPools(const uint32_t NumMaterials)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	const uint32_t NumRequests = NumMaterials * GNumMaterialRefreshPasses;
+
+	UHLinearRefreshPools LinearPools;
+	UHMaterialRefreshScene<UHLinearRefreshPools> LinearScene;
+	BuildMaterialRefreshScene(LinearPools, NumMaterials, LinearScene);
+	const UHMaterialRefreshStats LinearStats = RefreshMaterialScene(LinearPools, LinearScene);
+
+	UHHandleRefreshPools HandlePools;
+	UHMaterialRefreshScene<UHHandleRefreshPools> HandleScene;
+	BuildMaterialRefreshScene(HandlePools, NumMaterials, HandleScene);
+	const std::vector<UHResourceHandle> ReleasedHandles = HandleScene.States;
+	const UHMaterialRefreshStats HandleStats = RefreshMaterialScene(HandlePools, HandleScene);
+
+	// the refreshed states reuse the freed slots, the handles from before the refresh must not resolve to them
+	uint32_t NumStaleResolved = 0;
+	for (const UHResourceHandle& Handle : ReleasedHandles)
+	{
+		NumStaleResolved += (HandlePools.GetState(Handle) != nullptr) ? 1 : 0;
+	}
+
+	std::wstring Summary = L"Material refresh benchmark, " + std::to_wstring(NumMaterials) + L" materials, "
+		+ std::to_wstring(NumRequests) + L" shader and state requests\n";
+	Summary += L"Linear pools: " + std::to_wstring(LinearStats.ElapsedMs) + L" ms\n";
+	Summary += L"Resource pools: " + std::to_wstring(HandleStats.ElapsedMs) + L" ms\n";
+	Summary += L"Speedup: " + std::to_wstring(LinearStats.ElapsedMs / (std::max)(HandleStats.ElapsedMs, 0.001)) + L"x\n";
+
+	UH_TOOL_CHECK(LinearStats.NumShaderHits == NumRequests && HandleStats.NumShaderHits == NumRequests);
+	UH_TOOL_CHECK(LinearStats.NumStateMisses == NumRequests && HandleStats.NumStateMisses == NumRequests);
+	UH_TOOL_CHECK(LinearStats.NumStates == NumRequests && HandleStats.NumStates == NumRequests);
+	UH_TOOL_CHECK(NumStaleResolved == 0);
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
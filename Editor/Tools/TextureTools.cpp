@@ -0,0 +1,440 @@
+#include "CommandLineTools.h"
+
+#if WITH_EDITOR
+#include "../Classes/TextureBatchImporter.h"
+#include "../../Runtime/Classes/TextureCompressor.h"
+#include "../../Runtime/Classes/Texture2D.h"
+#include "../../Runtime/Engine/TextureStreaming.h"
+#include <DirectXPackedVector.h>
+#include <chrono>
+#include <deque>
+
+// PSNR of the first NumChannels channels of RGBA8 images
+static double CalculatePSNR(const std::vector<uint8_t>& Reference, const std::vector<uint8_t>& Decoded, const int32_t NumChannels)
+{
+	double SquaredError = 0.0;
+	for (size_t Idx = 0; Idx < Reference.size(); Idx += 4)
+	{
+		for (int32_t Ch = 0; Ch < NumChannels; Ch++)
+		{
+			const double Diff = static_cast<double>(Reference[Idx + Ch]) - static_cast<double>(Decoded[Idx + Ch]);
+			SquaredError += Diff * Diff;
+		}
+	}
+
+	const double MeanError = SquaredError / static_cast<double>(Reference.size() / 4 * NumChannels);
+	return (MeanError > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / MeanError) : 99.0;
+}
+
+// PSNR of RGBAHalf images, the RGB are tone mapped with x / (1 + x) first
+static double CalculatePSNRHDR(const std::vector<uint8_t>& Reference, const std::vector<uint8_t>& Decoded)
+{
+	std::vector<uint8_t> ReferenceLDR(Reference.size() / 2);
+	std::vector<uint8_t> DecodedLDR(Decoded.size() / 2);
+	for (size_t Idx = 0; Idx < ReferenceLDR.size(); Idx++)
+	{
+		DirectX::PackedVector::HALF ReferenceHalf;
+		DirectX::PackedVector::HALF DecodedHalf;
+		memcpy(&ReferenceHalf, &Reference[Idx * 2], sizeof(ReferenceHalf));
+		memcpy(&DecodedHalf, &Decoded[Idx * 2], sizeof(DecodedHalf));
+
+		const float ReferenceValue = (std::max)(DirectX::PackedVector::XMConvertHalfToFloat(ReferenceHalf), 0.0f);
+		const float DecodedValue = (std::max)(DirectX::PackedVector::XMConvertHalfToFloat(DecodedHalf), 0.0f);
+		ReferenceLDR[Idx] = static_cast<uint8_t>(ReferenceValue / (1.0f + ReferenceValue) * 255.0f + 0.5f);
+		DecodedLDR[Idx] = static_cast<uint8_t>(DecodedValue / (1.0f + DecodedValue) * 255.0f + 0.5f);
+	}
+
+	return CalculatePSNR(ReferenceLDR, DecodedLDR, 3);
+}
+
+// fixed test set of the compression benchmark, all images are generated with fixed seeds so the results are comparable
+static std::vector<std::vector<uint8_t>> CreateCompressionTestSet(const uint32_t Size, const bool bIsHDR)
+{
+	std::vector<std::vector<uint8_t>> TestSet;
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 24;
+	};
+
+	for (uint32_t ImageIdx = 0; ImageIdx < 4; ImageIdx++)
+	{
+		std::vector<uint8_t> Image(static_cast<size_t>(Size) * Size * (bIsHDR ? 8 : 4));
+		for (uint32_t Y = 0; Y < Size; Y++)
+		{
+			for (uint32_t X = 0; X < Size; X++)
+			{
+				const float U = static_cast<float>(X) / Size;
+				const float V = static_cast<float>(Y) / Size;
+				float Texel[4];
+				switch (ImageIdx)
+				{
+				case 0:
+					// smooth gradients
+					Texel[0] = U;
+					Texel[1] = V;
+					Texel[2] = 1.0f - U * V;
+					Texel[3] = 0.5f + 0.5f * std::sin(U * 6.0f);
+					break;
+
+				case 1:
+					// noise
+					Texel[0] = NextRandom() / 255.0f;
+					Texel[1] = NextRandom() / 255.0f;
+					Texel[2] = NextRandom() / 255.0f;
+					Texel[3] = NextRandom() / 255.0f;
+					break;
+
+				case 2:
+					// hard edges
+					Texel[0] = ((X / 8 + Y / 8) & 1) ? 0.9f : 0.1f;
+					Texel[1] = ((X / 3) & 1) ? 0.75f : 0.25f;
+					Texel[2] = (X > Y) ? 1.0f : 0.0f;
+					Texel[3] = ((Y / 16) & 1) ? 1.0f : 0.0f;
+					break;
+
+				default:
+					// low frequency pattern with a bit of noise, close to a typical albedo
+					Texel[0] = 0.5f + 0.3f * std::sin(U * 20.0f) * std::cos(V * 13.0f) + NextRandom() / 2550.0f;
+					Texel[1] = 0.4f + 0.2f * std::sin((U + V) * 9.0f) + NextRandom() / 2550.0f;
+					Texel[2] = 0.3f + 0.2f * std::cos(V * 17.0f);
+					Texel[3] = 1.0f;
+					break;
+				}
+
+				const size_t TexelIdx = static_cast<size_t>(Y) * Size + X;
+				for (int32_t Ch = 0; Ch < 4; Ch++)
+				{
+					if (bIsHDR)
+					{
+						// spread the values to a HDR range
+						const float Value = (Ch < 3) ? std::exp2(Texel[Ch] * 12.0f - 6.0f) : 1.0f;
+						const DirectX::PackedVector::HALF Half = DirectX::PackedVector::XMConvertFloatToHalf(Value);
+						memcpy(&Image[TexelIdx * 8 + Ch * 2], &Half, sizeof(Half));
+					}
+					else
+					{
+						Image[TexelIdx * 4 + Ch] = static_cast<uint8_t>(std::clamp(Texel[Ch], 0.0f, 1.0f) * 255.0f + 0.5f);
+					}
+				}
+			}
+		}
+		TestSet.push_back(std::move(Image));
+	}
+
+	return TestSet;
+}
+
+// compresses the fixed test set with both CPU and GPU encoders, reports the throughput and PSNR of each format
+// the decoded images are checked against the minimum PSNR of the format
+void BenchmarkTextureCompression(UHGraphic* InGfx)
+{
+	using namespace UHTextureCompressor;
+	typedef std::vector<uint64_t>(*CompressFunction)(const uint32_t, const uint32_t, const std::vector<uint8_t>&, UHGraphic*);
+	typedef std::vector<uint8_t>(*DecompressFunction)(const uint32_t, const uint32_t, const std::vector<uint64_t>&);
+
+	struct UHCompressionBenchmark
+	{
+		std::wstring Name;
+		CompressFunction Compress;
+		DecompressFunction Decompress;
+		int32_t NumChannels;
+		bool bIsHDR;
+		bool bHasGPUEncoder;
+		double MinPSNR;
+	};
+
+	// the minimum PSNR is averaged over the test set, the noise image alone is far below it
+	const std::vector<UHCompressionBenchmark> Benchmarks =
+	{
+		{ L"BC1", CompressBC1, DecompressBC1, 3, false, true, 25.0 },
+		{ L"BC3", CompressBC3, DecompressBC3, 4, false, true, 25.0 },
+		{ L"BC4", CompressBC4, DecompressBC4, 1, false, true, 30.0 },
+		{ L"BC5", CompressBC5, DecompressBC5, 2, false, true, 28.0 },
+		{ L"BC6H", CompressBC6H, [](const uint32_t W, const uint32_t H, const std::vector<uint64_t>& In) { return DecompressBC6H(W, H, In); }, 3, true, true, 25.0 },
+		{ L"BC7", CompressBC7, [](const uint32_t W, const uint32_t H, const std::vector<uint64_t>& In) { return DecompressBC7(W, H, In); }, 4, false, false, 28.0 },
+	};
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+
+	const uint32_t Size = 1024;
+	const std::vector<std::vector<uint8_t>> TestSetLDR = CreateCompressionTestSet(Size, false);
+	const std::vector<std::vector<uint8_t>> TestSetHDR = CreateCompressionTestSet(Size, true);
+	const double MegaPixels = static_cast<double>(Size) * Size * TestSetLDR.size() / 1000000.0;
+
+	std::wstring Summary = L"Texture compression benchmark, " + std::to_wstring(TestSetLDR.size()) + L" images of " + std::to_wstring(Size) + L"x"
+		+ std::to_wstring(Size) + L", " + std::to_wstring(std::thread::hardware_concurrency()) + L" threads, SIMD level "
+		+ std::to_wstring(UH_ENUM_VALUE(GetCompressorSIMDLevel())) + L"\n";
+
+	for (const UHCompressionBenchmark& Benchmark : Benchmarks)
+	{
+		const std::vector<std::vector<uint8_t>>& TestSet = Benchmark.bIsHDR ? TestSetHDR : TestSetLDR;
+		double Seconds[2] = { 0.0, 0.0 };
+		double PSNR[2] = { 0.0, 0.0 };
+
+		// index 0 for CPU and 1 for GPU
+		const int32_t NumEncoders = (Benchmark.bHasGPUEncoder && InGfx) ? 2 : 1;
+		for (int32_t EncoderIdx = 0; EncoderIdx < NumEncoders; EncoderIdx++)
+		{
+			for (const std::vector<uint8_t>& Image : TestSet)
+			{
+				const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+				const std::vector<uint64_t> Compressed = Benchmark.Compress(Size, Size, Image, (EncoderIdx == 0) ? nullptr : InGfx);
+				Seconds[EncoderIdx] += std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+				const std::vector<uint8_t> Decoded = Benchmark.Decompress(Size, Size, Compressed);
+				UH_TOOL_CHECK(Decoded.size() == Image.size());
+				PSNR[EncoderIdx] += (Benchmark.bIsHDR ? CalculatePSNRHDR(Image, Decoded) : CalculatePSNR(Image, Decoded, Benchmark.NumChannels)) / TestSet.size();
+			}
+
+			UH_TOOL_CHECK(PSNR[EncoderIdx] >= Benchmark.MinPSNR);
+		}
+
+		Summary += Benchmark.Name + L": CPU " + std::to_wstring(MegaPixels / (std::max)(Seconds[0], 1e-6)) + L" MPixels/s, PSNR "
+			+ std::to_wstring(PSNR[0]) + L" dB";
+		if (Seconds[1] > 0.0)
+		{
+			Summary += L" | GPU " + std::to_wstring(MegaPixels / Seconds[1]) + L" MPixels/s, PSNR " + std::to_wstring(PSNR[1]) + L" dB";
+		}
+		Summary += L"\n";
+	}
+
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+// imports all images under the source folder to texture assets without a graphic device, and reports the time of each stage
+void ImportTextures(const std::filesystem::path& SourceFolder, const std::filesystem::path& OutputFolder, const bool bForce)
+{
+	const uint64_t MemoryBudget = 2048ull * 1024 * 1024;
+	UHTextureBatchImporter Importer(MemoryBudget, static_cast<int32_t>(std::thread::hardware_concurrency()));
+	const UHTextureBatchImportStats Stats = Importer.ImportFolder(SourceFolder, OutputFolder, bForce);
+
+	for (const UHTextureImportRecord& Record : Stats.ImportedTextures)
+	{
+		wprintf(L"%ls: %ux%u, decode %.1f ms, mips %.1f ms, compress %.1f ms, export %.1f ms\n", Record.SourcePath.wstring().c_str()
+			, Record.Width, Record.Height, Record.DecodeSeconds * 1000.0, Record.MipSeconds * 1000.0, Record.CompressSeconds * 1000.0
+			, Record.ExportSeconds * 1000.0);
+	}
+
+	for (const std::filesystem::path& FailedSource : Stats.FailedSources)
+	{
+		wprintf(L"%ls: failed to import\n", FailedSource.wstring().c_str());
+	}
+
+	const std::wstring Summary = L"Imported " + std::to_wstring(Stats.NumImported) + L" textures, skipped " + std::to_wstring(Stats.NumSkipped)
+		+ L" unchanged, " + std::to_wstring(Stats.NumFailed) + L" failed, in " + std::to_wstring(Stats.WallSeconds) + L" s\n"
+		+ L"Stage time (summed over textures): hash " + std::to_wstring(Stats.HashSeconds) + L" s, decode " + std::to_wstring(Stats.DecodeSeconds)
+		+ L" s, mips " + std::to_wstring(Stats.MipSeconds) + L" s, compress " + std::to_wstring(Stats.CompressSeconds)
+		+ L" s, export " + std::to_wstring(Stats.ExportSeconds) + L" s\n"
+		+ L"Peak reserved memory: " + std::to_wstring(Stats.PeakReservedBytes / (1024 * 1024)) + L" MB of "
+		+ std::to_wstring(MemoryBudget / (1024 * 1024)) + L" MB budget\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+// runs the texture residency policy along a simulated camera path without a graphic device or texture files
+// a grid of objects references synthetic BC textures, and loads complete with a fixed IO bandwidth and latency.
+// the camera holds still at the end until the reads settle, then every texture must have its target mips resident
+void SimulateTextureStreaming(const uint32_t NumFrames, const uint64_t BudgetBytes)
+{
+	const uint32_t NumFailuresBefore = GetNumToolCheckFailures();
+	uint32_t Seed = 12345;
+	const auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+
+	// textures from 512 to 4096, BC formats with 16 bytes per 4x4 block
+	UHTextureResidencyPolicy Policy(BudgetBytes);
+	const uint32_t NumTextures = 600;
+	for (uint32_t TexIdx = 0; TexIdx < NumTextures; TexIdx++)
+	{
+		const uint32_t Size = 512u << (NextRandom() % 4);
+		const uint32_t MipCount = static_cast<uint32_t>(std::floor(std::log2(Size))) + 1;
+		std::vector<uint64_t> MipSizes(MipCount);
+		for (uint32_t MipIdx = 0; MipIdx < MipCount; MipIdx++)
+		{
+			const uint64_t Blocks = ((std::max)(Size >> MipIdx, 1u) + 3) / 4;
+			MipSizes[MipIdx] = Blocks * Blocks * 16;
+		}
+
+		const uint32_t TailMip = UHTexture2D::GetMipTailIndex(Size, Size, MipCount);
+		Policy.AddTexture(Size, Size, MipSizes, TailMip, TailMip);
+	}
+
+	// objects on a 50x40 grid with 10m spacing, each uses three textures
+	struct UHSimulatedObject
+	{
+		XMFLOAT3 Position;
+		float Radius;
+		int32_t Textures[3];
+	};
+
+	std::vector<UHSimulatedObject> Objects;
+	for (int32_t Z = 0; Z < 40; Z++)
+	{
+		for (int32_t X = 0; X < 50; X++)
+		{
+			UHSimulatedObject Object;
+			Object.Position = XMFLOAT3(X * 10.0f, 0.0f, Z * 10.0f);
+			Object.Radius = 1.0f + (NextRandom() % 300) / 100.0f;
+			for (int32_t& TexIdx : Object.Textures)
+			{
+				TexIdx = static_cast<int32_t>(NextRandom() % NumTextures);
+			}
+			Objects.push_back(Object);
+		}
+	}
+
+	// 90 degree FOV at 1080p, 200 MB/s with 3 frames of latency at 60 fps
+	const float ProjectionScale = 1.0f / std::tan(XM_PIDIV4) * 1080.0f * 0.5f;
+	const float CosHalfFov = std::cos(XM_PIDIV4 * 1.4f);
+	const float MaxDistance = 200.0f;
+	const uint64_t BytesPerFrame = 200ull * 1048576 / 60;
+	const uint64_t LatencyFrames = 3;
+
+	struct UHSimulatedRead
+	{
+		UHTextureStreamingChange Change;
+		uint64_t Bytes;
+		uint64_t StartFrame;
+	};
+	std::deque<UHSimulatedRead> Reads;
+	std::vector<UHTextureStreamingChange> Changes;
+
+	uint64_t PeakResident = 0;
+	uint64_t LoadedBytes = 0;
+	uint64_t EvictedBytes = 0;
+	uint32_t OverBudgetFrames = 0;
+	uint64_t SumBudgetLimited = 0;
+	double SumRequested = 0.0;
+	double UpdateSeconds = 0.0;
+	std::wstring Summary = L"Texture streaming simulation, " + std::to_wstring(NumTextures) + L" textures, " + std::to_wstring(Objects.size())
+		+ L" objects, budget " + std::to_wstring(BudgetBytes / 1048576) + L" MB\n";
+
+	const auto GetRangeSize = [&Policy](int32_t InTexIdx, uint32_t InFirstMip)
+	{
+		const UHStreamingTextureState& Texture = Policy.GetTexture(InTexIdx);
+		uint64_t Size = 0;
+		for (size_t MipIdx = InFirstMip; MipIdx < Texture.MipSizes.size(); MipIdx++)
+		{
+			Size += Texture.MipSizes[MipIdx];
+		}
+		return Size;
+	};
+
+	// the settling frames cover the request and eviction delays
+	const uint64_t MinSettleFrames = UHTextureResidencyPolicy::KeepRequestFrames + UHTextureResidencyPolicy::EvictDelayFrames;
+	const uint64_t MaxSettleFrames = MinSettleFrames + 3000;
+	uint64_t NumSettleFrames = 0;
+
+	for (uint64_t Frame = 0; Frame < NumFrames + MaxSettleFrames; Frame++)
+	{
+		// the camera flies a loop over the grid at a varying height
+		const float T = static_cast<float>((std::min)(Frame, static_cast<uint64_t>(NumFrames))) / NumFrames * XM_2PI;
+		const XMVECTOR CameraPos = XMVectorSet(245.0f + 200.0f * std::cos(T), 3.0f + 20.0f * (1.0f + std::sin(T * 3.0f)), 195.0f + 150.0f * std::sin(T), 0.0f);
+		const XMVECTOR CameraDir = XMVector3Normalize(XMVectorSet(-std::sin(T), -0.15f, std::cos(T), 0.0f));
+
+		const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+		for (const UHSimulatedObject& Object : Objects)
+		{
+			const XMVECTOR ToObject = XMLoadFloat3(&Object.Position) - CameraPos;
+			const float Distance = XMVectorGetX(XMVector3Length(ToObject));
+			if (Distance > MaxDistance + Object.Radius
+				|| (Distance > Object.Radius && XMVectorGetX(XMVector3Dot(ToObject, CameraDir)) < CosHalfFov * Distance - Object.Radius))
+			{
+				continue;
+			}
+
+			const float ScreenSize = UHTextureResidencyPolicy::GetProjectedSize(Object.Radius * 2.0f, (std::max)(Distance - Object.Radius, 0.1f), ProjectionScale);
+			for (const int32_t TexIdx : Object.Textures)
+			{
+				Policy.RequestTexture(TexIdx, ScreenSize);
+			}
+		}
+
+		Policy.Update(Frame);
+
+		// complete reads in order within the bandwidth of a frame
+		uint64_t FrameBytes = 0;
+		while (!Reads.empty() && Frame - Reads.front().StartFrame >= LatencyFrames && FrameBytes < BytesPerFrame)
+		{
+			const UHSimulatedRead& Read = Reads.front();
+			const uint64_t OldSize = GetRangeSize(Read.Change.TextureIndex, Policy.GetTexture(Read.Change.TextureIndex).ResidentMip);
+			const uint64_t NewSize = GetRangeSize(Read.Change.TextureIndex, Read.Change.NewResidentMip);
+			if (NewSize > OldSize)
+			{
+				LoadedBytes += NewSize - OldSize;
+			}
+			else
+			{
+				EvictedBytes += OldSize - NewSize;
+			}
+
+			FrameBytes += Read.Bytes;
+			Policy.FinishChange(Read.Change.TextureIndex, Read.Change.NewResidentMip, true);
+			Reads.pop_front();
+		}
+
+		Policy.CollectChanges(UHTextureStreamer::MaxInFlightReads - static_cast<uint32_t>(Reads.size()), Changes);
+		UpdateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+
+		for (const UHTextureStreamingChange& Change : Changes)
+		{
+			Reads.push_back({ Change, GetRangeSize(Change.TextureIndex, Change.NewResidentMip), Frame });
+		}
+
+		const UHTextureStreamingReport& Report = Policy.GetReport();
+		PeakResident = (std::max)(PeakResident, Report.ResidentBytes);
+		OverBudgetFrames += (Report.ResidentBytes > Report.BudgetBytes) ? 1 : 0;
+		if (Frame >= NumFrames)
+		{
+			NumSettleFrames++;
+			if (NumSettleFrames >= MinSettleFrames && Reads.empty() && Changes.empty())
+			{
+				break;
+			}
+			continue;
+		}
+
+		SumBudgetLimited += Report.NumBudgetLimitedTextures;
+		SumRequested += static_cast<double>(Report.RequestedBytes);
+
+		if (Frame % 300 == 0)
+		{
+			Summary += L"Frame " + std::to_wstring(Frame) + L": requested " + std::to_wstring(Report.RequestedBytes / 1048576) + L" MB, target "
+				+ std::to_wstring(Report.TargetBytes / 1048576) + L" MB, resident " + std::to_wstring(Report.ResidentBytes / 1048576) + L" MB (tails "
+				+ std::to_wstring(Report.TailBytes / 1048576) + L" MB), " + std::to_wstring(Report.NumRequestedTextures) + L" textures requested, "
+				+ std::to_wstring(Report.NumBudgetLimitedTextures) + L" budget limited, " + std::to_wstring(Report.NumPendingChanges) + L" pending\n";
+		}
+	}
+
+	Summary += L"Average requested " + std::to_wstring(static_cast<uint64_t>(SumRequested / NumFrames) / 1048576) + L" MB, peak resident "
+		+ std::to_wstring(PeakResident / 1048576) + L" MB, " + std::to_wstring(OverBudgetFrames) + L" frames over budget, "
+		+ std::to_wstring(static_cast<double>(SumBudgetLimited) / NumFrames) + L" budget limited textures per frame\n"
+		+ L"Loaded " + std::to_wstring(LoadedBytes / 1048576) + L" MB, evicted " + std::to_wstring(EvictedBytes / 1048576) + L" MB, policy "
+		+ std::to_wstring(UpdateSeconds * 1000000.0 / NumFrames) + L" us per frame\n";
+
+	// after settling, nothing is in flight and each texture has its target mips, which are the requested ones unless the budget limits them
+	uint32_t NumNotResident = 0;
+	uint32_t NumBudgetLimited = 0;
+	for (int32_t TexIdx = 0; TexIdx < Policy.GetTextureCount(); TexIdx++)
+	{
+		const UHStreamingTextureState& Texture = Policy.GetTexture(TexIdx);
+		NumNotResident += (Texture.bIsChanging || Texture.ResidentMip != Texture.TargetMip) ? 1 : 0;
+		NumBudgetLimited += (Texture.TargetMip > Texture.RequestedMip) ? 1 : 0;
+	}
+	Summary += L"Settled in " + std::to_wstring(NumSettleFrames) + L" frames, " + std::to_wstring(NumNotResident) + L" textures without their target mips, "
+		+ std::to_wstring(NumBudgetLimited) + L" budget limited\n";
+
+	UH_TOOL_CHECK(OverBudgetFrames == 0);
+	UH_TOOL_CHECK(NumSettleFrames < MaxSettleFrames);
+	UH_TOOL_CHECK(NumNotResident == 0);
+	Summary += (GetNumToolCheckFailures() == NumFailuresBefore) ? L"Validation passed\n" : L"Validation FAILED\n";
+	UHE_LOG(Summary);
+	wprintf(L"%ls", Summary.c_str());
+}
+
+#endif
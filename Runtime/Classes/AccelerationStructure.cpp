@@ -9,7 +9,9 @@ UHAccelerationStructure::UHAccelerationStructure()
     : AccelerationStructureBuffer(nullptr)
 	, ScratchBuffer(nullptr)
 	, ASInstanceBuffer(nullptr)
+	, TransformBuffer(nullptr)
     , AccelerationStructure(nullptr)
+	, ASDeviceAddress(0)
 	, GeometryKHRCache(VkAccelerationStructureGeometryKHR())
 	, GeometryInfoCache(VkAccelerationStructureBuildGeometryInfoKHR())
 	, RangeInfoCache(VkAccelerationStructureBuildRangeInfoKHR())
@@ -55,10 +57,33 @@ void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InB
 	GeometryKHR.geometry.triangles = VkAccelerationStructureGeometryTrianglesDataKHR{};
 	GeometryKHR.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
 
-	// set format for Vertex position, which is float3
-	// with proper stride, system should fetch vertex pos properly
-	GeometryKHR.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-	GeometryKHR.geometry.triangles.vertexStride = InMesh->GetPositionBuffer()->GetBufferStride();
+	// set format for Vertex position, which is float3 in full format
+	// compressed positions are 4x16-bit snorm relative to the mesh bound, a transform scales them back to the mesh space
+	if (InMesh->GetVertexFormat() == UHVertexFormat::Compressed)
+	{
+		const BoundingBox MeshBound = InMesh->GetMeshBound();
+		VkTransformMatrixKHR BoundTransform{};
+		BoundTransform.matrix[0][0] = MeshBound.Extents.x;
+		BoundTransform.matrix[1][1] = MeshBound.Extents.y;
+		BoundTransform.matrix[2][2] = MeshBound.Extents.z;
+		BoundTransform.matrix[0][3] = MeshBound.Center.x;
+		BoundTransform.matrix[1][3] = MeshBound.Center.y;
+		BoundTransform.matrix[2][3] = MeshBound.Center.z;
+
+		TransformBuffer = GfxCache->RequestRenderBuffer<VkTransformMatrixKHR>(1
+			, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+			, InMesh->GetName() + "_BottomLevelAS_TransformBuffer");
+		TransformBuffer->UploadAllData(&BoundTransform);
+
+		GeometryKHR.geometry.triangles.vertexFormat = VK_FORMAT_R16G16B16A16_SNORM;
+		GeometryKHR.geometry.triangles.vertexStride = sizeof(uint32_t) * 2;
+		GeometryKHR.geometry.triangles.transformData.deviceAddress = GetDeviceAddress(TransformBuffer->GetBuffer());
+	}
+	else
+	{
+		GeometryKHR.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+		GeometryKHR.geometry.triangles.vertexStride = sizeof(XMFLOAT3);
+	}
 	GeometryKHR.geometry.triangles.vertexData.deviceAddress = GetDeviceAddress(InMesh->GetPositionBuffer()->GetBuffer());
 	GeometryKHR.geometry.triangles.maxVertex = InMesh->GetHighestIndex();
 
@@ -120,6 +145,9 @@ void UHAccelerationStructure::CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InB
 	GeometryInfo.dstAccelerationStructure = AccelerationStructure;
 
 	GVkCmdBuildAccelerationStructuresKHR(InBuffer, 1, &GeometryInfo, RangeInfos);
+
+	// cache the address for top level instances
+	ASDeviceAddress = GetDeviceAddress(AccelerationStructure);
 }
 
 // this should be called by renderer
@@ -132,67 +160,30 @@ uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererCo
 		return 0;
 	}
 
-	InstanceKHRs.resize(InRenderers.size());
-	RendererCache.resize(InRenderers.size());
+	const uint32_t RendererCount = static_cast<uint32_t>(InRenderers.size());
+	if (RendererCount == 0)
+	{
+		return 0;
+	}
 
-	// add top-level instance per-renderer
-	uint32_t InstanceCount = 0;
+	// add top-level instance per-renderer, all instances are needed at the beginning
+	// visibility and culling distance will be applied by the following UploadInstances()
+	InstanceTracker.Reset(RendererCount);
 	for (size_t Idx = 0; Idx < InRenderers.size(); Idx++)
 	{
 		// refresh transform once
 		InRenderers[Idx]->Update();
-		UHMaterial* Mat = InRenderers[Idx]->GetMaterial();
-
-		// hit every thing for now
-		VkAccelerationStructureInstanceKHR InstanceKHR{};
-		InstanceKHR.mask = 0xff;
-
-		// set bottom level address
-		VkAccelerationStructureKHR BottomLevelAS = InRenderers[Idx]->GetMesh()->GetBottomLevelAS()->GetAS();
-		InstanceKHR.accelerationStructureReference = GetDeviceAddress(BottomLevelAS);
-
-		// copy transform3x4
-		XMFLOAT3X4 Transform3x4 = MathHelpers::MatrixTo3x4(InRenderers[Idx]->GetWorldMatrix());
-		std::copy(&Transform3x4.m[0][0], &Transform3x4.m[0][0] + 12, &InstanceKHR.transform.matrix[0][0]);
-
-		// cull mode flag, in DXR system, it's default cull back, here just to check the other two modes
-		if (Mat->GetCullMode() == UHCullMode::CullNone)
-		{
-			InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-		}
-		else if (Mat->GetCullMode() == UHCullMode::CullFront)
-		{
-			InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
-		}
-
-		// non-opaque flag, cutoff is treated as translucent as well so I can ignore the hit on culled pixel
-		if (Mat->GetBlendMode() > UHBlendMode::Opaque)
-		{
-			InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
-		}
-
-		// set material buffer data index as SBT index, each material has an unique hitgroup shader
-		InstanceKHR.instanceShaderBindingTableRecordOffset = Mat->GetBufferDataIndex();
-		InstanceKHR.instanceCustomIndex = Mat->GetBufferDataIndex();
-
-		// cache the instance KHRs and renderers for later use
-		const int32_t RendererIdx = InRenderers[Idx]->GetBufferDataIndex();
-		InstanceKHRs[RendererIdx] = InstanceKHR;
-		RendererCache[RendererIdx] = InRenderers[Idx];
-		InstanceCount++;
+		UpdateInstance(InRenderers[Idx]);
+		InstanceTracker.SetState(InRenderers[Idx]->GetBufferDataIndex(), UHTopLevelInstanceState::Needed);
 	}
+	InstanceTracker.Commit();
+	const uint32_t InstanceCount = InstanceTracker.GetInstanceCount();
 
-	// don't create if there is no instance
-	if (InstanceCount == 0)
-	{
-		return 0;
-	}
-	
-	// create instance KHR buffer for later use
-	ASInstanceBuffer = GfxCache->RequestRenderBuffer<VkAccelerationStructureInstanceKHR>(InstanceCount
+	// create instance KHR buffer for later use, it's sized for all renderers as instances can be added back later
+	ASInstanceBuffer = GfxCache->RequestRenderBuffer<VkAccelerationStructureInstanceKHR>(RendererCount
 		, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
 		, "Scene_TopLevelAS_InstanceBuffer");
-	ASInstanceBuffer->UploadAllData(InstanceKHRs.data());
+	ASInstanceBuffer->UploadAllData(InstanceTracker.GetInstances().data(), InstanceCount * sizeof(VkAccelerationStructureInstanceKHR));
 
 	// setup instance type
 	VkAccelerationStructureGeometryKHR GeometryKHR{};
@@ -211,12 +202,12 @@ uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererCo
 	GeometryInfo.geometryCount = 1;
 	GeometryInfo.pGeometries = &GeometryKHR;
 
-	// fetch the size info before creating AS based on geometry info
+	// fetch the size info before creating AS based on geometry info, the size is for the max instance count
 	VkAccelerationStructureBuildSizesInfoKHR SizeInfo{};
 	SizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-	GVkGetAccelerationStructureBuildSizesKHR(LogicalDevice, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &GeometryInfo, &InstanceCount, &SizeInfo);
+	GVkGetAccelerationStructureBuildSizesKHR(LogicalDevice, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &GeometryInfo, &RendererCount, &SizeInfo);
 
-	// build bottom-level AS after getting proper sizes
+	// build top-level AS after getting proper sizes
 	AccelerationStructureBuffer = GfxCache->RequestRenderBuffer<BYTE>(SizeInfo.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR
 		, "Scene_TopLevelAS_Buffer");
 
@@ -236,8 +227,9 @@ uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererCo
 	GfxCache->SetDebugUtilsObjectName(VK_OBJECT_TYPE_ACCELERATION_STRUCTURE_KHR, (uint64_t)AccelerationStructure, ObjName);
 #endif
 
-	// allocate scratch buffer as well, this buffer is for initialization
-	ScratchBuffer = GfxCache->RequestRenderBuffer<BYTE>(SizeInfo.buildScratchSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+	// allocate scratch buffer as well, it's kept for both rebuilding and refitting
+	ScratchBuffer = GfxCache->RequestRenderBuffer<BYTE>((std::max)(SizeInfo.buildScratchSize, SizeInfo.updateScratchSize)
+		, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
 		, "TopLevelAS_ScratchBuffer");
 	GeometryInfo.scratchData.deviceAddress = GetDeviceAddress(ScratchBuffer->GetBuffer());
 
@@ -252,76 +244,111 @@ uint32_t UHAccelerationStructure::CreateTopAS(const std::vector<UHMeshRendererCo
 	GeometryKHRCache = GeometryKHR;
 	GeometryInfoCache = GeometryInfo;
 	RangeInfoCache = RangeInfo;
-
-	// set geometry info as mode update for later use
-	GeometryInfoCache.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
-	GeometryInfoCache.srcAccelerationStructure = GeometryInfoCache.dstAccelerationStructure;
 	GeometryInfoCache.pGeometries = &GeometryKHRCache;
 
-	return InstanceCount;
+	return RendererCount;
 }
 
-// update top AS
-void UHAccelerationStructure::UpdateTopAS(VkCommandBuffer InBuffer, const int32_t CurrentFrameRT, const float RTCullingDistance)
+void UHAccelerationStructure::UpdateInstance(const UHMeshRendererComponent* InRenderer)
 {
-	for (size_t Idx = 0; Idx < InstanceKHRs.size(); Idx++)
+	const int32_t RendererIdx = InRenderer->GetBufferDataIndex();
+	const UHMaterial* Mat = InRenderer->GetMaterial();
+	if (RendererIdx < 0 || RendererIdx >= static_cast<int32_t>(InstanceTracker.GetRendererCount()) || InRenderer->GetMesh() == nullptr || Mat == nullptr)
 	{
-		UHMeshRendererComponent* Renderer = RendererCache[Idx];
+		return;
+	}
 
-		// copy transform3x4 when it's dirty
-		if (Renderer->IsTransformChanged())
-		{
-			XMFLOAT3X4 Transform3x4 = MathHelpers::MatrixTo3x4(Renderer->GetWorldMatrix());
-			std::copy(&Transform3x4.m[0][0], &Transform3x4.m[0][0] + 12, &InstanceKHRs[Idx].transform.matrix[0][0]);
+	// hit every thing for now, the tracker masks out culled instances until they're removed by a rebuild
+	VkAccelerationStructureInstanceKHR InstanceKHR{};
+	InstanceKHR.mask = 0xff;
 
-			// refresh bottom level address
-			VkAccelerationStructureKHR BottomLevelAS = Renderer->GetMesh()->GetBottomLevelAS()->GetAS();
-			InstanceKHRs[Idx].accelerationStructureReference = GetDeviceAddress(BottomLevelAS);
-		}
+	// set bottom level address
+	InstanceKHR.accelerationStructureReference = InRenderer->GetMesh()->GetBottomLevelAS()->GetASDeviceAddress();
+
+	// copy transform3x4
+	XMFLOAT3X4 Transform3x4 = MathHelpers::MatrixTo3x4(InRenderer->GetWorldMatrix());
+	std::copy(&Transform3x4.m[0][0], &Transform3x4.m[0][0] + 12, &InstanceKHR.transform.matrix[0][0]);
+
+	// cull mode flag, in DXR system, it's default cull back, here just to check the other two modes
+	if (Mat->GetCullMode() == UHCullMode::CullNone)
+	{
+		InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+	}
+	else if (Mat->GetCullMode() == UHCullMode::CullFront)
+	{
+		InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
+	}
 
-		// check visibility, can't use IsVisible() as it's set by frustum culling
-		bool bIsVisible = Renderer->IsEnabled()
+	// non-opaque flag, cutoff is treated as translucent as well so I can ignore the hit on culled pixel
+	if (Mat->GetBlendMode() > UHBlendMode::Opaque)
+	{
+		InstanceKHR.flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
+	}
+
+	// set material buffer data index as SBT index, each material has an unique hitgroup shader
+	// instances are compacted, so the renderer index is stored as InstanceID() for looking up renderer data in hit shaders
+	InstanceKHR.instanceShaderBindingTableRecordOffset = Mat->GetBufferDataIndex();
+	InstanceKHR.instanceCustomIndex = RendererIdx;
+
+	InstanceTracker.SetInstance(RendererIdx, InstanceKHR, InRenderer->GetRendererBound());
+}
+
+void UHAccelerationStructure::UpdateInstanceActive(const UHMeshRendererComponent* InRenderer, const float RTCullingDistance)
+{
+	// check visibility, can't use IsVisible() as it's set by frustum culling
+	const bool bIsVisible = InRenderer->IsEnabled()
 #if WITH_EDITOR
-			&& Renderer->IsVisibleInEditor()
+		&& InRenderer->IsVisibleInEditor()
 #endif
-			;
+		;
 
-		if (bIsVisible)
-		{
-			// only check culling distance when the component is visible
-			bIsVisible &= (Renderer->GetSquareDistanceToMainCam() < RTCullingDistance * RTCullingDistance);
-		}
-		InstanceKHRs[Idx].mask = bIsVisible ? 0xff : 0;
-
-		// check material state
-		UHMaterial* Mat = RendererCache[Idx]->GetMaterial();
-		InstanceKHRs[Idx].flags = 0;
+	// renderers slightly beyond the culling distance are kept or added along with rebuilds, so a moving camera won't rebuild every frame
+	const int32_t RendererIdx = InRenderer->GetBufferDataIndex();
+	if (RendererIdx >= 0 && RendererIdx < static_cast<int32_t>(InstanceTracker.GetRendererCount()))
+	{
+		InstanceTracker.SetState(RendererIdx
+			, UHTopLevelInstanceTracker::GetRangeState(bIsVisible, InRenderer->GetSquareDistanceToMainCam(), RTCullingDistance));
+	}
+}
 
-		// cull mode flag, in DXR system, it's default cull back, here just to check the other two modes
-		if (Mat->GetCullMode() == UHCullMode::CullNone)
-		{
-			InstanceKHRs[Idx].flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-		}
-		else if (Mat->GetCullMode() == UHCullMode::CullFront)
-		{
-			InstanceKHRs[Idx].flags |= VK_GEOMETRY_INSTANCE_TRIANGLE_FLIP_FACING_BIT_KHR;
-		}
+void UHAccelerationStructure::UploadInstances()
+{
+	if (ASInstanceBuffer == nullptr)
+	{
+		return;
+	}
 
-		// non-opaque flag, cutoff is treated as translucent as well so I can ignore the hit on culled pixel
-		if (Mat->GetBlendMode() > UHBlendMode::Opaque)
-		{
-			InstanceKHRs[Idx].flags |= VK_GEOMETRY_INSTANCE_FORCE_NO_OPAQUE_BIT_KHR;
-		}
+	// only upload the ranges that are changed
+	InstanceTracker.Commit();
+	const std::vector<VkAccelerationStructureInstanceKHR>& Instances = InstanceTracker.GetInstances();
+	for (const UHTopLevelInstanceRange& Range : InstanceTracker.GetDirtyRanges())
+	{
+		ASInstanceBuffer->UploadData(&Instances[Range.FirstSlot], Range.FirstSlot, Range.Count * sizeof(VkAccelerationStructureInstanceKHR));
+	}
+}
 
-		// set material buffer data index as SBT index, each material has an unique hitgroup shader
-		InstanceKHRs[Idx].instanceShaderBindingTableRecordOffset = Mat->GetBufferDataIndex();
-		InstanceKHRs[Idx].instanceCustomIndex = Mat->GetBufferDataIndex();
+// update top AS
+void UHAccelerationStructure::UpdateTopAS(VkCommandBuffer InBuffer)
+{
+	const UHTopLevelInstanceStats& Stats = InstanceTracker.GetStats();
+	if (AccelerationStructure == nullptr || Stats.BuildMode == UHTopLevelBuildMode::None)
+	{
+		return;
 	}
 
-	// upload all data in one call
-	ASInstanceBuffer->UploadAllData(InstanceKHRs.data());
+	// refit needs the same instance count as the last build, the tracker always rebuilds when the count is changed
+	if (Stats.BuildMode == UHTopLevelBuildMode::Rebuild)
+	{
+		GeometryInfoCache.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+		GeometryInfoCache.srcAccelerationStructure = nullptr;
+	}
+	else
+	{
+		GeometryInfoCache.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+		GeometryInfoCache.srcAccelerationStructure = AccelerationStructure;
+	}
+	RangeInfoCache.primitiveCount = Stats.NumInstances;
 
-	// update it 
 	const VkAccelerationStructureBuildRangeInfoKHR* RangeInfos[1] = { &RangeInfoCache };
 	GVkCmdBuildAccelerationStructuresKHR(InBuffer, 1, &GeometryInfoCache, RangeInfos);
 }
@@ -332,6 +359,7 @@ void UHAccelerationStructure::Release()
     {
 		UH_SAFE_RELEASE(ScratchBuffer);
 		UH_SAFE_RELEASE(ASInstanceBuffer);
+		UH_SAFE_RELEASE(TransformBuffer);
 		UH_SAFE_RELEASE(AccelerationStructureBuffer);
 
 		if (AccelerationStructure)
@@ -348,12 +376,23 @@ void UHAccelerationStructure::ReleaseScratch()
 	if (GfxCache->IsRayTracingEnabled())
 	{
 		UH_SAFE_RELEASE(ScratchBuffer);
-		// release temp AS instance buffer as well
+		// release temp AS instance and transform buffers as well
 		UH_SAFE_RELEASE(ASInstanceBuffer);
+		UH_SAFE_RELEASE(TransformBuffer);
 	}
 }
 
 VkAccelerationStructureKHR UHAccelerationStructure::GetAS() const
 {
 	return AccelerationStructure;
+}
+
+VkDeviceAddress UHAccelerationStructure::GetASDeviceAddress() const
+{
+	return ASDeviceAddress;
+}
+
+const UHTopLevelInstanceStats& UHAccelerationStructure::GetInstanceStats() const
+{
+	return InstanceTracker.GetStats();
 }
\ No newline at end of file
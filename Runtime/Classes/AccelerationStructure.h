@@ -4,6 +4,7 @@
 #include "../Classes/Types.h"
 #include "../../UnheardEngine.h"
 #include "RenderBuffer.h"
+#include "TopLevelInstanceTracker.h"
 
 class UHMesh;
 class UHMeshRendererComponent;
@@ -17,14 +18,27 @@ public:
 	// either call bottomAS or TopAS, only one instance is stored
 	void CreaetBottomAS(UHMesh* InMesh, VkCommandBuffer InBuffer);
 
-	// Create top level AS, return number of instance built
+	// Create top level AS, return the number of renderers it can hold, instances are indexed by InstanceID() as renderer index
 	uint32_t CreateTopAS(const std::vector<UHMeshRendererComponent*>& InRenderers, VkCommandBuffer InBuffer);
-	void UpdateTopAS(VkCommandBuffer InBuffer, const int32_t CurrentFrameRT, const float RTCullingDistance);
+
+	// refresh the instance of a renderer, call this when its transform or material is changed
+	void UpdateInstance(const UHMeshRendererComponent* InRenderer);
+
+	// update the range state of a renderer based on its visibility and the ray tracing culling distance
+	void UpdateInstanceActive(const UHMeshRendererComponent* InRenderer, const float RTCullingDistance);
+
+	// upload dirty instance ranges and decide how to build, this should be called once per frame after instances are updated
+	void UploadInstances();
+
+	// refit or rebuild top level AS based on the decision of UploadInstances(), nothing is recorded if no instance is changed
+	void UpdateTopAS(VkCommandBuffer InBuffer);
 
 	void Release();
 	void ReleaseScratch();
 
 	VkAccelerationStructureKHR GetAS() const;
+	VkDeviceAddress GetASDeviceAddress() const;
+	const UHTopLevelInstanceStats& GetInstanceStats() const;
 
 private:
 	VkDeviceAddress GetDeviceAddress(VkBuffer InBuffer);
@@ -32,12 +46,13 @@ private:
 
 	UniquePtr<UHRenderBuffer<BYTE>> ScratchBuffer;
 	UniquePtr<UHRenderBuffer<VkAccelerationStructureInstanceKHR>> ASInstanceBuffer;
+	UniquePtr<UHRenderBuffer<VkTransformMatrixKHR>> TransformBuffer;
 	UniquePtr<UHRenderBuffer<BYTE>> AccelerationStructureBuffer;
 	VkAccelerationStructureKHR AccelerationStructure;
+	VkDeviceAddress ASDeviceAddress;
 
-	// instance KHRs and renderer cache, both should the same length
-	std::vector<VkAccelerationStructureInstanceKHR> InstanceKHRs;
-	std::vector<UHMeshRendererComponent*> RendererCache;
+	// compacted instances of top level AS and their dirty ranges
+	UHTopLevelInstanceTracker InstanceTracker;
 
 	// cache the info too
 	VkAccelerationStructureGeometryKHR GeometryKHRCache;
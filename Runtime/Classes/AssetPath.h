@@ -6,11 +6,14 @@
 static std::string GAssetPath = "Assets/";
 static std::string GTempFilePath = "Temp/";
 static std::string GAssetMapName = "AssetMap";
+static std::string GProfileCapturePath = "Temp/Profiles/";
 
 // texture paths
 static std::string GTextureAssetFolder = "Assets/Textures/";
 static std::string GTextureAssetExtension = ".uhtexture";
 static std::string GCubemapAssetExtension = ".uhcubemap";
+static std::string GTextureHashExtension = ".uhtexturehash";
+static std::string GRawTextureAssetPath = "RawAssets/Textures/";
 
 // mesh paths
 static std::string GMeshAssetFolder = "Assets/Meshes/";
@@ -29,6 +32,11 @@ static std::string GShaderAssetFolder = "Assets/Shaders/";
 static std::string GShaderAssetExtension = ".spv";
 static std::string GShaderAssetCacheExtension = ".uhshadercache";
 
+// pipeline cache paths
+static std::string GPipelineCachePath = "AssetCaches/Pipelines/";
+static std::string GPipelineCacheName = "PipelineCache";
+static std::string GPipelineCacheExtension = ".uhpipelinecache";
+
 // material paths
 static std::string GMaterialAssetPath = "Assets/Materials/";
 static std::string GMaterialAssetExtension = ".uhmaterial";
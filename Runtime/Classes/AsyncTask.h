@@ -1,9 +1,9 @@
 #pragma once
-#include "../../UnheardEngine.h"
+#include <cstdint>
 
-// UHE async task class, typically referenced by UHThread
+// UHE async task class, typically referenced by UHThread or scheduled by UHJobSystem
 class UHAsyncTask
 {
 public:
 	virtual void DoTask(const int32_t ThreadIndex) {}
-};
\ No newline at end of file
+};
@@ -0,0 +1,590 @@
+#include "BoundingVolumeHierarchy.h"
+
+namespace
+{
+	float SurfaceArea(const XMFLOAT3& InMin, const XMFLOAT3& InMax)
+	{
+		const float DX = InMax.x - InMin.x;
+		const float DY = InMax.y - InMin.y;
+		const float DZ = InMax.z - InMin.z;
+		return 2.0f * (DX * DY + DY * DZ + DZ * DX);
+	}
+
+	float GetAxis(const XMFLOAT3& InVector, int32_t InAxis)
+	{
+		return (InAxis == 0) ? InVector.x : ((InAxis == 1) ? InVector.y : InVector.z);
+	}
+
+	void GrowBound(XMFLOAT3& InOutMin, XMFLOAT3& InOutMax, const XMFLOAT3& InMin, const XMFLOAT3& InMax)
+	{
+		InOutMin = MathHelpers::MinVector(InOutMin, InMin);
+		InOutMax = MathHelpers::MaxVector(InOutMax, InMax);
+	}
+
+	void GetItemBound(const UHCullingBounds& InBounds, int32_t InItem, XMFLOAT3& OutMin, XMFLOAT3& OutMax)
+	{
+		OutMin = XMFLOAT3(InBounds.CenterX[InItem] - InBounds.ExtentX[InItem], InBounds.CenterY[InItem] - InBounds.ExtentY[InItem]
+			, InBounds.CenterZ[InItem] - InBounds.ExtentZ[InItem]);
+		OutMax = XMFLOAT3(InBounds.CenterX[InItem] + InBounds.ExtentX[InItem], InBounds.CenterY[InItem] + InBounds.ExtentY[InItem]
+			, InBounds.CenterZ[InItem] + InBounds.ExtentZ[InItem]);
+	}
+
+	void SetBit(std::vector<uint32_t>& OutBits, int32_t InItem)
+	{
+		OutBits[InItem / UHCullingBounds::BoxesPerWord] |= (1u << (InItem % UHCullingBounds::BoxesPerWord));
+	}
+
+	// slab test, return the entry distance or a negative value if missed
+	float IntersectRayBox(const XMFLOAT3& InOrigin, const XMFLOAT3& InInvDir, const XMFLOAT3& InMin, const XMFLOAT3& InMax, float InMaxDistance)
+	{
+		float TMin = 0.0f;
+		float TMax = InMaxDistance;
+		for (int32_t Axis = 0; Axis < 3; Axis++)
+		{
+			const float T1 = (GetAxis(InMin, Axis) - GetAxis(InOrigin, Axis)) * GetAxis(InInvDir, Axis);
+			const float T2 = (GetAxis(InMax, Axis) - GetAxis(InOrigin, Axis)) * GetAxis(InInvDir, Axis);
+			TMin = std::max(TMin, std::min(T1, T2));
+			TMax = std::min(TMax, std::max(T1, T2));
+		}
+
+		return (TMin <= TMax) ? TMin : -1.0f;
+	}
+}
+
+UHBVHNode::UHBVHNode()
+	: BoundMin(XMFLOAT3(GWorldMax, GWorldMax, GWorldMax))
+	, LeftChild(UHINDEXNONE)
+	, BoundMax(XMFLOAT3(-GWorldMax, -GWorldMax, -GWorldMax))
+	, FirstItem(0)
+	, ItemCount(0)
+{
+
+}
+
+bool UHBVHNode::IsLeaf() const
+{
+	return LeftChild == UHINDEXNONE;
+}
+
+UHBoundingVolumeHierarchy::UHBoundingVolumeHierarchy()
+{
+
+}
+
+void UHBoundingVolumeHierarchy::Build(const UHCullingBounds& InBounds, const std::vector<int32_t>& InItems)
+{
+	Clear();
+	if (InItems.size() == 0)
+	{
+		return;
+	}
+
+	Items = InItems;
+	Nodes.reserve(Items.size() * 2);
+	Parents.reserve(Items.size() * 2);
+
+	int32_t MaxItem = 0;
+	for (const int32_t Item : Items)
+	{
+		MaxItem = std::max(MaxItem, Item);
+	}
+
+	// cache item bounds and centroids, they're visited many times during the build
+	std::vector<XMFLOAT3> ItemMins(MaxItem + 1);
+	std::vector<XMFLOAT3> ItemMaxs(MaxItem + 1);
+	std::vector<XMFLOAT3> ItemCenters(MaxItem + 1);
+	for (const int32_t Item : Items)
+	{
+		GetItemBound(InBounds, Item, ItemMins[Item], ItemMaxs[Item]);
+		ItemCenters[Item] = XMFLOAT3(InBounds.CenterX[Item], InBounds.CenterY[Item], InBounds.CenterZ[Item]);
+	}
+
+	UHBVHNode Root;
+	Root.ItemCount = static_cast<int32_t>(Items.size());
+	Nodes.push_back(Root);
+	Parents.push_back(UHINDEXNONE);
+
+	// top-down build with binned SAH, the cost of traversal step and item test are both treated as 1
+	std::vector<int32_t> Stack;
+	Stack.push_back(0);
+
+	while (Stack.size() > 0)
+	{
+		const int32_t NodeIdx = Stack.back();
+		Stack.pop_back();
+
+		const int32_t First = Nodes[NodeIdx].FirstItem;
+		const int32_t Count = Nodes[NodeIdx].ItemCount;
+
+		// node bound and centroid bound, the latter decides the bin range
+		XMFLOAT3 NodeMin(GWorldMax, GWorldMax, GWorldMax);
+		XMFLOAT3 NodeMax(-GWorldMax, -GWorldMax, -GWorldMax);
+		XMFLOAT3 CentroidMin(GWorldMax, GWorldMax, GWorldMax);
+		XMFLOAT3 CentroidMax(-GWorldMax, -GWorldMax, -GWorldMax);
+		for (int32_t Idx = First; Idx < First + Count; Idx++)
+		{
+			const int32_t Item = Items[Idx];
+			GrowBound(NodeMin, NodeMax, ItemMins[Item], ItemMaxs[Item]);
+			GrowBound(CentroidMin, CentroidMax, ItemCenters[Item], ItemCenters[Item]);
+		}
+		Nodes[NodeIdx].BoundMin = NodeMin;
+		Nodes[NodeIdx].BoundMax = NodeMax;
+
+		if (Count <= 1)
+		{
+			continue;
+		}
+
+		// bin all three axes in one pass
+		int32_t BinCounts[3][NumSAHBins] = {};
+		XMFLOAT3 BinMin[3][NumSAHBins];
+		XMFLOAT3 BinMax[3][NumSAHBins];
+		float BinScale[3];
+		for (int32_t Axis = 0; Axis < 3; Axis++)
+		{
+			const float AxisExtent = GetAxis(CentroidMax, Axis) - GetAxis(CentroidMin, Axis);
+			BinScale[Axis] = (AxisExtent > 0.0f) ? NumSAHBins / AxisExtent : 0.0f;
+			for (int32_t Bin = 0; Bin < NumSAHBins; Bin++)
+			{
+				BinMin[Axis][Bin] = XMFLOAT3(GWorldMax, GWorldMax, GWorldMax);
+				BinMax[Axis][Bin] = XMFLOAT3(-GWorldMax, -GWorldMax, -GWorldMax);
+			}
+		}
+
+		for (int32_t Idx = First; Idx < First + Count; Idx++)
+		{
+			const int32_t Item = Items[Idx];
+			for (int32_t Axis = 0; Axis < 3; Axis++)
+			{
+				const int32_t Bin = std::min(static_cast<int32_t>((GetAxis(ItemCenters[Item], Axis) - GetAxis(CentroidMin, Axis)) * BinScale[Axis])
+					, NumSAHBins - 1);
+				BinCounts[Axis][Bin]++;
+				GrowBound(BinMin[Axis][Bin], BinMax[Axis][Bin], ItemMins[Item], ItemMaxs[Item]);
+			}
+		}
+
+		int32_t BestAxis = UHINDEXNONE;
+		int32_t BestSplit = 0;
+		float BestCost = std::numeric_limits<float>::max();
+
+		for (int32_t Axis = 0; Axis < 3; Axis++)
+		{
+			if (BinScale[Axis] <= 0.0f)
+			{
+				continue;
+			}
+
+			// sweep from the right first and store the area * count, then sweep from the left to evaluate the split after each bin
+			float RightCosts[NumSAHBins];
+			XMFLOAT3 SweepMin(GWorldMax, GWorldMax, GWorldMax);
+			XMFLOAT3 SweepMax(-GWorldMax, -GWorldMax, -GWorldMax);
+			int32_t SweepCount = 0;
+			for (int32_t Bin = NumSAHBins - 1; Bin > 0; Bin--)
+			{
+				GrowBound(SweepMin, SweepMax, BinMin[Axis][Bin], BinMax[Axis][Bin]);
+				SweepCount += BinCounts[Axis][Bin];
+				RightCosts[Bin - 1] = (SweepCount > 0) ? SurfaceArea(SweepMin, SweepMax) * SweepCount : 0.0f;
+			}
+
+			SweepMin = XMFLOAT3(GWorldMax, GWorldMax, GWorldMax);
+			SweepMax = XMFLOAT3(-GWorldMax, -GWorldMax, -GWorldMax);
+			SweepCount = 0;
+			for (int32_t Bin = 0; Bin < NumSAHBins - 1; Bin++)
+			{
+				GrowBound(SweepMin, SweepMax, BinMin[Axis][Bin], BinMax[Axis][Bin]);
+				SweepCount += BinCounts[Axis][Bin];
+				if (SweepCount == 0 || SweepCount == Count)
+				{
+					continue;
+				}
+
+				const float Cost = SurfaceArea(SweepMin, SweepMax) * SweepCount + RightCosts[Bin];
+				if (Cost < BestCost)
+				{
+					BestCost = Cost;
+					BestAxis = Axis;
+					BestSplit = Bin;
+				}
+			}
+		}
+
+		const float NodeArea = std::max(SurfaceArea(NodeMin, NodeMax), GEpsilon);
+		int32_t Mid = First + Count / 2;
+
+		if (BestAxis != UHINDEXNONE)
+		{
+			// stop splitting when a leaf is cheaper
+			const float SplitCost = 1.0f + BestCost / NodeArea;
+			if (Count <= MaxLeafItems && SplitCost >= static_cast<float>(Count))
+			{
+				continue;
+			}
+
+			const float AxisMin = GetAxis(CentroidMin, BestAxis);
+			const float Scale = BinScale[BestAxis];
+			auto MidIter = std::partition(Items.begin() + First, Items.begin() + First + Count, [&](int32_t InItem)
+			{
+				const int32_t Bin = std::min(static_cast<int32_t>((GetAxis(ItemCenters[InItem], BestAxis) - AxisMin) * Scale), NumSAHBins - 1);
+				return Bin <= BestSplit;
+			});
+			Mid = static_cast<int32_t>(MidIter - Items.begin());
+		}
+		else if (Count <= MaxLeafItems)
+		{
+			// all centroids are at the same place and it's small enough
+			continue;
+		}
+
+		// fallback to the middle split when the partition failed, e.g. items with the same centroid
+		if (Mid == First || Mid == First + Count)
+		{
+			Mid = First + Count / 2;
+		}
+
+		const int32_t LeftIdx = static_cast<int32_t>(Nodes.size());
+		UHBVHNode Left;
+		Left.FirstItem = First;
+		Left.ItemCount = Mid - First;
+
+		UHBVHNode Right;
+		Right.FirstItem = Mid;
+		Right.ItemCount = First + Count - Mid;
+
+		Nodes.push_back(Left);
+		Nodes.push_back(Right);
+		Parents.push_back(NodeIdx);
+		Parents.push_back(NodeIdx);
+		Nodes[NodeIdx].LeftChild = LeftIdx;
+
+		Stack.push_back(LeftIdx + 1);
+		Stack.push_back(LeftIdx);
+	}
+
+	// item to leaf lookup for refitting
+	ItemToLeaf.resize(MaxItem + 1, UHINDEXNONE);
+	for (int32_t NodeIdx = 0; NodeIdx < static_cast<int32_t>(Nodes.size()); NodeIdx++)
+	{
+		if (Nodes[NodeIdx].IsLeaf())
+		{
+			for (int32_t Idx = Nodes[NodeIdx].FirstItem; Idx < Nodes[NodeIdx].FirstItem + Nodes[NodeIdx].ItemCount; Idx++)
+			{
+				ItemToLeaf[Items[Idx]] = NodeIdx;
+			}
+		}
+	}
+}
+
+void UHBoundingVolumeHierarchy::Clear()
+{
+	Nodes.clear();
+	Items.clear();
+	Parents.clear();
+	ItemToLeaf.clear();
+}
+
+void UHBoundingVolumeHierarchy::Refit(const UHCullingBounds& InBounds, const std::vector<int32_t>& InDirtyItems)
+{
+	if (Nodes.size() == 0 || InDirtyItems.size() == 0)
+	{
+		return;
+	}
+
+	// walking up from each item gets expensive when lots of items are dirty
+	if (InDirtyItems.size() * 8 >= Nodes.size())
+	{
+		RefitAll(InBounds);
+		return;
+	}
+
+	for (const int32_t Item : InDirtyItems)
+	{
+		if (Item < 0 || Item >= static_cast<int32_t>(ItemToLeaf.size()) || ItemToLeaf[Item] == UHINDEXNONE)
+		{
+			continue;
+		}
+
+		const int32_t LeafIdx = ItemToLeaf[Item];
+		ComputeBoundFromItems(InBounds, LeafIdx);
+
+		// stop as soon as a parent bound doesn't change
+		for (int32_t NodeIdx = Parents[LeafIdx]; NodeIdx != UHINDEXNONE; NodeIdx = Parents[NodeIdx])
+		{
+			if (!ComputeInnerBound(NodeIdx))
+			{
+				break;
+			}
+		}
+	}
+}
+
+void UHBoundingVolumeHierarchy::RefitAll(const UHCullingBounds& InBounds)
+{
+	// children are always stored after the parent, so a reversed loop is a bottom-up refit
+	for (int32_t NodeIdx = static_cast<int32_t>(Nodes.size()) - 1; NodeIdx >= 0; NodeIdx--)
+	{
+		if (Nodes[NodeIdx].IsLeaf())
+		{
+			ComputeBoundFromItems(InBounds, NodeIdx);
+		}
+		else
+		{
+			ComputeInnerBound(NodeIdx);
+		}
+	}
+}
+
+void UHBoundingVolumeHierarchy::QueryFrustum(const UHCullingBounds& InBounds, const UHCullingPlanes& InPlanes, std::vector<uint32_t>& OutBits) const
+{
+	if (Nodes.size() == 0)
+	{
+		return;
+	}
+
+	// the plane mask records the planes still intersecting the node, a fully inside node skips the tests of its children
+	const uint32_t AllPlanes = (1u << UHCullingPlanes::NumPlanes) - 1;
+	std::vector<std::pair<int32_t, uint32_t>> Stack;
+	Stack.reserve(64);
+	Stack.push_back(std::make_pair(0, AllPlanes));
+
+	while (Stack.size() > 0)
+	{
+		const int32_t NodeIdx = Stack.back().first;
+		uint32_t PlaneMask = Stack.back().second;
+		Stack.pop_back();
+
+		const UHBVHNode& Node = Nodes[NodeIdx];
+		const XMFLOAT3 Center((Node.BoundMin.x + Node.BoundMax.x) * 0.5f, (Node.BoundMin.y + Node.BoundMax.y) * 0.5f, (Node.BoundMin.z + Node.BoundMax.z) * 0.5f);
+		const XMFLOAT3 Extent((Node.BoundMax.x - Node.BoundMin.x) * 0.5f, (Node.BoundMax.y - Node.BoundMin.y) * 0.5f, (Node.BoundMax.z - Node.BoundMin.z) * 0.5f);
+
+		bool bOutside = false;
+		for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes && !bOutside; PlaneIdx++)
+		{
+			if (PlaneMask & (1u << PlaneIdx))
+			{
+				const int32_t Result = UHFrustumCulling::ClassifyBox(InPlanes, PlaneIdx, Center, Extent);
+				bOutside = (Result > 0);
+				PlaneMask &= (Result < 0) ? ~(1u << PlaneIdx) : AllPlanes;
+			}
+		}
+
+		if (bOutside)
+		{
+			continue;
+		}
+
+		if (PlaneMask == 0)
+		{
+			for (int32_t Idx = Node.FirstItem; Idx < Node.FirstItem + Node.ItemCount; Idx++)
+			{
+				SetBit(OutBits, Items[Idx]);
+			}
+			continue;
+		}
+
+		if (!Node.IsLeaf())
+		{
+			Stack.push_back(std::make_pair(Node.LeftChild + 1, PlaneMask));
+			Stack.push_back(std::make_pair(Node.LeftChild, PlaneMask));
+			continue;
+		}
+
+		// test the items of leaf with the remaining planes
+		for (int32_t Idx = Node.FirstItem; Idx < Node.FirstItem + Node.ItemCount; Idx++)
+		{
+			const int32_t Item = Items[Idx];
+			const XMFLOAT3 ItemCenter(InBounds.CenterX[Item], InBounds.CenterY[Item], InBounds.CenterZ[Item]);
+			const XMFLOAT3 ItemExtent(InBounds.ExtentX[Item], InBounds.ExtentY[Item], InBounds.ExtentZ[Item]);
+
+			bool bItemOutside = false;
+			for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes && !bItemOutside; PlaneIdx++)
+			{
+				if (PlaneMask & (1u << PlaneIdx))
+				{
+					bItemOutside = (UHFrustumCulling::ClassifyBox(InPlanes, PlaneIdx, ItemCenter, ItemExtent) > 0);
+				}
+			}
+
+			if (!bItemOutside)
+			{
+				SetBit(OutBits, Item);
+			}
+		}
+	}
+}
+
+void UHBoundingVolumeHierarchy::QuerySphere(const UHCullingBounds& InBounds, const XMFLOAT3& InCenter, const float InRadius, std::vector<uint32_t>& OutBits) const
+{
+	if (Nodes.size() == 0)
+	{
+		return;
+	}
+
+	const float SqrRadius = InRadius * InRadius;
+	std::vector<int32_t> Stack;
+	Stack.reserve(64);
+	Stack.push_back(0);
+
+	while (Stack.size() > 0)
+	{
+		const UHBVHNode& Node = Nodes[Stack.back()];
+		Stack.pop_back();
+
+		const XMFLOAT3 Center((Node.BoundMin.x + Node.BoundMax.x) * 0.5f, (Node.BoundMin.y + Node.BoundMax.y) * 0.5f, (Node.BoundMin.z + Node.BoundMax.z) * 0.5f);
+		const XMFLOAT3 Extent((Node.BoundMax.x - Node.BoundMin.x) * 0.5f, (Node.BoundMax.y - Node.BoundMin.y) * 0.5f, (Node.BoundMax.z - Node.BoundMin.z) * 0.5f);
+		if (UHFrustumCulling::SquareDistanceToBox(InCenter, Center, Extent) > SqrRadius)
+		{
+			continue;
+		}
+
+		// the farthest corner is inside the sphere, take all items
+		const float FX = std::abs(InCenter.x - Center.x) + Extent.x;
+		const float FY = std::abs(InCenter.y - Center.y) + Extent.y;
+		const float FZ = std::abs(InCenter.z - Center.z) + Extent.z;
+		if (FX * FX + FY * FY + FZ * FZ <= SqrRadius)
+		{
+			for (int32_t Idx = Node.FirstItem; Idx < Node.FirstItem + Node.ItemCount; Idx++)
+			{
+				SetBit(OutBits, Items[Idx]);
+			}
+			continue;
+		}
+
+		if (!Node.IsLeaf())
+		{
+			Stack.push_back(Node.LeftChild + 1);
+			Stack.push_back(Node.LeftChild);
+			continue;
+		}
+
+		for (int32_t Idx = Node.FirstItem; Idx < Node.FirstItem + Node.ItemCount; Idx++)
+		{
+			const int32_t Item = Items[Idx];
+			const XMFLOAT3 ItemCenter(InBounds.CenterX[Item], InBounds.CenterY[Item], InBounds.CenterZ[Item]);
+			const XMFLOAT3 ItemExtent(InBounds.ExtentX[Item], InBounds.ExtentY[Item], InBounds.ExtentZ[Item]);
+			if (UHFrustumCulling::SquareDistanceToBox(InCenter, ItemCenter, ItemExtent) <= SqrRadius)
+			{
+				SetBit(OutBits, Item);
+			}
+		}
+	}
+}
+
+int32_t UHBoundingVolumeHierarchy::RayCast(const UHCullingBounds& InBounds, const XMFLOAT3& InOrigin, const XMFLOAT3& InDirection, float InMaxDistance
+	, float& OutDistance) const
+{
+	OutDistance = InMaxDistance;
+	if (Nodes.size() == 0)
+	{
+		return UHINDEXNONE;
+	}
+
+	// division by zero gives infinity, which is handled by the slab test
+	const XMFLOAT3 InvDir(1.0f / InDirection.x, 1.0f / InDirection.y, 1.0f / InDirection.z);
+	int32_t ClosestItem = UHINDEXNONE;
+
+	std::vector<std::pair<int32_t, float>> Stack;
+	Stack.reserve(64);
+	const float RootDist = IntersectRayBox(InOrigin, InvDir, Nodes[0].BoundMin, Nodes[0].BoundMax, OutDistance);
+	if (RootDist >= 0.0f)
+	{
+		Stack.push_back(std::make_pair(0, RootDist));
+	}
+
+	while (Stack.size() > 0)
+	{
+		const int32_t NodeIdx = Stack.back().first;
+		const float NodeDist = Stack.back().second;
+		Stack.pop_back();
+
+		// skip the node farther than current hit
+		if (NodeDist > OutDistance)
+		{
+			continue;
+		}
+
+		const UHBVHNode& Node = Nodes[NodeIdx];
+		if (Node.IsLeaf())
+		{
+			for (int32_t Idx = Node.FirstItem; Idx < Node.FirstItem + Node.ItemCount; Idx++)
+			{
+				XMFLOAT3 ItemMin, ItemMax;
+				GetItemBound(InBounds, Items[Idx], ItemMin, ItemMax);
+
+				const float Dist = IntersectRayBox(InOrigin, InvDir, ItemMin, ItemMax, OutDistance);
+				if (Dist >= 0.0f && (ClosestItem == UHINDEXNONE || Dist < OutDistance))
+				{
+					OutDistance = Dist;
+					ClosestItem = Items[Idx];
+				}
+			}
+			continue;
+		}
+
+		// visit the closer child first
+		const UHBVHNode& Left = Nodes[Node.LeftChild];
+		const UHBVHNode& Right = Nodes[Node.LeftChild + 1];
+		const float LeftDist = IntersectRayBox(InOrigin, InvDir, Left.BoundMin, Left.BoundMax, OutDistance);
+		const float RightDist = IntersectRayBox(InOrigin, InvDir, Right.BoundMin, Right.BoundMax, OutDistance);
+
+		if (LeftDist >= 0.0f && RightDist >= 0.0f)
+		{
+			const bool bLeftFirst = LeftDist <= RightDist;
+			Stack.push_back(bLeftFirst ? std::make_pair(Node.LeftChild + 1, RightDist) : std::make_pair(Node.LeftChild, LeftDist));
+			Stack.push_back(bLeftFirst ? std::make_pair(Node.LeftChild, LeftDist) : std::make_pair(Node.LeftChild + 1, RightDist));
+		}
+		else if (LeftDist >= 0.0f)
+		{
+			Stack.push_back(std::make_pair(Node.LeftChild, LeftDist));
+		}
+		else if (RightDist >= 0.0f)
+		{
+			Stack.push_back(std::make_pair(Node.LeftChild + 1, RightDist));
+		}
+	}
+
+	return ClosestItem;
+}
+
+bool UHBoundingVolumeHierarchy::IsEmpty() const
+{
+	return Nodes.size() == 0;
+}
+
+size_t UHBoundingVolumeHierarchy::GetNodeCount() const
+{
+	return Nodes.size();
+}
+
+size_t UHBoundingVolumeHierarchy::GetItemCount() const
+{
+	return Items.size();
+}
+
+void UHBoundingVolumeHierarchy::ComputeBoundFromItems(const UHCullingBounds& InBounds, int32_t InNodeIdx)
+{
+	UHBVHNode& Node = Nodes[InNodeIdx];
+	Node.BoundMin = XMFLOAT3(GWorldMax, GWorldMax, GWorldMax);
+	Node.BoundMax = XMFLOAT3(-GWorldMax, -GWorldMax, -GWorldMax);
+
+	for (int32_t Idx = Node.FirstItem; Idx < Node.FirstItem + Node.ItemCount; Idx++)
+	{
+		XMFLOAT3 ItemMin, ItemMax;
+		GetItemBound(InBounds, Items[Idx], ItemMin, ItemMax);
+		GrowBound(Node.BoundMin, Node.BoundMax, ItemMin, ItemMax);
+	}
+}
+
+bool UHBoundingVolumeHierarchy::ComputeInnerBound(int32_t InNodeIdx)
+{
+	UHBVHNode& Node = Nodes[InNodeIdx];
+	const UHBVHNode& Left = Nodes[Node.LeftChild];
+	const UHBVHNode& Right = Nodes[Node.LeftChild + 1];
+
+	const XMFLOAT3 NewMin = MathHelpers::MinVector(Left.BoundMin, Right.BoundMin);
+	const XMFLOAT3 NewMax = MathHelpers::MaxVector(Left.BoundMax, Right.BoundMax);
+	const bool bChanged = !MathHelpers::IsVectorEqual(NewMin, Node.BoundMin) || !MathHelpers::IsVectorEqual(NewMax, Node.BoundMax);
+
+	Node.BoundMin = NewMin;
+	Node.BoundMax = NewMax;
+	return bChanged;
+}
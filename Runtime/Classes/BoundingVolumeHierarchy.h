@@ -0,0 +1,60 @@
+#pragma once
+#include "FrustumCulling.h"
+
+// BVH node, the children of an inner node are always stored after it
+// each node covers a contiguous range of items, so a node fully inside a query can add its items without visiting the children
+struct UHBVHNode
+{
+	UHBVHNode();
+	bool IsLeaf() const;
+
+	XMFLOAT3 BoundMin;
+	int32_t LeftChild;
+	XMFLOAT3 BoundMax;
+	int32_t FirstItem;
+	int32_t ItemCount;
+};
+
+// bounding volume hierarchy of UH engine, items are indices to a UHCullingBounds storage
+// the tree is built top-down with binned SAH, and it can be refitted when the bounds of items change
+// refitting keeps the topology, so it's preferred for moveable objects, while static objects are better with a full build
+class UHBoundingVolumeHierarchy
+{
+public:
+	UHBoundingVolumeHierarchy();
+
+	void Build(const UHCullingBounds& InBounds, const std::vector<int32_t>& InItems);
+	void Clear();
+
+	// refit the nodes containing the dirty items, a full refit is done instead when there are too many dirty items
+	void Refit(const UHCullingBounds& InBounds, const std::vector<int32_t>& InDirtyItems);
+	void RefitAll(const UHCullingBounds& InBounds);
+
+	// set the visible bits of items which aren't fully outside of any frustum plane
+	void QueryFrustum(const UHCullingBounds& InBounds, const UHCullingPlanes& InPlanes, std::vector<uint32_t>& OutBits) const;
+
+	// set the bits of items which overlap with the sphere
+	void QuerySphere(const UHCullingBounds& InBounds, const XMFLOAT3& InCenter, const float InRadius, std::vector<uint32_t>& OutBits) const;
+
+	// closest item hit by the ray, the distance is the entry distance to the item bound, return UHINDEXNONE if nothing is hit
+	int32_t RayCast(const UHCullingBounds& InBounds, const XMFLOAT3& InOrigin, const XMFLOAT3& InDirection, float InMaxDistance
+		, float& OutDistance) const;
+
+	bool IsEmpty() const;
+	size_t GetNodeCount() const;
+	size_t GetItemCount() const;
+
+	static const int32_t MaxLeafItems = 4;
+	static const int32_t NumSAHBins = 16;
+
+private:
+	void ComputeBoundFromItems(const UHCullingBounds& InBounds, int32_t InNodeIdx);
+	bool ComputeInnerBound(int32_t InNodeIdx);
+
+	std::vector<UHBVHNode> Nodes;
+	std::vector<int32_t> Items;
+	std::vector<int32_t> Parents;
+
+	// item index to leaf node index, UHINDEXNONE for items not in this tree
+	std::vector<int32_t> ItemToLeaf;
+};
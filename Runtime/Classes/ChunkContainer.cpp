@@ -0,0 +1,148 @@
+#include "ChunkContainer.h"
+#include <cstring>
+
+inline uint64_t AlignChunkOffset(uint64_t InOffset)
+{
+	return (InOffset + GChunkAlignment - 1) & ~static_cast<uint64_t>(GChunkAlignment - 1);
+}
+
+void UHChunkWriter::AddChunk(uint32_t InId, const void* InData, size_t InCount, uint32_t InElementSize)
+{
+	UHPendingChunk Chunk;
+	Chunk.Id = InId;
+	Chunk.ElementSize = InElementSize;
+	Chunk.Data = InData;
+	Chunk.Size = InCount * InElementSize;
+	PendingChunks.push_back(Chunk);
+}
+
+void UHChunkWriter::AddString(uint32_t InId, const std::string& InString)
+{
+	AddChunk(InId, InString.data(), InString.size(), sizeof(char));
+}
+
+bool UHChunkWriter::Write(std::ofstream& FileOut) const
+{
+	if (FileOut.fail())
+	{
+		return false;
+	}
+
+	// the offsets are absolute, so the alignment holds for the mapped view which always starts at a page boundary
+	const uint64_t ContainerStart = static_cast<uint64_t>(FileOut.tellp());
+
+	UHChunkContainerHeader Header;
+	Header.Magic = GChunkContainerMagic;
+	Header.ContainerVersion = GChunkContainerVersion;
+	Header.ChunkCount = static_cast<uint32_t>(PendingChunks.size());
+	Header.Alignment = GChunkAlignment;
+
+	std::vector<UHChunkEntry> Entries(PendingChunks.size());
+	uint64_t Cursor = ContainerStart + sizeof(UHChunkContainerHeader) + sizeof(UHChunkEntry) * Entries.size();
+	for (size_t Idx = 0; Idx < PendingChunks.size(); Idx++)
+	{
+		Cursor = AlignChunkOffset(Cursor);
+		Entries[Idx].Id = PendingChunks[Idx].Id;
+		Entries[Idx].ElementSize = PendingChunks[Idx].ElementSize;
+		Entries[Idx].Offset = Cursor;
+		Entries[Idx].Size = PendingChunks[Idx].Size;
+		Cursor += PendingChunks[Idx].Size;
+	}
+
+	FileOut.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	FileOut.write(reinterpret_cast<const char*>(Entries.data()), sizeof(UHChunkEntry) * Entries.size());
+
+	const char Padding[GChunkAlignment] = {};
+	uint64_t WrittenSize = ContainerStart + sizeof(UHChunkContainerHeader) + sizeof(UHChunkEntry) * Entries.size();
+	for (size_t Idx = 0; Idx < PendingChunks.size(); Idx++)
+	{
+		FileOut.write(Padding, static_cast<std::streamsize>(Entries[Idx].Offset - WrittenSize));
+		if (PendingChunks[Idx].Size > 0)
+		{
+			FileOut.write(reinterpret_cast<const char*>(PendingChunks[Idx].Data), static_cast<std::streamsize>(PendingChunks[Idx].Size));
+		}
+		WrittenSize = Entries[Idx].Offset + Entries[Idx].Size;
+	}
+
+	return !FileOut.fail();
+}
+
+UHChunkReader::UHChunkReader()
+	: FileData(nullptr)
+	, FileSize(0)
+{
+
+}
+
+bool UHChunkReader::Parse(const uint8_t* InData, size_t InSize, size_t InContainerOffset)
+{
+	FileData = nullptr;
+	FileSize = 0;
+	Entries.clear();
+
+	if (InData == nullptr || InContainerOffset > InSize || InSize - InContainerOffset < sizeof(UHChunkContainerHeader))
+	{
+		return false;
+	}
+
+	UHChunkContainerHeader Header;
+	memcpy(&Header, InData + InContainerOffset, sizeof(Header));
+	if (Header.Magic != GChunkContainerMagic || Header.ContainerVersion > GChunkContainerVersion || Header.Alignment != GChunkAlignment)
+	{
+		return false;
+	}
+
+	const uint64_t TocOffset = InContainerOffset + sizeof(UHChunkContainerHeader);
+	if (static_cast<uint64_t>(Header.ChunkCount) * sizeof(UHChunkEntry) > InSize - TocOffset)
+	{
+		return false;
+	}
+
+	Entries.resize(Header.ChunkCount);
+	memcpy(Entries.data(), InData + TocOffset, sizeof(UHChunkEntry) * Entries.size());
+
+	for (const UHChunkEntry& Entry : Entries)
+	{
+		const bool bValid = Entry.ElementSize > 0
+			&& Entry.Size % Entry.ElementSize == 0
+			&& Entry.Offset % GChunkAlignment == 0
+			&& Entry.Offset <= InSize
+			&& Entry.Size <= InSize - Entry.Offset;
+
+		if (!bValid)
+		{
+			Entries.clear();
+			return false;
+		}
+	}
+
+	FileData = InData;
+	FileSize = InSize;
+	return true;
+}
+
+const UHChunkEntry* UHChunkReader::FindChunk(uint32_t InId) const
+{
+	// assets have a handful of chunks, linear search is enough
+	for (const UHChunkEntry& Entry : Entries)
+	{
+		if (Entry.Id == InId)
+		{
+			return &Entry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool UHChunkReader::ReadString(uint32_t InId, std::string& OutString) const
+{
+	if (FindChunk(InId) == nullptr)
+	{
+		return false;
+	}
+
+	const UHDataSpan<char> Span = GetSpan<char>(InId);
+	OutString.assign(Span.begin(), Span.end());
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+
+// chunked binary container for assets: header, table of contents and aligned data blobs
+// [UHChunkContainerHeader][UHChunkEntry x ChunkCount][padding][chunk 0][padding][chunk 1]...
+// chunk offsets are absolute file offsets aligned to GChunkAlignment, so the chunks of a memory mapped file
+// can be used in place, the container itself can start anywhere in a file (e.g. after the UHObject header)
+
+// "UHCK" in little endian
+const uint32_t GChunkContainerMagic = 0x4B434855;
+const uint32_t GChunkContainerVersion = 1;
+const uint32_t GChunkAlignment = 16;
+
+struct UHChunkContainerHeader
+{
+	uint32_t Magic;
+	uint32_t ContainerVersion;
+	uint32_t ChunkCount;
+	uint32_t Alignment;
+};
+
+struct UHChunkEntry
+{
+	uint32_t Id;
+	uint32_t ElementSize;
+	uint64_t Offset;
+	uint64_t Size;
+};
+
+// read-only view of the elements inside a chunk, it doesn't own the data
+template <typename T>
+struct UHDataSpan
+{
+	UHDataSpan()
+		: Data(nullptr)
+		, Count(0)
+	{
+
+	}
+
+	UHDataSpan(const T* InData, size_t InCount)
+		: Data(InData)
+		, Count(InCount)
+	{
+
+	}
+
+	const T* begin() const
+	{
+		return Data;
+	}
+
+	const T* end() const
+	{
+		return Data + Count;
+	}
+
+	const T& operator[](size_t InIndex) const
+	{
+		return Data[InIndex];
+	}
+
+	bool IsEmpty() const
+	{
+		return Count == 0;
+	}
+
+	const T* Data;
+	size_t Count;
+};
+
+// collects chunks and writes the container, the chunk data must stay alive until Write() is called
+class UHChunkWriter
+{
+public:
+	void AddChunk(uint32_t InId, const void* InData, size_t InCount, uint32_t InElementSize);
+
+	template <typename T>
+	void AddChunk(uint32_t InId, const std::vector<T>& InData)
+	{
+		AddChunk(InId, InData.data(), InData.size(), sizeof(T));
+	}
+
+	template <typename T>
+	void AddValue(uint32_t InId, const T& InValue)
+	{
+		AddChunk(InId, &InValue, 1, sizeof(T));
+	}
+
+	void AddString(uint32_t InId, const std::string& InString);
+	bool Write(std::ofstream& FileOut) const;
+
+private:
+	struct UHPendingChunk
+	{
+		uint32_t Id;
+		uint32_t ElementSize;
+		const void* Data;
+		size_t Size;
+	};
+
+	std::vector<UHPendingChunk> PendingChunks;
+};
+
+// parses the container from the memory (usually a mapped file) and hands out spans that point into it
+class UHChunkReader
+{
+public:
+	UHChunkReader();
+
+	// InData is the beginning of the file, InContainerOffset is where the container header starts
+	// all entries are validated here, so the spans returned later are always in range
+	bool Parse(const uint8_t* InData, size_t InSize, size_t InContainerOffset);
+	const UHChunkEntry* FindChunk(uint32_t InId) const;
+
+	// returns an empty span if the chunk is missing or its element size doesn't match
+	template <typename T>
+	UHDataSpan<T> GetSpan(uint32_t InId) const
+	{
+		const UHChunkEntry* Entry = FindChunk(InId);
+		if (Entry == nullptr || Entry->ElementSize != sizeof(T))
+		{
+			return UHDataSpan<T>();
+		}
+
+		return UHDataSpan<T>(reinterpret_cast<const T*>(FileData + Entry->Offset), static_cast<size_t>(Entry->Size / sizeof(T)));
+	}
+
+	template <typename T>
+	bool ReadValue(uint32_t InId, T& OutValue) const
+	{
+		const UHDataSpan<T> Span = GetSpan<T>(InId);
+		if (Span.Count != 1)
+		{
+			return false;
+		}
+
+		OutValue = Span[0];
+		return true;
+	}
+
+	bool ReadString(uint32_t InId, std::string& OutString) const;
+
+private:
+	const uint8_t* FileData;
+	size_t FileSize;
+	std::vector<UHChunkEntry> Entries;
+};
\ No newline at end of file
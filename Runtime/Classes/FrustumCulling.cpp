@@ -0,0 +1,475 @@
+#include "FrustumCulling.h"
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define UH_TARGET_AVX
+#else
+#define UH_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+UHCullingBounds::UHCullingBounds()
+	: Count(0)
+{
+
+}
+
+void UHCullingBounds::Resize(size_t InCount)
+{
+	const size_t WordCount = (InCount + BoxesPerWord - 1) / BoxesPerWord;
+	const size_t PaddedCount = WordCount * BoxesPerWord;
+
+	CenterX.resize(PaddedCount, 0.0f);
+	CenterY.resize(PaddedCount, 0.0f);
+	CenterZ.resize(PaddedCount, 0.0f);
+	ExtentX.resize(PaddedCount, 0.0f);
+	ExtentY.resize(PaddedCount, 0.0f);
+	ExtentZ.resize(PaddedCount, 0.0f);
+	SquareDistances.resize(PaddedCount, 0.0f);
+
+	// new boxes are visible by default, which is the same as the default state of renderers
+	// they're in range as well, so the renderers will get their distance once they're culled
+	VisibleBits.resize(WordCount, 0);
+	InRangeBits.resize(WordCount, 0);
+	PreviousBits.resize(WordCount, 0);
+	CameraInsideBits.resize(WordCount, 0);
+	for (size_t Idx = Count; Idx < InCount; Idx++)
+	{
+		VisibleBits[Idx / BoxesPerWord] |= (1u << (Idx % BoxesPerWord));
+		InRangeBits[Idx / BoxesPerWord] |= (1u << (Idx % BoxesPerWord));
+	}
+
+	Count = InCount;
+}
+
+void UHCullingBounds::Clear()
+{
+	Count = 0;
+	CenterX.clear();
+	CenterY.clear();
+	CenterZ.clear();
+	ExtentX.clear();
+	ExtentY.clear();
+	ExtentZ.clear();
+	SquareDistances.clear();
+	VisibleBits.clear();
+	InRangeBits.clear();
+	PreviousBits.clear();
+	CameraInsideBits.clear();
+}
+
+void UHCullingBounds::SetBound(int32_t InIdx, const BoundingBox& InBound)
+{
+	CenterX[InIdx] = InBound.Center.x;
+	CenterY[InIdx] = InBound.Center.y;
+	CenterZ[InIdx] = InBound.Center.z;
+	ExtentX[InIdx] = InBound.Extents.x;
+	ExtentY[InIdx] = InBound.Extents.y;
+	ExtentZ[InIdx] = InBound.Extents.z;
+}
+
+BoundingBox UHCullingBounds::GetBound(int32_t InIdx) const
+{
+	return BoundingBox(XMFLOAT3(CenterX[InIdx], CenterY[InIdx], CenterZ[InIdx])
+		, XMFLOAT3(ExtentX[InIdx], ExtentY[InIdx], ExtentZ[InIdx]));
+}
+
+size_t UHCullingBounds::GetCount() const
+{
+	return Count;
+}
+
+int32_t UHCullingBounds::GetWordCount() const
+{
+	return static_cast<int32_t>(VisibleBits.size());
+}
+
+bool UHCullingBounds::IsVisible(int32_t InIdx) const
+{
+	return (VisibleBits[InIdx / BoxesPerWord] & (1u << (InIdx % BoxesPerWord))) != 0;
+}
+
+bool UHCullingBounds::IsInRange(int32_t InIdx) const
+{
+	return (InRangeBits[InIdx / BoxesPerWord] & (1u << (InIdx % BoxesPerWord))) != 0;
+}
+
+bool UHCullingBounds::IsCameraInside(int32_t InIdx) const
+{
+	return (CameraInsideBits[InIdx / BoxesPerWord] & (1u << (InIdx % BoxesPerWord))) != 0;
+}
+
+float UHCullingBounds::GetSquareDistance(int32_t InIdx) const
+{
+	return SquareDistances[InIdx];
+}
+
+UHCullingPlanes::UHCullingPlanes()
+{
+	for (int32_t Idx = 0; Idx < NumPlanes; Idx++)
+	{
+		NormalX[Idx] = 0.0f;
+		NormalY[Idx] = 0.0f;
+		NormalZ[Idx] = 0.0f;
+		Distance[Idx] = 0.0f;
+	}
+}
+
+namespace UHFrustumCulling
+{
+	UHCullingPlanes BuildPlanes(const BoundingFrustum& InFrustum)
+	{
+		XMVECTOR Planes[UHCullingPlanes::NumPlanes];
+		InFrustum.GetPlanes(&Planes[0], &Planes[1], &Planes[2], &Planes[3], &Planes[4], &Planes[5]);
+
+		UHCullingPlanes Result;
+		for (int32_t Idx = 0; Idx < UHCullingPlanes::NumPlanes; Idx++)
+		{
+			XMFLOAT4 Plane;
+			XMStoreFloat4(&Plane, Planes[Idx]);
+			Result.NormalX[Idx] = Plane.x;
+			Result.NormalY[Idx] = Plane.y;
+			Result.NormalZ[Idx] = Plane.z;
+			Result.Distance[Idx] = Plane.w;
+		}
+
+		return Result;
+	}
+
+	UHCullingSIMDLevel DetectSIMDLevel()
+	{
+#if defined(_MSC_VER)
+		int32_t CpuInfo[4];
+		__cpuid(CpuInfo, 1);
+
+		// AVX needs both CPU support and the OS saving YMM registers
+		const bool bHasOSXSave = (CpuInfo[2] & (1 << 27)) != 0;
+		const bool bHasAVX = (CpuInfo[2] & (1 << 28)) != 0;
+		if (bHasOSXSave && bHasAVX && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			return UHCullingSIMDLevel::AVX;
+		}
+#else
+		if (__builtin_cpu_supports("avx"))
+		{
+			return UHCullingSIMDLevel::AVX;
+		}
+#endif
+
+		// SSE2 is the baseline of x64
+		return UHCullingSIMDLevel::SSE;
+	}
+
+	UHCullingSIMDLevel GetSIMDLevel()
+	{
+		static const UHCullingSIMDLevel Level = DetectSIMDLevel();
+		return Level;
+	}
+
+	int32_t ClassifyBox(const UHCullingPlanes& InPlanes, int32_t InPlaneIdx, const XMFLOAT3& InCenter, const XMFLOAT3& InExtent)
+	{
+		const float Dist = InPlanes.NormalX[InPlaneIdx] * InCenter.x + InPlanes.NormalY[InPlaneIdx] * InCenter.y + InPlanes.NormalZ[InPlaneIdx] * InCenter.z
+			+ InPlanes.Distance[InPlaneIdx];
+		const float Radius = std::abs(InPlanes.NormalX[InPlaneIdx]) * InExtent.x + std::abs(InPlanes.NormalY[InPlaneIdx]) * InExtent.y
+			+ std::abs(InPlanes.NormalZ[InPlaneIdx]) * InExtent.z;
+
+		if (Dist > Radius)
+		{
+			return 1;
+		}
+
+		return (Dist < -Radius) ? -1 : 0;
+	}
+
+	float SquareDistanceToBox(const XMFLOAT3& InPoint, const XMFLOAT3& InCenter, const XMFLOAT3& InExtent)
+	{
+		const float DX = std::max(std::abs(InPoint.x - InCenter.x) - InExtent.x, 0.0f);
+		const float DY = std::max(std::abs(InPoint.y - InCenter.y) - InExtent.y, 0.0f);
+		const float DZ = std::max(std::abs(InPoint.z - InCenter.z) - InExtent.z, 0.0f);
+		return DX * DX + DY * DY + DZ * DZ;
+	}
+
+	// scalar reference, also used as the fallback
+	void CullBoundsScalar(const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd)
+	{
+		const float SqrRange = InRangeRadius * InRangeRadius;
+		for (int32_t WordIdx = InWordBegin; WordIdx < InWordEnd; WordIdx++)
+		{
+			uint32_t VisibleWord = 0;
+			uint32_t InRangeWord = 0;
+			uint32_t InsideWord = 0;
+
+			for (int32_t Bit = 0; Bit < UHCullingBounds::BoxesPerWord; Bit++)
+			{
+				const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + Bit;
+				const float CX = InOutBounds.CenterX[Idx];
+				const float CY = InOutBounds.CenterY[Idx];
+				const float CZ = InOutBounds.CenterZ[Idx];
+				const float EX = InOutBounds.ExtentX[Idx];
+				const float EY = InOutBounds.ExtentY[Idx];
+				const float EZ = InOutBounds.ExtentZ[Idx];
+
+				bool bOutside = false;
+				for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes; PlaneIdx++)
+				{
+					const float Dist = InPlanes.NormalX[PlaneIdx] * CX + InPlanes.NormalY[PlaneIdx] * CY + InPlanes.NormalZ[PlaneIdx] * CZ
+						+ InPlanes.Distance[PlaneIdx];
+					const float Radius = std::abs(InPlanes.NormalX[PlaneIdx]) * EX + std::abs(InPlanes.NormalY[PlaneIdx]) * EY
+						+ std::abs(InPlanes.NormalZ[PlaneIdx]) * EZ;
+					bOutside |= (Dist > Radius);
+				}
+
+				const float DX = CX - InCameraPos.x;
+				const float DY = CY - InCameraPos.y;
+				const float DZ = CZ - InCameraPos.z;
+				const float SqrDist = DX * DX + DY * DY + DZ * DZ;
+				InOutBounds.SquareDistances[Idx] = SqrDist;
+
+				VisibleWord |= bOutside ? 0 : (1u << Bit);
+				InRangeWord |= (SqrDist < SqrRange) ? (1u << Bit) : 0;
+				InsideWord |= (std::abs(DX) <= EX && std::abs(DY) <= EY && std::abs(DZ) <= EZ) ? (1u << Bit) : 0;
+			}
+
+			InOutBounds.PreviousBits[WordIdx] = InOutBounds.VisibleBits[WordIdx] | InOutBounds.InRangeBits[WordIdx];
+			InOutBounds.VisibleBits[WordIdx] = VisibleWord;
+			InOutBounds.InRangeBits[WordIdx] = InRangeWord;
+			InOutBounds.CameraInsideBits[WordIdx] = InsideWord;
+		}
+	}
+
+	// 4 boxes per iteration
+	void CullBoundsSSE(const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd)
+	{
+		const __m128 SignMask = _mm_set1_ps(-0.0f);
+		__m128 NX[UHCullingPlanes::NumPlanes];
+		__m128 NY[UHCullingPlanes::NumPlanes];
+		__m128 NZ[UHCullingPlanes::NumPlanes];
+		__m128 ND[UHCullingPlanes::NumPlanes];
+		for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes; PlaneIdx++)
+		{
+			NX[PlaneIdx] = _mm_set1_ps(InPlanes.NormalX[PlaneIdx]);
+			NY[PlaneIdx] = _mm_set1_ps(InPlanes.NormalY[PlaneIdx]);
+			NZ[PlaneIdx] = _mm_set1_ps(InPlanes.NormalZ[PlaneIdx]);
+			ND[PlaneIdx] = _mm_set1_ps(InPlanes.Distance[PlaneIdx]);
+		}
+
+		const __m128 CamX = _mm_set1_ps(InCameraPos.x);
+		const __m128 CamY = _mm_set1_ps(InCameraPos.y);
+		const __m128 CamZ = _mm_set1_ps(InCameraPos.z);
+		const __m128 SqrRange = _mm_set1_ps(InRangeRadius * InRangeRadius);
+
+		for (int32_t WordIdx = InWordBegin; WordIdx < InWordEnd; WordIdx++)
+		{
+			uint32_t VisibleWord = 0;
+			uint32_t InRangeWord = 0;
+			uint32_t InsideWord = 0;
+
+			for (int32_t Bit = 0; Bit < UHCullingBounds::BoxesPerWord; Bit += 4)
+			{
+				const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + Bit;
+				const __m128 CX = _mm_loadu_ps(&InOutBounds.CenterX[Idx]);
+				const __m128 CY = _mm_loadu_ps(&InOutBounds.CenterY[Idx]);
+				const __m128 CZ = _mm_loadu_ps(&InOutBounds.CenterZ[Idx]);
+				const __m128 EX = _mm_loadu_ps(&InOutBounds.ExtentX[Idx]);
+				const __m128 EY = _mm_loadu_ps(&InOutBounds.ExtentY[Idx]);
+				const __m128 EZ = _mm_loadu_ps(&InOutBounds.ExtentZ[Idx]);
+
+				__m128 Outside = _mm_setzero_ps();
+				for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes; PlaneIdx++)
+				{
+					__m128 Dist = _mm_add_ps(_mm_mul_ps(NX[PlaneIdx], CX), _mm_mul_ps(NY[PlaneIdx], CY));
+					Dist = _mm_add_ps(_mm_add_ps(Dist, _mm_mul_ps(NZ[PlaneIdx], CZ)), ND[PlaneIdx]);
+
+					__m128 Radius = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(SignMask, NX[PlaneIdx]), EX), _mm_mul_ps(_mm_andnot_ps(SignMask, NY[PlaneIdx]), EY));
+					Radius = _mm_add_ps(Radius, _mm_mul_ps(_mm_andnot_ps(SignMask, NZ[PlaneIdx]), EZ));
+
+					Outside = _mm_or_ps(Outside, _mm_cmpgt_ps(Dist, Radius));
+				}
+
+				const __m128 DX = _mm_sub_ps(CX, CamX);
+				const __m128 DY = _mm_sub_ps(CY, CamY);
+				const __m128 DZ = _mm_sub_ps(CZ, CamZ);
+				const __m128 SqrDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(DX, DX), _mm_mul_ps(DY, DY)), _mm_mul_ps(DZ, DZ));
+				_mm_storeu_ps(&InOutBounds.SquareDistances[Idx], SqrDist);
+
+				__m128 Inside = _mm_cmple_ps(_mm_andnot_ps(SignMask, DX), EX);
+				Inside = _mm_and_ps(Inside, _mm_cmple_ps(_mm_andnot_ps(SignMask, DY), EY));
+				Inside = _mm_and_ps(Inside, _mm_cmple_ps(_mm_andnot_ps(SignMask, DZ), EZ));
+
+				VisibleWord |= static_cast<uint32_t>(~_mm_movemask_ps(Outside) & 0xf) << Bit;
+				InRangeWord |= static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(SqrDist, SqrRange))) << Bit;
+				InsideWord |= static_cast<uint32_t>(_mm_movemask_ps(Inside)) << Bit;
+			}
+
+			InOutBounds.PreviousBits[WordIdx] = InOutBounds.VisibleBits[WordIdx] | InOutBounds.InRangeBits[WordIdx];
+			InOutBounds.VisibleBits[WordIdx] = VisibleWord;
+			InOutBounds.InRangeBits[WordIdx] = InRangeWord;
+			InOutBounds.CameraInsideBits[WordIdx] = InsideWord;
+		}
+	}
+
+	// 8 boxes per iteration, only AVX float instructions are used so it doesn't require AVX2
+	UH_TARGET_AVX void CullBoundsAVX(const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd)
+	{
+		const __m256 SignMask = _mm256_set1_ps(-0.0f);
+		__m256 NX[UHCullingPlanes::NumPlanes];
+		__m256 NY[UHCullingPlanes::NumPlanes];
+		__m256 NZ[UHCullingPlanes::NumPlanes];
+		__m256 ND[UHCullingPlanes::NumPlanes];
+		for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes; PlaneIdx++)
+		{
+			NX[PlaneIdx] = _mm256_set1_ps(InPlanes.NormalX[PlaneIdx]);
+			NY[PlaneIdx] = _mm256_set1_ps(InPlanes.NormalY[PlaneIdx]);
+			NZ[PlaneIdx] = _mm256_set1_ps(InPlanes.NormalZ[PlaneIdx]);
+			ND[PlaneIdx] = _mm256_set1_ps(InPlanes.Distance[PlaneIdx]);
+		}
+
+		const __m256 CamX = _mm256_set1_ps(InCameraPos.x);
+		const __m256 CamY = _mm256_set1_ps(InCameraPos.y);
+		const __m256 CamZ = _mm256_set1_ps(InCameraPos.z);
+		const __m256 SqrRange = _mm256_set1_ps(InRangeRadius * InRangeRadius);
+
+		for (int32_t WordIdx = InWordBegin; WordIdx < InWordEnd; WordIdx++)
+		{
+			uint32_t VisibleWord = 0;
+			uint32_t InRangeWord = 0;
+			uint32_t InsideWord = 0;
+
+			for (int32_t Bit = 0; Bit < UHCullingBounds::BoxesPerWord; Bit += 8)
+			{
+				const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + Bit;
+				const __m256 CX = _mm256_loadu_ps(&InOutBounds.CenterX[Idx]);
+				const __m256 CY = _mm256_loadu_ps(&InOutBounds.CenterY[Idx]);
+				const __m256 CZ = _mm256_loadu_ps(&InOutBounds.CenterZ[Idx]);
+				const __m256 EX = _mm256_loadu_ps(&InOutBounds.ExtentX[Idx]);
+				const __m256 EY = _mm256_loadu_ps(&InOutBounds.ExtentY[Idx]);
+				const __m256 EZ = _mm256_loadu_ps(&InOutBounds.ExtentZ[Idx]);
+
+				__m256 Outside = _mm256_setzero_ps();
+				for (int32_t PlaneIdx = 0; PlaneIdx < UHCullingPlanes::NumPlanes; PlaneIdx++)
+				{
+					__m256 Dist = _mm256_add_ps(_mm256_mul_ps(NX[PlaneIdx], CX), _mm256_mul_ps(NY[PlaneIdx], CY));
+					Dist = _mm256_add_ps(_mm256_add_ps(Dist, _mm256_mul_ps(NZ[PlaneIdx], CZ)), ND[PlaneIdx]);
+
+					__m256 Radius = _mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(SignMask, NX[PlaneIdx]), EX), _mm256_mul_ps(_mm256_andnot_ps(SignMask, NY[PlaneIdx]), EY));
+					Radius = _mm256_add_ps(Radius, _mm256_mul_ps(_mm256_andnot_ps(SignMask, NZ[PlaneIdx]), EZ));
+
+					Outside = _mm256_or_ps(Outside, _mm256_cmp_ps(Dist, Radius, _CMP_GT_OQ));
+				}
+
+				const __m256 DX = _mm256_sub_ps(CX, CamX);
+				const __m256 DY = _mm256_sub_ps(CY, CamY);
+				const __m256 DZ = _mm256_sub_ps(CZ, CamZ);
+				const __m256 SqrDist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(DX, DX), _mm256_mul_ps(DY, DY)), _mm256_mul_ps(DZ, DZ));
+				_mm256_storeu_ps(&InOutBounds.SquareDistances[Idx], SqrDist);
+
+				__m256 Inside = _mm256_cmp_ps(_mm256_andnot_ps(SignMask, DX), EX, _CMP_LE_OQ);
+				Inside = _mm256_and_ps(Inside, _mm256_cmp_ps(_mm256_andnot_ps(SignMask, DY), EY, _CMP_LE_OQ));
+				Inside = _mm256_and_ps(Inside, _mm256_cmp_ps(_mm256_andnot_ps(SignMask, DZ), EZ, _CMP_LE_OQ));
+
+				VisibleWord |= static_cast<uint32_t>(~_mm256_movemask_ps(Outside) & 0xff) << Bit;
+				InRangeWord |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(SqrDist, SqrRange, _CMP_LT_OQ))) << Bit;
+				InsideWord |= static_cast<uint32_t>(_mm256_movemask_ps(Inside)) << Bit;
+			}
+
+			InOutBounds.PreviousBits[WordIdx] = InOutBounds.VisibleBits[WordIdx] | InOutBounds.InRangeBits[WordIdx];
+			InOutBounds.VisibleBits[WordIdx] = VisibleWord;
+			InOutBounds.InRangeBits[WordIdx] = InRangeWord;
+			InOutBounds.CameraInsideBits[WordIdx] = InsideWord;
+		}
+
+		// avoid the AVX-SSE transition penalty
+		_mm256_zeroupper();
+	}
+
+	void CullBounds(UHCullingSIMDLevel InLevel, const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius
+		, UHCullingBounds& InOutBounds, int32_t InWordBegin, int32_t InWordEnd)
+	{
+		InWordEnd = std::min(InWordEnd, InOutBounds.GetWordCount());
+		if (InWordBegin >= InWordEnd)
+		{
+			return;
+		}
+
+		switch (InLevel)
+		{
+		case UHCullingSIMDLevel::AVX:
+			CullBoundsAVX(InPlanes, InCameraPos, InRangeRadius, InOutBounds, InWordBegin, InWordEnd);
+			break;
+
+		case UHCullingSIMDLevel::SSE:
+			CullBoundsSSE(InPlanes, InCameraPos, InRangeRadius, InOutBounds, InWordBegin, InWordEnd);
+			break;
+
+		default:
+			CullBoundsScalar(InPlanes, InCameraPos, InRangeRadius, InOutBounds, InWordBegin, InWordEnd);
+			break;
+		}
+
+		// padded boxes are never visible
+		const int32_t LastWord = InOutBounds.GetWordCount() - 1;
+		const uint32_t Remainder = static_cast<uint32_t>(InOutBounds.GetCount() % UHCullingBounds::BoxesPerWord);
+		if (InWordEnd - 1 == LastWord && Remainder > 0)
+		{
+			const uint32_t ValidMask = (1u << Remainder) - 1;
+			InOutBounds.VisibleBits[LastWord] &= ValidMask;
+			InOutBounds.InRangeBits[LastWord] &= ValidMask;
+			InOutBounds.PreviousBits[LastWord] &= ValidMask;
+			InOutBounds.CameraInsideBits[LastWord] &= ValidMask;
+		}
+	}
+
+	void CullBounds(const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd)
+	{
+		CullBounds(GetSIMDLevel(), InPlanes, InCameraPos, InRangeRadius, InOutBounds, InWordBegin, InWordEnd);
+	}
+
+	void BeginQuery(UHCullingBounds& InOutBounds)
+	{
+		for (int32_t WordIdx = 0; WordIdx < InOutBounds.GetWordCount(); WordIdx++)
+		{
+			InOutBounds.PreviousBits[WordIdx] = InOutBounds.VisibleBits[WordIdx] | InOutBounds.InRangeBits[WordIdx];
+			InOutBounds.VisibleBits[WordIdx] = 0;
+			InOutBounds.InRangeBits[WordIdx] = 0;
+		}
+	}
+
+	void ResolveQuery(const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd)
+	{
+		InWordEnd = std::min(InWordEnd, InOutBounds.GetWordCount());
+		const float SqrRange = InRangeRadius * InRangeRadius;
+
+		for (int32_t WordIdx = InWordBegin; WordIdx < InWordEnd; WordIdx++)
+		{
+			// only the boxes which will be written back need the distance
+			uint32_t Bits = InOutBounds.VisibleBits[WordIdx] | InOutBounds.InRangeBits[WordIdx] | InOutBounds.PreviousBits[WordIdx];
+			uint32_t InRangeWord = 0;
+			uint32_t InsideWord = 0;
+
+			while (Bits != 0)
+			{
+				const int32_t Bit = MathHelpers::CountTrailingZeros(Bits);
+				const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + Bit;
+				Bits &= Bits - 1;
+
+				const float DX = InOutBounds.CenterX[Idx] - InCameraPos.x;
+				const float DY = InOutBounds.CenterY[Idx] - InCameraPos.y;
+				const float DZ = InOutBounds.CenterZ[Idx] - InCameraPos.z;
+				const float SqrDist = DX * DX + DY * DY + DZ * DZ;
+				InOutBounds.SquareDistances[Idx] = SqrDist;
+
+				InRangeWord |= (SqrDist < SqrRange) ? (1u << Bit) : 0;
+				InsideWord |= (std::abs(DX) <= InOutBounds.ExtentX[Idx] && std::abs(DY) <= InOutBounds.ExtentY[Idx]
+					&& std::abs(DZ) <= InOutBounds.ExtentZ[Idx]) ? (1u << Bit) : 0;
+			}
+
+			// the candidates from a hierarchy are tested with box, finalize them with the center distance as the linear kernels do
+			InOutBounds.InRangeBits[WordIdx] &= InRangeWord;
+			InOutBounds.CameraInsideBits[WordIdx] = InsideWord;
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+// structure-of-arrays bound storage used by frustum culling, indexed by the buffer data index of renderers
+// the storage is padded to a multiple of 32 boxes, so each uint32_t of visible bits maps to a fixed batch of boxes
+// and different words can be culled by different threads safely
+struct UHCullingBounds
+{
+	UHCullingBounds();
+
+	void Resize(size_t InCount);
+	void Clear();
+	void SetBound(int32_t InIdx, const BoundingBox& InBound);
+	BoundingBox GetBound(int32_t InIdx) const;
+
+	size_t GetCount() const;
+	int32_t GetWordCount() const;
+	bool IsVisible(int32_t InIdx) const;
+	bool IsInRange(int32_t InIdx) const;
+	bool IsCameraInside(int32_t InIdx) const;
+	float GetSquareDistance(int32_t InIdx) const;
+
+	static const int32_t BoxesPerWord = 32;
+
+	size_t Count;
+	std::vector<float> CenterX;
+	std::vector<float> CenterY;
+	std::vector<float> CenterZ;
+	std::vector<float> ExtentX;
+	std::vector<float> ExtentY;
+	std::vector<float> ExtentZ;
+
+	// culling results, a box is in range when its center is within the range radius to the camera (e.g. RT culling radius)
+	// previous bits are the visible or in-range boxes of last culling, the renderers of these boxes need to be notified even they're culled now
+	std::vector<float> SquareDistances;
+	std::vector<uint32_t> VisibleBits;
+	std::vector<uint32_t> InRangeBits;
+	std::vector<uint32_t> PreviousBits;
+	std::vector<uint32_t> CameraInsideBits;
+};
+
+// frustum planes in SoA layout, normals point outward as BoundingFrustum::GetPlanes() does
+struct UHCullingPlanes
+{
+	UHCullingPlanes();
+
+	static const int32_t NumPlanes = 6;
+	float NormalX[NumPlanes];
+	float NormalY[NumPlanes];
+	float NormalZ[NumPlanes];
+	float Distance[NumPlanes];
+};
+
+enum class UHCullingSIMDLevel
+{
+	Scalar = 0,
+	SSE,
+	AVX
+};
+
+namespace UHFrustumCulling
+{
+	UHCullingPlanes BuildPlanes(const BoundingFrustum& InFrustum);
+
+	// the best kernel supported by current CPU, it's detected once
+	UHCullingSIMDLevel GetSIMDLevel();
+
+	// plane/sphere tests shared by the linear kernels and the hierarchical queries
+	// return 1 when the box is fully outside, -1 when it's fully inside and 0 when it intersects the plane
+	int32_t ClassifyBox(const UHCullingPlanes& InPlanes, int32_t InPlaneIdx, const XMFLOAT3& InCenter, const XMFLOAT3& InExtent);
+	float SquareDistanceToBox(const XMFLOAT3& InPoint, const XMFLOAT3& InCenter, const XMFLOAT3& InExtent);
+
+	// cull the boxes in [InWordBegin * 32, InWordEnd * 32) against planes, a box is disjoint when it's fully outside any plane
+	// this matches BoundingFrustum::Contains(BoundingBox) != DISJOINT
+	void CullBounds(const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd);
+
+	// the same as above but with a specific kernel, mainly for validation and profiling
+	void CullBounds(UHCullingSIMDLevel InLevel, const UHCullingPlanes& InPlanes, const XMFLOAT3& InCameraPos, const float InRangeRadius
+		, UHCullingBounds& InOutBounds, int32_t InWordBegin, int32_t InWordEnd);
+
+	// hierarchical culling, call BeginQuery() before a hierarchy sets the visible bits and the in-range candidate bits
+	// then ResolveQuery() calculates the distances and finalizes in-range bits, it can be called per word range in parallel
+	void BeginQuery(UHCullingBounds& InOutBounds);
+	void ResolveQuery(const XMFLOAT3& InCameraPos, const float InRangeRadius, UHCullingBounds& InOutBounds
+		, int32_t InWordBegin, int32_t InWordEnd);
+}
@@ -5,106 +5,314 @@
 
 UHGPUMemory::UHGPUMemory()
 	: MemoryBudgetByte(0)
-	, BufferMemory(nullptr)
-    , CurrentOffset(0)
+	, BlockSizeByte(0)
+	, MemoryTypeIndex(0)
+	, BufferImageGranularity(1)
+	, bIsHostVisible(false)
+	, FirstResourceKind(UHGPUMemoryResourceKind::None)
 {
 
 }
 
 void UHGPUMemory::Release()
 {
-	vkFreeMemory(LogicalDevice, BufferMemory, nullptr);
+	for (UniquePtr<UHGPUMemoryBlock>& Block : Blocks)
+	{
+		if (Block->Memory == nullptr)
+		{
+			continue;
+		}
+
+		if (Block->MappedData != nullptr)
+		{
+			vkUnmapMemory(LogicalDevice, Block->Memory);
+		}
+		vkFreeMemory(LogicalDevice, Block->Memory, nullptr);
+	}
+	Blocks.clear();
 }
 
 void UHGPUMemory::AllocateMemory(uint64_t InBudget, uint32_t MemTypeIndex)
 {
-    MemoryBudgetByte = InBudget;
-    const VkPhysicalDeviceMemoryProperties& DeviceMemoryProperties = GfxCache->GetDeviceMemProps();
-    if (MemoryBudgetByte > DeviceMemoryProperties.memoryHeaps[MemTypeIndex].size && DeviceMemoryProperties.memoryHeaps[MemTypeIndex].size != 0)
-    {
-        MemoryBudgetByte = DeviceMemoryProperties.memoryHeaps[MemTypeIndex].size;
-    }
-
-    VkMemoryAllocateInfo AllocInfo{};
-    AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    AllocInfo.allocationSize = MemoryBudgetByte;
-    AllocInfo.memoryTypeIndex = MemTypeIndex;
-
-    VkMemoryAllocateFlagsInfo MemFlagInfo{};
-    MemFlagInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-    MemFlagInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
-
-    // allocate with device address anyway, this memory is going to be used with different source
-    AllocInfo.pNext = &MemFlagInfo;
-
-    if (vkAllocateMemory(LogicalDevice, &AllocInfo, nullptr, &BufferMemory) != VK_SUCCESS)
-    {
-        UHE_LOG(L"Failed to allocate buffer memory!\n");
-    }
+	MemoryTypeIndex = MemTypeIndex;
+	MemoryBudgetByte = InBudget;
+
+	const VkPhysicalDeviceMemoryProperties DeviceMemoryProperties = GfxCache->GetDeviceMemProps();
+	const VkMemoryType& MemoryType = DeviceMemoryProperties.memoryTypes[MemTypeIndex];
+	const uint64_t HeapSize = DeviceMemoryProperties.memoryHeaps[MemoryType.heapIndex].size;
+	if (MemoryBudgetByte > HeapSize && HeapSize != 0)
+	{
+		MemoryBudgetByte = HeapSize;
+	}
+
+	BlockSizeByte = (std::min)(MemoryBudgetByte, DefaultBlockSize);
+	bIsHostVisible = (MemoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+	VkPhysicalDeviceProperties DeviceProperties{};
+	vkGetPhysicalDeviceProperties(GfxCache->GetPhysicalDevice(), &DeviceProperties);
+	BufferImageGranularity = (std::max)(DeviceProperties.limits.bufferImageGranularity, static_cast<VkDeviceSize>(1));
+
+	// the first block is allocated up front, the others are allocated once the existing blocks are full
+	AllocateBlock();
+}
+
+UHGPUMemoryAllocation UHGPUMemory::BindMemory(const VkMemoryRequirements& InRequirements, VkBuffer InBuffer, UHGPUMemoryClient* InClient)
+{
+	UHGPUMemoryAllocation Allocation = Allocate(InRequirements, UHGPUMemoryResourceKind::Buffer, InClient != nullptr);
+	if (!Allocation.IsValid())
+	{
+		return Allocation;
+	}
+
+	if (vkBindBufferMemory(LogicalDevice, InBuffer, Allocation.Memory, Allocation.Offset) != VK_SUCCESS)
+	{
+		FreeMemory(Allocation);
+		return Allocation;
+	}
+
+	if (InClient != nullptr)
+	{
+		Blocks[Allocation.BlockIndex]->Clients[Allocation.Offset] = InClient;
+	}
+
+	// return the allocation so the object knows where to manipulate
+	return Allocation;
+}
+
+UHGPUMemoryAllocation UHGPUMemory::BindMemory(const VkMemoryRequirements& InRequirements, VkImage InImage)
+{
+	// images are never moved, as the image views and descriptors would need to be recreated
+	UHGPUMemoryAllocation Allocation = Allocate(InRequirements, UHGPUMemoryResourceKind::Image, false);
+	if (!Allocation.IsValid())
+	{
+		return Allocation;
+	}
+
+	if (vkBindImageMemory(LogicalDevice, InImage, Allocation.Memory, Allocation.Offset) != VK_SUCCESS)
+	{
+		FreeMemory(Allocation);
+	}
+
+	return Allocation;
+}
+
+void UHGPUMemory::FreeMemory(UHGPUMemoryAllocation& InAllocation)
+{
+	if (!InAllocation.IsValid())
+	{
+		return;
+	}
+
+	UHGPUMemoryBlock* Block = Blocks[InAllocation.BlockIndex].get();
+	Block->Allocator.Free(InAllocation.Offset);
+	Block->Clients.erase(InAllocation.Offset);
+	InAllocation = UHGPUMemoryAllocation();
+
+	// give an empty block back to the driver unless it's the last one
+	if (Block->Allocator.IsEmpty())
+	{
+		int32_t NumLiveBlocks = 0;
+		for (const UniquePtr<UHGPUMemoryBlock>& LiveBlock : Blocks)
+		{
+			NumLiveBlocks += (LiveBlock->Memory != nullptr) ? 1 : 0;
+		}
+
+		if (NumLiveBlocks > 1)
+		{
+			if (Block->MappedData != nullptr)
+			{
+				vkUnmapMemory(LogicalDevice, Block->Memory);
+			}
+			vkFreeMemory(LogicalDevice, Block->Memory, nullptr);
+			Block->Memory = nullptr;
+			Block->MappedData = nullptr;
+			Block->Allocator.Initialize(0);
+		}
+	}
+}
+
+uint32_t UHGPUMemory::Defragment(uint32_t InMaxMoves)
+{
+	// only host visible memory can be copied here, device local memory would need transfer commands
+	if (!bIsHostVisible)
+	{
+		return 0;
+	}
+
+	uint32_t NumMoves = 0;
+	for (size_t BlockIdx = 0; BlockIdx < Blocks.size() && NumMoves < InMaxMoves; BlockIdx++)
+	{
+		UHGPUMemoryBlock* Block = Blocks[BlockIdx].get();
+		if (Block->MappedData == nullptr)
+		{
+			continue;
+		}
+
+		// the moves are in ascending order and always move down, copying them in order won't overwrite the data not moved yet
+		Block->Allocator.Defragment(InMaxMoves - NumMoves, DefragmentMoves);
+		for (const UHTLSFMove& Move : DefragmentMoves)
+		{
+			memmove(Block->MappedData + Move.DstOffset, Block->MappedData + Move.SrcOffset, Move.Size);
+
+			UHGPUMemoryClient* Client = Block->Clients[Move.SrcOffset];
+			Block->Clients.erase(Move.SrcOffset);
+			Block->Clients[Move.DstOffset] = Client;
+
+			UHGPUMemoryAllocation NewAllocation;
+			NewAllocation.Memory = Block->Memory;
+			NewAllocation.Offset = Move.DstOffset;
+			NewAllocation.Size = Move.Size;
+			NewAllocation.BlockIndex = static_cast<int32_t>(BlockIdx);
+			Client->OnMemoryMoved(NewAllocation);
+		}
+
+		NumMoves += static_cast<uint32_t>(DefragmentMoves.size());
+	}
+
+	return NumMoves;
+}
+
+uint8_t* UHGPUMemory::GetMappedData(const UHGPUMemoryAllocation& InAllocation) const
+{
+	if (!InAllocation.IsValid() || Blocks[InAllocation.BlockIndex]->MappedData == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Blocks[InAllocation.BlockIndex]->MappedData + InAllocation.Offset;
 }
 
-void UHGPUMemory::Reset()
+uint64_t UHGPUMemory::GetUsedSize() const
 {
-    CurrentOffset = 0;
+	uint64_t UsedSize = 0;
+	for (const UniquePtr<UHGPUMemoryBlock>& Block : Blocks)
+	{
+		UsedSize += Block->Allocator.GetUsedSize();
+	}
+
+	return UsedSize;
 }
 
-uint64_t UHGPUMemory::BindMemory(uint64_t InSize, uint64_t InAlignment, VkBuffer InBuffer)
+uint64_t UHGPUMemory::GetAllocatedSize() const
 {
-    // make the size is always the multiple of alignment
-    if ((InSize % InAlignment) != 0)
-    {
-        const uint64_t Stride = InSize / InAlignment;
-        InSize = InAlignment * (Stride + 1);
-    }
-
-    if (CurrentOffset + InSize > MemoryBudgetByte)
-    {
-        return ~0;
-    }
-
-    if (vkBindBufferMemory(LogicalDevice, InBuffer, BufferMemory, CurrentOffset) != VK_SUCCESS)
-    {
-        return ~0;
-    }
-
-    uint64_t StartOffset = CurrentOffset;
-    CurrentOffset += InSize;
-
-    // return start offset so the object knows where to manipulate
-    return StartOffset;
+	uint64_t AllocatedSize = 0;
+	for (const UniquePtr<UHGPUMemoryBlock>& Block : Blocks)
+	{
+		AllocatedSize += Block->Allocator.GetSize();
+	}
+
+	return AllocatedSize;
 }
 
-uint64_t UHGPUMemory::BindMemory(uint64_t InSize, uint64_t InAlignment, VkImage InImage, uint64_t ReboundOffset)
+UHGPUMemoryAllocation UHGPUMemory::Allocate(const VkMemoryRequirements& InRequirements, UHGPUMemoryResourceKind InKind, bool bIsMovable)
 {
-    uint64_t StartOffset = (ReboundOffset != UINT64_MAX) ? ReboundOffset : CurrentOffset;
-
-    // make the size is always the multiple of alignment
-    if ((InSize % InAlignment) != 0)
-    {
-        const uint64_t Stride = InSize / InAlignment;
-        InSize = InAlignment * (Stride + 1);
-    }
-
-    if (StartOffset + InSize > MemoryBudgetByte)
-    {
-        return ~0;
-    }
-
-    if (vkBindImageMemory(LogicalDevice, InImage, BufferMemory, StartOffset) != VK_SUCCESS)
-    {
-        return ~0;
-    }
-
-    if (ReboundOffset == UINT64_MAX)
-    {
-        CurrentOffset += InSize;
-    }
-
-    // return start offset so the object knows where to manipulate
-    return StartOffset;
+	// the resource must support the memory type of this pool
+	if ((InRequirements.memoryTypeBits & (1u << MemoryTypeIndex)) == 0)
+	{
+		return UHGPUMemoryAllocation();
+	}
+
+	// a resource of the other kind is aligned and padded to the granularity, so it never shares a page with its neighbors
+	if (FirstResourceKind == UHGPUMemoryResourceKind::None)
+	{
+		FirstResourceKind = InKind;
+	}
+
+	uint64_t Size = InRequirements.size;
+	uint64_t Alignment = InRequirements.alignment;
+	if (InKind != FirstResourceKind)
+	{
+		Alignment = (std::max)(Alignment, BufferImageGranularity);
+		Size = (Size + BufferImageGranularity - 1) / BufferImageGranularity * BufferImageGranularity;
+	}
+
+	// try the existing blocks first, then a new block if the budget still allows
+	for (int32_t Attempt = 0; Attempt < 2; Attempt++)
+	{
+		for (size_t BlockIdx = 0; BlockIdx < Blocks.size(); BlockIdx++)
+		{
+			UHGPUMemoryBlock* Block = Blocks[BlockIdx].get();
+			if (Block->Memory == nullptr)
+			{
+				continue;
+			}
+
+			const uint64_t Offset = Block->Allocator.Allocate(Size, Alignment, bIsMovable);
+			if (Offset != UHTLSFAllocator::InvalidOffset)
+			{
+				UHGPUMemoryAllocation Allocation;
+				Allocation.Memory = Block->Memory;
+				Allocation.Offset = Offset;
+				Allocation.Size = Block->Allocator.GetAllocationSize(Offset);
+				Allocation.BlockIndex = static_cast<int32_t>(BlockIdx);
+				return Allocation;
+			}
+		}
+
+		if (Size > BlockSizeByte || !AllocateBlock())
+		{
+			break;
+		}
+	}
+
+	return UHGPUMemoryAllocation();
 }
 
-VkDeviceMemory UHGPUMemory::GetMemory() const
+bool UHGPUMemory::AllocateBlock()
 {
-    return BufferMemory;
+	const uint64_t BlockSize = (std::min)(BlockSizeByte, MemoryBudgetByte - GetAllocatedSize());
+	if (BlockSize < UHTLSFAllocator::MinBlockSize)
+	{
+		return false;
+	}
+
+	VkMemoryAllocateInfo AllocInfo{};
+	AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	AllocInfo.allocationSize = BlockSize;
+	AllocInfo.memoryTypeIndex = MemoryTypeIndex;
+
+	VkMemoryAllocateFlagsInfo MemFlagInfo{};
+	MemFlagInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+	MemFlagInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+	// allocate with device address anyway, this memory is going to be used with different source
+	AllocInfo.pNext = &MemFlagInfo;
+
+	VkDeviceMemory Memory = nullptr;
+	if (vkAllocateMemory(LogicalDevice, &AllocInfo, nullptr, &Memory) != VK_SUCCESS)
+	{
+		UHE_LOG(L"Failed to allocate GPU memory block!\n");
+		return false;
+	}
+
+	// host visible blocks stay mapped, so uploading and defragmentation don't need to map again
+	uint8_t* MappedData = nullptr;
+	if (bIsHostVisible && vkMapMemory(LogicalDevice, Memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&MappedData)) != VK_SUCCESS)
+	{
+		MappedData = nullptr;
+	}
+
+	// reuse the slot of a released block, the block index of existing allocations must stay the same
+	UHGPUMemoryBlock* Block = nullptr;
+	for (UniquePtr<UHGPUMemoryBlock>& FreeSlot : Blocks)
+	{
+		if (FreeSlot->Memory == nullptr)
+		{
+			Block = FreeSlot.get();
+			break;
+		}
+	}
+
+	if (Block == nullptr)
+	{
+		Blocks.push_back(MakeUnique<UHGPUMemoryBlock>());
+		Block = Blocks.back().get();
+	}
+
+	Block->Memory = Memory;
+	Block->MappedData = MappedData;
+	Block->Allocator.Initialize(BlockSize);
+	Block->Clients.clear();
+
+	return true;
 }
\ No newline at end of file
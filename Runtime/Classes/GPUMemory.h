@@ -2,28 +2,98 @@
 #define VK_USE_PLATFORM_WIN32_KHR
 #include <vulkan/vulkan.h>
 #include "../Engine/RenderResource.h"
+#include "Types.h"
+#include "TLSFAllocator.h"
+#include <unordered_map>
 
 class UHGraphic;
 
-// UH GPU memory class for mananing VkDeviceMemory
-// a good usage of VkDeviceMemory should be creating a large one and share use it when possible
-// and this hasn't considered reallocation yet! it's used during lifetime for now
+// a range of UHGPUMemory, it's invalid if the shared memory can't fit it
+struct UHGPUMemoryAllocation
+{
+	UHGPUMemoryAllocation()
+		: Memory(nullptr)
+		, Offset(UHTLSFAllocator::InvalidOffset)
+		, Size(0)
+		, BlockIndex(UHINDEXNONE)
+	{
+
+	}
+
+	bool IsValid() const
+	{
+		return BlockIndex != UHINDEXNONE;
+	}
+
+	VkDeviceMemory Memory;
+	uint64_t Offset;
+	uint64_t Size;
+	int32_t BlockIndex;
+};
+
+// owner of a movable allocation, it recreates its resource at the new allocation after defragmentation copied the data
+class UHGPUMemoryClient
+{
+public:
+	virtual void OnMemoryMoved(const UHGPUMemoryAllocation& InNewAllocation) = 0;
+};
+
+// UH GPU memory class for mananing VkDeviceMemory of a memory type
+// the memory is allocated in large blocks on demand until the budget is reached, and each block is sub-allocated with a TLSF allocator.
+// a resource of a different kind than the first one (buffer vs. image) takes whole bufferImageGranularity pages,
+// so linear and optimal resources never share a page
 class UHGPUMemory : public UHRenderResource
 {
 public:
 	UHGPUMemory();
 	void Release();
 	void AllocateMemory(uint64_t InBudget, uint32_t MemTypeIndex);
-	void Reset();
 
-	uint64_t BindMemory(uint64_t InSize, uint64_t InAlignment, VkBuffer InBuffer);
-	uint64_t BindMemory(uint64_t InSize, uint64_t InAlignment, VkImage InImage, uint64_t ReboundOffset = ~0);
-	VkDeviceMemory GetMemory() const;
+	// returns an invalid allocation if it doesn't fit, the caller should allocate the memory individually in that case
+	// a buffer with a client can be moved by defragmentation
+	UHGPUMemoryAllocation BindMemory(const VkMemoryRequirements& InRequirements, VkBuffer InBuffer, UHGPUMemoryClient* InClient = nullptr);
+	UHGPUMemoryAllocation BindMemory(const VkMemoryRequirements& InRequirements, VkImage InImage);
+	void FreeMemory(UHGPUMemoryAllocation& InAllocation);
+
+	// compacts the host visible blocks by copying, returns the number of moved allocations
+	// it must be called while the GPU is idle, and the descriptors of moved buffers need to be rewritten after this,
+	// e.g. at scene loading before the renderer binds everything again
+	uint32_t Defragment(uint32_t InMaxMoves);
+
+	// persistently mapped address of an allocation, only available for host visible memory
+	uint8_t* GetMappedData(const UHGPUMemoryAllocation& InAllocation) const;
+	uint64_t GetUsedSize() const;
+	uint64_t GetAllocatedSize() const;
 
 private:
+	struct UHGPUMemoryBlock
+	{
+		VkDeviceMemory Memory;
+		uint8_t* MappedData;
+		UHTLSFAllocator Allocator;
+		std::unordered_map<uint64_t, UHGPUMemoryClient*> Clients;
+	};
+
+	enum class UHGPUMemoryResourceKind
+	{
+		None,
+		Buffer,
+		Image
+	};
+
+	UHGPUMemoryAllocation Allocate(const VkMemoryRequirements& InRequirements, UHGPUMemoryResourceKind InKind, bool bIsMovable);
+	bool AllocateBlock();
+
 	uint64_t MemoryBudgetByte;
-	VkDeviceMemory BufferMemory;
+	uint64_t BlockSizeByte;
+	uint32_t MemoryTypeIndex;
+	uint64_t BufferImageGranularity;
+	bool bIsHostVisible;
+	UHGPUMemoryResourceKind FirstResourceKind;
+
+	std::vector<UniquePtr<UHGPUMemoryBlock>> Blocks;
+	std::vector<UHTLSFMove> DefragmentMoves;
 
-	// start from 0, if an object is bound, this will increase
-	uint64_t CurrentOffset;
+	// a block is allocated with this size unless the budget is smaller
+	static const uint64_t DefaultBlockSize = 256ull * 1048576;
 };
\ No newline at end of file
@@ -1,10 +1,9 @@
 #include "GPUQuery.h"
 #include "../Engine/Graphic.h"
+#include "../Renderer/RenderBuilder.h"
+#include "Utility.h"
 
 #if WITH_EDITOR
-std::mutex GGPUTimeScopeLock;
-std::vector<UHGPUQuery*> UHGPUTimeQueryScope::RegisteredGPUTime;
-
 std::string GetQueryTypeName(VkQueryType InType)
 {
 	switch (InType)
@@ -22,11 +21,7 @@ std::string GetQueryTypeName(VkQueryType InType)
 
 UHGPUQuery::UHGPUQuery()
 	: QueryCount(0)
-	, State(UHGPUQueryState::Idle)
 	, QueryPool(nullptr)
-#if WITH_EDITOR
-	, PreviousValidTimeStamp(0)
-#endif
 {
 
 }
@@ -40,10 +35,10 @@ void UHGPUQuery::CreateQueryPool(uint32_t InQueryCount, VkQueryType QueryType)
 {
 	QueryCount = InQueryCount;
 
-	// force query count to 2 if it's time stamp
+	// a time stamp pool needs at least a begin and an end
 	if (QueryType == VK_QUERY_TYPE_TIMESTAMP)
 	{
-		QueryCount = 2;
+		QueryCount = (std::max)(QueryCount, 2U);
 	}
 
 	VkQueryPoolCreateInfo CreateInfo{};
@@ -62,131 +57,185 @@ void UHGPUQuery::CreateQueryPool(uint32_t InQueryCount, VkQueryType QueryType)
 #endif
 }
 
-void UHGPUQuery::BeginTimeStamp(VkCommandBuffer InBuffer)
+VkQueryPool UHGPUQuery::GetQueryPool() const
 {
-#if WITH_EDITOR
-	if (!GEnableGPUTiming)
+	return QueryPool;
+}
+
+uint32_t UHGPUQuery::GetQueryCount() const
+{
+	return QueryCount;
+}
+
+UHGPUTimelineRecorder::UHGPUTimelineRecorder()
+	: Gfx(nullptr)
+	, Timeline(nullptr)
+	, QueueIndex(0)
+	, FrameIndex(0)
+	, bIsRecording(false)
+{
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		QueryPools[Idx] = nullptr;
+		NumQueries[Idx] = 0;
+		SubmitTimes[Idx] = 0;
+	}
+}
+
+void UHGPUTimelineRecorder::Initialize(UHGraphic* InGfx, UHGPUTimeline* InTimeline, const std::string& InQueueName, uint32_t InQueueFamily)
+{
+	const uint32_t ValidBits = InGfx->GetTimestampValidBits(InQueueFamily);
+	if (ValidBits == 0)
 	{
+		UHE_LOG(L"Timestamps aren't supported on " + UHUtilities::ToStringW(InQueueName) + L", it won't be in GPU timeline.\n");
 		return;
 	}
 
-	if (State == UHGPUQueryState::Idle)
+	Gfx = InGfx;
+	Timeline = InTimeline;
+	QueueIndex = Timeline->AddQueue(InQueueName, Gfx->GetGPUTimeStampPeriod(), ValidBits, UHCPUProfiler::GetSecondsPerCount());
+
+	// a begin and an end per scope
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
-		vkResetQueryPool(LogicalDevice, QueryPool, 0, QueryCount);
-		vkCmdWriteTimestamp(InBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, QueryPool, 0);
+		QueryPools[Idx] = Gfx->RequestGPUQuery(MaxScopesPerFrame * 2, VK_QUERY_TYPE_TIMESTAMP);
+		RecordedScopes[Idx].reserve(MaxScopesPerFrame);
 	}
-#endif
+	QueryResults.resize(MaxScopesPerFrame * 4);
 }
 
-void UHGPUQuery::EndTimeStamp(VkCommandBuffer InBuffer)
+void UHGPUTimelineRecorder::Release()
 {
-#if WITH_EDITOR
-	if (!GEnableGPUTiming)
+	if (Gfx == nullptr)
 	{
 		return;
 	}
 
-	if (State == UHGPUQueryState::Idle)
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
-		vkCmdWriteTimestamp(InBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, QueryPool, 1);
-		State = UHGPUQueryState::Requested;
+		Gfx->RequestReleaseGPUQuery(QueryPools[Idx]);
+		QueryPools[Idx] = nullptr;
+		RecordedScopes[Idx].clear();
+		NumQueries[Idx] = 0;
 	}
-#endif
+
+	Gfx = nullptr;
+	Timeline = nullptr;
+	bIsRecording = false;
 }
 
-void UHGPUQuery::ResolveTimeStamp(VkCommandBuffer InBuffer)
+void UHGPUTimelineRecorder::BeginFrame(VkCommandBuffer InCmd, uint32_t InFrameIndex, bool bInEnabled)
 {
-#if WITH_EDITOR
-	if (!GEnableGPUTiming)
+	FrameIndex = InFrameIndex;
+	ScopeStack.clear();
+	if (Timeline == nullptr)
 	{
+		bIsRecording = false;
 		return;
 	}
 
-	// try getting time stamp after request
-	if (State == UHGPUQueryState::Requested)
-	{
-		uint32_t Queries[3] = { 0 };
+	ResolveFrame(InFrameIndex);
 
-		if (vkGetQueryPoolResults(LogicalDevice, QueryPool, 0, QueryCount, 3 * sizeof(uint32_t), &Queries, sizeof(uint32_t), VK_QUERY_RESULT_WITH_AVAILABILITY_BIT)
-			== VK_SUCCESS)
+	bIsRecording = bInEnabled;
+	if (bIsRecording)
+	{
+		// sample the clocks once per frame, so the mapping follows the drift
+		uint64_t GPUTick = 0;
+		int64_t CPUTime = 0;
+		uint64_t MaxDeviation = 0;
+		if (Gfx->GetCalibratedTimestamp(GPUTick, CPUTime, MaxDeviation))
 		{
-			// get data successfully, calculate time period and return
-			// also set state to Idle for next request
-			float Duration = static_cast<float>(Queries[1] - Queries[0]) * GfxCache->GetGPUTimeStampPeriod() * 1e-6f;
-			State = UHGPUQueryState::Idle;
-			PreviousValidTimeStamp = Duration;
+			Timeline->AddCalibrationSample(QueueIndex, GPUTick, CPUTime, MaxDeviation);
 		}
+
+		vkCmdResetQueryPool(InCmd, QueryPools[FrameIndex]->GetQueryPool(), 0, MaxScopesPerFrame * 2);
 	}
-#endif
 }
 
-VkQueryPool UHGPUQuery::GetQueryPool() const
+void UHGPUTimelineRecorder::EndFrame()
 {
-	return QueryPool;
+	SubmitTimes[FrameIndex] = bIsRecording ? UHCPUProfiler::GetTimeStamp() : 0;
 }
 
-uint32_t UHGPUQuery::GetQueryCount() const
+void UHGPUTimelineRecorder::BeginScope(VkCommandBuffer InCmd, const char* InName)
 {
-	return QueryCount;
-}
+	if (!bIsRecording || NumQueries[FrameIndex] + 2 > MaxScopesPerFrame * 2)
+	{
+		ScopeStack.push_back(UHINDEXNONE);
+		return;
+	}
 
-#if WITH_EDITOR
-void UHGPUQuery::SetDebugName(const std::string& InName)
-{
-	Name = InName;
-}
+	const uint32_t Query = NumQueries[FrameIndex];
+	NumQueries[FrameIndex] += 2;
+	vkCmdWriteTimestamp(InCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, QueryPools[FrameIndex]->GetQueryPool(), Query);
 
-std::string UHGPUQuery::GetDebugName() const
-{
-	return Name;
+	std::vector<UHRecordedScope>& Scopes = RecordedScopes[FrameIndex];
+	const uint32_t Depth = static_cast<uint32_t>(ScopeStack.size());
+	ScopeStack.push_back(static_cast<int32_t>(Scopes.size()));
+	Scopes.push_back(UHRecordedScope{ InName, Depth, Query, Query + 1 });
 }
 
-float UHGPUQuery::GetLastTimeStamp() const
+void UHGPUTimelineRecorder::EndScope(VkCommandBuffer InCmd)
 {
-	return PreviousValidTimeStamp;
+	const int32_t ScopeIdx = ScopeStack.back();
+	ScopeStack.pop_back();
+	if (ScopeIdx != UHINDEXNONE)
+	{
+		vkCmdWriteTimestamp(InCmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, QueryPools[FrameIndex]->GetQueryPool(), RecordedScopes[FrameIndex][ScopeIdx].EndQuery);
+	}
 }
-#endif
 
-UHGPUTimeQueryScope::UHGPUTimeQueryScope(VkCommandBuffer InCmd, UHGPUQuery* InQuery, std::string InName)
+void UHGPUTimelineRecorder::ResolveFrame(uint32_t InFrameIndex)
 {
-#if WITH_EDITOR
-	Cmd = InCmd;
-	GPUTimeQuery = InQuery;
-
-	if (GPUTimeQuery)
+	std::vector<UHRecordedScope>& Scopes = RecordedScopes[InFrameIndex];
+	const uint32_t QueryCount = NumQueries[InFrameIndex];
+	if (Scopes.size() > 0)
 	{
-		GPUTimeQuery->BeginTimeStamp(Cmd);
-		GPUTimeQuery->SetDebugName(InName);
+		// 64-bit values with availability, a scope missing either timestamp is dropped
+		const VkResult Result = vkGetQueryPoolResults(Gfx->GetLogicalDevice(), QueryPools[InFrameIndex]->GetQueryPool(), 0, QueryCount
+			, QueryCount * 2 * sizeof(uint64_t), QueryResults.data(), 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
 
-		// add to registered list for profiling display
-		std::unique_lock<std::mutex> Lock(GGPUTimeScopeLock);
-		RegisteredGPUTime.push_back(GPUTimeQuery);
+		if (Result == VK_SUCCESS || Result == VK_NOT_READY)
+		{
+			ResolvedScopes.clear();
+			for (const UHRecordedScope& Scope : Scopes)
+			{
+				const uint64_t* Begin = &QueryResults[Scope.BeginQuery * 2];
+				const uint64_t* End = &QueryResults[Scope.EndQuery * 2];
+				if (Begin[1] != 0 && End[1] != 0)
+				{
+					ResolvedScopes.push_back(UHGPUTimelineScope{ Scope.Name, Scope.Depth, Begin[0], End[0] });
+				}
+			}
+
+			// without calibrated timestamps, the first timestamp of the submission bounds the clock offset
+			if (ResolvedScopes.size() > 0 && SubmitTimes[InFrameIndex] != 0 && !Gfx->IsCalibratedTimestampSupported())
+			{
+				Timeline->AddSubmitBound(QueueIndex, ResolvedScopes[0].BeginTick, SubmitTimes[InFrameIndex]);
+			}
+			Timeline->SubmitFrame(QueueIndex, ResolvedScopes);
+		}
 	}
-#endif
+
+	Scopes.clear();
+	NumQueries[InFrameIndex] = 0;
+	SubmitTimes[InFrameIndex] = 0;
 }
 
 UHGPUTimeQueryScope::~UHGPUTimeQueryScope()
 {
-#if WITH_EDITOR
-	if (GPUTimeQuery)
+	if (Recorder)
 	{
-		GPUTimeQuery->EndTimeStamp(Cmd);
+		Recorder->EndScope(Cmd);
 	}
-#endif
 }
 
-const std::vector<UHGPUQuery*>& UHGPUTimeQueryScope::GetResiteredGPUTime()
+void UHGPUTimeQueryScope::Begin(UHRenderBuilder& InBuilder, const char* InName)
 {
-#if WITH_EDITOR
-	std::unique_lock<std::mutex> Lock(GGPUTimeScopeLock);
-	return RegisteredGPUTime;
-#endif
+	Recorder = InBuilder.GetGPUTimelineRecorder();
+	if (Recorder)
+	{
+		Cmd = InBuilder.GetCmdList();
+		Recorder->BeginScope(Cmd, InName);
+	}
 }
-
-void UHGPUTimeQueryScope::ClearRegisteredGPUTime()
-{
-#if WITH_EDITOR
-	std::unique_lock<std::mutex> Lock(GGPUTimeScopeLock);
-	RegisteredGPUTime.clear();
-#endif
-}
\ No newline at end of file
@@ -2,12 +2,8 @@
 #include "../../UnheardEngine.h"
 #include "../Engine/RenderResource.h"
 #include "RenderBuffer.h"
-
-enum class UHGPUQueryState
-{
-	Idle = 0,
-	Requested
-};
+#include "GPUTimeline.h"
+#include "../Renderer/RenderingTypes.h"
 
 // UH GPU Query object
 class UHGPUQuery : public UHRenderResource
@@ -17,47 +13,86 @@ public:
 	void Release();
 	void CreateQueryPool(uint32_t QueryCount, VkQueryType QueryType);
 
-	void BeginTimeStamp(VkCommandBuffer InBuffer);
-	void EndTimeStamp(VkCommandBuffer InBuffer);
-	void ResolveTimeStamp(VkCommandBuffer InBuffer);
-
 	VkQueryPool GetQueryPool() const;
 	uint32_t GetQueryCount() const;
 
-#if WITH_EDITOR
-	void SetDebugName(const std::string& InName);
-	std::string GetDebugName() const;
-	float GetLastTimeStamp() const;
-#endif
-
 private:
 	uint32_t QueryCount;
-	UHGPUQueryState State;
 	VkQueryPool QueryPool;
+};
+
+class UHRenderBuilder;
+
+// records GPU timeline scopes of a queue and feeds the resolved scopes to UHGPUTimeline
+// each frame in flight has its own timestamp pool, a pool is read back when its frame index is reused,
+// which is after the fence of that frame is waited, so reading never stalls
+class UHGPUTimelineRecorder
+{
+public:
+	UHGPUTimelineRecorder();
+	void Initialize(UHGraphic* InGfx, UHGPUTimeline* InTimeline, const std::string& InQueueName, uint32_t InQueueFamily);
+	void Release();
+
+	// call after the fence of the frame is waited and the command buffer begins, it resolves the previous scopes of this frame index
+	void BeginFrame(VkCommandBuffer InCmd, uint32_t InFrameIndex, bool bInEnabled);
 
-#if WITH_EDITOR
-	std::string DebugName;
-	float PreviousValidTimeStamp;
-#endif
+	// call right before submitting the command buffer
+	void EndFrame();
+
+	void BeginScope(VkCommandBuffer InCmd, const char* InName);
+	void EndScope(VkCommandBuffer InCmd);
+
+	static const uint32_t MaxScopesPerFrame = 256;
+
+private:
+	struct UHRecordedScope
+	{
+		const char* Name;
+		uint32_t Depth;
+		uint32_t BeginQuery;
+		uint32_t EndQuery;
+	};
+
+	void ResolveFrame(uint32_t InFrameIndex);
+
+	UHGraphic* Gfx;
+	UHGPUTimeline* Timeline;
+	uint32_t QueueIndex;
+	uint32_t FrameIndex;
+	bool bIsRecording;
+
+	UHGPUQuery* QueryPools[GMaxFrameInFlight];
+	std::vector<UHRecordedScope> RecordedScopes[GMaxFrameInFlight];
+	uint32_t NumQueries[GMaxFrameInFlight];
+	int64_t SubmitTimes[GMaxFrameInFlight];
+
+	// indices of open scopes, UHINDEXNONE for scopes that are skipped when the pool is full
+	std::vector<int32_t> ScopeStack;
+	std::vector<uint64_t> QueryResults;
+	std::vector<UHGPUTimelineScope> ResolvedScopes;
 };
 
-// timestamp query scope version, this simply kicks off timer in ctor and finishs in dtor
-// can be used with macro to maintain a clean code
+// GPU timeline scope, this simply writes the begin timestamp in ctor and the end timestamp in dtor
+// names must be string literals as they're the ids of scope histories, nothing is written when the builder has no recorder
 class UHGPUTimeQueryScope
 {
 public:
-	UHGPUTimeQueryScope(VkCommandBuffer InCmd, UHGPUQuery* InQuery, std::string InName);
+	template <size_t N>
+	UHGPUTimeQueryScope(UHRenderBuilder& InBuilder, const char (&InName)[N])
+		: Cmd(nullptr)
+		, Recorder(nullptr)
+	{
+		Begin(InBuilder, InName);
+	}
+
 	~UHGPUTimeQueryScope();
 
-	static const std::vector<UHGPUQuery*>& GetResiteredGPUTime();
-	static void ClearRegisteredGPUTime();
+	UHGPUTimeQueryScope(const UHGPUTimeQueryScope&) = delete;
+	UHGPUTimeQueryScope& operator=(const UHGPUTimeQueryScope&) = delete;
 
 private:
-#if WITH_EDITOR
-	UHGPUQuery* GPUTimeQuery;
-	VkCommandBuffer Cmd;
+	void Begin(UHRenderBuilder& InBuilder, const char* InName);
 
-	// editor only registered game time, which will be displayed in profile
-	static std::vector<UHGPUQuery*> RegisteredGPUTime;
-#endif
-};
\ No newline at end of file
+	VkCommandBuffer Cmd;
+	UHGPUTimelineRecorder* Recorder;
+};
@@ -0,0 +1,357 @@
+#include "GPUTimeline.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+UHGPUClockCalibration::UHGPUClockCalibration()
+	: NsPerTick(0.0)
+	, NominalCountsPerTick(0.0)
+	, TickMask(~0ULL)
+	, ValidBits(64)
+	, RefTick(0)
+	, RefCPUTime(0.0)
+	, CountsPerTick(0.0)
+	, bIsCalibrated(false)
+{
+
+}
+
+void UHGPUClockCalibration::Reset(double InNsPerTick, uint32_t InValidBits, double InCPUSecondsPerCount)
+{
+	NsPerTick = InNsPerTick;
+	NominalCountsPerTick = InNsPerTick * 1e-9 / InCPUSecondsPerCount;
+	ValidBits = (InValidBits == 0 || InValidBits > 64) ? 64 : InValidBits;
+	TickMask = (ValidBits == 64) ? ~0ULL : (1ULL << ValidBits) - 1;
+
+	Samples.clear();
+	SubmitBounds.clear();
+	RefTick = 0;
+	RefCPUTime = 0.0;
+	CountsPerTick = NominalCountsPerTick;
+	bIsCalibrated = false;
+}
+
+void UHGPUClockCalibration::AddSample(uint64_t InGPUTick, int64_t InCPUTime, uint64_t InMaxDeviationNs)
+{
+	// weight by the inverse variance, the deviation is offset by 1us so a few perfect samples don't dominate the fit
+	const double Deviation = static_cast<double>(InMaxDeviationNs) + 1000.0;
+	AddClockSample(Samples, MaxSamples, UHClockSample{ InGPUTick & TickMask, InCPUTime, 1.0 / (Deviation * Deviation) });
+	FitSamples();
+}
+
+void UHGPUClockCalibration::AddSubmitBound(uint64_t InGPUTick, int64_t InCPUSubmitTime)
+{
+	if (Samples.size() > 0)
+	{
+		return;
+	}
+
+	AddClockSample(SubmitBounds, MaxSubmitBounds, UHClockSample{ InGPUTick & TickMask, InCPUSubmitTime, 1.0 });
+	FitSubmitBounds();
+}
+
+bool UHGPUClockCalibration::IsCalibrated() const
+{
+	return bIsCalibrated;
+}
+
+bool UHGPUClockCalibration::HasSamples() const
+{
+	return Samples.size() > 0;
+}
+
+int64_t UHGPUClockCalibration::ToCPUTime(uint64_t InGPUTick) const
+{
+	const double Delta = static_cast<double>(GetTickDelta(InGPUTick, RefTick));
+	return static_cast<int64_t>(std::llround(RefCPUTime + CountsPerTick * Delta));
+}
+
+double UHGPUClockCalibration::GetDurationMs(uint64_t InBeginTick, uint64_t InEndTick) const
+{
+	// a scope can't end before it begins, treat the broken pair as empty
+	const int64_t Delta = GetTickDelta(InEndTick, InBeginTick);
+	return (Delta > 0) ? static_cast<double>(Delta) * NsPerTick * 1e-6 : 0.0;
+}
+
+double UHGPUClockCalibration::GetDriftPPM() const
+{
+	return (NominalCountsPerTick > 0.0) ? (CountsPerTick / NominalCountsPerTick - 1.0) * 1e6 : 0.0;
+}
+
+int64_t UHGPUClockCalibration::GetTickDelta(uint64_t InA, uint64_t InB) const
+{
+	uint64_t Delta = (InA - InB) & TickMask;
+	if (ValidBits < 64 && (Delta >> (ValidBits - 1)) != 0)
+	{
+		// sign extend
+		Delta |= ~TickMask;
+	}
+
+	return static_cast<int64_t>(Delta);
+}
+
+void UHGPUClockCalibration::AddClockSample(std::deque<UHClockSample>& InOutSamples, uint32_t InMaxCount, const UHClockSample& InSample)
+{
+	InOutSamples.push_back(InSample);
+	while (InOutSamples.size() > InMaxCount)
+	{
+		InOutSamples.pop_front();
+	}
+
+	// deltas are only unambiguous within half of the wrap range, keep samples well within it
+	// the range is measured with CPU time since the ticks themselves can't tell how many times they've wrapped
+	if (ValidBits < 64)
+	{
+		const double MaxCounts = std::ldexp(1.0, static_cast<int32_t>(ValidBits) - 2) * NominalCountsPerTick;
+		while (InOutSamples.size() > 1 && static_cast<double>(InSample.CPUTime - InOutSamples.front().CPUTime) >= MaxCounts)
+		{
+			InOutSamples.pop_front();
+		}
+	}
+}
+
+void UHGPUClockCalibration::FitSamples()
+{
+	// fit relative to the latest sample so the sums stay small in double precision
+	const UHClockSample& Ref = Samples.back();
+	double SumW = 0.0;
+	double SumX = 0.0;
+	double SumY = 0.0;
+	for (const UHClockSample& Sample : Samples)
+	{
+		SumW += Sample.Weight;
+		SumX += Sample.Weight * static_cast<double>(GetTickDelta(Sample.GPUTick, Ref.GPUTick));
+		SumY += Sample.Weight * static_cast<double>(Sample.CPUTime - Ref.CPUTime);
+	}
+	const double MeanX = SumX / SumW;
+	const double MeanY = SumY / SumW;
+
+	double SumXX = 0.0;
+	double SumXY = 0.0;
+	for (const UHClockSample& Sample : Samples)
+	{
+		const double X = static_cast<double>(GetTickDelta(Sample.GPUTick, Ref.GPUTick)) - MeanX;
+		const double Y = static_cast<double>(Sample.CPUTime - Ref.CPUTime) - MeanY;
+		SumXX += Sample.Weight * X * X;
+		SumXY += Sample.Weight * X * Y;
+	}
+
+	// the slope stays nominal until samples span enough time, a clock never drifts by a percent
+	double Slope = NominalCountsPerTick;
+	if (Samples.size() >= 2 && SumXX > 0.0)
+	{
+		const double Fitted = SumXY / SumXX;
+		if (std::abs(Fitted / NominalCountsPerTick - 1.0) < 0.01)
+		{
+			Slope = Fitted;
+		}
+	}
+
+	RefTick = Ref.GPUTick;
+	RefCPUTime = static_cast<double>(Ref.CPUTime) + MeanY - Slope * MeanX;
+	CountsPerTick = Slope;
+	bIsCalibrated = true;
+}
+
+void UHGPUClockCalibration::FitSubmitBounds()
+{
+	// every bound says the offset is at least CPU time - slope * tick, the largest one is the closest to the truth
+	const UHClockSample& Ref = SubmitBounds.back();
+	double Offset = -DBL_MAX;
+	for (const UHClockSample& Bound : SubmitBounds)
+	{
+		const double X = static_cast<double>(GetTickDelta(Bound.GPUTick, Ref.GPUTick));
+		Offset = (std::max)(Offset, static_cast<double>(Bound.CPUTime - Ref.CPUTime) - NominalCountsPerTick * X);
+	}
+
+	RefTick = Ref.GPUTick;
+	RefCPUTime = static_cast<double>(Ref.CPUTime) + Offset;
+	CountsPerTick = NominalCountsPerTick;
+	bIsCalibrated = true;
+}
+
+UHGPUTimeline::UHGPUTimeline()
+{
+
+}
+
+void UHGPUTimeline::Reset()
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	Queues.clear();
+	Histories.clear();
+	HistoryLookup.clear();
+}
+
+uint32_t UHGPUTimeline::AddQueue(const std::string& InName, double InNsPerTick, uint32_t InValidBits, double InCPUSecondsPerCount)
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	UHGPUQueueLane Lane;
+	Lane.Name = InName;
+	Lane.Calibration.Reset(InNsPerTick, InValidBits, InCPUSecondsPerCount);
+	Queues.push_back(std::move(Lane));
+
+	return static_cast<uint32_t>(Queues.size() - 1);
+}
+
+uint32_t UHGPUTimeline::GetQueueCount() const
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	return static_cast<uint32_t>(Queues.size());
+}
+
+std::string UHGPUTimeline::GetQueueName(uint32_t InQueueIndex) const
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	return Queues[InQueueIndex].Name;
+}
+
+void UHGPUTimeline::AddCalibrationSample(uint32_t InQueueIndex, uint64_t InGPUTick, int64_t InCPUTime, uint64_t InMaxDeviationNs)
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	Queues[InQueueIndex].Calibration.AddSample(InGPUTick, InCPUTime, InMaxDeviationNs);
+}
+
+void UHGPUTimeline::AddSubmitBound(uint32_t InQueueIndex, uint64_t InGPUTick, int64_t InCPUSubmitTime)
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	Queues[InQueueIndex].Calibration.AddSubmitBound(InGPUTick, InCPUSubmitTime);
+}
+
+void UHGPUTimeline::SubmitFrame(uint32_t InQueueIndex, const std::vector<UHGPUTimelineScope>& InScopes)
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	UHGPUQueueLane& Queue = Queues[InQueueIndex];
+	const UHGPUClockCalibration& Calibration = Queue.Calibration;
+
+	// sum durations of this frame per scope first, histories get one sample per frame
+	std::vector<size_t> FrameHistories;
+	for (const UHGPUTimelineScope& Scope : InScopes)
+	{
+		const UHScopeKey Key(InQueueIndex, Scope.Name, Scope.Depth);
+		size_t HistoryIdx = 0;
+		const auto Lookup = HistoryLookup.find(Key);
+		if (Lookup != HistoryLookup.end())
+		{
+			HistoryIdx = Lookup->second;
+		}
+		else
+		{
+			HistoryIdx = Histories.size();
+			HistoryLookup[Key] = HistoryIdx;
+			Histories.push_back(UHGPUScopeHistory{ Scope.Name, InQueueIndex, Scope.Depth, 0, 0, 0.0f, false, std::vector<float>(HistoryLength) });
+		}
+
+		UHGPUScopeHistory& History = Histories[HistoryIdx];
+		if (!History.bInFrame)
+		{
+			History.bInFrame = true;
+			History.FrameTotalMs = 0.0f;
+			FrameHistories.push_back(HistoryIdx);
+		}
+		History.FrameTotalMs += static_cast<float>(Calibration.GetDurationMs(Scope.BeginTick, Scope.EndTick));
+
+		if (Calibration.IsCalibrated())
+		{
+			UHCPUProfileEvent Event{};
+			Event.Name = Scope.Name;
+			Event.BeginTime = Calibration.ToCPUTime(Scope.BeginTick);
+			Event.EndTime = Calibration.ToCPUTime(Scope.EndTick);
+			Event.Depth = Scope.Depth;
+			Event.Type = UHCPUProfileEventType::Scope;
+			Queue.Events.push_back(Event);
+		}
+	}
+
+	while (Queue.Events.size() > MaxLaneEvents)
+	{
+		Queue.Events.pop_front();
+	}
+
+	for (const size_t HistoryIdx : FrameHistories)
+	{
+		UHGPUScopeHistory& History = Histories[HistoryIdx];
+		History.Durations[History.NextSample] = History.FrameTotalMs;
+		History.NextSample = (History.NextSample + 1) % HistoryLength;
+		History.NumSamples = (History.NumSamples < HistoryLength) ? History.NumSamples + 1 : HistoryLength;
+		History.bInFrame = false;
+	}
+}
+
+void UHGPUTimeline::GetStats(std::vector<UHGPUScopeStats>& OutStats) const
+{
+	OutStats.clear();
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+
+	std::vector<float> Sorted;
+	for (const UHGPUScopeHistory& History : Histories)
+	{
+		if (History.NumSamples == 0)
+		{
+			continue;
+		}
+
+		UHGPUScopeStats Stats{};
+		Stats.Name = History.Name;
+		Stats.QueueIndex = History.QueueIndex;
+		Stats.Depth = History.Depth;
+		Stats.NumSamples = History.NumSamples;
+		Stats.LastMs = History.Durations[(History.NextSample + HistoryLength - 1) % HistoryLength];
+
+		// the history is full or filled from the beginning, so the first NumSamples are valid either way
+		Sorted.assign(History.Durations.begin(), History.Durations.begin() + History.NumSamples);
+		std::sort(Sorted.begin(), Sorted.end());
+
+		double Sum = 0.0;
+		for (const float Duration : Sorted)
+		{
+			Sum += Duration;
+		}
+		Stats.AverageMs = static_cast<float>(Sum / Sorted.size());
+		Stats.MaxMs = Sorted.back();
+
+		// nearest rank percentiles
+		const auto Percentile = [&Sorted](double InPercent)
+		{
+			const size_t Rank = static_cast<size_t>(std::ceil(InPercent * Sorted.size()));
+			return Sorted[(std::min)((std::max)(Rank, static_cast<size_t>(1)), Sorted.size()) - 1];
+		};
+		Stats.P50Ms = Percentile(0.50);
+		Stats.P95Ms = Percentile(0.95);
+		Stats.P99Ms = Percentile(0.99);
+
+		OutStats.push_back(Stats);
+	}
+
+	std::stable_sort(OutStats.begin(), OutStats.end(), [](const UHGPUScopeStats& A, const UHGPUScopeStats& B)
+		{
+			return A.QueueIndex < B.QueueIndex;
+		});
+}
+
+void UHGPUTimeline::CaptureLanes(std::vector<UHCPUProfileThreadCapture>& OutLanes) const
+{
+	OutLanes.clear();
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+
+	for (size_t Idx = 0; Idx < Queues.size(); Idx++)
+	{
+		const UHGPUQueueLane& Queue = Queues[Idx];
+		if (Queue.Events.size() == 0)
+		{
+			continue;
+		}
+
+		UHCPUProfileThreadCapture Lane;
+		Lane.ThreadId = LaneIdBase + static_cast<uint32_t>(Idx);
+		Lane.ThreadName = Queue.Name;
+		Lane.Events.assign(Queue.Events.begin(), Queue.Events.end());
+		OutLanes.push_back(std::move(Lane));
+	}
+}
+
+UHGPUClockCalibration UHGPUTimeline::GetCalibration(uint32_t InQueueIndex) const
+{
+	std::unique_lock<std::mutex> Lock(TimelineLock);
+	return Queues[InQueueIndex].Calibration;
+}
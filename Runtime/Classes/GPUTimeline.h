@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../Engine/CPUProfiler.h"
+
+// a scope resolved from timestamp queries, ticks are raw device timestamps
+// names are string literals so the pointer works as the id of a scope, the same as CPU profile scopes
+struct UHGPUTimelineScope
+{
+	const char* Name;
+	uint32_t Depth;
+	uint64_t BeginTick;
+	uint64_t EndTick;
+};
+
+// rolling statistics of a scope, durations are in milliseconds
+struct UHGPUScopeStats
+{
+	const char* Name;
+	uint32_t QueueIndex;
+	uint32_t Depth;
+	uint32_t NumSamples;
+	float LastMs;
+	float AverageMs;
+	float P50Ms;
+	float P95Ms;
+	float P99Ms;
+	float MaxMs;
+};
+
+// maps device ticks to the CPU time of UHCPUProfiler, it doesn't touch the device
+// ticks only have timestampValidBits bits and wrap around, so ticks are always compared as signed deltas to a reference
+//
+// with calibrated timestamps, the mapping is a weighted least squares fit of recent (tick, CPU time) pairs,
+// which follows the clock drift between GPU and CPU as the slope isn't fixed to the nominal period
+// without them, a timestamp of a submission can't be earlier than the CPU time it's submitted,
+// so the offset is the tightest of these lower bounds over recent frames and the slope is the nominal period
+class UHGPUClockCalibration
+{
+public:
+	UHGPUClockCalibration();
+
+	// InNsPerTick is timestampPeriod, InValidBits is timestampValidBits of the queue family
+	void Reset(double InNsPerTick, uint32_t InValidBits, double InCPUSecondsPerCount);
+
+	// a pair sampled at the same moment, the deviation is the sampling uncertainty in nanoseconds
+	void AddSample(uint64_t InGPUTick, int64_t InCPUTime, uint64_t InMaxDeviationNs);
+
+	// the first timestamp of a submission and the CPU time it's submitted, ignored once there are calibrated samples
+	void AddSubmitBound(uint64_t InGPUTick, int64_t InCPUSubmitTime);
+
+	bool IsCalibrated() const;
+	bool HasSamples() const;
+	int64_t ToCPUTime(uint64_t InGPUTick) const;
+	double GetDurationMs(uint64_t InBeginTick, uint64_t InEndTick) const;
+
+	// the fitted drift against the nominal period in parts per million
+	double GetDriftPPM() const;
+
+	// signed InA - InB with wrap around
+	int64_t GetTickDelta(uint64_t InA, uint64_t InB) const;
+
+	static const uint32_t MaxSamples = 32;
+	static const uint32_t MaxSubmitBounds = 64;
+
+private:
+	struct UHClockSample
+	{
+		uint64_t GPUTick;
+		int64_t CPUTime;
+		double Weight;
+	};
+
+	void AddClockSample(std::deque<UHClockSample>& InOutSamples, uint32_t InMaxCount, const UHClockSample& InSample);
+	void FitSamples();
+	void FitSubmitBounds();
+
+	std::deque<UHClockSample> Samples;
+	std::deque<UHClockSample> SubmitBounds;
+
+	double NsPerTick;
+	double NominalCountsPerTick;
+	uint64_t TickMask;
+	uint32_t ValidBits;
+
+	// the fitted mapping, CPU time = RefCPUTime + CountsPerTick * (tick - RefTick)
+	uint64_t RefTick;
+	double RefCPUTime;
+	double CountsPerTick;
+	bool bIsCalibrated;
+};
+
+// GPU timeline of all queues, it aggregates resolved scopes into rolling histories and keeps recent scopes in CPU time
+// so they can be exported into the same trace as CPU scopes, it doesn't touch the device and is safe to call from any thread
+//
+// a scope that appears several times in a frame is summed as one sample of the frame, scopes are identified by (queue, name, depth)
+class UHGPUTimeline
+{
+public:
+	UHGPUTimeline();
+
+	void Reset();
+
+	// add a queue lane and return its index
+	uint32_t AddQueue(const std::string& InName, double InNsPerTick, uint32_t InValidBits, double InCPUSecondsPerCount);
+	uint32_t GetQueueCount() const;
+	std::string GetQueueName(uint32_t InQueueIndex) const;
+
+	void AddCalibrationSample(uint32_t InQueueIndex, uint64_t InGPUTick, int64_t InCPUTime, uint64_t InMaxDeviationNs);
+	void AddSubmitBound(uint32_t InQueueIndex, uint64_t InGPUTick, int64_t InCPUSubmitTime);
+
+	// submit resolved scopes of a frame of a queue, scopes are in the order they begin
+	void SubmitFrame(uint32_t InQueueIndex, const std::vector<UHGPUTimelineScope>& InScopes);
+
+	// stats of all scopes in the order of queue and their first appearance
+	void GetStats(std::vector<UHGPUScopeStats>& OutStats) const;
+
+	// recent scopes in CPU time as profile lanes, scopes before the queue is calibrated aren't included
+	void CaptureLanes(std::vector<UHCPUProfileThreadCapture>& OutLanes) const;
+
+	UHGPUClockCalibration GetCalibration(uint32_t InQueueIndex) const;
+
+	// frames kept in histories, and scopes kept for trace export per queue
+	static const uint32_t HistoryLength = 256;
+	static const uint32_t MaxLaneEvents = 65536;
+
+	// lanes are after CPU threads in traces
+	static const uint32_t LaneIdBase = 10000;
+
+private:
+	struct UHGPUScopeHistory
+	{
+		const char* Name;
+		uint32_t QueueIndex;
+		uint32_t Depth;
+		uint32_t NumSamples;
+		uint32_t NextSample;
+		float FrameTotalMs;
+		bool bInFrame;
+		std::vector<float> Durations;
+	};
+
+	struct UHGPUQueueLane
+	{
+		std::string Name;
+		UHGPUClockCalibration Calibration;
+		std::deque<UHCPUProfileEvent> Events;
+	};
+
+	using UHScopeKey = std::tuple<uint32_t, const char*, uint32_t>;
+
+	mutable std::mutex TimelineLock;
+	std::vector<UHGPUQueueLane> Queues;
+	std::vector<UHGPUScopeHistory> Histories;
+	std::map<UHScopeKey, size_t> HistoryLookup;
+};
@@ -334,7 +334,7 @@ bool UHGraphicState::CreateState(UHRenderPassInfo InInfo)
 	PipelineInfo.basePipelineHandle = nullptr; // Optional
 	PipelineInfo.basePipelineIndex = UHINDEXNONE; // Optional
 
-	VkResult Result = vkCreateGraphicsPipelines(LogicalDevice, nullptr, 1, &PipelineInfo, nullptr, &PassPipeline);
+	VkResult Result = vkCreateGraphicsPipelines(LogicalDevice, GfxCache->GetPipelineCache(), 1, &PipelineInfo, nullptr, &PassPipeline);
 	if (Result != VK_SUCCESS)
 	{
 		UHE_LOG(L"Failed to create graphics pipeline!\n");
@@ -477,7 +477,7 @@ bool UHGraphicState::CreateState(UHRayTracingInfo InInfo)
 	CreateInfo.pLibraryInterface = &PipelineInterfaceInfo;
 
 	// create state for ray tracing pipeline
-	VkResult Result = GVkCreateRayTracingPipelinesKHR(LogicalDevice, nullptr, nullptr, 1, &CreateInfo, nullptr, &RTPipeline);
+	VkResult Result = GVkCreateRayTracingPipelinesKHR(LogicalDevice, nullptr, GfxCache->GetPipelineCache(), 1, &CreateInfo, nullptr, &RTPipeline);
 	if (Result != VK_SUCCESS)
 	{
 		UHE_LOG(L"Failed to create ray tracing pipeline!\n");
@@ -515,7 +515,7 @@ bool UHGraphicState::CreateState(UHComputePassInfo InInfo)
 	PipelineInfo.basePipelineHandle = nullptr;
 	PipelineInfo.basePipelineIndex = UHINDEXNONE;
 
-	VkResult Result = vkCreateComputePipelines(LogicalDevice, nullptr, 1, &PipelineInfo, nullptr, &PassPipeline);
+	VkResult Result = vkCreateComputePipelines(LogicalDevice, GfxCache->GetPipelineCache(), 1, &PipelineInfo, nullptr, &PassPipeline);
 	if (Result != VK_SUCCESS)
 	{
 		UHE_LOG(L"Failed to create graphics pipeline!\n");
@@ -553,4 +553,13 @@ bool UHGraphicState::operator==(const UHGraphicState& InState)
 	bool bComputePassEqual = ComputePassInfo == InState.ComputePassInfo;
 
 	return bRenderPassEqual && bRayTracingEqual && bComputePassEqual;
+}
+
+size_t UHGraphicState::GetHash() const
+{
+	size_t Hash = RenderPassInfo.GetHash();
+	UHUtilities::HashCombine(Hash, RayTracingInfo.GetHash());
+	UHUtilities::HashCombine(Hash, ComputePassInfo.GetHash());
+
+	return Hash;
 }
\ No newline at end of file
@@ -23,6 +23,9 @@ public:
 
 	bool operator==(const UHGraphicState& InState);
 
+	// hash of render pass, ray tracing and compute pass info
+	size_t GetHash() const;
+
 private:
 	bool CreateState(UHRenderPassInfo InInfo);
 	bool CreateState(UHRayTracingInfo InInfo);
@@ -0,0 +1,146 @@
+#include "IndirectDrawBuilder.h"
+#include "FrustumCulling.h"
+
+UHIndirectDrawBuilder::UHIndirectDrawBuilder()
+	: FirstInstance(0)
+	, CommandCount(0)
+{
+
+}
+
+void UHIndirectDrawBuilder::Build(const std::vector<UHIndirectDrawItem>& InItems, uint32_t InFirstInstance)
+{
+	const int32_t ItemCount = static_cast<int32_t>(InItems.size());
+	Buckets.clear();
+	BucketLookup.clear();
+	CullData.resize(ItemCount);
+
+	// assign drawable items to buckets, a bucket is created at its first renderer
+	for (int32_t Idx = 0; Idx < ItemCount; Idx++)
+	{
+		const UHIndirectDrawItem& Item = InItems[Idx];
+		if (!Item.bDrawable)
+		{
+			CullData[Idx] = UHIndirectCullData{ UHINDEXNONE, 0, 0, 0, 0 };
+			continue;
+		}
+
+		const auto Lookup = BucketLookup.emplace(Item.Material, static_cast<int32_t>(Buckets.size()));
+		if (Lookup.second)
+		{
+			Buckets.push_back(UHIndirectDrawBucket{ Item.Material, 0, 0 });
+		}
+
+		const int32_t BucketIdx = Lookup.first->second;
+		Buckets[BucketIdx].Capacity++;
+		CullData[Idx] = UHIndirectCullData{ BucketIdx, 0, Item.IndexCount, Item.FirstIndex, Item.VertexOffset };
+	}
+
+	// reserve the command range of each bucket, the capacity is the renderer count so a bucket never overflows
+	FirstInstance = InFirstInstance;
+	CommandCount = 0;
+	for (UHIndirectDrawBucket& Bucket : Buckets)
+	{
+		Bucket.FirstCommand = CommandCount;
+		CommandCount += Bucket.Capacity;
+	}
+
+	for (UHIndirectCullData& Data : CullData)
+	{
+		if (Data.BucketIndex != UHINDEXNONE)
+		{
+			Data.FirstCommand = Buckets[Data.BucketIndex].FirstCommand;
+		}
+	}
+}
+
+const std::vector<UHIndirectDrawBucket>& UHIndirectDrawBuilder::GetBuckets() const
+{
+	return Buckets;
+}
+
+const std::vector<UHIndirectCullData>& UHIndirectDrawBuilder::GetCullData() const
+{
+	return CullData;
+}
+
+uint32_t UHIndirectDrawBuilder::GetFirstInstance() const
+{
+	return FirstInstance;
+}
+
+uint32_t UHIndirectDrawBuilder::GetCommandCount() const
+{
+	return CommandCount;
+}
+
+void UHIndirectDrawBuilder::CullAndCompact(const UHIndirectCullView& InView, const UHCullingBounds& InBounds, const std::vector<uint32_t>& InOcclusionResult
+	, std::vector<UHDrawIndexedIndirectCommand>& OutCommands, std::vector<uint32_t>& OutDrawCounts, std::vector<uint32_t>& OutInstances) const
+{
+	OutCommands.assign(CommandCount, UHDrawIndexedIndirectCommand{ 0, 0, 0, 0, 0 });
+	OutDrawCounts.assign(Buckets.size(), 0);
+	OutInstances.resize(FirstInstance + CommandCount);
+
+	// one iteration per renderer as one thread per renderer in the compute shader
+	// the shader appends with atomics so its command order within a bucket is arbitrary, the draws are the same otherwise
+	const int32_t Count = static_cast<int32_t>((std::min)(CullData.size(), InBounds.GetCount()));
+	for (int32_t Idx = 0; Idx < Count; Idx++)
+	{
+		const UHIndirectCullData& Data = CullData[Idx];
+		if (Data.BucketIndex == UHINDEXNONE)
+		{
+			continue;
+		}
+
+		const XMFLOAT3 Center(InBounds.CenterX[Idx], InBounds.CenterY[Idx], InBounds.CenterZ[Idx]);
+		const XMFLOAT3 Extent(InBounds.ExtentX[Idx], InBounds.ExtentY[Idx], InBounds.ExtentZ[Idx]);
+		if (!IsBoxVisible(InView, Center, Extent))
+		{
+			continue;
+		}
+
+		if (InView.bEnableOcclusion && Idx < static_cast<int32_t>(InOcclusionResult.size()) && InOcclusionResult[Idx] == 0)
+		{
+			continue;
+		}
+
+		const uint32_t CommandIdx = Data.FirstCommand + OutDrawCounts[Data.BucketIndex]++;
+		OutCommands[CommandIdx] = UHDrawIndexedIndirectCommand{ Data.IndexCount, 1, Data.FirstIndex, Data.VertexOffset, FirstInstance + CommandIdx };
+		OutInstances[FirstInstance + CommandIdx] = static_cast<uint32_t>(Idx);
+	}
+}
+
+bool UHIndirectDrawBuilder::IsBoxVisible(const UHIndirectCullView& InView, const XMFLOAT3& InCenter, const XMFLOAT3& InExtent)
+{
+	// the matrix is stored transposed, so its rows are the columns of view projection
+	// left, right, bottom, top and the near plane of reversed-z, the projection has an infinite far plane
+	const XMFLOAT4X4& M = InView.ViewProj;
+	const float Planes[5][4] =
+	{
+		{ M.m[3][0] + M.m[0][0], M.m[3][1] + M.m[0][1], M.m[3][2] + M.m[0][2], M.m[3][3] + M.m[0][3] },
+		{ M.m[3][0] - M.m[0][0], M.m[3][1] - M.m[0][1], M.m[3][2] - M.m[0][2], M.m[3][3] - M.m[0][3] },
+		{ M.m[3][0] + M.m[1][0], M.m[3][1] + M.m[1][1], M.m[3][2] + M.m[1][2], M.m[3][3] + M.m[1][3] },
+		{ M.m[3][0] - M.m[1][0], M.m[3][1] - M.m[1][1], M.m[3][2] - M.m[1][2], M.m[3][3] - M.m[1][3] },
+		{ M.m[3][0] - M.m[2][0], M.m[3][1] - M.m[2][1], M.m[3][2] - M.m[2][2], M.m[3][3] - M.m[2][3] }
+	};
+
+	// a box is outside when it's fully behind any plane, planes aren't normalized and the test doesn't need it
+	for (int32_t Idx = 0; Idx < 5; Idx++)
+	{
+		const float* P = Planes[Idx];
+		const float Dist = P[0] * InCenter.x + P[1] * InCenter.y + P[2] * InCenter.z + P[3];
+		const float Radius = std::abs(P[0]) * InExtent.x + std::abs(P[1]) * InExtent.y + std::abs(P[2]) * InExtent.z;
+		if (Dist < -Radius)
+		{
+			return false;
+		}
+	}
+
+	// the culling distance works as the far plane, the same as the frustum of CPU culling
+	const XMFLOAT3& D = InView.CameraDir;
+	const float FarDist = InView.CullingDistance - (D.x * (InCenter.x - InView.CameraPos.x) + D.y * (InCenter.y - InView.CameraPos.y)
+		+ D.z * (InCenter.z - InView.CameraPos.z));
+	const float FarRadius = std::abs(D.x) * InExtent.x + std::abs(D.y) * InExtent.y + std::abs(D.z) * InExtent.z;
+
+	return FarDist >= -FarRadius;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Types.h"
+
+class UHMaterial;
+struct UHCullingBounds;
+
+// the same layout as VkDrawIndexedIndirectCommand, so commands can be uploaded as they are
+struct UHDrawIndexedIndirectCommand
+{
+	uint32_t IndexCount;
+	uint32_t InstanceCount;
+	uint32_t FirstIndex;
+	int32_t VertexOffset;
+	uint32_t FirstInstance;
+};
+
+// per renderer data of GPU culling, indexed by the buffer data index of renderers
+struct UHIndirectCullData
+{
+	// the bucket the renderer is drawn with, UHINDEXNONE if it isn't drawn by the indirect path
+	int32_t BucketIndex;
+	uint32_t FirstCommand;
+
+	// the range of the mesh in the geometry pool, written to the command as it is
+	uint32_t IndexCount;
+	uint32_t FirstIndex;
+	int32_t VertexOffset;
+};
+
+// a renderer to draw indirectly, bDrawable is false for renderers that are disabled or not opaque
+struct UHIndirectDrawItem
+{
+	bool operator==(const UHIndirectDrawItem& InOther) const
+	{
+		return Material == InOther.Material && IndexCount == InOther.IndexCount && FirstIndex == InOther.FirstIndex
+			&& VertexOffset == InOther.VertexOffset && bDrawable == InOther.bDrawable;
+	}
+
+	bool operator!=(const UHIndirectDrawItem& InOther) const
+	{
+		return !(*this == InOther);
+	}
+
+	const UHMaterial* Material;
+	uint32_t IndexCount;
+	uint32_t FirstIndex;
+	int32_t VertexOffset;
+	bool bDrawable;
+};
+
+// renderers sharing the same material are drawn by one indirect count draw, meshes come from the geometry pool
+// the bucket reserves Capacity commands from FirstCommand, and the draw count of the bucket is written by culling
+struct UHIndirectDrawBucket
+{
+	const UHMaterial* Material;
+	uint32_t FirstCommand;
+	uint32_t Capacity;
+};
+
+// view data of GPU culling, ViewProj is the transposed matrix as it's stored in system constants
+struct UHIndirectCullView
+{
+	XMFLOAT4X4 ViewProj;
+	XMFLOAT3 CameraPos;
+	XMFLOAT3 CameraDir;
+	float CullingDistance;
+	bool bEnableOcclusion;
+};
+
+// builds the indirect draw buckets for GPU-driven rendering, buckets only change when renderers, meshes or materials change
+// CullAndCompact() is the CPU reference of GPUCullingComputeShader.hlsl, the compute shader writes commands and draw counts the same way
+class UHIndirectDrawBuilder
+{
+public:
+	UHIndirectDrawBuilder();
+
+	// group drawable items by material, items are indexed by the buffer data index of renderers
+	// buckets are in the order their materials first appear, command N draws one instance at InFirstInstance + N
+	void Build(const std::vector<UHIndirectDrawItem>& InItems, uint32_t InFirstInstance);
+
+	const std::vector<UHIndirectDrawBucket>& GetBuckets() const;
+	const std::vector<UHIndirectCullData>& GetCullData() const;
+	uint32_t GetFirstInstance() const;
+	uint32_t GetCommandCount() const;
+
+	// cull renderers and compact the visible ones into their buckets, InOcclusionResult can be empty if there is no occlusion data
+	// a renderer is occluded when its result is 0, the result of renderers the camera is inside is never 0
+	// OutCommands has GetCommandCount() commands, only the first OutDrawCounts[Bucket] commands of a bucket are written
+	// OutInstances is indexed by FirstInstance of commands, commands within a bucket are in renderer index order
+	void CullAndCompact(const UHIndirectCullView& InView, const UHCullingBounds& InBounds, const std::vector<uint32_t>& InOcclusionResult
+		, std::vector<UHDrawIndexedIndirectCommand>& OutCommands, std::vector<uint32_t>& OutDrawCounts, std::vector<uint32_t>& OutInstances) const;
+
+	// frustum test of a world space box, the planes are the side and near planes of view projection plus the culling distance
+	static bool IsBoxVisible(const UHIndirectCullView& InView, const XMFLOAT3& InCenter, const XMFLOAT3& InExtent);
+
+private:
+	std::vector<UHIndirectDrawBucket> Buckets;
+	std::vector<UHIndirectCullData> CullData;
+	uint32_t FirstInstance;
+	uint32_t CommandCount;
+
+	// working data, kept between builds to avoid allocations
+	std::unordered_map<const UHMaterial*, int32_t> BucketLookup;
+};
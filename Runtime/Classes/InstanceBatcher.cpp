@@ -0,0 +1,83 @@
+#include "InstanceBatcher.h"
+#include "Utility.h"
+
+size_t UHInstanceBatcher::UHBatchKeyHash::operator()(const UHBatchKey& InKey) const
+{
+	size_t Hash = std::hash<const UHMesh*>()(InKey.Mesh);
+	UHUtilities::HashCombine(Hash, InKey.Material);
+	return Hash;
+}
+
+UHInstanceBatcher::UHInstanceBatcher(int32_t InOrderWindow)
+	: OrderWindow(InOrderWindow)
+{
+
+}
+
+void UHInstanceBatcher::SetOrderWindow(int32_t InOrderWindow)
+{
+	OrderWindow = InOrderWindow;
+}
+
+void UHInstanceBatcher::Build(const std::vector<UHInstanceBatchItem>& InItems, std::vector<UHInstanceBatch>& OutBatches, std::vector<uint32_t>& OutInstances)
+{
+	const int32_t ItemCount = static_cast<int32_t>(InItems.size());
+	const int32_t FirstBatch = static_cast<int32_t>(OutBatches.size());
+	OpenBatches.clear();
+	ItemBatches.resize(ItemCount);
+
+	// assign items to batches in front-to-back order, a batch is created at its nearest item
+	for (int32_t Idx = 0; Idx < ItemCount; Idx++)
+	{
+		const UHInstanceBatchItem& Item = InItems[Idx];
+		int32_t BatchIdx = UHINDEXNONE;
+
+		if (Item.bCanBatch)
+		{
+			const UHBatchKey Key{ Item.Mesh, Item.Material };
+			const auto OpenBatch = OpenBatches.find(Key);
+			if (OpenBatch != OpenBatches.end() && Idx - OutBatches[OpenBatch->second].FirstItem < OrderWindow)
+			{
+				BatchIdx = OpenBatch->second;
+			}
+			else
+			{
+				// a batch out of the window is closed, later items start a new one
+				BatchIdx = static_cast<int32_t>(OutBatches.size());
+				OpenBatches[Key] = BatchIdx;
+			}
+		}
+		else
+		{
+			BatchIdx = static_cast<int32_t>(OutBatches.size());
+		}
+
+		if (BatchIdx == static_cast<int32_t>(OutBatches.size()))
+		{
+			OutBatches.push_back(UHInstanceBatch{ 0, 0, Idx });
+		}
+
+		OutBatches[BatchIdx].InstanceCount++;
+		ItemBatches[Idx] = BatchIdx;
+	}
+
+	// lay out the instances of each batch contiguously
+	const int32_t BatchCount = static_cast<int32_t>(OutBatches.size()) - FirstBatch;
+	BatchOffsets.resize(BatchCount);
+
+	uint32_t InstanceOffset = static_cast<uint32_t>(OutInstances.size());
+	for (int32_t Idx = 0; Idx < BatchCount; Idx++)
+	{
+		UHInstanceBatch& Batch = OutBatches[FirstBatch + Idx];
+		Batch.FirstInstance = InstanceOffset;
+		BatchOffsets[Idx] = InstanceOffset;
+		InstanceOffset += Batch.InstanceCount;
+	}
+
+	// instances within a batch stay front-to-back as well
+	OutInstances.resize(InstanceOffset);
+	for (int32_t Idx = 0; Idx < ItemCount; Idx++)
+	{
+		OutInstances[BatchOffsets[ItemBatches[Idx] - FirstBatch]++] = InItems[Idx].RendererIndex;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class UHMesh;
+class UHMaterial;
+
+// a renderer to batch, renderers sharing the same mesh and material are drawn with one instanced call
+// the cull and blend states belong to the material, so mesh and material are the whole batch key
+struct UHInstanceBatchItem
+{
+	const UHMesh* Mesh;
+	const UHMaterial* Material;
+	uint32_t RendererIndex;
+
+	// false for renderers which need their own draw, e.g. translucent ones which must keep the sorted order
+	bool bCanBatch;
+};
+
+// a batch draws InstanceCount instances starting from FirstInstance of the instance buffer
+// FirstItem is the input item of its nearest instance, which provides the mesh and the descriptors for the draw
+struct UHInstanceBatch
+{
+	uint32_t FirstInstance;
+	uint32_t InstanceCount;
+	int32_t FirstItem;
+};
+
+// builds instanced batches from items sorted front-to-back, the batches are ordered by their nearest instance
+// an item only joins a batch started within the last OrderWindow items, so far instances don't break the front-to-back order too much
+class UHInstanceBatcher
+{
+public:
+	UHInstanceBatcher(int32_t InOrderWindow = 1024);
+
+	void SetOrderWindow(int32_t InOrderWindow);
+
+	// appends the batches to OutBatches and the renderer indices of instances to OutInstances
+	// the instances of a batch are contiguous and FirstInstance indexes OutInstances, so several lists can share one instance buffer
+	void Build(const std::vector<UHInstanceBatchItem>& InItems, std::vector<UHInstanceBatch>& OutBatches, std::vector<uint32_t>& OutInstances);
+
+private:
+	struct UHBatchKey
+	{
+		bool operator==(const UHBatchKey& InOther) const
+		{
+			return Mesh == InOther.Mesh && Material == InOther.Material;
+		}
+
+		const UHMesh* Mesh;
+		const UHMaterial* Material;
+	};
+
+	struct UHBatchKeyHash
+	{
+		size_t operator()(const UHBatchKey& InKey) const;
+	};
+
+	int32_t OrderWindow;
+
+	// working data, kept between builds to avoid allocations every frame
+	std::unordered_map<UHBatchKey, int32_t, UHBatchKeyHash> OpenBatches;
+	std::vector<int32_t> ItemBatches;
+	std::vector<uint32_t> BatchOffsets;
+};
@@ -0,0 +1,647 @@
+#include "JobSystem.h"
+#include "Thread.h"
+#include "../Engine/CPUProfiler.h"
+#include "../../UnheardEngine.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+// cached context index of current thread, a thread can be registered to different job systems during its lifetime
+// so the index is only valid when the system id matches
+static thread_local uint64_t GJobSystemIdTLS = 0;
+static thread_local int32_t GJobContextIdxTLS = -1;
+static std::atomic<uint64_t> GNextJobSystemId(1);
+
+// external slots taken by current thread, they're given back when the thread exits
+// a registry which is already gone means its job system was released, nothing to give back then
+struct UHJobThreadRegistrations
+{
+	~UHJobThreadRegistrations()
+	{
+		for (const std::pair<std::weak_ptr<UHJobExternalRegistry>, int32_t>& Registration : Registrations)
+		{
+			if (std::shared_ptr<UHJobExternalRegistry> Registry = Registration.first.lock())
+			{
+				std::unique_lock<std::mutex> Lock(Registry->Mutex);
+				Registry->Threads[Registration.second] = std::thread::id();
+			}
+		}
+	}
+
+	std::vector<std::pair<std::weak_ptr<UHJobExternalRegistry>, int32_t>> Registrations;
+};
+static thread_local UHJobThreadRegistrations GJobThreadRegistrationsTLS;
+
+UHJobCounter::UHJobCounter()
+	: Value(0)
+{
+
+}
+
+bool UHJobCounter::IsDone() const
+{
+	return Value.load(std::memory_order_acquire) == 0;
+}
+
+int32_t UHJobCounter::GetValue() const
+{
+	return Value.load(std::memory_order_acquire);
+}
+
+UHJob::UHJob()
+	: Task(nullptr)
+	, RangeFunction(nullptr)
+	, Begin(0)
+	, End(0)
+	, Grain(1)
+	, Counter(nullptr)
+	, Dependency(nullptr)
+	, bIsActive(false)
+{
+
+}
+
+UHWorkStealingQueue::UHWorkStealingQueue(uint32_t InCapacity)
+	: Top(0)
+	, Bottom(0)
+	, Buffer(InCapacity)
+	, Mask(static_cast<int64_t>(InCapacity) - 1)
+{
+	// capacity must be power of two
+	assert((InCapacity & (InCapacity - 1)) == 0);
+}
+
+// push a job at the bottom, owner thread only
+bool UHWorkStealingQueue::Push(UHJob* InJob)
+{
+	const int64_t B = Bottom.load(std::memory_order_relaxed);
+	const int64_t T = Top.load(std::memory_order_acquire);
+	if (B - T > Mask)
+	{
+		// queue is full, the caller should run the job inline
+		return false;
+	}
+
+	Buffer[B & Mask].store(InJob, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	Bottom.store(B + 1, std::memory_order_relaxed);
+	return true;
+}
+
+// pop a job from the bottom, owner thread only
+UHJob* UHWorkStealingQueue::Pop()
+{
+	const int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+	Bottom.store(B, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t T = Top.load(std::memory_order_relaxed);
+
+	UHJob* Job = nullptr;
+	if (T <= B)
+	{
+		Job = Buffer[B & Mask].load(std::memory_order_relaxed);
+		if (T == B)
+		{
+			// the last element, race against thieves
+			if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				Job = nullptr;
+			}
+			Bottom.store(B + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		// empty queue, restore the bottom
+		Bottom.store(B + 1, std::memory_order_relaxed);
+	}
+
+	return Job;
+}
+
+// steal a job from the top, can be called from any thread
+UHJob* UHWorkStealingQueue::Steal()
+{
+	int64_t T = Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t B = Bottom.load(std::memory_order_acquire);
+
+	if (T < B)
+	{
+		UHJob* Job = Buffer[T & Mask].load(std::memory_order_relaxed);
+		if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			// lost the race to the owner or another thief
+			return nullptr;
+		}
+		return Job;
+	}
+
+	return nullptr;
+}
+
+bool UHWorkStealingQueue::IsEmpty() const
+{
+	return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+}
+
+// job pages are allocated when the context schedules its first job, most external contexts are never used
+UHJobSystem::UHJobContext::UHJobContext()
+	: Queue(QueueCapacity)
+	, NextJob(0)
+	, RandomSeed(0)
+{
+
+}
+
+UHJobSystem::UHJobSystem()
+	: SystemId(GNextJobSystemId.fetch_add(1))
+	, NumWorkers(0)
+	, NumActiveContexts(0)
+	, NumDeferredJobs(0)
+	, NumQueuedJobs(0)
+	, NumSleepingWorkers(0)
+	, bIsTerminated(false)
+{
+
+}
+
+UHJobSystem::~UHJobSystem()
+{
+	Release();
+}
+
+void UHJobSystem::Initialize(int32_t InNumWorkers)
+{
+	Release();
+
+	// a new id invalidates the context index cached by external threads
+	SystemId = GNextJobSystemId.fetch_add(1);
+	NumWorkers = std::max(InNumWorkers, 0);
+	bIsTerminated = false;
+
+	const int32_t NumExternalContexts = std::max(MinExternalContexts, static_cast<int32_t>(std::thread::hardware_concurrency()) * 2);
+	Contexts.resize(NumWorkers + NumExternalContexts);
+	for (size_t Idx = 0; Idx < Contexts.size(); Idx++)
+	{
+		Contexts[Idx] = std::make_unique<UHJobContext>();
+		Contexts[Idx]->RandomSeed = static_cast<uint32_t>(Idx) * 2654435761u + 1;
+	}
+
+	// a new registry, threads registered to the previous one can't give back slots of this one
+	ExternalRegistry = std::make_shared<UHJobExternalRegistry>();
+	ExternalRegistry->Threads.resize(NumExternalContexts);
+	NumActiveContexts = NumWorkers;
+
+	Workers.resize(NumWorkers);
+	for (int32_t Idx = 0; Idx < NumWorkers; Idx++)
+	{
+		Workers[Idx] = std::thread(&UHJobSystem::WorkerThreadLoop, this, Idx);
+	}
+}
+
+void UHJobSystem::Initialize(int32_t InNumWorkers, uint32_t InAffinityCore)
+{
+	Initialize(InNumWorkers);
+	for (int32_t Idx = 0; Idx < NumWorkers; Idx++)
+	{
+		UHThread::SetAffinity(Workers[Idx], InAffinityCore + Idx);
+	}
+}
+
+// stop all workers, jobs that are still queued are dropped so caller should wait the counters before release
+void UHJobSystem::Release()
+{
+	if (Workers.size() > 0)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(SleepMutex);
+			bIsTerminated = true;
+		}
+		SleepCondition.notify_all();
+
+		for (std::thread& Worker : Workers)
+		{
+			if (Worker.joinable())
+			{
+				Worker.join();
+			}
+		}
+	}
+
+	Workers.clear();
+	Contexts.clear();
+	ExternalRegistry.reset();
+	NumActiveContexts = 0;
+	DeferredJobs.clear();
+	NumDeferredJobs = 0;
+	NumQueuedJobs = 0;
+	NumWorkers = 0;
+}
+
+int32_t UHJobSystem::GetNumWorkers() const
+{
+	return NumWorkers;
+}
+
+int32_t UHJobSystem::GetNumContexts() const
+{
+	return static_cast<int32_t>(Contexts.size());
+}
+
+void UHJobSystem::Schedule(UHAsyncTask* InTask, UHJobCounter* InCounter, const UHJobCounter* InDependency)
+{
+	const int32_t ContextIdx = GetContextIndex();
+	UHJob* Job = AcquireJob(ContextIdx);
+	Job->Task = InTask;
+	Job->RangeFunction = nullptr;
+	Job->Counter = InCounter;
+	Job->Dependency = InDependency;
+	SubmitJob(ContextIdx, Job);
+}
+
+void UHJobSystem::ScheduleParallelFor(int32_t InCount, int32_t InMinGrain, const UHParallelForFunction* InFunction
+	, UHJobCounter* InCounter, const UHJobCounter* InDependency)
+{
+	if (InCount <= 0)
+	{
+		return;
+	}
+
+	// aim for a few chunks per participant so the stealing can balance uneven work, but never go below the minimal grain
+	const int32_t NumParticipants = NumWorkers + 1;
+	const int32_t Grain = std::max(std::max(InMinGrain, 1), InCount / (NumParticipants * ChunksPerContext));
+
+	const int32_t ContextIdx = GetContextIndex();
+	UHJob* Job = AcquireJob(ContextIdx);
+	Job->Task = nullptr;
+	Job->RangeFunction = InFunction;
+	Job->Begin = 0;
+	Job->End = InCount;
+	Job->Grain = Grain;
+	Job->Counter = InCounter;
+	Job->Dependency = InDependency;
+	SubmitJob(ContextIdx, Job);
+}
+
+void UHJobSystem::ParallelFor(int32_t InCount, int32_t InMinGrain, const UHParallelForFunction& InFunction)
+{
+	if (InCount <= 0)
+	{
+		return;
+	}
+
+	UHJobCounter Counter;
+	ScheduleParallelFor(InCount, InMinGrain, &InFunction, &Counter);
+	Wait(&Counter);
+}
+
+void UHJobSystem::Wait(const UHJobCounter* InCounter)
+{
+	const int32_t ContextIdx = GetContextIndex();
+	while (!InCounter->IsDone())
+	{
+		if (UHJob* Job = FindJob(ContextIdx))
+		{
+			ExecuteJob(ContextIdx, Job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void UHJobSystem::WorkerThreadLoop(int32_t WorkerIdx)
+{
+	GJobSystemIdTLS = SystemId;
+	GJobContextIdxTLS = WorkerIdx;
+	UHCPUProfiler::SetThreadName("Job Worker " + std::to_string(WorkerIdx));
+
+	while (!bIsTerminated.load(std::memory_order_relaxed))
+	{
+		if (UHJob* Job = FindJob(WorkerIdx))
+		{
+			ExecuteJob(WorkerIdx, Job);
+			continue;
+		}
+
+		// spin a little before sleeping, jobs are usually scheduled in bursts
+		bool bHasJob = false;
+		for (int32_t Spin = 0; Spin < 64; Spin++)
+		{
+			if (NumQueuedJobs.load() > 0)
+			{
+				bHasJob = true;
+				break;
+			}
+			std::this_thread::yield();
+		}
+
+		if (bHasJob)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> Lock(SleepMutex);
+		NumSleepingWorkers++;
+		SleepCondition.wait(Lock, [this] { return NumQueuedJobs.load() > 0 || bIsTerminated.load(); });
+		NumSleepingWorkers--;
+	}
+}
+
+int32_t UHJobSystem::GetContextIndex()
+{
+	if (GJobSystemIdTLS == SystemId)
+	{
+		return GJobContextIdxTLS;
+	}
+
+	// first time this external thread touches the system, or it's switching between systems, register it
+	std::unique_lock<std::mutex> Lock(ExternalRegistry->Mutex);
+	std::vector<std::thread::id>& ExternalThreads = ExternalRegistry->Threads;
+	const std::thread::id ThisThread = std::this_thread::get_id();
+
+	int32_t ExternalIdx = -1;
+	int32_t FreeIdx = -1;
+	for (size_t Idx = 0; Idx < ExternalThreads.size(); Idx++)
+	{
+		if (ExternalThreads[Idx] == ThisThread)
+		{
+			ExternalIdx = static_cast<int32_t>(Idx);
+			break;
+		}
+
+		if (FreeIdx == -1 && ExternalThreads[Idx] == std::thread::id())
+		{
+			FreeIdx = static_cast<int32_t>(Idx);
+		}
+	}
+
+	if (ExternalIdx == -1)
+	{
+		// every context has a single owner, sharing one between threads would corrupt its deque and job pool
+		if (FreeIdx == -1)
+		{
+			UHE_LOG(L"More than " + std::to_wstring(ExternalThreads.size()) + L" external threads are using the same job system!\n");
+			assert(false);
+			std::abort();
+		}
+
+		// the previous owner of a recycled context has exited, so the jobs it left are taken over safely
+		ExternalIdx = FreeIdx;
+		ExternalThreads[ExternalIdx] = ThisThread;
+
+		// drop the registrations of released systems before adding a new one
+		std::vector<std::pair<std::weak_ptr<UHJobExternalRegistry>, int32_t>>& Registrations = GJobThreadRegistrationsTLS.Registrations;
+		Registrations.erase(std::remove_if(Registrations.begin(), Registrations.end()
+			, [](const std::pair<std::weak_ptr<UHJobExternalRegistry>, int32_t>& Registration) { return Registration.first.expired(); })
+			, Registrations.end());
+		Registrations.push_back(std::make_pair(std::weak_ptr<UHJobExternalRegistry>(ExternalRegistry), ExternalIdx));
+		NumActiveContexts.store(std::max(NumActiveContexts.load(), NumWorkers + ExternalIdx + 1), std::memory_order_release);
+	}
+
+	GJobSystemIdTLS = SystemId;
+	GJobContextIdxTLS = NumWorkers + ExternalIdx;
+	return GJobContextIdxTLS;
+}
+
+// allocate a job from the ring pool of a context, only the owner thread allocates from its pool
+// jobs are never moved since the queues and deferred list point to them, so the pool grows by pages
+UHJob* UHJobSystem::AllocateJob(int32_t ContextIdx)
+{
+	UHJobContext* Context = Contexts[ContextIdx].get();
+	const uint32_t NumJobs = static_cast<uint32_t>(Context->JobPages.size()) * JobsPerPage;
+
+	// probe a few slots after the last one, a job waiting for its dependency can hold a slot for long
+	const uint32_t NumProbes = std::min(NumJobs, MaxJobProbes);
+	for (uint32_t Probe = 0; Probe < NumProbes; Probe++)
+	{
+		const uint32_t Slot = Context->NextJob++ % NumJobs;
+		UHJob* Job = &Context->JobPages[Slot / JobsPerPage][Slot % JobsPerPage];
+		if (!Job->bIsActive.load(std::memory_order_acquire))
+		{
+			Job->bIsActive.store(true, std::memory_order_relaxed);
+			return Job;
+		}
+	}
+
+	// the ring is crowded with jobs which aren't finished yet
+	if (Context->JobPages.size() >= MaxJobPages)
+	{
+		return nullptr;
+	}
+
+	Context->JobPages.push_back(std::make_unique<UHJob[]>(JobsPerPage));
+	Context->NextJob = NumJobs + 1;
+
+	UHJob* Job = &Context->JobPages.back()[0];
+	Job->bIsActive.store(true, std::memory_order_relaxed);
+	return Job;
+}
+
+// allocate a job which must be scheduled, if the pool can't grow anymore, help finishing the jobs until a slot is free
+// running the job inline instead would ignore its dependency
+UHJob* UHJobSystem::AcquireJob(int32_t ContextIdx)
+{
+	UHJob* Job = AllocateJob(ContextIdx);
+	while (Job == nullptr)
+	{
+		if (UHJob* PendingJob = FindJob(ContextIdx))
+		{
+			ExecuteJob(ContextIdx, PendingJob);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+		Job = AllocateJob(ContextIdx);
+	}
+
+	return Job;
+}
+
+bool UHJobSystem::PushJob(int32_t ContextIdx, UHJob* InJob)
+{
+	if (!Contexts[ContextIdx]->Queue.Push(InJob))
+	{
+		return false;
+	}
+
+	NumQueuedJobs++;
+	WakeWorkers();
+	return true;
+}
+
+// pop from own queue first, then try stealing from a random victim
+UHJob* UHJobSystem::FindJob(int32_t ContextIdx)
+{
+	UHJobContext* Context = Contexts[ContextIdx].get();
+	if (UHJob* Job = Context->Queue.Pop())
+	{
+		NumQueuedJobs--;
+		return Job;
+	}
+
+	if (NumQueuedJobs.load(std::memory_order_relaxed) <= 0)
+	{
+		return nullptr;
+	}
+
+	// xorshift for picking the first victim
+	uint32_t& Seed = Context->RandomSeed;
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+
+	const int32_t NumContexts = NumActiveContexts.load(std::memory_order_acquire);
+	const int32_t StartIdx = static_cast<int32_t>(Seed % static_cast<uint32_t>(NumContexts));
+	for (int32_t Idx = 0; Idx < NumContexts; Idx++)
+	{
+		const int32_t VictimIdx = (StartIdx + Idx) % NumContexts;
+		if (VictimIdx == ContextIdx)
+		{
+			continue;
+		}
+
+		if (UHJob* Job = Contexts[VictimIdx]->Queue.Steal())
+		{
+			NumQueuedJobs--;
+			return Job;
+		}
+	}
+
+	return nullptr;
+}
+
+void UHJobSystem::ExecuteJob(int32_t ContextIdx, UHJob* InJob)
+{
+	UHCPUProfileScope Scope("Job");
+	if (InJob->Task != nullptr)
+	{
+		InJob->Task->DoTask(ContextIdx);
+	}
+	else
+	{
+		int32_t Begin = InJob->Begin;
+		int32_t End = InJob->End;
+		const int32_t Grain = InJob->Grain;
+		UHJobCounter* Counter = InJob->Counter;
+
+		while (Begin < End)
+		{
+			// lazy binary splitting, only split the range when the local queue runs dry
+			// so idle threads always have something to steal, while busy threads don't pay the splitting cost
+			if (End - Begin > Grain && Contexts[ContextIdx]->Queue.IsEmpty())
+			{
+				if (UHJob* SplitJob = AllocateJob(ContextIdx))
+				{
+					const int32_t Mid = Begin + (End - Begin) / 2;
+					SplitJob->Task = nullptr;
+					SplitJob->RangeFunction = InJob->RangeFunction;
+					SplitJob->Begin = Mid;
+					SplitJob->End = End;
+					SplitJob->Grain = Grain;
+					SplitJob->Counter = Counter;
+					SplitJob->Dependency = nullptr;
+
+					Counter->Value++;
+					if (PushJob(ContextIdx, SplitJob))
+					{
+						End = Mid;
+						continue;
+					}
+
+					// failed to push, keep the range and go on
+					Counter->Value--;
+					SplitJob->bIsActive.store(false, std::memory_order_release);
+				}
+			}
+
+			const int32_t ChunkEnd = std::min(Begin + Grain, End);
+			(*InJob->RangeFunction)(Begin, ChunkEnd, ContextIdx);
+			Begin = ChunkEnd;
+		}
+	}
+
+	FinishJob(ContextIdx, InJob);
+}
+
+void UHJobSystem::FinishJob(int32_t ContextIdx, UHJob* InJob)
+{
+	UHJobCounter* Counter = InJob->Counter;
+
+	// the job slot can be reused after this, don't touch it anymore
+	InJob->bIsActive.store(false, std::memory_order_release);
+
+	// the counter might be released by the waiter once it reaches zero, so it's the last access to the counter
+	if (Counter->Value.fetch_sub(1, std::memory_order_seq_cst) == 1 && NumDeferredJobs.load(std::memory_order_seq_cst) > 0)
+	{
+		ReleaseDeferredJobs(ContextIdx);
+	}
+}
+
+void UHJobSystem::SubmitJob(int32_t ContextIdx, UHJob* InJob)
+{
+	InJob->Counter->Value++;
+
+	if (InJob->Dependency != nullptr && !InJob->Dependency->IsDone())
+	{
+		std::unique_lock<std::mutex> Lock(DeferredMutex);
+		NumDeferredJobs.fetch_add(1, std::memory_order_seq_cst);
+
+		// check again after the deferred count is visible, the dependency could be done in the meantime
+		// both this and FinishJob() store then load with seq_cst, so at least one side sees the other and the job isn't lost
+		if (InJob->Dependency->Value.load(std::memory_order_seq_cst) != 0)
+		{
+			DeferredJobs.push_back(InJob);
+			return;
+		}
+		NumDeferredJobs--;
+	}
+
+	if (!PushJob(ContextIdx, InJob))
+	{
+		ExecuteJob(ContextIdx, InJob);
+	}
+}
+
+// kick off the deferred jobs whose dependency are done
+void UHJobSystem::ReleaseDeferredJobs(int32_t ContextIdx)
+{
+	std::vector<UHJob*> ReadyJobs;
+	{
+		std::unique_lock<std::mutex> Lock(DeferredMutex);
+		for (size_t Idx = 0; Idx < DeferredJobs.size();)
+		{
+			if (DeferredJobs[Idx]->Dependency->IsDone())
+			{
+				ReadyJobs.push_back(DeferredJobs[Idx]);
+				DeferredJobs[Idx] = DeferredJobs.back();
+				DeferredJobs.pop_back();
+				NumDeferredJobs--;
+			}
+			else
+			{
+				Idx++;
+			}
+		}
+	}
+
+	for (UHJob* Job : ReadyJobs)
+	{
+		if (!PushJob(ContextIdx, Job))
+		{
+			ExecuteJob(ContextIdx, Job);
+		}
+	}
+}
+
+void UHJobSystem::WakeWorkers()
+{
+	if (NumSleepingWorkers.load() > 0)
+	{
+		std::unique_lock<std::mutex> Lock(SleepMutex);
+		SleepCondition.notify_one();
+	}
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include "AsyncTask.h"
+
+// UH job system, a platform-neutral work-stealing scheduler
+// each worker owns a Chase-Lev deque, it pushes/pops at the bottom while the others steal from the top
+// threads which are not workers (main thread, render thread...) get their own deques when they first schedule jobs,
+// and they execute jobs while waiting for a counter instead of sleeping.
+// the context of an external thread is given back when the thread exits, so short-lived threads don't use up the contexts
+
+class UHJobSystem;
+typedef std::function<void(int32_t Begin, int32_t End, int32_t WorkerIdx)> UHParallelForFunction;
+
+// job counter, it's increased when a job is scheduled and decreased when a job is done
+// a counter can also be the dependency of other jobs, and these jobs are kicked off after the counter reaches zero
+class UHJobCounter
+{
+public:
+	UHJobCounter();
+	bool IsDone() const;
+	int32_t GetValue() const;
+
+private:
+	friend class UHJobSystem;
+	std::atomic<int32_t> Value;
+};
+
+// job data, either a single async task or a range of parallel-for
+struct UHJob
+{
+	UHJob();
+
+	UHAsyncTask* Task;
+	const UHParallelForFunction* RangeFunction;
+	int32_t Begin;
+	int32_t End;
+	int32_t Grain;
+	UHJobCounter* Counter;
+	const UHJobCounter* Dependency;
+	std::atomic<bool> bIsActive;
+};
+
+// fixed-size Chase-Lev deque, reference: "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+// only the owner thread can call Push() and Pop(), Steal() can be called from any thread
+class UHWorkStealingQueue
+{
+public:
+	UHWorkStealingQueue(uint32_t InCapacity);
+
+	bool Push(UHJob* InJob);
+	UHJob* Pop();
+	UHJob* Steal();
+	bool IsEmpty() const;
+
+private:
+	std::atomic<int64_t> Top;
+	std::atomic<int64_t> Bottom;
+	std::vector<std::atomic<UHJob*>> Buffer;
+	int64_t Mask;
+};
+
+// external thread slots of a job system, shared with the registered threads so they can give back their slots on exit
+// even if the system is released before them
+struct UHJobExternalRegistry
+{
+	std::mutex Mutex;
+	std::vector<std::thread::id> Threads;
+};
+
+class UHJobSystem
+{
+public:
+	UHJobSystem();
+	~UHJobSystem();
+
+	// start/stop worker threads, the system can still run jobs on the caller thread with zero worker
+	// workers can be given the starting affinity core, the same as UHThread
+	void Initialize(int32_t InNumWorkers);
+	void Initialize(int32_t InNumWorkers, uint32_t InAffinityCore);
+	void Release();
+
+	// number of workers and the number of thread contexts, the WorkerIdx passed to jobs is always in [0, GetNumContexts())
+	int32_t GetNumWorkers() const;
+	int32_t GetNumContexts() const;
+
+	// schedule a single task, the counter is increased before this function returns
+	// if a dependency is given, the task won't start until the dependency counter reaches zero
+	void Schedule(UHAsyncTask* InTask, UHJobCounter* InCounter, const UHJobCounter* InDependency = nullptr);
+
+	// schedule a parallel-for over [0, InCount), the range is split lazily into chunks no smaller than the grain size
+	// the function object must stay alive until the counter is done
+	void ScheduleParallelFor(int32_t InCount, int32_t InMinGrain, const UHParallelForFunction* InFunction
+		, UHJobCounter* InCounter, const UHJobCounter* InDependency = nullptr);
+
+	// blocking parallel-for, the caller joins the work until everything is finished
+	void ParallelFor(int32_t InCount, int32_t InMinGrain, const UHParallelForFunction& InFunction);
+
+	// wait a counter reaches zero, the caller keeps executing jobs instead of sleeping
+	void Wait(const UHJobCounter* InCounter);
+
+	// job pools grow by pages when the jobs in flight outnumber them, up to the max pages
+	// the scheduling thread helps finishing jobs if even that is exhausted, a job never runs before its dependency
+	static const uint32_t JobsPerPage = 1024;
+	static const uint32_t MaxJobPages = 64;
+	static const uint32_t MaxJobProbes = 8;
+	static const uint32_t QueueCapacity = 1024;
+
+	// external threads alive at the same time can't exceed the external contexts, it's a fatal error
+	// the number of external contexts is at least the minimum and twice the hardware threads
+	static const int32_t MinExternalContexts = 16;
+
+	// how many chunks per context a parallel-for aims for when the minimal grain size allows it
+	static const int32_t ChunksPerContext = 8;
+
+private:
+	struct alignas(64) UHJobContext
+	{
+		UHJobContext();
+
+		UHWorkStealingQueue Queue;
+		std::vector<std::unique_ptr<UHJob[]>> JobPages;
+		uint32_t NextJob;
+		uint32_t RandomSeed;
+	};
+
+	void WorkerThreadLoop(int32_t WorkerIdx);
+	int32_t GetContextIndex();
+	UHJob* AllocateJob(int32_t ContextIdx);
+	UHJob* AcquireJob(int32_t ContextIdx);
+	bool PushJob(int32_t ContextIdx, UHJob* InJob);
+	UHJob* FindJob(int32_t ContextIdx);
+	void ExecuteJob(int32_t ContextIdx, UHJob* InJob);
+	void FinishJob(int32_t ContextIdx, UHJob* InJob);
+	void SubmitJob(int32_t ContextIdx, UHJob* InJob);
+	void ReleaseDeferredJobs(int32_t ContextIdx);
+	void WakeWorkers();
+
+	uint64_t SystemId;
+	int32_t NumWorkers;
+	std::vector<std::unique_ptr<UHJobContext>> Contexts;
+	std::vector<std::thread> Workers;
+
+	// external thread registration, steals only visit the contexts which have been used
+	std::shared_ptr<UHJobExternalRegistry> ExternalRegistry;
+	std::atomic<int32_t> NumActiveContexts;
+
+	// jobs waiting for their dependency
+	std::mutex DeferredMutex;
+	std::vector<UHJob*> DeferredJobs;
+	std::atomic<int32_t> NumDeferredJobs;
+
+	// sleeping control
+	std::mutex SleepMutex;
+	std::condition_variable SleepCondition;
+	std::atomic<int32_t> NumQueuedJobs;
+	std::atomic<int32_t> NumSleepingWorkers;
+	std::atomic<bool> bIsTerminated;
+};
@@ -0,0 +1,512 @@
+#include "LightClustering.h"
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define UH_TARGET_AVX
+#else
+#define UH_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+UHLightClusterView::UHLightClusterView()
+	: CountX(0)
+	, CountY(0)
+	, Width(0.0f)
+	, Height(0.0f)
+	, NearPlane(0.0f)
+	, FarPlane(0.0f)
+	, SliceScale(0.0f)
+	, SliceBias(0.0f)
+	, ProjScaleX(0.0f)
+	, ProjScaleY(0.0f)
+	, View(MathHelpers::Identity4x4())
+{
+	for (uint32_t Slice = 0; Slice < NumSlices; Slice++)
+	{
+		SliceDepths[Slice] = 0.0f;
+	}
+}
+
+uint32_t UHLightClusterView::GetClusterCount() const
+{
+	return CountX * CountY * NumSlices;
+}
+
+uint32_t UHLightClusterView::GetEntryCount() const
+{
+	return GetClusterCount() * NumLightTypes;
+}
+
+UHLightClusterSpheres::UHLightClusterSpheres()
+	: NumPointLights(0)
+	, NumSpotLights(0)
+{
+
+}
+
+void UHLightClusterSpheres::Resize(uint32_t InNumPointLights, uint32_t InNumSpotLights)
+{
+	NumPointLights = InNumPointLights;
+	NumSpotLights = InNumSpotLights;
+
+	// padded lights are reset to zero radius
+	const uint32_t PaddedCount = GetPaddedCount();
+	CenterX.assign(PaddedCount, 0.0f);
+	CenterY.assign(PaddedCount, 0.0f);
+	CenterZ.assign(PaddedCount, 0.0f);
+	Radius.assign(PaddedCount, 0.0f);
+
+	MinX.resize(PaddedCount);
+	MaxX.resize(PaddedCount);
+	MinY.resize(PaddedCount);
+	MaxY.resize(PaddedCount);
+	MinZ.resize(PaddedCount);
+	MaxZ.resize(PaddedCount);
+}
+
+void UHLightClusterSpheres::SetSphere(uint32_t InIdx, const XMFLOAT3& InCenter, const float InRadius)
+{
+	CenterX[InIdx] = InCenter.x;
+	CenterY[InIdx] = InCenter.y;
+	CenterZ[InIdx] = InCenter.z;
+	Radius[InIdx] = InRadius;
+}
+
+uint32_t UHLightClusterSpheres::GetCount() const
+{
+	return NumPointLights + NumSpotLights;
+}
+
+uint32_t UHLightClusterSpheres::GetPaddedCount() const
+{
+	return (GetCount() + LightsPerBatch - 1) / LightsPerBatch * LightsPerBatch;
+}
+
+namespace UHLightClustering
+{
+	UHLightClusterView BuildView(uint32_t InWidth, uint32_t InHeight, const XMFLOAT4X4& InView, const XMFLOAT4X4& InProjection
+		, const float InNearPlane, const float InFarPlane)
+	{
+		UHLightClusterView Result;
+		Result.CountX = std::max((InWidth + UHLightClusterView::TileSize - 1) / UHLightClusterView::TileSize, 1u);
+		Result.CountY = std::max((InHeight + UHLightClusterView::TileSize - 1) / UHLightClusterView::TileSize, 1u);
+		Result.Width = static_cast<float>(InWidth);
+		Result.Height = static_cast<float>(InHeight);
+
+		// slices need a depth range to distribute
+		Result.NearPlane = InNearPlane;
+		Result.FarPlane = std::max(InFarPlane, InNearPlane * 2.0f);
+
+		const float NumSlices = static_cast<float>(UHLightClusterView::NumSlices);
+		const float DepthRatio = Result.FarPlane / Result.NearPlane;
+		Result.SliceScale = NumSlices / std::log2(DepthRatio);
+		Result.SliceBias = -std::log2(Result.NearPlane) * Result.SliceScale;
+
+		Result.ProjScaleX = InProjection._11;
+		Result.ProjScaleY = InProjection._22;
+		Result.View = InView;
+
+		for (uint32_t Slice = 0; Slice < UHLightClusterView::NumSlices; Slice++)
+		{
+			Result.SliceDepths[Slice] = Result.NearPlane * std::pow(DepthRatio, Slice / NumSlices);
+		}
+
+		return Result;
+	}
+
+	XMFLOAT4 GetSpotLightBound(const XMFLOAT3& InPosition, const XMFLOAT3& InDir, const float InRange, const float InAngle)
+	{
+		// wide cones use the sphere of the whole light range
+		if (InAngle >= XM_PIDIV2)
+		{
+			return XMFLOAT4(InPosition.x, InPosition.y, InPosition.z, InRange);
+		}
+
+		// the sphere through the apex and the rim for narrow cones, otherwise the sphere centered at the rim
+		const float CosAngle = std::cos(InAngle);
+		const float Offset = (InAngle > XM_PIDIV4) ? InRange * CosAngle : InRange / (2.0f * CosAngle);
+		const float Radius = (InAngle > XM_PIDIV4) ? InRange * std::sin(InAngle) : Offset;
+
+		return XMFLOAT4(InPosition.x + InDir.x * Offset, InPosition.y + InDir.y * Offset, InPosition.z + InDir.z * Offset, Radius);
+	}
+
+	uint32_t GetSlice(const UHLightClusterView& InView, const float InViewZ)
+	{
+		uint32_t Slice = 0;
+		for (uint32_t Idx = 1; Idx < UHLightClusterView::NumSlices; Idx++)
+		{
+			Slice += (InView.SliceDepths[Idx] <= InViewZ) ? 1 : 0;
+		}
+
+		return Slice;
+	}
+
+	// scalar reference, the SIMD kernels follow the same operation order so they output the same ranges
+	void ComputeRangesScalar(const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres, uint32_t InBegin, uint32_t InEnd)
+	{
+		const XMFLOAT4X4& V = InView.View;
+		const float HalfWidth = InView.Width * 0.5f;
+		const float HalfHeight = InView.Height * 0.5f;
+		const float ScaleX = InView.ProjScaleX * HalfWidth;
+		const float ScaleY = InView.ProjScaleY * HalfHeight;
+		const float InvTileSize = 1.0f / UHLightClusterView::TileSize;
+		const float CountX = static_cast<float>(InView.CountX);
+		const float CountY = static_cast<float>(InView.CountY);
+		const float LastX = CountX - 1.0f;
+		const float LastY = CountY - 1.0f;
+
+		for (uint32_t Idx = InBegin; Idx < InEnd; Idx++)
+		{
+			const float CX = InOutSpheres.CenterX[Idx];
+			const float CY = InOutSpheres.CenterY[Idx];
+			const float CZ = InOutSpheres.CenterZ[Idx];
+			const float R = InOutSpheres.Radius[Idx];
+
+			// view space with z pointing forward
+			const float VX = CX * V._11 + CY * V._21 + CZ * V._31 + V._41;
+			const float VY = CX * V._12 + CY * V._22 + CZ * V._32 + V._42;
+			const float VZ = -(CX * V._13 + CY * V._23 + CZ * V._33 + V._43);
+			const float ZMin = VZ - R;
+			const float ZMax = VZ + R;
+
+			// project the tangent lines of the sphere in xz and yz planes, it's only valid when the sphere is in front of the near plane
+			float PixelMinX = 0.0f;
+			float PixelMaxX = InView.Width;
+			float PixelMinY = 0.0f;
+			float PixelMaxY = InView.Height;
+			if (ZMin >= InView.NearPlane)
+			{
+				const float RR = R * R;
+				const float TX = std::sqrt(VX * VX + VZ * VZ - RR);
+				const float SlopeMinX = (VX * TX - R * VZ) / (VZ * TX + R * VX);
+				const float SlopeMaxX = (VX * TX + R * VZ) / (VZ * TX - R * VX);
+				const float AX = SlopeMinX * ScaleX + HalfWidth;
+				const float BX = SlopeMaxX * ScaleX + HalfWidth;
+				PixelMinX = std::min(AX, BX);
+				PixelMaxX = std::max(AX, BX);
+
+				const float TY = std::sqrt(VY * VY + VZ * VZ - RR);
+				const float SlopeMinY = (VY * TY - R * VZ) / (VZ * TY + R * VY);
+				const float SlopeMaxY = (VY * TY + R * VZ) / (VZ * TY - R * VY);
+				const float AY = SlopeMinY * ScaleY + HalfHeight;
+				const float BY = SlopeMaxY * ScaleY + HalfHeight;
+				PixelMinY = std::min(AY, BY);
+				PixelMaxY = std::max(AY, BY);
+			}
+
+			// a pixel of margin for the jitter
+			const float TileMinX = (PixelMinX - 1.0f) * InvTileSize;
+			const float TileMaxX = (PixelMaxX + 1.0f) * InvTileSize;
+			const float TileMinY = (PixelMinY - 1.0f) * InvTileSize;
+			const float TileMaxY = (PixelMaxY + 1.0f) * InvTileSize;
+
+			const bool bAssigned = (R > 0.0f) && (ZMax >= InView.NearPlane)
+				&& (TileMaxX >= 0.0f) && (TileMinX < CountX) && (TileMaxY >= 0.0f) && (TileMinY < CountY);
+
+			float SliceMin = 0.0f;
+			float SliceMax = 0.0f;
+			for (uint32_t Slice = 1; Slice < UHLightClusterView::NumSlices; Slice++)
+			{
+				SliceMin += (InView.SliceDepths[Slice] <= ZMin) ? 1.0f : 0.0f;
+				SliceMax += (InView.SliceDepths[Slice] <= ZMax) ? 1.0f : 0.0f;
+			}
+
+			// ranges are clamped to the grid before truncating, so truncating is the same as flooring
+			InOutSpheres.MinX[Idx] = static_cast<int32_t>(std::max(TileMinX, 0.0f));
+			InOutSpheres.MaxX[Idx] = static_cast<int32_t>(std::min(TileMaxX, LastX));
+			InOutSpheres.MinY[Idx] = static_cast<int32_t>(std::max(TileMinY, 0.0f));
+			InOutSpheres.MaxY[Idx] = static_cast<int32_t>(std::min(TileMaxY, LastY));
+			InOutSpheres.MinZ[Idx] = static_cast<int32_t>(SliceMin);
+			InOutSpheres.MaxZ[Idx] = static_cast<int32_t>(bAssigned ? SliceMax : -1.0f);
+		}
+	}
+
+	inline __m128 SelectSSE(const __m128 InMask, const __m128 InA, const __m128 InB)
+	{
+		return _mm_or_ps(_mm_and_ps(InMask, InA), _mm_andnot_ps(InMask, InB));
+	}
+
+	// 4 lights per iteration, lights in front of the near plane select the projected ranges
+	void ComputeRangesSSE(const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres, uint32_t InBegin, uint32_t InEnd)
+	{
+		const XMFLOAT4X4& V = InView.View;
+		const __m128 V11 = _mm_set1_ps(V._11);
+		const __m128 V21 = _mm_set1_ps(V._21);
+		const __m128 V31 = _mm_set1_ps(V._31);
+		const __m128 V41 = _mm_set1_ps(V._41);
+		const __m128 V12 = _mm_set1_ps(V._12);
+		const __m128 V22 = _mm_set1_ps(V._22);
+		const __m128 V32 = _mm_set1_ps(V._32);
+		const __m128 V42 = _mm_set1_ps(V._42);
+		const __m128 V13 = _mm_set1_ps(V._13);
+		const __m128 V23 = _mm_set1_ps(V._23);
+		const __m128 V33 = _mm_set1_ps(V._33);
+		const __m128 V43 = _mm_set1_ps(V._43);
+
+		const __m128 SignMask = _mm_set1_ps(-0.0f);
+		const __m128 Zero = _mm_setzero_ps();
+		const __m128 One = _mm_set1_ps(1.0f);
+		const __m128 MinusOne = _mm_set1_ps(-1.0f);
+		const __m128 Near = _mm_set1_ps(InView.NearPlane);
+		const __m128 Width = _mm_set1_ps(InView.Width);
+		const __m128 Height = _mm_set1_ps(InView.Height);
+		const __m128 HalfWidth = _mm_set1_ps(InView.Width * 0.5f);
+		const __m128 HalfHeight = _mm_set1_ps(InView.Height * 0.5f);
+		const __m128 ScaleX = _mm_set1_ps(InView.ProjScaleX * (InView.Width * 0.5f));
+		const __m128 ScaleY = _mm_set1_ps(InView.ProjScaleY * (InView.Height * 0.5f));
+		const __m128 InvTileSize = _mm_set1_ps(1.0f / UHLightClusterView::TileSize);
+		const __m128 CountX = _mm_set1_ps(static_cast<float>(InView.CountX));
+		const __m128 CountY = _mm_set1_ps(static_cast<float>(InView.CountY));
+		const __m128 LastX = _mm_sub_ps(CountX, One);
+		const __m128 LastY = _mm_sub_ps(CountY, One);
+
+		for (uint32_t Idx = InBegin; Idx < InEnd; Idx += 4)
+		{
+			const __m128 CX = _mm_loadu_ps(&InOutSpheres.CenterX[Idx]);
+			const __m128 CY = _mm_loadu_ps(&InOutSpheres.CenterY[Idx]);
+			const __m128 CZ = _mm_loadu_ps(&InOutSpheres.CenterZ[Idx]);
+			const __m128 R = _mm_loadu_ps(&InOutSpheres.Radius[Idx]);
+
+			const __m128 VX = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(CX, V11), _mm_mul_ps(CY, V21)), _mm_mul_ps(CZ, V31)), V41);
+			const __m128 VY = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(CX, V12), _mm_mul_ps(CY, V22)), _mm_mul_ps(CZ, V32)), V42);
+			const __m128 VZ = _mm_xor_ps(SignMask
+				, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(CX, V13), _mm_mul_ps(CY, V23)), _mm_mul_ps(CZ, V33)), V43));
+			const __m128 ZMin = _mm_sub_ps(VZ, R);
+			const __m128 ZMax = _mm_add_ps(VZ, R);
+			const __m128 Projected = _mm_cmpge_ps(ZMin, Near);
+
+			// lanes behind the near plane may get NaN here, they're replaced by the select
+			const __m128 RR = _mm_mul_ps(R, R);
+			const __m128 VZ2 = _mm_mul_ps(VZ, VZ);
+			const __m128 RVZ = _mm_mul_ps(R, VZ);
+
+			const __m128 TX = _mm_sqrt_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(VX, VX), VZ2), RR));
+			const __m128 SlopeMinX = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(VX, TX), RVZ), _mm_add_ps(_mm_mul_ps(VZ, TX), _mm_mul_ps(R, VX)));
+			const __m128 SlopeMaxX = _mm_div_ps(_mm_add_ps(_mm_mul_ps(VX, TX), RVZ), _mm_sub_ps(_mm_mul_ps(VZ, TX), _mm_mul_ps(R, VX)));
+			const __m128 AX = _mm_add_ps(_mm_mul_ps(SlopeMinX, ScaleX), HalfWidth);
+			const __m128 BX = _mm_add_ps(_mm_mul_ps(SlopeMaxX, ScaleX), HalfWidth);
+			const __m128 PixelMinX = SelectSSE(Projected, _mm_min_ps(AX, BX), Zero);
+			const __m128 PixelMaxX = SelectSSE(Projected, _mm_max_ps(AX, BX), Width);
+
+			const __m128 TY = _mm_sqrt_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(VY, VY), VZ2), RR));
+			const __m128 SlopeMinY = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(VY, TY), RVZ), _mm_add_ps(_mm_mul_ps(VZ, TY), _mm_mul_ps(R, VY)));
+			const __m128 SlopeMaxY = _mm_div_ps(_mm_add_ps(_mm_mul_ps(VY, TY), RVZ), _mm_sub_ps(_mm_mul_ps(VZ, TY), _mm_mul_ps(R, VY)));
+			const __m128 AY = _mm_add_ps(_mm_mul_ps(SlopeMinY, ScaleY), HalfHeight);
+			const __m128 BY = _mm_add_ps(_mm_mul_ps(SlopeMaxY, ScaleY), HalfHeight);
+			const __m128 PixelMinY = SelectSSE(Projected, _mm_min_ps(AY, BY), Zero);
+			const __m128 PixelMaxY = SelectSSE(Projected, _mm_max_ps(AY, BY), Height);
+
+			const __m128 TileMinX = _mm_mul_ps(_mm_sub_ps(PixelMinX, One), InvTileSize);
+			const __m128 TileMaxX = _mm_mul_ps(_mm_add_ps(PixelMaxX, One), InvTileSize);
+			const __m128 TileMinY = _mm_mul_ps(_mm_sub_ps(PixelMinY, One), InvTileSize);
+			const __m128 TileMaxY = _mm_mul_ps(_mm_add_ps(PixelMaxY, One), InvTileSize);
+
+			__m128 Assigned = _mm_and_ps(_mm_cmpgt_ps(R, Zero), _mm_cmpge_ps(ZMax, Near));
+			Assigned = _mm_and_ps(Assigned, _mm_and_ps(_mm_cmpge_ps(TileMaxX, Zero), _mm_cmplt_ps(TileMinX, CountX)));
+			Assigned = _mm_and_ps(Assigned, _mm_and_ps(_mm_cmpge_ps(TileMaxY, Zero), _mm_cmplt_ps(TileMinY, CountY)));
+
+			__m128 SliceMin = Zero;
+			__m128 SliceMax = Zero;
+			for (uint32_t Slice = 1; Slice < UHLightClusterView::NumSlices; Slice++)
+			{
+				const __m128 Depth = _mm_set1_ps(InView.SliceDepths[Slice]);
+				SliceMin = _mm_add_ps(SliceMin, _mm_and_ps(_mm_cmple_ps(Depth, ZMin), One));
+				SliceMax = _mm_add_ps(SliceMax, _mm_and_ps(_mm_cmple_ps(Depth, ZMax), One));
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&InOutSpheres.MinX[Idx]), _mm_cvttps_epi32(_mm_max_ps(TileMinX, Zero)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&InOutSpheres.MaxX[Idx]), _mm_cvttps_epi32(_mm_min_ps(TileMaxX, LastX)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&InOutSpheres.MinY[Idx]), _mm_cvttps_epi32(_mm_max_ps(TileMinY, Zero)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&InOutSpheres.MaxY[Idx]), _mm_cvttps_epi32(_mm_min_ps(TileMaxY, LastY)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&InOutSpheres.MinZ[Idx]), _mm_cvttps_epi32(SliceMin));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&InOutSpheres.MaxZ[Idx]), _mm_cvttps_epi32(SelectSSE(Assigned, SliceMax, MinusOne)));
+		}
+	}
+
+	UH_TARGET_AVX inline __m256 SelectAVX(const __m256 InMask, const __m256 InA, const __m256 InB)
+	{
+		return _mm256_blendv_ps(InB, InA, InMask);
+	}
+
+	// 8 lights per iteration, only AVX float instructions are used so it doesn't require AVX2
+	UH_TARGET_AVX void ComputeRangesAVX(const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres, uint32_t InBegin, uint32_t InEnd)
+	{
+		const XMFLOAT4X4& V = InView.View;
+		const __m256 V11 = _mm256_set1_ps(V._11);
+		const __m256 V21 = _mm256_set1_ps(V._21);
+		const __m256 V31 = _mm256_set1_ps(V._31);
+		const __m256 V41 = _mm256_set1_ps(V._41);
+		const __m256 V12 = _mm256_set1_ps(V._12);
+		const __m256 V22 = _mm256_set1_ps(V._22);
+		const __m256 V32 = _mm256_set1_ps(V._32);
+		const __m256 V42 = _mm256_set1_ps(V._42);
+		const __m256 V13 = _mm256_set1_ps(V._13);
+		const __m256 V23 = _mm256_set1_ps(V._23);
+		const __m256 V33 = _mm256_set1_ps(V._33);
+		const __m256 V43 = _mm256_set1_ps(V._43);
+
+		const __m256 SignMask = _mm256_set1_ps(-0.0f);
+		const __m256 Zero = _mm256_setzero_ps();
+		const __m256 One = _mm256_set1_ps(1.0f);
+		const __m256 MinusOne = _mm256_set1_ps(-1.0f);
+		const __m256 Near = _mm256_set1_ps(InView.NearPlane);
+		const __m256 Width = _mm256_set1_ps(InView.Width);
+		const __m256 Height = _mm256_set1_ps(InView.Height);
+		const __m256 HalfWidth = _mm256_set1_ps(InView.Width * 0.5f);
+		const __m256 HalfHeight = _mm256_set1_ps(InView.Height * 0.5f);
+		const __m256 ScaleX = _mm256_set1_ps(InView.ProjScaleX * (InView.Width * 0.5f));
+		const __m256 ScaleY = _mm256_set1_ps(InView.ProjScaleY * (InView.Height * 0.5f));
+		const __m256 InvTileSize = _mm256_set1_ps(1.0f / UHLightClusterView::TileSize);
+		const __m256 CountX = _mm256_set1_ps(static_cast<float>(InView.CountX));
+		const __m256 CountY = _mm256_set1_ps(static_cast<float>(InView.CountY));
+		const __m256 LastX = _mm256_sub_ps(CountX, One);
+		const __m256 LastY = _mm256_sub_ps(CountY, One);
+
+		for (uint32_t Idx = InBegin; Idx < InEnd; Idx += 8)
+		{
+			const __m256 CX = _mm256_loadu_ps(&InOutSpheres.CenterX[Idx]);
+			const __m256 CY = _mm256_loadu_ps(&InOutSpheres.CenterY[Idx]);
+			const __m256 CZ = _mm256_loadu_ps(&InOutSpheres.CenterZ[Idx]);
+			const __m256 R = _mm256_loadu_ps(&InOutSpheres.Radius[Idx]);
+
+			const __m256 VX = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(CX, V11), _mm256_mul_ps(CY, V21)), _mm256_mul_ps(CZ, V31)), V41);
+			const __m256 VY = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(CX, V12), _mm256_mul_ps(CY, V22)), _mm256_mul_ps(CZ, V32)), V42);
+			const __m256 VZ = _mm256_xor_ps(SignMask
+				, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(CX, V13), _mm256_mul_ps(CY, V23)), _mm256_mul_ps(CZ, V33)), V43));
+			const __m256 ZMin = _mm256_sub_ps(VZ, R);
+			const __m256 ZMax = _mm256_add_ps(VZ, R);
+			const __m256 Projected = _mm256_cmp_ps(ZMin, Near, _CMP_GE_OQ);
+
+			const __m256 RR = _mm256_mul_ps(R, R);
+			const __m256 VZ2 = _mm256_mul_ps(VZ, VZ);
+			const __m256 RVZ = _mm256_mul_ps(R, VZ);
+
+			const __m256 TX = _mm256_sqrt_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(VX, VX), VZ2), RR));
+			const __m256 SlopeMinX = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(VX, TX), RVZ), _mm256_add_ps(_mm256_mul_ps(VZ, TX), _mm256_mul_ps(R, VX)));
+			const __m256 SlopeMaxX = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(VX, TX), RVZ), _mm256_sub_ps(_mm256_mul_ps(VZ, TX), _mm256_mul_ps(R, VX)));
+			const __m256 AX = _mm256_add_ps(_mm256_mul_ps(SlopeMinX, ScaleX), HalfWidth);
+			const __m256 BX = _mm256_add_ps(_mm256_mul_ps(SlopeMaxX, ScaleX), HalfWidth);
+			const __m256 PixelMinX = SelectAVX(Projected, _mm256_min_ps(AX, BX), Zero);
+			const __m256 PixelMaxX = SelectAVX(Projected, _mm256_max_ps(AX, BX), Width);
+
+			const __m256 TY = _mm256_sqrt_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(VY, VY), VZ2), RR));
+			const __m256 SlopeMinY = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(VY, TY), RVZ), _mm256_add_ps(_mm256_mul_ps(VZ, TY), _mm256_mul_ps(R, VY)));
+			const __m256 SlopeMaxY = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(VY, TY), RVZ), _mm256_sub_ps(_mm256_mul_ps(VZ, TY), _mm256_mul_ps(R, VY)));
+			const __m256 AY = _mm256_add_ps(_mm256_mul_ps(SlopeMinY, ScaleY), HalfHeight);
+			const __m256 BY = _mm256_add_ps(_mm256_mul_ps(SlopeMaxY, ScaleY), HalfHeight);
+			const __m256 PixelMinY = SelectAVX(Projected, _mm256_min_ps(AY, BY), Zero);
+			const __m256 PixelMaxY = SelectAVX(Projected, _mm256_max_ps(AY, BY), Height);
+
+			const __m256 TileMinX = _mm256_mul_ps(_mm256_sub_ps(PixelMinX, One), InvTileSize);
+			const __m256 TileMaxX = _mm256_mul_ps(_mm256_add_ps(PixelMaxX, One), InvTileSize);
+			const __m256 TileMinY = _mm256_mul_ps(_mm256_sub_ps(PixelMinY, One), InvTileSize);
+			const __m256 TileMaxY = _mm256_mul_ps(_mm256_add_ps(PixelMaxY, One), InvTileSize);
+
+			__m256 Assigned = _mm256_and_ps(_mm256_cmp_ps(R, Zero, _CMP_GT_OQ), _mm256_cmp_ps(ZMax, Near, _CMP_GE_OQ));
+			Assigned = _mm256_and_ps(Assigned, _mm256_and_ps(_mm256_cmp_ps(TileMaxX, Zero, _CMP_GE_OQ), _mm256_cmp_ps(TileMinX, CountX, _CMP_LT_OQ)));
+			Assigned = _mm256_and_ps(Assigned, _mm256_and_ps(_mm256_cmp_ps(TileMaxY, Zero, _CMP_GE_OQ), _mm256_cmp_ps(TileMinY, CountY, _CMP_LT_OQ)));
+
+			__m256 SliceMin = Zero;
+			__m256 SliceMax = Zero;
+			for (uint32_t Slice = 1; Slice < UHLightClusterView::NumSlices; Slice++)
+			{
+				const __m256 Depth = _mm256_set1_ps(InView.SliceDepths[Slice]);
+				SliceMin = _mm256_add_ps(SliceMin, _mm256_and_ps(_mm256_cmp_ps(Depth, ZMin, _CMP_LE_OQ), One));
+				SliceMax = _mm256_add_ps(SliceMax, _mm256_and_ps(_mm256_cmp_ps(Depth, ZMax, _CMP_LE_OQ), One));
+			}
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&InOutSpheres.MinX[Idx]), _mm256_cvttps_epi32(_mm256_max_ps(TileMinX, Zero)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&InOutSpheres.MaxX[Idx]), _mm256_cvttps_epi32(_mm256_min_ps(TileMaxX, LastX)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&InOutSpheres.MinY[Idx]), _mm256_cvttps_epi32(_mm256_max_ps(TileMinY, Zero)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&InOutSpheres.MaxY[Idx]), _mm256_cvttps_epi32(_mm256_min_ps(TileMaxY, LastY)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&InOutSpheres.MinZ[Idx]), _mm256_cvttps_epi32(SliceMin));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&InOutSpheres.MaxZ[Idx]), _mm256_cvttps_epi32(SelectAVX(Assigned, SliceMax, MinusOne)));
+		}
+	}
+
+	void ComputeRanges(UHCullingSIMDLevel InLevel, const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres
+		, uint32_t InBatchBegin, uint32_t InBatchEnd)
+	{
+		const uint32_t Begin = InBatchBegin * UHLightClusterSpheres::LightsPerBatch;
+		const uint32_t End = std::min(InBatchEnd * UHLightClusterSpheres::LightsPerBatch, InOutSpheres.GetPaddedCount());
+		if (Begin >= End)
+		{
+			return;
+		}
+
+		switch (InLevel)
+		{
+		case UHCullingSIMDLevel::AVX:
+			ComputeRangesAVX(InView, InOutSpheres, Begin, End);
+			break;
+
+		case UHCullingSIMDLevel::SSE:
+			ComputeRangesSSE(InView, InOutSpheres, Begin, End);
+			break;
+
+		default:
+			ComputeRangesScalar(InView, InOutSpheres, Begin, End);
+			break;
+		}
+	}
+
+	void ComputeRanges(const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres, uint32_t InBatchBegin, uint32_t InBatchEnd)
+	{
+		ComputeRanges(UHFrustumCulling::GetSIMDLevel(), InView, InOutSpheres, InBatchBegin, InBatchEnd);
+	}
+
+	// visit the entries of all clusters covered by a light
+	template <typename T>
+	void ForEachLightEntry(const UHLightClusterView& InView, const UHLightClusterSpheres& InSpheres, uint32_t InIdx, T&& InFunc)
+	{
+		const uint32_t LightType = (InIdx < InSpheres.NumPointLights) ? 0 : 1;
+		for (int32_t Z = InSpheres.MinZ[InIdx]; Z <= InSpheres.MaxZ[InIdx]; Z++)
+		{
+			for (int32_t Y = InSpheres.MinY[InIdx]; Y <= InSpheres.MaxY[InIdx]; Y++)
+			{
+				const uint32_t RowBegin = (Y + Z * InView.CountY) * InView.CountX;
+				for (int32_t X = InSpheres.MinX[InIdx]; X <= InSpheres.MaxX[InIdx]; X++)
+				{
+					InFunc((RowBegin + X) * UHLightClusterView::NumLightTypes + LightType);
+				}
+			}
+		}
+	}
+
+	uint32_t BuildLists(const UHLightClusterView& InView, const UHLightClusterSpheres& InSpheres
+		, std::vector<UHLightClusterEntry>& OutEntries, std::vector<uint32_t>& OutIndices)
+	{
+		OutEntries.assign(InView.GetEntryCount(), UHLightClusterEntry{ 0, 0 });
+		const uint32_t LightCount = InSpheres.GetCount();
+
+		// count the lights of each entry, then the prefix sum is the offset
+		for (uint32_t Idx = 0; Idx < LightCount; Idx++)
+		{
+			ForEachLightEntry(InView, InSpheres, Idx, [&OutEntries](uint32_t InEntry)
+				{
+					OutEntries[InEntry].Count++;
+				});
+		}
+
+		uint32_t NumIndices = 0;
+		for (UHLightClusterEntry& Entry : OutEntries)
+		{
+			Entry.Offset = NumIndices;
+			NumIndices += Entry.Count;
+			Entry.Count = 0;
+		}
+
+		// fill in the light order, so indices are sorted in each entry
+		OutIndices.resize(NumIndices);
+		for (uint32_t Idx = 0; Idx < LightCount; Idx++)
+		{
+			const uint32_t LightIdx = (Idx < InSpheres.NumPointLights) ? Idx : Idx - InSpheres.NumPointLights;
+			ForEachLightEntry(InView, InSpheres, Idx, [&OutEntries, &OutIndices, LightIdx](uint32_t InEntry)
+				{
+					UHLightClusterEntry& Entry = OutEntries[InEntry];
+					OutIndices[Entry.Offset + Entry.Count++] = LightIdx;
+				});
+		}
+
+		return NumIndices;
+	}
+}
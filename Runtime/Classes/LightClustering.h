@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+#include "FrustumCulling.h"
+
+// view parameters of light clustering, a cluster (froxel) is a screen tile split by exponential depth slices
+// depth is the view space z pointing forward, the same as WorldToViewPos() in shaders, and the last slice extends to infinity
+struct UHLightClusterView
+{
+	UHLightClusterView();
+
+	uint32_t GetClusterCount() const;
+	uint32_t GetEntryCount() const;
+
+	// must match UHLIGHTCLUSTER_TILESIZE and UHLIGHTCLUSTER_SLICES in shaders
+	static const uint32_t TileSize = 64;
+	static const uint32_t NumSlices = 32;
+
+	// each cluster has an entry per light type, point lights first and spot lights second
+	static const uint32_t NumLightTypes = 2;
+
+	uint32_t CountX;
+	uint32_t CountY;
+	float Width;
+	float Height;
+	float NearPlane;
+	float FarPlane;
+
+	// slice = floor(log2(z) * SliceScale + SliceBias) in shaders
+	float SliceScale;
+	float SliceBias;
+
+	// P00 and P11 of the non-jittered projection
+	float ProjScaleX;
+	float ProjScaleY;
+	XMFLOAT4X4 View;
+
+	// the depth where each slice begins, the CPU kernels count the boundaries instead of calculating log2
+	// so all kernels get the same slices
+	float SliceDepths[NumSlices];
+};
+
+// offset and count of a cluster entry in the index list, the same layout as the GPU cluster grid
+struct UHLightClusterEntry
+{
+	uint32_t Offset;
+	uint32_t Count;
+};
+
+// world space bounding spheres of lights in SoA layout, point lights first and spot lights second
+// the storage is padded to a multiple of 8 lights, padded lights have zero radius and are never assigned
+struct UHLightClusterSpheres
+{
+	UHLightClusterSpheres();
+
+	void Resize(uint32_t InNumPointLights, uint32_t InNumSpotLights);
+	void SetSphere(uint32_t InIdx, const XMFLOAT3& InCenter, const float InRadius);
+
+	uint32_t GetCount() const;
+	uint32_t GetPaddedCount() const;
+
+	static const uint32_t LightsPerBatch = 8;
+
+	uint32_t NumPointLights;
+	uint32_t NumSpotLights;
+	std::vector<float> CenterX;
+	std::vector<float> CenterY;
+	std::vector<float> CenterZ;
+	std::vector<float> Radius;
+
+	// inclusive cluster range of each light, a light isn't assigned when MinZ > MaxZ
+	std::vector<int32_t> MinX;
+	std::vector<int32_t> MaxX;
+	std::vector<int32_t> MinY;
+	std::vector<int32_t> MaxY;
+	std::vector<int32_t> MinZ;
+	std::vector<int32_t> MaxZ;
+};
+
+namespace UHLightClustering
+{
+	UHLightClusterView BuildView(uint32_t InWidth, uint32_t InHeight, const XMFLOAT4X4& InView, const XMFLOAT4X4& InProjection
+		, const float InNearPlane, const float InFarPlane);
+
+	// the bounding sphere of the lit region of a spot light, it's a spherical sector with the half angle InAngle
+	XMFLOAT4 GetSpotLightBound(const XMFLOAT3& InPosition, const XMFLOAT3& InDir, const float InRange, const float InAngle);
+
+	// slice of a view depth, it's clamped to the last slice
+	uint32_t GetSlice(const UHLightClusterView& InView, const float InViewZ);
+
+	// calculate cluster ranges of lights in [InBatchBegin * 8, InBatchEnd * 8), the range is conservative:
+	// the sphere is projected with its tangent planes, and lights intersecting the near plane cover the whole screen
+	// it's expanded by a pixel, so the jittered projection is still covered
+	void ComputeRanges(const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres, uint32_t InBatchBegin, uint32_t InBatchEnd);
+
+	// the same as above but with a specific kernel, mainly for validation and profiling
+	void ComputeRanges(UHCullingSIMDLevel InLevel, const UHLightClusterView& InView, UHLightClusterSpheres& InOutSpheres
+		, uint32_t InBatchBegin, uint32_t InBatchEnd);
+
+	// build compact index lists from the ranges, indices are light indices of their own type and sorted in each cluster
+	// returns the number of indices
+	uint32_t BuildLists(const UHLightClusterView& InView, const UHLightClusterSpheres& InSpheres
+		, std::vector<UHLightClusterEntry>& OutEntries, std::vector<uint32_t>& OutIndices);
+}
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+UHMappedFile::UHMappedFile()
+	: FileHandle(INVALID_HANDLE_VALUE)
+	, MappingHandle(nullptr)
+	, MappedData(nullptr)
+	, MappedSize(0)
+{
+
+}
+
+UHMappedFile::~UHMappedFile()
+{
+	Close();
+}
+
+bool UHMappedFile::Open(const std::filesystem::path& InPath)
+{
+	Close();
+
+	// sequential scan hint since the loaders walk the chunks from front to back
+	FileHandle = CreateFileW(InPath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING
+		, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER FileSize{};
+	if (!GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0)
+	{
+		// empty file can't be mapped
+		Close();
+		return false;
+	}
+
+	MappingHandle = CreateFileMappingW(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (MappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	MappedData = static_cast<const uint8_t*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (MappedData == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	MappedSize = static_cast<size_t>(FileSize.QuadPart);
+	return true;
+}
+
+void UHMappedFile::Close()
+{
+	if (MappedData != nullptr)
+	{
+		UnmapViewOfFile(MappedData);
+		MappedData = nullptr;
+	}
+
+	if (MappingHandle != nullptr)
+	{
+		CloseHandle(MappingHandle);
+		MappingHandle = nullptr;
+	}
+
+	if (FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(FileHandle);
+		FileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	MappedSize = 0;
+}
+
+const uint8_t* UHMappedFile::GetData() const
+{
+	return MappedData;
+}
+
+size_t UHMappedFile::GetSize() const
+{
+	return MappedSize;
+}
+
+bool UHMappedFile::IsOpened() const
+{
+	return MappedData != nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include <filesystem>
+#include "../../UnheardEngine.h"
+
+// read-only memory mapped file, the view stays valid until Close() or destruction
+// note that Windows doesn't allow writing a file while it's mapped, owners should close the mapping before overwriting
+class UHMappedFile
+{
+public:
+	UHMappedFile();
+	~UHMappedFile();
+	UHMappedFile(const UHMappedFile&) = delete;
+	UHMappedFile& operator=(const UHMappedFile&) = delete;
+
+	bool Open(const std::filesystem::path& InPath);
+	void Close();
+
+	const uint8_t* GetData() const;
+	size_t GetSize() const;
+	bool IsOpened() const;
+
+private:
+	HANDLE FileHandle;
+	HANDLE MappingHandle;
+	const uint8_t* MappedData;
+	size_t MappedSize;
+};
\ No newline at end of file
@@ -346,6 +346,11 @@ UHBlendMode UHMaterial::GetBlendMode() const
 	return BlendMode;
 }
 
+float UHMaterial::GetCutoffValue() const
+{
+	return CutoffValue;
+}
+
 bool UHMaterial::IsOpaque() const
 {
 	return GetBlendMode() < UHBlendMode::TranditionalAlpha;
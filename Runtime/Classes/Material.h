@@ -94,6 +94,7 @@ public:
 	std::string GetSourcePath() const;
 	UHCullMode GetCullMode() const;
 	UHBlendMode GetBlendMode() const;
+	float GetCutoffValue() const;
 	UHMaterialCompileFlag GetCompileFlag() const;
 	std::filesystem::path GetPath() const;
 	bool IsOpaque() const;
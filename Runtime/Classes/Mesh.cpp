@@ -5,6 +5,21 @@
 #include "../Engine/Graphic.h"
 #include "../CoreGlobals.h"
 
+// fixed size info of the chunked .uhmesh, the bound is stored so loading doesn't need to touch the positions
+struct UHMeshInfoChunk
+{
+	XMFLOAT3 ImportedTranslation;
+	XMFLOAT3 ImportedRotation;
+	XMFLOAT3 ImportedScale;
+	XMFLOAT3 BoundCenter;
+	XMFLOAT3 BoundExtents;
+	uint32_t VertexCount;
+	uint32_t IndiceCount;
+	int32_t HighestIndex;
+	UHVertexFormat VertexFormat;
+	uint32_t bIndexBuffer32Bit;
+};
+
 UHMesh::UHMesh()
 	: UHMesh("")
 {
@@ -31,6 +46,8 @@ UHMesh::UHMesh(std::string InName)
 	, MeshBound(BoundingBox())
 	, bHasInitialized(false)
 	, NumMeshlets(0)
+	, VertexFormat(UHVertexFormat::Full)
+	, MappedFile(nullptr)
 {
 	Name = InName;
 }
@@ -62,10 +79,17 @@ void UHMesh::CreateGPUBuffers(UHGraphic* InGfx)
 
 	UHGPUMemory* SharedMemory = InGfx->GetMeshSharedMemory();
 
-	PositionBuffer = InGfx->RequestRenderBuffer<XMFLOAT3>(VertexCount, VBFlags, Name + "_Position", SharedMemory);
-	UV0Buffer = InGfx->RequestRenderBuffer<XMFLOAT2>(VertexCount, VBFlags, Name + "_UV0", SharedMemory);
-	NormalBuffer = InGfx->RequestRenderBuffer<XMFLOAT3>(VertexCount, VBFlags, Name + "_Normal", SharedMemory);
-	TangentBuffer = InGfx->RequestRenderBuffer<XMFLOAT4>(VertexCount, VBFlags, Name + "_Tangent", SharedMemory);
+	UHMeshGPUStreams Streams;
+	if (!GetGPUStreams(Streams))
+	{
+		UHE_LOG(L"Mesh data of " + UHUtilities::ToStringW(Name) + L" is released, GPU buffers can't be created!\n");
+		return;
+	}
+
+	PositionBuffer = InGfx->RequestRenderBuffer<uint32_t>(Streams.PositionCount, VBFlags, Name + "_Position", SharedMemory);
+	UV0Buffer = InGfx->RequestRenderBuffer<uint32_t>(Streams.UV0Count, VBFlags, Name + "_UV0", SharedMemory);
+	NormalBuffer = InGfx->RequestRenderBuffer<uint32_t>(Streams.NormalCount, VBFlags, Name + "_Normal", SharedMemory);
+	TangentBuffer = InGfx->RequestRenderBuffer<uint32_t>(Streams.TangentCount, VBFlags, Name + "_Tangent", SharedMemory);
 
 	// consider 32 or 16 bit index buffer
 	if (bIndexBuffer32Bit)
@@ -99,18 +123,18 @@ void UHMesh::CreateGPUBuffers(UHGraphic* InGfx)
 	}
 
 	// upload vb/ib data
-	PositionBuffer->UploadAllDataShared(PositionData.data(), SharedMemory);
-	UV0Buffer->UploadAllDataShared(UV0Data.data(), SharedMemory);
-	NormalBuffer->UploadAllDataShared(NormalData.data(), SharedMemory);
-	TangentBuffer->UploadAllDataShared(TangentData.data(), SharedMemory);
+	PositionBuffer->UploadAllDataShared(Streams.Position);
+	UV0Buffer->UploadAllDataShared(Streams.UV0);
+	NormalBuffer->UploadAllDataShared(Streams.Normal);
+	TangentBuffer->UploadAllDataShared(Streams.Tangent);
 
 	if (bIndexBuffer32Bit)
 	{
-		IndexBuffer->UploadAllDataShared(IndicesData.data(), SharedMemory);
+		IndexBuffer->UploadAllDataShared(Streams.Indices);
 	}
 	else
 	{
-		IndexBuffer16->UploadAllDataShared(IndicesData16.data(), SharedMemory);
+		IndexBuffer16->UploadAllDataShared(Streams.Indices);
 	}
 
 	// create meshlet if MS supported
@@ -147,6 +171,10 @@ void UHMesh::ReleaseCPUMeshData()
 	IndicesData16.clear();
 
 	MeshletsData.clear();
+	MeshletIndicesData.clear();
+
+	MappedData = UHMeshMappedData();
+	MappedFile.reset();
 }
 
 void UHMesh::Release()
@@ -175,33 +203,44 @@ void UHMesh::Release()
 	UH_SAFE_RELEASE(MeshletBuffer);
 	MeshletBuffer.reset();
 
+	UH_SAFE_RELEASE(MeshletIndexBuffer);
+	MeshletIndexBuffer.reset();
+
 	// in case re-init is needed.
 	bHasInitialized = false;
 }
 
 void UHMesh::SetPositionData(std::vector<XMFLOAT3> InData)
 {
+	MaterializeCPUData();
 	PositionData = InData;
 	VertexCount = static_cast<uint32_t>(PositionData.size());
+
+	// compressed positions are relative to the bound, keep it in sync
+	CalculateMeshBound();
 }
 
 void UHMesh::SetUV0Data(std::vector<XMFLOAT2> InData)
 {
+	MaterializeCPUData();
 	UV0Data = InData;
 }
 
 void UHMesh::SetNormalData(std::vector<XMFLOAT3> InData)
 {
+	MaterializeCPUData();
 	NormalData = InData;
 }
 
 void UHMesh::SetTangentData(std::vector<XMFLOAT4> InData)
 {
+	MaterializeCPUData();
 	TangentData = InData;
 }
 
 void UHMesh::SetIndicesData(std::vector<uint32_t> InIndicesData)
 {
+	MaterializeCPUData();
 	IndicesData = InIndicesData;
 	IndiceCount = static_cast<uint32_t>(IndicesData.size());
 	CheckAndConvertToIndices16();
@@ -217,16 +256,6 @@ std::string UHMesh::GetSourcePath() const
 	return SourcePath;
 }
 
-const std::vector<uint32_t>& UHMesh::GetIndicesData() const
-{
-	return IndicesData;
-}
-
-const std::vector<uint16_t>& UHMesh::GetIndicesData16() const
-{
-	return IndicesData16;
-}
-
 uint32_t UHMesh::GetVertexCount() const
 {
 	return VertexCount;
@@ -247,6 +276,11 @@ bool UHMesh::IsIndexBufer32Bit() const
 	return bIndexBuffer32Bit;
 }
 
+UHVertexFormat UHMesh::GetVertexFormat() const
+{
+	return VertexFormat;
+}
+
 std::string UHMesh::GetImportedMaterialName() const
 {
 	return ImportedMaterialName;
@@ -277,22 +311,110 @@ BoundingBox UHMesh::GetMeshBound() const
 	return MeshBound;
 }
 
-UHRenderBuffer<XMFLOAT3>* UHMesh::GetPositionBuffer() const
+bool UHMesh::GetCPUGeometry(std::vector<XMFLOAT3>& OutPositions, std::vector<uint32_t>& OutIndices) const
+{
+	if (MappedFile != nullptr)
+	{
+		OutPositions.assign(MappedData.Position.begin(), MappedData.Position.end());
+		if (bIndexBuffer32Bit)
+		{
+			OutIndices.assign(MappedData.Indices32.begin(), MappedData.Indices32.end());
+		}
+		else
+		{
+			OutIndices.assign(MappedData.Indices16.begin(), MappedData.Indices16.end());
+		}
+	}
+	else
+	{
+		OutPositions = PositionData;
+		if (IndicesData.size() > 0)
+		{
+			OutIndices = IndicesData;
+		}
+		else
+		{
+			OutIndices.assign(IndicesData16.begin(), IndicesData16.end());
+		}
+	}
+
+	return OutPositions.size() > 0 && OutIndices.size() > 0;
+}
+
+bool UHMesh::GetGPUStreams(UHMeshGPUStreams& OutStreams) const
+{
+	// mapped assets upload from the file directly, the others upload from the CPU copies
+	const bool bMapped = MappedFile != nullptr;
+	if (!bMapped && PositionData.size() == 0)
+	{
+		return false;
+	}
+
+	// full format stores the float data as it is
+	OutStreams.Position = bMapped ? static_cast<const void*>(MappedData.Position.Data) : PositionData.data();
+	OutStreams.UV0 = bMapped ? static_cast<const void*>(MappedData.UV0.Data) : UV0Data.data();
+	OutStreams.Normal = bMapped ? static_cast<const void*>(MappedData.Normal.Data) : NormalData.data();
+	OutStreams.Tangent = bMapped ? static_cast<const void*>(MappedData.Tangent.Data) : TangentData.data();
+	OutStreams.PositionCount = static_cast<uint64_t>(VertexCount) * 3;
+	OutStreams.UV0Count = static_cast<uint64_t>(VertexCount) * 2;
+	OutStreams.NormalCount = static_cast<uint64_t>(VertexCount) * 3;
+	OutStreams.TangentCount = static_cast<uint64_t>(VertexCount) * 4;
+
+	// compressed format stores two uints per position and one uint per vertex for the other streams
+	if (VertexFormat == UHVertexFormat::Compressed)
+	{
+		if (bMapped)
+		{
+			OutStreams.Position = MappedData.PackedPosition.Data;
+			OutStreams.UV0 = MappedData.PackedUV0.Data;
+			OutStreams.Normal = MappedData.PackedNormal.Data;
+			OutStreams.Tangent = MappedData.PackedTangent.Data;
+		}
+		else
+		{
+			UHVertexCompression::EncodePositionStream(PositionData, MeshBound, OutStreams.PackedPosition);
+			UHVertexCompression::EncodeUV0Stream(UV0Data, OutStreams.PackedUV0);
+			UHVertexCompression::EncodeNormalStream(NormalData, OutStreams.PackedNormal);
+			UHVertexCompression::EncodeTangentStream(TangentData, OutStreams.PackedTangent);
+			OutStreams.Position = OutStreams.PackedPosition.data();
+			OutStreams.UV0 = OutStreams.PackedUV0.data();
+			OutStreams.Normal = OutStreams.PackedNormal.data();
+			OutStreams.Tangent = OutStreams.PackedTangent.data();
+		}
+		OutStreams.PositionCount = static_cast<uint64_t>(VertexCount) * 2;
+		OutStreams.UV0Count = VertexCount;
+		OutStreams.NormalCount = VertexCount;
+		OutStreams.TangentCount = VertexCount;
+	}
+
+	if (bIndexBuffer32Bit)
+	{
+		OutStreams.Indices = bMapped ? static_cast<const void*>(MappedData.Indices32.Data) : IndicesData.data();
+	}
+	else
+	{
+		OutStreams.Indices = bMapped ? static_cast<const void*>(MappedData.Indices16.Data) : IndicesData16.data();
+	}
+
+	return true;
+}
+
+UHRenderBuffer<uint32_t>* UHMesh::GetPositionBuffer() const
 {
 	return PositionBuffer.get();
 }
 
-UHRenderBuffer<XMFLOAT2>* UHMesh::GetUV0Buffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetUV0Buffer() const
 {
 	return UV0Buffer.get();
 }
 
-UHRenderBuffer<XMFLOAT3>* UHMesh::GetNormalBuffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetNormalBuffer() const
 {
 	return NormalBuffer.get();
 }
 
-UHRenderBuffer<XMFLOAT4>* UHMesh::GetTangentBuffer() const
+UHRenderBuffer<uint32_t>* UHMesh::GetTangentBuffer() const
 {
 	return TangentBuffer.get();
 }
@@ -302,6 +424,11 @@ UHRenderBuffer<UHMeshlet>* UHMesh::GetMeshletBuffer() const
 	return MeshletBuffer.get();
 }
 
+UHRenderBuffer<uint32_t>* UHMesh::GetMeshletIndexBuffer() const
+{
+	return MeshletIndexBuffer.get();
+}
+
 UHRenderBuffer<uint32_t>* UHMesh::GetIndexBuffer() const
 {
 	return IndexBuffer.get();
@@ -334,6 +461,112 @@ bool UHMesh::Import(std::filesystem::path InUHMeshPath)
 
 	UHObject::OnLoad(FileIn);
 
+	// chunked assets are memory mapped, the container starts right after the object header
+	if (Version >= UH_ENUM_VALUE(UHMeshVersion::ChunkedContainer))
+	{
+		const size_t ContainerOffset = static_cast<size_t>(FileIn.tellg());
+		FileIn.close();
+
+		if (!ImportChunked(InUHMeshPath, ContainerOffset))
+		{
+			UHE_LOG(L"Invalid chunks in UHMesh " + InUHMeshPath.wstring() + L"!\n");
+			return false;
+		}
+		return true;
+	}
+
+	ImportLegacy(FileIn);
+	FileIn.close();
+
+	return true;
+}
+
+bool UHMesh::ImportChunked(const std::filesystem::path& InUHMeshPath, size_t InContainerOffset)
+{
+	UniquePtr<UHMappedFile> File = MakeUnique<UHMappedFile>();
+	if (!File->Open(InUHMeshPath))
+	{
+		return false;
+	}
+
+	UHChunkReader Reader;
+	if (!Reader.Parse(File->GetData(), File->GetSize(), InContainerOffset))
+	{
+		return false;
+	}
+
+	UHMeshInfoChunk Info;
+	if (!Reader.ReadValue(UH_ENUM_VALUE_U(UHMeshChunk::Info), Info))
+	{
+		return false;
+	}
+
+	Reader.ReadString(UH_ENUM_VALUE_U(UHMeshChunk::SourcePath), SourcePath);
+	Reader.ReadString(UH_ENUM_VALUE_U(UHMeshChunk::MaterialName), ImportedMaterialName);
+
+	UHMeshMappedData Data;
+	Data.Position = Reader.GetSpan<XMFLOAT3>(UH_ENUM_VALUE_U(UHMeshChunk::Position));
+	Data.UV0 = Reader.GetSpan<XMFLOAT2>(UH_ENUM_VALUE_U(UHMeshChunk::UV0));
+	Data.Normal = Reader.GetSpan<XMFLOAT3>(UH_ENUM_VALUE_U(UHMeshChunk::Normal));
+	Data.Tangent = Reader.GetSpan<XMFLOAT4>(UH_ENUM_VALUE_U(UHMeshChunk::Tangent));
+	Data.Indices32 = Reader.GetSpan<uint32_t>(UH_ENUM_VALUE_U(UHMeshChunk::Indices32));
+	Data.Indices16 = Reader.GetSpan<uint16_t>(UH_ENUM_VALUE_U(UHMeshChunk::Indices16));
+	Data.Meshlets = Reader.GetSpan<UHMeshlet>(UH_ENUM_VALUE_U(UHMeshChunk::Meshlets));
+	Data.MeshletIndices = Reader.GetSpan<uint32_t>(UH_ENUM_VALUE_U(UHMeshChunk::MeshletIndices));
+	Data.PackedUV0 = Reader.GetSpan<uint32_t>(UH_ENUM_VALUE_U(UHMeshChunk::PackedUV0));
+	Data.PackedNormal = Reader.GetSpan<uint32_t>(UH_ENUM_VALUE_U(UHMeshChunk::PackedNormal));
+	Data.PackedTangent = Reader.GetSpan<uint32_t>(UH_ENUM_VALUE_U(UHMeshChunk::PackedTangent));
+	Data.PackedPosition = Reader.GetSpan<uint32_t>(UH_ENUM_VALUE_U(UHMeshChunk::PackedPosition));
+
+	// GPU buffers are sized by the counts in info, so every stream must match them before it's uploaded from the mapping
+	bool bValid = Info.VertexFormat < UHVertexFormat::VertexFormatMax
+		&& Data.Position.Count == Info.VertexCount
+		&& Data.UV0.Count == Info.VertexCount
+		&& Data.Normal.Count == Info.VertexCount
+		&& Data.Tangent.Count == Info.VertexCount;
+
+	if (Info.bIndexBuffer32Bit)
+	{
+		bValid &= Data.Indices32.Count == Info.IndiceCount;
+	}
+	else
+	{
+		bValid &= Data.Indices16.Count == Info.IndiceCount;
+	}
+
+	if (Info.VertexFormat == UHVertexFormat::Compressed)
+	{
+		bValid &= Data.PackedPosition.Count == static_cast<size_t>(Info.VertexCount) * 2
+			&& Data.PackedUV0.Count == Info.VertexCount
+			&& Data.PackedNormal.Count == Info.VertexCount
+			&& Data.PackedTangent.Count == Info.VertexCount;
+	}
+
+	if (!bValid)
+	{
+		return false;
+	}
+
+	ImportedTranslation = Info.ImportedTranslation;
+	ImportedRotation = Info.ImportedRotation;
+	ImportedScale = Info.ImportedScale;
+	MeshCenter = Info.BoundCenter;
+	MeshBound = BoundingBox(Info.BoundCenter, Info.BoundExtents);
+	VertexCount = Info.VertexCount;
+	IndiceCount = Info.IndiceCount;
+	HighestIndex = Info.HighestIndex;
+	VertexFormat = Info.VertexFormat;
+	bIndexBuffer32Bit = Info.bIndexBuffer32Bit != 0;
+	NumMeshlets = static_cast<uint32_t>(Data.Meshlets.Count);
+
+	MappedData = Data;
+	MappedFile = std::move(File);
+
+	return true;
+}
+
+void UHMesh::ImportLegacy(std::ifstream& FileIn)
+{
 	if (Version >= UH_ENUM_VALUE(UHMeshVersion::StoreSourcePath))
 	{
 		UHUtilities::ReadStringData(FileIn, SourcePath);
@@ -356,33 +589,28 @@ bool UHMesh::Import(std::filesystem::path InUHMeshPath)
 	// read indices
 	UHUtilities::ReadVectorData(FileIn, IndicesData);
 
-	FileIn.close();
-
-	VertexCount = static_cast<uint32_t>(PositionData.size());
-	IndiceCount = static_cast<uint32_t>(IndicesData.size());
-
-	// calc the mesh center and mesh bound
-	constexpr float Inf = std::numeric_limits<float>::infinity();
-	XMFLOAT3 MinPoint = XMFLOAT3(Inf, Inf, Inf);
-	XMFLOAT3 MaxPoint = XMFLOAT3(-Inf, -Inf, -Inf);
+	// read meshlets, meshes saved before this version will build meshlets on GPU buffer creation
+	if (Version >= UH_ENUM_VALUE(UHMeshVersion::StoreMeshlets))
+	{
+		UHUtilities::ReadVectorData(FileIn, MeshletsData);
+		UHUtilities::ReadVectorData(FileIn, MeshletIndicesData);
+		NumMeshlets = static_cast<uint32_t>(MeshletsData.size());
+	}
 
-	for (const XMFLOAT3& P : PositionData)
+	if (Version >= UH_ENUM_VALUE(UHMeshVersion::StoreVertexFormat))
 	{
-		MinPoint = MathHelpers::MinVector(P, MinPoint);
-		MaxPoint = MathHelpers::MaxVector(P, MaxPoint);
+		FileIn.read(reinterpret_cast<char*>(&VertexFormat), sizeof(VertexFormat));
 	}
 
-	MeshCenter = (MinPoint + MaxPoint) * 0.5f;
-	XMFLOAT3 MeshExtent = (MaxPoint - MinPoint) * 0.5f;
-	MeshBound = BoundingBox(MeshCenter, MeshExtent);
+	VertexCount = static_cast<uint32_t>(PositionData.size());
+	IndiceCount = static_cast<uint32_t>(IndicesData.size());
 
+	CalculateMeshBound();
 	CheckAndConvertToIndices16();
 	if (Version < UH_ENUM_VALUE(UHMeshVersion::StoreSourcePath))
 	{
 		SourcePath = Name;
 	}
-
-	return true;
 }
 
 #if WITH_EDITOR
@@ -419,9 +647,15 @@ void UHMesh::SetSourcePath(const std::string InPath)
 	SourcePath = InPath;
 }
 
+void UHMesh::SetVertexFormat(UHVertexFormat InFormat)
+{
+	VertexFormat = InFormat;
+}
+
 void UHMesh::ApplyUnitScale()
 {
 	// apply unit scale to imported mesh
+	MaterializeCPUData();
 	float UnitScale = 0.01f;
 	XMMATRIX S = XMMatrixScaling(UnitScale, UnitScale, UnitScale);
 
@@ -443,12 +677,48 @@ void UHMesh::ApplyUnitScale()
 	XMStoreFloat3(&ImportedRotation, R);
 }
 
+// reorder the indices for post-transform cache and overdraw, then reorder vertices for fetch locality
+// all vertex streams are remapped together, meshlets will be rebuilt with the new order on exporting
+UHMeshOptimizeStats UHMesh::Optimize()
+{
+	MaterializeCPUData();
+
+	UHMeshOptimizeStats Stats;
+	Stats.TriangleCount = static_cast<uint32_t>(IndicesData.size() / 3);
+	Stats.VertexCount = static_cast<uint32_t>(PositionData.size());
+	Stats.ACMRBefore = UHMeshOptimizer::CalculateACMR(IndicesData, Stats.VertexCount);
+
+	UHMeshOptimizer::OptimizeVertexCache(IndicesData, Stats.VertexCount);
+	UHMeshOptimizer::OptimizeOverdraw(IndicesData, PositionData);
+
+	std::vector<uint32_t> VertexRemap;
+	UHMeshOptimizer::OptimizeVertexFetch(IndicesData, Stats.VertexCount, VertexRemap);
+	UHMeshOptimizer::RemapVertexStream(PositionData, VertexRemap);
+	UHMeshOptimizer::RemapVertexStream(UV0Data, VertexRemap);
+	UHMeshOptimizer::RemapVertexStream(NormalData, VertexRemap);
+	UHMeshOptimizer::RemapVertexStream(TangentData, VertexRemap);
+
+	Stats.ACMRAfter = UHMeshOptimizer::CalculateACMR(IndicesData, Stats.VertexCount);
+
+	VertexCount = Stats.VertexCount;
+	IndiceCount = static_cast<uint32_t>(IndicesData.size());
+	CheckAndConvertToIndices16();
+	MeshletsData.clear();
+	MeshletIndicesData.clear();
+	NumMeshlets = 0;
+
+	UHE_LOG(L"Optimized UHMesh " + UHUtilities::ToStringW(Name) + L", ACMR: " + std::to_wstring(Stats.ACMRBefore)
+		+ L" -> " + std::to_wstring(Stats.ACMRAfter) + L"\n");
+
+	return Stats;
+}
+
 void UHMesh::Export(std::filesystem::path OutputFolder, bool bOverwrite)
 {
 	// export UHMesh as file, so we don't need to load from source everytime
 	// the data output be like:
-	// (1) mesh name
-	// (2) mesh data
+	// (1) object header with mesh name
+	// (2) chunk container of mesh data, see UHMeshChunk
 
 	// create folder if it's not existed
 	if (std::filesystem::is_directory(OutputFolder) && !std::filesystem::exists(OutputFolder))
@@ -468,34 +738,111 @@ void UHMesh::Export(std::filesystem::path OutputFolder, bool bOverwrite)
 		return;
 	}
 
-	// open UHMesh file
+	// a mapped asset must be unmapped before it's overwritten
+	MaterializeCPUData();
+
+	VertexCount = static_cast<uint32_t>(PositionData.size());
+	IndiceCount = static_cast<uint32_t>(IndicesData.size());
+	CalculateMeshBound();
+	CheckAndConvertToIndices16();
+
+	// always rebuild meshlets as the vertex data could be changed after importing
+	BuildMeshlets();
+
+	UHMeshInfoChunk Info;
+	Info.ImportedTranslation = ImportedTranslation;
+	Info.ImportedRotation = ImportedRotation;
+	Info.ImportedScale = ImportedScale;
+	Info.BoundCenter = MeshBound.Center;
+	Info.BoundExtents = MeshBound.Extents;
+	Info.VertexCount = VertexCount;
+	Info.IndiceCount = IndiceCount;
+	Info.HighestIndex = HighestIndex;
+	Info.VertexFormat = VertexFormat;
+	Info.bIndexBuffer32Bit = bIndexBuffer32Bit ? 1 : 0;
+
+	// the full precision streams are always stored for editing, compressed format stores the GPU-ready streams in addition
+	UHChunkWriter Writer;
+	Writer.AddValue(UH_ENUM_VALUE_U(UHMeshChunk::Info), Info);
+	Writer.AddString(UH_ENUM_VALUE_U(UHMeshChunk::SourcePath), SourcePath);
+	Writer.AddString(UH_ENUM_VALUE_U(UHMeshChunk::MaterialName), ImportedMaterialName);
+	Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::Position), PositionData);
+	Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::UV0), UV0Data);
+	Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::Normal), NormalData);
+	Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::Tangent), TangentData);
+
+	if (bIndexBuffer32Bit)
+	{
+		Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::Indices32), IndicesData);
+	}
+	else
+	{
+		Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::Indices16), IndicesData16);
+	}
+
+	Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::Meshlets), MeshletsData);
+	Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::MeshletIndices), MeshletIndicesData);
+
+	std::vector<uint32_t> PackedPosition;
+	std::vector<uint32_t> PackedUV0;
+	std::vector<uint32_t> PackedNormal;
+	std::vector<uint32_t> PackedTangent;
+	if (VertexFormat == UHVertexFormat::Compressed)
+	{
+		UHVertexCompression::EncodePositionStream(PositionData, MeshBound, PackedPosition);
+		UHVertexCompression::EncodeUV0Stream(UV0Data, PackedUV0);
+		UHVertexCompression::EncodeNormalStream(NormalData, PackedNormal);
+		UHVertexCompression::EncodeTangentStream(TangentData, PackedTangent);
+		Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::PackedUV0), PackedUV0);
+		Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::PackedNormal), PackedNormal);
+		Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::PackedTangent), PackedTangent);
+		Writer.AddChunk(UH_ENUM_VALUE_U(UHMeshChunk::PackedPosition), PackedPosition);
+	}
+
+	// open UHMesh file, object header first then the chunk container
 	std::ofstream FileOut(OutPath.string(), std::ios::out | std::ios::binary);
 	Version = UH_ENUM_VALUE(UHMeshVersion::MeshVersionMax) - 1;
 	UHObject::OnSave(FileOut);
 
-	UHUtilities::WriteStringData(FileOut, SourcePath);
+	if (!Writer.Write(FileOut))
+	{
+		UHE_LOG(L"Failed to export UHMesh " + OutPath.wstring() + L"!\n");
+	}
 
-	// write imported material name
-	UHUtilities::WriteStringData(FileOut, ImportedMaterialName);
+	FileOut.close();
+}
 
-	// write transform data
-	FileOut.write(reinterpret_cast<const char*>(&ImportedTranslation), sizeof(ImportedTranslation));
-	FileOut.write(reinterpret_cast<const char*>(&ImportedRotation), sizeof(ImportedRotation));
-	FileOut.write(reinterpret_cast<const char*>(&ImportedScale), sizeof(ImportedScale));
+bool UHMesh::ValidateMeshlets(UHMeshletStats& OutStats) const
+{
+	// validate the stored meshlets, either mapped from the asset or built after importing
+	const bool bMapped = !MappedData.Meshlets.IsEmpty();
+	const std::vector<UHMeshlet> Meshlets = bMapped ? std::vector<UHMeshlet>(MappedData.Meshlets.begin(), MappedData.Meshlets.end()) : MeshletsData;
+	const std::vector<uint32_t> MeshletIndices = bMapped ? std::vector<uint32_t>(MappedData.MeshletIndices.begin(), MappedData.MeshletIndices.end())
+		: MeshletIndicesData;
 
-	// write vertex
-	UHUtilities::WriteVectorData(FileOut, PositionData);
-	UHUtilities::WriteVectorData(FileOut, UV0Data);
-	UHUtilities::WriteVectorData(FileOut, NormalData);
-	UHUtilities::WriteVectorData(FileOut, TangentData);
+	std::vector<XMFLOAT3> Positions;
+	std::vector<uint32_t> Indices;
+	if (!GetCPUGeometry(Positions, Indices))
+	{
+		return false;
+	}
 
-	// write indices
-	UHUtilities::WriteVectorData(FileOut, IndicesData);
+	OutStats = UHMeshletBuilder::CalculateStats(Meshlets, static_cast<uint32_t>(Positions.size()));
+	return UHMeshletBuilder::ValidateMeshlets(Meshlets, MeshletIndices, Indices, static_cast<uint32_t>(Positions.size())
+		, MaxVertexPerMeshlet, MaxPrimitivePerMeshlet);
+}
 
-	FileOut.close();
+UHVertexCompressionError UHMesh::MeasureCompressionError() const
+{
+	if (MappedFile != nullptr)
+	{
+		return UHVertexCompression::MeasureError(std::vector<XMFLOAT3>(MappedData.Position.begin(), MappedData.Position.end()), MeshBound
+			, std::vector<XMFLOAT2>(MappedData.UV0.begin(), MappedData.UV0.end())
+			, std::vector<XMFLOAT3>(MappedData.Normal.begin(), MappedData.Normal.end())
+			, std::vector<XMFLOAT4>(MappedData.Tangent.begin(), MappedData.Tangent.end()));
+	}
 
-	VertexCount = static_cast<uint32_t>(PositionData.size());
-	IndiceCount = static_cast<uint32_t>(IndicesData.size());
+	return UHVertexCompression::MeasureError(PositionData, MeshBound, UV0Data, NormalData, TangentData);
 }
 #endif
 
@@ -510,6 +857,54 @@ bool UHMesh::operator==(const UHMesh& InMesh)
 		&& InMesh.IndiceCount == IndiceCount;
 }
 
+void UHMesh::CalculateMeshBound()
+{
+	// calc the mesh center and mesh bound
+	constexpr float Inf = std::numeric_limits<float>::infinity();
+	XMFLOAT3 MinPoint = XMFLOAT3(Inf, Inf, Inf);
+	XMFLOAT3 MaxPoint = XMFLOAT3(-Inf, -Inf, -Inf);
+
+	for (const XMFLOAT3& P : PositionData)
+	{
+		MinPoint = MathHelpers::MinVector(P, MinPoint);
+		MaxPoint = MathHelpers::MaxVector(P, MaxPoint);
+	}
+
+	MeshCenter = (MinPoint + MaxPoint) * 0.5f;
+	XMFLOAT3 MeshExtent = (MaxPoint - MinPoint) * 0.5f;
+	MeshBound = BoundingBox(MeshCenter, MeshExtent);
+}
+
+// copy the mapped chunks to CPU vectors and unmap the file, this is needed before editing or overwriting the asset
+void UHMesh::MaterializeCPUData()
+{
+	if (MappedFile == nullptr)
+	{
+		return;
+	}
+
+	PositionData.assign(MappedData.Position.begin(), MappedData.Position.end());
+	UV0Data.assign(MappedData.UV0.begin(), MappedData.UV0.end());
+	NormalData.assign(MappedData.Normal.begin(), MappedData.Normal.end());
+	TangentData.assign(MappedData.Tangent.begin(), MappedData.Tangent.end());
+
+	if (bIndexBuffer32Bit)
+	{
+		IndicesData.assign(MappedData.Indices32.begin(), MappedData.Indices32.end());
+	}
+	else
+	{
+		IndicesData16.assign(MappedData.Indices16.begin(), MappedData.Indices16.end());
+		IndicesData.assign(MappedData.Indices16.begin(), MappedData.Indices16.end());
+	}
+
+	MeshletsData.assign(MappedData.Meshlets.begin(), MappedData.Meshlets.end());
+	MeshletIndicesData.assign(MappedData.MeshletIndices.begin(), MappedData.MeshletIndices.end());
+
+	MappedData = UHMeshMappedData();
+	MappedFile.reset();
+}
+
 void UHMesh::CheckAndConvertToIndices16()
 {
 	// check if it's necessary to convert as 16-bit indices
@@ -538,31 +933,35 @@ void UHMesh::CheckAndConvertToIndices16()
 	}
 }
 
-void UHMesh::CreateMeshlets(UHGraphic* InGfx)
+void UHMesh::BuildMeshlets()
 {
-	// calculate number of meshlets by indices count and round up
-	NumMeshlets = MathHelpers::RoundUpDivide(IndiceCount, MaxVertexPerMeshlet);
+	UHMeshletBuilder::BuildMeshlets(PositionData, NormalData, IndicesData, MaxVertexPerMeshlet, MaxPrimitivePerMeshlet
+		, MeshletsData, MeshletIndicesData);
+	NumMeshlets = static_cast<uint32_t>(MeshletsData.size());
+}
 
-	int32_t LocalIndiceCount = IndiceCount;
-	for (uint32_t Idx = 0; Idx < NumMeshlets; Idx++)
+void UHMesh::CreateMeshlets(UHGraphic* InGfx)
+{
+	// meshlets are built offline and stored in the asset, build them here only for the old assets
+	if (MappedData.Meshlets.IsEmpty() && MeshletsData.size() == 0)
 	{
-		UHMeshlet Meshlet{};
-
-		// set vertex count as max indice count
-		// in the mesh shader, it will map to the corresponding vertex data
-		Meshlet.VertexCount = std::min(MaxVertexPerMeshlet, (uint32_t)LocalIndiceCount);
-		Meshlet.VertexOffset = Idx > 0 ? MeshletsData[Idx - 1].VertexCount + MeshletsData[Idx - 1].VertexOffset : 0;
-		Meshlet.PrimitiveCount = Meshlet.VertexCount / 3;
+		MaterializeCPUData();
+		BuildMeshlets();
+	}
 
-		MeshletsData.push_back(Meshlet);
+	const bool bMapped = !MappedData.Meshlets.IsEmpty();
+	const UHDataSpan<UHMeshlet> Meshlets = bMapped ? MappedData.Meshlets : UHDataSpan<UHMeshlet>(MeshletsData.data(), MeshletsData.size());
+	const UHDataSpan<uint32_t> MeshletIndices = bMapped ? MappedData.MeshletIndices
+		: UHDataSpan<uint32_t>(MeshletIndicesData.data(), MeshletIndicesData.size());
 
-		LocalIndiceCount -= Meshlet.VertexCount;
-		if (LocalIndiceCount <= 0)
-		{
-			break;
-		}
+	if (Meshlets.IsEmpty())
+	{
+		return;
 	}
 
-	MeshletBuffer = InGfx->RequestRenderBuffer<UHMeshlet>(MeshletsData.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Name + "_Meshlet");
-	MeshletBuffer->UploadAllData(MeshletsData.data());
+	MeshletBuffer = InGfx->RequestRenderBuffer<UHMeshlet>(Meshlets.Count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Name + "_Meshlet");
+	MeshletBuffer->UploadAllData(Meshlets.Data);
+
+	MeshletIndexBuffer = InGfx->RequestRenderBuffer<uint32_t>(MeshletIndices.Count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, Name + "_MeshletIndex");
+	MeshletIndexBuffer->UploadAllData(MeshletIndices.Data);
 }
\ No newline at end of file
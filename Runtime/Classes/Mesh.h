@@ -8,33 +8,98 @@
 #include "Object.h"
 #include "../../UnheardEngine.h"
 #include "AccelerationStructure.h"
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "VertexCompression.h"
+#include "MappedFile.h"
+#include "ChunkContainer.h"
 #include "Runtime/Renderer/RenderingTypes.h"
 
 enum class UHMeshVersion
 {
 	StoreSourcePath = 1,
+	StoreMeshlets,
+	StoreVertexFormat,
+	ChunkedContainer,
 	MeshVersionMax
 };
 
-class UHGraphic;
+// chunk ids of the .uhmesh container, append only
+enum class UHMeshChunk : uint32_t
+{
+	Info = 0,
+	SourcePath,
+	MaterialName,
+	Position,
+	UV0,
+	Normal,
+	Tangent,
+	Indices32,
+	Indices16,
+	Meshlets,
+	MeshletIndices,
+	// GPU-ready streams of compressed vertex format, so they can be uploaded without encoding
+	PackedUV0,
+	PackedNormal,
+	PackedTangent,
+	PackedPosition
+};
 
-// Meshlet structure, for now it simply stores the vert/prim count and offset
-struct UHMeshlet
+// spans of a memory mapped .uhmesh, they point into the mapped file and are uploaded to GPU directly
+struct UHMeshMappedData
 {
-public:
-	UHMeshlet()
-		: VertexCount(0)
-		, VertexOffset(0)
-		, PrimitiveCount(0)
+	UHDataSpan<XMFLOAT3> Position;
+	UHDataSpan<XMFLOAT2> UV0;
+	UHDataSpan<XMFLOAT3> Normal;
+	UHDataSpan<XMFLOAT4> Tangent;
+	UHDataSpan<uint32_t> Indices32;
+	UHDataSpan<uint16_t> Indices16;
+	UHDataSpan<UHMeshlet> Meshlets;
+	UHDataSpan<uint32_t> MeshletIndices;
+	UHDataSpan<uint32_t> PackedUV0;
+	UHDataSpan<uint32_t> PackedNormal;
+	UHDataSpan<uint32_t> PackedTangent;
+	UHDataSpan<uint32_t> PackedPosition;
+};
+
+// GPU-ready streams of a mesh, Position/UV0/Normal/Tangent are raw uint streams of the vertex format and counts are in uints
+// the pointers are into the mapped file, the CPU copies or the Packed vectors, which are filled when the streams are encoded on the fly
+struct UHMeshGPUStreams
+{
+	UHMeshGPUStreams()
+		: Position(nullptr)
+		, UV0(nullptr)
+		, Normal(nullptr)
+		, Tangent(nullptr)
+		, PositionCount(0)
+		, UV0Count(0)
+		, NormalCount(0)
+		, TangentCount(0)
+		, Indices(nullptr)
 	{
 
 	}
 
-	uint32_t VertexCount;
-	uint32_t VertexOffset;
-	uint32_t PrimitiveCount;
+	const void* Position;
+	const void* UV0;
+	const void* Normal;
+	const void* Tangent;
+	uint64_t PositionCount;
+	uint64_t UV0Count;
+	uint64_t NormalCount;
+	uint64_t TangentCount;
+
+	// 32 or 16 bit indices as the mesh stores them
+	const void* Indices;
+
+	std::vector<uint32_t> PackedPosition;
+	std::vector<uint32_t> PackedUV0;
+	std::vector<uint32_t> PackedNormal;
+	std::vector<uint32_t> PackedTangent;
 };
 
+class UHGraphic;
+
 // Mesh class of unheard engine
 class UHMesh : public UHObject, public UHRenderState
 {
@@ -54,13 +119,12 @@ public:
 
 	std::string GetName() const;
 	std::string GetSourcePath() const;
-	const std::vector<uint32_t>& GetIndicesData() const;
-	const std::vector<uint16_t>& GetIndicesData16() const;
 
 	uint32_t GetVertexCount() const;
 	uint32_t GetIndicesCount() const;
 	uint32_t GetMeshletCount() const;
 	bool IsIndexBufer32Bit() const;
+	UHVertexFormat GetVertexFormat() const;
 
 	std::string GetImportedMaterialName() const;
 	XMFLOAT3 GetImportedTranslation() const;
@@ -69,11 +133,20 @@ public:
 	XMFLOAT3 GetMeshCenter() const;
 	BoundingBox GetMeshBound() const;
 
-	UHRenderBuffer<XMFLOAT3>* GetPositionBuffer() const;
-	UHRenderBuffer<XMFLOAT2>* GetUV0Buffer() const;
-	UHRenderBuffer<XMFLOAT3>* GetNormalBuffer() const;
-	UHRenderBuffer<XMFLOAT4>* GetTangentBuffer() const;
+	// copy positions and 32-bit indices from either the mapped file or CPU data, false if CPU data is released already
+	bool GetCPUGeometry(std::vector<XMFLOAT3>& OutPositions, std::vector<uint32_t>& OutIndices) const;
+
+	// get the streams uploaded to GPU buffers, false if CPU data is released already
+	bool GetGPUStreams(UHMeshGPUStreams& OutStreams) const;
+
+	// Position/UV0/Normal/Tangent buffers are raw streams, the layout depends on vertex format
+	// compressed positions are relative to the mesh bound
+	UHRenderBuffer<uint32_t>* GetPositionBuffer() const;
+	UHRenderBuffer<uint32_t>* GetUV0Buffer() const;
+	UHRenderBuffer<uint32_t>* GetNormalBuffer() const;
+	UHRenderBuffer<uint32_t>* GetTangentBuffer() const;
 	UHRenderBuffer<UHMeshlet>* GetMeshletBuffer() const;
+	UHRenderBuffer<uint32_t>* GetMeshletIndexBuffer() const;
 
 	UHRenderBuffer<uint32_t>* GetIndexBuffer() const;
 	UHRenderBuffer<uint16_t>* GetIndexBuffer16() const;
@@ -86,19 +159,33 @@ public:
 	void SetImportedTransform(XMFLOAT3 InTranslation, XMFLOAT3 InRotation, XMFLOAT3 InScale);
 	void SetImportedMaterialName(std::string InName);
 	void SetSourcePath(const std::string InPath);
+	void SetVertexFormat(UHVertexFormat InFormat);
 	void ApplyUnitScale();
+	UHMeshOptimizeStats Optimize();
 	void Export(std::filesystem::path OutputFolder, bool bOverwrite = true);
+
+	// check the meshlets against the indices and meshlet limits, also output the meshlet stats
+	bool ValidateMeshlets(UHMeshletStats& OutStats) const;
+
+	// encode the full precision streams with the compressed format and return the max error against them
+	UHVertexCompressionError MeasureCompressionError() const;
 #endif
 
 	bool operator==(const UHMesh& InMesh);
 
 	// meshlet stuff, a mesh can be divided into multiple meshlets
-	// try to keep the MaxVertexPerMeshlet a multiply of 3 of MaxPrimitivePerMeshlet
-	static const uint32_t MaxVertexPerMeshlet = 126;
-	static const uint32_t MaxPrimitivePerMeshlet = 42;
+	// vertices are shared within a meshlet, so the primitive count can be higher than the vertex count
+	// these must be the same as MESHSHADER_MAX_VERTEX and MESHSHADER_MAX_PRIMITIVE in UHMeshShaderCommon.hlsli
+	static const uint32_t MaxVertexPerMeshlet = 64;
+	static const uint32_t MaxPrimitivePerMeshlet = 126;
 
 private:
+	bool ImportChunked(const std::filesystem::path& InUHMeshPath, size_t InContainerOffset);
+	void ImportLegacy(std::ifstream& FileIn);
+	void CalculateMeshBound();
+	void MaterializeCPUData();
 	void CheckAndConvertToIndices16();
+	void BuildMeshlets();
 	void CreateMeshlets(UHGraphic* InGfx);
 
 	std::string ImportedMaterialName;
@@ -121,12 +208,17 @@ private:
 	int32_t HighestIndex;
 	bool bIndexBuffer32Bit;
 	bool bHasInitialized;
+	UHVertexFormat VertexFormat;
+
+	// the mapping of chunked assets, CPU data stays in the file until it's materialized for editing
+	UniquePtr<UHMappedFile> MappedFile;
+	UHMeshMappedData MappedData;
 
 	// GPU VB/IB buffer
-	UniquePtr<UHRenderBuffer<XMFLOAT3>> PositionBuffer;
-	UniquePtr<UHRenderBuffer<XMFLOAT2>> UV0Buffer;
-	UniquePtr<UHRenderBuffer<XMFLOAT3>> NormalBuffer;
-	UniquePtr<UHRenderBuffer<XMFLOAT4>> TangentBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> PositionBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> UV0Buffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> NormalBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> TangentBuffer;
 
 	UniquePtr<UHRenderBuffer<uint32_t>> IndexBuffer;
 	UniquePtr<UHRenderBuffer<uint16_t>> IndexBuffer16;
@@ -137,5 +229,7 @@ private:
 
 	uint32_t NumMeshlets;
 	std::vector<UHMeshlet> MeshletsData;
+	std::vector<uint32_t> MeshletIndicesData;
 	UniquePtr<UHRenderBuffer<UHMeshlet>> MeshletBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> MeshletIndexBuffer;
 };
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "MeshGeometryPool.h"
+#include "Mesh.h"
+#include "../Engine/Graphic.h"
+
+enum UHGeometryPoolStream
+{
+	PositionStream = 0,
+	UV0Stream,
+	NormalStream,
+	TangentStream,
+	GeometryPoolStreamMax
+};
+
+// uints per vertex of each stream, this must be the same as UHMesh::GetGPUStreams()
+static void GetStreamStrides(UHVertexFormat InFormat, uint64_t OutStrides[GeometryPoolStreamMax])
+{
+	const bool bCompressed = InFormat == UHVertexFormat::Compressed;
+	OutStrides[PositionStream] = bCompressed ? 2 : 3;
+	OutStrides[UV0Stream] = bCompressed ? 1 : 2;
+	OutStrides[NormalStream] = bCompressed ? 1 : 3;
+	OutStrides[TangentStream] = bCompressed ? 1 : 4;
+}
+
+UHMeshGeometryPool::UHMeshGeometryPool()
+	: PositionBuffer(nullptr)
+	, UV0Buffer(nullptr)
+	, NormalBuffer(nullptr)
+	, TangentBuffer(nullptr)
+	, IndexBuffer(nullptr)
+{
+
+}
+
+void UHMeshGeometryPool::Release()
+{
+	UH_SAFE_RELEASE(PositionBuffer);
+	PositionBuffer.reset();
+
+	UH_SAFE_RELEASE(UV0Buffer);
+	UV0Buffer.reset();
+
+	UH_SAFE_RELEASE(NormalBuffer);
+	NormalBuffer.reset();
+
+	UH_SAFE_RELEASE(TangentBuffer);
+	TangentBuffer.reset();
+
+	UH_SAFE_RELEASE(IndexBuffer);
+	IndexBuffer.reset();
+
+	Ranges.clear();
+}
+
+void UHMeshGeometryPool::Build(UHGraphic* InGfx, const std::vector<UHMesh*>& InMeshes)
+{
+	Release();
+	Ranges.resize(InMeshes.size());
+
+	// layout pass, the vertex offset of a mesh is the first vertex that's free in all streams
+	// streams of different strides are padded a bit this way, but a single offset works for all of them
+	uint64_t StreamEnds[GeometryPoolStreamMax] = {};
+	uint64_t Strides[GeometryPoolStreamMax];
+	uint64_t IndexEnd = 0;
+	for (size_t Idx = 0; Idx < InMeshes.size(); Idx++)
+	{
+		const UHMesh* Mesh = InMeshes[Idx];
+		assert(Mesh->GetBufferDataIndex() == static_cast<int32_t>(Idx));
+		GetStreamStrides(Mesh->GetVertexFormat(), Strides);
+
+		uint64_t VertexOffset = 0;
+		for (int32_t Sdx = 0; Sdx < GeometryPoolStreamMax; Sdx++)
+		{
+			VertexOffset = (std::max)(VertexOffset, MathHelpers::RoundUpDivide(StreamEnds[Sdx], Strides[Sdx]));
+		}
+
+		for (int32_t Sdx = 0; Sdx < GeometryPoolStreamMax; Sdx++)
+		{
+			StreamEnds[Sdx] = (VertexOffset + Mesh->GetVertexCount()) * Strides[Sdx];
+		}
+
+		UHMeshGeometryRange& Range = Ranges[Idx];
+		Range.FirstIndex = static_cast<uint32_t>(IndexEnd);
+		Range.VertexOffset = static_cast<int32_t>(VertexOffset);
+		Range.IndexCount = Mesh->GetIndicesCount();
+		IndexEnd += Mesh->GetIndicesCount();
+	}
+
+	if (IndexEnd == 0)
+	{
+		return;
+	}
+
+	// vertex offset and first index of draw commands are 32-bit
+	if (IndexEnd > UINT32_MAX || StreamEnds[PositionStream] / 2 > INT32_MAX)
+	{
+		UHE_LOG(L"Meshes exceed the geometry pool limit, GPU-driven draws are disabled!\n");
+		Ranges.clear();
+		return;
+	}
+
+	const VkBufferUsageFlags VBFlags = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	PositionBuffer = InGfx->RequestRenderBuffer<uint32_t>(StreamEnds[PositionStream], VBFlags, "GeometryPool_Position");
+	UV0Buffer = InGfx->RequestRenderBuffer<uint32_t>(StreamEnds[UV0Stream], VBFlags, "GeometryPool_UV0");
+	NormalBuffer = InGfx->RequestRenderBuffer<uint32_t>(StreamEnds[NormalStream], VBFlags, "GeometryPool_Normal");
+	TangentBuffer = InGfx->RequestRenderBuffer<uint32_t>(StreamEnds[TangentStream], VBFlags, "GeometryPool_Tangent");
+	IndexBuffer = InGfx->RequestRenderBuffer<uint32_t>(IndexEnd, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "GeometryPool_Index32");
+
+	// copy pass, 16-bit indices are converted
+	std::vector<uint32_t> Indices32;
+	uint32_t NumSkipped = 0;
+	for (size_t Idx = 0; Idx < InMeshes.size(); Idx++)
+	{
+		const UHMesh* Mesh = InMeshes[Idx];
+		UHMeshGeometryRange& Range = Ranges[Idx];
+		UHMeshGPUStreams Streams;
+		if (Range.IndexCount == 0 || !Mesh->GetGPUStreams(Streams))
+		{
+			NumSkipped += (Range.IndexCount > 0) ? 1 : 0;
+			Range = UHMeshGeometryRange();
+			continue;
+		}
+
+		GetStreamStrides(Mesh->GetVertexFormat(), Strides);
+		const uint64_t VertexOffset = static_cast<uint64_t>(Range.VertexOffset);
+		PositionBuffer->UploadData(Streams.Position, VertexOffset * Strides[PositionStream], Streams.PositionCount * sizeof(uint32_t));
+		UV0Buffer->UploadData(Streams.UV0, VertexOffset * Strides[UV0Stream], Streams.UV0Count * sizeof(uint32_t));
+		NormalBuffer->UploadData(Streams.Normal, VertexOffset * Strides[NormalStream], Streams.NormalCount * sizeof(uint32_t));
+		TangentBuffer->UploadData(Streams.Tangent, VertexOffset * Strides[TangentStream], Streams.TangentCount * sizeof(uint32_t));
+
+		if (Mesh->IsIndexBufer32Bit())
+		{
+			IndexBuffer->UploadData(Streams.Indices, Range.FirstIndex, Range.IndexCount * sizeof(uint32_t));
+		}
+		else
+		{
+			const uint16_t* Indices16 = static_cast<const uint16_t*>(Streams.Indices);
+			Indices32.assign(Indices16, Indices16 + Range.IndexCount);
+			IndexBuffer->UploadData(Indices32.data(), Range.FirstIndex, Range.IndexCount * sizeof(uint32_t));
+		}
+	}
+
+	if (NumSkipped > 0)
+	{
+		UHE_LOG(std::to_wstring(NumSkipped) + L" meshes are released before packing, they aren't drawn by GPU-driven draws!\n");
+	}
+}
+
+bool UHMeshGeometryPool::GetRange(const UHMesh* InMesh, UHMeshGeometryRange& OutRange) const
+{
+	const int32_t MeshIdx = InMesh->GetBufferDataIndex();
+	if (MeshIdx < 0 || MeshIdx >= static_cast<int32_t>(Ranges.size()) || Ranges[MeshIdx].IndexCount == 0)
+	{
+		return false;
+	}
+
+	OutRange = Ranges[MeshIdx];
+	return true;
+}
+
+UHRenderBuffer<uint32_t>* UHMeshGeometryPool::GetPositionBuffer() const
+{
+	return PositionBuffer.get();
+}
+
+UHRenderBuffer<uint32_t>* UHMeshGeometryPool::GetUV0Buffer() const
+{
+	return UV0Buffer.get();
+}
+
+UHRenderBuffer<uint32_t>* UHMeshGeometryPool::GetNormalBuffer() const
+{
+	return NormalBuffer.get();
+}
+
+UHRenderBuffer<uint32_t>* UHMeshGeometryPool::GetTangentBuffer() const
+{
+	return TangentBuffer.get();
+}
+
+UHRenderBuffer<uint32_t>* UHMeshGeometryPool::GetIndexBuffer() const
+{
+	return IndexBuffer.get();
+}
\ No newline at end of file
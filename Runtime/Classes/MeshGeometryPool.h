@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "RenderBuffer.h"
+
+class UHGraphic;
+class UHMesh;
+
+// the range of a mesh in the geometry pool, VertexOffset is added to the indices of the mesh when it's drawn
+struct UHMeshGeometryRange
+{
+	UHMeshGeometryRange()
+		: FirstIndex(0)
+		, VertexOffset(0)
+		, IndexCount(0)
+	{
+
+	}
+
+	uint32_t FirstIndex;
+	int32_t VertexOffset;
+	uint32_t IndexCount;
+};
+
+// vertex streams and indices of meshes packed into shared buffers, so renderers of different meshes can be drawn by one indirect call
+// streams are raw uint buffers as the mesh buffers, the vertices of a mesh start at the same VertexOffset in all streams,
+// so meshes of both vertex formats can share the streams, and indices are stored as 32-bit
+class UHMeshGeometryPool
+{
+public:
+	UHMeshGeometryPool();
+	void Release();
+
+	// pack meshes from their CPU data, so it must be done before CPU data is released
+	// meshes are indexed by their buffer data index, a mesh without CPU data isn't packed
+	void Build(UHGraphic* InGfx, const std::vector<UHMesh*>& InMeshes);
+
+	// false if the mesh isn't packed
+	bool GetRange(const UHMesh* InMesh, UHMeshGeometryRange& OutRange) const;
+
+	UHRenderBuffer<uint32_t>* GetPositionBuffer() const;
+	UHRenderBuffer<uint32_t>* GetUV0Buffer() const;
+	UHRenderBuffer<uint32_t>* GetNormalBuffer() const;
+	UHRenderBuffer<uint32_t>* GetTangentBuffer() const;
+	UHRenderBuffer<uint32_t>* GetIndexBuffer() const;
+
+private:
+	std::vector<UHMeshGeometryRange> Ranges;
+
+	UniquePtr<UHRenderBuffer<uint32_t>> PositionBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> UV0Buffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> NormalBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> TangentBuffer;
+	UniquePtr<UHRenderBuffer<uint32_t>> IndexBuffer;
+};
\ No newline at end of file
@@ -0,0 +1,385 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace UHMeshOptimizer
+{
+	// tunables from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	const uint32_t GForsythCacheSize = 32;
+	const uint32_t GForsythMaxValence = 32;
+	const float GForsythCacheDecayPower = 1.5f;
+	const float GForsythLastTriScore = 0.75f;
+	const float GForsythValenceBoostScale = 2.0f;
+	const float GForsythValenceBoostPower = 0.5f;
+
+	// vertex -> triangle adjacency in compressed form, triangles of a vertex are stored at [Offsets[V], Offsets[V] + Counts[V])
+	struct UHTriangleAdjacency
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Counts;
+		std::vector<uint32_t> Triangles;
+	};
+
+	void BuildAdjacency(const std::vector<uint32_t>& InIndices, uint32_t InVertexCount, UHTriangleAdjacency& OutAdjacency)
+	{
+		const uint32_t TriangleCount = static_cast<uint32_t>(InIndices.size() / 3);
+		OutAdjacency.Offsets.assign(InVertexCount, 0);
+		OutAdjacency.Counts.assign(InVertexCount, 0);
+		OutAdjacency.Triangles.resize(TriangleCount * 3);
+
+		for (uint32_t Idx = 0; Idx < TriangleCount * 3; Idx++)
+		{
+			OutAdjacency.Counts[InIndices[Idx]]++;
+		}
+
+		uint32_t Offset = 0;
+		for (uint32_t Vdx = 0; Vdx < InVertexCount; Vdx++)
+		{
+			OutAdjacency.Offsets[Vdx] = Offset;
+			Offset += OutAdjacency.Counts[Vdx];
+			OutAdjacency.Counts[Vdx] = 0;
+		}
+
+		for (uint32_t Tdx = 0; Tdx < TriangleCount; Tdx++)
+		{
+			for (uint32_t Kdx = 0; Kdx < 3; Kdx++)
+			{
+				const uint32_t V = InIndices[Tdx * 3 + Kdx];
+				OutAdjacency.Triangles[OutAdjacency.Offsets[V] + OutAdjacency.Counts[V]++] = Tdx;
+			}
+		}
+	}
+
+	float CalculateACMR(const std::vector<uint32_t>& InIndices, uint32_t InVertexCount, uint32_t InCacheSize)
+	{
+		const uint32_t TriangleCount = static_cast<uint32_t>(InIndices.size() / 3);
+		if (TriangleCount == 0)
+		{
+			return 0.0f;
+		}
+
+		// FIFO simulation with timestamps, a vertex is in cache if it's pushed within the last InCacheSize misses
+		std::vector<uint32_t> CacheTimestamps(InVertexCount, 0);
+		uint32_t Timestamp = InCacheSize + 1;
+		uint32_t MissCount = 0;
+
+		for (uint32_t Idx = 0; Idx < TriangleCount * 3; Idx++)
+		{
+			const uint32_t V = InIndices[Idx];
+			if (Timestamp - CacheTimestamps[V] > InCacheSize)
+			{
+				CacheTimestamps[V] = Timestamp++;
+				MissCount++;
+			}
+		}
+
+		return static_cast<float>(MissCount) / TriangleCount;
+	}
+
+	void OptimizeVertexCache(std::vector<uint32_t>& InOutIndices, uint32_t InVertexCount)
+	{
+		const uint32_t TriangleCount = static_cast<uint32_t>(InOutIndices.size() / 3);
+		if (TriangleCount == 0 || InVertexCount == 0)
+		{
+			return;
+		}
+
+		// score tables, indexed by cache position + 1 (0 for not in cache) and valence
+		float CacheScores[GForsythCacheSize + 1];
+		float ValenceScores[GForsythMaxValence + 1];
+		CacheScores[0] = 0.0f;
+		for (uint32_t Idx = 0; Idx < GForsythCacheSize; Idx++)
+		{
+			// the last triangle gets a fixed score, so it doesn't matter which order they were added
+			CacheScores[Idx + 1] = (Idx < 3) ? GForsythLastTriScore
+				: std::pow(1.0f - static_cast<float>(Idx - 3) / (GForsythCacheSize - 3), GForsythCacheDecayPower);
+		}
+
+		ValenceScores[0] = 0.0f;
+		for (uint32_t Idx = 1; Idx <= GForsythMaxValence; Idx++)
+		{
+			ValenceScores[Idx] = GForsythValenceBoostScale * std::pow(static_cast<float>(Idx), -GForsythValenceBoostPower);
+		}
+
+		auto VertexScore = [&](int32_t InCachePos, uint32_t InLiveTriangles)
+		{
+			if (InLiveTriangles == 0)
+			{
+				return -1.0f;
+			}
+			return CacheScores[InCachePos + 1] + ValenceScores[(std::min)(InLiveTriangles, GForsythMaxValence)];
+		};
+
+		// the live count of a vertex is the Counts of adjacency, emitted triangles are swapped out from the list
+		UHTriangleAdjacency Adjacency;
+		BuildAdjacency(InOutIndices, InVertexCount, Adjacency);
+
+		std::vector<int32_t> CachePositions(InVertexCount, -1);
+		std::vector<float> VertexScores(InVertexCount);
+		for (uint32_t Vdx = 0; Vdx < InVertexCount; Vdx++)
+		{
+			VertexScores[Vdx] = VertexScore(-1, Adjacency.Counts[Vdx]);
+		}
+
+		std::vector<float> TriangleScores(TriangleCount);
+		std::vector<bool> bIsEmitted(TriangleCount, false);
+		uint32_t BestTriangle = 0;
+		for (uint32_t Tdx = 0; Tdx < TriangleCount; Tdx++)
+		{
+			TriangleScores[Tdx] = VertexScores[InOutIndices[Tdx * 3]] + VertexScores[InOutIndices[Tdx * 3 + 1]] + VertexScores[InOutIndices[Tdx * 3 + 2]];
+			if (TriangleScores[Tdx] > TriangleScores[BestTriangle])
+			{
+				BestTriangle = Tdx;
+			}
+		}
+
+		// cache holds 3 extra slots for the vertices pushed by the emitted triangle
+		std::vector<uint32_t> Cache;
+		std::vector<uint32_t> NewCache;
+		Cache.reserve(GForsythCacheSize + 3);
+		NewCache.reserve(GForsythCacheSize + 3);
+
+		std::vector<uint32_t> OutIndices(InOutIndices.size());
+		uint32_t Cursor = 0;
+
+		for (uint32_t EmitCount = 0; EmitCount < TriangleCount; EmitCount++)
+		{
+			// no candidate from the cache, pick the next unemitted triangle in the input order
+			if (BestTriangle == UINT32_MAX)
+			{
+				while (bIsEmitted[Cursor])
+				{
+					Cursor++;
+				}
+				BestTriangle = Cursor;
+			}
+
+			const uint32_t* Tri = &InOutIndices[BestTriangle * 3];
+			OutIndices[EmitCount * 3] = Tri[0];
+			OutIndices[EmitCount * 3 + 1] = Tri[1];
+			OutIndices[EmitCount * 3 + 2] = Tri[2];
+			bIsEmitted[BestTriangle] = true;
+
+			// remove the emitted triangle from the live lists
+			NewCache.clear();
+			for (uint32_t Kdx = 0; Kdx < 3; Kdx++)
+			{
+				const uint32_t V = Tri[Kdx];
+				uint32_t* Begin = &Adjacency.Triangles[Adjacency.Offsets[V]];
+				uint32_t& Count = Adjacency.Counts[V];
+				for (uint32_t Idx = 0; Idx < Count; Idx++)
+				{
+					if (Begin[Idx] == BestTriangle)
+					{
+						Begin[Idx] = Begin[Count - 1];
+						Count--;
+						break;
+					}
+				}
+				NewCache.push_back(V);
+			}
+
+			// move the triangle vertices to the front, keep the rest in LRU order
+			for (const uint32_t V : Cache)
+			{
+				if (V != Tri[0] && V != Tri[1] && V != Tri[2])
+				{
+					NewCache.push_back(V);
+				}
+			}
+
+			// update the cache positions and scores, evicted vertices are updated as well
+			for (uint32_t Idx = 0; Idx < static_cast<uint32_t>(NewCache.size()); Idx++)
+			{
+				const uint32_t V = NewCache[Idx];
+				CachePositions[V] = (Idx < GForsythCacheSize) ? static_cast<int32_t>(Idx) : -1;
+				VertexScores[V] = VertexScore(CachePositions[V], Adjacency.Counts[V]);
+			}
+
+			// rescore the live triangles touching the cache and pick the best one
+			BestTriangle = UINT32_MAX;
+			float BestScore = -1.0f;
+			for (const uint32_t V : NewCache)
+			{
+				const uint32_t* Begin = &Adjacency.Triangles[Adjacency.Offsets[V]];
+				for (uint32_t Idx = 0; Idx < Adjacency.Counts[V]; Idx++)
+				{
+					const uint32_t T = Begin[Idx];
+					const float Score = VertexScores[InOutIndices[T * 3]] + VertexScores[InOutIndices[T * 3 + 1]] + VertexScores[InOutIndices[T * 3 + 2]];
+					TriangleScores[T] = Score;
+					if (Score > BestScore)
+					{
+						BestScore = Score;
+						BestTriangle = T;
+					}
+				}
+			}
+
+			if (NewCache.size() > GForsythCacheSize)
+			{
+				NewCache.resize(GForsythCacheSize);
+			}
+			std::swap(Cache, NewCache);
+		}
+
+		InOutIndices = std::move(OutIndices);
+	}
+
+	void OptimizeOverdraw(std::vector<uint32_t>& InOutIndices, const std::vector<XMFLOAT3>& InPositions, float InThreshold)
+	{
+		const uint32_t TriangleCount = static_cast<uint32_t>(InOutIndices.size() / 3);
+		const uint32_t VertexCount = static_cast<uint32_t>(InPositions.size());
+		if (TriangleCount < 2 || VertexCount == 0)
+		{
+			return;
+		}
+
+		// find cluster starts, a triangle with 3 cache misses is a hard boundary which doesn't break the cache locality
+		// a soft boundary is added whenever the ACMR of the current cluster is good enough
+		const float TargetACMR = CalculateACMR(InOutIndices, VertexCount) * InThreshold;
+		std::vector<uint32_t> ClusterStarts;
+		std::vector<uint32_t> CacheTimestamps(VertexCount, 0);
+		uint32_t Timestamp = GACMRCacheSize + 1;
+		uint32_t ClusterMisses = 0;
+		uint32_t ClusterStart = 0;
+
+		for (uint32_t Tdx = 0; Tdx < TriangleCount; Tdx++)
+		{
+			uint32_t Misses = 0;
+			for (uint32_t Kdx = 0; Kdx < 3; Kdx++)
+			{
+				const uint32_t V = InOutIndices[Tdx * 3 + Kdx];
+				if (Timestamp - CacheTimestamps[V] > GACMRCacheSize)
+				{
+					CacheTimestamps[V] = Timestamp++;
+					Misses++;
+				}
+			}
+
+			const bool bHardBoundary = (Misses == 3);
+			const bool bSoftBoundary = Tdx > ClusterStart && static_cast<float>(ClusterMisses) <= TargetACMR * (Tdx - ClusterStart);
+			if (Tdx == 0 || bHardBoundary || bSoftBoundary)
+			{
+				ClusterStarts.push_back(Tdx);
+				ClusterStart = Tdx;
+				ClusterMisses = 0;
+
+				// a new cluster could be drawn after anything, so start with a cold cache
+				if (!bHardBoundary)
+				{
+					Timestamp += GACMRCacheSize + 1;
+					Misses = 0;
+					for (uint32_t Kdx = 0; Kdx < 3; Kdx++)
+					{
+						CacheTimestamps[InOutIndices[Tdx * 3 + Kdx]] = Timestamp++;
+						Misses++;
+					}
+				}
+			}
+			ClusterMisses += Misses;
+		}
+
+		const uint32_t ClusterCount = static_cast<uint32_t>(ClusterStarts.size());
+		if (ClusterCount < 2)
+		{
+			return;
+		}
+		ClusterStarts.push_back(TriangleCount);
+
+		// area weighted centroid and normal of clusters, the normal isn't normalized so flat clusters are sorted by their area
+		std::vector<XMFLOAT3> ClusterCentroids(ClusterCount, XMFLOAT3(0, 0, 0));
+		std::vector<XMFLOAT3> ClusterNormals(ClusterCount, XMFLOAT3(0, 0, 0));
+		XMFLOAT3 MeshCentroid(0, 0, 0);
+		float MeshArea = 0.0f;
+
+		for (uint32_t Cdx = 0; Cdx < ClusterCount; Cdx++)
+		{
+			float ClusterArea = 0.0f;
+			for (uint32_t Tdx = ClusterStarts[Cdx]; Tdx < ClusterStarts[Cdx + 1]; Tdx++)
+			{
+				const XMFLOAT3& P0 = InPositions[InOutIndices[Tdx * 3]];
+				const XMFLOAT3& P1 = InPositions[InOutIndices[Tdx * 3 + 1]];
+				const XMFLOAT3& P2 = InPositions[InOutIndices[Tdx * 3 + 2]];
+
+				const XMFLOAT3 Edge0 = P1 - P0;
+				const XMFLOAT3 Edge1 = P2 - P0;
+				XMFLOAT3 Normal;
+				XMStoreFloat3(&Normal, XMVector3Cross(XMLoadFloat3(&Edge0), XMLoadFloat3(&Edge1)));
+				const float Area = std::sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+
+				ClusterCentroids[Cdx] = ClusterCentroids[Cdx] + (P0 + P1 + P2) * (Area / 3.0f);
+				ClusterNormals[Cdx] = ClusterNormals[Cdx] + Normal;
+				ClusterArea += Area;
+			}
+
+			MeshCentroid = MeshCentroid + ClusterCentroids[Cdx];
+			MeshArea += ClusterArea;
+			ClusterCentroids[Cdx] = (ClusterArea > 0.0f) ? ClusterCentroids[Cdx] * (1.0f / ClusterArea) : InPositions[InOutIndices[ClusterStarts[Cdx] * 3]];
+		}
+
+		if (MeshArea <= 0.0f)
+		{
+			return;
+		}
+		MeshCentroid = MeshCentroid * (1.0f / MeshArea);
+
+		// clusters facing away from the mesh center are more likely to be occluders, draw them first
+		std::vector<float> SortKeys(ClusterCount);
+		float KeySum = 0.0f;
+		for (uint32_t Cdx = 0; Cdx < ClusterCount; Cdx++)
+		{
+			const XMFLOAT3 ToCluster = ClusterCentroids[Cdx] - MeshCentroid;
+			const XMFLOAT3& N = ClusterNormals[Cdx];
+			SortKeys[Cdx] = ToCluster.x * N.x + ToCluster.y * N.y + ToCluster.z * N.z;
+			KeySum += SortKeys[Cdx];
+		}
+
+		// the winding isn't known here, assume most of the surface faces outward and flip the keys if the sum says otherwise
+		if (KeySum < 0.0f)
+		{
+			for (float& Key : SortKeys)
+			{
+				Key = -Key;
+			}
+		}
+
+		std::vector<uint32_t> ClusterOrder(ClusterCount);
+		std::iota(ClusterOrder.begin(), ClusterOrder.end(), 0);
+		std::stable_sort(ClusterOrder.begin(), ClusterOrder.end(), [&SortKeys](uint32_t A, uint32_t B)
+			{
+				return SortKeys[A] > SortKeys[B];
+			});
+
+		std::vector<uint32_t> OutIndices;
+		OutIndices.reserve(InOutIndices.size());
+		for (const uint32_t Cdx : ClusterOrder)
+		{
+			OutIndices.insert(OutIndices.end(), InOutIndices.begin() + ClusterStarts[Cdx] * 3, InOutIndices.begin() + ClusterStarts[Cdx + 1] * 3);
+		}
+		InOutIndices = std::move(OutIndices);
+	}
+
+	void OptimizeVertexFetch(std::vector<uint32_t>& InOutIndices, uint32_t InVertexCount, std::vector<uint32_t>& OutRemap)
+	{
+		OutRemap.assign(InVertexCount, UINT32_MAX);
+		uint32_t NextVertex = 0;
+
+		for (uint32_t& Index : InOutIndices)
+		{
+			if (OutRemap[Index] == UINT32_MAX)
+			{
+				OutRemap[Index] = NextVertex++;
+			}
+			Index = OutRemap[Index];
+		}
+
+		for (uint32_t& Remap : OutRemap)
+		{
+			if (Remap == UINT32_MAX)
+			{
+				Remap = NextVertex++;
+			}
+		}
+	}
+}
\ No newline at end of file
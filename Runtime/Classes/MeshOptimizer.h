@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+// ACMR before and after the optimization, measured with a FIFO cache of GACMRCacheSize
+struct UHMeshOptimizeStats
+{
+	UHMeshOptimizeStats()
+		: TriangleCount(0)
+		, VertexCount(0)
+		, ACMRBefore(0.0f)
+		, ACMRAfter(0.0f)
+	{
+
+	}
+
+	uint32_t TriangleCount;
+	uint32_t VertexCount;
+	float ACMRBefore;
+	float ACMRAfter;
+};
+
+// index and vertex reordering for imported meshes, all functions work on triangle lists
+// the usual order is: vertex cache -> overdraw -> vertex fetch
+namespace UHMeshOptimizer
+{
+	// post-transform cache size used for ACMR report, close to the hardware FIFO caches
+	const uint32_t GACMRCacheSize = 16;
+
+	// average cache miss ratio: transformed vertices per triangle, 0.5 is the ideal value of a regular grid
+	float CalculateACMR(const std::vector<uint32_t>& InIndices, uint32_t InVertexCount, uint32_t InCacheSize = GACMRCacheSize);
+
+	// Tom Forsyth's linear-speed vertex cache optimization, reorders triangles in place
+	void OptimizeVertexCache(std::vector<uint32_t>& InOutIndices, uint32_t InVertexCount);
+
+	// split the cache optimized order into clusters at the cache boundaries and sort the clusters from outside to inside
+	// so the occluders are more likely to be drawn first, InThreshold limits the ACMR loss caused by the extra cluster splits
+	void OptimizeOverdraw(std::vector<uint32_t>& InOutIndices, const std::vector<XMFLOAT3>& InPositions, float InThreshold = 1.05f);
+
+	// reorder vertices by their first use in the index buffer, the indices are rewritten in place
+	// OutRemap[OldVertex] = NewVertex, unreferenced vertices are kept and moved to the end
+	void OptimizeVertexFetch(std::vector<uint32_t>& InOutIndices, uint32_t InVertexCount, std::vector<uint32_t>& OutRemap);
+
+	// apply the vertex fetch remap on a vertex stream, streams that don't match the remap size are left untouched
+	template <typename T>
+	void RemapVertexStream(std::vector<T>& InOutStream, const std::vector<uint32_t>& InRemap)
+	{
+		if (InOutStream.size() != InRemap.size())
+		{
+			return;
+		}
+
+		std::vector<T> Remapped(InOutStream.size());
+		for (size_t Idx = 0; Idx < InRemap.size(); Idx++)
+		{
+			Remapped[InRemap[Idx]] = InOutStream[Idx];
+		}
+		InOutStream = std::move(Remapped);
+	}
+}
\ No newline at end of file
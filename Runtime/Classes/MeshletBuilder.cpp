@@ -0,0 +1,436 @@
+#include "MeshletBuilder.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace UHMeshletBuilder
+{
+	// spread the lowest 10 bits to every third bit, for morton code
+	uint32_t SpreadBits(uint32_t InValue)
+	{
+		InValue &= 0x3ff;
+		InValue = (InValue | (InValue << 16)) & 0x030000ff;
+		InValue = (InValue | (InValue << 8)) & 0x0300f00f;
+		InValue = (InValue | (InValue << 4)) & 0x030c30c3;
+		InValue = (InValue | (InValue << 2)) & 0x09249249;
+		return InValue;
+	}
+
+	// working data of the current meshlet
+	struct UHMeshletContext
+	{
+		std::vector<uint32_t> Vertices;
+		std::vector<uint32_t> Primitives;
+		std::vector<uint32_t> Triangles;
+		std::vector<uint32_t> Candidates;
+	};
+
+	void ComputeMeshletBound(const std::vector<XMFLOAT3>& InPositions, const std::vector<XMFLOAT3>& InFaceNormals
+		, const UHMeshletContext& InContext, UHMeshlet& OutMeshlet)
+	{
+		// bounding sphere, centered at the bounding box center
+		constexpr float Inf = std::numeric_limits<float>::infinity();
+		XMFLOAT3 MinPoint = XMFLOAT3(Inf, Inf, Inf);
+		XMFLOAT3 MaxPoint = XMFLOAT3(-Inf, -Inf, -Inf);
+		for (const uint32_t VertexIdx : InContext.Vertices)
+		{
+			MinPoint = MathHelpers::MinVector(InPositions[VertexIdx], MinPoint);
+			MaxPoint = MathHelpers::MaxVector(InPositions[VertexIdx], MaxPoint);
+		}
+
+		const XMVECTOR Center = (XMLoadFloat3(&MinPoint) + XMLoadFloat3(&MaxPoint)) * 0.5f;
+		float SquareRadius = 0.0f;
+		for (const uint32_t VertexIdx : InContext.Vertices)
+		{
+			const XMVECTOR Diff = XMLoadFloat3(&InPositions[VertexIdx]) - Center;
+			SquareRadius = std::max(SquareRadius, XMVectorGetX(XMVector3LengthSq(Diff)));
+		}
+
+		XMStoreFloat3(&OutMeshlet.BoundCenter, Center);
+		OutMeshlet.BoundRadius = std::sqrt(SquareRadius);
+
+		// normal cone, the axis is the average of face normals and the spread is the minimum dot between axis and normals
+		XMVECTOR AxisSum = XMVectorZero();
+		for (const uint32_t TriIdx : InContext.Triangles)
+		{
+			AxisSum += XMLoadFloat3(&InFaceNormals[TriIdx]);
+		}
+
+		OutMeshlet.ConeAxis = XMFLOAT3(0, 0, 0);
+		OutMeshlet.ConeCutoff = 1.0f;
+		if (XMVectorGetX(XMVector3LengthSq(AxisSum)) < GEpsilon)
+		{
+			return;
+		}
+
+		const XMVECTOR Axis = XMVector3Normalize(AxisSum);
+		float MinDot = 1.0f;
+		for (const uint32_t TriIdx : InContext.Triangles)
+		{
+			const XMVECTOR N = XMLoadFloat3(&InFaceNormals[TriIdx]);
+			// degenerated triangles have zero normal and can be ignored
+			if (XMVectorGetX(XMVector3LengthSq(N)) > 0.0f)
+			{
+				MinDot = std::min(MinDot, XMVectorGetX(XMVector3Dot(Axis, N)));
+			}
+		}
+
+		XMStoreFloat3(&OutMeshlet.ConeAxis, Axis);
+
+		// the cone is nearly a half space or wider, it's not worth testing
+		if (MinDot <= 0.1f)
+		{
+			return;
+		}
+
+		OutMeshlet.ConeCutoff = std::sqrt(1.0f - MinDot * MinDot);
+	}
+
+	void BuildMeshlets(const std::vector<XMFLOAT3>& InPositions, const std::vector<XMFLOAT3>& InNormals, const std::vector<uint32_t>& InIndices
+		, uint32_t InMaxVertices, uint32_t InMaxPrimitives, std::vector<UHMeshlet>& OutMeshlets, std::vector<uint32_t>& OutMeshletIndices)
+	{
+		OutMeshlets.clear();
+		OutMeshletIndices.clear();
+
+		const uint32_t VertexCount = static_cast<uint32_t>(InPositions.size());
+		const uint32_t TriangleCount = static_cast<uint32_t>(InIndices.size() / 3);
+
+		// local indices are packed as 8-bit, and a meshlet needs at least one triangle
+		if (TriangleCount == 0 || InMaxVertices < 3 || InMaxVertices > 256 || InMaxPrimitives == 0)
+		{
+			return;
+		}
+
+		const bool bHasNormals = (InNormals.size() == InPositions.size());
+
+		// vertex to triangle adjacency, and the number of unprocessed triangles of vertices
+		std::vector<uint32_t> AdjacencyOffsets(VertexCount + 1, 0);
+		std::vector<uint32_t> AdjacencyTriangles(TriangleCount * 3);
+		std::vector<uint32_t> LiveCounts(VertexCount, 0);
+
+		for (const uint32_t Index : InIndices)
+		{
+			LiveCounts[Index]++;
+		}
+
+		for (uint32_t Idx = 0; Idx < VertexCount; Idx++)
+		{
+			AdjacencyOffsets[Idx + 1] = AdjacencyOffsets[Idx] + LiveCounts[Idx];
+		}
+
+		{
+			std::vector<uint32_t> FillCounts(VertexCount, 0);
+			for (uint32_t Idx = 0; Idx < TriangleCount * 3; Idx++)
+			{
+				const uint32_t VertexIdx = InIndices[Idx];
+				AdjacencyTriangles[AdjacencyOffsets[VertexIdx] + FillCounts[VertexIdx]++] = Idx / 3;
+			}
+		}
+
+		// face normals and centroids, face normals are flipped to the side of vertex normals if there are
+		std::vector<XMFLOAT3> FaceNormals(TriangleCount);
+		std::vector<XMFLOAT3> Centroids(TriangleCount);
+		constexpr float Inf = std::numeric_limits<float>::infinity();
+		XMFLOAT3 MinPoint = XMFLOAT3(Inf, Inf, Inf);
+		XMFLOAT3 MaxPoint = XMFLOAT3(-Inf, -Inf, -Inf);
+
+		for (uint32_t TriIdx = 0; TriIdx < TriangleCount; TriIdx++)
+		{
+			const uint32_t I0 = InIndices[TriIdx * 3];
+			const uint32_t I1 = InIndices[TriIdx * 3 + 1];
+			const uint32_t I2 = InIndices[TriIdx * 3 + 2];
+
+			const XMVECTOR P0 = XMLoadFloat3(&InPositions[I0]);
+			const XMVECTOR P1 = XMLoadFloat3(&InPositions[I1]);
+			const XMVECTOR P2 = XMLoadFloat3(&InPositions[I2]);
+
+			XMVECTOR N = XMVector3Cross(P1 - P0, P2 - P0);
+			if (XMVectorGetX(XMVector3LengthSq(N)) > 0.0f)
+			{
+				N = XMVector3Normalize(N);
+				if (bHasNormals)
+				{
+					const XMVECTOR VertexNormals = XMLoadFloat3(&InNormals[I0]) + XMLoadFloat3(&InNormals[I1]) + XMLoadFloat3(&InNormals[I2]);
+					if (XMVectorGetX(XMVector3Dot(N, VertexNormals)) < 0.0f)
+					{
+						N = -N;
+					}
+				}
+			}
+			else
+			{
+				N = XMVectorZero();
+			}
+
+			XMStoreFloat3(&FaceNormals[TriIdx], N);
+			XMStoreFloat3(&Centroids[TriIdx], (P0 + P1 + P2) / 3.0f);
+			MinPoint = MathHelpers::MinVector(Centroids[TriIdx], MinPoint);
+			MaxPoint = MathHelpers::MaxVector(Centroids[TriIdx], MaxPoint);
+		}
+
+		// triangles sorted in morton order of centroids, seeds and fallbacks are picked in this order
+		// so a meshlet that runs out of connected triangles continues with the spatially close ones
+		std::vector<std::pair<uint32_t, uint32_t>> MortonOrder(TriangleCount);
+		{
+			const XMFLOAT3 Size = MaxPoint - MinPoint;
+			const float ScaleX = Size.x > 0.0f ? 1023.0f / Size.x : 0.0f;
+			const float ScaleY = Size.y > 0.0f ? 1023.0f / Size.y : 0.0f;
+			const float ScaleZ = Size.z > 0.0f ? 1023.0f / Size.z : 0.0f;
+
+			for (uint32_t TriIdx = 0; TriIdx < TriangleCount; TriIdx++)
+			{
+				const XMFLOAT3& C = Centroids[TriIdx];
+				const uint32_t X = static_cast<uint32_t>((C.x - MinPoint.x) * ScaleX);
+				const uint32_t Y = static_cast<uint32_t>((C.y - MinPoint.y) * ScaleY);
+				const uint32_t Z = static_cast<uint32_t>((C.z - MinPoint.z) * ScaleZ);
+				MortonOrder[TriIdx] = std::make_pair(SpreadBits(X) | (SpreadBits(Y) << 1) | (SpreadBits(Z) << 2), TriIdx);
+			}
+			std::sort(MortonOrder.begin(), MortonOrder.end());
+		}
+
+		std::vector<bool> bEmitted(TriangleCount, false);
+		std::vector<int32_t> LocalIndices(VertexCount, UHINDEXNONE);
+		uint32_t MortonCursor = 0;
+		uint32_t EmittedCount = 0;
+
+		UHMeshletContext Context;
+		Context.Vertices.reserve(InMaxVertices);
+		Context.Primitives.reserve(InMaxPrimitives);
+		Context.Triangles.reserve(InMaxPrimitives);
+
+		// number of new vertices if the triangle is added to current meshlet
+		auto CountNewVertices = [&](uint32_t InTriIdx)
+		{
+			uint32_t Count = 0;
+			for (uint32_t Corner = 0; Corner < 3; Corner++)
+			{
+				Count += (LocalIndices[InIndices[InTriIdx * 3 + Corner]] == UHINDEXNONE) ? 1 : 0;
+			}
+			return Count;
+		};
+
+		auto AddTriangle = [&](uint32_t InTriIdx)
+		{
+			uint32_t Local[3];
+			for (uint32_t Corner = 0; Corner < 3; Corner++)
+			{
+				const uint32_t VertexIdx = InIndices[InTriIdx * 3 + Corner];
+				if (LocalIndices[VertexIdx] == UHINDEXNONE)
+				{
+					LocalIndices[VertexIdx] = static_cast<int32_t>(Context.Vertices.size());
+					Context.Vertices.push_back(VertexIdx);
+
+					// neighbors of new vertices become candidates
+					for (uint32_t Adj = AdjacencyOffsets[VertexIdx]; Adj < AdjacencyOffsets[VertexIdx + 1]; Adj++)
+					{
+						if (!bEmitted[AdjacencyTriangles[Adj]])
+						{
+							Context.Candidates.push_back(AdjacencyTriangles[Adj]);
+						}
+					}
+				}
+
+				Local[Corner] = static_cast<uint32_t>(LocalIndices[VertexIdx]);
+				LiveCounts[VertexIdx]--;
+			}
+
+			Context.Primitives.push_back(PackPrimitive(Local[0], Local[1], Local[2]));
+			Context.Triangles.push_back(InTriIdx);
+			bEmitted[InTriIdx] = true;
+			EmittedCount++;
+		};
+
+		auto FlushMeshlet = [&]()
+		{
+			UHMeshlet Meshlet;
+			Meshlet.VertexCount = static_cast<uint32_t>(Context.Vertices.size());
+			Meshlet.VertexOffset = static_cast<uint32_t>(OutMeshletIndices.size());
+			OutMeshletIndices.insert(OutMeshletIndices.end(), Context.Vertices.begin(), Context.Vertices.end());
+
+			Meshlet.PrimitiveCount = static_cast<uint32_t>(Context.Primitives.size());
+			Meshlet.PrimitiveOffset = static_cast<uint32_t>(OutMeshletIndices.size());
+			OutMeshletIndices.insert(OutMeshletIndices.end(), Context.Primitives.begin(), Context.Primitives.end());
+
+			ComputeMeshletBound(InPositions, FaceNormals, Context, Meshlet);
+			OutMeshlets.push_back(Meshlet);
+
+			for (const uint32_t VertexIdx : Context.Vertices)
+			{
+				LocalIndices[VertexIdx] = UHINDEXNONE;
+			}
+
+			Context.Vertices.clear();
+			Context.Primitives.clear();
+			Context.Triangles.clear();
+			Context.Candidates.clear();
+		};
+
+		auto NextMortonTriangle = [&]()
+		{
+			while (MortonCursor < TriangleCount && bEmitted[MortonOrder[MortonCursor].second])
+			{
+				MortonCursor++;
+			}
+			return (MortonCursor < TriangleCount) ? static_cast<int32_t>(MortonOrder[MortonCursor].second) : UHINDEXNONE;
+		};
+
+		while (EmittedCount < TriangleCount)
+		{
+			// pick the best connected candidate, which adds the fewest vertices
+			// ties are broken by the number of unprocessed triangles around it, so the isolated triangles are picked first
+			int32_t BestTri = UHINDEXNONE;
+			uint32_t BestNew = 4;
+			uint32_t BestLive = ~0u;
+
+			for (size_t Idx = 0; Idx < Context.Candidates.size();)
+			{
+				const uint32_t TriIdx = Context.Candidates[Idx];
+				if (bEmitted[TriIdx])
+				{
+					Context.Candidates[Idx] = Context.Candidates.back();
+					Context.Candidates.pop_back();
+					continue;
+				}
+
+				const uint32_t NewVertices = CountNewVertices(TriIdx);
+				if (Context.Vertices.size() + NewVertices <= InMaxVertices)
+				{
+					const uint32_t Live = LiveCounts[InIndices[TriIdx * 3]] + LiveCounts[InIndices[TriIdx * 3 + 1]] + LiveCounts[InIndices[TriIdx * 3 + 2]];
+					if (NewVertices < BestNew || (NewVertices == BestNew && Live < BestLive))
+					{
+						BestTri = static_cast<int32_t>(TriIdx);
+						BestNew = NewVertices;
+						BestLive = Live;
+					}
+				}
+				Idx++;
+			}
+
+			// nothing connected, continue with the next triangle in morton order
+			if (BestTri == UHINDEXNONE)
+			{
+				const int32_t NextTri = NextMortonTriangle();
+				if (NextTri != UHINDEXNONE && Context.Vertices.size() + CountNewVertices(NextTri) <= InMaxVertices)
+				{
+					BestTri = NextTri;
+				}
+			}
+
+			if (BestTri == UHINDEXNONE)
+			{
+				FlushMeshlet();
+				continue;
+			}
+
+			AddTriangle(static_cast<uint32_t>(BestTri));
+			if (Context.Primitives.size() == InMaxPrimitives)
+			{
+				FlushMeshlet();
+			}
+		}
+
+		if (Context.Primitives.size() > 0)
+		{
+			FlushMeshlet();
+		}
+	}
+
+	bool ValidateMeshlets(const std::vector<UHMeshlet>& InMeshlets, const std::vector<uint32_t>& InMeshletIndices, const std::vector<uint32_t>& InIndices
+		, uint32_t InVertexCount, uint32_t InMaxVertices, uint32_t InMaxPrimitives)
+	{
+		// triangles are compared after rotating the smallest index to the front, which keeps the winding
+		auto MakeKey = [](uint32_t I0, uint32_t I1, uint32_t I2)
+		{
+			std::array<uint32_t, 3> Key = { I0, I1, I2 };
+			std::rotate(Key.begin(), std::min_element(Key.begin(), Key.end()), Key.end());
+			return Key;
+		};
+
+		std::vector<std::array<uint32_t, 3>> SourceTriangles;
+		SourceTriangles.reserve(InIndices.size() / 3);
+		for (size_t Idx = 0; Idx + 2 < InIndices.size(); Idx += 3)
+		{
+			SourceTriangles.push_back(MakeKey(InIndices[Idx], InIndices[Idx + 1], InIndices[Idx + 2]));
+		}
+
+		std::vector<std::array<uint32_t, 3>> MeshletTriangles;
+		MeshletTriangles.reserve(SourceTriangles.size());
+		std::vector<uint32_t> VertexStamps(InVertexCount, ~0u);
+
+		for (uint32_t MeshletIdx = 0; MeshletIdx < InMeshlets.size(); MeshletIdx++)
+		{
+			const UHMeshlet& Meshlet = InMeshlets[MeshletIdx];
+			if (Meshlet.VertexCount == 0 || Meshlet.VertexCount > InMaxVertices
+				|| Meshlet.PrimitiveCount == 0 || Meshlet.PrimitiveCount > InMaxPrimitives
+				|| Meshlet.VertexOffset + Meshlet.VertexCount > InMeshletIndices.size()
+				|| Meshlet.PrimitiveOffset + Meshlet.PrimitiveCount > InMeshletIndices.size())
+			{
+				return false;
+			}
+
+			// vertex list must be unique within a meshlet
+			for (uint32_t Idx = 0; Idx < Meshlet.VertexCount; Idx++)
+			{
+				const uint32_t VertexIdx = InMeshletIndices[Meshlet.VertexOffset + Idx];
+				if (VertexIdx >= InVertexCount || VertexStamps[VertexIdx] == MeshletIdx)
+				{
+					return false;
+				}
+				VertexStamps[VertexIdx] = MeshletIdx;
+			}
+
+			for (uint32_t Idx = 0; Idx < Meshlet.PrimitiveCount; Idx++)
+			{
+				uint32_t L0, L1, L2;
+				UnpackPrimitive(InMeshletIndices[Meshlet.PrimitiveOffset + Idx], L0, L1, L2);
+				if (L0 >= Meshlet.VertexCount || L1 >= Meshlet.VertexCount || L2 >= Meshlet.VertexCount)
+				{
+					return false;
+				}
+
+				MeshletTriangles.push_back(MakeKey(InMeshletIndices[Meshlet.VertexOffset + L0]
+					, InMeshletIndices[Meshlet.VertexOffset + L1]
+					, InMeshletIndices[Meshlet.VertexOffset + L2]));
+			}
+		}
+
+		std::sort(SourceTriangles.begin(), SourceTriangles.end());
+		std::sort(MeshletTriangles.begin(), MeshletTriangles.end());
+		return SourceTriangles == MeshletTriangles;
+	}
+
+	UHMeshletStats CalculateStats(const std::vector<UHMeshlet>& InMeshlets, uint32_t InVertexCount)
+	{
+		UHMeshletStats Stats;
+		Stats.MeshletCount = static_cast<uint32_t>(InMeshlets.size());
+		for (const UHMeshlet& Meshlet : InMeshlets)
+		{
+			Stats.TriangleCount += Meshlet.PrimitiveCount;
+			Stats.TransformedVertexCount += Meshlet.VertexCount;
+		}
+
+		if (Stats.TriangleCount > 0)
+		{
+			Stats.ACMR = static_cast<float>(Stats.TransformedVertexCount) / Stats.TriangleCount;
+		}
+
+		if (InVertexCount > 0)
+		{
+			Stats.ATVR = static_cast<float>(Stats.TransformedVertexCount) / InVertexCount;
+		}
+
+		return Stats;
+	}
+
+	uint32_t PackPrimitive(uint32_t InLocal0, uint32_t InLocal1, uint32_t InLocal2)
+	{
+		return (InLocal0 & 0xff) | ((InLocal1 & 0xff) << 8) | ((InLocal2 & 0xff) << 16);
+	}
+
+	void UnpackPrimitive(uint32_t InPacked, uint32_t& OutLocal0, uint32_t& OutLocal1, uint32_t& OutLocal2)
+	{
+		OutLocal0 = InPacked & 0xff;
+		OutLocal1 = (InPacked >> 8) & 0xff;
+		OutLocal2 = (InPacked >> 16) & 0xff;
+	}
+}
\ No newline at end of file
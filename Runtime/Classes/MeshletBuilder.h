@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+// Meshlet structure, stores the offsets to the meshlet index data and the culling data
+// the layout must be the same as UHMeshlet in UHMeshShaderCommon.hlsli
+struct UHMeshlet
+{
+public:
+	UHMeshlet()
+		: VertexCount(0)
+		, VertexOffset(0)
+		, PrimitiveCount(0)
+		, PrimitiveOffset(0)
+		, BoundCenter(XMFLOAT3(0, 0, 0))
+		, BoundRadius(0.0f)
+		, ConeAxis(XMFLOAT3(0, 0, 0))
+		, ConeCutoff(1.0f)
+	{
+
+	}
+
+	// unique vertex indices of this meshlet are stored at [VertexOffset, VertexOffset + VertexCount) of meshlet index data
+	// and the primitives are stored at [PrimitiveOffset, PrimitiveOffset + PrimitiveCount), with 3 local indices packed in 8-bit each
+	uint32_t VertexCount;
+	uint32_t VertexOffset;
+	uint32_t PrimitiveCount;
+	uint32_t PrimitiveOffset;
+
+	// bounding sphere in local space
+	XMFLOAT3 BoundCenter;
+	float BoundRadius;
+
+	// normal cone, the meshlet is back-facing when dot(Center - Eye, Axis) >= Cutoff * length(Center - Eye) + Radius
+	// cutoff is 1 when the cone is too wide to be culled
+	XMFLOAT3 ConeAxis;
+	float ConeCutoff;
+};
+
+// statistics of meshlet building
+// ACMR: transformed vertices per triangle, ATVR: transformed vertices per unique vertex
+struct UHMeshletStats
+{
+	UHMeshletStats()
+		: MeshletCount(0)
+		, TriangleCount(0)
+		, TransformedVertexCount(0)
+		, ACMR(0.0f)
+		, ATVR(0.0f)
+	{
+
+	}
+
+	uint32_t MeshletCount;
+	uint32_t TriangleCount;
+	uint32_t TransformedVertexCount;
+	float ACMR;
+	float ATVR;
+};
+
+namespace UHMeshletBuilder
+{
+	// greedy clustering of triangles, the next triangle is picked from the neighbors of current meshlet with the fewest new vertices
+	// output meshlets never exceed InMaxVertices and InMaxPrimitives, normals are used for orienting the normal cones
+	void BuildMeshlets(const std::vector<XMFLOAT3>& InPositions, const std::vector<XMFLOAT3>& InNormals, const std::vector<uint32_t>& InIndices
+		, uint32_t InMaxVertices, uint32_t InMaxPrimitives, std::vector<UHMeshlet>& OutMeshlets, std::vector<uint32_t>& OutMeshletIndices);
+
+	// check that every triangle is output exactly once and all meshlets are within limits
+	bool ValidateMeshlets(const std::vector<UHMeshlet>& InMeshlets, const std::vector<uint32_t>& InMeshletIndices, const std::vector<uint32_t>& InIndices
+		, uint32_t InVertexCount, uint32_t InMaxVertices, uint32_t InMaxPrimitives);
+
+	UHMeshletStats CalculateStats(const std::vector<UHMeshlet>& InMeshlets, uint32_t InVertexCount);
+
+	uint32_t PackPrimitive(uint32_t InLocal0, uint32_t InLocal1, uint32_t InLocal2);
+	void UnpackPrimitive(uint32_t InPacked, uint32_t& OutLocal0, uint32_t& OutLocal1, uint32_t& OutLocal2);
+}
\ No newline at end of file
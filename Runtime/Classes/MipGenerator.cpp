@@ -0,0 +1,397 @@
+#include "MipGenerator.h"
+
+#if WITH_EDITOR
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include "TextureCompressor.h"
+#include "JobSystem.h"
+
+namespace UHMipGenerator
+{
+	// source texels and weights contributing to each destination texel of one axis
+	struct UHMipContributors
+	{
+		std::vector<uint32_t> Start;
+		std::vector<uint32_t> Count;
+		std::vector<uint32_t> SrcIndices;
+		std::vector<float> Weights;
+	};
+
+	// modified Bessel function of the first kind, used by the Kaiser window
+	double BesselI0(const double X)
+	{
+		double Sum = 1.0;
+		double Term = 1.0;
+		const double HalfX = X * 0.5;
+		for (int32_t K = 1; K < 32; K++)
+		{
+			Term *= (HalfX / K) * (HalfX / K);
+			Sum += Term;
+			if (Term < Sum * 1e-12)
+			{
+				break;
+			}
+		}
+
+		return Sum;
+	}
+
+	// Kaiser windowed sinc, T is in destination texels
+	float KaiserFilter(const float T)
+	{
+		const float Radius = 3.0f;
+		const float Alpha = 4.0f;
+		if (std::abs(T) >= Radius)
+		{
+			return 0.0f;
+		}
+
+		const float X = T * XM_PI;
+		const float Sinc = (std::abs(T) < 1e-5f) ? 1.0f : std::sin(X) / X;
+		const float Ratio = T / Radius;
+		const float Window = static_cast<float>(BesselI0(Alpha * std::sqrt(1.0 - Ratio * Ratio)) / BesselI0(Alpha));
+
+		return Sinc * Window;
+	}
+
+	UHMipContributors BuildContributors(const uint32_t SrcSize, const uint32_t DstSize, const UHMipFilter InFilter)
+	{
+		UHMipContributors Contributors;
+		Contributors.Start.resize(DstSize);
+		Contributors.Count.resize(DstSize);
+
+		const float Scale = static_cast<float>(SrcSize) / DstSize;
+		const float Support = (InFilter == UHMipFilter::Box) ? Scale * 0.5f : Scale * 3.0f;
+
+		for (uint32_t Dst = 0; Dst < DstSize; Dst++)
+		{
+			const float Center = (Dst + 0.5f) * Scale;
+			const int32_t First = static_cast<int32_t>(std::floor(Center - Support));
+			const int32_t Last = static_cast<int32_t>(std::ceil(Center + Support));
+
+			Contributors.Start[Dst] = static_cast<uint32_t>(Contributors.Weights.size());
+			float WeightSum = 0.0f;
+			for (int32_t Src = First; Src <= Last; Src++)
+			{
+				float Weight;
+				if (InFilter == UHMipFilter::Box)
+				{
+					// coverage of the source texel inside the destination texel
+					Weight = (std::min)(Src + 1.0f, Center + Support) - (std::max)(static_cast<float>(Src), Center - Support);
+				}
+				else
+				{
+					Weight = KaiserFilter((Src + 0.5f - Center) / Scale);
+				}
+
+				if ((InFilter == UHMipFilter::Box) ? Weight <= 0.0f : Weight == 0.0f)
+				{
+					continue;
+				}
+
+				// clamp addressing on the edges
+				Contributors.SrcIndices.push_back(static_cast<uint32_t>(std::clamp(Src, 0, static_cast<int32_t>(SrcSize) - 1)));
+				Contributors.Weights.push_back(Weight);
+				WeightSum += Weight;
+			}
+
+			Contributors.Count[Dst] = static_cast<uint32_t>(Contributors.Weights.size()) - Contributors.Start[Dst];
+			for (uint32_t Idx = 0; Idx < Contributors.Count[Dst]; Idx++)
+			{
+				Contributors.Weights[Contributors.Start[Dst] + Idx] /= WeightSum;
+			}
+		}
+
+		return Contributors;
+	}
+
+	const float* GetSRGBToLinearTable()
+	{
+		static float Table[256];
+		static std::once_flag InitFlag;
+		std::call_once(InitFlag, []()
+			{
+				for (int32_t Idx = 0; Idx < 256; Idx++)
+				{
+					const float Value = Idx / 255.0f;
+					Table[Idx] = (Value <= 0.04045f) ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+				}
+			});
+		return Table;
+	}
+
+	// linear to sRGB byte, the table is dense enough that the dark values are still exact
+	static const int32_t GLinearToSRGBTableSize = 16384;
+	const uint8_t* GetLinearToSRGBTable()
+	{
+		static uint8_t Table[GLinearToSRGBTableSize];
+		static std::once_flag InitFlag;
+		std::call_once(InitFlag, []()
+			{
+				for (int32_t Idx = 0; Idx < GLinearToSRGBTableSize; Idx++)
+				{
+					const float Value = static_cast<float>(Idx) / (GLinearToSRGBTableSize - 1);
+					const float SRGB = (Value <= 0.0031308f) ? Value * 12.92f : 1.055f * std::pow(Value, 1.0f / 2.4f) - 0.055f;
+					Table[Idx] = static_cast<uint8_t>(std::clamp(SRGB, 0.0f, 1.0f) * 255.0f + 0.5f);
+				}
+			});
+		return Table;
+	}
+
+	void DecodeTexels(const uint8_t* InData, const size_t NumTexels, const UHMipGenerationSettings& InSettings, XMVECTOR* OutTexels)
+	{
+		using namespace DirectX::PackedVector;
+		const float* SRGBTable = GetSRGBToLinearTable();
+
+		for (size_t Idx = 0; Idx < NumTexels; Idx++)
+		{
+			if (InSettings.bIsHDR)
+			{
+				OutTexels[Idx] = XMLoadHalf4(reinterpret_cast<const XMHALF4*>(InData + Idx * 8));
+				continue;
+			}
+
+			const uint8_t* Texel = InData + Idx * 4;
+			if (InSettings.bIsSRGB && !InSettings.bIsNormal)
+			{
+				OutTexels[Idx] = XMVectorSet(SRGBTable[Texel[0]], SRGBTable[Texel[1]], SRGBTable[Texel[2]], Texel[3] / 255.0f);
+			}
+			else
+			{
+				OutTexels[Idx] = XMLoadUByteN4(reinterpret_cast<const XMUBYTEN4*>(Texel));
+			}
+
+			if (InSettings.bIsNormal)
+			{
+				const XMVECTOR Normal = XMVectorMultiplyAdd(OutTexels[Idx], XMVectorReplicate(2.0f), XMVectorReplicate(-1.0f));
+				OutTexels[Idx] = XMVectorSelect(OutTexels[Idx], Normal, g_XMSelect1110);
+			}
+		}
+	}
+
+	void EncodeTexels(const XMVECTOR* InTexels, const size_t NumTexels, const UHMipGenerationSettings& InSettings, const float AlphaScale, uint8_t* OutData)
+	{
+		using namespace DirectX::PackedVector;
+		const uint8_t* SRGBTable = GetLinearToSRGBTable();
+		const XMVECTOR Scale = XMVectorSet(1.0f, 1.0f, 1.0f, AlphaScale);
+
+		for (size_t Idx = 0; Idx < NumTexels; Idx++)
+		{
+			XMVECTOR Texel = XMVectorMultiply(InTexels[Idx], Scale);
+			if (InSettings.bIsHDR)
+			{
+				XMStoreHalf4(reinterpret_cast<XMHALF4*>(OutData + Idx * 8), Texel);
+				continue;
+			}
+
+			if (InSettings.bIsNormal)
+			{
+				const XMVECTOR Encoded = XMVectorMultiplyAdd(Texel, g_XMOneHalf, g_XMOneHalf);
+				Texel = XMVectorSelect(Texel, Encoded, g_XMSelect1110);
+			}
+			Texel = XMVectorSaturate(Texel);
+
+			uint8_t* Output = OutData + Idx * 4;
+			XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(Output), Texel);
+			if (InSettings.bIsSRGB && !InSettings.bIsNormal)
+			{
+				XMFLOAT4A Linear;
+				XMStoreFloat4A(&Linear, XMVectorScale(Texel, GLinearToSRGBTableSize - 1.0f));
+				Output[0] = SRGBTable[static_cast<int32_t>(Linear.x + 0.5f)];
+				Output[1] = SRGBTable[static_cast<int32_t>(Linear.y + 0.5f)];
+				Output[2] = SRGBTable[static_cast<int32_t>(Linear.z + 0.5f)];
+			}
+		}
+	}
+
+	// fraction of texels whose alpha pass the cutoff after scaling
+	float CalculateAlphaCoverage(const std::vector<XMVECTOR>& InTexels, const float InCutoff)
+	{
+		size_t NumPassed = 0;
+		for (const XMVECTOR& Texel : InTexels)
+		{
+			NumPassed += (XMVectorGetW(Texel) > InCutoff) ? 1 : 0;
+		}
+
+		return static_cast<float>(NumPassed) / InTexels.size();
+	}
+
+	// find the alpha scale which keeps the coverage, the threshold is placed between two distinct alpha values
+	// texels with the same alpha pass or fail together, so pick the side which is closer to the target count
+	float FindAlphaScale(const std::vector<XMVECTOR>& InTexels, const float InCutoff, const float InTargetCoverage)
+	{
+		std::vector<float> Alphas(InTexels.size());
+		for (size_t Idx = 0; Idx < InTexels.size(); Idx++)
+		{
+			Alphas[Idx] = XMVectorGetW(InTexels[Idx]);
+		}
+
+		const size_t TargetCount = static_cast<size_t>(InTargetCoverage * Alphas.size() + 0.5f);
+		if (TargetCount == 0)
+		{
+			return 1.0f;
+		}
+
+		std::nth_element(Alphas.begin(), Alphas.begin() + (TargetCount - 1), Alphas.end(), std::greater<float>());
+		const float Pivot = Alphas[TargetCount - 1];
+
+		size_t NumGreater = 0;
+		size_t NumEqual = 0;
+		float NextHigher = FLT_MAX;
+		float NextLower = -FLT_MAX;
+		for (const float Alpha : Alphas)
+		{
+			if (Alpha > Pivot)
+			{
+				NumGreater++;
+				NextHigher = (std::min)(NextHigher, Alpha);
+			}
+			else if (Alpha == Pivot)
+			{
+				NumEqual++;
+			}
+			else
+			{
+				NextLower = (std::max)(NextLower, Alpha);
+			}
+		}
+
+		float Threshold;
+		if (NumGreater + NumEqual - TargetCount <= TargetCount - NumGreater)
+		{
+			// texels equal to the pivot pass
+			Threshold = (NextLower > -FLT_MAX) ? (Pivot + NextLower) * 0.5f : Pivot * 0.999f;
+		}
+		else
+		{
+			Threshold = (NextHigher < FLT_MAX) ? (Pivot + NextHigher) * 0.5f : Pivot * 1.001f;
+		}
+
+		return (std::min)(InCutoff / (std::max)(Threshold, 1e-4f), 16.0f);
+	}
+
+	uint32_t GetMipCount(const uint32_t Width, const uint32_t Height)
+	{
+		return static_cast<uint32_t>(std::floor(std::log2((std::min)(Width, Height)))) + 1;
+	}
+
+	std::vector<uint8_t> GenerateMipChain(const uint32_t Width, const uint32_t Height, const uint32_t MipCount
+		, const std::vector<uint8_t>& Input, const UHMipGenerationSettings& InSettings)
+	{
+		const size_t ByteSize = InSettings.bIsHDR ? 8 : 4;
+		const size_t Mip0Size = static_cast<size_t>(Width) * Height * ByteSize;
+		if (Input.size() < Mip0Size || MipCount == 0)
+		{
+			return Input;
+		}
+
+		size_t TotalSize = 0;
+		for (uint32_t MipIdx = 0; MipIdx < MipCount; MipIdx++)
+		{
+			TotalSize += static_cast<size_t>(Width >> MipIdx) * (Height >> MipIdx) * ByteSize;
+		}
+
+		std::vector<uint8_t> Output(TotalSize);
+		memcpy_s(Output.data(), Output.size(), Input.data(), Mip0Size);
+
+		// float data of the previous mip
+		std::vector<XMVECTOR> SrcTexels(static_cast<size_t>(Width) * Height);
+		DecodeTexels(Input.data(), SrcTexels.size(), InSettings, SrcTexels.data());
+
+		const bool bPreserveCoverage = InSettings.AlphaCutoff > 0.0f && !InSettings.bIsNormal;
+		const float TargetCoverage = bPreserveCoverage ? CalculateAlphaCoverage(SrcTexels, InSettings.AlphaCutoff) : 0.0f;
+
+		UHJobSystem& JobSystem = UHTextureCompressor::GetTextureJobSystem();
+		std::vector<XMVECTOR> Intermediate;
+		std::vector<XMVECTOR> DstTexels;
+		size_t MipOffset = Mip0Size;
+
+		for (uint32_t MipIdx = 1; MipIdx < MipCount; MipIdx++)
+		{
+			const uint32_t SrcWidth = Width >> (MipIdx - 1);
+			const uint32_t SrcHeight = Height >> (MipIdx - 1);
+			const uint32_t DstWidth = Width >> MipIdx;
+			const uint32_t DstHeight = Height >> MipIdx;
+			const UHMipContributors ContributorsX = BuildContributors(SrcWidth, DstWidth, InSettings.Filter);
+			const UHMipContributors ContributorsY = BuildContributors(SrcHeight, DstHeight, InSettings.Filter);
+
+			// horizontal pass, source rows to destination width
+			Intermediate.resize(static_cast<size_t>(DstWidth) * SrcHeight);
+			JobSystem.ParallelFor(static_cast<int32_t>(SrcHeight), 8, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+				{
+					for (int32_t Y = Begin; Y < End; Y++)
+					{
+						const XMVECTOR* SrcRow = SrcTexels.data() + static_cast<size_t>(Y) * SrcWidth;
+						XMVECTOR* DstRow = Intermediate.data() + static_cast<size_t>(Y) * DstWidth;
+						for (uint32_t X = 0; X < DstWidth; X++)
+						{
+							const uint32_t Start = ContributorsX.Start[X];
+							XMVECTOR Sum = XMVectorZero();
+							for (uint32_t Idx = Start; Idx < Start + ContributorsX.Count[X]; Idx++)
+							{
+								Sum = XMVectorMultiplyAdd(SrcRow[ContributorsX.SrcIndices[Idx]], XMVectorReplicate(ContributorsX.Weights[Idx]), Sum);
+							}
+							DstRow[X] = Sum;
+						}
+					}
+				});
+
+			// vertical pass, then clamp the ringing of Kaiser filter and renormalize
+			DstTexels.resize(static_cast<size_t>(DstWidth) * DstHeight);
+			JobSystem.ParallelFor(static_cast<int32_t>(DstHeight), 8, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+				{
+					const XMVECTOR MinValue = InSettings.bIsNormal ? XMVectorSet(-1.0f, -1.0f, -1.0f, 0.0f) : XMVectorZero();
+					const XMVECTOR MaxValue = InSettings.bIsHDR ? XMVectorReplicate(65504.0f) : XMVectorReplicate(1.0f);
+
+					for (int32_t Y = Begin; Y < End; Y++)
+					{
+						// accumulate whole rows so the intermediate data is read linearly
+						XMVECTOR* DstRow = DstTexels.data() + static_cast<size_t>(Y) * DstWidth;
+						std::fill(DstRow, DstRow + DstWidth, XMVectorZero());
+
+						const uint32_t Start = ContributorsY.Start[Y];
+						for (uint32_t Idx = Start; Idx < Start + ContributorsY.Count[Y]; Idx++)
+						{
+							const XMVECTOR* SrcRow = Intermediate.data() + static_cast<size_t>(ContributorsY.SrcIndices[Idx]) * DstWidth;
+							const XMVECTOR Weight = XMVectorReplicate(ContributorsY.Weights[Idx]);
+							for (uint32_t X = 0; X < DstWidth; X++)
+							{
+								DstRow[X] = XMVectorMultiplyAdd(SrcRow[X], Weight, DstRow[X]);
+							}
+						}
+
+						for (uint32_t X = 0; X < DstWidth; X++)
+						{
+							XMVECTOR Sum = XMVectorClamp(DstRow[X], MinValue, MaxValue);
+
+							if (InSettings.bIsNormal)
+							{
+								// a fully cancelled normal falls back to the up vector of tangent space
+								const XMVECTOR Length = XMVector3Length(Sum);
+								const XMVECTOR Normal = (XMVectorGetX(Length) > 1e-5f) ? XMVectorDivide(Sum, Length) : g_XMIdentityR2;
+								Sum = XMVectorSelect(Sum, Normal, g_XMSelect1110);
+							}
+							DstRow[X] = Sum;
+						}
+					}
+				});
+
+			const float AlphaScale = bPreserveCoverage ? FindAlphaScale(DstTexels, InSettings.AlphaCutoff, TargetCoverage) : 1.0f;
+			uint8_t* MipData = Output.data() + MipOffset;
+			JobSystem.ParallelFor(static_cast<int32_t>(DstHeight), 8, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
+				{
+					const size_t RowStart = static_cast<size_t>(Begin) * DstWidth;
+					EncodeTexels(DstTexels.data() + RowStart, static_cast<size_t>(End - Begin) * DstWidth, InSettings, AlphaScale
+						, MipData + RowStart * ByteSize);
+				});
+
+			MipOffset += DstTexels.size() * ByteSize;
+			std::swap(SrcTexels, DstTexels);
+		}
+
+		return Output;
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include "../../UnheardEngine.h"
+
+#if WITH_EDITOR
+#include <vector>
+
+// downsampling filter of the CPU mip generator
+enum class UHMipFilter
+{
+	Box,
+	Kaiser
+};
+
+struct UHMipGenerationSettings
+{
+	UHMipGenerationSettings()
+		: Filter(UHMipFilter::Kaiser)
+		, bIsHDR(false)
+		, bIsSRGB(true)
+		, bIsNormal(false)
+		, AlphaCutoff(0.0f)
+	{
+
+	}
+
+	UHMipFilter Filter;
+
+	// RGBA16F input if HDR, RGBA8 otherwise
+	bool bIsHDR;
+
+	// filter RGB in linear space, the alpha is always linear
+	bool bIsSRGB;
+
+	// decode RGB to [-1,1] and renormalize after filtering
+	bool bIsNormal;
+
+	// scale the alpha of each mip so the coverage of (alpha > cutoff) stays the same as mip 0, zero disables it
+	float AlphaCutoff;
+};
+
+// CPU mip chain generator, it doesn't need a graphic device so textures can be cooked without a GPU
+// every mip is filtered from the float data of the previous mip, so the quantization error doesn't accumulate
+// the filtering is separable, rows are split across the job system and the texels are processed with DirectXMath vectors
+namespace UHMipGenerator
+{
+	// number of mips with the same rule as UHTexture, the smaller side decides the count
+	uint32_t GetMipCount(const uint32_t Width, const uint32_t Height);
+
+	// returns all mips from 0 to MipCount - 1 tightly packed, mip 0 is the copy of the input
+	std::vector<uint8_t> GenerateMipChain(const uint32_t Width, const uint32_t Height, const uint32_t MipCount
+		, const std::vector<uint8_t>& Input, const UHMipGenerationSettings& InSettings);
+}
+#endif
\ No newline at end of file
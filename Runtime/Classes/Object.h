@@ -16,6 +16,9 @@ public:
 	virtual void OnLoad(std::ifstream& InStream);
 	virtual void OnPostLoad(UHAssetManager* InAssetMgr) {}
 
+	// called before OnPostLoad, objects can request their assets asynchronously here so they're loaded in parallel
+	virtual void OnPreloadAssets(UHAssetManager* InAssetMgr) {}
+
 	void AddReferenceObject(UHObject*);
 	void RemoveReferenceObject(UHObject*);
 	void SetName(std::string InName);
@@ -7,7 +7,7 @@
 // class for managing render buffer (E.g. vertex buffer/index buffer)
 // make this template so we can decide the size dynamically
 template<class T>
-class UHRenderBuffer : public UHRenderResource
+class UHRenderBuffer : public UHRenderResource, public UHGPUMemoryClient
 {
 public:
     UHRenderBuffer() 
@@ -19,7 +19,8 @@ public:
         , DstData(nullptr)
         , BufferSize(0)
         , BufferStride(0)
-        , OffsetInSharedMemory(~0)
+        , BufferUsage(0)
+        , SharedMemory(nullptr)
     {
 
     }
@@ -61,6 +62,15 @@ public:
 
         BufferSize = InElementCount * BufferStride;
 
+        // the null graphics backend has no device, keep the data in host memory and treat it as a mapped upload buffer
+        if (LogicalDevice == nullptr)
+        {
+            HostData.resize(BufferSize);
+            DstData = HostData.data();
+            bIsUploadBuffer = true;
+            return true;
+        }
+
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = BufferSize;
@@ -114,10 +124,10 @@ public:
         return true;
 	}
 
-    bool CreateBuffer(uint64_t InElementCount, VkBufferUsageFlags InUsage, UHGPUMemory* SharedMemory)
+    bool CreateBuffer(uint64_t InElementCount, VkBufferUsageFlags InUsage, UHGPUMemory* InSharedMemory)
     {
         // skip creaetion if it's empty
-        if (InElementCount == 0 || SharedMemory == nullptr)
+        if (InElementCount == 0 || InSharedMemory == nullptr)
         {
             return false;
         }
@@ -125,6 +135,7 @@ public:
         ElementCount = InElementCount;
         BufferStride = sizeof(T);
         BufferSize = InElementCount * BufferStride;
+        BufferUsage = InUsage;
         bIsShaderDeviceAddress = (InUsage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT);
 
         VkBufferCreateInfo bufferInfo{};
@@ -142,10 +153,17 @@ public:
         VkMemoryRequirements MemRequirements;
         vkGetBufferMemoryRequirements(LogicalDevice, BufferSource, &MemRequirements);
 
-        // bind to shared memory and keep the offset
+        // bind to shared memory and keep the allocation, this buffer is notified if the allocation is moved
+        // a buffer whose device address is kept by GPU objects (acceleration structure storage or binding table) is pinned,
+        // geometry inputs are still movable since a built BLAS doesn't reference them anymore
+        const bool bIsMovable = !(InUsage & (VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR));
         bool bExceedSharedMemory = false;
-        OffsetInSharedMemory = SharedMemory->BindMemory(MemRequirements.size, MemRequirements.alignment, BufferSource);
-        if (OffsetInSharedMemory == ~0)
+        SharedAllocation = InSharedMemory->BindMemory(MemRequirements, BufferSource, bIsMovable ? this : nullptr);
+        if (SharedAllocation.IsValid())
+        {
+            SharedMemory = InSharedMemory;
+        }
+        else
         {
             bExceedSharedMemory = true;
             //UHE_LOG(L"Exceed shared image memory budget, will allocate individually instead.\n");
@@ -201,12 +219,47 @@ public:
             vkFreeMemory(LogicalDevice, BufferMemory, nullptr);
         }
 
+        if (SharedMemory)
+        {
+            SharedMemory->FreeMemory(SharedAllocation);
+        }
+
         BufferSource = nullptr;
         BufferMemory = nullptr;
+        SharedMemory = nullptr;
+
+        HostData.clear();
+        HostData.shrink_to_fit();
+    }
+
+    // recreate the buffer at the new offset after defragmentation, the data is copied by the shared memory already
+    // the new buffer has a new handle and device address, the caller of Defragment() rewrites the descriptors bound with the old one
+    // and device addresses are queried again by the next build that reads this buffer
+    virtual void OnMemoryMoved(const UHGPUMemoryAllocation& InNewAllocation) override
+    {
+        vkDestroyBuffer(LogicalDevice, BufferSource, nullptr);
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = BufferSize;
+        bufferInfo.usage = BufferUsage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(LogicalDevice, &bufferInfo, nullptr, &BufferSource) != VK_SUCCESS)
+        {
+            UHE_LOG(L"Failed to recreate buffer!\n");
+        }
+
+        if (vkBindBufferMemory(LogicalDevice, BufferSource, InNewAllocation.Memory, InNewAllocation.Offset) != VK_SUCCESS)
+        {
+            UHE_LOG(L"Failed to bind buffer to GPU!\n");
+        }
+
+        SharedAllocation = InNewAllocation;
     }
 
 	// upload all data, this will copy whole buffer
-	void UploadAllData(void* SrcData, size_t InCopySize = 0)
+	void UploadAllData(const void* SrcData, size_t InCopySize = 0)
 	{
         // upload buffer is mapped when initialization, simply copy it
         const int64_t CopySize = (InCopySize == 0) ? BufferSize : static_cast<int64_t>(InCopySize);
@@ -226,26 +279,34 @@ public:
 	}
 
     // upload all data, but it's copying to shared memory
-    void UploadAllDataShared(void* SrcData, UHGPUMemory* InMemory)
+    void UploadAllDataShared(const void* SrcData)
     {
-        if (OffsetInSharedMemory == ~0)
+        if (!SharedAllocation.IsValid())
         {
             // shared memory didn't allocate an address for this buffer (might be used up)
             // fallback to regular upload
-            if (BufferMemory != nullptr)
+            if (BufferMemory != nullptr || HostData.size() > 0)
             {
                 UploadAllData(SrcData);
             }
             return;
         }
 
-        vkMapMemory(LogicalDevice, InMemory->GetMemory(), OffsetInSharedMemory, BufferSize, 0, reinterpret_cast<void**>(&DstData));
+        // host visible shared memory is mapped persistently
+        BYTE* SharedData = SharedMemory->GetMappedData(SharedAllocation);
+        if (SharedData != nullptr)
+        {
+            memcpy_s(SharedData, BufferSize, SrcData, BufferSize);
+            return;
+        }
+
+        vkMapMemory(LogicalDevice, SharedAllocation.Memory, SharedAllocation.Offset, BufferSize, 0, reinterpret_cast<void**>(&DstData));
         memcpy_s(&DstData[0], BufferSize, SrcData, BufferSize);
-        vkUnmapMemory(LogicalDevice, InMemory->GetMemory());
+        vkUnmapMemory(LogicalDevice, SharedAllocation.Memory);
     }
 
     // upload data with individual offset, similar to upload all but copy a buffer stride instead
-    void UploadData(void* SrcData, int64_t DstOffset, size_t InCopySize = 0)
+    void UploadData(const void* SrcData, int64_t DstOffset, size_t InCopySize = 0)
     {
         // upload buffer is mapped when initialization, simply copy it
         const int64_t CopySize = (InCopySize == 0) ? BufferStride : static_cast<int64_t>(InCopySize);
@@ -310,6 +371,12 @@ private:
     bool bIsShaderDeviceAddress;
     BYTE* DstData;
 
+    VkBufferUsageFlags BufferUsage;
+
     // for shared memory
-    uint64_t OffsetInSharedMemory;
+    UHGPUMemory* SharedMemory;
+    UHGPUMemoryAllocation SharedAllocation;
+
+    // for the null graphics backend
+    std::vector<BYTE> HostData;
 };
\ No newline at end of file
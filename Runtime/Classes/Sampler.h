@@ -1,5 +1,6 @@
 #pragma once
 #include "../Engine/RenderResource.h"
+#include "Utility.h"
 
 class UHGraphic;
 
@@ -29,6 +30,20 @@ struct UHSamplerInfo
 			&& InInfo.MipBias == MipBias;
 	}
 
+	size_t GetHash() const
+	{
+		size_t Hash = 0;
+		UHUtilities::HashCombine(Hash, FilterMode);
+		UHUtilities::HashCombine(Hash, AddressModeU);
+		UHUtilities::HashCombine(Hash, AddressModeV);
+		UHUtilities::HashCombine(Hash, AddressModeW);
+		UHUtilities::HashCombine(Hash, MaxAnisotropy);
+		UHUtilities::HashCombine(Hash, CompareOp);
+		UHUtilities::HashCombine(Hash, MipBias);
+
+		return Hash;
+	}
+
 #if WITH_EDITOR
 	std::string AddressModeToString(VkSamplerAddressMode InMode) const
 	{
@@ -16,6 +16,8 @@ UHScene::UHScene()
 	, CurrentSelectedComp(nullptr)
 #endif
 	, MainCamera(nullptr)
+	, bIsInitialized(false)
+	, bIsBVHDirty(false)
 {
 	SetName("Scene" + std::to_string(GetId()));
 }
@@ -70,6 +72,12 @@ void UHScene::OnLoad(std::ifstream& InStream)
 
 void UHScene::OnPostLoad(UHAssetManager* InAssetMgr)
 {
+	// request all referenced assets first, so they're loaded in parallel while the post load callbacks wait for them one by one
+	for (UniquePtr<UHComponent>& Comp : ComponentPools)
+	{
+		Comp->OnPreloadAssets(InAssetMgr);
+	}
+
 	// certain types of component needs a post load callback to setup their reference
 	for (UniquePtr<UHComponent>& Comp : ComponentPools)
 	{
@@ -121,6 +129,17 @@ void UHScene::Initialize(UHEngine* InEngine)
 			Renderers[Idx]->SetBufferDataIndex(BufferIdx++);
 		}
 	}
+
+	// build culling bounds after buffer index assignment
+	RenderersByBufferIndex.resize(Renderers.size());
+	RendererBounds.Resize(Renderers.size());
+	for (UHMeshRendererComponent* Renderer : Renderers)
+	{
+		RenderersByBufferIndex[Renderer->GetBufferDataIndex()] = Renderer;
+		RendererBounds.SetBound(Renderer->GetBufferDataIndex(), Renderer->GetRendererBound());
+	}
+	BuildBVH();
+	bIsInitialized = true;
 }
 
 void UHScene::Release()
@@ -134,6 +153,11 @@ void UHScene::Release()
 	DirectionalLights.clear();
 	PointLights.clear();
 	SpotLights.clear();
+	RenderersByBufferIndex.clear();
+	RendererBounds.Clear();
+	StaticBVH.Clear();
+	MoveableBVH.Clear();
+	bIsInitialized = false;
 }
 
 void UHScene::Update()
@@ -147,9 +171,24 @@ void UHScene::Update()
 		if (Renderer->IsWorldDirty())
 		{
 			Renderer->Update();
+			RendererBounds.SetBound(Renderer->GetBufferDataIndex(), Renderer->GetRendererBound());
+			DirtyBVHItems.push_back(Renderer->GetBufferDataIndex());
 		}
 	}
 
+	// refit BVHs with the dirty renderers only, or rebuild them after renderers are appended
+	// each tree simply skips the items it doesn't contain
+	if (bIsBVHDirty)
+	{
+		BuildBVH();
+	}
+	else
+	{
+		StaticBVH.Refit(RendererBounds, DirtyBVHItems);
+		MoveableBVH.Refit(RendererBounds, DirtyBVHItems);
+	}
+	DirtyBVHItems.clear();
+
 	for (UHDirectionalLightComponent* Light : DirectionalLights)
 	{
 		if (Light->IsWorldDirty())
@@ -274,6 +313,17 @@ void UHScene::AddMeshRenderer(UHMeshRendererComponent* InRenderer)
 
 	Renderers.push_back(InRenderer);
 
+	// renderers added after initialization are appended to the end of buffer
+	if (bIsInitialized)
+	{
+		const int32_t BufferIdx = static_cast<int32_t>(RenderersByBufferIndex.size());
+		InRenderer->SetBufferDataIndex(BufferIdx);
+		RenderersByBufferIndex.push_back(InRenderer);
+		RendererBounds.Resize(RenderersByBufferIndex.size());
+		RendererBounds.SetBound(BufferIdx, InRenderer->GetRendererBound());
+		bIsBVHDirty = true;
+	}
+
 	// collect material as well, assign constant index for both newly added and already added cases
 	UHMaterial* InMaterial = InRenderer->GetMaterial();
 	int32_t ConstIdx = UHUtilities::FindIndex(Materials, InMaterial);
@@ -386,6 +436,42 @@ const std::vector<UHMaterial*>& UHScene::GetMaterials() const
 	return Materials;
 }
 
+const std::vector<UHMeshRendererComponent*>& UHScene::GetRenderersByBufferIndex() const
+{
+	return RenderersByBufferIndex;
+}
+
+UHCullingBounds& UHScene::GetRendererBounds()
+{
+	return RendererBounds;
+}
+
+void UHScene::QueryFrustum(const UHCullingPlanes& InPlanes, std::vector<uint32_t>& OutBits) const
+{
+	StaticBVH.QueryFrustum(RendererBounds, InPlanes, OutBits);
+	MoveableBVH.QueryFrustum(RendererBounds, InPlanes, OutBits);
+}
+
+void UHScene::QuerySphere(const XMFLOAT3& InCenter, const float InRadius, std::vector<uint32_t>& OutBits) const
+{
+	StaticBVH.QuerySphere(RendererBounds, InCenter, InRadius, OutBits);
+	MoveableBVH.QuerySphere(RendererBounds, InCenter, InRadius, OutBits);
+}
+
+UHMeshRendererComponent* UHScene::RayCast(const XMFLOAT3& InOrigin, const XMFLOAT3& InDirection, const float InMaxDistance, float& OutDistance) const
+{
+	// test the moveable tree with the distance of static hit, so it can early out
+	float StaticDistance;
+	const int32_t StaticHit = StaticBVH.RayCast(RendererBounds, InOrigin, InDirection, InMaxDistance, StaticDistance);
+
+	float MoveableDistance;
+	const int32_t MoveableHit = MoveableBVH.RayCast(RendererBounds, InOrigin, InDirection, StaticDistance, MoveableDistance);
+
+	const int32_t HitIdx = (MoveableHit != UHINDEXNONE) ? MoveableHit : StaticHit;
+	OutDistance = (MoveableHit != UHINDEXNONE) ? MoveableDistance : StaticDistance;
+	return (HitIdx != UHINDEXNONE) ? RenderersByBufferIndex[HitIdx] : nullptr;
+}
+
 UHCameraComponent* UHScene::GetMainCamera()
 {
 	return MainCamera;
@@ -396,6 +482,27 @@ UHSkyLightComponent* UHScene::GetSkyLight() const
 	return CurrentSkyLight;
 }
 
+void UHScene::BuildBVH()
+{
+	std::vector<int32_t> StaticItems;
+	std::vector<int32_t> MoveableItems;
+	for (const UHMeshRendererComponent* Renderer : RenderersByBufferIndex)
+	{
+		if (Renderer->IsMoveable())
+		{
+			MoveableItems.push_back(Renderer->GetBufferDataIndex());
+		}
+		else
+		{
+			StaticItems.push_back(Renderer->GetBufferDataIndex());
+		}
+	}
+
+	StaticBVH.Build(RendererBounds, StaticItems);
+	MoveableBVH.Build(RendererBounds, MoveableItems);
+	bIsBVHDirty = false;
+}
+
 void UHScene::UpdateCamera()
 {
 	if (MainCamera == nullptr)
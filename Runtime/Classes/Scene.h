@@ -8,6 +8,7 @@
 #include <vector>
 #include <memory>
 #include "TextureCube.h"
+#include "BoundingVolumeHierarchy.h"
 
 class UHAssetManager;
 class UHGraphic;
@@ -53,6 +54,15 @@ public:
 	const std::vector<UHPointLightComponent*>& GetPointLights() const;
 	const std::vector<UHSpotLightComponent*>& GetSpotLights() const;
 	const std::vector<UHMaterial*>& GetMaterials() const;
+
+	// renderers and their culling bounds indexed by buffer data index
+	const std::vector<UHMeshRendererComponent*>& GetRenderersByBufferIndex() const;
+	UHCullingBounds& GetRendererBounds();
+
+	// hierarchical queries against the scene BVHs, the output bits are indexed by buffer data index
+	void QueryFrustum(const UHCullingPlanes& InPlanes, std::vector<uint32_t>& OutBits) const;
+	void QuerySphere(const XMFLOAT3& InCenter, const float InRadius, std::vector<uint32_t>& OutBits) const;
+	UHMeshRendererComponent* RayCast(const XMFLOAT3& InOrigin, const XMFLOAT3& InDirection, const float InMaxDistance, float& OutDistance) const;
 	UHCameraComponent* GetMainCamera();
 	UHSkyLightComponent* GetSkyLight() const;
 
@@ -62,6 +72,7 @@ private:
 	void AddPointLight(UHPointLightComponent* InLight);
 	void AddSpotLight(UHSpotLightComponent* InLight);
 	void UpdateCamera();
+	void BuildBVH();
 
 	UHConfigManager* ConfigCache;
 	UHRawInput* Input;
@@ -76,6 +87,16 @@ private:
 	std::vector<UHDirectionalLightComponent*> DirectionalLights;
 	std::vector<UHPointLightComponent*> PointLights;
 	std::vector<UHSpotLightComponent*> SpotLights;
+	std::vector<UHMeshRendererComponent*> RenderersByBufferIndex;
+	UHCullingBounds RendererBounds;
+	bool bIsInitialized;
+
+	// static renderers are built with SAH, moveable renderers are refitted per frame
+	// static renderers are refitted too when they're moved in editor, and both are rebuilt after renderers are appended
+	UHBoundingVolumeHierarchy StaticBVH;
+	UHBoundingVolumeHierarchy MoveableBVH;
+	std::vector<int32_t> DirtyBVHItems;
+	bool bIsBVHDirty;
 
 	std::vector<UniquePtr<UHComponent>> ComponentPools;
 
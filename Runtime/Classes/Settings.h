@@ -38,6 +38,8 @@ public:
 		, FPSLimit(60.0f)
 		, MeshBufferMemoryBudgetMB(512.0f)
 		, ImageMemoryBudgetMB(1024.0f)
+		, bEnableTextureStreaming(true)
+		, TextureStreamingBudgetMB(512.0f)
 	{
 
 	}
@@ -53,6 +55,10 @@ public:
 	float FPSLimit;
 	float MeshBufferMemoryBudgetMB;
 	float ImageMemoryBudgetMB;
+
+	// texture streaming, it's only enabled in non-editor build
+	bool bEnableTextureStreaming;
+	float TextureStreamingBudgetMB;
 };
 
 enum class UHRTShadowQuality
@@ -91,8 +97,11 @@ public:
 		, FinalReflectionStrength(0.75f)
 		, bEnableAsyncCompute(false)
 		, bEnableHDR(false)
-		, bEnableHardwareOcclusion(true)
-		, OcclusionTriangleThreshold(5000)
+		, bEnableOcclusionCulling(true)
+		, OccluderTriangleLimit(2048)
+		, MaxSoftwareOccluders(64)
+		, bEnableGPUDrivenRendering(true)
+		, bEnableGPULightClustering(true)
 		, GammaCorrection(2.2f)
 		, HDRWhitePaperNits(200.0f)
 		, HDRContrast(1.3f)
@@ -133,8 +142,18 @@ public:
 	bool bDenoiseRTReflection;
 
 	bool bEnableAsyncCompute;
-	bool bEnableHardwareOcclusion;
-	int32_t OcclusionTriangleThreshold;
+
+	// Hi-Z occlusion with mesh shaders, or software occlusion on CPU otherwise
+	// software occlusion rasterizes up to MaxSoftwareOccluders meshes, meshes with more triangles than OccluderTriangleLimit aren't occluders
+	bool bEnableOcclusionCulling;
+	int32_t OccluderTriangleLimit;
+	int32_t MaxSoftwareOccluders;
+
+	// cull and draw opaque renderers with compute and indirect draws when mesh shader isn't supported
+	bool bEnableGPUDrivenRendering;
+
+	// assign lights to clusters with compute, or with SIMD on CPU and upload the lists otherwise
+	bool bEnableGPULightClustering;
 
 	// HDR settings
 	bool bEnableHDR;
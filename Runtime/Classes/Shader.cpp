@@ -10,8 +10,10 @@ UHShader::UHShader(std::string InShaderName, std::filesystem::path InSource, std
 	, ProfileName(InProfileName)
 	, ShaderDefines(InMacro)
 	, bIsMaterialShader(false)
+	, ShaderHash(0)
 {
 	Name = ShaderName;
+	CalculateHash();
 }
 
 UHShader::UHShader(std::string InShaderName, std::filesystem::path InSource, std::string InEntryName, std::string InProfileName
@@ -23,8 +25,10 @@ UHShader::UHShader(std::string InShaderName, std::filesystem::path InSource, std
 	, ProfileName(InProfileName)
 	, bIsMaterialShader(bInIsMaterialShader)
 	, ShaderDefines(InMacro)
+	, ShaderHash(0)
 {
 	Name = ShaderName;
+	CalculateHash();
 }
 
 void UHShader::Release()
@@ -75,4 +79,19 @@ bool UHShader::operator==(const UHShader& InShader)
 		&& InShader.ShaderName == ShaderName
 		&& InShader.SourcePath == SourcePath
 		&& InShader.bIsMaterialShader == bIsMaterialShader;
+}
+
+size_t UHShader::GetHash() const
+{
+	return ShaderHash;
+}
+
+void UHShader::CalculateHash()
+{
+	ShaderHash = UHUtilities::ShaderDefinesToHash(ShaderDefines);
+	UHUtilities::HashCombine(ShaderHash, ShaderName);
+	UHUtilities::HashCombine(ShaderHash, std::filesystem::hash_value(SourcePath));
+	UHUtilities::HashCombine(ShaderHash, EntryName);
+	UHUtilities::HashCombine(ShaderHash, ProfileName);
+	UHUtilities::HashCombine(ShaderHash, bIsMaterialShader);
 }
\ No newline at end of file
@@ -22,8 +22,12 @@ public:
 
 	bool operator==(const UHShader& InShader);
 
+	// hash of name, source, entry, profile and defines, it's calculated once at construction
+	size_t GetHash() const;
+
 private:
 	bool Create(VkShaderModuleCreateInfo InCreateInfo);
+	void CalculateHash();
 
 	VkShaderModule Shader;
 
@@ -33,6 +37,7 @@ private:
 	std::string ProfileName;
 	std::vector<std::string> ShaderDefines;
 	bool bIsMaterialShader;
+	size_t ShaderHash;
 
 	friend UHGraphic;
 };
\ No newline at end of file
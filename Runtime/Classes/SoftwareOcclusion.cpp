@@ -0,0 +1,411 @@
+#include "SoftwareOcclusion.h"
+#include <immintrin.h>
+
+namespace
+{
+	// matrices are stored transposed, so they transform column vectors and the product applies InB first
+	XMFLOAT4X4 MultiplyStored(const XMFLOAT4X4& InA, const XMFLOAT4X4& InB)
+	{
+		XMFLOAT4X4 Result;
+		for (int32_t Row = 0; Row < 4; Row++)
+		{
+			for (int32_t Col = 0; Col < 4; Col++)
+			{
+				Result.m[Row][Col] = InA.m[Row][0] * InB.m[0][Col] + InA.m[Row][1] * InB.m[1][Col]
+					+ InA.m[Row][2] * InB.m[2][Col] + InA.m[Row][3] * InB.m[3][Col];
+			}
+		}
+
+		return Result;
+	}
+
+	XMFLOAT4 TransformPoint(const XMFLOAT4X4& InMatrix, const XMFLOAT3& InPoint)
+	{
+		const XMFLOAT4X4& M = InMatrix;
+		return XMFLOAT4(M.m[0][0] * InPoint.x + M.m[0][1] * InPoint.y + M.m[0][2] * InPoint.z + M.m[0][3]
+			, M.m[1][0] * InPoint.x + M.m[1][1] * InPoint.y + M.m[1][2] * InPoint.z + M.m[1][3]
+			, M.m[2][0] * InPoint.x + M.m[2][1] * InPoint.y + M.m[2][2] * InPoint.z + M.m[2][3]
+			, M.m[3][0] * InPoint.x + M.m[3][1] * InPoint.y + M.m[3][2] * InPoint.z + M.m[3][3]);
+	}
+
+	// distance to the near plane in clip space, it's z <= w for reversed-z and positive in front of the plane
+	float NearDistance(const XMFLOAT4& InVertex)
+	{
+		return InVertex.w - InVertex.z;
+	}
+
+	// triangles are clipped by the near plane and a guard band of the side planes, the distances are positive inside
+	// the guard band keeps screen coordinates small, so edge functions don't lose precision for vertices close to the near plane
+	const int32_t NumClipPlanes = 5;
+	const float GuardBand = 2.0f;
+
+	float ClipDistance(const XMFLOAT4& InVertex, int32_t InPlane)
+	{
+		switch (InPlane)
+		{
+		case 0:
+			return NearDistance(InVertex);
+		case 1:
+			return GuardBand * InVertex.w + InVertex.x;
+		case 2:
+			return GuardBand * InVertex.w - InVertex.x;
+		case 3:
+			return GuardBand * InVertex.w + InVertex.y;
+		default:
+			return GuardBand * InVertex.w - InVertex.y;
+		}
+	}
+
+	uint32_t GetOutCode(const XMFLOAT4& InVertex)
+	{
+		uint32_t OutCode = 0;
+		for (int32_t Plane = 0; Plane < NumClipPlanes; Plane++)
+		{
+			if (ClipDistance(InVertex, Plane) < 0.0f)
+			{
+				OutCode |= 1u << Plane;
+			}
+		}
+
+		return OutCode;
+	}
+
+	XMFLOAT4 LerpClipVertex(const XMFLOAT4& InA, const XMFLOAT4& InB, float T)
+	{
+		return XMFLOAT4(InA.x + (InB.x - InA.x) * T, InA.y + (InB.y - InA.y) * T, InA.z + (InB.z - InA.z) * T, InA.w + (InB.w - InA.w) * T);
+	}
+
+	// clamp before converting to int, the projected coordinates can be huge close to the near plane
+	int32_t ToPixel(float InValue, int32_t InMax)
+	{
+		return static_cast<int32_t>(std::clamp(InValue, -1.0f, static_cast<float>(InMax) + 1.0f));
+	}
+}
+
+UHSoftwareOcclusion::UHSoftwareOcclusion()
+	: Width(0)
+	, Height(0)
+	, ViewProj(MathHelpers::Identity4x4())
+{
+
+}
+
+void UHSoftwareOcclusion::Resize(uint32_t InWidth, uint32_t InHeight)
+{
+	Width = ((std::max)(InWidth, 1u) + 3) & ~3u;
+	Height = (std::max)(InHeight, 1u);
+	DepthBuffer.assign(static_cast<size_t>(Width) * Height, 0.0f);
+}
+
+uint32_t UHSoftwareOcclusion::GetWidth() const
+{
+	return Width;
+}
+
+uint32_t UHSoftwareOcclusion::GetHeight() const
+{
+	return Height;
+}
+
+void UHSoftwareOcclusion::BeginFrame(const XMFLOAT4X4& InViewProj)
+{
+	// clear to the infinite far plane of reversed-z
+	ViewProj = InViewProj;
+	std::fill(DepthBuffer.begin(), DepthBuffer.end(), 0.0f);
+	Stats = UHSoftwareOcclusionStats();
+}
+
+void UHSoftwareOcclusion::RasterizeOccluder(const UHOccluderMesh& InMesh, const XMFLOAT4X4& InWorld)
+{
+	SetupTriangles(InMesh, InWorld);
+	Stats.NumOccluders++;
+
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 PixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (const UHOcclusionTriangle& Tri : Triangles)
+	{
+		const __m128 A0 = _mm_set1_ps(Tri.A[0]);
+		const __m128 A1 = _mm_set1_ps(Tri.A[1]);
+		const __m128 A2 = _mm_set1_ps(Tri.A[2]);
+		const __m128 DepthX = _mm_set1_ps(Tri.DepthX);
+		const __m128 DepthMin = _mm_set1_ps(Tri.DepthMin);
+
+		// start from an aligned pixel, the edge functions reject the pixels outside the triangle anyway
+		const int32_t StartX = Tri.MinX & ~3;
+
+		for (int32_t Y = Tri.MinY; Y <= Tri.MaxY; Y++)
+		{
+			const float PixelY = static_cast<float>(Y) + 0.5f;
+			const __m128 Row0 = _mm_set1_ps(Tri.B[0] * PixelY + Tri.C[0]);
+			const __m128 Row1 = _mm_set1_ps(Tri.B[1] * PixelY + Tri.C[1]);
+			const __m128 Row2 = _mm_set1_ps(Tri.B[2] * PixelY + Tri.C[2]);
+			const __m128 RowDepth = _mm_set1_ps(Tri.DepthY * PixelY + Tri.DepthC);
+			float* Row = &DepthBuffer[static_cast<size_t>(Y) * Width];
+
+			for (int32_t X = StartX; X <= Tri.MaxX; X += 4)
+			{
+				const __m128 PixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(X)), PixelOffsets);
+				const __m128 E0 = _mm_add_ps(_mm_mul_ps(A0, PixelX), Row0);
+				const __m128 E1 = _mm_add_ps(_mm_mul_ps(A1, PixelX), Row1);
+				const __m128 E2 = _mm_add_ps(_mm_mul_ps(A2, PixelX), Row2);
+				const __m128 Inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(E0, Zero), _mm_cmpge_ps(E1, Zero)), _mm_cmpge_ps(E2, Zero));
+				if (_mm_movemask_ps(Inside) == 0)
+				{
+					continue;
+				}
+
+				const __m128 Depth = _mm_max_ps(_mm_add_ps(_mm_mul_ps(DepthX, PixelX), RowDepth), DepthMin);
+				const __m128 OldDepth = _mm_loadu_ps(Row + X);
+				const __m128 NewDepth = _mm_max_ps(OldDepth, Depth);
+				_mm_storeu_ps(Row + X, _mm_or_ps(_mm_and_ps(Inside, NewDepth), _mm_andnot_ps(Inside, OldDepth)));
+			}
+		}
+	}
+}
+
+void UHSoftwareOcclusion::RasterizeOccluderReference(const UHOccluderMesh& InMesh, const XMFLOAT4X4& InWorld)
+{
+	SetupTriangles(InMesh, InWorld);
+	Stats.NumOccluders++;
+
+	for (const UHOcclusionTriangle& Tri : Triangles)
+	{
+		for (int32_t Y = Tri.MinY; Y <= Tri.MaxY; Y++)
+		{
+			const float PixelY = static_cast<float>(Y) + 0.5f;
+			const float Row0 = Tri.B[0] * PixelY + Tri.C[0];
+			const float Row1 = Tri.B[1] * PixelY + Tri.C[1];
+			const float Row2 = Tri.B[2] * PixelY + Tri.C[2];
+			const float RowDepth = Tri.DepthY * PixelY + Tri.DepthC;
+			float* Row = &DepthBuffer[static_cast<size_t>(Y) * Width];
+
+			for (int32_t X = Tri.MinX; X <= Tri.MaxX; X++)
+			{
+				const float PixelX = static_cast<float>(X) + 0.5f;
+				if (Tri.A[0] * PixelX + Row0 >= 0.0f && Tri.A[1] * PixelX + Row1 >= 0.0f && Tri.A[2] * PixelX + Row2 >= 0.0f)
+				{
+					const float Depth = (std::max)(Tri.DepthX * PixelX + RowDepth, Tri.DepthMin);
+					Row[X] = (std::max)(Row[X], Depth);
+				}
+			}
+		}
+	}
+}
+
+bool UHSoftwareOcclusion::IsBoxVisible(const XMFLOAT3& InCenter, const XMFLOAT3& InExtent) const
+{
+	if (DepthBuffer.empty())
+	{
+		return true;
+	}
+
+	float MinX = std::numeric_limits<float>::max();
+	float MinY = std::numeric_limits<float>::max();
+	float MaxX = -std::numeric_limits<float>::max();
+	float MaxY = -std::numeric_limits<float>::max();
+	float NearestDepth = 0.0f;
+
+	for (int32_t Idx = 0; Idx < 8; Idx++)
+	{
+		const XMFLOAT3 Corner(InCenter.x + ((Idx & 1) ? InExtent.x : -InExtent.x)
+			, InCenter.y + ((Idx & 2) ? InExtent.y : -InExtent.y)
+			, InCenter.z + ((Idx & 4) ? InExtent.z : -InExtent.z));
+
+		const XMFLOAT4 Vertex = TransformPoint(ViewProj, Corner);
+		if (Vertex.w <= 0.0f || NearDistance(Vertex) < 0.0f)
+		{
+			return true;
+		}
+
+		const float InvW = 1.0f / Vertex.w;
+		const float ScreenX = (Vertex.x * InvW * 0.5f + 0.5f) * Width;
+		const float ScreenY = (Vertex.y * InvW * 0.5f + 0.5f) * Height;
+		MinX = (std::min)(MinX, ScreenX);
+		MinY = (std::min)(MinY, ScreenY);
+		MaxX = (std::max)(MaxX, ScreenX);
+		MaxY = (std::max)(MaxY, ScreenY);
+		NearestDepth = (std::max)(NearestDepth, Vertex.z * InvW);
+	}
+
+	// the rest is left to frustum culling
+	if (MaxX < 0.0f || MaxY < 0.0f || MinX > static_cast<float>(Width) || MinY > static_cast<float>(Height))
+	{
+		return true;
+	}
+
+	// occluders cover a pixel by its center, so the rect is dilated by a pixel in case the box is seen through the rest of it
+	// the rect is aligned to 4 pixels outward as well, testing more pixels only makes the result more conservative
+	const int32_t StartX = (std::max)(ToPixel(std::floor(MinX), Width) - 1, 0) & ~3;
+	const int32_t EndX = (std::min)((std::min)(ToPixel(std::floor(MaxX), Width) + 1, static_cast<int32_t>(Width) - 1) | 3, static_cast<int32_t>(Width) - 1);
+	const int32_t StartY = (std::max)(ToPixel(std::floor(MinY), Height) - 1, 0);
+	const int32_t EndY = (std::min)(ToPixel(std::floor(MaxY), Height) + 1, static_cast<int32_t>(Height) - 1);
+
+	const __m128 BoxDepth = _mm_set1_ps(NearestDepth);
+	for (int32_t Y = StartY; Y <= EndY; Y++)
+	{
+		const float* Row = &DepthBuffer[static_cast<size_t>(Y) * Width];
+		for (int32_t X = StartX; X <= EndX; X += 4)
+		{
+			// visible when the occluder of any pixel isn't nearer than the box
+			if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(Row + X), BoxDepth)) != 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+const std::vector<float>& UHSoftwareOcclusion::GetDepthBuffer() const
+{
+	return DepthBuffer;
+}
+
+const UHSoftwareOcclusionStats& UHSoftwareOcclusion::GetStats() const
+{
+	return Stats;
+}
+
+void UHSoftwareOcclusion::SetupTriangles(const UHOccluderMesh& InMesh, const XMFLOAT4X4& InWorld)
+{
+	Triangles.clear();
+	if (DepthBuffer.empty())
+	{
+		return;
+	}
+
+	const XMFLOAT4X4 WorldViewProj = MultiplyStored(ViewProj, InWorld);
+	const size_t VertexCount = InMesh.Positions.size();
+	ClipVertices.resize(VertexCount);
+	for (size_t Idx = 0; Idx < VertexCount; Idx++)
+	{
+		ClipVertices[Idx] = TransformPoint(WorldViewProj, InMesh.Positions[Idx]);
+	}
+
+	for (size_t Idx = 0; Idx + 2 < InMesh.Indices.size(); Idx += 3)
+	{
+		if (InMesh.Indices[Idx] >= VertexCount || InMesh.Indices[Idx + 1] >= VertexCount || InMesh.Indices[Idx + 2] >= VertexCount)
+		{
+			continue;
+		}
+
+		Stats.NumTriangles++;
+		const XMFLOAT4 Vertices[3] = { ClipVertices[InMesh.Indices[Idx]], ClipVertices[InMesh.Indices[Idx + 1]], ClipVertices[InMesh.Indices[Idx + 2]] };
+		const uint32_t OutCodes[3] = { GetOutCode(Vertices[0]), GetOutCode(Vertices[1]), GetOutCode(Vertices[2]) };
+
+		if ((OutCodes[0] & OutCodes[1] & OutCodes[2]) != 0)
+		{
+			continue;
+		}
+
+		if ((OutCodes[0] | OutCodes[1] | OutCodes[2]) == 0)
+		{
+			SetupTriangle(Vertices[0], Vertices[1], Vertices[2]);
+			continue;
+		}
+
+		// clip the polygon plane by plane, each plane adds a vertex at most
+		XMFLOAT4 Polygons[2][3 + NumClipPlanes];
+		int32_t PolygonCount = 3;
+		std::copy(Vertices, Vertices + 3, Polygons[0]);
+
+		for (int32_t Plane = 0; Plane < NumClipPlanes && PolygonCount >= 3; Plane++)
+		{
+			const XMFLOAT4* Input = Polygons[Plane & 1];
+			XMFLOAT4* Output = Polygons[(Plane + 1) & 1];
+			int32_t OutputCount = 0;
+
+			for (int32_t Edge = 0; Edge < PolygonCount; Edge++)
+			{
+				const int32_t Next = (Edge + 1) % PolygonCount;
+				const float Distance = ClipDistance(Input[Edge], Plane);
+				const float NextDistance = ClipDistance(Input[Next], Plane);
+				if (Distance >= 0.0f)
+				{
+					Output[OutputCount++] = Input[Edge];
+				}
+
+				if ((Distance >= 0.0f) != (NextDistance >= 0.0f))
+				{
+					Output[OutputCount++] = LerpClipVertex(Input[Edge], Input[Next], Distance / (Distance - NextDistance));
+				}
+			}
+
+			PolygonCount = OutputCount;
+		}
+
+		const XMFLOAT4* Polygon = Polygons[NumClipPlanes & 1];
+		for (int32_t Jdx = 1; Jdx + 1 < PolygonCount; Jdx++)
+		{
+			SetupTriangle(Polygon[0], Polygon[Jdx], Polygon[Jdx + 1]);
+		}
+	}
+}
+
+void UHSoftwareOcclusion::SetupTriangle(const XMFLOAT4& InV0, const XMFLOAT4& InV1, const XMFLOAT4& InV2)
+{
+	// vertices are in front of the near plane after clipping, so w is positive
+	const XMFLOAT4* Vertices[3] = { &InV0, &InV1, &InV2 };
+	float X[3];
+	float Y[3];
+	float Z[3];
+	for (int32_t Idx = 0; Idx < 3; Idx++)
+	{
+		const float InvW = 1.0f / Vertices[Idx]->w;
+		X[Idx] = (Vertices[Idx]->x * InvW * 0.5f + 0.5f) * Width;
+		Y[Idx] = (Vertices[Idx]->y * InvW * 0.5f + 0.5f) * Height;
+		Z[Idx] = Vertices[Idx]->z * InvW;
+	}
+
+	float Area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+	if (std::abs(Area) < 1e-4f)
+	{
+		return;
+	}
+
+	// both sides are rasterized, flip the back facing ones so the edge functions are positive inside
+	if (Area < 0.0f)
+	{
+		std::swap(X[1], X[2]);
+		std::swap(Y[1], Y[2]);
+		std::swap(Z[1], Z[2]);
+		Area = -Area;
+	}
+
+	// pixels whose centers can be inside the triangle
+	UHOcclusionTriangle Tri;
+	const float MinX = (std::min)((std::min)(X[0], X[1]), X[2]);
+	const float MinY = (std::min)((std::min)(Y[0], Y[1]), Y[2]);
+	const float MaxX = (std::max)((std::max)(X[0], X[1]), X[2]);
+	const float MaxY = (std::max)((std::max)(Y[0], Y[1]), Y[2]);
+	Tri.MinX = (std::max)(ToPixel(std::ceil(MinX - 0.5f), Width), 0);
+	Tri.MinY = (std::max)(ToPixel(std::ceil(MinY - 0.5f), Height), 0);
+	Tri.MaxX = (std::min)(ToPixel(std::floor(MaxX - 0.5f), Width), static_cast<int32_t>(Width) - 1);
+	Tri.MaxY = (std::min)(ToPixel(std::floor(MaxY - 0.5f), Height), static_cast<int32_t>(Height) - 1);
+	if (Tri.MinX > Tri.MaxX || Tri.MinY > Tri.MaxY)
+	{
+		return;
+	}
+
+	// edge function I is for the edge opposite to vertex I
+	for (int32_t Idx = 0; Idx < 3; Idx++)
+	{
+		const int32_t A = (Idx + 1) % 3;
+		const int32_t B = (Idx + 2) % 3;
+		Tri.A[Idx] = Y[A] - Y[B];
+		Tri.B[Idx] = X[B] - X[A];
+		Tri.C[Idx] = X[A] * Y[B] - Y[A] * X[B];
+	}
+
+	// the depth plane is moved to the farthest point within a pixel, then clamped by the farthest vertex
+	// so a pixel never stores a depth nearer than the occluder is anywhere inside it
+	Tri.DepthX = ((Z[1] - Z[0]) * (Y[2] - Y[0]) - (Z[2] - Z[0]) * (Y[1] - Y[0])) / Area;
+	Tri.DepthY = ((Z[2] - Z[0]) * (X[1] - X[0]) - (Z[1] - Z[0]) * (X[2] - X[0])) / Area;
+	Tri.DepthC = Z[0] - Tri.DepthX * X[0] - Tri.DepthY * Y[0] - 0.5f * (std::abs(Tri.DepthX) + std::abs(Tri.DepthY));
+	Tri.DepthMin = (std::min)((std::min)(Z[0], Z[1]), Z[2]);
+
+	Triangles.push_back(Tri);
+	Stats.NumRasterizedTriangles++;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+// occluder geometry in object space, it's a CPU copy of mesh positions and triangle list indices
+struct UHOccluderMesh
+{
+	bool IsValid() const
+	{
+		return Positions.size() > 0 && Indices.size() >= 3;
+	}
+
+	std::vector<XMFLOAT3> Positions;
+	std::vector<uint32_t> Indices;
+};
+
+struct UHSoftwareOcclusionStats
+{
+	UHSoftwareOcclusionStats()
+		: NumOccluders(0)
+		, NumTriangles(0)
+		, NumRasterizedTriangles(0)
+	{
+
+	}
+
+	uint32_t NumOccluders;
+	uint32_t NumTriangles;
+	uint32_t NumRasterizedTriangles;
+};
+
+// CPU occlusion culling with a low resolution depth buffer, the depth is reversed-z as the scene depth
+// occluders are rasterized with SSE, 4 pixels a time, the scalar reference does exactly the same math
+// the depth is conservative, a pixel keeps the farthest depth of an occluder within its area, while coverage follows pixel centers
+// a box is visible if any pixel around its screen rect isn't nearer than the nearest point of the box
+// so a box can only be culled by mistake when it's seen through a gap narrower than a pixel between occluders
+class UHSoftwareOcclusion
+{
+public:
+	UHSoftwareOcclusion();
+
+	// the width is rounded up to a multiple of 4, so a row can be processed by SSE without tails
+	void Resize(uint32_t InWidth, uint32_t InHeight);
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+
+	// clear the depth buffer, view projection is the transposed matrix as it's stored in system constants
+	void BeginFrame(const XMFLOAT4X4& InViewProj);
+
+	// rasterize an occluder with the transposed world matrix, both sides of triangles are rasterized
+	void RasterizeOccluder(const UHOccluderMesh& InMesh, const XMFLOAT4X4& InWorld);
+	void RasterizeOccluderReference(const UHOccluderMesh& InMesh, const XMFLOAT4X4& InWorld);
+
+	// test a world space box, a box crossing the near plane or outside the screen is always visible
+	// it only reads the depth buffer, so boxes can be tested in parallel after rasterization
+	bool IsBoxVisible(const XMFLOAT3& InCenter, const XMFLOAT3& InExtent) const;
+
+	const std::vector<float>& GetDepthBuffer() const;
+	const UHSoftwareOcclusionStats& GetStats() const;
+
+private:
+	// screen space triangle ready for rasterization
+	// edge functions are A * x + B * y + C and they're positive inside, depth is a plane in screen space
+	struct UHOcclusionTriangle
+	{
+		float A[3];
+		float B[3];
+		float C[3];
+		float DepthX;
+		float DepthY;
+		float DepthC;
+		float DepthMin;
+		int32_t MinX;
+		int32_t MaxX;
+		int32_t MinY;
+		int32_t MaxY;
+	};
+
+	void SetupTriangles(const UHOccluderMesh& InMesh, const XMFLOAT4X4& InWorld);
+	void SetupTriangle(const XMFLOAT4& InV0, const XMFLOAT4& InV1, const XMFLOAT4& InV2);
+
+	uint32_t Width;
+	uint32_t Height;
+	XMFLOAT4X4 ViewProj;
+	std::vector<float> DepthBuffer;
+	UHSoftwareOcclusionStats Stats;
+
+	// working data, kept between occluders to avoid allocations
+	std::vector<XMFLOAT4> ClipVertices;
+	std::vector<UHOcclusionTriangle> Triangles;
+};
\ No newline at end of file
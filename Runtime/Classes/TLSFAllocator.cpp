@@ -0,0 +1,514 @@
+#include "TLSFAllocator.h"
+#include "Types.h"
+#include <cstring>
+
+static uint64_t AlignUp(uint64_t InOffset, uint64_t InAlignment)
+{
+	return (InOffset + InAlignment - 1) / InAlignment * InAlignment;
+}
+
+UHTLSFAllocator::UHTLSFAllocator()
+	: FLBitmap(0)
+	, FirstBlock(UHINDEXNONE)
+	, TotalSize(0)
+	, UsedSize(0)
+	, NumFreeBlocks(0)
+{
+	memset(SLBitmaps, 0, sizeof(SLBitmaps));
+}
+
+void UHTLSFAllocator::Initialize(uint64_t InSize)
+{
+	TotalSize = InSize / MinBlockSize * MinBlockSize;
+	Reset();
+}
+
+void UHTLSFAllocator::Reset()
+{
+	Blocks.clear();
+	UnusedBlocks.clear();
+	AllocatedBlocks.clear();
+
+	FLBitmap = 0;
+	memset(SLBitmaps, 0, sizeof(SLBitmaps));
+	FreeHeads.assign(FLCount * SLCount, UHINDEXNONE);
+	UsedSize = 0;
+	NumFreeBlocks = 0;
+	FirstBlock = UHINDEXNONE;
+
+	// the whole range starts as a single free block
+	if (TotalSize > 0)
+	{
+		FirstBlock = NewBlock(0, TotalSize);
+		InsertFreeBlock(FirstBlock);
+	}
+}
+
+uint64_t UHTLSFAllocator::Allocate(uint64_t InSize, uint64_t InAlignment, bool bIsMovable)
+{
+	if (InSize == 0 || InSize > TotalSize)
+	{
+		return InvalidOffset;
+	}
+
+	const uint64_t Size = AlignUp(InSize, MinBlockSize);
+	const uint64_t Alignment = (std::max)(InAlignment, MinBlockSize);
+
+	// search with the worst padding so any block found fits, if nothing is found,
+	// try the blocks in the list of the exact size as their offsets might be aligned already
+	int32_t BlockIdx = FindFreeBlock(Size + Alignment - MinBlockSize);
+	if (BlockIdx == UHINDEXNONE)
+	{
+		uint32_t FL;
+		uint32_t SL;
+		GetListIndex(Size, FL, SL);
+		for (int32_t Idx = FreeHeads[FL * SLCount + SL]; Idx != UHINDEXNONE; Idx = Blocks[Idx].NextFree)
+		{
+			if (AlignUp(Blocks[Idx].Offset, Alignment) + Size <= Blocks[Idx].Offset + Blocks[Idx].Size)
+			{
+				BlockIdx = Idx;
+				break;
+			}
+		}
+	}
+
+	if (BlockIdx == UHINDEXNONE)
+	{
+		return InvalidOffset;
+	}
+
+	RemoveFreeBlock(BlockIdx);
+
+	// the padding before the aligned offset stays free, it's never smaller than MinBlockSize as all offsets are multiples of it
+	const uint64_t Padding = AlignUp(Blocks[BlockIdx].Offset, Alignment) - Blocks[BlockIdx].Offset;
+	if (Padding > 0)
+	{
+		const int32_t AlignedIdx = SplitBlock(BlockIdx, Padding);
+		InsertFreeBlock(BlockIdx);
+		BlockIdx = AlignedIdx;
+	}
+
+	if (Blocks[BlockIdx].Size > Size)
+	{
+		InsertFreeBlock(SplitBlock(BlockIdx, Size));
+	}
+
+	UHTLSFBlock& Block = Blocks[BlockIdx];
+	Block.bIsFree = false;
+	Block.bIsMovable = bIsMovable;
+	Block.Alignment = Alignment;
+	UsedSize += Block.Size;
+	AllocatedBlocks[Block.Offset] = BlockIdx;
+
+	return Block.Offset;
+}
+
+bool UHTLSFAllocator::Free(uint64_t InOffset)
+{
+	const auto It = AllocatedBlocks.find(InOffset);
+	if (It == AllocatedBlocks.end())
+	{
+		return false;
+	}
+
+	int32_t BlockIdx = It->second;
+	AllocatedBlocks.erase(It);
+	UsedSize -= Blocks[BlockIdx].Size;
+	Blocks[BlockIdx].bIsFree = true;
+
+	// coalesce with the free neighbors, they can't be free at the same time with their own neighbors
+	const int32_t NextIdx = Blocks[BlockIdx].NextPhysical;
+	if (NextIdx != UHINDEXNONE && Blocks[NextIdx].bIsFree)
+	{
+		RemoveFreeBlock(NextIdx);
+		MergeWithNext(BlockIdx);
+	}
+
+	const int32_t PrevIdx = Blocks[BlockIdx].PrevPhysical;
+	if (PrevIdx != UHINDEXNONE && Blocks[PrevIdx].bIsFree)
+	{
+		RemoveFreeBlock(PrevIdx);
+		MergeWithNext(PrevIdx);
+		BlockIdx = PrevIdx;
+	}
+
+	InsertFreeBlock(BlockIdx);
+	return true;
+}
+
+void UHTLSFAllocator::Defragment(uint32_t InMaxMoves, std::vector<UHTLSFMove>& OutMoves)
+{
+	OutMoves.clear();
+
+	// walk in physical order, a movable allocation right after a free block slides down as far as its alignment allows
+	// the space it leaves joins the next free block, so the following allocations can slide into it
+	for (int32_t BlockIdx = FirstBlock; BlockIdx != UHINDEXNONE && OutMoves.size() < InMaxMoves; BlockIdx = Blocks[BlockIdx].NextPhysical)
+	{
+		const int32_t FreeIdx = Blocks[BlockIdx].PrevPhysical;
+		if (Blocks[BlockIdx].bIsFree || !Blocks[BlockIdx].bIsMovable || FreeIdx == UHINDEXNONE || !Blocks[FreeIdx].bIsFree)
+		{
+			continue;
+		}
+
+		const uint64_t SrcOffset = Blocks[BlockIdx].Offset;
+		const uint64_t DstOffset = AlignUp(Blocks[FreeIdx].Offset, Blocks[BlockIdx].Alignment);
+		if (DstOffset >= SrcOffset)
+		{
+			continue;
+		}
+
+		const uint64_t Shift = SrcOffset - DstOffset;
+		RemoveFreeBlock(FreeIdx);
+		if (DstOffset > Blocks[FreeIdx].Offset)
+		{
+			// the alignment padding stays free
+			Blocks[FreeIdx].Size = DstOffset - Blocks[FreeIdx].Offset;
+			InsertFreeBlock(FreeIdx);
+		}
+		else
+		{
+			const int32_t PrevIdx = Blocks[FreeIdx].PrevPhysical;
+			Blocks[BlockIdx].PrevPhysical = PrevIdx;
+			if (PrevIdx != UHINDEXNONE)
+			{
+				Blocks[PrevIdx].NextPhysical = BlockIdx;
+			}
+			else
+			{
+				FirstBlock = BlockIdx;
+			}
+			RecycleBlock(FreeIdx);
+		}
+
+		AllocatedBlocks.erase(SrcOffset);
+		Blocks[BlockIdx].Offset = DstOffset;
+		AllocatedBlocks[DstOffset] = BlockIdx;
+
+		const int32_t NextIdx = Blocks[BlockIdx].NextPhysical;
+		if (NextIdx != UHINDEXNONE && Blocks[NextIdx].bIsFree)
+		{
+			RemoveFreeBlock(NextIdx);
+			Blocks[NextIdx].Offset -= Shift;
+			Blocks[NextIdx].Size += Shift;
+			InsertFreeBlock(NextIdx);
+		}
+		else
+		{
+			const int32_t TailIdx = NewBlock(DstOffset + Blocks[BlockIdx].Size, Shift);
+			Blocks[TailIdx].PrevPhysical = BlockIdx;
+			Blocks[TailIdx].NextPhysical = NextIdx;
+			Blocks[BlockIdx].NextPhysical = TailIdx;
+			if (NextIdx != UHINDEXNONE)
+			{
+				Blocks[NextIdx].PrevPhysical = TailIdx;
+			}
+			InsertFreeBlock(TailIdx);
+		}
+
+		OutMoves.push_back({ SrcOffset, DstOffset, Blocks[BlockIdx].Size });
+	}
+}
+
+bool UHTLSFAllocator::Validate() const
+{
+	// physical blocks must cover the range without gaps, and two free blocks can't be neighbors
+	uint64_t Offset = 0;
+	uint64_t Used = 0;
+	uint32_t NumFree = 0;
+	uint32_t NumUsed = 0;
+	int32_t PrevIdx = UHINDEXNONE;
+	for (int32_t Idx = FirstBlock; Idx != UHINDEXNONE; Idx = Blocks[Idx].NextPhysical)
+	{
+		const UHTLSFBlock& Block = Blocks[Idx];
+		if (Block.Offset != Offset || Block.Size == 0 || (Block.Size % MinBlockSize) != 0 || Block.PrevPhysical != PrevIdx)
+		{
+			return false;
+		}
+
+		if (Block.bIsFree)
+		{
+			if (PrevIdx != UHINDEXNONE && Blocks[PrevIdx].bIsFree)
+			{
+				return false;
+			}
+			NumFree++;
+		}
+		else
+		{
+			const auto It = AllocatedBlocks.find(Block.Offset);
+			if (It == AllocatedBlocks.end() || It->second != Idx || (Block.Offset % Block.Alignment) != 0)
+			{
+				return false;
+			}
+			Used += Block.Size;
+			NumUsed++;
+		}
+
+		Offset += Block.Size;
+		PrevIdx = Idx;
+	}
+
+	if (Offset != TotalSize || Used != UsedSize || NumUsed != AllocatedBlocks.size() || NumFree != NumFreeBlocks)
+	{
+		return false;
+	}
+
+	// free lists must match the bitmaps, and each free block must be in the list of its size
+	uint32_t NumListed = 0;
+	for (uint32_t FL = 0; FL < FLCount; FL++)
+	{
+		if ((SLBitmaps[FL] != 0) != (((FLBitmap >> FL) & 1) != 0))
+		{
+			return false;
+		}
+
+		for (uint32_t SL = 0; SL < SLCount; SL++)
+		{
+			const int32_t Head = FreeHeads[FL * SLCount + SL];
+			if ((Head != UHINDEXNONE) != (((SLBitmaps[FL] >> SL) & 1) != 0))
+			{
+				return false;
+			}
+
+			int32_t PrevFreeIdx = UHINDEXNONE;
+			for (int32_t Idx = Head; Idx != UHINDEXNONE; Idx = Blocks[Idx].NextFree)
+			{
+				uint32_t BlockFL;
+				uint32_t BlockSL;
+				GetListIndex(Blocks[Idx].Size, BlockFL, BlockSL);
+				if (!Blocks[Idx].bIsFree || Blocks[Idx].PrevFree != PrevFreeIdx || BlockFL != FL || BlockSL != SL)
+				{
+					return false;
+				}
+
+				PrevFreeIdx = Idx;
+				NumListed++;
+			}
+		}
+	}
+
+	return NumListed == NumFreeBlocks;
+}
+
+uint64_t UHTLSFAllocator::GetSize() const
+{
+	return TotalSize;
+}
+
+uint64_t UHTLSFAllocator::GetUsedSize() const
+{
+	return UsedSize;
+}
+
+uint64_t UHTLSFAllocator::GetLargestFreeSize() const
+{
+	if (FLBitmap == 0)
+	{
+		return 0;
+	}
+
+	// the largest block is in the highest non-empty list
+	const uint32_t FL = static_cast<uint32_t>(MathHelpers::FindMostSignificantBit64(FLBitmap));
+	const uint32_t SL = static_cast<uint32_t>(MathHelpers::FindMostSignificantBit64(SLBitmaps[FL]));
+
+	uint64_t LargestSize = 0;
+	for (int32_t Idx = FreeHeads[FL * SLCount + SL]; Idx != UHINDEXNONE; Idx = Blocks[Idx].NextFree)
+	{
+		LargestSize = (std::max)(LargestSize, Blocks[Idx].Size);
+	}
+
+	return LargestSize;
+}
+
+uint64_t UHTLSFAllocator::GetAllocationSize(uint64_t InOffset) const
+{
+	const auto It = AllocatedBlocks.find(InOffset);
+	return (It != AllocatedBlocks.end()) ? Blocks[It->second].Size : 0;
+}
+
+uint32_t UHTLSFAllocator::GetAllocationCount() const
+{
+	return static_cast<uint32_t>(AllocatedBlocks.size());
+}
+
+uint32_t UHTLSFAllocator::GetFreeBlockCount() const
+{
+	return NumFreeBlocks;
+}
+
+bool UHTLSFAllocator::IsEmpty() const
+{
+	return AllocatedBlocks.empty();
+}
+
+void UHTLSFAllocator::GetListIndex(uint64_t InSize, uint32_t& OutFL, uint32_t& OutSL)
+{
+	if (InSize < (1ull << SmallBlockShift))
+	{
+		OutFL = 0;
+		OutSL = static_cast<uint32_t>(InSize >> (SmallBlockShift - SLBits));
+		return;
+	}
+
+	const uint32_t MSB = static_cast<uint32_t>(MathHelpers::FindMostSignificantBit64(InSize));
+	OutFL = MSB - SmallBlockShift + 1;
+	OutSL = static_cast<uint32_t>(InSize >> (MSB - SLBits)) & (SLCount - 1);
+}
+
+int32_t UHTLSFAllocator::FindFreeBlock(uint64_t InSize) const
+{
+	// round up to the next list, so any block in the list found is large enough
+	const uint64_t Step = (InSize < (1ull << SmallBlockShift))
+		? (1ull << (SmallBlockShift - SLBits))
+		: (1ull << (MathHelpers::FindMostSignificantBit64(InSize) - SLBits));
+
+	uint32_t FL;
+	uint32_t SL;
+	GetListIndex(InSize + Step - 1, FL, SL);
+	if (FL >= FLCount)
+	{
+		return UHINDEXNONE;
+	}
+
+	uint32_t SLMap = SLBitmaps[FL] & (~0u << SL);
+	if (SLMap == 0)
+	{
+		const uint64_t FLMap = (FL + 1 < 64) ? (FLBitmap & (~0ull << (FL + 1))) : 0;
+		if (FLMap == 0)
+		{
+			return UHINDEXNONE;
+		}
+
+		FL = static_cast<uint32_t>(MathHelpers::CountTrailingZeros64(FLMap));
+		SLMap = SLBitmaps[FL];
+	}
+
+	SL = static_cast<uint32_t>(MathHelpers::CountTrailingZeros(SLMap));
+	return FreeHeads[FL * SLCount + SL];
+}
+
+int32_t UHTLSFAllocator::NewBlock(uint64_t InOffset, uint64_t InSize)
+{
+	int32_t BlockIdx;
+	if (UnusedBlocks.size() > 0)
+	{
+		BlockIdx = UnusedBlocks.back();
+		UnusedBlocks.pop_back();
+	}
+	else
+	{
+		BlockIdx = static_cast<int32_t>(Blocks.size());
+		Blocks.emplace_back();
+	}
+
+	UHTLSFBlock& Block = Blocks[BlockIdx];
+	Block.Offset = InOffset;
+	Block.Size = InSize;
+	Block.Alignment = MinBlockSize;
+	Block.PrevPhysical = UHINDEXNONE;
+	Block.NextPhysical = UHINDEXNONE;
+	Block.PrevFree = UHINDEXNONE;
+	Block.NextFree = UHINDEXNONE;
+	Block.bIsFree = true;
+	Block.bIsMovable = true;
+
+	return BlockIdx;
+}
+
+void UHTLSFAllocator::RecycleBlock(int32_t InBlockIdx)
+{
+	UnusedBlocks.push_back(InBlockIdx);
+}
+
+void UHTLSFAllocator::InsertFreeBlock(int32_t InBlockIdx)
+{
+	uint32_t FL;
+	uint32_t SL;
+	GetListIndex(Blocks[InBlockIdx].Size, FL, SL);
+
+	const int32_t Head = FreeHeads[FL * SLCount + SL];
+	UHTLSFBlock& Block = Blocks[InBlockIdx];
+	Block.bIsFree = true;
+	Block.PrevFree = UHINDEXNONE;
+	Block.NextFree = Head;
+	if (Head != UHINDEXNONE)
+	{
+		Blocks[Head].PrevFree = InBlockIdx;
+	}
+
+	FreeHeads[FL * SLCount + SL] = InBlockIdx;
+	FLBitmap |= 1ull << FL;
+	SLBitmaps[FL] |= 1u << SL;
+	NumFreeBlocks++;
+}
+
+void UHTLSFAllocator::RemoveFreeBlock(int32_t InBlockIdx)
+{
+	uint32_t FL;
+	uint32_t SL;
+	GetListIndex(Blocks[InBlockIdx].Size, FL, SL);
+
+	const int32_t PrevIdx = Blocks[InBlockIdx].PrevFree;
+	const int32_t NextIdx = Blocks[InBlockIdx].NextFree;
+	if (PrevIdx != UHINDEXNONE)
+	{
+		Blocks[PrevIdx].NextFree = NextIdx;
+	}
+	else
+	{
+		FreeHeads[FL * SLCount + SL] = NextIdx;
+	}
+
+	if (NextIdx != UHINDEXNONE)
+	{
+		Blocks[NextIdx].PrevFree = PrevIdx;
+	}
+
+	// clear the bits once the list is empty
+	if (FreeHeads[FL * SLCount + SL] == UHINDEXNONE)
+	{
+		SLBitmaps[FL] &= ~(1u << SL);
+		if (SLBitmaps[FL] == 0)
+		{
+			FLBitmap &= ~(1ull << FL);
+		}
+	}
+
+	Blocks[InBlockIdx].PrevFree = UHINDEXNONE;
+	Blocks[InBlockIdx].NextFree = UHINDEXNONE;
+	NumFreeBlocks--;
+}
+
+int32_t UHTLSFAllocator::SplitBlock(int32_t InBlockIdx, uint64_t InSize)
+{
+	// the block must not be in a free list, the remaining part is returned and linked after it
+	const int32_t RemainIdx = NewBlock(Blocks[InBlockIdx].Offset + InSize, Blocks[InBlockIdx].Size - InSize);
+	const int32_t NextIdx = Blocks[InBlockIdx].NextPhysical;
+
+	Blocks[InBlockIdx].Size = InSize;
+	Blocks[InBlockIdx].NextPhysical = RemainIdx;
+	Blocks[RemainIdx].PrevPhysical = InBlockIdx;
+	Blocks[RemainIdx].NextPhysical = NextIdx;
+	if (NextIdx != UHINDEXNONE)
+	{
+		Blocks[NextIdx].PrevPhysical = RemainIdx;
+	}
+
+	return RemainIdx;
+}
+
+void UHTLSFAllocator::MergeWithNext(int32_t InBlockIdx)
+{
+	// both blocks must not be in a free list
+	const int32_t NextIdx = Blocks[InBlockIdx].NextPhysical;
+	const int32_t NextNextIdx = Blocks[NextIdx].NextPhysical;
+
+	Blocks[InBlockIdx].Size += Blocks[NextIdx].Size;
+	Blocks[InBlockIdx].NextPhysical = NextNextIdx;
+	if (NextNextIdx != UHINDEXNONE)
+	{
+		Blocks[NextNextIdx].PrevPhysical = InBlockIdx;
+	}
+
+	RecycleBlock(NextIdx);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// a move from defragmentation, the content at SrcOffset must be copied to DstOffset
+struct UHTLSFMove
+{
+	uint64_t SrcOffset;
+	uint64_t DstOffset;
+	uint64_t Size;
+};
+
+// two-level segregated fit allocator over a linear range, it only deals with offsets so it has nothing to do with Vulkan
+// free blocks are bucketed by the power of 2 of their size (first level) and 32 linear steps within it (second level),
+// a bitmap per level makes both allocation and free constant time, and the physical neighbors are coalesced on free.
+// offsets and sizes are in multiples of MinBlockSize
+class UHTLSFAllocator
+{
+public:
+	UHTLSFAllocator();
+	void Initialize(uint64_t InSize);
+	void Reset();
+
+	// returns InvalidOffset if there isn't a free block large enough, the alignment must be a power of 2
+	// an immovable allocation is never moved by defragmentation
+	uint64_t Allocate(uint64_t InSize, uint64_t InAlignment, bool bIsMovable = true);
+	bool Free(uint64_t InOffset);
+
+	// slides the movable allocations down to the free space before them, at most InMaxMoves allocations are moved
+	// moves are sorted by source offset and the destination is always lower, so copying them in order with memmove is safe
+	void Defragment(uint32_t InMaxMoves, std::vector<UHTLSFMove>& OutMoves);
+
+	// checks the physical links, free lists and bitmaps, it's for fuzz testing
+	bool Validate() const;
+
+	uint64_t GetSize() const;
+	uint64_t GetUsedSize() const;
+	uint64_t GetLargestFreeSize() const;
+	uint64_t GetAllocationSize(uint64_t InOffset) const;
+	uint32_t GetAllocationCount() const;
+	uint32_t GetFreeBlockCount() const;
+	bool IsEmpty() const;
+
+	static const uint64_t InvalidOffset = ~0ull;
+	static const uint64_t MinBlockSize = 16;
+
+private:
+	struct UHTLSFBlock
+	{
+		uint64_t Offset;
+		uint64_t Size;
+		uint64_t Alignment;
+		int32_t PrevPhysical;
+		int32_t NextPhysical;
+		int32_t PrevFree;
+		int32_t NextFree;
+		bool bIsFree;
+		bool bIsMovable;
+	};
+
+	// sizes below SmallBlockSize share the first level list 0 with a linear step
+	static const uint32_t SLBits = 5;
+	static const uint32_t SLCount = 1 << SLBits;
+	static const uint32_t SmallBlockShift = 8;
+	static const uint32_t FLCount = 64 - SmallBlockShift + 1;
+
+	static void GetListIndex(uint64_t InSize, uint32_t& OutFL, uint32_t& OutSL);
+	int32_t FindFreeBlock(uint64_t InSize) const;
+	int32_t NewBlock(uint64_t InOffset, uint64_t InSize);
+	void RecycleBlock(int32_t InBlockIdx);
+	void InsertFreeBlock(int32_t InBlockIdx);
+	void RemoveFreeBlock(int32_t InBlockIdx);
+	int32_t SplitBlock(int32_t InBlockIdx, uint64_t InSize);
+	void MergeWithNext(int32_t InBlockIdx);
+
+	std::vector<UHTLSFBlock> Blocks;
+	std::vector<int32_t> UnusedBlocks;
+	std::unordered_map<uint64_t, int32_t> AllocatedBlocks;
+
+	uint64_t FLBitmap;
+	uint32_t SLBitmaps[FLCount];
+	std::vector<int32_t> FreeHeads;
+	int32_t FirstBlock;
+
+	uint64_t TotalSize;
+	uint64_t UsedSize;
+	uint32_t NumFreeBlocks;
+};
\ No newline at end of file
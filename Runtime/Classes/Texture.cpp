@@ -21,7 +21,7 @@ UHTexture::UHTexture(std::string InName, VkExtent2D InExtent, UHTextureFormat In
 	, bHasUploadedToGPU(false)
 	, bIsMipMapGenerated(false)
 	, TextureSettings(InSettings)
-	, MemoryOffset(~0)
+	, SharedMemory(nullptr)
 	, MipMapCount(1)
 	, TextureType(UHTextureType::Texture2D)
 	, bCreatePerMipImageView(false)
@@ -55,17 +55,6 @@ void UHTexture::SetExtent(uint32_t Width, uint32_t Height)
 
 void UHTexture::Release()
 {
-	vkFreeMemory(LogicalDevice, ImageMemory, nullptr);
-	ImageMemory = nullptr;
-	vkDestroyImageView(LogicalDevice, ImageView, nullptr);
-	ImageView = nullptr;
-
-	for (size_t Idx = 0; Idx < ImageViewPerMip.size(); Idx++)
-	{
-		vkDestroyImageView(LogicalDevice, ImageViewPerMip[Idx], nullptr);
-	}
-	ImageViewPerMip.clear();
-
 #if WITH_EDITOR
 	for (int32_t Idx = 0; Idx < CubemapImageViewCount; Idx++)
 	{
@@ -77,16 +66,55 @@ void UHTexture::Release()
 	}
 #endif
 
-	// only destroy source if it's created by this
+	UHTextureGPUObjects Objects = DetachGPUObjects();
+	ReleaseGPUObjects(LogicalDevice, Objects);
+
+	bHasUploadedToGPU = false;
+	bIsMipMapGenerated = false;
+}
+
+UHTextureGPUObjects UHTexture::DetachGPUObjects()
+{
+	UHTextureGPUObjects Objects;
+	Objects.ImageMemory = ImageMemory;
+	ImageMemory = nullptr;
+	Objects.ImageView = ImageView;
+	ImageView = nullptr;
+	Objects.ImageViewPerMip = std::move(ImageViewPerMip);
+	ImageViewPerMip.clear();
+
+	// only detach source if it's created by this
 	// image like swap chain can't be destroyed here
 	if (bIsSourceCreatedByThis)
 	{
-		vkDestroyImage(LogicalDevice, ImageSource, nullptr);
+		Objects.Image = ImageSource;
 		ImageSource = nullptr;
+		Objects.SharedMemory = SharedMemory;
+		Objects.SharedAllocation = SharedAllocation;
+		SharedMemory = nullptr;
+		SharedAllocation = UHGPUMemoryAllocation();
 	}
 
-	bHasUploadedToGPU = false;
-	bIsMipMapGenerated = false;
+	return Objects;
+}
+
+void UHTexture::ReleaseGPUObjects(VkDevice InDevice, UHTextureGPUObjects& InObjects)
+{
+	vkFreeMemory(InDevice, InObjects.ImageMemory, nullptr);
+	vkDestroyImageView(InDevice, InObjects.ImageView, nullptr);
+	for (size_t Idx = 0; Idx < InObjects.ImageViewPerMip.size(); Idx++)
+	{
+		vkDestroyImageView(InDevice, InObjects.ImageViewPerMip[Idx], nullptr);
+	}
+	vkDestroyImage(InDevice, InObjects.Image, nullptr);
+
+	// give the range back to shared memory
+	if (InObjects.SharedMemory != nullptr)
+	{
+		InObjects.SharedMemory->FreeMemory(InObjects.SharedAllocation);
+	}
+
+	InObjects = UHTextureGPUObjects();
 }
 
 void UHTexture::SetImage(VkImage InImage)
@@ -181,9 +209,13 @@ bool UHTexture::Create(UHTextureInfo InInfo, UHGPUMemory* InSharedMemory)
 		bool bExceedSharedMemory = false;
 		if (InSharedMemory)
 		{
-			// cache the memory offset in shared memory, when it's re-creating, bind to the same offset
-			MemoryOffset = InSharedMemory->BindMemory(MemRequirements.size, MemRequirements.alignment, ImageSource, InInfo.ReboundOffset);
-			if (MemoryOffset == ~0)
+			// keep the allocation in shared memory, it's freed when this texture is released
+			SharedAllocation = InSharedMemory->BindMemory(MemRequirements, ImageSource);
+			if (SharedAllocation.IsValid())
+			{
+				SharedMemory = InSharedMemory;
+			}
+			else
 			{
 				bExceedSharedMemory = true;
 				//UHE_LOG(L"Exceed shared image memory budget, will allocate individually instead.\n");
@@ -433,4 +465,17 @@ bool UHTexture::operator==(const UHTexture& InTexture)
 		&& InTexture.ImageExtent.height == ImageExtent.height
 		&& TextureSettings.bIsLinear == InTexture.TextureSettings.bIsLinear
 		&& TextureSettings.bIsNormal == InTexture.TextureSettings.bIsNormal;
+}
+
+size_t UHTexture::GetHash() const
+{
+	size_t Hash = 0;
+	UHUtilities::HashCombine(Hash, Name);
+	UHUtilities::HashCombine(Hash, ImageFormat);
+	UHUtilities::HashCombine(Hash, ImageExtent.width);
+	UHUtilities::HashCombine(Hash, ImageExtent.height);
+	UHUtilities::HashCombine(Hash, TextureSettings.bIsLinear);
+	UHUtilities::HashCombine(Hash, TextureSettings.bIsNormal);
+
+	return Hash;
 }
\ No newline at end of file
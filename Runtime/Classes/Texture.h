@@ -9,6 +9,7 @@
 enum class UHTextureVersion
 {
 	InitialTexture = 0,
+	MipChunks,
 	TextureVersionMax
 };
 
@@ -25,7 +26,8 @@ enum class UHTextureCompressionSettings
 	BC3,
 	BC4,
 	BC5,
-	BC6H
+	BC6H,
+	BC7
 };
 
 struct UHTextureInfo
@@ -44,7 +46,6 @@ struct UHTextureInfo
 		, Usage(InUsage)
 		, bIsRT(bInIsRT)
 		, bIsShadowRT(false)
-		, ReboundOffset(~0)
 	{
 
 	}
@@ -56,7 +57,6 @@ struct UHTextureInfo
 	VkImageUsageFlags Usage;
 	bool bIsRT;
 	bool bIsShadowRT;
-	uint64_t ReboundOffset;
 };
 
 struct UHTextureSettings
@@ -82,6 +82,26 @@ struct UHTextureSettings
 class UHGraphic;
 class UHRenderBuilder;
 
+// GPU objects detached from a texture, they can be released later once GPU isn't using them
+struct UHTextureGPUObjects
+{
+	UHTextureGPUObjects()
+		: Image(nullptr)
+		, ImageView(nullptr)
+		, ImageMemory(nullptr)
+		, SharedMemory(nullptr)
+	{
+
+	}
+
+	VkImage Image;
+	VkImageView ImageView;
+	std::vector<VkImageView> ImageViewPerMip;
+	VkDeviceMemory ImageMemory;
+	UHGPUMemory* SharedMemory;
+	UHGPUMemoryAllocation SharedAllocation;
+};
+
 // base texture class for textures. Texture2D, RenderTexture can inherit this
 class UHTexture : public UHRenderResource
 {
@@ -92,6 +112,10 @@ public:
 	// release
 	virtual void Release();
 
+	// take the image, views and memory out of this texture, so it can be recreated while GPU still uses the old ones
+	UHTextureGPUObjects DetachGPUObjects();
+	static void ReleaseGPUObjects(VkDevice InDevice, UHTextureGPUObjects& InObjects);
+
 	virtual void UploadToGPU(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder) {}
 	virtual void GenerateMipMaps(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder) {}
 
@@ -148,6 +172,9 @@ public:
 
 	bool operator==(const UHTexture& InTexture);
 
+	// hash of the members compared in operator==
+	size_t GetHash() const;
+
 protected:
 	bool Create(UHTextureInfo InInfo, UHGPUMemory* InSharedMemory);
 	std::string SourcePath;
@@ -162,7 +189,8 @@ protected:
 	bool bIsMipMapGenerated;
 	bool bCreatePerMipImageView;
 	UHTextureSettings TextureSettings;
-	uint64_t MemoryOffset;
+	UHGPUMemory* SharedMemory;
+	UHGPUMemoryAllocation SharedAllocation;
 	UHTextureType TextureType;
 	uint32_t MipMapCount;
 
@@ -1,10 +1,14 @@
 #include "Texture2D.h"
 #include "../../UnheardEngine.h"
+#include "../CoreGlobals.h"
 #include "../Classes/Utility.h"
 #include "AssetPath.h"
 #include "../Engine/Graphic.h"
 #include "../Renderer/RenderBuilder.h"
 #include "TextureCompressor.h"
+#include "MipGenerator.h"
+#include "Material.h"
+#include <chrono>
 
 UHTexture2D::UHTexture2D()
 	: UHTexture2D("", "", VkExtent2D(), UHTextureFormat::UH_FORMAT_RGBA8_SRGB, UHTextureSettings())
@@ -15,6 +19,8 @@ UHTexture2D::UHTexture2D()
 UHTexture2D::UHTexture2D(std::string InName, std::string InSourcePath, VkExtent2D InExtent, UHTextureFormat InFormat, UHTextureSettings InSettings)
 	: UHTexture(InName, InExtent, InFormat, InSettings)
 	, bSharedMemory(true)
+	, MipDataOffset(0)
+	, ResidentMip(0)
 {
 	SourcePath = InSourcePath;
 	TextureType = UHTextureType::Texture2D;
@@ -40,6 +46,13 @@ void UHTexture2D::ReleaseCPUTextureData()
 	RawStageBuffers.clear();
 }
 
+std::vector<UHRenderBuffer<uint8_t>> UHTexture2D::DetachStageBuffers()
+{
+	std::vector<UHRenderBuffer<uint8_t>> StageBuffers = std::move(RawStageBuffers);
+	RawStageBuffers.clear();
+	return StageBuffers;
+}
+
 bool UHTexture2D::Import(std::filesystem::path InTexturePath)
 {
 	if (InTexturePath.extension() != GTextureAssetExtension)
@@ -65,48 +78,139 @@ bool UHTexture2D::Import(std::filesystem::path InTexturePath)
 	FileIn.read(reinterpret_cast<char*>(&ImageExtent.width), sizeof(ImageExtent.width));
 	FileIn.read(reinterpret_cast<char*>(&ImageExtent.height), sizeof(ImageExtent.height));
 
-	// read texture data
+	if (Version >= UH_ENUM_VALUE(UHTextureVersion::MipChunks))
+	{
+		// read texture settings and the mip chunk table, the mip data starts after the table
+		FileIn.read(reinterpret_cast<char*>(&TextureSettings), sizeof(TextureSettings));
+		UHUtilities::ReadVectorData(FileIn, MipDataSizes);
+		MipDataOffset = static_cast<uint64_t>(FileIn.tellg());
+		FileIn.close();
+
+		// a streamed texture only loads its mip tail here, the texture streamer reads the other mips on demand
+		ImportedPath = InTexturePath;
+		ResidentMip = IsStreamed() ? GetMipTailIndex() : 0;
+		return ReadMipChunks(ResidentMip, TextureData);
+	}
+
+	// legacy format, the texture data is a single vector and can't be streamed
 	UHUtilities::ReadVectorData(FileIn, TextureData);
 
 	// read texture settings
 	FileIn.read(reinterpret_cast<char*>(&TextureSettings), sizeof(TextureSettings));
+	MipDataSizes.clear();
+	ResidentMip = 0;
 
 	FileIn.close();
 
 	return true;
 }
 
+bool UHTexture2D::ReadMipChunks(uint32_t InFirstMip, std::vector<uint8_t>& OutData) const
+{
+	if (InFirstMip >= MipDataSizes.size())
+	{
+		return false;
+	}
+
+	// mips are stored from the largest to the smallest, so the requested range is a single contiguous read
+	uint64_t ReadOffset = MipDataOffset;
+	uint64_t ReadSize = 0;
+	for (uint32_t MipIdx = 0; MipIdx < static_cast<uint32_t>(MipDataSizes.size()); MipIdx++)
+	{
+		if (MipIdx < InFirstMip)
+		{
+			ReadOffset += MipDataSizes[MipIdx];
+		}
+		else
+		{
+			ReadSize += MipDataSizes[MipIdx];
+		}
+	}
+
+	std::ifstream FileIn(ImportedPath.string().c_str(), std::ios::in | std::ios::binary);
+	if (!FileIn.is_open())
+	{
+		UHE_LOG(L"Failed to read mips of UHTexture " + ImportedPath.wstring() + L"!\n");
+		return false;
+	}
+
+	OutData.resize(ReadSize);
+	FileIn.seekg(ReadOffset);
+	FileIn.read(reinterpret_cast<char*>(OutData.data()), ReadSize);
+	const bool bSucceed = static_cast<uint64_t>(FileIn.gcount()) == ReadSize;
+	FileIn.close();
+
+	return bSucceed;
+}
+
 #if WITH_EDITOR
-void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData)
+// mip generation settings of this texture, the alpha coverage follows the cutoff of the masked materials referencing it
+UHMipGenerationSettings UHTexture2D::GetMipGenerationSettings() const
 {
-	GfxCache->WaitGPU();
-	for (UHRenderBuffer<uint8_t>& Buffer : RawStageBuffers)
+	UHMipGenerationSettings Settings;
+	Settings.bIsHDR = TextureSettings.bIsHDR;
+	Settings.bIsSRGB = !TextureSettings.bIsLinear;
+	Settings.bIsNormal = TextureSettings.bIsNormal;
+
+	for (UHObject* Obj : GetReferenceObjects())
 	{
-		Buffer.Release();
+		const UHMaterial* Mat = CastObject<UHMaterial>(Obj);
+		if (Mat != nullptr && Mat->GetBlendMode() == UHBlendMode::Masked)
+		{
+			Settings.AlphaCutoff = Mat->GetCutoffValue();
+			break;
+		}
 	}
-	Release();
 
+	return Settings;
+}
+
+void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData)
+{
 	// recreation workflow
-	// 1. Upload uncompressed data and generate mipmaps
-	// 2. Readback texture data for storage
-	// 3. Compress if requested
+	// 1. Build texture data on CPU, which generates mipmaps and compresses if requested
+	// 2. Create the texture and upload, this is skipped without a graphic device so textures can be cooked headless
+	if (GfxCache != nullptr)
+	{
+		GfxCache->WaitGPU();
+		for (UHRenderBuffer<uint8_t>& Buffer : RawStageBuffers)
+		{
+			Buffer.Release();
+		}
+		Release();
+	}
+
+	BuildTextureData(bNeedGeneratMipmap, RawData);
+
+	// all mips are in the texture data already
+	bIsMipMapGenerated = true;
+	if (GfxCache != nullptr)
+	{
+		CreateTexture(bSharedMemory);
+
+		VkCommandBuffer UploadCmd = GfxCache->BeginOneTimeCmd();
+		UHRenderBuilder UploadBuilder(GfxCache, UploadCmd);
+		UploadToGPU(GfxCache, UploadBuilder);
+		GfxCache->EndOneTimeCmd(UploadCmd);
+	}
+}
+
+void UHTexture2D::BuildTextureData(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData, UHTextureBuildStats* OutStats)
+{
 	TextureSettings.bIsCompressed = false;
 	ImageFormat = UHTextureFormat::UH_FORMAT_NONE;
-	CreateTexture(bSharedMemory);
-
-	// upload the 1st slice and generate mip map
-	TextureData = RawData;
-	VkCommandBuffer UploadCmd = GfxCache->BeginOneTimeCmd();
-	UHRenderBuilder UploadBuilder(GfxCache, UploadCmd);
-	UploadToGPU(GfxCache, UploadBuilder);
-	if (bNeedGeneratMipmap)
+
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	const uint32_t MipCount = TextureSettings.bUseMipmap ? UHMipGenerator::GetMipCount(ImageExtent.width, ImageExtent.height) : 1;
+	TextureData = (bNeedGeneratMipmap && MipCount > 1)
+		? UHMipGenerator::GenerateMipChain(ImageExtent.width, ImageExtent.height, MipCount, RawData, GetMipGenerationSettings())
+		: RawData;
+
+	if (OutStats != nullptr)
 	{
-		GenerateMipMaps(GfxCache, UploadBuilder);
+		OutStats->MipSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+		StartTime = std::chrono::steady_clock::now();
 	}
-	GfxCache->EndOneTimeCmd(UploadCmd);
-
-	// readback CPU data for storage, this includes the mip map data
-	TextureData = ReadbackTextureData();
 
 	// since the mip map generation can't be done in block compression, always process compression after raw data is done
 	const int32_t RawByteSize = (TextureSettings.bIsHDR) ? GTextureFormatData[UH_ENUM_VALUE(UHTextureFormat::UH_FORMAT_RGBA16F)].ByteSize 
@@ -118,7 +222,7 @@ void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>&
 		uint64_t MipStartIndex = 0;
 		uint64_t MipEndIndex = ImageExtent.width * ImageExtent.height * RawByteSize;
 
-		for (uint32_t Idx = 0; Idx < GetMipMapCount(); Idx++)
+		for (uint32_t Idx = 0; Idx < MipCount; Idx++)
 		{
 			std::vector<uint8_t> MipData(TextureData.begin() + MipStartIndex, TextureData.begin() + MipEndIndex);
 			std::vector<uint64_t> CompressedMipData;
@@ -145,6 +249,10 @@ void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>&
 				CompressedMipData = UHTextureCompressor::CompressBC6H(ImageExtent.width >> Idx, ImageExtent.height >> Idx, MipData, GfxCache);
 				break;
 
+			case UHTextureCompressionSettings::BC7:
+				CompressedMipData = UHTextureCompressor::CompressBC7(ImageExtent.width >> Idx, ImageExtent.height >> Idx, MipData, GfxCache);
+				break;
+
 			default:
 				break;
 			}
@@ -161,25 +269,11 @@ void UHTexture2D::Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>&
 		TextureData.resize(OutputSize);
 		memcpy_s(TextureData.data(), OutputSize, CompressedData.data(), OutputSize);
 		TextureSettings.bIsCompressed = true;
-
-		// repeat the texture creation for compressed texture
-		for (UHRenderBuffer<uint8_t>& Buffer : RawStageBuffers)
-		{
-			Buffer.Release();
-		}
-		Release();
-		CreateTexture(bSharedMemory);
-
-		// upload compressed data
-		VkCommandBuffer UploadCmd = GfxCache->BeginOneTimeCmd();
-		UHRenderBuilder UploadBuilder(GfxCache, UploadCmd);
-		UploadToGPU(GfxCache, UploadBuilder);
-		GfxCache->EndOneTimeCmd(UploadCmd);
 	}
 
-	if (!bNeedGeneratMipmap)
+	if (OutStats != nullptr)
 	{
-		bIsMipMapGenerated = true;
+		OutStats->CompressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
 	}
 }
 
@@ -249,19 +343,22 @@ void UHTexture2D::Export(std::filesystem::path InTexturePath)
 	FileOut.write(reinterpret_cast<const char*>(&ImageExtent.width), sizeof(ImageExtent.width));
 	FileOut.write(reinterpret_cast<const char*>(&ImageExtent.height), sizeof(ImageExtent.height));
 
-	// write texture data
-	UHUtilities::WriteVectorData(FileOut, TextureData);
-
 	// write texture settings
 	FileOut.write(reinterpret_cast<char*>(&TextureSettings), sizeof(TextureSettings));
 
+	// write texture data as mip chunks, the size table goes first so any mip range can be read without the others
+	MipDataSizes = CalculateMipDataSizes();
+	UHUtilities::WriteVectorData(FileOut, MipDataSizes);
+	FileOut.write(reinterpret_cast<const char*>(TextureData.data()), TextureData.size());
+
 	FileOut.close();
 }
 #endif
 
 void UHTexture2D::SetTextureData(std::vector<uint8_t> InData)
 {
-	TextureData = InData;
+	// move so that setting an empty array frees the old data
+	TextureData = std::move(InData);
 }
 
 const std::vector<uint8_t>& UHTexture2D::GetTextureData() const
@@ -276,14 +373,15 @@ void UHTexture2D::UploadToGPU(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder
 		return;
 	}
 
-	// copy data to staging buffer first
+	// copy data to staging buffer first, a streamed texture only has the data from its resident mip
 	RawStageBuffers.resize(GetMipMapCount());
 	const UHTextureFormatData TextureFormatData = GTextureFormatData[UH_ENUM_VALUE(ImageFormat)];
+	const VkExtent2D ResidentExtent = GetResidentExtent();
 	uint64_t MipStartIndex = 0;
 
 	for (uint32_t MipIdx = 0; MipIdx < GetMipMapCount(); MipIdx++)
 	{
-		uint64_t MipSize = (ImageExtent.width >> MipIdx) * (ImageExtent.height >> MipIdx) * TextureFormatData.ByteSize / TextureFormatData.BlockSize;
+		uint64_t MipSize = (ResidentExtent.width >> MipIdx) * (ResidentExtent.height >> MipIdx) * TextureFormatData.ByteSize / TextureFormatData.BlockSize;
 		if (TextureSettings.bIsCompressed)
 		{
 			MipSize = std::max(MipSize, static_cast<uint64_t>(TextureFormatData.ByteSize));
@@ -308,7 +406,7 @@ void UHTexture2D::UploadToGPU(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder
 		// copy buffer to image
 		VkBuffer SrcBuffer = RawStageBuffers[Mdx].GetBuffer();
 		VkImage DstImage = GetImage();
-		VkExtent2D Extent = GetExtent();
+		VkExtent2D Extent = ResidentExtent;
 
 		if (SrcBuffer == nullptr)
 		{
@@ -391,42 +489,50 @@ void UHTexture2D::GenerateMipMaps(UHGraphic* InGfx, UHRenderBuilder& InRenderBui
 
 bool UHTexture2D::CreateTexture(bool bFromSharedMemory)
 {
-	// texture also needs SRC/DST bits for copying/blit operation
-	UHTextureInfo Info(VK_IMAGE_TYPE_2D
-		, VK_IMAGE_VIEW_TYPE_2D, ImageFormat, ImageExtent
-		, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false);
-	Info.ReboundOffset = MemoryOffset;
 	bSharedMemory = bFromSharedMemory;
+	const VkExtent2D FullExtent = ImageExtent;
 
 	if (ImageFormat == UHTextureFormat::UH_FORMAT_NONE)
 	{
 		ImageFormat = (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_RGBA8_UNORM : UHTextureFormat::UH_FORMAT_RGBA8_SRGB;
-		Info.Format = ImageFormat;
 	}
 
+	// texture also needs SRC/DST bits for copying/blit operation
+	UHTextureInfo Info(VK_IMAGE_TYPE_2D
+		, VK_IMAGE_VIEW_TYPE_2D, GetTextureDataFormat(), GetResidentExtent()
+		, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false);
+
+	const bool bSucceed = Create(Info, (bSharedMemory) ? GfxCache->GetImageSharedMemory() : nullptr);
+
+	// the image starts from the resident mip, but the extent of this texture always describes mip 0
+	ImageExtent = FullExtent;
+	return bSucceed;
+}
+
+// format of the texture data, which is also the image format
+UHTextureFormat UHTexture2D::GetTextureDataFormat() const
+{
 	if (TextureSettings.bIsCompressed)
 	{
 		switch (TextureSettings.CompressionSetting)
 		{
 		case UHTextureCompressionSettings::BC1:
-			Info.Format = (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_BC1_UNORM : UHTextureFormat::UH_FORMAT_BC1_SRGB;
-			break;
+			return (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_BC1_UNORM : UHTextureFormat::UH_FORMAT_BC1_SRGB;
 
 		case UHTextureCompressionSettings::BC3:
-			Info.Format = (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_BC3_UNORM : UHTextureFormat::UH_FORMAT_BC3_SRGB;
-			break;
+			return (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_BC3_UNORM : UHTextureFormat::UH_FORMAT_BC3_SRGB;
 
 		case UHTextureCompressionSettings::BC4:
-			Info.Format = UHTextureFormat::UH_FORMAT_BC4;
-			break;
+			return UHTextureFormat::UH_FORMAT_BC4;
 
 		case UHTextureCompressionSettings::BC5:
-			Info.Format = UHTextureFormat::UH_FORMAT_BC5;
-			break;
+			return UHTextureFormat::UH_FORMAT_BC5;
 
 		case UHTextureCompressionSettings::BC6H:
-			Info.Format = UHTextureFormat::UH_FORMAT_BC6H;
-			break;
+			return UHTextureFormat::UH_FORMAT_BC6H;
+
+		case UHTextureCompressionSettings::BC7:
+			return (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_BC7_UNORM : UHTextureFormat::UH_FORMAT_BC7_SRGB;
 
 		default:
 			break;
@@ -434,8 +540,103 @@ bool UHTexture2D::CreateTexture(bool bFromSharedMemory)
 	}
 	else if (TextureSettings.bIsHDR)
 	{
-		Info.Format = UHTextureFormat::UH_FORMAT_RGBA16F;
+		return UHTextureFormat::UH_FORMAT_RGBA16F;
 	}
 
-	return Create(Info, (bFromSharedMemory) ? GfxCache->GetImageSharedMemory() : nullptr);
+	if (ImageFormat == UHTextureFormat::UH_FORMAT_NONE)
+	{
+		return (TextureSettings.bIsLinear) ? UHTextureFormat::UH_FORMAT_RGBA8_UNORM : UHTextureFormat::UH_FORMAT_RGBA8_SRGB;
+	}
+
+	return ImageFormat;
+}
+
+// same rule as UHTexture::Create
+uint32_t UHTexture2D::GetFullMipCount() const
+{
+	return TextureSettings.bUseMipmap ? static_cast<uint32_t>(std::floor(std::log2((std::min)(ImageExtent.width, ImageExtent.height)))) + 1 : 1;
+}
+
+// split the texture data into mips with the same rule as uploading, the data might not contain all mips
+std::vector<uint64_t> UHTexture2D::CalculateMipDataSizes() const
+{
+	const UHTextureFormatData FormatData = GTextureFormatData[UH_ENUM_VALUE(GetTextureDataFormat())];
+	const uint32_t MipCount = GetFullMipCount();
+	std::vector<uint64_t> Sizes;
+	uint64_t MipStartIndex = 0;
+
+	for (uint32_t MipIdx = 0; MipIdx < MipCount && MipStartIndex < TextureData.size(); MipIdx++)
+	{
+		uint64_t MipSize = static_cast<uint64_t>(ImageExtent.width >> MipIdx) * (ImageExtent.height >> MipIdx) * FormatData.ByteSize / FormatData.BlockSize;
+		if (TextureSettings.bIsCompressed)
+		{
+			MipSize = std::max(MipSize, static_cast<uint64_t>(FormatData.ByteSize));
+		}
+
+		MipSize = std::min(MipSize, TextureData.size() - MipStartIndex);
+		Sizes.push_back(MipSize);
+		MipStartIndex += MipSize;
+	}
+
+	return Sizes;
+}
+
+bool UHTexture2D::IsStreamable() const
+{
+	// all mips must be in the file, and the texture must be larger than the mip tail
+	return MipDataSizes.size() > 1 && MipDataSizes.size() == GetFullMipCount() && GetMipTailIndex() > 0;
+}
+
+bool UHTexture2D::IsStreamed() const
+{
+	return GEnableTextureStreaming && IsStreamable();
+}
+
+uint32_t UHTexture2D::GetResidentMip() const
+{
+	return ResidentMip;
+}
+
+VkExtent2D UHTexture2D::GetResidentExtent() const
+{
+	VkExtent2D Extent;
+	Extent.width = (std::max)(ImageExtent.width >> ResidentMip, 1u);
+	Extent.height = (std::max)(ImageExtent.height >> ResidentMip, 1u);
+	return Extent;
+}
+
+uint32_t UHTexture2D::GetMipTailIndex() const
+{
+	return GetMipTailIndex(ImageExtent.width, ImageExtent.height, GetFullMipCount());
+}
+
+const std::vector<uint64_t>& UHTexture2D::GetMipDataSizes() const
+{
+	return MipDataSizes;
+}
+
+uint32_t UHTexture2D::GetMipTailIndex(uint32_t Width, uint32_t Height, uint32_t MipCount)
+{
+	uint32_t MipIdx = 0;
+	while (MipIdx + 1 < MipCount && (std::max)(Width >> MipIdx, Height >> MipIdx) > StreamingMipTailSize)
+	{
+		MipIdx++;
+	}
+
+	return MipIdx;
+}
+
+UHTextureGPUObjects UHTexture2D::ApplyStreamedMips(uint32_t InFirstMip, std::vector<uint8_t> InData)
+{
+	// only detach the GPU resources, the CPU data is replaced with the streamed mips
+	UHTextureGPUObjects OldObjects = DetachGPUObjects();
+	bHasUploadedToGPU = false;
+
+	ResidentMip = InFirstMip;
+	TextureData = std::move(InData);
+	CreateTexture(true);
+
+	// streamed data always contains the mips
+	bIsMipMapGenerated = true;
+	return OldObjects;
 }
\ No newline at end of file
@@ -4,10 +4,27 @@
 #include <vector>
 #include <filesystem>
 #include "RenderBuffer.h"
+#include "MipGenerator.h"
 
 class UHGraphic;
 class UHRenderBuilder;
 
+#if WITH_EDITOR
+// time spent in each step of UHTexture2D::BuildTextureData
+struct UHTextureBuildStats
+{
+	UHTextureBuildStats()
+		: MipSeconds(0.0)
+		, CompressSeconds(0.0)
+	{
+
+	}
+
+	double MipSeconds;
+	double CompressSeconds;
+};
+#endif
+
 class UHTexture2D : public UHTexture
 {
 public:
@@ -16,11 +33,17 @@ public:
 	virtual void Release() override;
 
 	void ReleaseCPUTextureData();
+
+	// take the staging buffers of the last upload, they're released by the caller after GPU finishes the copy
+	std::vector<UHRenderBuffer<uint8_t>> DetachStageBuffers();
 	bool Import(std::filesystem::path InTexturePath);
 	void SetTextureData(std::vector<uint8_t> InData);
 
 #if WITH_EDITOR
 	void Recreate(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData);
+
+	// build the stored texture data from raw data on CPU: mip generation and compression, no GPU resource is touched
+	void BuildTextureData(bool bNeedGeneratMipmap, const std::vector<uint8_t>& RawData, UHTextureBuildStats* OutStats = nullptr);
 	virtual std::vector<uint8_t> ReadbackTextureData() override;
 	void Export(std::filesystem::path InTexturePath);
 #endif
@@ -32,12 +55,44 @@ public:
 	// generate mip maps
 	virtual void GenerateMipMaps(UHGraphic* InGfx, UHRenderBuilder& InRenderBuilder) override;
 
+	// texture streaming, the mips of a .uhtexture are stored as separate chunks so a mip range can be read alone
+	// a streamed texture keeps mips from the resident mip to the last one on GPU, GetExtent() still returns the size of mip 0
+	bool IsStreamable() const;
+	bool IsStreamed() const;
+	uint32_t GetResidentMip() const;
+	VkExtent2D GetResidentExtent() const;
+	uint32_t GetMipTailIndex() const;
+	const std::vector<uint64_t>& GetMipDataSizes() const;
+
+	// read mips from InFirstMip to the last one from the imported file, it can be called from any thread
+	bool ReadMipChunks(uint32_t InFirstMip, std::vector<uint8_t>& OutData) const;
+
+	// recreate the image with mips from InFirstMip in shared memory, the upload is recorded later with UploadToGPU()
+	// the old GPU objects could be still in use by the frames in flight, they're returned for the caller to release later
+	UHTextureGPUObjects ApplyStreamedMips(uint32_t InFirstMip, std::vector<uint8_t> InData);
+
+	// the first mip whose larger side fits the tail size, mips from here are always resident
+	static uint32_t GetMipTailIndex(uint32_t Width, uint32_t Height, uint32_t MipCount);
+	static const uint32_t StreamingMipTailSize = 128;
+
 private:
 	bool CreateTexture(bool bFromSharedMemory);
+	UHTextureFormat GetTextureDataFormat() const;
+	uint32_t GetFullMipCount() const;
+	std::vector<uint64_t> CalculateMipDataSizes() const;
+#if WITH_EDITOR
+	UHMipGenerationSettings GetMipGenerationSettings() const;
+#endif
 
 	std::vector<uint8_t> TextureData;
 	std::vector<UHRenderBuffer<uint8_t>> RawStageBuffers;
 	bool bSharedMemory;
 
+	// mip chunk layout of the imported file, empty for the textures imported from the legacy format
+	std::filesystem::path ImportedPath;
+	std::vector<uint64_t> MipDataSizes;
+	uint64_t MipDataOffset;
+	uint32_t ResidentMip;
+
 	friend UHGraphic;
 };
\ No newline at end of file
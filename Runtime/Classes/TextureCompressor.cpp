@@ -12,7 +12,7 @@
 // compress raw texture data to block compression, implementation follows the Microsoft document
 // https://learn.microsoft.com/en-us/windows/win32/direct3d10/d3d10-graphics-programming-guide-resources-block-compression
 // input is assumed as RGBA8888 for non-HDR, and RGBAHalf for HDR
-// implementation is done on the compute shader
+// implementation is done on the compute shader, or on CPU when there is no graphic interface (see TextureCompressorCPU.cpp)
 namespace UHTextureCompressor
 {
 	struct UHCompressionConstant
@@ -133,6 +133,11 @@ namespace UHTextureCompressor
 
 	std::vector<uint64_t> CompressBC1(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx)
 	{
+		if (InGfx == nullptr)
+		{
+			return CompressBC1CPU(Width, Height, Input);
+		}
+
 		// store color as float
 		std::vector<UHColorRGB> RGB888(Width * Height);
 		const size_t RawColorStride = 4;
@@ -150,6 +155,11 @@ namespace UHTextureCompressor
 
 	std::vector<uint64_t> CompressBC3(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx)
 	{
+		if (InGfx == nullptr)
+		{
+			return CompressBC3CPU(Width, Height, Input);
+		}
+
 		// 16 bytes per 4x4 block, BC3 compression, alpha channel will be preserved
 		const uint32_t OutputSize = std::max(Width * Height / 16, (uint32_t)1);
 		std::vector<uint64_t> Output(OutputSize * 2);
@@ -183,6 +193,11 @@ namespace UHTextureCompressor
 
 	std::vector<uint64_t> CompressBC4(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx)
 	{
+		if (InGfx == nullptr)
+		{
+			return CompressBC4CPU(Width, Height, Input);
+		}
+
 		// 8 bytes per 4x4 block, BC4 compression, stores red channel only
 		std::vector<uint32_t> Red8(Width * Height);
 		const size_t RawColorStride = 4;
@@ -198,6 +213,11 @@ namespace UHTextureCompressor
 
 	std::vector<uint64_t> CompressBC5(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx)
 	{
+		if (InGfx == nullptr)
+		{
+			return CompressBC5CPU(Width, Height, Input);
+		}
+
 		// 16 bytes per 4x4 block, BC5 compression, stores red/green channel only
 		const uint32_t OutputSize = std::max(Width * Height / 16, (uint32_t)1);
 		std::vector<uint64_t> Output(OutputSize * 2);
@@ -276,6 +296,11 @@ namespace UHTextureCompressor
 
 	std::vector<uint64_t> CompressBC6H(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx)
 	{
+		if (InGfx == nullptr)
+		{
+			return CompressBC6HCPU(Width, Height, Input);
+		}
+
 		// collect RGB info
 		std::vector<UHColorRGBInt> RGBInt(Width * Height);
 
@@ -295,5 +320,11 @@ namespace UHTextureCompressor
 		BlockCompressionHDRGPU(Width, Height, RGBInt, InGfx, Output);
 		return Output;
 	}
+
+	std::vector<uint64_t> CompressBC7(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx)
+	{
+		// there is no BC7 compute shader, always compress on CPU
+		return CompressBC7CPU(Width, Height, Input);
+	}
 }
 #endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #if WITH_EDITOR
 #include "../Engine/Graphic.h"
 
+class UHJobSystem;
+
 namespace UHTextureCompressor
 {
 	// helper structure for readability, can be move somewhere else if they're useful
@@ -53,11 +55,44 @@ namespace UHTextureCompressor
 		uint64_t HighBits;
 	};
 
-	// compression
+	// SIMD level used by the CPU encoders, detected once at runtime
+	enum class UHCompressorSIMDLevel
+	{
+		Scalar,
+		SSE,
+		AVX
+	};
+
+	// compression, the CPU encoder is used when InGfx is nullptr, so textures can be cooked without a GPU
+	// BC7 is CPU only and the InGfx is ignored
 	std::vector<uint64_t> CompressBC1(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx);
 	std::vector<uint64_t> CompressBC3(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx);
 	std::vector<uint64_t> CompressBC4(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx);
 	std::vector<uint64_t> CompressBC5(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx);
 	std::vector<uint64_t> CompressBC6H(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx);
+	std::vector<uint64_t> CompressBC7(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, UHGraphic* InGfx);
+
+	// CPU encoders, implemented in TextureCompressorCPU.cpp
+	// rows of blocks are split across the job system, partial blocks of the edge replicate the last texel
+	UHCompressorSIMDLevel GetCompressorSIMDLevel();
+	void SetCompressorSIMDLevel(UHCompressorSIMDLevel InLevel);
+	std::vector<uint64_t> CompressBC1CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input);
+	std::vector<uint64_t> CompressBC3CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input);
+	std::vector<uint64_t> CompressBC4CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input);
+	std::vector<uint64_t> CompressBC5CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input);
+	std::vector<uint64_t> CompressBC6HCPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input);
+	std::vector<uint64_t> CompressBC7CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input);
+
+	// worker threads shared by the CPU texture processing, the mip generator uses it as well
+	UHJobSystem& GetTextureJobSystem();
+
+	// decompression for validation, the output layout is the same as the encoder input (RGBA8, or RGBAHalf for BC6H)
+	// BC6H supports the single region modes 11~14, BC7 supports mode 6, blocks of other modes are decoded as zero and counted as failures
+	std::vector<uint8_t> DecompressBC1(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input);
+	std::vector<uint8_t> DecompressBC3(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input);
+	std::vector<uint8_t> DecompressBC4(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input);
+	std::vector<uint8_t> DecompressBC5(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input);
+	std::vector<uint8_t> DecompressBC6H(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input, uint32_t* OutNumFailedBlocks = nullptr);
+	std::vector<uint8_t> DecompressBC7(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input, uint32_t* OutNumFailedBlocks = nullptr);
 }
 #endif
\ No newline at end of file
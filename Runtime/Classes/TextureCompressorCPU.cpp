@@ -0,0 +1,1392 @@
+#include "TextureCompressor.h"
+
+#if WITH_EDITOR
+#include <immintrin.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "JobSystem.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define UH_TARGET_AVX
+#else
+#define UH_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+// CPU implementation of block compression, it doesn't need a graphic device so it can run on the asset build machines
+// endpoints are fitted along the principal axis of a block and refined with least squares, then the indices are fitted with SIMD
+// the block formats follow the same documents as the GPU path:
+// https://learn.microsoft.com/en-us/windows/win32/direct3d10/d3d10-graphics-programming-guide-resources-block-compression
+// https://learn.microsoft.com/en-us/windows/win32/direct3d11/bc6h-format
+// https://learn.microsoft.com/en-us/windows/win32/direct3d11/bc7-format
+namespace UHTextureCompressor
+{
+	// texels of a 4x4 block in SoA layout, unused channels are zero
+	struct alignas(32) UHBlockTexels
+	{
+		float Channels[4][16];
+	};
+
+	// reference values of a block, unused channels are zero as well
+	struct UHBlockPalette
+	{
+		UHBlockPalette()
+			: NumEntries(0)
+		{
+			memset(Entries, 0, sizeof(Entries));
+		}
+
+		float Entries[16][4];
+		int32_t NumEntries;
+	};
+
+	// 128-bit little endian bit stream, used by BC6H and BC7 whose fields aren't byte aligned
+	struct UHBitWriter
+	{
+		UHBitWriter()
+			: Position(0)
+		{
+			Bits[0] = 0;
+			Bits[1] = 0;
+		}
+
+		void Write(uint32_t InValue, uint32_t InNumBits)
+		{
+			for (uint32_t Idx = 0; Idx < InNumBits; Idx++, Position++)
+			{
+				Bits[Position >> 6] |= static_cast<uint64_t>((InValue >> Idx) & 1) << (Position & 63);
+			}
+		}
+
+		uint64_t Bits[2];
+		uint32_t Position;
+	};
+
+	struct UHBitReader
+	{
+		UHBitReader(const uint64_t* InBits)
+			: Bits(InBits)
+			, Position(0)
+		{
+		}
+
+		uint32_t Read(uint32_t InNumBits)
+		{
+			uint32_t Value = 0;
+			for (uint32_t Idx = 0; Idx < InNumBits; Idx++, Position++)
+			{
+				Value |= static_cast<uint32_t>((Bits[Position >> 6] >> (Position & 63)) & 1) << Idx;
+			}
+			return Value;
+		}
+
+		const uint64_t* Bits;
+		uint32_t Position;
+	};
+
+	// interpolation weights of 4-bit indices, shared by BC6H and BC7
+	const int32_t GWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	UHCompressorSIMDLevel DetectSIMDLevel()
+	{
+#if defined(_MSC_VER)
+		int32_t CpuInfo[4];
+		__cpuid(CpuInfo, 1);
+
+		// AVX needs both CPU support and the OS saving YMM registers
+		const bool bHasOSXSave = (CpuInfo[2] & (1 << 27)) != 0;
+		const bool bHasAVX = (CpuInfo[2] & (1 << 28)) != 0;
+		if (bHasOSXSave && bHasAVX && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			return UHCompressorSIMDLevel::AVX;
+		}
+#else
+		if (__builtin_cpu_supports("avx"))
+		{
+			return UHCompressorSIMDLevel::AVX;
+		}
+#endif
+
+		// SSE2 is the baseline of x64
+		return UHCompressorSIMDLevel::SSE;
+	}
+
+	UHCompressorSIMDLevel& CurrentSIMDLevel()
+	{
+		static UHCompressorSIMDLevel Level = DetectSIMDLevel();
+		return Level;
+	}
+
+	UHCompressorSIMDLevel GetCompressorSIMDLevel()
+	{
+		return CurrentSIMDLevel();
+	}
+
+	// mostly for benchmarking, a level higher than the CPU supports is clamped
+	void SetCompressorSIMDLevel(UHCompressorSIMDLevel InLevel)
+	{
+		CurrentSIMDLevel() = (std::min)(InLevel, DetectSIMDLevel());
+	}
+
+	// workers are shared by all CPU texture processing (compression and mip generation), the caller thread joins the work as well
+	UHJobSystem& GetTextureJobSystem()
+	{
+		static UHJobSystem JobSystem;
+		static std::once_flag InitFlag;
+		std::call_once(InitFlag, []()
+			{
+				JobSystem.Initialize((std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 0));
+			});
+		return JobSystem;
+	}
+
+	// find the closest palette entry for each texel, returns the sum of squared errors
+	// all SIMD levels use the same operation order, so they output the same indices
+	float FitIndicesScalar(const UHBlockTexels& InTexels, const UHBlockPalette& InPalette, uint8_t* OutIndices)
+	{
+		float TotalError = 0.0f;
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			float MinError = FLT_MAX;
+			int32_t ClosestIdx = 0;
+			for (int32_t Jdx = 0; Jdx < InPalette.NumEntries; Jdx++)
+			{
+				float Error = 0.0f;
+				for (int32_t Ch = 0; Ch < 4; Ch++)
+				{
+					const float Diff = InTexels.Channels[Ch][Idx] - InPalette.Entries[Jdx][Ch];
+					Error += Diff * Diff;
+				}
+
+				if (Error < MinError)
+				{
+					MinError = Error;
+					ClosestIdx = Jdx;
+				}
+			}
+
+			OutIndices[Idx] = static_cast<uint8_t>(ClosestIdx);
+			TotalError += MinError;
+		}
+
+		return TotalError;
+	}
+
+	// 4 texels per iteration
+	float FitIndicesSSE(const UHBlockTexels& InTexels, const UHBlockPalette& InPalette, uint8_t* OutIndices)
+	{
+		alignas(16) float Errors[16];
+		alignas(16) float Indices[16];
+
+		for (int32_t Base = 0; Base < 16; Base += 4)
+		{
+			const __m128 C0 = _mm_load_ps(&InTexels.Channels[0][Base]);
+			const __m128 C1 = _mm_load_ps(&InTexels.Channels[1][Base]);
+			const __m128 C2 = _mm_load_ps(&InTexels.Channels[2][Base]);
+			const __m128 C3 = _mm_load_ps(&InTexels.Channels[3][Base]);
+
+			__m128 MinError = _mm_set1_ps(FLT_MAX);
+			__m128 ClosestIdx = _mm_setzero_ps();
+			for (int32_t Jdx = 0; Jdx < InPalette.NumEntries; Jdx++)
+			{
+				const float* Entry = InPalette.Entries[Jdx];
+				__m128 Diff = _mm_sub_ps(C0, _mm_set1_ps(Entry[0]));
+				__m128 Error = _mm_add_ps(_mm_setzero_ps(), _mm_mul_ps(Diff, Diff));
+				Diff = _mm_sub_ps(C1, _mm_set1_ps(Entry[1]));
+				Error = _mm_add_ps(Error, _mm_mul_ps(Diff, Diff));
+				Diff = _mm_sub_ps(C2, _mm_set1_ps(Entry[2]));
+				Error = _mm_add_ps(Error, _mm_mul_ps(Diff, Diff));
+				Diff = _mm_sub_ps(C3, _mm_set1_ps(Entry[3]));
+				Error = _mm_add_ps(Error, _mm_mul_ps(Diff, Diff));
+
+				const __m128 Closer = _mm_cmplt_ps(Error, MinError);
+				MinError = _mm_min_ps(Error, MinError);
+				ClosestIdx = _mm_or_ps(_mm_and_ps(Closer, _mm_set1_ps(static_cast<float>(Jdx))), _mm_andnot_ps(Closer, ClosestIdx));
+			}
+
+			_mm_store_ps(&Errors[Base], MinError);
+			_mm_store_ps(&Indices[Base], ClosestIdx);
+		}
+
+		float TotalError = 0.0f;
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			OutIndices[Idx] = static_cast<uint8_t>(Indices[Idx]);
+			TotalError += Errors[Idx];
+		}
+
+		return TotalError;
+	}
+
+	// 8 texels per iteration, only AVX float instructions are used so it doesn't require AVX2
+	UH_TARGET_AVX float FitIndicesAVX(const UHBlockTexels& InTexels, const UHBlockPalette& InPalette, uint8_t* OutIndices)
+	{
+		alignas(32) float Errors[16];
+		alignas(32) float Indices[16];
+
+		for (int32_t Base = 0; Base < 16; Base += 8)
+		{
+			const __m256 C0 = _mm256_load_ps(&InTexels.Channels[0][Base]);
+			const __m256 C1 = _mm256_load_ps(&InTexels.Channels[1][Base]);
+			const __m256 C2 = _mm256_load_ps(&InTexels.Channels[2][Base]);
+			const __m256 C3 = _mm256_load_ps(&InTexels.Channels[3][Base]);
+
+			__m256 MinError = _mm256_set1_ps(FLT_MAX);
+			__m256 ClosestIdx = _mm256_setzero_ps();
+			for (int32_t Jdx = 0; Jdx < InPalette.NumEntries; Jdx++)
+			{
+				const float* Entry = InPalette.Entries[Jdx];
+				__m256 Diff = _mm256_sub_ps(C0, _mm256_set1_ps(Entry[0]));
+				__m256 Error = _mm256_add_ps(_mm256_setzero_ps(), _mm256_mul_ps(Diff, Diff));
+				Diff = _mm256_sub_ps(C1, _mm256_set1_ps(Entry[1]));
+				Error = _mm256_add_ps(Error, _mm256_mul_ps(Diff, Diff));
+				Diff = _mm256_sub_ps(C2, _mm256_set1_ps(Entry[2]));
+				Error = _mm256_add_ps(Error, _mm256_mul_ps(Diff, Diff));
+				Diff = _mm256_sub_ps(C3, _mm256_set1_ps(Entry[3]));
+				Error = _mm256_add_ps(Error, _mm256_mul_ps(Diff, Diff));
+
+				const __m256 Closer = _mm256_cmp_ps(Error, MinError, _CMP_LT_OQ);
+				MinError = _mm256_min_ps(Error, MinError);
+				ClosestIdx = _mm256_or_ps(_mm256_and_ps(Closer, _mm256_set1_ps(static_cast<float>(Jdx))), _mm256_andnot_ps(Closer, ClosestIdx));
+			}
+
+			_mm256_store_ps(&Errors[Base], MinError);
+			_mm256_store_ps(&Indices[Base], ClosestIdx);
+		}
+
+		// avoid the AVX-SSE transition penalty
+		_mm256_zeroupper();
+
+		float TotalError = 0.0f;
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			OutIndices[Idx] = static_cast<uint8_t>(Indices[Idx]);
+			TotalError += Errors[Idx];
+		}
+
+		return TotalError;
+	}
+
+	float FitIndices(const UHBlockTexels& InTexels, const UHBlockPalette& InPalette, uint8_t* OutIndices)
+	{
+		switch (CurrentSIMDLevel())
+		{
+		case UHCompressorSIMDLevel::AVX:
+			return FitIndicesAVX(InTexels, InPalette, OutIndices);
+
+		case UHCompressorSIMDLevel::SSE:
+			return FitIndicesSSE(InTexels, InPalette, OutIndices);
+
+		default:
+			break;
+		}
+
+		return FitIndicesScalar(InTexels, InPalette, OutIndices);
+	}
+
+	// load a block from RGBA8 data, the channels [InFirstChannel, InFirstChannel + InNumChannels) are stored from the first slot
+	void LoadBlockRGBA8(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input, const uint32_t BlockX, const uint32_t BlockY
+		, const int32_t InFirstChannel, const int32_t InNumChannels, UHBlockTexels& OutTexels)
+	{
+		memset(&OutTexels, 0, sizeof(UHBlockTexels));
+		for (uint32_t Y = 0; Y < 4; Y++)
+		{
+			const uint32_t PY = (std::min)(BlockY * 4 + Y, Height - 1);
+			for (uint32_t X = 0; X < 4; X++)
+			{
+				const uint32_t PX = (std::min)(BlockX * 4 + X, Width - 1);
+				const uint8_t* Texel = &Input[(static_cast<size_t>(PY) * Width + PX) * 4];
+				for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+				{
+					OutTexels.Channels[Ch][Y * 4 + X] = static_cast<float>(Texel[InFirstChannel + Ch]);
+				}
+			}
+		}
+	}
+
+	// principal axis with power iteration, the axis is zero if all texels are the same
+	void ComputePrincipalAxis(const UHBlockTexels& InTexels, const int32_t InNumChannels, float* OutMean, float* OutAxis)
+	{
+		float MinValue[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+		float MaxValue[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			OutMean[Ch] = 0.0f;
+			OutAxis[Ch] = 0.0f;
+			if (Ch >= InNumChannels)
+			{
+				continue;
+			}
+
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				OutMean[Ch] += InTexels.Channels[Ch][Idx];
+				MinValue[Ch] = (std::min)(MinValue[Ch], InTexels.Channels[Ch][Idx]);
+				MaxValue[Ch] = (std::max)(MaxValue[Ch], InTexels.Channels[Ch][Idx]);
+			}
+			OutMean[Ch] /= 16.0f;
+		}
+
+		float Covariance[4][4] = {};
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			for (int32_t Row = 0; Row < InNumChannels; Row++)
+			{
+				const float DR = InTexels.Channels[Row][Idx] - OutMean[Row];
+				for (int32_t Col = 0; Col < InNumChannels; Col++)
+				{
+					Covariance[Row][Col] += DR * (InTexels.Channels[Col][Idx] - OutMean[Col]);
+				}
+			}
+		}
+
+		// start from the diagonal of the bounding box, it's usually close to the principal axis already
+		float Axis[4] = {};
+		for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+		{
+			Axis[Ch] = MaxValue[Ch] - MinValue[Ch];
+		}
+
+		for (int32_t Iter = 0; Iter < 8; Iter++)
+		{
+			float NewAxis[4] = {};
+			float MaxComponent = 0.0f;
+			for (int32_t Row = 0; Row < InNumChannels; Row++)
+			{
+				for (int32_t Col = 0; Col < InNumChannels; Col++)
+				{
+					NewAxis[Row] += Covariance[Row][Col] * Axis[Col];
+				}
+				MaxComponent = (std::max)(MaxComponent, std::abs(NewAxis[Row]));
+			}
+
+			if (MaxComponent < 1e-6f)
+			{
+				break;
+			}
+
+			for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+			{
+				Axis[Ch] = NewAxis[Ch] / MaxComponent;
+			}
+		}
+
+		float Length = 0.0f;
+		for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+		{
+			Length += Axis[Ch] * Axis[Ch];
+		}
+
+		if (Length > 1e-12f)
+		{
+			Length = std::sqrt(Length);
+			for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+			{
+				OutAxis[Ch] = Axis[Ch] / Length;
+			}
+		}
+	}
+
+	// endpoints at the extent of texels projected on the principal axis
+	void FitEndpointsOnAxis(const UHBlockTexels& InTexels, const int32_t InNumChannels, float* OutEndpoint0, float* OutEndpoint1)
+	{
+		float Mean[4];
+		float Axis[4];
+		ComputePrincipalAxis(InTexels, InNumChannels, Mean, Axis);
+
+		float MinT = 0.0f;
+		float MaxT = 0.0f;
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			float T = 0.0f;
+			for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+			{
+				T += (InTexels.Channels[Ch][Idx] - Mean[Ch]) * Axis[Ch];
+			}
+			MinT = (std::min)(MinT, T);
+			MaxT = (std::max)(MaxT, T);
+		}
+
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			OutEndpoint0[Ch] = Mean[Ch] + Axis[Ch] * MinT;
+			OutEndpoint1[Ch] = Mean[Ch] + Axis[Ch] * MaxT;
+		}
+	}
+
+	// solve the endpoints which minimize the error for the given interpolation weights (0 at endpoint 0, 1 at endpoint 1)
+	// returns false if the weights are degenerate
+	bool SolveEndpointsLeastSquares(const UHBlockTexels& InTexels, const int32_t InNumChannels, const float* InWeights, const float InMinValue
+		, const float InMaxValue, float* OutEndpoint0, float* OutEndpoint1)
+	{
+		float AA = 0.0f;
+		float AB = 0.0f;
+		float BB = 0.0f;
+		float AX[4] = {};
+		float BX[4] = {};
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			const float B = InWeights[Idx];
+			const float A = 1.0f - B;
+			AA += A * A;
+			AB += A * B;
+			BB += B * B;
+			for (int32_t Ch = 0; Ch < InNumChannels; Ch++)
+			{
+				AX[Ch] += A * InTexels.Channels[Ch][Idx];
+				BX[Ch] += B * InTexels.Channels[Ch][Idx];
+			}
+		}
+
+		const float Det = AA * BB - AB * AB;
+		if (std::abs(Det) < 1e-6f)
+		{
+			return false;
+		}
+
+		const float InvDet = 1.0f / Det;
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			OutEndpoint0[Ch] = (Ch < InNumChannels) ? std::clamp((BB * AX[Ch] - AB * BX[Ch]) * InvDet, InMinValue, InMaxValue) : 0.0f;
+			OutEndpoint1[Ch] = (Ch < InNumChannels) ? std::clamp((AA * BX[Ch] - AB * AX[Ch]) * InvDet, InMinValue, InMaxValue) : 0.0f;
+		}
+
+		return true;
+	}
+
+	// BC1 ~ BC3 color part
+	uint16_t ToRGB565(const float* InColor)
+	{
+		const uint32_t R = static_cast<uint32_t>(std::clamp(InColor[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+		const uint32_t G = static_cast<uint32_t>(std::clamp(InColor[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+		const uint32_t B = static_cast<uint32_t>(std::clamp(InColor[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+		return static_cast<uint16_t>((R << 11) | (G << 5) | B);
+	}
+
+	void FromRGB565(const uint16_t InColor, int32_t* OutColor)
+	{
+		const int32_t R = (InColor >> 11) & 31;
+		const int32_t G = (InColor >> 5) & 63;
+		const int32_t B = InColor & 31;
+		OutColor[0] = (R << 3) | (R >> 2);
+		OutColor[1] = (G << 2) | (G >> 4);
+		OutColor[2] = (B << 3) | (B >> 2);
+	}
+
+	// BC1 switches to 3-color mode when Color0 <= Color1, the color part of BC3 always uses 4-color mode
+	void BuildColorPalette(const uint16_t InColor0, const uint16_t InColor1, const bool bAlways4Color, int32_t OutPalette[4][3])
+	{
+		FromRGB565(InColor0, OutPalette[0]);
+		FromRGB565(InColor1, OutPalette[1]);
+		for (int32_t Ch = 0; Ch < 3; Ch++)
+		{
+			const int32_t C0 = OutPalette[0][Ch];
+			const int32_t C1 = OutPalette[1][Ch];
+			if (bAlways4Color || InColor0 > InColor1)
+			{
+				OutPalette[2][Ch] = (2 * C0 + C1 + 1) / 3;
+				OutPalette[3][Ch] = (C0 + 2 * C1 + 1) / 3;
+			}
+			else
+			{
+				OutPalette[2][Ch] = (C0 + C1 + 1) / 2;
+				OutPalette[3][Ch] = 0;
+			}
+		}
+	}
+
+	float EvaluateColorEndpoints(const UHBlockTexels& InTexels, const float* InEndpoint0, const float* InEndpoint1
+		, uint16_t& OutColor0, uint16_t& OutColor1, uint8_t* OutIndices)
+	{
+		// always output Color0 > Color1, so the block decodes the same in BC1 and BC3
+		OutColor0 = ToRGB565(InEndpoint0);
+		OutColor1 = ToRGB565(InEndpoint1);
+		if (OutColor0 < OutColor1)
+		{
+			std::swap(OutColor0, OutColor1);
+		}
+
+		int32_t Colors[4][3];
+		BuildColorPalette(OutColor0, OutColor1, true, Colors);
+
+		UHBlockPalette Palette;
+		Palette.NumEntries = (OutColor0 == OutColor1) ? 1 : 4;
+		for (int32_t Idx = 0; Idx < Palette.NumEntries; Idx++)
+		{
+			for (int32_t Ch = 0; Ch < 3; Ch++)
+			{
+				Palette.Entries[Idx][Ch] = static_cast<float>(Colors[Idx][Ch]);
+			}
+		}
+
+		return FitIndices(InTexels, Palette, OutIndices);
+	}
+
+	uint64_t EncodeColorBlock(const UHBlockTexels& InTexels)
+	{
+		float Endpoint0[4];
+		float Endpoint1[4];
+		FitEndpointsOnAxis(InTexels, 3, Endpoint0, Endpoint1);
+
+		uint16_t BestColor0;
+		uint16_t BestColor1;
+		uint8_t BestIndices[16];
+		float BestError = EvaluateColorEndpoints(InTexels, Endpoint0, Endpoint1, BestColor0, BestColor1, BestIndices);
+
+		// refine with least squares, the weights follow the 4-color palette order
+		const float IndexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		for (int32_t Iter = 0; Iter < 2 && BestError > 0.0f && BestColor0 != BestColor1; Iter++)
+		{
+			float Weights[16];
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				Weights[Idx] = IndexWeights[BestIndices[Idx]];
+			}
+
+			if (!SolveEndpointsLeastSquares(InTexels, 3, Weights, 0.0f, 255.0f, Endpoint0, Endpoint1))
+			{
+				break;
+			}
+
+			uint16_t Color0;
+			uint16_t Color1;
+			uint8_t Indices[16];
+			const float Error = EvaluateColorEndpoints(InTexels, Endpoint0, Endpoint1, Color0, Color1, Indices);
+			if (Error >= BestError)
+			{
+				break;
+			}
+
+			BestError = Error;
+			BestColor0 = Color0;
+			BestColor1 = Color1;
+			memcpy(BestIndices, Indices, sizeof(Indices));
+		}
+
+		uint64_t Result = static_cast<uint64_t>(BestColor0) | (static_cast<uint64_t>(BestColor1) << 16);
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			Result |= static_cast<uint64_t>(BestIndices[Idx]) << (32 + Idx * 2);
+		}
+
+		return Result;
+	}
+
+	// BC3 alpha part / BC4 / BC5, 8-value mode when Alpha0 > Alpha1, otherwise 6-value mode with 0 and 255
+	void BuildAlphaPalette(const int32_t InAlpha0, const int32_t InAlpha1, int32_t OutPalette[8])
+	{
+		OutPalette[0] = InAlpha0;
+		OutPalette[1] = InAlpha1;
+		if (InAlpha0 > InAlpha1)
+		{
+			for (int32_t Idx = 2; Idx < 8; Idx++)
+			{
+				OutPalette[Idx] = ((8 - Idx) * InAlpha0 + (Idx - 1) * InAlpha1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int32_t Idx = 2; Idx < 6; Idx++)
+			{
+				OutPalette[Idx] = ((6 - Idx) * InAlpha0 + (Idx - 1) * InAlpha1 + 2) / 5;
+			}
+			OutPalette[6] = 0;
+			OutPalette[7] = 255;
+		}
+	}
+
+	float EvaluateAlphaEndpoints(const UHBlockTexels& InTexels, const int32_t InAlpha0, const int32_t InAlpha1, uint8_t* OutIndices)
+	{
+		int32_t Alphas[8];
+		BuildAlphaPalette(InAlpha0, InAlpha1, Alphas);
+
+		UHBlockPalette Palette;
+		Palette.NumEntries = 8;
+		for (int32_t Idx = 0; Idx < 8; Idx++)
+		{
+			Palette.Entries[Idx][0] = static_cast<float>(Alphas[Idx]);
+		}
+
+		return FitIndices(InTexels, Palette, OutIndices);
+	}
+
+	// the value is expected in the first channel
+	uint64_t EncodeAlphaBlock(const UHBlockTexels& InTexels)
+	{
+		int32_t MinAlpha = 255;
+		int32_t MaxAlpha = 0;
+		int32_t MinInnerAlpha = 255;
+		int32_t MaxInnerAlpha = 0;
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			const int32_t Alpha = static_cast<int32_t>(InTexels.Channels[0][Idx]);
+			MinAlpha = (std::min)(MinAlpha, Alpha);
+			MaxAlpha = (std::max)(MaxAlpha, Alpha);
+			if (Alpha > 0 && Alpha < 255)
+			{
+				MinInnerAlpha = (std::min)(MinInnerAlpha, Alpha);
+				MaxInnerAlpha = (std::max)(MaxInnerAlpha, Alpha);
+			}
+		}
+
+		int32_t BestAlpha0 = MinAlpha;
+		int32_t BestAlpha1 = MaxAlpha;
+		uint8_t BestIndices[16];
+		float BestError = FLT_MAX;
+
+		// 8-value mode, also try insetting the endpoints a bit since the extremes are often outliers
+		for (int32_t Inset0 = 0; Inset0 < 3 && BestError > 0.0f; Inset0++)
+		{
+			for (int32_t Inset1 = 0; Inset1 < 3 && BestError > 0.0f; Inset1++)
+			{
+				const int32_t Alpha0 = MaxAlpha - Inset0;
+				const int32_t Alpha1 = MinAlpha + Inset1;
+				if (Alpha0 <= Alpha1)
+				{
+					continue;
+				}
+
+				uint8_t Indices[16];
+				const float Error = EvaluateAlphaEndpoints(InTexels, Alpha0, Alpha1, Indices);
+				if (Error < BestError)
+				{
+					BestError = Error;
+					BestAlpha0 = Alpha0;
+					BestAlpha1 = Alpha1;
+					memcpy(BestIndices, Indices, sizeof(Indices));
+				}
+			}
+		}
+
+		// 6-value mode, 0 and 255 are represented exactly so the range only needs to cover the other values
+		if (BestError > 0.0f)
+		{
+			const int32_t Alpha0 = (MinInnerAlpha <= MaxInnerAlpha) ? MinInnerAlpha : MinAlpha;
+			const int32_t Alpha1 = (MinInnerAlpha <= MaxInnerAlpha) ? MaxInnerAlpha : MinAlpha;
+
+			uint8_t Indices[16];
+			const float Error = EvaluateAlphaEndpoints(InTexels, Alpha0, Alpha1, Indices);
+			if (Error < BestError)
+			{
+				BestError = Error;
+				BestAlpha0 = Alpha0;
+				BestAlpha1 = Alpha1;
+				memcpy(BestIndices, Indices, sizeof(Indices));
+			}
+		}
+
+		uint64_t Result = static_cast<uint64_t>(BestAlpha0) | (static_cast<uint64_t>(BestAlpha1) << 8);
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			Result |= static_cast<uint64_t>(BestIndices[Idx]) << (16 + Idx * 3);
+		}
+
+		return Result;
+	}
+
+	// BC6H, the CPU encoder outputs mode 11 (10-bit endpoints without delta) of the signed format
+	// endpoints are searched in the half float bits, negative values are clamped to zero
+	const int32_t GMaxHalfBits = 0x7bff;
+
+	int32_t SignExtend(const int32_t InValue, const int32_t InNumBits)
+	{
+		const int32_t Shift = 32 - InNumBits;
+		return static_cast<int32_t>(static_cast<uint32_t>(InValue) << Shift) >> Shift;
+	}
+
+	int32_t UnquantizeBC6HSigned(int32_t InValue, const int32_t InNumBits)
+	{
+		if (InNumBits >= 16)
+		{
+			return InValue;
+		}
+
+		const bool bIsNegative = InValue < 0;
+		InValue = std::abs(InValue);
+
+		int32_t Result;
+		if (InValue == 0)
+		{
+			Result = 0;
+		}
+		else if (InValue >= (1 << (InNumBits - 1)) - 1)
+		{
+			Result = 0x7fff;
+		}
+		else
+		{
+			Result = ((InValue << 15) + 0x4000) >> (InNumBits - 1);
+		}
+
+		return bIsNegative ? -Result : Result;
+	}
+
+	// final scaling to the half float bits
+	uint16_t FinishBC6HSigned(const int32_t InValue)
+	{
+		if (InValue < 0)
+		{
+			return static_cast<uint16_t>(0x8000 | (((-InValue) * 31) >> 5));
+		}
+
+		return static_cast<uint16_t>((InValue * 31) >> 5);
+	}
+
+	uint16_t InterpolateBC6H(const int32_t InUnquantized0, const int32_t InUnquantized1, const int32_t InWeight)
+	{
+		return FinishBC6HSigned((InUnquantized0 * (64 - InWeight) + InUnquantized1 * InWeight + 32) >> 6);
+	}
+
+	// the half bits decoded from each positive 10-bit endpoint, it's monotonic so it can be searched
+	const std::vector<int32_t>& GetBC6HEndpointTable()
+	{
+		static const std::vector<int32_t> Table = []()
+			{
+				std::vector<int32_t> Result(512);
+				for (int32_t Idx = 0; Idx < 512; Idx++)
+				{
+					Result[Idx] = FinishBC6HSigned(UnquantizeBC6HSigned(Idx, 10));
+				}
+				return Result;
+			}();
+		return Table;
+	}
+
+	int32_t QuantizeBC6HEndpoint(const float InHalfBits)
+	{
+		const std::vector<int32_t>& Table = GetBC6HEndpointTable();
+		const int32_t Target = static_cast<int32_t>(std::clamp(InHalfBits + 0.5f, 0.0f, static_cast<float>(GMaxHalfBits)));
+		const int32_t Upper = static_cast<int32_t>(std::lower_bound(Table.begin(), Table.end(), Target) - Table.begin());
+		if (Upper == 0)
+		{
+			return 0;
+		}
+
+		if (Upper >= static_cast<int32_t>(Table.size()))
+		{
+			return static_cast<int32_t>(Table.size()) - 1;
+		}
+
+		return (Table[Upper] - Target < Target - Table[Upper - 1]) ? Upper : Upper - 1;
+	}
+
+	float EvaluateBC6HEndpoints(const UHBlockTexels& InTexels, const float* InEndpoint0, const float* InEndpoint1
+		, int32_t* OutQuantized0, int32_t* OutQuantized1, uint8_t* OutIndices)
+	{
+		UHBlockPalette Palette;
+		Palette.NumEntries = 16;
+		for (int32_t Ch = 0; Ch < 3; Ch++)
+		{
+			OutQuantized0[Ch] = QuantizeBC6HEndpoint(InEndpoint0[Ch]);
+			OutQuantized1[Ch] = QuantizeBC6HEndpoint(InEndpoint1[Ch]);
+
+			const int32_t Unquantized0 = UnquantizeBC6HSigned(OutQuantized0[Ch], 10);
+			const int32_t Unquantized1 = UnquantizeBC6HSigned(OutQuantized1[Ch], 10);
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				Palette.Entries[Idx][Ch] = static_cast<float>(InterpolateBC6H(Unquantized0, Unquantized1, GWeights4[Idx]));
+			}
+		}
+
+		return FitIndices(InTexels, Palette, OutIndices);
+	}
+
+	void EncodeBC6HBlock(const UHBlockTexels& InTexels, uint64_t* OutBlock)
+	{
+		float Endpoint0[4];
+		float Endpoint1[4];
+		FitEndpointsOnAxis(InTexels, 3, Endpoint0, Endpoint1);
+
+		int32_t BestQuantized0[3];
+		int32_t BestQuantized1[3];
+		uint8_t BestIndices[16];
+		float BestError = EvaluateBC6HEndpoints(InTexels, Endpoint0, Endpoint1, BestQuantized0, BestQuantized1, BestIndices);
+
+		float Weights[16];
+		for (int32_t Iter = 0; Iter < 2 && BestError > 0.0f; Iter++)
+		{
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				Weights[Idx] = GWeights4[BestIndices[Idx]] / 64.0f;
+			}
+
+			if (!SolveEndpointsLeastSquares(InTexels, 3, Weights, 0.0f, static_cast<float>(GMaxHalfBits), Endpoint0, Endpoint1))
+			{
+				break;
+			}
+
+			int32_t Quantized0[3];
+			int32_t Quantized1[3];
+			uint8_t Indices[16];
+			const float Error = EvaluateBC6HEndpoints(InTexels, Endpoint0, Endpoint1, Quantized0, Quantized1, Indices);
+			if (Error >= BestError)
+			{
+				break;
+			}
+
+			BestError = Error;
+			memcpy(BestQuantized0, Quantized0, sizeof(Quantized0));
+			memcpy(BestQuantized1, Quantized1, sizeof(Quantized1));
+			memcpy(BestIndices, Indices, sizeof(Indices));
+		}
+
+		// the MSB of the anchor index is implicitly zero, swap the endpoints if it's set
+		if (BestIndices[0] > 7)
+		{
+			std::swap(BestQuantized0, BestQuantized1);
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				BestIndices[Idx] = 15 - BestIndices[Idx];
+			}
+		}
+
+		UHBitWriter Writer;
+		Writer.Write(0x03, 5);
+		for (int32_t Ch = 0; Ch < 3; Ch++)
+		{
+			Writer.Write(BestQuantized0[Ch], 10);
+		}
+		for (int32_t Ch = 0; Ch < 3; Ch++)
+		{
+			Writer.Write(BestQuantized1[Ch], 10);
+		}
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			Writer.Write(BestIndices[Idx], (Idx == 0) ? 3 : 4);
+		}
+
+		OutBlock[0] = Writer.Bits[0];
+		OutBlock[1] = Writer.Bits[1];
+	}
+
+	// BC7, the CPU encoder outputs mode 6 which is a single subset RGBA with 7-bit endpoints, p-bits and 4-bit indices
+	int32_t QuantizeBC7Endpoint(const float InValue, const int32_t InPBit)
+	{
+		return std::clamp(static_cast<int32_t>((InValue - InPBit) * 0.5f + 0.5f), 0, 127);
+	}
+
+	float EvaluateBC7Endpoints(const UHBlockTexels& InTexels, const float* InEndpoint0, const float* InEndpoint1, const int32_t InPBit0
+		, const int32_t InPBit1, int32_t* OutQuantized0, int32_t* OutQuantized1, uint8_t* OutIndices)
+	{
+		UHBlockPalette Palette;
+		Palette.NumEntries = 16;
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			OutQuantized0[Ch] = QuantizeBC7Endpoint(InEndpoint0[Ch], InPBit0);
+			OutQuantized1[Ch] = QuantizeBC7Endpoint(InEndpoint1[Ch], InPBit1);
+
+			const int32_t Value0 = (OutQuantized0[Ch] << 1) | InPBit0;
+			const int32_t Value1 = (OutQuantized1[Ch] << 1) | InPBit1;
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				Palette.Entries[Idx][Ch] = static_cast<float>((Value0 * (64 - GWeights4[Idx]) + Value1 * GWeights4[Idx] + 32) >> 6);
+			}
+		}
+
+		return FitIndices(InTexels, Palette, OutIndices);
+	}
+
+	struct UHBC7Mode6Data
+	{
+		int32_t Quantized0[4];
+		int32_t Quantized1[4];
+		int32_t PBit0;
+		int32_t PBit1;
+		uint8_t Indices[16];
+	};
+
+	// try all p-bit combinations of the endpoints
+	float EvaluateBC7Mode6(const UHBlockTexels& InTexels, const float* InEndpoint0, const float* InEndpoint1, UHBC7Mode6Data& OutData)
+	{
+		float BestError = FLT_MAX;
+		for (int32_t PBits = 0; PBits < 4; PBits++)
+		{
+			UHBC7Mode6Data Data;
+			Data.PBit0 = PBits & 1;
+			Data.PBit1 = PBits >> 1;
+			const float Error = EvaluateBC7Endpoints(InTexels, InEndpoint0, InEndpoint1, Data.PBit0, Data.PBit1, Data.Quantized0, Data.Quantized1, Data.Indices);
+			if (Error < BestError)
+			{
+				BestError = Error;
+				OutData = Data;
+			}
+		}
+
+		return BestError;
+	}
+
+	void EncodeBC7Block(const UHBlockTexels& InTexels, uint64_t* OutBlock)
+	{
+		float Endpoint0[4];
+		float Endpoint1[4];
+		FitEndpointsOnAxis(InTexels, 4, Endpoint0, Endpoint1);
+
+		UHBC7Mode6Data Best;
+		float BestError = EvaluateBC7Mode6(InTexels, Endpoint0, Endpoint1, Best);
+
+		float Weights[16];
+		for (int32_t Iter = 0; Iter < 2 && BestError > 0.0f; Iter++)
+		{
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				Weights[Idx] = GWeights4[Best.Indices[Idx]] / 64.0f;
+			}
+
+			if (!SolveEndpointsLeastSquares(InTexels, 4, Weights, 0.0f, 255.0f, Endpoint0, Endpoint1))
+			{
+				break;
+			}
+
+			UHBC7Mode6Data Data;
+			const float Error = EvaluateBC7Mode6(InTexels, Endpoint0, Endpoint1, Data);
+			if (Error >= BestError)
+			{
+				break;
+			}
+
+			BestError = Error;
+			Best = Data;
+		}
+
+		// the MSB of the anchor index is implicitly zero, swap the endpoints if it's set
+		if (Best.Indices[0] > 7)
+		{
+			std::swap(Best.Quantized0, Best.Quantized1);
+			std::swap(Best.PBit0, Best.PBit1);
+			for (int32_t Idx = 0; Idx < 16; Idx++)
+			{
+				Best.Indices[Idx] = 15 - Best.Indices[Idx];
+			}
+		}
+
+		UHBitWriter Writer;
+		Writer.Write(1 << 6, 7);
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			Writer.Write(Best.Quantized0[Ch], 7);
+			Writer.Write(Best.Quantized1[Ch], 7);
+		}
+		Writer.Write(Best.PBit0, 1);
+		Writer.Write(Best.PBit1, 1);
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			Writer.Write(Best.Indices[Idx], (Idx == 0) ? 3 : 4);
+		}
+
+		OutBlock[0] = Writer.Bits[0];
+		OutBlock[1] = Writer.Bits[1];
+	}
+
+	// run the block function for all blocks, rows of blocks are distributed to the job system
+	template <typename BlockFunction>
+	std::vector<uint64_t> CompressBlocks(const uint32_t Width, const uint32_t Height, const uint32_t NumWordsPerBlock, const BlockFunction& InFunction)
+	{
+		const uint32_t BlocksX = (std::max)((Width + 3) / 4, 1u);
+		const uint32_t BlocksY = (std::max)((Height + 3) / 4, 1u);
+		std::vector<uint64_t> Output(static_cast<size_t>(BlocksX) * BlocksY * NumWordsPerBlock);
+
+		const UHParallelForFunction RowFunction = [&](int32_t Begin, int32_t End, int32_t)
+			{
+				for (int32_t Row = Begin; Row < End; Row++)
+				{
+					for (uint32_t Column = 0; Column < BlocksX; Column++)
+					{
+						InFunction(Column, static_cast<uint32_t>(Row), &Output[(static_cast<size_t>(Row) * BlocksX + Column) * NumWordsPerBlock]);
+					}
+				}
+			};
+		GetTextureJobSystem().ParallelFor(static_cast<int32_t>(BlocksY), 1, RowFunction);
+
+		return Output;
+	}
+
+	std::vector<uint64_t> CompressBC1CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input)
+	{
+		return CompressBlocks(Width, Height, 1, [&](uint32_t BlockX, uint32_t BlockY, uint64_t* OutBlock)
+			{
+				UHBlockTexels Texels;
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 0, 3, Texels);
+				OutBlock[0] = EncodeColorBlock(Texels);
+			});
+	}
+
+	std::vector<uint64_t> CompressBC3CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input)
+	{
+		return CompressBlocks(Width, Height, 2, [&](uint32_t BlockX, uint32_t BlockY, uint64_t* OutBlock)
+			{
+				UHBlockTexels Texels;
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 3, 1, Texels);
+				OutBlock[0] = EncodeAlphaBlock(Texels);
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 0, 3, Texels);
+				OutBlock[1] = EncodeColorBlock(Texels);
+			});
+	}
+
+	std::vector<uint64_t> CompressBC4CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input)
+	{
+		return CompressBlocks(Width, Height, 1, [&](uint32_t BlockX, uint32_t BlockY, uint64_t* OutBlock)
+			{
+				UHBlockTexels Texels;
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 0, 1, Texels);
+				OutBlock[0] = EncodeAlphaBlock(Texels);
+			});
+	}
+
+	std::vector<uint64_t> CompressBC5CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input)
+	{
+		return CompressBlocks(Width, Height, 2, [&](uint32_t BlockX, uint32_t BlockY, uint64_t* OutBlock)
+			{
+				UHBlockTexels Texels;
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 0, 1, Texels);
+				OutBlock[0] = EncodeAlphaBlock(Texels);
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 1, 1, Texels);
+				OutBlock[1] = EncodeAlphaBlock(Texels);
+			});
+	}
+
+	std::vector<uint64_t> CompressBC6HCPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input)
+	{
+		// input is RGBAHalf, load the half bits directly
+		return CompressBlocks(Width, Height, 2, [&](uint32_t BlockX, uint32_t BlockY, uint64_t* OutBlock)
+			{
+				UHBlockTexels Texels;
+				memset(&Texels, 0, sizeof(UHBlockTexels));
+				for (uint32_t Y = 0; Y < 4; Y++)
+				{
+					const uint32_t PY = (std::min)(BlockY * 4 + Y, Height - 1);
+					for (uint32_t X = 0; X < 4; X++)
+					{
+						const uint32_t PX = (std::min)(BlockX * 4 + X, Width - 1);
+						uint16_t RGBAHalf[4];
+						memcpy(RGBAHalf, &Input[(static_cast<size_t>(PY) * Width + PX) * sizeof(RGBAHalf)], sizeof(RGBAHalf));
+
+						for (int32_t Ch = 0; Ch < 3; Ch++)
+						{
+							const int32_t HalfBits = (RGBAHalf[Ch] & 0x8000) ? 0 : (std::min)(static_cast<int32_t>(RGBAHalf[Ch]), GMaxHalfBits);
+							Texels.Channels[Ch][Y * 4 + X] = static_cast<float>(HalfBits);
+						}
+					}
+				}
+
+				EncodeBC6HBlock(Texels, OutBlock);
+			});
+	}
+
+	std::vector<uint64_t> CompressBC7CPU(const uint32_t Width, const uint32_t Height, const std::vector<uint8_t>& Input)
+	{
+		return CompressBlocks(Width, Height, 2, [&](uint32_t BlockX, uint32_t BlockY, uint64_t* OutBlock)
+			{
+				UHBlockTexels Texels;
+				LoadBlockRGBA8(Width, Height, Input, BlockX, BlockY, 0, 4, Texels);
+				EncodeBC7Block(Texels, OutBlock);
+			});
+	}
+
+	// decoders, blocks are written back to the texels inside the image
+	template <typename BlockFunction>
+	std::vector<uint8_t> DecompressBlocks(const uint32_t Width, const uint32_t Height, const uint32_t NumWordsPerBlock, const uint32_t TexelSize
+		, const std::vector<uint64_t>& Input, const BlockFunction& InFunction)
+	{
+		const uint32_t BlocksX = (std::max)((Width + 3) / 4, 1u);
+		const uint32_t BlocksY = (std::max)((Height + 3) / 4, 1u);
+		std::vector<uint8_t> Output(static_cast<size_t>(Width) * Height * TexelSize);
+		if (Input.size() < static_cast<size_t>(BlocksX) * BlocksY * NumWordsPerBlock)
+		{
+			return Output;
+		}
+
+		for (uint32_t BlockY = 0; BlockY < BlocksY; BlockY++)
+		{
+			for (uint32_t BlockX = 0; BlockX < BlocksX; BlockX++)
+			{
+				uint8_t BlockTexels[16][8] = {};
+				InFunction(&Input[(static_cast<size_t>(BlockY) * BlocksX + BlockX) * NumWordsPerBlock], BlockTexels);
+
+				for (uint32_t Y = 0; Y < 4 && BlockY * 4 + Y < Height; Y++)
+				{
+					for (uint32_t X = 0; X < 4 && BlockX * 4 + X < Width; X++)
+					{
+						const size_t OutputIdx = (static_cast<size_t>(BlockY * 4 + Y) * Width + BlockX * 4 + X) * TexelSize;
+						memcpy(&Output[OutputIdx], BlockTexels[Y * 4 + X], TexelSize);
+					}
+				}
+			}
+		}
+
+		return Output;
+	}
+
+	void DecodeColorBlock(const uint64_t InBlock, const bool bAlways4Color, uint8_t OutTexels[16][8])
+	{
+		int32_t Colors[4][3];
+		BuildColorPalette(static_cast<uint16_t>(InBlock & 0xffff), static_cast<uint16_t>((InBlock >> 16) & 0xffff), bAlways4Color, Colors);
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			const int32_t ColorIdx = static_cast<int32_t>((InBlock >> (32 + Idx * 2)) & 3);
+			for (int32_t Ch = 0; Ch < 3; Ch++)
+			{
+				OutTexels[Idx][Ch] = static_cast<uint8_t>(Colors[ColorIdx][Ch]);
+			}
+		}
+	}
+
+	void DecodeAlphaBlock(const uint64_t InBlock, const int32_t InChannel, uint8_t OutTexels[16][8])
+	{
+		int32_t Alphas[8];
+		BuildAlphaPalette(static_cast<int32_t>(InBlock & 0xff), static_cast<int32_t>((InBlock >> 8) & 0xff), Alphas);
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			OutTexels[Idx][InChannel] = static_cast<uint8_t>(Alphas[(InBlock >> (16 + Idx * 3)) & 7]);
+		}
+	}
+
+	std::vector<uint8_t> DecompressBC1(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input)
+	{
+		return DecompressBlocks(Width, Height, 1, 4, Input, [](const uint64_t* InBlock, uint8_t OutTexels[16][8])
+			{
+				DecodeColorBlock(InBlock[0], false, OutTexels);
+				for (int32_t Idx = 0; Idx < 16; Idx++)
+				{
+					OutTexels[Idx][3] = 255;
+				}
+			});
+	}
+
+	std::vector<uint8_t> DecompressBC3(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input)
+	{
+		return DecompressBlocks(Width, Height, 2, 4, Input, [](const uint64_t* InBlock, uint8_t OutTexels[16][8])
+			{
+				DecodeAlphaBlock(InBlock[0], 3, OutTexels);
+				DecodeColorBlock(InBlock[1], true, OutTexels);
+			});
+	}
+
+	std::vector<uint8_t> DecompressBC4(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input)
+	{
+		return DecompressBlocks(Width, Height, 1, 4, Input, [](const uint64_t* InBlock, uint8_t OutTexels[16][8])
+			{
+				DecodeAlphaBlock(InBlock[0], 0, OutTexels);
+				for (int32_t Idx = 0; Idx < 16; Idx++)
+				{
+					OutTexels[Idx][3] = 255;
+				}
+			});
+	}
+
+	std::vector<uint8_t> DecompressBC5(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input)
+	{
+		return DecompressBlocks(Width, Height, 2, 4, Input, [](const uint64_t* InBlock, uint8_t OutTexels[16][8])
+			{
+				DecodeAlphaBlock(InBlock[0], 0, OutTexels);
+				DecodeAlphaBlock(InBlock[1], 1, OutTexels);
+				for (int32_t Idx = 0; Idx < 16; Idx++)
+				{
+					OutTexels[Idx][3] = 255;
+				}
+			});
+	}
+
+	// bit layout of the single region BC6H modes, the fields after the 5 mode bits are listed in the stream order
+	// endpoint 0 is W and endpoint 1 (or the delta) is X, components are R/G/B
+	struct UHBC6HField
+	{
+		int32_t Endpoint;
+		int32_t Component;
+		int32_t FirstBit;
+		int32_t NumBits;
+	};
+
+	struct UHBC6HModeLayout
+	{
+		uint32_t ModeBits;
+		int32_t EndpointBits;
+		int32_t DeltaBits;
+		bool bIsTransformed;
+		std::vector<UHBC6HField> Fields;
+	};
+
+	const std::vector<UHBC6HModeLayout>& GetBC6HModeLayouts()
+	{
+		static const std::vector<UHBC6HModeLayout> Layouts = []()
+			{
+				std::vector<UHBC6HModeLayout> Result;
+
+				// the first 10 bits of all endpoints are stored in order
+				const auto AddLowBits = [](UHBC6HModeLayout& InLayout)
+					{
+						for (int32_t Ch = 0; Ch < 3; Ch++)
+						{
+							InLayout.Fields.push_back({ 0, Ch, 0, 10 });
+						}
+					};
+
+				// mode 11, 10-bit endpoints
+				UHBC6HModeLayout Mode11{ 0x03, 10, 10, false, {} };
+				AddLowBits(Mode11);
+				for (int32_t Ch = 0; Ch < 3; Ch++)
+				{
+					Mode11.Fields.push_back({ 1, Ch, 0, 10 });
+				}
+				Result.push_back(Mode11);
+
+				// mode 12, 11-bit endpoint and 9-bit delta
+				UHBC6HModeLayout Mode12{ 0x07, 11, 9, true, {} };
+				AddLowBits(Mode12);
+				for (int32_t Ch = 0; Ch < 3; Ch++)
+				{
+					Mode12.Fields.push_back({ 1, Ch, 0, 9 });
+					Mode12.Fields.push_back({ 0, Ch, 10, 1 });
+				}
+				Result.push_back(Mode12);
+
+				// mode 13, 12-bit endpoint and 8-bit delta, the high bits of the endpoint are stored reversed
+				UHBC6HModeLayout Mode13{ 0x0b, 12, 8, true, {} };
+				AddLowBits(Mode13);
+				for (int32_t Ch = 0; Ch < 3; Ch++)
+				{
+					Mode13.Fields.push_back({ 1, Ch, 0, 8 });
+					Mode13.Fields.push_back({ 0, Ch, 11, 1 });
+					Mode13.Fields.push_back({ 0, Ch, 10, 1 });
+				}
+				Result.push_back(Mode13);
+
+				// mode 14, 16-bit endpoint and 4-bit delta, the high bits of the endpoint are stored reversed
+				UHBC6HModeLayout Mode14{ 0x0f, 16, 4, true, {} };
+				AddLowBits(Mode14);
+				for (int32_t Ch = 0; Ch < 3; Ch++)
+				{
+					Mode14.Fields.push_back({ 1, Ch, 0, 4 });
+					for (int32_t Bit = 15; Bit >= 10; Bit--)
+					{
+						Mode14.Fields.push_back({ 0, Ch, Bit, 1 });
+					}
+				}
+				Result.push_back(Mode14);
+
+				return Result;
+			}();
+		return Layouts;
+	}
+
+	bool DecodeBC6HBlock(const uint64_t* InBlock, uint8_t OutTexels[16][8])
+	{
+		UHBitReader Reader(InBlock);
+		const uint32_t ModeBits = Reader.Read(5);
+
+		const UHBC6HModeLayout* Layout = nullptr;
+		for (const UHBC6HModeLayout& Mode : GetBC6HModeLayouts())
+		{
+			if (Mode.ModeBits == ModeBits)
+			{
+				Layout = &Mode;
+				break;
+			}
+		}
+
+		if (Layout == nullptr)
+		{
+			return false;
+		}
+
+		int32_t Endpoints[2][3] = {};
+		for (const UHBC6HField& Field : Layout->Fields)
+		{
+			Endpoints[Field.Endpoint][Field.Component] |= static_cast<int32_t>(Reader.Read(Field.NumBits)) << Field.FirstBit;
+		}
+
+		int32_t Unquantized[2][3];
+		for (int32_t Ch = 0; Ch < 3; Ch++)
+		{
+			const int32_t Endpoint0 = SignExtend(Endpoints[0][Ch], Layout->EndpointBits);
+			int32_t Endpoint1 = SignExtend(Endpoints[1][Ch], Layout->DeltaBits);
+			if (Layout->bIsTransformed)
+			{
+				Endpoint1 = SignExtend((Endpoint0 + Endpoint1) & ((1 << Layout->EndpointBits) - 1), Layout->EndpointBits);
+			}
+
+			Unquantized[0][Ch] = UnquantizeBC6HSigned(Endpoint0, Layout->EndpointBits);
+			Unquantized[1][Ch] = UnquantizeBC6HSigned(Endpoint1, Layout->EndpointBits);
+		}
+
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			const int32_t Weight = GWeights4[Reader.Read((Idx == 0) ? 3 : 4)];
+			uint16_t RGBAHalf[4];
+			for (int32_t Ch = 0; Ch < 3; Ch++)
+			{
+				RGBAHalf[Ch] = InterpolateBC6H(Unquantized[0][Ch], Unquantized[1][Ch], Weight);
+			}
+			RGBAHalf[3] = 0x3c00;
+			memcpy(OutTexels[Idx], RGBAHalf, sizeof(RGBAHalf));
+		}
+
+		return true;
+	}
+
+	bool DecodeBC7Block(const uint64_t* InBlock, uint8_t OutTexels[16][8])
+	{
+		UHBitReader Reader(InBlock);
+		if (Reader.Read(7) != (1 << 6))
+		{
+			return false;
+		}
+
+		int32_t Endpoints[2][4];
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			Endpoints[0][Ch] = static_cast<int32_t>(Reader.Read(7));
+			Endpoints[1][Ch] = static_cast<int32_t>(Reader.Read(7));
+		}
+
+		const int32_t PBit0 = static_cast<int32_t>(Reader.Read(1));
+		const int32_t PBit1 = static_cast<int32_t>(Reader.Read(1));
+		for (int32_t Ch = 0; Ch < 4; Ch++)
+		{
+			Endpoints[0][Ch] = (Endpoints[0][Ch] << 1) | PBit0;
+			Endpoints[1][Ch] = (Endpoints[1][Ch] << 1) | PBit1;
+		}
+
+		for (int32_t Idx = 0; Idx < 16; Idx++)
+		{
+			const int32_t Weight = GWeights4[Reader.Read((Idx == 0) ? 3 : 4)];
+			for (int32_t Ch = 0; Ch < 4; Ch++)
+			{
+				OutTexels[Idx][Ch] = static_cast<uint8_t>((Endpoints[0][Ch] * (64 - Weight) + Endpoints[1][Ch] * Weight + 32) >> 6);
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<uint8_t> DecompressBC6H(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input, uint32_t* OutNumFailedBlocks)
+	{
+		uint32_t NumFailedBlocks = 0;
+		std::vector<uint8_t> Output = DecompressBlocks(Width, Height, 2, 8, Input, [&NumFailedBlocks](const uint64_t* InBlock, uint8_t OutTexels[16][8])
+			{
+				NumFailedBlocks += DecodeBC6HBlock(InBlock, OutTexels) ? 0 : 1;
+			});
+
+		if (OutNumFailedBlocks)
+		{
+			*OutNumFailedBlocks = NumFailedBlocks;
+		}
+		return Output;
+	}
+
+	std::vector<uint8_t> DecompressBC7(const uint32_t Width, const uint32_t Height, const std::vector<uint64_t>& Input, uint32_t* OutNumFailedBlocks)
+	{
+		uint32_t NumFailedBlocks = 0;
+		std::vector<uint8_t> Output = DecompressBlocks(Width, Height, 2, 4, Input, [&NumFailedBlocks](const uint64_t* InBlock, uint8_t OutTexels[16][8])
+			{
+				NumFailedBlocks += DecodeBC7Block(InBlock, OutTexels) ? 0 : 1;
+			});
+
+		if (OutNumFailedBlocks)
+		{
+			*OutNumFailedBlocks = NumFailedBlocks;
+		}
+		return Output;
+	}
+}
+#endif
\ No newline at end of file
@@ -34,6 +34,8 @@ VkFormat GetVulkanFormat(UHTextureFormat InUHFormat)
 		FormatCache[UHTextureFormat::UH_FORMAT_BC4] = VK_FORMAT_BC4_UNORM_BLOCK;
 		FormatCache[UHTextureFormat::UH_FORMAT_BC5] = VK_FORMAT_BC5_UNORM_BLOCK;
 		FormatCache[UHTextureFormat::UH_FORMAT_BC6H] = VK_FORMAT_BC6H_SFLOAT_BLOCK;
+		FormatCache[UHTextureFormat::UH_FORMAT_BC7_UNORM] = VK_FORMAT_BC7_UNORM_BLOCK;
+		FormatCache[UHTextureFormat::UH_FORMAT_BC7_SRGB] = VK_FORMAT_BC7_SRGB_BLOCK;
 	}
 
 	return FormatCache[InUHFormat];
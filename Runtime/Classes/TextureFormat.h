@@ -36,6 +36,9 @@ enum class UHTextureFormat
 	UH_FORMAT_R11G11B10,
 	UH_FORMAT_R32F,
 
+	UH_FORMAT_BC7_UNORM,
+	UH_FORMAT_BC7_SRGB,
+
 	// add the format above
 	UH_FORMAT_MAX
 };
@@ -93,6 +96,9 @@ inline const UHTextureFormatData GTextureFormatData[UH_ENUM_VALUE(UHTextureForma
 	{4,1,2,true},
 	{4,1,3,true},
 	{4,1,1,true},
+
+	{16,16,4,false},
+	{16,16,4,false},
 };
 
 extern VkFormat GetVulkanFormat(UHTextureFormat InUHFormat);
\ No newline at end of file
@@ -19,6 +19,11 @@ void UHThread::BeginThread(std::thread InObj, uint32_t AffinityCore)
 {
 	ThreadObj = std::move(InObj);
 	ThreadId = ThreadObj.get_id();
+	SetAffinity(ThreadObj, AffinityCore);
+}
+
+void UHThread::SetAffinity(std::thread& InObj, uint32_t AffinityCore)
+{
 	// modern OS should be smart enough for thread control, uncomment for test purpose
 	// I find manually setting it introduces weird stuttering in some hardwares...
 	 
@@ -26,7 +31,7 @@ void UHThread::BeginThread(std::thread InObj, uint32_t AffinityCore)
 	//uint32_t NumCores = std::thread::hardware_concurrency();
 	//AffinityCore = AffinityCore % NumCores;
 
-	//DWORD_PTR Result = SetThreadAffinityMask(ThreadObj.native_handle(), DWORD_PTR(1) << AffinityCore);
+	//DWORD_PTR Result = SetThreadAffinityMask(InObj.native_handle(), DWORD_PTR(1) << AffinityCore);
 	//if (Result == 0)
 	//{
 	//	UHE_LOG("Failed to set affinity for thread!\n");
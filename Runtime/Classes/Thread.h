@@ -1,6 +1,7 @@
 #pragma once
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include "AsyncTask.h"
 
 // UH thread wrapper
@@ -14,6 +15,9 @@ public:
 	void BeginThread(std::thread InObj, uint32_t AffinityCore);
 	void BeginThread(std::thread InObj);
 
+	// affinity setting shared with the job system workers, the core is wrapped by the number of cores
+	static void SetAffinity(std::thread& InObj, uint32_t AffinityCore);
+
 	// end a thread
 	void EndThread();
 
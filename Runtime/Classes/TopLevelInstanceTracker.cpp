@@ -0,0 +1,328 @@
+#include "TopLevelInstanceTracker.h"
+#include <cstring>
+
+UHTopLevelInstanceTracker::UHTopLevelInstanceTracker()
+	: RefitArea(0.0)
+	, LeafArea(0.0)
+	, NumRefitsSinceRebuild(0)
+	, NumMissingNeeded(0)
+	, NumMaskedSlots(0)
+	, MaxDegradation(0.5f)
+	, MaxRefits(300)
+	, MaxMaskedRatio(0.25f)
+	, MaxRangeGap(4)
+{
+
+}
+
+void UHTopLevelInstanceTracker::Reset(uint32_t InRendererCount)
+{
+	Records.assign(InRendererCount, UHInstanceRecord{ VkAccelerationStructureInstanceKHR{}, BoundingBox(), BoundingBox(), UHINDEXNONE
+		, UHTopLevelInstanceState::Culled });
+	Instances.clear();
+	Instances.reserve(InRendererCount);
+	SlotRenderers.clear();
+	SlotRenderers.reserve(InRendererCount);
+
+	DirtySlots.clear();
+	DirtyFlags.assign(InRendererCount, 0);
+	DirtyRanges.clear();
+
+	RefitArea = 0.0;
+	LeafArea = 0.0;
+	NumRefitsSinceRebuild = 0;
+	NumMissingNeeded = 0;
+	NumMaskedSlots = 0;
+	PendingStats = UHTopLevelInstanceStats();
+	Stats = UHTopLevelInstanceStats();
+}
+
+void UHTopLevelInstanceTracker::SetRebuildPolicy(float InMaxDegradation, uint32_t InMaxRefits, float InMaxMaskedRatio, uint32_t InMaxRangeGap)
+{
+	MaxDegradation = InMaxDegradation;
+	MaxRefits = InMaxRefits;
+	MaxMaskedRatio = InMaxMaskedRatio;
+	MaxRangeGap = InMaxRangeGap;
+}
+
+void UHTopLevelInstanceTracker::SetInstance(uint32_t InRendererIndex, const VkAccelerationStructureInstanceKHR& InInstance, const BoundingBox& InBound)
+{
+	UHInstanceRecord& Record = Records[InRendererIndex];
+	const bool bSameBound = memcmp(&Record.Bound, &InBound, sizeof(BoundingBox)) == 0;
+	if (bSameBound && memcmp(&Record.Instance, &InInstance, sizeof(VkAccelerationStructureInstanceKHR)) == 0)
+	{
+		return;
+	}
+
+	// bounds of instances in the AS are accumulated, the sums are recalculated anyway when the AS will be rebuilt
+	const bool bAccumulateArea = Record.Slot != UHINDEXNONE;
+	if (bAccumulateArea)
+	{
+		RefitArea -= GetRefitArea(Record);
+		LeafArea -= GetSurfaceArea(Record.Bound);
+	}
+
+	Record.Instance = InInstance;
+	Record.Bound = InBound;
+
+	if (bAccumulateArea)
+	{
+		RefitArea += GetRefitArea(Record);
+		LeafArea += GetSurfaceArea(Record.Bound);
+		Instances[Record.Slot] = GetSlotInstance(Record);
+		MarkSlotDirty(Record.Slot);
+		PendingStats.NumUpdated++;
+	}
+}
+
+void UHTopLevelInstanceTracker::SetState(uint32_t InRendererIndex, UHTopLevelInstanceState InState)
+{
+	UHInstanceRecord& Record = Records[InRendererIndex];
+	if (Record.State == InState)
+	{
+		return;
+	}
+
+	const bool bInAS = Record.Slot != UHINDEXNONE;
+	const bool bWasMasked = bInAS && Record.State == UHTopLevelInstanceState::Culled;
+	const bool bWasMissing = !bInAS && Record.State == UHTopLevelInstanceState::Needed;
+	Record.State = InState;
+	const bool bMasked = bInAS && InState == UHTopLevelInstanceState::Culled;
+	const bool bMissing = !bInAS && InState == UHTopLevelInstanceState::Needed;
+
+	NumMaskedSlots = NumMaskedSlots + (bMasked ? 1 : 0) - (bWasMasked ? 1 : 0);
+	NumMissingNeeded = NumMissingNeeded + (bMissing ? 1 : 0) - (bWasMissing ? 1 : 0);
+
+	// toggling the mask of an instance in the AS only needs a refit
+	if (bMasked != bWasMasked)
+	{
+		Instances[Record.Slot] = GetSlotInstance(Record);
+		MarkSlotDirty(Record.Slot);
+		PendingStats.NumUpdated++;
+	}
+}
+
+UHTopLevelInstanceState UHTopLevelInstanceTracker::GetRangeState(bool bInVisible, float InSquareDistance, float InCullingDistance)
+{
+	if (!bInVisible)
+	{
+		return UHTopLevelInstanceState::Culled;
+	}
+
+	if (InSquareDistance < InCullingDistance * InCullingDistance)
+	{
+		return UHTopLevelInstanceState::Needed;
+	}
+
+	const float NearbyDistance = InCullingDistance * NearbyScale;
+	return (InSquareDistance < NearbyDistance * NearbyDistance) ? UHTopLevelInstanceState::Nearby : UHTopLevelInstanceState::Culled;
+}
+
+void UHTopLevelInstanceTracker::Commit()
+{
+	const float Degradation = (LeafArea > 0.0) ? static_cast<float>(RefitArea / LeafArea - 1.0) : 0.0f;
+
+	// nothing to build if no slot is changed
+	UHTopLevelBuildMode BuildMode = UHTopLevelBuildMode::None;
+	const bool bTooManyMasked = NumMaskedSlots > 0 && NumMaskedSlots > MaxMaskedRatio * GetInstanceCount();
+	if (NumMissingNeeded > 0 || bTooManyMasked)
+	{
+		BuildMode = UHTopLevelBuildMode::Rebuild;
+	}
+	else if (DirtySlots.size() > 0)
+	{
+		const bool bRefitTooMuch = MaxRefits > 0 && NumRefitsSinceRebuild >= MaxRefits;
+		BuildMode = (Degradation > MaxDegradation || bRefitTooMuch) ? UHTopLevelBuildMode::Rebuild : UHTopLevelBuildMode::Refit;
+	}
+
+	// membership only changes when rebuilding
+	if (BuildMode == UHTopLevelBuildMode::Rebuild)
+	{
+		ApplyMembership();
+	}
+
+	const uint32_t InstanceCount = GetInstanceCount();
+	if (BuildMode == UHTopLevelBuildMode::Rebuild)
+	{
+		// the current bounds become the build bounds
+		RefitArea = 0.0;
+		for (uint32_t Slot = 0; Slot < InstanceCount; Slot++)
+		{
+			UHInstanceRecord& Record = Records[SlotRenderers[Slot]];
+			Record.BuildBound = Record.Bound;
+			RefitArea += GetSurfaceArea(Record.Bound);
+		}
+		LeafArea = RefitArea;
+		NumRefitsSinceRebuild = 0;
+	}
+	else if (BuildMode == UHTopLevelBuildMode::Refit)
+	{
+		NumRefitsSinceRebuild++;
+	}
+
+	// merge dirty slots into ranges, slots beyond the instance count were removed and don't need uploads
+	std::sort(DirtySlots.begin(), DirtySlots.end());
+	DirtyRanges.clear();
+	uint32_t UploadCount = 0;
+	for (const uint32_t Slot : DirtySlots)
+	{
+		DirtyFlags[Slot] = 0;
+		if (Slot >= InstanceCount)
+		{
+			continue;
+		}
+
+		if (DirtyRanges.size() > 0)
+		{
+			UHTopLevelInstanceRange& Last = DirtyRanges.back();
+			if (Slot <= Last.FirstSlot + Last.Count + MaxRangeGap)
+			{
+				UploadCount += Slot + 1 - (Last.FirstSlot + Last.Count);
+				Last.Count = Slot + 1 - Last.FirstSlot;
+				continue;
+			}
+		}
+
+		DirtyRanges.push_back(UHTopLevelInstanceRange{ Slot, 1 });
+		UploadCount++;
+	}
+	DirtySlots.clear();
+
+	Stats = PendingStats;
+	Stats.NumInstances = InstanceCount;
+	Stats.NumMasked = NumMaskedSlots;
+	Stats.NumUploadRanges = static_cast<uint32_t>(DirtyRanges.size());
+	Stats.UploadBytes = UploadCount * static_cast<uint32_t>(sizeof(VkAccelerationStructureInstanceKHR));
+	Stats.NumRefitsSinceRebuild = NumRefitsSinceRebuild;
+	Stats.RefitDegradation = Degradation;
+	Stats.BuildMode = BuildMode;
+
+	PendingStats = UHTopLevelInstanceStats();
+}
+
+const std::vector<VkAccelerationStructureInstanceKHR>& UHTopLevelInstanceTracker::GetInstances() const
+{
+	return Instances;
+}
+
+const std::vector<UHTopLevelInstanceRange>& UHTopLevelInstanceTracker::GetDirtyRanges() const
+{
+	return DirtyRanges;
+}
+
+const UHTopLevelInstanceStats& UHTopLevelInstanceTracker::GetStats() const
+{
+	return Stats;
+}
+
+uint32_t UHTopLevelInstanceTracker::GetInstanceCount() const
+{
+	return static_cast<uint32_t>(Instances.size());
+}
+
+uint32_t UHTopLevelInstanceTracker::GetRendererCount() const
+{
+	return static_cast<uint32_t>(Records.size());
+}
+
+int32_t UHTopLevelInstanceTracker::GetSlotOfRenderer(uint32_t InRendererIndex) const
+{
+	return Records[InRendererIndex].Slot;
+}
+
+uint32_t UHTopLevelInstanceTracker::GetRendererOfSlot(uint32_t InSlot) const
+{
+	return SlotRenderers[InSlot];
+}
+
+double UHTopLevelInstanceTracker::GetSurfaceArea(const BoundingBox& InBound)
+{
+	// extents are the half size
+	const double X = InBound.Extents.x;
+	const double Y = InBound.Extents.y;
+	const double Z = InBound.Extents.z;
+	return 8.0 * (X * Y + Y * Z + Z * X);
+}
+
+double UHTopLevelInstanceTracker::GetRefitArea(const UHInstanceRecord& InRecord)
+{
+	BoundingBox Merged;
+	BoundingBox::CreateMerged(Merged, InRecord.BuildBound, InRecord.Bound);
+	return GetSurfaceArea(Merged);
+}
+
+VkAccelerationStructureInstanceKHR UHTopLevelInstanceTracker::GetSlotInstance(const UHInstanceRecord& InRecord)
+{
+	VkAccelerationStructureInstanceKHR Instance = InRecord.Instance;
+	if (InRecord.State == UHTopLevelInstanceState::Culled)
+	{
+		Instance.mask = 0;
+	}
+
+	return Instance;
+}
+
+void UHTopLevelInstanceTracker::MarkSlotDirty(uint32_t InSlot)
+{
+	if (DirtyFlags[InSlot] == 0)
+	{
+		DirtyFlags[InSlot] = 1;
+		DirtySlots.push_back(InSlot);
+	}
+}
+
+void UHTopLevelInstanceTracker::AddSlot(uint32_t InRendererIndex)
+{
+	// append to the end
+	UHInstanceRecord& Record = Records[InRendererIndex];
+	Record.Slot = static_cast<int32_t>(Instances.size());
+	Instances.push_back(GetSlotInstance(Record));
+	SlotRenderers.push_back(InRendererIndex);
+	MarkSlotDirty(Record.Slot);
+	PendingStats.NumAdded++;
+}
+
+void UHTopLevelInstanceTracker::RemoveSlot(uint32_t InRendererIndex)
+{
+	// move the last instance to the removed slot
+	UHInstanceRecord& Record = Records[InRendererIndex];
+	const uint32_t Slot = static_cast<uint32_t>(Record.Slot);
+	const uint32_t LastSlot = static_cast<uint32_t>(Instances.size() - 1);
+	if (Slot != LastSlot)
+	{
+		Instances[Slot] = Instances[LastSlot];
+		SlotRenderers[Slot] = SlotRenderers[LastSlot];
+		Records[SlotRenderers[Slot]].Slot = static_cast<int32_t>(Slot);
+		MarkSlotDirty(Slot);
+	}
+
+	Instances.pop_back();
+	SlotRenderers.pop_back();
+	Record.Slot = UHINDEXNONE;
+	PendingStats.NumRemoved++;
+}
+
+void UHTopLevelInstanceTracker::ApplyMembership()
+{
+	// drop the masked out instances first, then add all needed and nearby renderers which aren't in the AS
+	// this only runs when rebuilding, so scanning all renderers is fine
+	const uint32_t RendererCount = GetRendererCount();
+	for (uint32_t Idx = 0; Idx < RendererCount; Idx++)
+	{
+		if (Records[Idx].Slot != UHINDEXNONE && Records[Idx].State == UHTopLevelInstanceState::Culled)
+		{
+			RemoveSlot(Idx);
+		}
+	}
+
+	for (uint32_t Idx = 0; Idx < RendererCount; Idx++)
+	{
+		if (Records[Idx].Slot == UHINDEXNONE && Records[Idx].State != UHTopLevelInstanceState::Culled)
+		{
+			AddSlot(Idx);
+		}
+	}
+
+	NumMissingNeeded = 0;
+	NumMaskedSlots = 0;
+}
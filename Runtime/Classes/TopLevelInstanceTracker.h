@@ -0,0 +1,150 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+// a range of instance slots to upload
+struct UHTopLevelInstanceRange
+{
+	uint32_t FirstSlot;
+	uint32_t Count;
+};
+
+enum class UHTopLevelBuildMode
+{
+	None,
+	Refit,
+	Rebuild
+};
+
+// range state of a renderer against the ray tracing culling distance, see UHTopLevelInstanceTracker::GetRangeState()
+enum class UHTopLevelInstanceState
+{
+	Culled,
+	Nearby,
+	Needed
+};
+
+// instance churn of a frame, collected by UHTopLevelInstanceTracker::Commit()
+struct UHTopLevelInstanceStats
+{
+	UHTopLevelInstanceStats()
+		: NumInstances(0)
+		, NumAdded(0)
+		, NumRemoved(0)
+		, NumUpdated(0)
+		, NumMasked(0)
+		, NumUploadRanges(0)
+		, UploadBytes(0)
+		, NumRefitsSinceRebuild(0)
+		, RefitDegradation(0.0f)
+		, BuildMode(UHTopLevelBuildMode::None)
+	{
+
+	}
+
+	uint32_t NumInstances;
+	uint32_t NumAdded;
+	uint32_t NumRemoved;
+	uint32_t NumUpdated;
+	uint32_t NumMasked;
+	uint32_t NumUploadRanges;
+	uint32_t UploadBytes;
+	uint32_t NumRefitsSinceRebuild;
+	float RefitDegradation;
+	UHTopLevelBuildMode BuildMode;
+};
+
+// keeps the instances of a top-level AS compacted and tracks the slots to upload, it doesn't touch the device
+// renderers are indexed by their buffer data index, instances in the AS are packed in slots [0, GetInstanceCount())
+// removing an instance moves the last slot into its place, so only the moved slot needs an upload
+//
+// Vulkan refit requires the same instance count as the last build, so adding or removing instances always rebuilds
+// to keep a moving camera from rebuilding every frame, membership only changes when the AS is rebuilt:
+// - culled renderers are masked out in place, which a refit can do, and they're removed at the next rebuild
+// - nearby renderers are added along with a rebuild, so the camera can move for a while before a needed one is missing
+// - a rebuild is forced when a needed renderer is missing, or too many slots are masked out
+// otherwise a refit is chosen until the tree quality drops, the quality is estimated with world bounds of instances:
+// refit nodes have to cover where instances were built and where they are, so the degradation is
+// sum(area(union(build bound, current bound))) / sum(area(current bound)) - 1, it's 0 when nothing moves away
+class UHTopLevelInstanceTracker
+{
+public:
+	UHTopLevelInstanceTracker();
+
+	// reset with the number of renderers, all renderers are inactive until they're activated
+	void Reset(uint32_t InRendererCount);
+
+	// rebuild when the degradation exceeds InMaxDegradation, or after InMaxRefits refits, 0 refits means no periodic rebuild
+	// or when more than InMaxMaskedRatio of the instances are masked out
+	// dirty slots within InMaxRangeGap clean slots are merged into the same upload range
+	void SetRebuildPolicy(float InMaxDegradation, uint32_t InMaxRefits, float InMaxMaskedRatio, uint32_t InMaxRangeGap);
+
+	// set the instance and world bound of a renderer, it's fine to set the same instance as nothing will be marked dirty
+	void SetInstance(uint32_t InRendererIndex, const VkAccelerationStructureInstanceKHR& InInstance, const BoundingBox& InBound);
+
+	// set the range state of a renderer, needed renderers are always in the AS after Commit()
+	// nearby renderers stay in the AS or join at the next rebuild, culled ones are masked out until the next rebuild
+	void SetState(uint32_t InRendererIndex, UHTopLevelInstanceState InState);
+
+	// the range state with hysteresis, renderers within NearbyScale times the culling distance are nearby
+	static UHTopLevelInstanceState GetRangeState(bool bInVisible, float InSquareDistance, float InCullingDistance);
+	static constexpr float NearbyScale = 1.25f;
+
+	// finish the changes of a frame, decide the build mode and collect dirty ranges and stats
+	void Commit();
+
+	const std::vector<VkAccelerationStructureInstanceKHR>& GetInstances() const;
+	const std::vector<UHTopLevelInstanceRange>& GetDirtyRanges() const;
+	const UHTopLevelInstanceStats& GetStats() const;
+	uint32_t GetInstanceCount() const;
+	uint32_t GetRendererCount() const;
+	int32_t GetSlotOfRenderer(uint32_t InRendererIndex) const;
+	uint32_t GetRendererOfSlot(uint32_t InSlot) const;
+
+private:
+	struct UHInstanceRecord
+	{
+		VkAccelerationStructureInstanceKHR Instance;
+		BoundingBox Bound;
+		BoundingBox BuildBound;
+		int32_t Slot;
+		UHTopLevelInstanceState State;
+	};
+
+	static double GetSurfaceArea(const BoundingBox& InBound);
+	static double GetRefitArea(const UHInstanceRecord& InRecord);
+	static VkAccelerationStructureInstanceKHR GetSlotInstance(const UHInstanceRecord& InRecord);
+	void MarkSlotDirty(uint32_t InSlot);
+	void AddSlot(uint32_t InRendererIndex);
+	void RemoveSlot(uint32_t InRendererIndex);
+	void ApplyMembership();
+
+	std::vector<UHInstanceRecord> Records;
+	std::vector<VkAccelerationStructureInstanceKHR> Instances;
+	std::vector<uint32_t> SlotRenderers;
+
+	// dirty slots of this frame, the flags prevent duplicate slots in the list
+	std::vector<uint32_t> DirtySlots;
+	std::vector<uint8_t> DirtyFlags;
+	std::vector<UHTopLevelInstanceRange> DirtyRanges;
+
+	// area sums of instances in the AS since the last build
+	double RefitArea;
+	double LeafArea;
+	uint32_t NumRefitsSinceRebuild;
+
+	// needed renderers which aren't in the AS, and culled ones which are still in the AS
+	uint32_t NumMissingNeeded;
+	uint32_t NumMaskedSlots;
+
+	float MaxDegradation;
+	uint32_t MaxRefits;
+	float MaxMaskedRatio;
+	uint32_t MaxRangeGap;
+
+	// counters of the frame in progress, they're moved to stats when committing
+	UHTopLevelInstanceStats PendingStats;
+	UHTopLevelInstanceStats Stats;
+};
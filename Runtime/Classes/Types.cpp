@@ -1,4 +1,7 @@
 #include "Types.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 // https://learn.microsoft.com/en-us/windows/win32/dxmath/pg-xnamath-getting-started#type-usage-guidelines
 // according to type usage guidelines from Microsoft, it's suggested to do computation with XMVECTOR/XMMATRIX
@@ -229,6 +232,39 @@ namespace MathHelpers
     {
         return std::roundf(InVal / InMultiple) * InMultiple;
     }
+
+    int32_t CountTrailingZeros(uint32_t InVal)
+    {
+#if defined(_MSC_VER)
+        unsigned long Index;
+        _BitScanForward(&Index, InVal);
+        return static_cast<int32_t>(Index);
+#else
+        return __builtin_ctz(InVal);
+#endif
+    }
+
+    int32_t CountTrailingZeros64(uint64_t InVal)
+    {
+#if defined(_MSC_VER)
+        unsigned long Index;
+        _BitScanForward64(&Index, InVal);
+        return static_cast<int32_t>(Index);
+#else
+        return __builtin_ctzll(InVal);
+#endif
+    }
+
+    int32_t FindMostSignificantBit64(uint64_t InVal)
+    {
+#if defined(_MSC_VER)
+        unsigned long Index;
+        _BitScanReverse64(&Index, InVal);
+        return static_cast<int32_t>(Index);
+#else
+        return 63 - __builtin_clzll(InVal);
+#endif
+    }
 }
 
 // operator for XMFLOAT3 multipication
@@ -77,6 +77,13 @@ namespace MathHelpers
     }
 
     float RoundUpToMultiple(float InVal, float InMultiple);
+
+    // index of the lowest set bit, the input must not be zero
+    int32_t CountTrailingZeros(uint32_t InVal);
+    int32_t CountTrailingZeros64(uint64_t InVal);
+
+    // index of the highest set bit, the input must not be zero
+    int32_t FindMostSignificantBit64(uint64_t InVal);
 }
 
 // operator for XMFLOAT3 multipication
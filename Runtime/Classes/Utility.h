@@ -258,6 +258,13 @@ namespace UHUtilities
 		// no value found, the OutValue will remain the same
 	}
 
+	// combine the hash of a value into the seed, same as boost::hash_combine
+	template<typename T>
+	inline void HashCombine(size_t& InOutSeed, const T& InValue)
+	{
+		InOutSeed ^= std::hash<T>()(InValue) + 0x9e3779b97f4a7c15ull + (InOutSeed << 6) + (InOutSeed >> 2);
+	}
+
 	// djb2 string to hash, reference: http://www.cse.yorku.ca/~oz/hash.html
 	size_t StringToHash(std::string InString);
 
@@ -0,0 +1,210 @@
+#include "VertexCompression.h"
+#include <DirectXPackedVector.h>
+
+namespace UHVertexCompression
+{
+	float SignNotZero(float InValue)
+	{
+		return (InValue >= 0.0f) ? 1.0f : -1.0f;
+	}
+
+	// map a unit vector to [-1,1]^2 with octahedral projection
+	XMFLOAT2 OctEncode(const XMFLOAT3& InDir)
+	{
+		const float L1 = std::abs(InDir.x) + std::abs(InDir.y) + std::abs(InDir.z);
+		if (L1 <= GEpsilon)
+		{
+			return XMFLOAT2(0.0f, 0.0f);
+		}
+
+		XMFLOAT2 Result(InDir.x / L1, InDir.y / L1);
+		if (InDir.z < 0.0f)
+		{
+			// fold the lower hemisphere over the diagonals
+			const XMFLOAT2 Folded((1.0f - std::abs(Result.y)) * SignNotZero(Result.x), (1.0f - std::abs(Result.x)) * SignNotZero(Result.y));
+			Result = Folded;
+		}
+
+		return Result;
+	}
+
+	XMFLOAT3 OctDecode(const XMFLOAT2& InEncoded)
+	{
+		XMFLOAT3 Dir(InEncoded.x, InEncoded.y, 1.0f - std::abs(InEncoded.x) - std::abs(InEncoded.y));
+		const float T = (std::max)(-Dir.z, 0.0f);
+		Dir.x += (Dir.x >= 0.0f) ? -T : T;
+		Dir.y += (Dir.y >= 0.0f) ? -T : T;
+
+		XMStoreFloat3(&Dir, XMVector3Normalize(XMLoadFloat3(&Dir)));
+		return Dir;
+	}
+
+	// snorm quantization with the given bits, the result is stored in the lowest bits
+	uint32_t QuantizeSnorm(float InValue, uint32_t InBits)
+	{
+		const float Scale = static_cast<float>((1 << (InBits - 1)) - 1);
+		const int32_t Quantized = static_cast<int32_t>(std::round(std::clamp(InValue, -1.0f, 1.0f) * Scale));
+		return static_cast<uint32_t>(Quantized) & ((1u << InBits) - 1);
+	}
+
+	float DequantizeSnorm(uint32_t InValue, uint32_t InBits)
+	{
+		// sign extend before scaling
+		const int32_t Shift = 32 - static_cast<int32_t>(InBits);
+		const int32_t Signed = static_cast<int32_t>(InValue << Shift) >> Shift;
+		const float Scale = static_cast<float>((1 << (InBits - 1)) - 1);
+		return (std::max)(static_cast<float>(Signed) / Scale, -1.0f);
+	}
+
+	// atan2 keeps the precision for small angles, which acos doesn't
+	float AngleBetween(const XMFLOAT3& InA, const XMFLOAT3& InB)
+	{
+		const XMVECTOR A = XMLoadFloat3(&InA);
+		const XMVECTOR B = XMLoadFloat3(&InB);
+		const float CrossLength = std::sqrt(XMVectorGetX(XMVector3LengthSq(XMVector3Cross(A, B))));
+		return std::atan2(CrossLength, XMVectorGetX(XMVector3Dot(A, B)));
+	}
+
+	XMUINT2 EncodePosition(const XMFLOAT3& InPosition, const BoundingBox& InBound)
+	{
+		// flat axes are stored as zero and decoded to the center
+		const float P[3] = { InPosition.x - InBound.Center.x, InPosition.y - InBound.Center.y, InPosition.z - InBound.Center.z };
+		const float E[3] = { InBound.Extents.x, InBound.Extents.y, InBound.Extents.z };
+		uint32_t Q[3];
+		for (int32_t Idx = 0; Idx < 3; Idx++)
+		{
+			Q[Idx] = (E[Idx] > 0.0f) ? QuantizeSnorm(P[Idx] / E[Idx], 16) : 0;
+		}
+
+		return XMUINT2(Q[0] | (Q[1] << 16), Q[2]);
+	}
+
+	XMFLOAT3 DecodePosition(const XMUINT2& InPacked, const BoundingBox& InBound)
+	{
+		return XMFLOAT3(DequantizeSnorm(InPacked.x & 0xffff, 16) * InBound.Extents.x + InBound.Center.x
+			, DequantizeSnorm(InPacked.x >> 16, 16) * InBound.Extents.y + InBound.Center.y
+			, DequantizeSnorm(InPacked.y & 0xffff, 16) * InBound.Extents.z + InBound.Center.z);
+	}
+
+	uint32_t EncodeHalf2(const XMFLOAT2& InValue)
+	{
+		return static_cast<uint32_t>(PackedVector::XMConvertFloatToHalf(InValue.x))
+			| (static_cast<uint32_t>(PackedVector::XMConvertFloatToHalf(InValue.y)) << 16);
+	}
+
+	XMFLOAT2 DecodeHalf2(uint32_t InPacked)
+	{
+		return XMFLOAT2(PackedVector::XMConvertHalfToFloat(static_cast<PackedVector::HALF>(InPacked & 0xffff))
+			, PackedVector::XMConvertHalfToFloat(static_cast<PackedVector::HALF>(InPacked >> 16)));
+	}
+
+	uint32_t EncodeOctNormal(const XMFLOAT3& InNormal)
+	{
+		const XMFLOAT2 Oct = OctEncode(InNormal);
+		return QuantizeSnorm(Oct.x, 16) | (QuantizeSnorm(Oct.y, 16) << 16);
+	}
+
+	XMFLOAT3 DecodeOctNormal(uint32_t InPacked)
+	{
+		return OctDecode(XMFLOAT2(DequantizeSnorm(InPacked & 0xffff, 16), DequantizeSnorm(InPacked >> 16, 16)));
+	}
+
+	uint32_t EncodeOctTangent(const XMFLOAT4& InTangent)
+	{
+		const XMFLOAT2 Oct = OctEncode(XMFLOAT3(InTangent.x, InTangent.y, InTangent.z));
+		const uint32_t SignBit = (InTangent.w < 0.0f) ? 1u : 0u;
+		return QuantizeSnorm(Oct.x, 16) | (QuantizeSnorm(Oct.y, 15) << 16) | (SignBit << 31);
+	}
+
+	XMFLOAT4 DecodeOctTangent(uint32_t InPacked)
+	{
+		const XMFLOAT3 Dir = OctDecode(XMFLOAT2(DequantizeSnorm(InPacked & 0xffff, 16), DequantizeSnorm((InPacked >> 16) & 0x7fff, 15)));
+		return XMFLOAT4(Dir.x, Dir.y, Dir.z, (InPacked >> 31) ? -1.0f : 1.0f);
+	}
+
+	void EncodePositionStream(const std::vector<XMFLOAT3>& InPositions, const BoundingBox& InBound, std::vector<uint32_t>& OutPacked)
+	{
+		OutPacked.resize(InPositions.size() * 2);
+		for (size_t Idx = 0; Idx < InPositions.size(); Idx++)
+		{
+			const XMUINT2 Packed = EncodePosition(InPositions[Idx], InBound);
+			OutPacked[Idx * 2] = Packed.x;
+			OutPacked[Idx * 2 + 1] = Packed.y;
+		}
+	}
+
+	void EncodeUV0Stream(const std::vector<XMFLOAT2>& InUV0, std::vector<uint32_t>& OutPacked)
+	{
+		OutPacked.resize(InUV0.size());
+		for (size_t Idx = 0; Idx < InUV0.size(); Idx++)
+		{
+			OutPacked[Idx] = EncodeHalf2(InUV0[Idx]);
+		}
+	}
+
+	void EncodeNormalStream(const std::vector<XMFLOAT3>& InNormals, std::vector<uint32_t>& OutPacked)
+	{
+		OutPacked.resize(InNormals.size());
+		for (size_t Idx = 0; Idx < InNormals.size(); Idx++)
+		{
+			OutPacked[Idx] = EncodeOctNormal(InNormals[Idx]);
+		}
+	}
+
+	void EncodeTangentStream(const std::vector<XMFLOAT4>& InTangents, std::vector<uint32_t>& OutPacked)
+	{
+		OutPacked.resize(InTangents.size());
+		for (size_t Idx = 0; Idx < InTangents.size(); Idx++)
+		{
+			OutPacked[Idx] = EncodeOctTangent(InTangents[Idx]);
+		}
+	}
+
+	UHVertexCompressionError MeasureError(const std::vector<XMFLOAT3>& InPositions, const BoundingBox& InBound, const std::vector<XMFLOAT2>& InUV0
+		, const std::vector<XMFLOAT3>& InNormals, const std::vector<XMFLOAT4>& InTangents)
+	{
+		UHVertexCompressionError Error;
+
+		for (const XMFLOAT3& P : InPositions)
+		{
+			const XMFLOAT3 Decoded = DecodePosition(EncodePosition(P, InBound), InBound);
+			const float DX = std::abs(Decoded.x - P.x) / (std::max)(InBound.Extents.x, GEpsilon);
+			const float DY = std::abs(Decoded.y - P.y) / (std::max)(InBound.Extents.y, GEpsilon);
+			const float DZ = std::abs(Decoded.z - P.z) / (std::max)(InBound.Extents.z, GEpsilon);
+			Error.MaxPositionError = (std::max)(Error.MaxPositionError, (std::max)((std::max)(DX, DY), DZ));
+		}
+
+		for (const XMFLOAT2& UV : InUV0)
+		{
+			const XMFLOAT2 Decoded = DecodeHalf2(EncodeHalf2(UV));
+			const float Scale = (std::max)((std::max)(std::abs(UV.x), std::abs(UV.y)), 1.0f);
+			Error.MaxUVError = (std::max)(Error.MaxUVError, (std::max)(std::abs(Decoded.x - UV.x), std::abs(Decoded.y - UV.y)) / Scale);
+		}
+
+		for (const XMFLOAT3& N : InNormals)
+		{
+			if (MathHelpers::IsVectorNearlyZero(N))
+			{
+				continue;
+			}
+			Error.MaxNormalAngle = (std::max)(Error.MaxNormalAngle, AngleBetween(N, DecodeOctNormal(EncodeOctNormal(N))));
+		}
+
+		for (const XMFLOAT4& T : InTangents)
+		{
+			const XMFLOAT3 Dir(T.x, T.y, T.z);
+			const XMFLOAT4 Decoded = DecodeOctTangent(EncodeOctTangent(T));
+			if (!MathHelpers::IsVectorNearlyZero(Dir))
+			{
+				Error.MaxTangentAngle = (std::max)(Error.MaxTangentAngle, AngleBetween(Dir, XMFLOAT3(Decoded.x, Decoded.y, Decoded.z)));
+			}
+
+			if ((T.w < 0.0f) != (Decoded.w < 0.0f))
+			{
+				Error.NumTangentSignMismatch++;
+			}
+		}
+
+		return Error;
+	}
+}
\ No newline at end of file
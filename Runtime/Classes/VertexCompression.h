@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+// vertex format of Position/UV0/Normal/Tangent streams, this needs to sync with UH_VERTEX_FORMAT defines in UHCommon.hlsli
+// Full: float3 position, float2 UV0, float3 normal, float4 tangent (48 bytes)
+// Compressed: 4x16-bit snorm position relative to the mesh bound (the last component is unused), half2 UV0
+// , octahedral normal in 2x16-bit snorm, octahedral tangent in 16-bit + 15-bit snorm with the sign bit (20 bytes)
+enum class UHVertexFormat
+{
+	Full = 0,
+	Compressed,
+	VertexFormatMax
+};
+
+// measured max error of a compressed vertex stream
+struct UHVertexCompressionError
+{
+	UHVertexCompressionError()
+		: MaxPositionError(0.0f)
+		, MaxUVError(0.0f)
+		, MaxNormalAngle(0.0f)
+		, MaxTangentAngle(0.0f)
+		, NumTangentSignMismatch(0)
+	{
+
+	}
+
+	// position error is relative to the bound extent of each axis
+	float MaxPositionError;
+	float MaxUVError;
+	float MaxNormalAngle;
+	float MaxTangentAngle;
+	uint32_t NumTangentSignMismatch;
+};
+
+namespace UHVertexCompression
+{
+	// error bounds of the encoding, in radians for directions
+	// position error is relative to the bound extent, which is half a 16-bit snorm step plus float rounding
+	// UV error is relative to the UV value since half float has 11-bit mantissa
+	const float GMaxSnormPositionError = 1.0f / 32767.0f;
+	const float GMaxOctNormalAngle = 0.0001f;
+	const float GMaxOctTangentAngle = 0.0002f;
+	const float GMaxHalfUVRelativeError = 1.0f / 2048.0f;
+
+	// position is quantized relative to the bound, the bound must be the same when decoding
+	XMUINT2 EncodePosition(const XMFLOAT3& InPosition, const BoundingBox& InBound);
+	XMFLOAT3 DecodePosition(const XMUINT2& InPacked, const BoundingBox& InBound);
+
+	uint32_t EncodeHalf2(const XMFLOAT2& InValue);
+	XMFLOAT2 DecodeHalf2(uint32_t InPacked);
+
+	// normal is expected to be normalized, zero vector is encoded as +z
+	uint32_t EncodeOctNormal(const XMFLOAT3& InNormal);
+	XMFLOAT3 DecodeOctNormal(uint32_t InPacked);
+
+	// the bitangent sign (w) is stored in the highest bit
+	uint32_t EncodeOctTangent(const XMFLOAT4& InTangent);
+	XMFLOAT4 DecodeOctTangent(uint32_t InPacked);
+
+	// two uints are stored per position
+	void EncodePositionStream(const std::vector<XMFLOAT3>& InPositions, const BoundingBox& InBound, std::vector<uint32_t>& OutPacked);
+	void EncodeUV0Stream(const std::vector<XMFLOAT2>& InUV0, std::vector<uint32_t>& OutPacked);
+	void EncodeNormalStream(const std::vector<XMFLOAT3>& InNormals, std::vector<uint32_t>& OutPacked);
+	void EncodeTangentStream(const std::vector<XMFLOAT4>& InTangents, std::vector<uint32_t>& OutPacked);
+
+	// encode and decode all streams, and return the max error against the source data
+	UHVertexCompressionError MeasureError(const std::vector<XMFLOAT3>& InPositions, const BoundingBox& InBound, const std::vector<XMFLOAT2>& InUV0
+		, const std::vector<XMFLOAT3>& InNormals, const std::vector<XMFLOAT4>& InTangents);
+}
\ No newline at end of file
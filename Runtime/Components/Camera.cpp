@@ -265,6 +265,21 @@ BoundingBox UHCameraComponent::GetScreenBound(BoundingBox InWorldBound) const
 	return Result;
 }
 
+XMFLOAT3 UHCameraComponent::GetRayDirection(float InNDCX, float InNDCY) const
+{
+	// normalized direction through the [-1,1] NDC position, +Y of NDC is down as the view matrix flips the up vector
+	// the screen right is the same as the right axis of the view matrix
+	const float TanHalfFov = std::tan(FovY * 0.5f);
+	const XMVECTOR F = XMLoadFloat3(&Forward);
+	const XMVECTOR U = XMLoadFloat3(&Up);
+	const XMVECTOR R = XMVector3Cross(U, F);
+	const XMVECTOR Dir = F + R * (InNDCX * TanHalfFov * Aspect) - U * (InNDCY * TanHalfFov);
+
+	XMFLOAT3 Result;
+	XMStoreFloat3(&Result, XMVector3Normalize(Dir));
+	return Result;
+}
+
 float UHCameraComponent::GetCullingDistance() const
 {
 	return CullingDistance;
@@ -33,6 +33,7 @@ public:
 	BoundingFrustum GetBoundingFrustum() const;
 	XMFLOAT3 GetScreenPos(XMFLOAT3 InWorld) const;
 	BoundingBox GetScreenBound(BoundingBox InWorldBound) const;
+	XMFLOAT3 GetRayDirection(float InNDCX, float InNDCY) const;
 	float GetCullingDistance() const;
 	float GetNearPlane() const;
 
@@ -113,6 +113,12 @@ void UHMeshRendererComponent::OnLoad(std::ifstream& InStream)
 	InStream.read(reinterpret_cast<char*>(&MaterialId), sizeof(MaterialId));
 }
 
+void UHMeshRendererComponent::OnPreloadAssets(UHAssetManager* InAssetMgr)
+{
+	InAssetMgr->GetAssetAsync(MeshId, UHAssetLoadPriority::High);
+	InAssetMgr->GetAssetAsync(MaterialId, UHAssetLoadPriority::High);
+}
+
 void UHMeshRendererComponent::OnPostLoad(UHAssetManager* InAssetMgr)
 {
 	SetMesh((UHMesh*)InAssetMgr->GetAsset(MeshId));
@@ -133,15 +139,11 @@ void UHMeshRendererComponent::SetMaterial(UHMaterial* InMaterial)
 	}
 }
 
-void UHMeshRendererComponent::CalculateSquareDistanceToCamera(const XMFLOAT3 Position)
+void UHMeshRendererComponent::SetSquareDistanceToMainCam(const float InSquareDistance, const bool bInCameraInside)
 {
-	// this roughly does the calculation with the center point of a bound
-	// to have more precise result, find the closest point on a bound first
-	const XMFLOAT3 Center = GetRendererBound().Center;
-	SquareDistanceToMainCam = MathHelpers::VectorDistanceSqr(Center, Position);
-
-	// check if the camera is inside this renderer bound
-	bIsCameraInsideBound = RendererBound.Contains(XMLoadFloat3(&Position));
+	// the distance is calculated with the center point of a bound during frustum culling
+	SquareDistanceToMainCam = InSquareDistance;
+	bIsCameraInsideBound = bInCameraInside;
 }
 
 UHMesh* UHMeshRendererComponent::GetMesh() const
@@ -164,6 +166,13 @@ UHObjectConstants UHMeshRendererComponent::GetConstants() const
 	CB.InstanceIndex = GetBufferDataIndex();
 	CB.WorldPos = RendererBound.Center;
 	CB.BoundExtent = RendererBound.Extents;
+	CB.VertexFormat = (MeshCache) ? UH_ENUM_VALUE_U(MeshCache->GetVertexFormat()) : UH_ENUM_VALUE_U(UHVertexFormat::Full);
+	if (MeshCache)
+	{
+		const BoundingBox MeshBound = MeshCache->GetMeshBound();
+		CB.MeshBoundCenter = MeshBound.Center;
+		CB.MeshBoundExtent = MeshBound.Extents;
+	}
 
 	return CB;
 }
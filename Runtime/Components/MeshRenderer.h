@@ -15,11 +15,12 @@ public:
 	virtual void Update() override;
 	virtual void OnSave(std::ofstream& OutStream) override;
 	virtual void OnLoad(std::ifstream& InStream) override;
+	virtual void OnPreloadAssets(UHAssetManager* InAssetMgr) override;
 	virtual void OnPostLoad(UHAssetManager* InAssetMgr) override;
 
 	void SetMesh(UHMesh* InMesh);
 	void SetMaterial(UHMaterial* InMaterial);
-	void CalculateSquareDistanceToCamera(const XMFLOAT3 Position);
+	void SetSquareDistanceToMainCam(const float InSquareDistance, const bool bInCameraInside);
 
 	UHMesh* GetMesh() const;
 	UHMaterial* GetMaterial() const;
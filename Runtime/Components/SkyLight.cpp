@@ -50,6 +50,11 @@ void UHSkyLightComponent::OnLoad(std::ifstream& InStream)
 	InStream.read(reinterpret_cast<char*>(&CubemapId), sizeof(CubemapId));
 }
 
+void UHSkyLightComponent::OnPreloadAssets(UHAssetManager* InAssetMgr)
+{
+	InAssetMgr->GetAssetAsync(CubemapId, UHAssetLoadPriority::High);
+}
+
 void UHSkyLightComponent::OnPostLoad(UHAssetManager* InAssetMgr)
 {
 	CubemapCache = (UHTextureCube*)InAssetMgr->GetAsset(CubemapId);
@@ -12,6 +12,7 @@ public:
 	UHSkyLightComponent();
 	virtual void OnSave(std::ofstream& OutStream) override;
 	virtual void OnLoad(std::ifstream& InStream) override;
+	virtual void OnPreloadAssets(UHAssetManager* InAssetMgr) override;
 	virtual void OnPostLoad(UHAssetManager* InAssetMgr) override;
 
 	void SetSkyColor(XMFLOAT3 InColor);
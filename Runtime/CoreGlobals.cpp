@@ -10,6 +10,7 @@ bool GIsShipping = false;
 bool GIsEditor = false;
 bool GIsShipping = true;
 #endif
+bool GEnableTextureStreaming = false;
 
 // the starting core of threads
 const uint32_t GMainThreadAffinity = 0;
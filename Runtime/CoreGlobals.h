@@ -16,4 +16,7 @@ static const uint32_t GMaxWorkerThreads = 16;
 
 extern std::thread::id GMainThreadID;
 extern bool GIsEditor;
-extern bool GIsShipping;
\ No newline at end of file
+extern bool GIsShipping;
+
+// set at engine initialization, textures only load their mip tail at import and the rest is streamed by UHTextureStreamer
+extern bool GEnableTextureStreaming;
\ No newline at end of file
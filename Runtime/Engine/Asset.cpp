@@ -11,12 +11,43 @@
 UHAssetManager* UHAssetManager::AssetMgrEditorOnly = nullptr;
 #endif
 
+// key of pending loads, so the same file requested with different separators is loaded once
+inline std::string ToAssetLoadKey(const std::filesystem::path& InPath)
+{
+	return UHAssetPathTable::Normalize(InPath);
+}
+
+inline UHAssetType GetAssetTypeByExtension(const std::string& InExtension)
+{
+	if (InExtension == GMeshAssetExtension)
+	{
+		return UHAssetType::Mesh;
+	}
+	else if (InExtension == GTextureAssetExtension)
+	{
+		return UHAssetType::Texture2D;
+	}
+	else if (InExtension == GCubemapAssetExtension)
+	{
+		return UHAssetType::Cubemap;
+	}
+	else if (InExtension == GMaterialAssetExtension)
+	{
+		return UHAssetType::Material;
+	}
+
+	return UHAssetType::Unknown;
+}
+
 UHAssetManager::UHAssetManager()
+	: LoadSequence(0)
+	, NumInFlightLoads(0)
 {
 #if WITH_EDITOR
 	// load shader cache after initialization
 	UHShaderImporterInterface = MakeUnique<UHShaderImporter>();
 	UHShaderImporterInterface->LoadShaderCache();
+	UHShaderImporterInterface->RecompileCachedShaders();
 	UHShaderImporterInterface->CompileHLSL("FallbackPixelShader", GRawShaderPath + "FallbackPixelShader.hlsl", "FallbackPS", "ps_6_0", std::vector<std::string>());
 
 	UHMaterialImporterInterface = MakeUnique<UHMaterialImporter>();
@@ -35,17 +66,24 @@ UHAssetManager::UHAssetManager()
 		size_t NumAssets;
 		FileIn.read(reinterpret_cast<char*>(&NumAssets), sizeof(NumAssets));
 
-		AllAssetsMap.resize(NumAssets);
+		AssetRegistry.Reserve(NumAssets);
 		for (size_t Idx = 0; Idx < NumAssets; Idx++)
 		{
-			FileIn.read(reinterpret_cast<char*>(&AllAssetsMap[Idx].AssetUUid), sizeof(AllAssetsMap[Idx].AssetUUid));
-			UHUtilities::ReadStringData(FileIn, AllAssetsMap[Idx].FilePath);
+			UUID AssetUuid;
+			std::string FilePath;
+			FileIn.read(reinterpret_cast<char*>(&AssetUuid), sizeof(AssetUuid));
+			UHUtilities::ReadStringData(FileIn, FilePath);
+			AssetRegistry.Add(AssetUuid, FilePath, nullptr);
 		}
 	}
 	FileIn.close();
 #endif
 
 	GfxCache = nullptr;
+
+	// loading workers, reading files is mostly IO bound so it doesn't share the workers with renderer
+	LoadingJobSystem = MakeUnique<UHJobSystem>();
+	LoadingJobSystem->Initialize((std::max)(static_cast<int32_t>(std::thread::hardware_concurrency()) / 2, 2));
 }
 
 void UHAssetManager::SetGfxCache(UHGraphic* InGfx)
@@ -63,12 +101,16 @@ void UHAssetManager::ImportBuiltInAssets()
 		{
 			continue;
 		}
-		ImportAsset(Idx->path());
+		ImportAssetAsync(Idx->path(), UHAssetLoadPriority::High);
 	}
+	WaitAsyncLoads();
 }
 
 void UHAssetManager::Release()
 {
+	// don't release while the workers are still reading into the assets
+	WaitAsyncLoads();
+
 	// release meshes
 	for (auto& Mesh : UHMeshes)
 	{
@@ -94,10 +136,7 @@ void UHAssetManager::Release()
 		GfxCache->RequestReleaseMaterial(Mat);
 	}
 
-	for (UHAssetMap& Map : AllAssetsMap)
-	{
-		Map.Asset = nullptr;
-	}
+	AssetRegistry.ResetAssets();
 
 	// container cleanup
 	ClearAssetCaches();
@@ -109,14 +148,15 @@ void UHAssetManager::TranslateHLSL(std::string InShaderName, std::filesystem::pa
 #if WITH_EDITOR
 	UHMaterial* InMat = InData.MaterialCache;
 	UHMaterialCompileFlag CompileFlag = InMat->GetCompileFlag();
+	const bool bTemplateCached = UHShaderImporterInterface->IsShaderTemplateCached(InSource, EntryName, ProfileName);
 
 	if (CompileFlag == UHMaterialCompileFlag::FullCompileTemporary
 		|| CompileFlag == UHMaterialCompileFlag::FullCompileResave
 		|| !UHMaterialImporterInterface->IsMaterialCached(InMat, InShaderName, Defines)
-		|| !UHShaderImporterInterface->IsShaderTemplateCached(InSource, EntryName, ProfileName))
+		|| !bTemplateCached)
 	{
-		// mark as include changed when necessary
-		if (!UHShaderImporterInterface->IsShaderIncludeCached() && CompileFlag == UHMaterialCompileFlag::UpToDate)
+		// mark as include changed when the template or any of its includes is changed
+		if (!bTemplateCached && CompileFlag == UHMaterialCompileFlag::UpToDate)
 		{
 			InMat->SetCompileFlag(UHMaterialCompileFlag::IncludeChanged);
 		}
@@ -147,103 +187,91 @@ void UHAssetManager::ClearAssetCaches()
 	UHMaterialsCache.clear();
 	UHTexture2Ds.clear();
 	ReferencedTexture2Ds.clear();
+	ReferencedTextureSlots.clear();
 	UHCubemaps.clear();
+
+	MeshByName.Clear();
+	MeshBySourcePath.Clear();
+	MaterialByName.Clear();
+	TextureByName.Clear();
+	TextureBySourcePath.Clear();
+	CubemapByName.Clear();
+	CubemapBySourcePath.Clear();
 }
 
-UHObject* UHAssetManager::ImportMesh(std::filesystem::path InPath)
+UHObject* UHAssetManager::RegisterMesh(UniquePtr<UHMesh>& InMesh, std::filesystem::path InPath)
 {
-	UHObject* Result = nullptr;
-	UniquePtr<UHMesh> LoadedMesh = MakeUnique<UHMesh>();
-
-	if (LoadedMesh->Import(InPath))
+	UHMesh* LoadedMesh = InMesh.get();
+	UHMeshesCache.push_back(LoadedMesh);
+	MeshByName.Add(LoadedMesh->GetName(), LoadedMesh);
+	MeshBySourcePath.Add(UHAssetPathTable::Normalize(LoadedMesh->GetSourcePath()), LoadedMesh);
+	if (GIsEditor)
 	{
-		UHMeshesCache.push_back(LoadedMesh.get());
-		if (GIsEditor)
-		{
-			AllAssetsMap.push_back(UHAssetMap(LoadedMesh.get(), InPath.string()));
-		}
-
-		Result = LoadedMesh.get();
-		UHMeshes.push_back(std::move(LoadedMesh));
+		AssetRegistry.Add(LoadedMesh->GetRuntimeGuid(), InPath, LoadedMesh);
 	}
 
-	return Result;
+	UHMeshes.push_back(std::move(InMesh));
+	return LoadedMesh;
 }
 
-UHObject* UHAssetManager::ImportTexture(std::filesystem::path InPath)
+UHObject* UHAssetManager::RegisterTexture(UniquePtr<UHTexture2D>& InTexture, std::filesystem::path InPath)
 {
-	UHObject* Result = nullptr;
-	UniquePtr<UHTexture2D> LoadedTex = MakeUnique<UHTexture2D>();
-
-	if (LoadedTex->Import(InPath))
+	// import successfully, request texture 2d from GFX
+	UHTexture2D* NewTex = GfxCache->RequestTexture2D(InTexture, true);
+	if (NewTex == nullptr)
 	{
-		// import successfully, request texture 2d from GFX
-		UHTexture2D* NewTex = GfxCache->RequestTexture2D(LoadedTex, true);
-		UHTexture2Ds.push_back(NewTex);
-		if (GIsEditor)
-		{
-			AllAssetsMap.push_back(UHAssetMap(NewTex, InPath.string()));
-		}
+		return nullptr;
+	}
 
-		Result = NewTex;
+	UHTexture2Ds.push_back(NewTex);
+	TextureByName.Add(NewTex->GetName(), NewTex);
+	TextureBySourcePath.Add(UHAssetPathTable::Normalize(NewTex->GetSourcePath()), NewTex);
+	if (GIsEditor)
+	{
+		AssetRegistry.Add(NewTex->GetRuntimeGuid(), InPath, NewTex);
 	}
 
-	return Result;
+	return NewTex;
 }
 
-UHObject* UHAssetManager::ImportCubemap(std::filesystem::path InPath)
+UHObject* UHAssetManager::RegisterCubemap(UniquePtr<UHTextureCube>& InCube, std::filesystem::path InPath)
 {
-	UHObject* Result = nullptr;
-	UniquePtr<UHTextureCube> LoadedCube = MakeUnique<UHTextureCube>();
-
-	if (LoadedCube->Import(InPath))
+	// import successfully, request texture cube from GFX
+	UHTextureCube* NewCube = GfxCache->RequestTextureCube(InCube);
+	if (NewCube == nullptr)
 	{
-		// import successfully, request texture cube from GFX
-		UHTextureInfo Info{};
-		Info.Format = LoadedCube->GetFormat();
-		Info.Extent = LoadedCube->GetExtent();
-
-		UHTextureCube* NewCube = GfxCache->RequestTextureCube(LoadedCube);
-		UHCubemaps.push_back(NewCube);
-		if (GIsEditor)
-		{
-			AllAssetsMap.push_back(UHAssetMap(NewCube, InPath.string()));
-		}
+		return nullptr;
+	}
 
-		Result = NewCube;
+	UHCubemaps.push_back(NewCube);
+	CubemapByName.Add(NewCube->GetName(), NewCube);
+	CubemapBySourcePath.Add(UHAssetPathTable::Normalize(NewCube->GetSourcePath()), NewCube);
+	if (GIsEditor)
+	{
+		AssetRegistry.Add(NewCube->GetRuntimeGuid(), InPath, NewCube);
 	}
 
-	return Result;
+	return NewCube;
 }
 
-UHObject* UHAssetManager::ImportMaterial(std::filesystem::path InPath)
+UHObject* UHAssetManager::RegisterMaterial(UHMaterial* InMat, std::filesystem::path InPath)
 {
-	return AddImportedMaterial(InPath);
-}
+	// it's also important to update the texture references after material is imported
+	MapTextureIndex(InMat);
 
-UHObject* UHAssetManager::ImportAsset(std::filesystem::path InPath)
-{
-	UHObject* Result = nullptr;
-	const std::string Extension = InPath.extension().string();
-
-	if (Extension == GMeshAssetExtension)
-	{
-		Result = ImportMesh(InPath);
-	}
-	else if (Extension == GTextureAssetExtension)
-	{
-		Result = ImportTexture(InPath);
-	}
-	else if (Extension == GCubemapAssetExtension)
-	{
-		Result = ImportCubemap(InPath);
-	}
-	else if (Extension == GMaterialAssetExtension)
+	UHMaterialsCache.push_back(InMat);
+	MaterialByName.Add(InMat->GetName(), InMat);
+	if (GIsEditor)
 	{
-		Result = ImportMaterial(InPath);
+		AssetRegistry.Add(InMat->GetRuntimeGuid(), InPath, InMat);
 	}
 
-	return Result;
+	return InMat;
+}
+
+UHObject* UHAssetManager::ImportAsset(std::filesystem::path InPath)
+{
+	return ImportAssetAsync(InPath, UHAssetLoadPriority::High).Get();
 }
 
 void UHAssetManager::MapTextureIndex(UHMaterial* InMat)
@@ -255,33 +283,40 @@ void UHAssetManager::MapTextureIndex(UHMaterial* InMat)
 
 	// set texture reference after material creation
 	std::vector<int32_t> RegisteredIndexes;
-	for (const std::string RegisteredTexture : InMat->GetRegisteredTextureNames())
+	for (const std::string& RegisteredTexture : InMat->GetRegisteredTextureNames())
 	{
-		for (int32_t Jdx = 0; Jdx < UHTexture2Ds.size(); Jdx++)
-		{
-			if (UHTexture2Ds[Jdx]->GetSourcePath() == RegisteredTexture 
+		UHTexture2D* Tex = GetTexture2DByPath(RegisteredTexture);
 #if WITH_EDITOR
-				|| UHTexture2Ds[Jdx]->GetSourcePath() == FindTexturePathName(RegisteredTexture)
+		if (Tex == nullptr)
+		{
+			Tex = GetTexture2DByPath(FindTexturePathName(RegisteredTexture));
+		}
 #endif
-				)
-			{
-				// find referenced texture and set index
-				// add to referenced texture list if doesn't exist
-				int32_t TextureIdx = UHUtilities::FindIndex(ReferencedTexture2Ds, UHTexture2Ds[Jdx]);
 
-				if (TextureIdx == UHINDEXNONE)
-				{
-					TextureIdx = static_cast<int32_t>(ReferencedTexture2Ds.size());
-					ReferencedTexture2Ds.push_back(UHTexture2Ds[Jdx]);
-				}
+		if (Tex == nullptr)
+		{
+			continue;
+		}
 
-				// offset the texture index with system preserved texture slots
-				TextureIdx += GSystemPreservedTextureSlots;
-				RegisteredIndexes.push_back(TextureIdx);
-				UHTexture2Ds[Jdx]->AddReferenceObject(InMat);
-				break;
-			}
+		// find referenced texture and set index
+		// add to referenced texture list if doesn't exist
+		int32_t TextureIdx;
+		const auto SlotIt = ReferencedTextureSlots.find(Tex);
+		if (SlotIt != ReferencedTextureSlots.end())
+		{
+			TextureIdx = SlotIt->second;
+		}
+		else
+		{
+			TextureIdx = static_cast<int32_t>(ReferencedTexture2Ds.size());
+			ReferencedTexture2Ds.push_back(Tex);
+			ReferencedTextureSlots[Tex] = TextureIdx;
 		}
+
+		// offset the texture index with system preserved texture slots
+		TextureIdx += GSystemPreservedTextureSlots;
+		RegisteredIndexes.push_back(TextureIdx);
+		Tex->AddReferenceObject(InMat);
 	}
 
 	InMat->SetRegisteredTextureIndexes(RegisteredIndexes);
@@ -307,173 +342,378 @@ const std::vector<UHTexture2D*>& UHAssetManager::GetReferencedTexture2Ds() const
 	return ReferencedTexture2Ds;
 }
 
+int32_t UHAssetManager::GetReferencedTextureIndex(UHTexture2D* InTexture) const
+{
+	const auto SlotIt = ReferencedTextureSlots.find(InTexture);
+	return (SlotIt != ReferencedTextureSlots.end()) ? SlotIt->second : UHINDEXNONE;
+}
+
 const std::vector<UHTextureCube*>& UHAssetManager::GetCubemaps() const
 {
 	return UHCubemaps;
 }
 
-// get texture by name, only use for initialization
+// get texture by name or source path
 UHTexture2D* UHAssetManager::GetTexture2D(std::string InName) const
 {
-	for (UHTexture2D* Tex : UHTexture2Ds)
+	UHTexture2D* Tex = TextureByName.Find(InName, UHTexture2Ds, [](const UHTexture2D* InTex) { return InTex->GetName(); });
+	return (Tex != nullptr) ? Tex : GetTexture2DByPath(InName);
+}
+
+// get texture by source path
+UHTexture2D* UHAssetManager::GetTexture2DByPath(std::filesystem::path InPath) const
+{
+	return TextureBySourcePath.Find(UHAssetPathTable::Normalize(InPath), UHTexture2Ds
+		, [](const UHTexture2D* InTex) { return UHAssetPathTable::Normalize(InTex->GetSourcePath()); });
+}
+
+UHTextureCube* UHAssetManager::GetCubemapByName(std::string InName) const
+{
+	return CubemapByName.Find(InName, UHCubemaps, [](const UHTextureCube* InCube) { return InCube->GetName(); });
+}
+
+UHTextureCube* UHAssetManager::GetCubemapByPath(std::filesystem::path InPath) const
+{
+	return CubemapBySourcePath.Find(UHAssetPathTable::Normalize(InPath), UHCubemaps
+		, [](const UHTextureCube* InCube) { return UHAssetPathTable::Normalize(InCube->GetSourcePath()); });
+}
+
+UHMaterial* UHAssetManager::GetMaterial(std::string InName) const
+{
+	return MaterialByName.Find(InName, UHMaterialsCache, [](const UHMaterial* InMat) { return InMat->GetName(); });
+}
+
+UHMesh* UHAssetManager::GetMesh(std::string InName) const
+{
+	UHMesh* Mesh = MeshByName.Find(InName, UHMeshesCache, [](const UHMesh* InMesh) { return InMesh->GetName(); });
+	if (Mesh == nullptr)
 	{
-		if (Tex->GetName() == InName || Tex->GetSourcePath() == InName)
-		{
-			return Tex;
-		}
+		Mesh = MeshBySourcePath.Find(UHAssetPathTable::Normalize(InName), UHMeshesCache
+			, [](const UHMesh* InMesh) { return UHAssetPathTable::Normalize(InMesh->GetSourcePath()); });
 	}
 
-	return nullptr;
+	return Mesh;
 }
 
-// get texture by path, only use for initialization
-UHTexture2D* UHAssetManager::GetTexture2DByPath(std::filesystem::path InPath) const
+UHObject* UHAssetManager::GetAsset(UUID InAssetUuid)
 {
-	for (UHTexture2D* Tex : UHTexture2Ds)
+	return GetAssetAsync(InAssetUuid, UHAssetLoadPriority::High).Get();
+}
+
+UHObject* UHAssetManager::GetAsset(std::string InPath)
+{
+	return GetAssetAsync(InPath, UHAssetLoadPriority::High).Get();
+}
+
+UHObject* UHAssetManager::AddImportedMaterial(std::filesystem::path InPath)
+{
+	return ImportAssetAsync(InPath, UHAssetLoadPriority::High).Get();
+}
+
+UHAssetHandle UHAssetManager::ImportAssetAsync(std::filesystem::path InPath, UHAssetLoadPriority InPriority)
+{
+	const std::string LoadKey = ToAssetLoadKey(InPath);
+	if (PendingLoads.find(LoadKey) != PendingLoads.end())
 	{
-		if (Tex->GetSourcePath() == InPath)
-		{
-			return Tex;
-		}
+		std::shared_ptr<UHAssetLoadRequest> Pending = PendingLoads[LoadKey];
+		RaiseLoadPriority(Pending, InPriority);
+		return UHAssetHandle(this, Pending);
 	}
 
-	return nullptr;
+	const UHAssetType Type = GetAssetTypeByExtension(InPath.extension().string());
+	if (Type == UHAssetType::Unknown)
+	{
+		return UHAssetHandle();
+	}
+
+	// objects are created here instead of the workers, UHObject registers itself to the global object table
+	std::shared_ptr<UHAssetLoadRequest> Request = std::make_shared<UHAssetLoadRequest>(InPath, Type, InPriority);
+	switch (Type)
+	{
+	case UHAssetType::Mesh:
+		Request->Mesh = MakeUnique<UHMesh>();
+		break;
+
+	case UHAssetType::Texture2D:
+		Request->Texture = MakeUnique<UHTexture2D>();
+		break;
+
+	case UHAssetType::Cubemap:
+		Request->Cubemap = MakeUnique<UHTextureCube>();
+		break;
+
+	default:
+		break;
+	}
+
+	PendingLoads[LoadKey] = Request;
+	LoadQueue.push(UHAssetQueueEntry(Request, LoadSequence++));
+	DispatchAsyncLoads();
+
+	return UHAssetHandle(this, Request);
 }
 
-UHTextureCube* UHAssetManager::GetCubemapByName(std::string InName) const
+UHAssetHandle UHAssetManager::GetAssetAsync(UUID InAssetUuid, UHAssetLoadPriority InPriority)
 {
-	for (UHTextureCube* Tex : UHCubemaps)
+	UHAssetMap* AssetMap = AssetRegistry.FindByUuid(InAssetUuid);
+	if (AssetMap == nullptr)
+	{
+		return UHAssetHandle();
+	}
+
+	if (AssetMap->Asset != nullptr)
 	{
-		if (Tex->GetName() == InName)
+		// safely get the object if it's created already
+		UHObject* Obj = SafeGetObjectFromTable<UHObject>(AssetMap->Asset->GetId());
+		if (Obj && Obj->GetRuntimeGuid() == InAssetUuid)
 		{
-			return Tex;
+			return MakeLoadedHandle(Obj);
 		}
+
+		return UHAssetHandle();
 	}
 
-	return nullptr;
+	// load asset if not found, it's cached in the asset map after finalization
+	return ImportAssetAsync(AssetRegistry.GetFilePath(*AssetMap), InPriority);
 }
 
-UHTextureCube* UHAssetManager::GetCubemapByPath(std::filesystem::path InPath) const
+UHAssetHandle UHAssetManager::GetAssetAsync(std::string InPath, UHAssetLoadPriority InPriority)
 {
-	for (UHTextureCube* Tex : UHCubemaps)
+	UHAssetMap* AssetMap = AssetRegistry.FindByPath(InPath);
+	if (AssetMap != nullptr)
 	{
-		if (Tex->GetSourcePath() == InPath)
+		if (AssetMap->Asset != nullptr)
 		{
-			return Tex;
+			// safely get the object if it's created already
+			UHObject* Obj = SafeGetObjectFromTable<UHObject>(AssetMap->Asset->GetId());
+			if (Obj && Obj->GetRuntimeGuid() == AssetMap->AssetUUid)
+			{
+				return MakeLoadedHandle(Obj);
+			}
+		}
+		else
+		{
+			// load asset if not found, it's cached in the asset map after finalization
+			return ImportAssetAsync(AssetRegistry.GetFilePath(*AssetMap), InPriority);
 		}
 	}
 
-	return nullptr;
+	// the asset could still be loading, e.g. a texture referenced by a material during ImportAssets()
+	const std::string LoadKey = ToAssetLoadKey(InPath);
+	if (PendingLoads.find(LoadKey) != PendingLoads.end())
+	{
+		std::shared_ptr<UHAssetLoadRequest> Pending = PendingLoads[LoadKey];
+		RaiseLoadPriority(Pending, InPriority);
+		return UHAssetHandle(this, Pending);
+	}
+
+	return UHAssetHandle();
 }
 
-UHMaterial* UHAssetManager::GetMaterial(std::string InName) const
+void UHAssetManager::PumpAsyncLoads()
 {
-	// get material by name, don't use this except for initialization!
-	for (UHMaterial* Mat : UHMaterialsCache)
+	// register the finished loads first, so their slots can be reused by the queued ones
+	for (size_t Idx = 0; Idx < ActiveLoads.size();)
 	{
-		if (Mat->GetName() == InName)
+		std::shared_ptr<UHAssetLoadRequest> Request = ActiveLoads[Idx];
+		if (!FinalizeAsyncLoad(Request.get()))
+		{
+			Idx++;
+			continue;
+		}
+
+		const std::string LoadKey = ToAssetLoadKey(Request->Path);
+		if (PendingLoads.find(LoadKey) != PendingLoads.end() && PendingLoads[LoadKey] == Request)
 		{
-			return Mat;
+			PendingLoads.erase(LoadKey);
 		}
+		UHUtilities::RemoveByIndex(ActiveLoads, static_cast<int32_t>(Idx));
 	}
 
-	return nullptr;
+	DispatchAsyncLoads();
 }
 
-UHMesh* UHAssetManager::GetMesh(std::string InName) const
+void UHAssetManager::WaitAsyncLoads()
 {
-	// get mesh by name, don't use this except for initialization!
-	for (UHMesh* Mesh : UHMeshesCache)
+	PumpAsyncLoads();
+	while (!PendingLoads.empty())
 	{
-		if (Mesh->GetName() == InName || Mesh->GetSourcePath() == InName)
-		{
-			return Mesh;
-		}
+		WaitAnyAsyncLoad();
+		PumpAsyncLoads();
+	}
+}
+
+void UHAssetManager::WaitAsyncLoad(const std::shared_ptr<UHAssetLoadRequest>& InRequest)
+{
+	if (InRequest == nullptr)
+	{
+		return;
 	}
 
-	return nullptr;
+	// waiting on a request means it's needed right now
+	RaiseLoadPriority(InRequest, UHAssetLoadPriority::High);
+	PumpAsyncLoads();
+
+	while (InRequest->State != UHAssetLoadState::Done)
+	{
+		WaitAnyAsyncLoad();
+		PumpAsyncLoads();
+	}
 }
 
-UHObject* UHAssetManager::GetAsset(UUID InAssetUuid)
+UHAssetHandle UHAssetManager::MakeLoadedHandle(UHObject* InAsset)
 {
-	for (UHAssetMap& AssetMap : AllAssetsMap)
+	std::shared_ptr<UHAssetLoadRequest> Request = std::make_shared<UHAssetLoadRequest>(std::filesystem::path(), UHAssetType::Unknown
+		, UHAssetLoadPriority::Normal);
+	Request->State = UHAssetLoadState::Done;
+	Request->Result = InAsset;
+
+	return UHAssetHandle(this, Request);
+}
+
+void UHAssetManager::RaiseLoadPriority(const std::shared_ptr<UHAssetLoadRequest>& InRequest, UHAssetLoadPriority InPriority)
+{
+	if (InRequest->Priority >= InPriority)
 	{
-		if (AssetMap.AssetUUid == InAssetUuid)
+		return;
+	}
+
+	// the priority queue can't be updated in place, push it again and the stale entry is skipped on dispatching
+	InRequest->Priority = InPriority;
+	if (InRequest->State == UHAssetLoadState::Queued)
+	{
+		LoadQueue.push(UHAssetQueueEntry(InRequest, LoadSequence++));
+	}
+
+	for (const std::shared_ptr<UHAssetLoadRequest>& Dependency : InRequest->Dependencies)
+	{
+		RaiseLoadPriority(Dependency, InPriority);
+	}
+}
+
+void UHAssetManager::DispatchAsyncLoads()
+{
+	while (!LoadQueue.empty() && NumInFlightLoads < MaxInFlightLoads)
+	{
+		std::shared_ptr<UHAssetLoadRequest> Request = LoadQueue.top().Request;
+		LoadQueue.pop();
+
+		// stale entry of a raised request
+		if (Request->State != UHAssetLoadState::Queued)
 		{
-			if (AssetMap.Asset != nullptr)
-			{
-				// safely get the object if it's created already
-				UHObject* Obj = SafeGetObjectFromTable<UHObject>(AssetMap.Asset->GetId());
-				if (Obj && Obj->GetRuntimeGuid() == InAssetUuid)
-				{
-					return Obj;
-				}
-			}
-			else
-			{
-				// load asset if not found and cache in the asset map
-				UHObject* Obj = ImportAsset(AssetMap.FilePath);
-				AssetMap.Asset = Obj;
-				return Obj;
-			}
+			continue;
 		}
-	}
 
-	return nullptr;
+		Request->State = UHAssetLoadState::Loading;
+		ActiveLoads.push_back(Request);
+
+		// materials are parsed at finalization, so they don't occupy the worker slots
+		if (Request->Type != UHAssetType::Material)
+		{
+			NumInFlightLoads++;
+			LoadingJobSystem->Schedule(Request.get(), &Request->Counter);
+		}
+	}
 }
 
-UHObject* UHAssetManager::GetAsset(std::string InPath)
+bool UHAssetManager::FinalizeAsyncLoad(UHAssetLoadRequest* InRequest)
 {
-	for (UHAssetMap& AssetMap : AllAssetsMap)
+	if (InRequest->State == UHAssetLoadState::Loading)
 	{
-		if (std::filesystem::path(AssetMap.FilePath) == std::filesystem::path(InPath))
+		if (!InRequest->Counter.IsDone())
+		{
+			return false;
+		}
+
+		if (InRequest->Type != UHAssetType::Material)
 		{
-			if (AssetMap.Asset != nullptr)
+			NumInFlightLoads--;
+		}
+
+		InRequest->State = UHAssetLoadState::Done;
+		switch (InRequest->Type)
+		{
+		case UHAssetType::Mesh:
+			InRequest->Result = InRequest->bImportSucceeded ? RegisterMesh(InRequest->Mesh, InRequest->Path) : nullptr;
+			break;
+
+		case UHAssetType::Texture2D:
+			InRequest->Result = InRequest->bImportSucceeded ? RegisterTexture(InRequest->Texture, InRequest->Path) : nullptr;
+			break;
+
+		case UHAssetType::Cubemap:
+			InRequest->Result = InRequest->bImportSucceeded ? RegisterCubemap(InRequest->Cubemap, InRequest->Path) : nullptr;
+			break;
+
+		case UHAssetType::Material:
+			// graph nodes are UHObject, so the material is parsed here instead of the workers
+			// referenced textures are requested with the same priority, and the material waits for them before registration
+			InRequest->Material = GfxCache->RequestMaterial(InRequest->Path);
+			if (InRequest->Material != nullptr)
 			{
-				// safely get the object if it's created already
-				UHObject* Obj = SafeGetObjectFromTable<UHObject>(AssetMap.Asset->GetId());
-				if (Obj && Obj->GetRuntimeGuid() == AssetMap.AssetUUid)
+				InRequest->State = UHAssetLoadState::WaitingDependencies;
+				for (const std::string& TextureName : InRequest->Material->GetRegisteredTextureNames())
 				{
-					return Obj;
+					UHAssetHandle Handle = GetAssetAsync(GTextureAssetFolder + TextureName + GTextureAssetExtension, InRequest->Priority);
+					if (Handle.IsValid())
+					{
+						InRequest->Dependencies.push_back(Handle.Request);
+					}
 				}
 			}
-			else
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (InRequest->State == UHAssetLoadState::WaitingDependencies)
+	{
+		for (const std::shared_ptr<UHAssetLoadRequest>& Dependency : InRequest->Dependencies)
+		{
+			if (Dependency->State != UHAssetLoadState::Done)
 			{
-				// load asset if not found and cache in the asset map
-				UHObject* Obj = ImportAsset(AssetMap.FilePath);
-				AssetMap.Asset = Obj;
-				return Obj;
+				return false;
 			}
 		}
-	}
 
-	return nullptr;
-}
+		InRequest->Dependencies.clear();
+		InRequest->Result = RegisterMaterial(InRequest->Material, InRequest->Path);
+		InRequest->State = UHAssetLoadState::Done;
+	}
 
-UHObject* UHAssetManager::AddImportedMaterial(std::filesystem::path InPath)
-{
-	UHObject* Result = nullptr;
-	UHMaterial* Mat = GfxCache->RequestMaterial(InPath);
+	if (InRequest->State != UHAssetLoadState::Done)
+	{
+		return false;
+	}
 
-	if (Mat)
+	// cache the loaded asset in the asset map, editor adds the map entry during registration instead
+	if (!GIsEditor && InRequest->Result != nullptr)
 	{
-		// it's also important to update the texture references after material is imported
-		for (const std::string& TextureName : Mat->GetRegisteredTextureNames())
+		UHAssetMap* AssetMap = AssetRegistry.FindByPath(InRequest->Path);
+		if (AssetMap != nullptr && AssetMap->Asset == nullptr)
 		{
-			GetAsset(GTextureAssetFolder + TextureName + GTextureAssetExtension);
+			AssetMap->Asset = InRequest->Result;
 		}
-		MapTextureIndex(Mat);
+	}
+
+	return true;
+}
 
-		UHMaterialsCache.push_back(Mat);
-		if (GIsEditor)
+void UHAssetManager::WaitAnyAsyncLoad()
+{
+	// join the loading workers until the first in-flight load is done, instead of spinning on the caller thread
+	for (const std::shared_ptr<UHAssetLoadRequest>& Request : ActiveLoads)
+	{
+		if (Request->State == UHAssetLoadState::Loading && !Request->Counter.IsDone())
 		{
-			AllAssetsMap.push_back(UHAssetMap(Mat, InPath.string()));
+			LoadingJobSystem->Wait(&Request->Counter);
+			return;
 		}
-
-		Result = Mat;
 	}
 
-	return Result;
+	std::this_thread::yield();
 }
 
 #if WITH_EDITOR
@@ -484,7 +724,7 @@ void UHAssetManager::ImportAssets()
 	std::filesystem::create_directories(GMaterialAssetPath);
 
 	ClearAssetCaches();
-	AllAssetsMap.clear();
+	AssetRegistry.Clear();
 
 	for (std::filesystem::recursive_directory_iterator Idx(GAssetPath), end; Idx != end; Idx++)
 	{
@@ -494,20 +734,21 @@ void UHAssetManager::ImportAssets()
 			continue;
 		}
 
-		// load corresponding asset based on file type
-		ImportAsset(Idx->path());
+		// queue corresponding asset based on file type, they're loaded in parallel and registered in the order they finish
+		ImportAssetAsync(Idx->path(), UHAssetLoadPriority::Normal);
 	}
+	WaitAsyncLoads();
 
 	// output asset map after import all
 	std::ofstream FileOut(GAssetPath + GAssetMapName, std::ios::out | std::ios::binary);
 
-	size_t NumAssets = AllAssetsMap.size();
+	size_t NumAssets = AssetRegistry.GetEntries().size();
 	FileOut.write(reinterpret_cast<const char*>(&NumAssets), sizeof(NumAssets));
 
-	for (size_t Idx = 0; Idx < NumAssets; Idx++)
+	for (const UHAssetMap& AssetMap : AssetRegistry.GetEntries())
 	{
-		FileOut.write(reinterpret_cast<const char*>(&AllAssetsMap[Idx].AssetUUid), sizeof(AllAssetsMap[Idx].AssetUUid));
-		UHUtilities::WriteStringData(FileOut, AllAssetsMap[Idx].FilePath);
+		FileOut.write(reinterpret_cast<const char*>(&AssetMap.AssetUUid), sizeof(AssetMap.AssetUUid));
+		UHUtilities::WriteStringData(FileOut, AssetRegistry.GetFilePath(AssetMap));
 	}
 
 	FileOut.close();
@@ -518,12 +759,16 @@ void UHAssetManager::AddTexture2D(UHTexture2D* InTexture2D)
 	if (!UHUtilities::FindByElement(UHTexture2Ds, InTexture2D))
 	{
 		UHTexture2Ds.push_back(InTexture2D);
+		TextureByName.Add(InTexture2D->GetName(), InTexture2D);
+		TextureBySourcePath.Add(UHAssetPathTable::Normalize(InTexture2D->GetSourcePath()), InTexture2D);
 	}
 }
 
 void UHAssetManager::AddImportedMesh(UniquePtr<UHMesh>& InMesh)
 {
 	UHMeshesCache.push_back(InMesh.get());
+	MeshByName.Add(InMesh->GetName(), InMesh.get());
+	MeshBySourcePath.Add(UHAssetPathTable::Normalize(InMesh->GetSourcePath()), InMesh.get());
 	UHMeshes.push_back(std::move(InMesh));
 }
 
@@ -539,33 +784,21 @@ UHTexture2D* UHAssetManager::GetTexture2DByPathEditor(std::string InPathName)
 		return nullptr;
 	}
 
-	for (UHTexture2D* Tex : AssetMgrEditorOnly->GetTexture2Ds())
-	{
-		if (Tex->GetSourcePath() == AssetMgrEditorOnly->FindTexturePathName(InPathName))
-		{
-			return Tex;
-		}
-	}
-
-	return nullptr;
+	return AssetMgrEditorOnly->GetTexture2DByPath(FindTexturePathName(InPathName));
 }
 
 // find texture path name by name, used for old asset look-up
 std::string UHAssetManager::FindTexturePathName(std::string InName)
 {
-	for (const UHTexture2D* Tex : AssetMgrEditorOnly->GetTexture2Ds())
-	{
-		if (Tex->GetName() == InName)
-		{
-			return Tex->GetSourcePath();
-		}
-	}
-
-	return InName;
+	const UHTexture2D* Tex = AssetMgrEditorOnly->TextureByName.Find(InName, AssetMgrEditorOnly->UHTexture2Ds
+		, [](const UHTexture2D* InTex) { return InTex->GetName(); });
+	return (Tex != nullptr) ? Tex->GetSourcePath() : InName;
 }
 
 void UHAssetManager::AddCubemap(UHTextureCube* InCube)
 {
 	UHCubemaps.push_back(InCube);
+	CubemapByName.Add(InCube->GetName(), InCube);
+	CubemapBySourcePath.Add(UHAssetPathTable::Normalize(InCube->GetSourcePath()), InCube);
 }
 #endif
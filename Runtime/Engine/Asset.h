@@ -3,6 +3,9 @@
 #include "../Classes/Material.h"
 #include "../Classes/Texture2D.h"
 #include "../Classes/TextureCube.h"
+#include "AssetStreaming.h"
+#include "AssetRegistry.h"
+#include <queue>
 
 #if WITH_EDITOR
 #include "../../Editor/Classes/ShaderImporter.h"
@@ -11,25 +14,30 @@
 
 class UHGraphic;
 
-struct UHAssetMap
+// entry of the async load queue, the priority is copied so a raised request can be pushed again
+struct UHAssetQueueEntry
 {
-	UHAssetMap() 
-		: Asset(nullptr)
-		, AssetUUid(UUID())
+	UHAssetQueueEntry(std::shared_ptr<UHAssetLoadRequest> InRequest, uint64_t InSequence)
+		: Request(InRequest)
+		, Priority(InRequest->Priority)
+		, Sequence(InSequence)
 	{
+
 	}
 
-	UHAssetMap(UHObject* InObj, std::string InPath)
-		: AssetUUid(InObj->GetRuntimeGuid())
-		, FilePath(InPath)
-		, Asset(InObj)
+	// higher priority first, then first come first served
+	bool operator<(const UHAssetQueueEntry& InEntry) const
 	{
-
+		if (Priority != InEntry.Priority)
+		{
+			return Priority < InEntry.Priority;
+		}
+		return Sequence > InEntry.Sequence;
 	}
 
-	UUID AssetUUid;
-	std::string FilePath;
-	UHObject* Asset;
+	std::shared_ptr<UHAssetLoadRequest> Request;
+	UHAssetLoadPriority Priority;
+	uint64_t Sequence;
 };
 
 // asset manager class in UH
@@ -53,6 +61,7 @@ public:
 	const std::vector<UHMaterial*>& GetMaterials() const;
 	const std::vector<UHTexture2D*>& GetTexture2Ds() const;
 	const std::vector<UHTexture2D*>& GetReferencedTexture2Ds() const;
+	int32_t GetReferencedTextureIndex(UHTexture2D* InTexture) const;
 	const std::vector<UHTextureCube*>& GetCubemaps() const;
 
 	UHTexture2D* GetTexture2D(std::string InName) const;
@@ -68,6 +77,20 @@ public:
 	UHObject* GetAsset(std::string InPath);
 	UHObject* AddImportedMaterial(std::filesystem::path InPath);
 
+	// async loading, file reading and parsing run on the loading workers while registration happens on the caller thread
+	// the same file is only loaded once, requesting it again returns the pending handle and raises its priority
+	UHAssetHandle ImportAssetAsync(std::filesystem::path InPath, UHAssetLoadPriority InPriority = UHAssetLoadPriority::Normal);
+	UHAssetHandle GetAssetAsync(UUID InAssetUuid, UHAssetLoadPriority InPriority = UHAssetLoadPriority::Normal);
+	UHAssetHandle GetAssetAsync(std::string InPath, UHAssetLoadPriority InPriority = UHAssetLoadPriority::Normal);
+
+	// register finished loads and dispatch queued ones, this doesn't block
+	void PumpAsyncLoads();
+	void WaitAsyncLoads();
+	void WaitAsyncLoad(const std::shared_ptr<UHAssetLoadRequest>& InRequest);
+
+	// maximum loads that are being read/parsed by the workers at the same time
+	static const uint32_t MaxInFlightLoads = 64;
+
 #if WITH_EDITOR
 	void ImportAssets();
 	void AddTexture2D(UHTexture2D* InTexture2D);
@@ -82,10 +105,16 @@ public:
 
 private:
 	void ClearAssetCaches();
-	UHObject* ImportMesh(std::filesystem::path InPath);
-	UHObject* ImportTexture(std::filesystem::path InPath);
-	UHObject* ImportCubemap(std::filesystem::path InPath);
-	UHObject* ImportMaterial(std::filesystem::path InPath);
+	UHObject* RegisterMesh(UniquePtr<UHMesh>& InMesh, std::filesystem::path InPath);
+	UHObject* RegisterTexture(UniquePtr<UHTexture2D>& InTexture, std::filesystem::path InPath);
+	UHObject* RegisterCubemap(UniquePtr<UHTextureCube>& InCube, std::filesystem::path InPath);
+	UHObject* RegisterMaterial(UHMaterial* InMat, std::filesystem::path InPath);
+
+	UHAssetHandle MakeLoadedHandle(UHObject* InAsset);
+	void RaiseLoadPriority(const std::shared_ptr<UHAssetLoadRequest>& InRequest, UHAssetLoadPriority InPriority);
+	void DispatchAsyncLoads();
+	bool FinalizeAsyncLoad(UHAssetLoadRequest* InRequest);
+	void WaitAnyAsyncLoad();
 
 	// loaded meshes
 	std::vector<UniquePtr<UHMesh>> UHMeshes;
@@ -113,6 +142,26 @@ private:
 	std::vector<UHTexture2D*> ReferencedTexture2Ds;
 	std::vector<UHTextureCube*> UHCubemaps;
 
-	// general list for looking up
-	std::vector<UHAssetMap> AllAssetsMap;
+	// texture to its index in ReferencedTexture2Ds
+	std::unordered_map<UHTexture2D*, int32_t> ReferencedTextureSlots;
+
+	// name and source path lookups of loaded assets, source paths are normalized
+	UHAssetNameLookup<UHMesh> MeshByName;
+	UHAssetNameLookup<UHMesh> MeshBySourcePath;
+	UHAssetNameLookup<UHMaterial> MaterialByName;
+	UHAssetNameLookup<UHTexture2D> TextureByName;
+	UHAssetNameLookup<UHTexture2D> TextureBySourcePath;
+	UHAssetNameLookup<UHTextureCube> CubemapByName;
+	UHAssetNameLookup<UHTextureCube> CubemapBySourcePath;
+
+	// general registry for looking up by UUID or file path
+	UHAssetRegistry AssetRegistry;
+
+	// async loading states, pending loads are keyed by the normalized file path
+	UniquePtr<UHJobSystem> LoadingJobSystem;
+	std::priority_queue<UHAssetQueueEntry> LoadQueue;
+	std::vector<std::shared_ptr<UHAssetLoadRequest>> ActiveLoads;
+	std::unordered_map<std::string, std::shared_ptr<UHAssetLoadRequest>> PendingLoads;
+	uint64_t LoadSequence;
+	uint32_t NumInFlightLoads;
 };
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "AssetRegistry.h"
+#include <cstring>
+
+size_t UHUUIDHash::operator()(const UUID& InUuid) const
+{
+	uint64_t Parts[2];
+	memcpy(Parts, &InUuid, sizeof(Parts));
+	return std::hash<uint64_t>()(Parts[0] ^ (Parts[1] * 0x9E3779B97F4A7C15ull));
+}
+
+std::string UHAssetPathTable::Normalize(const std::filesystem::path& InPath)
+{
+	return InPath.lexically_normal().generic_string();
+}
+
+int32_t UHAssetPathTable::Intern(const std::filesystem::path& InPath)
+{
+	const auto Result = PathIds.emplace(Normalize(InPath), static_cast<int32_t>(Paths.size()));
+	if (Result.second)
+	{
+		Paths.push_back(&Result.first->first);
+	}
+
+	return Result.first->second;
+}
+
+int32_t UHAssetPathTable::Find(const std::filesystem::path& InPath) const
+{
+	const auto It = PathIds.find(Normalize(InPath));
+	return (It != PathIds.end()) ? It->second : UHINDEXNONE;
+}
+
+const std::string& UHAssetPathTable::GetPath(int32_t InPathId) const
+{
+	return *Paths[InPathId];
+}
+
+void UHAssetPathTable::Clear()
+{
+	Paths.clear();
+	PathIds.clear();
+}
+
+UHAssetMap& UHAssetRegistry::Add(UUID InUuid, const std::filesystem::path& InPath, UHObject* InAsset)
+{
+	const int32_t PathId = PathTable.Intern(InPath);
+
+	size_t EntryIdx;
+	const auto It = EntryByUuid.find(InUuid);
+	if (It != EntryByUuid.end())
+	{
+		// re-imported asset, the old path doesn't refer to this entry anymore
+		EntryIdx = It->second;
+		const auto PathIt = EntryByPath.find(Entries[EntryIdx].PathId);
+		if (PathIt != EntryByPath.end() && PathIt->second == EntryIdx)
+		{
+			EntryByPath.erase(PathIt);
+		}
+		Entries[EntryIdx] = UHAssetMap(InUuid, PathId, InAsset);
+	}
+	else
+	{
+		EntryIdx = Entries.size();
+		Entries.push_back(UHAssetMap(InUuid, PathId, InAsset));
+		EntryByUuid[InUuid] = EntryIdx;
+	}
+
+	EntryByPath[PathId] = EntryIdx;
+	return Entries[EntryIdx];
+}
+
+UHAssetMap* UHAssetRegistry::FindByUuid(const UUID& InUuid)
+{
+	const auto It = EntryByUuid.find(InUuid);
+	return (It != EntryByUuid.end()) ? &Entries[It->second] : nullptr;
+}
+
+UHAssetMap* UHAssetRegistry::FindByPath(const std::filesystem::path& InPath)
+{
+	const int32_t PathId = PathTable.Find(InPath);
+	if (PathId == UHINDEXNONE)
+	{
+		return nullptr;
+	}
+
+	const auto It = EntryByPath.find(PathId);
+	return (It != EntryByPath.end()) ? &Entries[It->second] : nullptr;
+}
+
+const std::vector<UHAssetMap>& UHAssetRegistry::GetEntries() const
+{
+	return Entries;
+}
+
+const std::string& UHAssetRegistry::GetFilePath(const UHAssetMap& InEntry) const
+{
+	return PathTable.GetPath(InEntry.PathId);
+}
+
+void UHAssetRegistry::Reserve(size_t InCount)
+{
+	Entries.reserve(InCount);
+	EntryByUuid.reserve(InCount);
+	EntryByPath.reserve(InCount);
+}
+
+void UHAssetRegistry::ResetAssets()
+{
+	for (UHAssetMap& Entry : Entries)
+	{
+		Entry.Asset = nullptr;
+	}
+}
+
+void UHAssetRegistry::Clear()
+{
+	Entries.clear();
+	EntryByUuid.clear();
+	EntryByPath.clear();
+	PathTable.Clear();
+}
\ No newline at end of file
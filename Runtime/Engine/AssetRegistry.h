@@ -0,0 +1,122 @@
+#pragma once
+#include "../Classes/Object.h"
+#include "../Classes/Types.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// entry of the asset map, the file path is interned in UHAssetPathTable
+struct UHAssetMap
+{
+	UHAssetMap()
+		: AssetUUid(UUID())
+		, PathId(UHINDEXNONE)
+		, Asset(nullptr)
+	{
+	}
+
+	UHAssetMap(UUID InUuid, int32_t InPathId, UHObject* InObj)
+		: AssetUUid(InUuid)
+		, PathId(InPathId)
+		, Asset(InObj)
+	{
+
+	}
+
+	UUID AssetUUid;
+	int32_t PathId;
+	UHObject* Asset;
+};
+
+// GUIDs are random already, simply fold the 128 bits
+struct UHUUIDHash
+{
+	size_t operator()(const UUID& InUuid) const;
+};
+
+// interned asset paths, each normalized path string is stored once and referred by its id
+// paths are normalized with generic separators, so "A\\B" and "A/B" are the same path
+class UHAssetPathTable
+{
+public:
+	static std::string Normalize(const std::filesystem::path& InPath);
+
+	int32_t Intern(const std::filesystem::path& InPath);
+	int32_t Find(const std::filesystem::path& InPath) const;
+	const std::string& GetPath(int32_t InPathId) const;
+	void Clear();
+
+private:
+	std::unordered_map<std::string, int32_t> PathIds;
+
+	// points to the keys of PathIds, the nodes of unordered_map are stable
+	std::vector<const std::string*> Paths;
+};
+
+// asset map with O(1) lookup by UUID and by path, entries are unique by UUID
+class UHAssetRegistry
+{
+public:
+	// add a new entry or update the existing one with the same UUID
+	UHAssetMap& Add(UUID InUuid, const std::filesystem::path& InPath, UHObject* InAsset);
+	UHAssetMap* FindByUuid(const UUID& InUuid);
+	UHAssetMap* FindByPath(const std::filesystem::path& InPath);
+
+	const std::vector<UHAssetMap>& GetEntries() const;
+	const std::string& GetFilePath(const UHAssetMap& InEntry) const;
+
+	void Reserve(size_t InCount);
+	void ResetAssets();
+	void Clear();
+
+private:
+	std::vector<UHAssetMap> Entries;
+	UHAssetPathTable PathTable;
+	std::unordered_map<UUID, size_t, UHUUIDHash> EntryByUuid;
+	std::unordered_map<int32_t, size_t> EntryByPath;
+};
+
+// lookup of loaded assets by name or source path, editor can rename assets after they're registered
+// so the hit is verified with the current key, and editor falls back to a scan for a stale or missing key
+template <typename T>
+class UHAssetNameLookup
+{
+public:
+	// the first asset registered with the key wins, same as the scan order
+	void Add(const std::string& InKey, T* InAsset)
+	{
+		Lookup.emplace(InKey, InAsset);
+	}
+
+	template <typename KeyFunc>
+	T* Find(const std::string& InKey, const std::vector<T*>& InAssets, KeyFunc InGetKey) const
+	{
+		const auto It = Lookup.find(InKey);
+		if (It != Lookup.end() && InGetKey(It->second) == InKey)
+		{
+			return It->second;
+		}
+
+#if WITH_EDITOR
+		for (T* Asset : InAssets)
+		{
+			if (InGetKey(Asset) == InKey)
+			{
+				Lookup[InKey] = Asset;
+				return Asset;
+			}
+		}
+#endif
+
+		return nullptr;
+	}
+
+	void Clear()
+	{
+		Lookup.clear();
+	}
+
+private:
+	mutable std::unordered_map<std::string, T*> Lookup;
+};
\ No newline at end of file
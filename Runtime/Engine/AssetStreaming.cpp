@@ -0,0 +1,74 @@
+#include "AssetStreaming.h"
+#include "Asset.h"
+
+UHAssetLoadRequest::UHAssetLoadRequest(std::filesystem::path InPath, UHAssetType InType, UHAssetLoadPriority InPriority)
+	: Path(InPath)
+	, Type(InType)
+	, Priority(InPriority)
+	, State(UHAssetLoadState::Queued)
+	, bImportSucceeded(false)
+	, Material(nullptr)
+	, Result(nullptr)
+{
+
+}
+
+void UHAssetLoadRequest::DoTask(const int32_t ThreadIndex)
+{
+	switch (Type)
+	{
+	case UHAssetType::Mesh:
+		bImportSucceeded = Mesh->Import(Path);
+		break;
+
+	case UHAssetType::Texture2D:
+		bImportSucceeded = Texture->Import(Path);
+		break;
+
+	case UHAssetType::Cubemap:
+		bImportSucceeded = Cubemap->Import(Path);
+		break;
+
+	default:
+		break;
+	}
+}
+
+UHAssetHandle::UHAssetHandle()
+	: AssetMgr(nullptr)
+	, Request(nullptr)
+{
+
+}
+
+UHAssetHandle::UHAssetHandle(UHAssetManager* InAssetMgr, std::shared_ptr<UHAssetLoadRequest> InRequest)
+	: AssetMgr(InAssetMgr)
+	, Request(InRequest)
+{
+
+}
+
+bool UHAssetHandle::IsValid() const
+{
+	return Request != nullptr;
+}
+
+bool UHAssetHandle::IsReady() const
+{
+	return Request != nullptr && Request->State == UHAssetLoadState::Done;
+}
+
+UHObject* UHAssetHandle::Get() const
+{
+	if (Request == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (Request->State != UHAssetLoadState::Done)
+	{
+		AssetMgr->WaitAsyncLoad(Request);
+	}
+
+	return Request->Result;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include <filesystem>
+#include "../Classes/AsyncTask.h"
+#include "../Classes/JobSystem.h"
+#include "../Classes/Mesh.h"
+#include "../Classes/Texture2D.h"
+#include "../Classes/TextureCube.h"
+
+class UHAssetManager;
+class UHMaterial;
+
+enum class UHAssetLoadPriority
+{
+	Low = 0,
+	Normal,
+	High
+};
+
+enum class UHAssetLoadState
+{
+	Queued = 0,
+	Loading,
+	WaitingDependencies,
+	Done
+};
+
+enum class UHAssetType
+{
+	Unknown = 0,
+	Mesh,
+	Texture2D,
+	Cubemap,
+	Material
+};
+
+// a single asset load, the file reading and parsing run on the loading workers via DoTask()
+// everything else (object creation, GFX requests, registration) happens on the thread which owns the asset manager
+class UHAssetLoadRequest : public UHAsyncTask
+{
+public:
+	UHAssetLoadRequest(std::filesystem::path InPath, UHAssetType InType, UHAssetLoadPriority InPriority);
+	virtual void DoTask(const int32_t ThreadIndex) override;
+
+	std::filesystem::path Path;
+	UHAssetType Type;
+	UHAssetLoadPriority Priority;
+	UHAssetLoadState State;
+	UHJobCounter Counter;
+	bool bImportSucceeded;
+
+	// objects are created before the request is scheduled, as UHObject registers itself to the global object table
+	// materials are parsed at finalization since their graph nodes are UHObject too
+	UniquePtr<UHMesh> Mesh;
+	UniquePtr<UHTexture2D> Texture;
+	UniquePtr<UHTextureCube> Cubemap;
+	UHMaterial* Material;
+
+	// textures referenced by a material, the material is registered after all of them are done
+	std::vector<std::shared_ptr<UHAssetLoadRequest>> Dependencies;
+	UHObject* Result;
+};
+
+// handle of an async asset load, Get() blocks until the asset is registered
+// it must be resolved on the thread which owns the asset manager
+class UHAssetHandle
+{
+public:
+	UHAssetHandle();
+	UHAssetHandle(UHAssetManager* InAssetMgr, std::shared_ptr<UHAssetLoadRequest> InRequest);
+
+	bool IsValid() const;
+	bool IsReady() const;
+	UHObject* Get() const;
+
+	template <typename T>
+	T* GetAs() const
+	{
+		return static_cast<T*>(Get());
+	}
+
+private:
+	friend class UHAssetManager;
+	UHAssetManager* AssetMgr;
+	std::shared_ptr<UHAssetLoadRequest> Request;
+};
\ No newline at end of file
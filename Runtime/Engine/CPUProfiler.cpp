@@ -0,0 +1,458 @@
+#include "CPUProfiler.h"
+#include "framework.h"
+#include "../CoreGlobals.h"
+#include "../Classes/AssetPath.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+// the lane of a thread, events are only written by the owner thread
+struct UHCPUProfileThread
+{
+	UHCPUProfileThread(uint32_t InThreadId)
+		: Events(UHCPUProfiler::EventsPerThread)
+		, WriteIndex(0)
+		, FrameCount(0)
+		, Depth(0)
+		, bHasFrameMarker(false)
+		, bIsActive(true)
+		, ThreadId(InThreadId)
+	{
+
+	}
+
+	std::vector<UHCPUProfileEvent> Events;
+	std::atomic<uint64_t> WriteIndex;
+	int64_t FrameCount;
+	uint32_t Depth;
+	std::atomic<bool> bHasFrameMarker;
+
+	// registry data, guarded by the registry lock
+	bool bIsActive;
+	uint32_t ThreadId;
+	std::string Name;
+};
+
+// releases the lane when a thread exits, so the threads created later can reuse it instead of allocating another ring
+struct UHCPUProfileThreadHandle
+{
+	~UHCPUProfileThreadHandle();
+	UHCPUProfileThread* Thread = nullptr;
+};
+
+static const uint64_t GCPUProfileIndexMask = UHCPUProfiler::EventsPerThread - 1;
+static std::mutex GCPUProfileRegistryLock;
+static std::vector<std::unique_ptr<UHCPUProfileThread>> GCPUProfileThreads;
+static thread_local UHCPUProfileThread* GCPUProfileThreadTLS = nullptr;
+static thread_local UHCPUProfileThreadHandle GCPUProfileThreadHandleTLS;
+static std::atomic<int64_t> GCPUProfileStartTime(0);
+
+// begin time of recent main frames, the count is published after the time is written
+static const uint64_t GMaxMainFrameTimes = 4;
+static std::atomic<int64_t> GMainFrameTimes[GMaxMainFrameTimes];
+static std::atomic<uint64_t> GMainFrameCount(0);
+
+std::atomic<bool> UHCPUProfiler::bIsEnabled(false);
+
+UHCPUProfileThreadHandle::~UHCPUProfileThreadHandle()
+{
+	if (Thread != nullptr)
+	{
+		std::unique_lock<std::mutex> Lock(GCPUProfileRegistryLock);
+		Thread->bIsActive = false;
+	}
+}
+
+void UHCPUProfiler::SetEnabled(bool bInEnabled)
+{
+	// events before enabling are excluded from captures, the rings don't need to be cleared
+	if (bInEnabled && !IsEnabled())
+	{
+		GCPUProfileStartTime.store(GetTimeStamp(), std::memory_order_relaxed);
+	}
+	bIsEnabled.store(bInEnabled, std::memory_order_relaxed);
+}
+
+void UHCPUProfiler::SetThreadName(const std::string& InName)
+{
+	UHCPUProfileThread* Thread = GetThread();
+	std::unique_lock<std::mutex> Lock(GCPUProfileRegistryLock);
+	Thread->Name = InName;
+}
+
+void UHCPUProfiler::BeginFrame()
+{
+	if (IsEnabled())
+	{
+		MarkFrameInternal(true);
+	}
+}
+
+void UHCPUProfiler::MarkThreadFrame()
+{
+	if (IsEnabled())
+	{
+		MarkFrameInternal(false);
+	}
+}
+
+int64_t UHCPUProfiler::GetTimeStamp()
+{
+	int64_t CurrTime;
+	QueryPerformanceCounter((LARGE_INTEGER*)&CurrTime);
+	return CurrTime;
+}
+
+double UHCPUProfiler::GetSecondsPerCount()
+{
+	static const double SecondsPerCount = []()
+	{
+		int64_t CountsPerSec;
+		QueryPerformanceFrequency((LARGE_INTEGER*)&CountsPerSec);
+		return 1.0 / static_cast<double>(CountsPerSec);
+	}();
+
+	return SecondsPerCount;
+}
+
+void UHCPUProfiler::Capture(std::vector<UHCPUProfileThreadCapture>& OutThreads)
+{
+	OutThreads.clear();
+	const int64_t StartTime = GCPUProfileStartTime.load(std::memory_order_relaxed);
+
+	std::unique_lock<std::mutex> Lock(GCPUProfileRegistryLock);
+	for (const std::unique_ptr<UHCPUProfileThread>& Thread : GCPUProfileThreads)
+	{
+		const uint64_t End = Thread->WriteIndex.load(std::memory_order_acquire);
+		const uint64_t First = (End > EventsPerThread) ? End - EventsPerThread : 0;
+
+		UHCPUProfileThreadCapture Capture;
+		Capture.ThreadId = Thread->ThreadId;
+		Capture.ThreadName = Thread->Name;
+		Capture.Events.reserve(End - First);
+		for (uint64_t Index = First; Index < End; Index++)
+		{
+			Capture.Events.push_back(Thread->Events[Index & GCPUProfileIndexMask]);
+		}
+
+		// the owner keeps writing while copying, drop the events that are overwritten or being overwritten
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t WriteIndex = Thread->WriteIndex.load(std::memory_order_relaxed);
+		const uint64_t ValidFirst = (WriteIndex >= EventsPerThread) ? WriteIndex - EventsPerThread + 1 : 0;
+		const size_t NumDropped = static_cast<size_t>((std::min)((std::max)(ValidFirst, First), End) - First);
+		Capture.Events.erase(Capture.Events.begin(), Capture.Events.begin() + NumDropped);
+
+		Capture.Events.erase(std::remove_if(Capture.Events.begin(), Capture.Events.end()
+			, [StartTime](const UHCPUProfileEvent& InEvent) { return InEvent.BeginTime < StartTime; }), Capture.Events.end());
+
+		if (Capture.Events.size() > 0)
+		{
+			OutThreads.push_back(std::move(Capture));
+		}
+	}
+}
+
+void UHCPUProfiler::CaptureLastFrame(std::vector<UHCPUProfileThreadCapture>& OutThreads)
+{
+	OutThreads.clear();
+	const int64_t StartTime = GCPUProfileStartTime.load(std::memory_order_relaxed);
+
+	// the window of the last finished main frame
+	const uint64_t MainFrameCount = GMainFrameCount.load(std::memory_order_acquire);
+	const bool bHasWindow = MainFrameCount >= 2;
+	const int64_t WindowBegin = bHasWindow ? GMainFrameTimes[(MainFrameCount - 2) % GMaxMainFrameTimes].load(std::memory_order_relaxed) : 0;
+	const int64_t WindowEnd = bHasWindow ? GMainFrameTimes[(MainFrameCount - 1) % GMaxMainFrameTimes].load(std::memory_order_relaxed) : 0;
+
+	std::vector<uint64_t> Indices;
+	std::unique_lock<std::mutex> Lock(GCPUProfileRegistryLock);
+	for (const std::unique_ptr<UHCPUProfileThread>& Thread : GCPUProfileThreads)
+	{
+		const bool bOwnFrames = Thread->bHasFrameMarker.load(std::memory_order_relaxed);
+		if (!bOwnFrames && !bHasWindow)
+		{
+			continue;
+		}
+
+		const uint64_t End = Thread->WriteIndex.load(std::memory_order_acquire);
+		const uint64_t First = (End > EventsPerThread) ? End - EventsPerThread : 0;
+
+		UHCPUProfileThreadCapture Capture;
+		Capture.ThreadId = Thread->ThreadId;
+		Capture.ThreadName = Thread->Name;
+		Indices.clear();
+
+		// walk backward from the latest event, so only the events of the last frame are visited
+		// a thread with frame markers collects the events between its last two markers, others collect the events within the main window
+		bool bInFrame = !bOwnFrames;
+		for (uint64_t Index = End; Index > First; Index--)
+		{
+			const UHCPUProfileEvent& Event = Thread->Events[(Index - 1) & GCPUProfileIndexMask];
+			if (bOwnFrames)
+			{
+				if (Event.Type == UHCPUProfileEventType::Frame)
+				{
+					if (bInFrame)
+					{
+						break;
+					}
+					bInFrame = true;
+					continue;
+				}
+			}
+			else
+			{
+				const int64_t Time = (Event.Type == UHCPUProfileEventType::Scope) ? Event.EndTime : Event.BeginTime;
+				if (Time < WindowBegin)
+				{
+					break;
+				}
+				bInFrame = Time < WindowEnd;
+			}
+
+			if (bInFrame && Event.BeginTime >= StartTime)
+			{
+				Capture.Events.push_back(Event);
+				Indices.push_back(Index - 1);
+			}
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t WriteIndex = Thread->WriteIndex.load(std::memory_order_relaxed);
+		const uint64_t ValidFirst = (WriteIndex >= EventsPerThread) ? WriteIndex - EventsPerThread + 1 : 0;
+		while (Indices.size() > 0 && Indices.back() < ValidFirst)
+		{
+			Indices.pop_back();
+			Capture.Events.pop_back();
+		}
+
+		if (Capture.Events.size() > 0)
+		{
+			std::reverse(Capture.Events.begin(), Capture.Events.end());
+			OutThreads.push_back(std::move(Capture));
+		}
+	}
+}
+
+static void WriteJsonString(std::ofstream& FileOut, const std::string& InString)
+{
+	FileOut << '"';
+	for (const char C : InString)
+	{
+		if (C == '"' || C == '\\')
+		{
+			FileOut << '\\' << C;
+		}
+		else if (static_cast<unsigned char>(C) < 0x20)
+		{
+			FileOut << ' ';
+		}
+		else
+		{
+			FileOut << C;
+		}
+	}
+	FileOut << '"';
+}
+
+bool UHCPUProfiler::ExportChromeTrace(const std::filesystem::path& InPath, const std::vector<UHCPUProfileThreadCapture>& InExtraLanes)
+{
+	std::vector<UHCPUProfileThreadCapture> Threads;
+	Capture(Threads);
+
+	// extra lanes are clipped to the same capture range
+	const size_t NumCPUThreads = Threads.size();
+	const int64_t StartTime = GCPUProfileStartTime.load(std::memory_order_relaxed);
+	for (const UHCPUProfileThreadCapture& Lane : InExtraLanes)
+	{
+		UHCPUProfileThreadCapture Clipped;
+		Clipped.ThreadId = Lane.ThreadId;
+		Clipped.ThreadName = Lane.ThreadName;
+		for (const UHCPUProfileEvent& Event : Lane.Events)
+		{
+			if (Event.BeginTime >= StartTime)
+			{
+				Clipped.Events.push_back(Event);
+			}
+		}
+
+		if (Clipped.Events.size() > 0)
+		{
+			Threads.push_back(std::move(Clipped));
+		}
+	}
+
+	if (InPath.has_parent_path())
+	{
+		std::error_code ErrorCode;
+		std::filesystem::create_directories(InPath.parent_path(), ErrorCode);
+	}
+
+	std::ofstream FileOut(InPath, std::ios::out);
+	if (!FileOut.is_open())
+	{
+		return false;
+	}
+
+	// timestamps are microseconds since the first event
+	int64_t BaseTime = INT64_MAX;
+	for (const UHCPUProfileThreadCapture& Thread : Threads)
+	{
+		for (const UHCPUProfileEvent& Event : Thread.Events)
+		{
+			BaseTime = (std::min)(BaseTime, Event.BeginTime);
+		}
+	}
+	const double MicrosecondsPerCount = GetSecondsPerCount() * 1000000.0;
+
+	FileOut << std::fixed << std::setprecision(3);
+	FileOut << "{\"traceEvents\":[\n";
+	bool bIsFirst = true;
+	const auto BeginEvent = [&FileOut, &bIsFirst]()
+	{
+		FileOut << (bIsFirst ? "{" : ",\n{");
+		bIsFirst = false;
+	};
+
+	for (size_t ThreadIdx = 0; ThreadIdx < Threads.size(); ThreadIdx++)
+	{
+		const UHCPUProfileThreadCapture& Thread = Threads[ThreadIdx];
+		const char* Category = (ThreadIdx < NumCPUThreads) ? "CPU" : "GPU";
+		BeginEvent();
+		FileOut << "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Thread.ThreadId << ",\"args\":{\"name\":";
+		WriteJsonString(FileOut, Thread.ThreadName);
+		FileOut << "}}";
+
+		BeginEvent();
+		FileOut << "\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Thread.ThreadId
+			<< ",\"args\":{\"sort_index\":" << Thread.ThreadId << "}}";
+
+		for (const UHCPUProfileEvent& Event : Thread.Events)
+		{
+			const double Timestamp = (Event.BeginTime - BaseTime) * MicrosecondsPerCount;
+			BeginEvent();
+			FileOut << "\"name\":";
+			WriteJsonString(FileOut, Event.Name);
+
+			switch (Event.Type)
+			{
+			case UHCPUProfileEventType::Scope:
+				FileOut << ",\"cat\":\"" << Category << "\",\"ph\":\"X\",\"ts\":" << Timestamp << ",\"dur\":" << (Event.EndTime - Event.BeginTime) * MicrosecondsPerCount;
+				break;
+			case UHCPUProfileEventType::Counter:
+				FileOut << ",\"ph\":\"C\",\"ts\":" << Timestamp << ",\"args\":{\"value\":" << Event.Value << "}";
+				break;
+			case UHCPUProfileEventType::Frame:
+				FileOut << ",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << Timestamp << ",\"args\":{\"frame\":" << Event.EndTime << "}";
+				break;
+			}
+			FileOut << ",\"pid\":1,\"tid\":" << Thread.ThreadId << "}";
+		}
+	}
+
+	FileOut << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	FileOut.close();
+
+	return !FileOut.fail();
+}
+
+std::filesystem::path UHCPUProfiler::GetTraceFilePath()
+{
+	return GProfileCapturePath + "CPUTrace_" + std::to_string(GFrameNumber) + ".json";
+}
+
+UHCPUProfileThread* UHCPUProfiler::GetThread()
+{
+	if (GCPUProfileThreadTLS != nullptr)
+	{
+		return GCPUProfileThreadTLS;
+	}
+
+	// first event of this thread, reuse a lane of an exited thread if there is any
+	std::unique_lock<std::mutex> Lock(GCPUProfileRegistryLock);
+	UHCPUProfileThread* Thread = nullptr;
+	for (const std::unique_ptr<UHCPUProfileThread>& Lane : GCPUProfileThreads)
+	{
+		if (!Lane->bIsActive)
+		{
+			Thread = Lane.get();
+			break;
+		}
+	}
+
+	if (Thread == nullptr)
+	{
+		GCPUProfileThreads.push_back(std::make_unique<UHCPUProfileThread>(static_cast<uint32_t>(GCPUProfileThreads.size())));
+		Thread = GCPUProfileThreads.back().get();
+	}
+
+	Thread->bIsActive = true;
+	Thread->Depth = 0;
+	Thread->bHasFrameMarker = false;
+	Thread->Name = "Thread " + std::to_string(Thread->ThreadId);
+
+	GCPUProfileThreadTLS = Thread;
+	GCPUProfileThreadHandleTLS.Thread = Thread;
+	return Thread;
+}
+
+void UHCPUProfiler::PushEvent(UHCPUProfileThread* InThread, const UHCPUProfileEvent& InEvent)
+{
+	// single writer, the event is published by the index
+	const uint64_t Index = InThread->WriteIndex.load(std::memory_order_relaxed);
+	InThread->Events[Index & GCPUProfileIndexMask] = InEvent;
+	InThread->WriteIndex.store(Index + 1, std::memory_order_release);
+}
+
+void UHCPUProfiler::AddCounterInternal(const char* InName, double InValue)
+{
+	UHCPUProfileEvent Event;
+	Event.Name = InName;
+	Event.BeginTime = GetTimeStamp();
+	Event.Value = InValue;
+
+	UHCPUProfileThread* Thread = GetThread();
+	Event.Depth = Thread->Depth;
+	Event.Type = UHCPUProfileEventType::Counter;
+	PushEvent(Thread, Event);
+}
+
+void UHCPUProfiler::MarkFrameInternal(bool bIsMainFrame)
+{
+	UHCPUProfileThread* Thread = GetThread();
+
+	UHCPUProfileEvent Event;
+	Event.Name = "Frame";
+	Event.BeginTime = GetTimeStamp();
+	Event.EndTime = Thread->FrameCount++;
+	Event.Depth = 0;
+	Event.Type = UHCPUProfileEventType::Frame;
+	PushEvent(Thread, Event);
+	Thread->bHasFrameMarker.store(true, std::memory_order_relaxed);
+
+	if (bIsMainFrame)
+	{
+		const uint64_t FrameCount = GMainFrameCount.load(std::memory_order_relaxed);
+		GMainFrameTimes[FrameCount % GMaxMainFrameTimes].store(Event.BeginTime, std::memory_order_relaxed);
+		GMainFrameCount.store(FrameCount + 1, std::memory_order_release);
+	}
+}
+
+void UHCPUProfileScope::Begin()
+{
+	Thread = UHCPUProfiler::GetThread();
+	Thread->Depth++;
+	BeginTime = UHCPUProfiler::GetTimeStamp();
+}
+
+void UHCPUProfileScope::End()
+{
+	UHCPUProfileEvent Event;
+	Event.EndTime = UHCPUProfiler::GetTimeStamp();
+	Event.Name = Name;
+	Event.BeginTime = BeginTime;
+	Event.Depth = --Thread->Depth;
+	Event.Type = UHCPUProfileEventType::Scope;
+	UHCPUProfiler::PushEvent(Thread, Event);
+}
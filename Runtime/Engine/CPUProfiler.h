@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+enum class UHCPUProfileEventType : uint32_t
+{
+	Scope,
+	Counter,
+	Frame
+};
+
+// an event recorded by UHCPUProfiler, names are string literals so the pointer works as the id of a scope
+// scopes are recorded when they end, so events of a thread are in the order of end time
+struct UHCPUProfileEvent
+{
+	const char* Name;
+	int64_t BeginTime;
+	union
+	{
+		// end time of scopes, frame number of frame markers
+		int64_t EndTime;
+		// value of counters
+		double Value;
+	};
+	uint32_t Depth;
+	UHCPUProfileEventType Type;
+};
+
+// events of a thread lane copied from its ring buffer
+struct UHCPUProfileThreadCapture
+{
+	uint32_t ThreadId;
+	std::string ThreadName;
+	std::vector<UHCPUProfileEvent> Events;
+};
+
+struct UHCPUProfileThread;
+
+// hierarchical CPU profiler, it's available in all builds and toggled at runtime
+// each thread writes events to its own ring buffer, so recording never takes a lock and older events are overwritten
+// only registering a new thread and the readers take the registry lock, readers copy events and drop the ones overwritten while copying
+//
+// the main thread calls BeginFrame() and threads with their own frame loop call MarkThreadFrame(),
+// threads without frame markers (e.g. job workers) use the time window of the main frame when collecting a frame
+class UHCPUProfiler
+{
+public:
+	static void SetEnabled(bool bInEnabled);
+	static bool IsEnabled()
+	{
+		return bIsEnabled.load(std::memory_order_relaxed);
+	}
+
+	// name the lane of the calling thread
+	static void SetThreadName(const std::string& InName);
+
+	static void BeginFrame();
+	static void MarkThreadFrame();
+
+	// record a counter value on the lane of the calling thread
+	template <size_t N>
+	static void AddCounter(const char (&InName)[N], double InValue)
+	{
+		if (IsEnabled())
+		{
+			AddCounterInternal(InName, InValue);
+		}
+	}
+
+	static int64_t GetTimeStamp();
+	static double GetSecondsPerCount();
+
+	// copy all events recorded since the profiler is enabled
+	static void Capture(std::vector<UHCPUProfileThreadCapture>& OutThreads);
+
+	// copy events of the last finished frame, the current frame in progress isn't included
+	static void CaptureLastFrame(std::vector<UHCPUProfileThreadCapture>& OutThreads);
+
+	// export the capture as Chrome trace JSON, which can be opened with chrome://tracing or Perfetto UI
+	// extra lanes are events already in CPU time from other timelines (e.g. GPU queues), they're exported as GPU scopes
+	static bool ExportChromeTrace(const std::filesystem::path& InPath, const std::vector<UHCPUProfileThreadCapture>& InExtraLanes = {});
+
+	// default file path of a trace, it's named by the frame number
+	static std::filesystem::path GetTraceFilePath();
+
+	// the ring buffer size of a thread, must be power of two
+	static const uint32_t EventsPerThread = 32768;
+
+private:
+	friend class UHCPUProfileScope;
+
+	static UHCPUProfileThread* GetThread();
+	static void PushEvent(UHCPUProfileThread* InThread, const UHCPUProfileEvent& InEvent);
+	static void AddCounterInternal(const char* InName, double InValue);
+	static void MarkFrameInternal(bool bIsMainFrame);
+
+	static std::atomic<bool> bIsEnabled;
+};
+
+// profile scope, only takes string literals so no string is built at runtime
+// the scope is recorded if the profiler is enabled when it begins
+class UHCPUProfileScope
+{
+public:
+	template <size_t N>
+	explicit UHCPUProfileScope(const char (&InName)[N])
+		: Name(InName)
+		, Thread(nullptr)
+		, BeginTime(0)
+	{
+		if (UHCPUProfiler::IsEnabled())
+		{
+			Begin();
+		}
+	}
+
+	~UHCPUProfileScope()
+	{
+		if (Thread != nullptr)
+		{
+			End();
+		}
+	}
+
+	UHCPUProfileScope(const UHCPUProfileScope&) = delete;
+	UHCPUProfileScope& operator=(const UHCPUProfileScope&) = delete;
+
+private:
+	void Begin();
+	void End();
+
+	const char* Name;
+	UHCPUProfileThread* Thread;
+	int64_t BeginTime;
+};
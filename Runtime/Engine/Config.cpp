@@ -41,10 +41,13 @@ void UHConfigManager::LoadConfig()
 			UHUtilities::ReadINIData<float>(FileIn, Section, "FPSLimit", EngineSettings.FPSLimit);
 			UHUtilities::ReadINIData<float>(FileIn, Section, "MeshBufferMemoryBudgetMB", EngineSettings.MeshBufferMemoryBudgetMB);
 			UHUtilities::ReadINIData<float>(FileIn, Section, "ImageMemoryBudgetMB", EngineSettings.ImageMemoryBudgetMB);
+			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableTextureStreaming", EngineSettings.bEnableTextureStreaming);
+			UHUtilities::ReadINIData<float>(FileIn, Section, "TextureStreamingBudgetMB", EngineSettings.TextureStreamingBudgetMB);
 
 			// clamp a few parameters
 			EngineSettings.MeshBufferMemoryBudgetMB = std::clamp(EngineSettings.MeshBufferMemoryBudgetMB, 0.1f, std::numeric_limits<float>::max());
 			EngineSettings.ImageMemoryBudgetMB = std::clamp(EngineSettings.ImageMemoryBudgetMB, 256.0f, std::numeric_limits<float>::max());
+			EngineSettings.TextureStreamingBudgetMB = std::clamp(EngineSettings.TextureStreamingBudgetMB, 64.0f, std::numeric_limits<float>::max());
 		}
 
 		// rendering settings
@@ -69,8 +72,11 @@ void UHConfigManager::LoadConfig()
 			UHUtilities::ReadINIData<bool>(FileIn, Section, "bDenoiseRTReflection", RenderingSettings.bDenoiseRTReflection);
 			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableAsyncCompute", RenderingSettings.bEnableAsyncCompute);
 			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableHDR", RenderingSettings.bEnableHDR);
-			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableHardwareOcclusion", RenderingSettings.bEnableHardwareOcclusion);
-			UHUtilities::ReadINIData<int32_t>(FileIn, Section, "OcclusionTriangleThreshold", RenderingSettings.OcclusionTriangleThreshold);
+			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableOcclusionCulling", RenderingSettings.bEnableOcclusionCulling);
+			UHUtilities::ReadINIData<int32_t>(FileIn, Section, "OccluderTriangleLimit", RenderingSettings.OccluderTriangleLimit);
+			UHUtilities::ReadINIData<int32_t>(FileIn, Section, "MaxSoftwareOccluders", RenderingSettings.MaxSoftwareOccluders);
+			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableGPUDrivenRendering", RenderingSettings.bEnableGPUDrivenRendering);
+			UHUtilities::ReadINIData<bool>(FileIn, Section, "bEnableGPULightClustering", RenderingSettings.bEnableGPULightClustering);
 			UHUtilities::ReadINIData<float>(FileIn, Section, "HDRWhitePaperNits", RenderingSettings.HDRWhitePaperNits);
 			UHUtilities::ReadINIData<float>(FileIn, Section, "HDRContrast", RenderingSettings.HDRContrast);
 			UHUtilities::ReadINIData<float>(FileIn, Section, "GammaCorrection", RenderingSettings.GammaCorrection);
@@ -118,6 +124,8 @@ void UHConfigManager::SaveConfig(HWND InWindow)
 		UHUtilities::WriteINIData(FileOut, "FPSLimit", EngineSettings.FPSLimit);
 		UHUtilities::WriteINIData(FileOut, "MeshBufferMemoryBudgetMB", EngineSettings.MeshBufferMemoryBudgetMB);
 		UHUtilities::WriteINIData(FileOut, "ImageMemoryBudgetMB", EngineSettings.ImageMemoryBudgetMB);
+		UHUtilities::WriteINIData(FileOut, "bEnableTextureStreaming", EngineSettings.bEnableTextureStreaming);
+		UHUtilities::WriteINIData(FileOut, "TextureStreamingBudgetMB", EngineSettings.TextureStreamingBudgetMB);
 		FileOut << std::endl;
 
 		UHUtilities::WriteINISection(FileOut, "RenderingSettings");
@@ -140,8 +148,11 @@ void UHConfigManager::SaveConfig(HWND InWindow)
 		UHUtilities::WriteINIData(FileOut, "bDenoiseRTReflection", RenderingSettings.bDenoiseRTReflection);
 		UHUtilities::WriteINIData(FileOut, "bEnableAsyncCompute", RenderingSettings.bEnableAsyncCompute);
 		UHUtilities::WriteINIData(FileOut, "bEnableHDR", RenderingSettings.bEnableHDR);
-		UHUtilities::WriteINIData(FileOut, "bEnableHardwareOcclusion", RenderingSettings.bEnableHardwareOcclusion);
-		UHUtilities::WriteINIData(FileOut, "OcclusionTriangleThreshold", RenderingSettings.OcclusionTriangleThreshold);
+		UHUtilities::WriteINIData(FileOut, "bEnableOcclusionCulling", RenderingSettings.bEnableOcclusionCulling);
+		UHUtilities::WriteINIData(FileOut, "OccluderTriangleLimit", RenderingSettings.OccluderTriangleLimit);
+		UHUtilities::WriteINIData(FileOut, "MaxSoftwareOccluders", RenderingSettings.MaxSoftwareOccluders);
+		UHUtilities::WriteINIData(FileOut, "bEnableGPUDrivenRendering", RenderingSettings.bEnableGPUDrivenRendering);
+		UHUtilities::WriteINIData(FileOut, "bEnableGPULightClustering", RenderingSettings.bEnableGPULightClustering);
 		UHUtilities::WriteINIData(FileOut, "HDRWhitePaperNits", RenderingSettings.HDRWhitePaperNits);
 		UHUtilities::WriteINIData(FileOut, "HDRContrast", RenderingSettings.HDRContrast);
 		UHUtilities::WriteINIData(FileOut, "GammaCorrection", RenderingSettings.GammaCorrection);
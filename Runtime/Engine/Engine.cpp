@@ -64,12 +64,19 @@ bool UHEngine::InitEngine(HINSTANCE Instance, HWND EngineWindow)
 	//SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << GMainThreadAffinity);
 	GMainThreadID = std::this_thread::get_id();
 
+	// CPU profiler is always on in editor, it can be toggled in game with Ctrl+P
+	UHCPUProfiler::SetThreadName("Main Thread");
+	UHCPUProfiler::SetEnabled(GIsEditor);
+
 	// cache current monitor refresh rate, also consider the NTSC frequencies
 	DEVMODE DevMode;
 	DevMode.dmSize = sizeof(DEVMODE);
 	EnumDisplaySettings(NULL, ENUM_CURRENT_SETTINGS, &DevMode);
 	DisplayFrequency = FixupNTSCFrequency(DevMode.dmDisplayFrequency);
 
+	// texture streaming is decided before any texture is imported, editor always keeps full textures
+	GEnableTextureStreaming = !GIsEditor && UHEConfig->EngineSetting().bEnableTextureStreaming;
+
 	// init asset manager
 	UHEAsset = MakeUnique<UHAssetManager>();
 
@@ -170,6 +177,65 @@ void UHEngine::ReleaseEngine()
 	FramerateLimitThread->EndThread();
 }
 
+#if WITH_EDITOR
+bool UHEngine::InitHeadlessEngine(bool bInSupportMeshShader, bool bInSupportDrawIndirectFirstInstance)
+{
+	GMainThreadID = std::this_thread::get_id();
+	GEnableTextureStreaming = false;
+
+	// assets aren't imported in headless mode, so there is no asset manager either
+	UHEGraphic = MakeUnique<UHGraphic>(nullptr, UHEConfig.get());
+	if (!UHEGraphic->InitNullBackend(bInSupportMeshShader, bInSupportDrawIndirectFirstInstance))
+	{
+		UHE_LOG(L"Can't initialize null graphic backend!\n");
+		return false;
+	}
+
+	// input devices aren't initialized, so no key is ever held
+	UHERawInput = MakeUnique<UHRawInput>();
+	UHEGameTimer = MakeUnique<UHGameTimer>();
+	UHEGameTimer->Reset();
+
+	return true;
+}
+
+bool UHEngine::InitHeadlessScene(UniquePtr<UHScene> InScene)
+{
+	CurrentScene = std::move(InScene);
+	CurrentScene->Initialize(this);
+
+	UHERenderer = MakeUnique<UHDeferredShadingRenderer>(this);
+	if (!UHERenderer->InitializeHeadless(CurrentScene.get()))
+	{
+		UHE_LOG(L"Can't initialize headless renderer!\n");
+		return false;
+	}
+
+	return true;
+}
+
+void UHEngine::ReleaseHeadlessEngine()
+{
+	if (UHERenderer != nullptr)
+	{
+		UHERenderer->ReleaseHeadless();
+		UHERenderer.reset();
+	}
+
+	if (CurrentScene != nullptr)
+	{
+		CurrentScene->Release();
+		CurrentScene.reset();
+	}
+
+	UHERawInput.reset();
+	UHEGameTimer.reset();
+
+	UH_SAFE_RELEASE(UHEGraphic);
+	UHEGraphic.reset();
+}
+#endif
+
 bool UHEngine::IsEngineInitialized()
 {
 	return bIsInitialized;
@@ -178,11 +244,16 @@ bool UHEngine::IsEngineInitialized()
 // engine updates
 void UHEngine::Update()
 {
+	UHCPUProfiler::BeginFrame();
 	UHProfilerScope Profiler(&EngineUpdateProfile);
+	UHGameTimerScope Scope("EngineUpdate", false);
 
 	// timer tick
 	UHEGameTimer->Tick();
 
+	// register the async loaded assets which are finished
+	UHEAsset->PumpAsyncLoads();
+
 	// update scripts
 	for (const auto& Script : UHGameScripts)
 	{
@@ -212,6 +283,12 @@ void UHEngine::Update()
 		SetResizeReason(UHEngineResizeReason::ToggleVsync);
 	}
 
+	// CPU profiler toggling, the capture is exported when it's turned off
+	if (UHERawInput->IsKeyHold(VK_CONTROL) && UHERawInput->IsKeyUp('p'))
+	{
+		ToggleCPUProfiler();
+	}
+
 	// update scene
 	CurrentScene->Update();
 
@@ -257,6 +334,7 @@ void UHEngine::Update()
 // engine render loop
 void UHEngine::RenderLoop()
 {
+	UHGameTimerScope Scope("RenderLoop", false);
 	UHERenderer->NotifyRenderThread();
 	GFrameNumber++;
 }
@@ -285,6 +363,35 @@ void UHEngine::ToggleFullScreen()
 	UHEGraphic->ToggleFullScreen(UHEConfig->PresentationSetting().bFullScreen);
 }
 
+void UHEngine::ToggleCPUProfiler()
+{
+	if (!UHCPUProfiler::IsEnabled())
+	{
+		UHCPUProfiler::SetEnabled(true);
+		UHE_LOG(L"CPU profiler is enabled.\n");
+		return;
+	}
+
+	UHCPUProfiler::SetEnabled(false);
+	const std::filesystem::path TracePath = UHCPUProfiler::GetTraceFilePath();
+
+	// GPU queues are exported as extra lanes of the same trace
+	std::vector<UHCPUProfileThreadCapture> GPULanes;
+	if (UHERenderer != nullptr)
+	{
+		UHERenderer->GetGPUTimeline().CaptureLanes(GPULanes);
+	}
+
+	if (UHCPUProfiler::ExportChromeTrace(TracePath, GPULanes))
+	{
+		UHE_LOG("CPU profile is exported to " + TracePath.string() + "\n");
+	}
+	else
+	{
+		UHE_LOG("Failed to export CPU profile to " + TracePath.string() + "\n");
+	}
+}
+
 void UHEngine::SetResizeReason(UHEngineResizeReason InFlag)
 {
 	EngineResizeReason = InFlag;
@@ -430,14 +537,18 @@ void UHEngine::OnLoadScene(std::filesystem::path InputPath)
 	UHEGraphic->WaitGPU();
 	UH_SAFE_RELEASE(UHERenderer);
 
-	// release assets of previous map for re-import
-	// and also reset the shared memory
+	// release assets of previous map for re-import, their shared memory is freed on release
 	if (GIsShipping)
 	{
 		UHEAsset->Release();
 		UHEAsset->ImportBuiltInAssets();
-		UHEGraphic->GetImageSharedMemory()->Reset();
-		UHEGraphic->GetMeshSharedMemory()->Reset();
+	}
+
+	// compact the shared mesh memory for the new map, GPU is idle and the renderer rebinds all descriptors at initialization
+	const uint32_t NumMoves = UHEGraphic->GetMeshSharedMemory()->Defragment(UINT32_MAX);
+	if (NumMoves > 0)
+	{
+		UHE_LOG(L"Defragmentation moved " + std::to_wstring(NumMoves) + L" mesh buffers.\n");
 	}
 
 	// recreate scene when loading
@@ -505,6 +616,17 @@ void UHEngine::EndProfile()
 	Stats.RendererCount = CurrentScene ? static_cast<int32_t>(CurrentScene->GetAllRendererCount()) : 0;
 	Stats.DrawCallCount = UHERenderer->GetDrawCallCount();
 	Stats.OccludedCallCount = UHERenderer->GetOccludedCallCount();
+
+	const UHTopLevelInstanceStats& InstanceStats = UHERenderer->GetTopLevelInstanceStats();
+	Stats.RTInstanceCount = static_cast<int32_t>(InstanceStats.NumInstances);
+	Stats.RTInstanceMasked = static_cast<int32_t>(InstanceStats.NumMasked);
+	Stats.RTInstanceAdded = static_cast<int32_t>(InstanceStats.NumAdded);
+	Stats.RTInstanceRemoved = static_cast<int32_t>(InstanceStats.NumRemoved);
+	Stats.RTInstanceUpdated = static_cast<int32_t>(InstanceStats.NumUpdated);
+	Stats.RTInstanceUploadBytes = static_cast<int32_t>(InstanceStats.UploadBytes);
+	Stats.RTInstanceUploadRanges = static_cast<int32_t>(InstanceStats.NumUploadRanges);
+	Stats.TopLevelASBuildMode = InstanceStats.BuildMode;
+
 	Stats.PSOCount = static_cast<int32_t>(UHEGraphic->StatePools.size());
 	Stats.ShaderCount = static_cast<int32_t>(UHEGraphic->ShaderPools.size());
 	Stats.RTCount = static_cast<int32_t>(UHEGraphic->RTPools.size());
@@ -57,6 +57,9 @@ public:
 	// toggle full screen
 	void ToggleFullScreen();
 
+	// toggle CPU profiler, the capture is exported to a Chrome trace when it's turned off
+	void ToggleCPUProfiler();
+
 	// set is need resize
 	void SetResizeReason(UHEngineResizeReason InFlag);
 
@@ -81,6 +84,12 @@ public:
 
 	void BeginProfile();
 	void EndProfile();
+
+	// headless engine for CPU benchmarks, it runs on the null graphics backend without window, input devices or render thread
+	// the scene is built by the caller and the renderer update stages are driven with GetSceneRenderer()
+	bool InitHeadlessEngine(bool bInSupportMeshShader, bool bInSupportDrawIndirectFirstInstance);
+	bool InitHeadlessScene(UniquePtr<UHScene> InScene);
+	void ReleaseHeadlessEngine();
 #endif
 
 private:
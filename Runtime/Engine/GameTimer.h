@@ -1,8 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <chrono>
-#include <utility>
-#include <vector>
+#include "CPUProfiler.h"
 
 // Game timer based on chrono 
 // Each time is stored as milliseconds
@@ -34,22 +33,24 @@ private:
 	bool bStopped;
 };
 
-// simple scoped timer
-class UHGameTimerScope : public UHGameTimer
+// simple scoped timer, it's recorded by UHCPUProfiler and the name must be a string literal
+class UHGameTimerScope
 {
 public:
-	UHGameTimerScope(std::string InName, bool bPrintTimeAfterStop);
+	template <size_t N>
+	UHGameTimerScope(const char (&InName)[N], bool bInPrintTimeAfterStop)
+		: ProfileScope(InName)
+		, Name(InName)
+		, bPrintTimeAfterStop(bInPrintTimeAfterStop)
+		, StartTime(bInPrintTimeAfterStop ? UHCPUProfiler::GetTimeStamp() : 0)
+	{
+
+	}
 	~UHGameTimerScope();
 
-	static const std::vector<std::pair<std::string, float>>& GetResiteredGameTime();
-	static void ClearRegisteredGameTime();
-
 private:
+	UHCPUProfileScope ProfileScope;
+	const char* Name;
 	bool bPrintTimeAfterStop;
-	std::string Name;
-
-#if WITH_EDITOR
-	// editor only registered game time, which will be displayed in profile
-	static std::vector<std::pair<std::string, float>> RegisteredGameTime;
-#endif
+	int64_t StartTime;
 };
\ No newline at end of file
@@ -5,12 +5,15 @@
 #include <algorithm> // for clamp
 #include "../Classes/Utility.h"
 #include "../Classes/AssetPath.h"
+#include "../Classes/JobSystem.h"
 
 UHGraphic::UHGraphic(UHAssetManager* InAssetManager, UHConfigManager* InConfig)
 	: GraphicsQueue(nullptr)
 	, CreationCommandPool(nullptr)
 	, LogicalDevice(nullptr)
 	, SwapChainRenderPass(nullptr)
+	, PipelineCache(nullptr)
+	, PipelineBatchDepth(0)
 	, MainSurface(nullptr)
 	, PhysicalDevice(nullptr)
 	, PhysicalDeviceMemoryProperties(VkPhysicalDeviceMemoryProperties())
@@ -26,6 +29,10 @@ UHGraphic::UHGraphic(UHAssetManager* InAssetManager, UHConfigManager* InConfig)
 	, bSupportHDR(false)
 	, bSupport24BitDepth(true)
 	, bSupportMeshShader(false)
+	, bSupportDrawIndirectFirstInstance(false)
+	, bSupportDrawIndirectCount(false)
+	, bSupportCalibratedTimestamps(false)
+	, bIsNullBackend(false)
 	, MeshBufferSharedMemory(nullptr)
 	, ImageSharedMemory(nullptr)
 #if WITH_EDITOR
@@ -56,7 +63,8 @@ UHGraphic::UHGraphic(UHAssetManager* InAssetManager, UHConfigManager* InConfig)
 		, "VK_KHR_push_descriptor"
 		, "VK_EXT_conditional_rendering"
 		, "VK_EXT_descriptor_indexing"
-		, "VK_EXT_mesh_shader" };
+		, "VK_EXT_mesh_shader"
+		, "VK_EXT_calibrated_timestamps" };
 
 	RayTracingExtensions = { "VK_KHR_deferred_host_operations"
 		, "VK_KHR_acceleration_structure"
@@ -81,7 +89,8 @@ bool UHGraphic::InitGraphics(HWND Hwnd)
 		&& CreateWindowSurface()
 		&& CreateQueueFamily()
 		&& CreateLogicalDevice()
-		&& CreateSwapChain();
+		&& CreateSwapChain()
+		&& CreatePipelineCache();
 
 	if (bInitSuccess)
 	{
@@ -100,22 +109,44 @@ bool UHGraphic::InitGraphics(HWND Hwnd)
 		MeshBufferSharedMemory->AllocateMemory(static_cast<uint64_t>(ConfigInterface->EngineSetting().MeshBufferMemoryBudgetMB) * 1048576, HostMemoryTypeIndex);
 
 		// reserve pools for faster allocation
-		ShaderPools.reserve(std::numeric_limits<int16_t>::max());
-		StatePools.reserve(1024);
-		RTPools.reserve(64);
-		SamplerPools.reserve(64);
-		Texture2DPools.reserve(1024);
-		TextureCubePools.reserve(1024);
-		MaterialPools.reserve(1024);
-		QueryPools.reserve(std::numeric_limits<int16_t>::max());
+		ShaderPools.Reserve(std::numeric_limits<int16_t>::max());
+		StatePools.Reserve(1024);
+		RTPools.Reserve(64);
+		SamplerPools.Reserve(64);
+		Texture2DPools.Reserve(1024);
+		TextureCubePools.Reserve(1024);
+		MaterialPools.Reserve(1024);
+		QueryPools.Reserve(std::numeric_limits<int16_t>::max());
 	}
 
 	return bInitSuccess;
 }
 
+#if WITH_EDITOR
+bool UHGraphic::InitNullBackend(bool bInSupportMeshShader, bool bInSupportDrawIndirectFirstInstance)
+{
+	// there is no device, so resources see a null logical device and shared memory is never used
+	bIsNullBackend = true;
+	bEnableRayTracing = false;
+	bSupportMeshShader = bInSupportMeshShader;
+	bSupportDrawIndirectFirstInstance = bInSupportDrawIndirectFirstInstance;
+	bSupportDrawIndirectCount = bInSupportDrawIndirectFirstInstance;
+	MaterialPools.Reserve(1024);
+
+	return true;
+}
+#endif
+
 // release graphics
 void UHGraphic::Release()
 {
+	// only materials are requested from the null backend
+	if (bIsNullBackend)
+	{
+		MaterialPools.Clear();
+		return;
+	}
+
 	// wait device to finish before release
 	WaitGPU();
 
@@ -129,31 +160,29 @@ void UHGraphic::Release()
 	GraphicsQueue = nullptr;
 
 	// release all shaders
-	ClearContainer(ShaderPools);
+	ShaderPools.ReleaseAll();
 
-	// release all states
-	ClearContainer(StatePools);
+	// release all states, the pipeline cache is saved before it's destroyed
+	StatePools.ReleaseAll();
+	SavePipelineCache();
+	vkDestroyPipelineCache(LogicalDevice, PipelineCache, nullptr);
 
 	// release all RTs
 	ClearSwapChain();
-	ClearContainer(RTPools);
+	RTPools.ReleaseAll();
 
 	// release all samplers
-	ClearContainer(SamplerPools);
+	SamplerPools.ReleaseAll();
 
 	// relase all textures
-	ClearContainer(Texture2DPools);
-	ClearContainer(TextureCubePools);
+	Texture2DPools.ReleaseAll();
+	TextureCubePools.ReleaseAll();
 
 	// release all materials
-	for (auto& Mat : MaterialPools)
-	{
-		Mat.reset();
-	}
-	MaterialPools.clear();
+	MaterialPools.Clear();
 
 	// release all queries
-	ClearContainer(QueryPools);
+	QueryPools.ReleaseAll();
 
 	// release GPU memory pool
 	ImageSharedMemory->Release();
@@ -321,6 +350,8 @@ bool UHGraphic::CreateInstance()
 	GVkCmdBeginConditionalRenderingEXT = (PFN_vkCmdBeginConditionalRenderingEXT)vkGetInstanceProcAddr(VulkanInstance, "vkCmdBeginConditionalRenderingEXT");
 	GVkCmdEndConditionalRenderingEXT = (PFN_vkCmdEndConditionalRenderingEXT)vkGetInstanceProcAddr(VulkanInstance, "vkCmdEndConditionalRenderingEXT");
 	GVkCmdDrawMeshTasksEXT = (PFN_vkCmdDrawMeshTasksEXT)vkGetInstanceProcAddr(VulkanInstance, "vkCmdDrawMeshTasksEXT");
+	GVkGetPhysicalDeviceCalibrateableTimeDomainsEXT = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(VulkanInstance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+	GVkGetCalibratedTimestampsEXT = (PFN_vkGetCalibratedTimestampsEXT)vkGetInstanceProcAddr(VulkanInstance, "vkGetCalibratedTimestampsEXT");
 
 	return true;
 }
@@ -436,8 +467,11 @@ bool UHGraphic::CreateQueueFamily()
 	vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &QueueFamilyCount, QueueFamilies.data());
 
 	// choose queue family, find both graphic queue and compute queue for now
+	QueueTimestampValidBits.resize(QueueFamilyCount);
 	for (uint32_t Idx = 0; Idx < QueueFamilyCount; Idx++)
 	{
+		QueueTimestampValidBits[Idx] = QueueFamilies[Idx].timestampValidBits;
+
 		// consider present support
 		VkBool32 PresentSupport = false;
 		vkGetPhysicalDeviceSurfaceSupportKHR(PhysicalDevice, Idx, MainSurface, &PresentSupport);
@@ -558,9 +592,31 @@ bool UHGraphic::CreateLogicalDevice()
 		bSupport24BitDepth = FormatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
 
 		// mesh shader support, disable others usage for now
-		bSupportMeshShader = MeshShaderFeatures.meshShader;
+		// task shader is required as well, since meshlets are culled in the amplification shader
+		bSupportMeshShader = MeshShaderFeatures.meshShader && MeshShaderFeatures.taskShader;
 		MeshShaderFeatures.multiviewMeshShader = false;
 		MeshShaderFeatures.primitiveFragmentShadingRateMeshShader = false;
+
+		// GPU-driven draws put the instance offset in indirect commands, and the draw counts are written by GPU culling
+		bSupportDrawIndirectFirstInstance = PhyFeatures.features.drawIndirectFirstInstance;
+		bSupportDrawIndirectCount = Vk12Features.drawIndirectCount;
+
+		// GPU timeline calibration samples the device clock together with QPC, which is the clock of the CPU profiler
+		const bool bHasCalibratedTimestamps = std::find_if(DeviceExtensions.begin(), DeviceExtensions.end(), [](const char* InExtension)
+			{
+				return strcmp(InExtension, "VK_EXT_calibrated_timestamps") == 0;
+			}) != DeviceExtensions.end();
+
+		if (bHasCalibratedTimestamps && GVkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+		{
+			uint32_t TimeDomainCount = 0;
+			GVkGetPhysicalDeviceCalibrateableTimeDomainsEXT(PhysicalDevice, &TimeDomainCount, nullptr);
+			std::vector<VkTimeDomainEXT> TimeDomains(TimeDomainCount);
+			GVkGetPhysicalDeviceCalibrateableTimeDomainsEXT(PhysicalDevice, &TimeDomainCount, TimeDomains.data());
+
+			bSupportCalibratedTimestamps = UHUtilities::FindByElement(TimeDomains, VK_TIME_DOMAIN_DEVICE_EXT)
+				&& UHUtilities::FindByElement(TimeDomains, VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT);
+		}
 	}
 
 	// get RT feature props
@@ -807,6 +863,11 @@ void UHGraphic::ToggleFullScreen(bool InFullScreenState)
 
 void UHGraphic::WaitGPU()
 {
+	if (bIsNullBackend)
+	{
+		return;
+	}
+
 	vkDeviceWaitIdle(LogicalDevice);
 }
 
@@ -998,21 +1059,15 @@ UHGPUQuery* UHGraphic::RequestGPUQuery(uint32_t Count, VkQueryType QueueType)
 	NewQuery->SetGfxCache(this);
 	NewQuery->CreateQueryPool(Count, QueueType);
 
-	QueryPools.push_back(std::move(NewQuery));
-	return QueryPools.back().get();
+	UHGPUQuery* Query = NewQuery.get();
+	QueryPools.Add(NewQuery);
+	return Query;
 }
 
 void UHGraphic::RequestReleaseGPUQuery(UHGPUQuery* InQuery)
 {
-	int32_t Idx = UHUtilities::FindIndex<UHGPUQuery>(QueryPools, *InQuery);
-	if (Idx == UHINDEXNONE)
-	{
-		return;
-	}
-
-	QueryPools[Idx]->Release();
-	QueryPools[Idx].reset();
-	UHUtilities::RemoveByIndex(QueryPools, Idx);
+	UniquePtr<UHGPUQuery> Query = QueryPools.Remove(InQuery);
+	UH_SAFE_RELEASE(Query);
 }
 
 // request render texture, this also sets device info to it
@@ -1029,10 +1084,10 @@ UHRenderTexture* UHGraphic::RequestRenderTexture(std::string InName, VkImage InI
 	UniquePtr<UHRenderTexture> NewRT = MakeUnique<UHRenderTexture>(InName, InExtent, InFormat, bIsReadWrite, bUseMipmap);
 	NewRT->SetImage(InImage);
 
-	int32_t Idx = UHUtilities::FindIndex<UHRenderTexture>(RTPools, *NewRT.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = NewRT->GetHash();
+	if (UHRenderTexture* CachedRT = RTPools.Find(Hash, *NewRT))
 	{
-		return RTPools[Idx].get();
+		return CachedRT;
 	}
 
 	NewRT->SetGfxCache(this);
@@ -1040,8 +1095,9 @@ UHRenderTexture* UHGraphic::RequestRenderTexture(std::string InName, VkImage InI
 
 	if (NewRT->CreateRT())
 	{
-		RTPools.push_back(std::move(NewRT));
-		return RTPools.back().get();
+		UHRenderTexture* RT = NewRT.get();
+		RTPools.Add(NewRT, Hash);
+		return RT;
 	}
 
 	return nullptr;
@@ -1050,32 +1106,26 @@ UHRenderTexture* UHGraphic::RequestRenderTexture(std::string InName, VkImage InI
 // request release RT, this could be used during resizing
 void UHGraphic::RequestReleaseRT(UHRenderTexture* InRT)
 {
-	int32_t Idx = UHUtilities::FindIndex<UHRenderTexture>(RTPools, *InRT);
-	if (Idx == UHINDEXNONE)
-	{
-		return;
-	}
-
-	RTPools[Idx]->Release();
-	RTPools[Idx].reset();
-	UHUtilities::RemoveByIndex(RTPools, Idx);
+	UniquePtr<UHRenderTexture> RT = RTPools.Remove(InRT);
+	UH_SAFE_RELEASE(RT);
 }
 
 UHTexture2D* UHGraphic::RequestTexture2D(UniquePtr<UHTexture2D>& LoadedTex, bool bUseSharedMemory)
 {
 	// return cached if there is already one
-	int32_t Idx = UHUtilities::FindIndex<UHTexture2D>(Texture2DPools, *LoadedTex.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = LoadedTex->GetHash();
+	if (UHTexture2D* CachedTex = Texture2DPools.Find(Hash, *LoadedTex))
 	{
-		return Texture2DPools[Idx].get();
+		return CachedTex;
 	}
 
 	LoadedTex->SetGfxCache(this);
 
 	if (LoadedTex->CreateTexture(bUseSharedMemory))
 	{
-		Texture2DPools.push_back(std::move(LoadedTex));
-		return Texture2DPools.back().get();
+		UHTexture2D* Tex = LoadedTex.get();
+		Texture2DPools.Add(LoadedTex, Hash);
+		return Tex;
 	}
 
 	return nullptr;
@@ -1083,16 +1133,14 @@ UHTexture2D* UHGraphic::RequestTexture2D(UniquePtr<UHTexture2D>& LoadedTex, bool
 
 void UHGraphic::RequestReleaseTexture2D(UHTexture2D* InTex)
 {
-	int32_t Idx = UHUtilities::FindIndex<UHTexture2D>(Texture2DPools, *InTex);
-	if (Idx == UHINDEXNONE)
+	UniquePtr<UHTexture2D> Tex = Texture2DPools.Remove(InTex);
+	if (Tex == nullptr)
 	{
 		return;
 	}
 
-	Texture2DPools[Idx]->ReleaseCPUTextureData();
-	Texture2DPools[Idx]->Release();
-	Texture2DPools[Idx].reset();
-	UHUtilities::RemoveByIndex(Texture2DPools, Idx);
+	Tex->ReleaseCPUTextureData();
+	Tex->Release();
 }
 
 bool AreTextureSliceConsistent(std::string InArrayName, std::vector<UHTexture2D*> InTextures)
@@ -1149,18 +1197,19 @@ UHTextureCube* UHGraphic::RequestTextureCube(std::string InName, std::vector<UHT
 	}
 
 	UniquePtr<UHTextureCube> NewCube = MakeUnique<UHTextureCube>(InName, InTextures[0]->GetExtent(), InTextures[0]->GetFormat(), InTextures[0]->GetTextureSettings());
-	int32_t Idx = UHUtilities::FindIndex<UHTextureCube>(TextureCubePools, *NewCube.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = NewCube->GetHash();
+	if (UHTextureCube* CachedCube = TextureCubePools.Find(Hash, *NewCube))
 	{
-		return TextureCubePools[Idx].get();
+		return CachedCube;
 	}
 
 	NewCube->SetGfxCache(this);
 
 	if (NewCube->CreateCube(InTextures))
 	{
-		TextureCubePools.push_back(std::move(NewCube));
-		return TextureCubePools.back().get();
+		UHTextureCube* Cube = NewCube.get();
+		TextureCubePools.Add(NewCube, Hash);
+		return Cube;
 	}
 
 	return nullptr;
@@ -1169,18 +1218,19 @@ UHTextureCube* UHGraphic::RequestTextureCube(std::string InName, std::vector<UHT
 // light version of texture cube request, usually called when an existed asset is imported
 UHTextureCube* UHGraphic::RequestTextureCube(UniquePtr<UHTextureCube>& LoadedCube)
 {
-	int32_t Idx = UHUtilities::FindIndex<UHTextureCube>(TextureCubePools, *LoadedCube.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = LoadedCube->GetHash();
+	if (UHTextureCube* CachedCube = TextureCubePools.Find(Hash, *LoadedCube))
 	{
-		return TextureCubePools[Idx].get();
+		return CachedCube;
 	}
 
 	LoadedCube->SetGfxCache(this);
 
 	if (LoadedCube->CreateCube())
 	{
-		TextureCubePools.push_back(std::move(LoadedCube));
-		return TextureCubePools.back().get();
+		UHTextureCube* Cube = LoadedCube.get();
+		TextureCubePools.Add(LoadedCube, Hash);
+		return Cube;
 	}
 
 	return nullptr;
@@ -1188,16 +1238,14 @@ UHTextureCube* UHGraphic::RequestTextureCube(UniquePtr<UHTextureCube>& LoadedCub
 
 void UHGraphic::RequestReleaseTextureCube(UHTextureCube* InCube)
 {
-	int32_t Idx = UHUtilities::FindIndex<UHTextureCube>(TextureCubePools, *InCube);
-	if (Idx == UHINDEXNONE)
+	UniquePtr<UHTextureCube> Cube = TextureCubePools.Remove(InCube);
+	if (Cube == nullptr)
 	{
 		return;
 	}
 
-	TextureCubePools[Idx]->ReleaseCPUData();
-	TextureCubePools[Idx]->Release();
-	TextureCubePools[Idx].reset();
-	UHUtilities::RemoveByIndex(TextureCubePools, Idx);
+	Cube->ReleaseCPUData();
+	Cube->Release();
 }
 
 // request material without any import
@@ -1205,8 +1253,9 @@ void UHGraphic::RequestReleaseTextureCube(UHTextureCube* InCube)
 UHMaterial* UHGraphic::RequestMaterial()
 {
 	UniquePtr<UHMaterial> NewMat = MakeUnique<UHMaterial>();
-	MaterialPools.push_back(std::move(NewMat));
-	return MaterialPools.back().get();
+	UHMaterial* Mat = NewMat.get();
+	MaterialPools.Add(NewMat);
+	return Mat;
 }
 
 UHMaterial* UHGraphic::RequestMaterial(std::filesystem::path InPath)
@@ -1218,8 +1267,9 @@ UHMaterial* UHGraphic::RequestMaterial(std::filesystem::path InPath)
 	{
 		NewMat->SetGfxCache(this);
 		NewMat->PostImport();
-		MaterialPools.push_back(std::move(NewMat));
-		return MaterialPools.back().get();
+		UHMaterial* Mat = NewMat.get();
+		MaterialPools.Add(NewMat);
+		return Mat;
 	}
 
 	return nullptr;
@@ -1227,14 +1277,7 @@ UHMaterial* UHGraphic::RequestMaterial(std::filesystem::path InPath)
 
 void UHGraphic::RequestReleaseMaterial(UHMaterial* InMat)
 {
-	int32_t Idx = UHUtilities::FindIndex<UHMaterial>(MaterialPools, *InMat);
-	if (Idx == UHINDEXNONE)
-	{
-		return;
-	}
-
-	MaterialPools[Idx].reset();
-	UHUtilities::RemoveByIndex(MaterialPools, Idx);
+	MaterialPools.Remove(InMat);
 }
 
 UniquePtr<UHAccelerationStructure> UHGraphic::RequestAccelerationStructure()
@@ -1288,10 +1331,10 @@ uint32_t UHGraphic::RequestShader(std::string InShaderName, std::filesystem::pat
 	NewShader->SetGfxCache(this);
 
 	// early return if it's exist in pool
-	int32_t PoolIdx = UHUtilities::FindIndex<UHShader>(ShaderPools, *NewShader.get());
-	if (PoolIdx != UHINDEXNONE)
+	const size_t Hash = NewShader->GetHash();
+	if (const UHShader* CachedShader = ShaderPools.Find(Hash, *NewShader))
 	{
-		return ShaderPools[PoolIdx]->GetId();
+		return CachedShader->GetId();
 	}
 
 	// ensure the shader is compiled (debug only)
@@ -1313,8 +1356,9 @@ uint32_t UHGraphic::RequestShader(std::string InShaderName, std::filesystem::pat
 		return -1;
 	}
 
-	ShaderPools.push_back(std::move(NewShader));
-	return ShaderPools.back()->GetId();
+	const uint32_t ShaderId = NewShader->GetId();
+	ShaderPools.Add(NewShader, Hash);
+	return ShaderId;
 }
 
 // request shader for material
@@ -1342,10 +1386,10 @@ uint32_t UHGraphic::RequestMaterialShader(std::string InShaderName, std::filesys
 	NewShader->SetGfxCache(this);
 
 	// early return if it's exist in pool and does not need recompile
-	int32_t PoolIdx = UHUtilities::FindIndex<UHShader>(ShaderPools, *NewShader.get());
-	if (PoolIdx != UHINDEXNONE)
+	const size_t Hash = NewShader->GetHash();
+	if (const UHShader* CachedShader = ShaderPools.Find(Hash, *NewShader))
 	{
-		return ShaderPools[PoolIdx]->GetId();
+		return CachedShader->GetId();
 	}
 
 	// almost the same as common shader flow, but this will go through HLSL translator instead
@@ -1359,8 +1403,9 @@ uint32_t UHGraphic::RequestMaterialShader(std::string InShaderName, std::filesys
 		return -1;
 	}
 
-	ShaderPools.push_back(std::move(NewShader));
-	return ShaderPools.back()->GetId();
+	const uint32_t ShaderId = NewShader->GetId();
+	ShaderPools.Add(NewShader, Hash);
+	return ShaderId;
 }
 
 void UHGraphic::RequestReleaseShader(uint32_t InShaderID)
@@ -1368,123 +1413,182 @@ void UHGraphic::RequestReleaseShader(uint32_t InShaderID)
 	// check if the object still exists before release
 	if (const UHShader* InShader = SafeGetObjectFromTable<const UHShader>(InShaderID))
 	{
-		int32_t Idx = UHUtilities::FindIndex(ShaderPools, *InShader);
-		if (Idx != UHINDEXNONE)
-		{
-			ShaderPools[Idx]->Release();
-			ShaderPools[Idx].reset();
-			UHUtilities::RemoveByIndex(ShaderPools, Idx);
-		}
+		UniquePtr<UHShader> Shader = ShaderPools.Remove(InShader);
+		UH_SAFE_RELEASE(Shader);
 	}
 }
 
 // request a Graphic State object and return
-UHGraphicState* UHGraphic::RequestGraphicState(UHRenderPassInfo InInfo)
+UHResourceHandle UHGraphic::RequestGraphicState(UHRenderPassInfo InInfo)
 {
 	std::unique_lock<std::mutex> Lock(Mutex);
 	UniquePtr<UHGraphicState> NewState = MakeUnique<UHGraphicState>(InInfo);
 
 	// check cached state first
-	int32_t Idx = UHUtilities::FindIndex(StatePools, *NewState.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = NewState->GetHash();
+	if (UHGraphicState* CachedState = StatePools.Find(Hash, *NewState))
 	{
-		StatePools[Idx]->IncreaseRefCount();
-		return StatePools[Idx].get();
+		CachedState->IncreaseRefCount();
+		return StatePools.GetHandle(CachedState);
 	}
 
 	NewState->SetGfxCache(this);
+
+	// the pipeline is created when the batch ends
+	if (PipelineBatchDepth > 0)
+	{
+		NewState->IncreaseRefCount();
+		PendingStates.push_back(NewState.get());
+		return StatePools.Add(NewState, Hash);
+	}
 	
 	if (!NewState->CreateState(InInfo))
 	{
-		return nullptr;
+		return UHResourceHandle();
 	}
 
 	NewState->IncreaseRefCount();
-	StatePools.push_back(std::move(NewState));
-	return StatePools.back().get();
+	return StatePools.Add(NewState, Hash);
 }
 
-void UHGraphic::RequestReleaseGraphicState(UHGraphicState* InState)
+void UHGraphic::RequestReleaseGraphicState(UHResourceHandle InHandle)
 {
 	std::unique_lock<std::mutex> Lock(Mutex);
+
+	// a stale handle doesn't resolve, e.g. the state failed in a batch and it's released already
+	UHGraphicState* InState = StatePools.Get(InHandle);
 	if (InState == nullptr)
 	{
 		return;
 	}
 
-	int32_t Idx = UHUtilities::FindIndex(StatePools, *InState);
-	if (Idx != UHINDEXNONE)
+	// since a graphic state could be referenced by multiple shader record
+	// only release and remove it from the pool when ref count = 0
+	InState->DecreaseRefCount();
+	if (InState->GetRefCount() == 0)
 	{
-		// since a graphic state could be referenced by multiple shader record
-		// only release and remove it from the pool when ref count = 0
-		InState->DecreaseRefCount();
-		if (InState->GetRefCount() == 0)
-		{
-			StatePools[Idx]->Release();
-			StatePools[Idx].reset();
-			UHUtilities::RemoveByIndex(StatePools, Idx);
-		}
+		// a state released within the same batch doesn't need its pipeline anymore
+		PendingStates.erase(std::remove(PendingStates.begin(), PendingStates.end(), InState), PendingStates.end());
+		UniquePtr<UHGraphicState> State = StatePools.Remove(InState);
+		State->Release();
 	}
 }
 
-UHGraphicState* UHGraphic::RequestRTState(UHRayTracingInfo InInfo)
+UHResourceHandle UHGraphic::RequestRTState(UHRayTracingInfo InInfo)
 {
 	std::unique_lock<std::mutex> Lock(Mutex);
 	UniquePtr<UHGraphicState> NewState = MakeUnique<UHGraphicState>(InInfo);
 
 	// check cached state first
-	int32_t Idx = UHUtilities::FindIndex(StatePools, *NewState.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = NewState->GetHash();
+	if (UHGraphicState* CachedState = StatePools.Find(Hash, *NewState))
 	{
-		StatePools[Idx]->IncreaseRefCount();
-		return StatePools[Idx].get();
+		CachedState->IncreaseRefCount();
+		return StatePools.GetHandle(CachedState);
 	}
 
 	NewState->SetGfxCache(this);
 
 	if (!NewState->CreateState(InInfo))
 	{
-		return nullptr;
+		return UHResourceHandle();
 	}
 
 	NewState->IncreaseRefCount();
-	StatePools.push_back(std::move(NewState));
-	return StatePools.back().get();
+	return StatePools.Add(NewState, Hash);
 }
 
-UHComputeState* UHGraphic::RequestComputeState(UHComputePassInfo InInfo)
+UHResourceHandle UHGraphic::RequestComputeState(UHComputePassInfo InInfo)
 {
 	std::unique_lock<std::mutex> Lock(Mutex);
 	UniquePtr<UHComputeState> NewState = MakeUnique<UHComputeState>(InInfo);
 
 	// check cached state first
-	int32_t Idx = UHUtilities::FindIndex(StatePools, *NewState.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = NewState->GetHash();
+	if (UHGraphicState* CachedState = StatePools.Find(Hash, *NewState))
 	{
-		StatePools[Idx]->IncreaseRefCount();
-		return StatePools[Idx].get();
+		CachedState->IncreaseRefCount();
+		return StatePools.GetHandle(CachedState);
 	}
 
 	NewState->SetGfxCache(this);
 
 	if (!NewState->CreateState(InInfo))
 	{
-		return nullptr;
+		return UHResourceHandle();
 	}
 
 	NewState->IncreaseRefCount();
-	StatePools.push_back(std::move(NewState));
-	return StatePools.back().get();
+	return StatePools.Add(NewState, Hash);
+}
+
+UHGraphicState* UHGraphic::GetGraphicState(UHResourceHandle InHandle) const
+{
+	return StatePools.Get(InHandle);
+}
+
+void UHGraphic::BeginPipelineBatch()
+{
+	std::unique_lock<std::mutex> Lock(Mutex);
+	PipelineBatchDepth++;
+}
+
+void UHGraphic::EndPipelineBatch(UHJobSystem* InJobSystem)
+{
+	std::vector<UHGraphicState*> States;
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		assert(PipelineBatchDepth > 0);
+		if (--PipelineBatchDepth > 0)
+		{
+			return;
+		}
+		States = std::move(PendingStates);
+		PendingStates.clear();
+	}
+
+	if (States.size() == 0)
+	{
+		return;
+	}
+
+	// pipeline creation with a shared VkPipelineCache is thread-safe, each job only writes its own state
+	std::vector<uint8_t> IsFailed(States.size(), 0);
+	InJobSystem->ParallelFor(static_cast<int32_t>(States.size()), 1, [&States, &IsFailed](int32_t Begin, int32_t End, int32_t WorkerIdx)
+	{
+		for (int32_t Idx = Begin; Idx < End; Idx++)
+		{
+			IsFailed[Idx] = States[Idx]->CreateState(States[Idx]->GetRenderPassInfo()) ? 0 : 1;
+		}
+	});
+
+	// failed states are released now, their handles go stale and resolve to nullptr like a failed non-batch request
+	uint32_t NumFailed = 0;
+	std::unique_lock<std::mutex> Lock(Mutex);
+	for (size_t Idx = 0; Idx < States.size(); Idx++)
+	{
+		if (IsFailed[Idx])
+		{
+			UniquePtr<UHGraphicState> State = StatePools.Remove(States[Idx]);
+			State->Release();
+			NumFailed++;
+		}
+	}
+
+	if (NumFailed > 0)
+	{
+		UHE_LOG(L"Failed to create " + std::to_wstring(NumFailed) + L" graphic states in the batch!\n");
+	}
 }
 
 UHSampler* UHGraphic::RequestTextureSampler(UHSamplerInfo InInfo)
 {
 	UniquePtr<UHSampler> NewSampler = MakeUnique<UHSampler>(InInfo);
 
-	int32_t Idx = UHUtilities::FindIndex(SamplerPools, *NewSampler.get());
-	if (Idx != UHINDEXNONE)
+	const size_t Hash = InInfo.GetHash();
+	if (UHSampler* CachedSampler = SamplerPools.Find(Hash, *NewSampler))
 	{
-		return SamplerPools[Idx].get();
+		return CachedSampler;
 	}
 
 	// create new one if cache fails
@@ -1495,8 +1599,9 @@ UHSampler* UHGraphic::RequestTextureSampler(UHSamplerInfo InInfo)
 		return nullptr;
 	}
 
-	SamplerPools.push_back(std::move(NewSampler));
-	return SamplerPools.back().get();
+	UHSampler* Sampler = NewSampler.get();
+	SamplerPools.Add(NewSampler, Hash);
+	return Sampler;
 }
 
 VkInstance UHGraphic::GetInstance() const
@@ -1519,6 +1624,11 @@ UHQueueFamily UHGraphic::GetQueueFamily() const
 	return QueueFamily;
 }
 
+VkPipelineCache UHGraphic::GetPipelineCache() const
+{
+	return PipelineCache;
+}
+
 VkSwapchainKHR UHGraphic::GetSwapChain() const
 {
 	return SwapChain;
@@ -1569,6 +1679,45 @@ float UHGraphic::GetGPUTimeStampPeriod() const
 	return GPUTimeStampPeriod;
 }
 
+uint32_t UHGraphic::GetTimestampValidBits(uint32_t InQueueFamily) const
+{
+	return (InQueueFamily < QueueTimestampValidBits.size()) ? QueueTimestampValidBits[InQueueFamily] : 0;
+}
+
+bool UHGraphic::GetCalibratedTimestamp(uint64_t& OutGPUTick, int64_t& OutCPUTime, uint64_t& OutMaxDeviation) const
+{
+	if (!bSupportCalibratedTimestamps)
+	{
+		return false;
+	}
+
+	VkCalibratedTimestampInfoEXT TimestampInfos[2]{};
+	TimestampInfos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	TimestampInfos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+	TimestampInfos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	TimestampInfos[1].timeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+
+	uint64_t Timestamps[2] = { 0 };
+	if (GVkGetCalibratedTimestampsEXT(LogicalDevice, 2, TimestampInfos, Timestamps, &OutMaxDeviation) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	OutGPUTick = Timestamps[0];
+	OutCPUTime = static_cast<int64_t>(Timestamps[1]);
+	return true;
+}
+
+bool UHGraphic::IsCalibratedTimestampSupported() const
+{
+	return bSupportCalibratedTimestamps;
+}
+
+bool UHGraphic::IsNullBackend() const
+{
+	return bIsNullBackend;
+}
+
 bool UHGraphic::IsDepthPrePassEnabled() const
 {
 	return bEnableDepthPrePass;
@@ -1599,13 +1748,21 @@ bool UHGraphic::IsMeshShaderSupported() const
 	return bSupportMeshShader;
 }
 
+bool UHGraphic::IsDrawIndirectFirstInstanceSupported() const
+{
+	return bSupportDrawIndirectFirstInstance;
+}
+
+bool UHGraphic::IsDrawIndirectCountSupported() const
+{
+	return bSupportDrawIndirectCount;
+}
+
 std::vector<UHSampler*> UHGraphic::GetSamplers() const
 {
-	std::vector<UHSampler*> Samplers(SamplerPools.size());
-	for (size_t Idx = 0; Idx < Samplers.size(); Idx++)
-	{
-		Samplers[Idx] = SamplerPools[Idx].get();
-	}
+	std::vector<UHSampler*> Samplers;
+	Samplers.reserve(SamplerPools.Size());
+	SamplerPools.ForEach([&Samplers](UHSampler* InSampler) { Samplers.push_back(InSampler); });
 
 	return Samplers;
 }
@@ -1771,7 +1928,7 @@ bool UHGraphic::RecreateImGui()
 	InitInfo.Device = GetLogicalDevice();
 	InitInfo.QueueFamily = GetQueueFamily().GraphicsFamily.value();
 	InitInfo.Queue = GetGraphicsQueue();
-	InitInfo.PipelineCache = nullptr;
+	InitInfo.PipelineCache = PipelineCache;
 	InitInfo.DescriptorPool = ImGuiDescriptorPool;
 	InitInfo.Subpass = 0;
 	InitInfo.MinImageCount = GetMinImageCount();
@@ -1954,4 +2111,152 @@ std::vector<uint32_t> UHGraphic::GetMemoryTypeIndices(VkMemoryPropertyFlags InFl
 	}
 
 	return OutTypes;
+}
+
+// header written before the pipeline cache data, the cache is only reused if all device and driver identifiers match
+struct UHPipelineCacheHeader
+{
+	uint32_t Version;
+	uint32_t VendorID;
+	uint32_t DeviceID;
+	uint32_t DriverVersion;
+	uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+	uint8_t DeviceUUID[VK_UUID_SIZE];
+	uint8_t DriverUUID[VK_UUID_SIZE];
+	uint64_t DataSize;
+	size_t DataHash;
+};
+
+// bump this if the header layout changes
+static const uint32_t GPipelineCacheVersion = 1;
+
+UHPipelineCacheHeader GetPipelineCacheHeader(VkPhysicalDevice InDevice)
+{
+	VkPhysicalDeviceIDProperties IDProps{};
+	IDProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 Props2{};
+	Props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	Props2.pNext = &IDProps;
+	vkGetPhysicalDeviceProperties2(InDevice, &Props2);
+
+	UHPipelineCacheHeader Header{};
+	Header.Version = GPipelineCacheVersion;
+	Header.VendorID = Props2.properties.vendorID;
+	Header.DeviceID = Props2.properties.deviceID;
+	Header.DriverVersion = Props2.properties.driverVersion;
+	memcpy(Header.PipelineCacheUUID, Props2.properties.pipelineCacheUUID, VK_UUID_SIZE);
+	memcpy(Header.DeviceUUID, IDProps.deviceUUID, VK_UUID_SIZE);
+	memcpy(Header.DriverUUID, IDProps.driverUUID, VK_UUID_SIZE);
+
+	return Header;
+}
+
+bool UHGraphic::CreatePipelineCache()
+{
+	const std::string CachePath = GPipelineCachePath + GPipelineCacheName + GPipelineCacheExtension;
+	const UHPipelineCacheHeader ExpectedHeader = GetPipelineCacheHeader(PhysicalDevice);
+	std::vector<uint8_t> CacheData;
+
+	std::ifstream FileIn(CachePath, std::ios::in | std::ios::binary);
+	if (FileIn.is_open())
+	{
+		UHPipelineCacheHeader Header{};
+		FileIn.read(reinterpret_cast<char*>(&Header), sizeof(UHPipelineCacheHeader));
+
+		// validate against current device and driver, a different GPU or a driver update invalidates the cache
+		bool bIsValid = FileIn.good()
+			&& Header.Version == ExpectedHeader.Version
+			&& Header.VendorID == ExpectedHeader.VendorID
+			&& Header.DeviceID == ExpectedHeader.DeviceID
+			&& Header.DriverVersion == ExpectedHeader.DriverVersion
+			&& memcmp(Header.PipelineCacheUUID, ExpectedHeader.PipelineCacheUUID, VK_UUID_SIZE) == 0
+			&& memcmp(Header.DeviceUUID, ExpectedHeader.DeviceUUID, VK_UUID_SIZE) == 0
+			&& memcmp(Header.DriverUUID, ExpectedHeader.DriverUUID, VK_UUID_SIZE) == 0
+			&& Header.DataSize >= sizeof(VkPipelineCacheHeaderVersionOne);
+
+		if (bIsValid)
+		{
+			CacheData.resize(Header.DataSize);
+			FileIn.read(reinterpret_cast<char*>(CacheData.data()), Header.DataSize);
+			bIsValid = FileIn.gcount() == static_cast<std::streamsize>(Header.DataSize)
+				&& std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(CacheData.data()), CacheData.size())) == Header.DataHash;
+		}
+
+		// the driver validates its own header too, but check it here so a corrupted file is never passed to the driver
+		if (bIsValid)
+		{
+			VkPipelineCacheHeaderVersionOne DriverHeader{};
+			memcpy(&DriverHeader, CacheData.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+			bIsValid = DriverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+				&& DriverHeader.vendorID == ExpectedHeader.VendorID
+				&& DriverHeader.deviceID == ExpectedHeader.DeviceID
+				&& memcmp(DriverHeader.pipelineCacheUUID, ExpectedHeader.PipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+
+		if (!bIsValid)
+		{
+			UHE_LOG(L"Pipeline cache is outdated or corrupted, it will be rebuilt.\n");
+			CacheData.clear();
+		}
+		FileIn.close();
+	}
+
+	VkPipelineCacheCreateInfo CreateInfo{};
+	CreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	CreateInfo.initialDataSize = CacheData.size();
+	CreateInfo.pInitialData = CacheData.empty() ? nullptr : CacheData.data();
+
+	if (vkCreatePipelineCache(LogicalDevice, &CreateInfo, nullptr, &PipelineCache) != VK_SUCCESS)
+	{
+		// try again with an empty cache before giving up
+		CreateInfo.initialDataSize = 0;
+		CreateInfo.pInitialData = nullptr;
+		if (vkCreatePipelineCache(LogicalDevice, &CreateInfo, nullptr, &PipelineCache) != VK_SUCCESS)
+		{
+			UHE_LOG(L"Failed to create pipeline cache!\n");
+			return false;
+		}
+	}
+
+#if WITH_EDITOR
+	SetDebugUtilsObjectName(VK_OBJECT_TYPE_PIPELINE_CACHE, (uint64_t)PipelineCache, "MainPipelineCache");
+#endif
+
+	return true;
+}
+
+void UHGraphic::SavePipelineCache()
+{
+	if (PipelineCache == nullptr)
+	{
+		return;
+	}
+
+	size_t DataSize = 0;
+	if (vkGetPipelineCacheData(LogicalDevice, PipelineCache, &DataSize, nullptr) != VK_SUCCESS || DataSize == 0)
+	{
+		return;
+	}
+
+	std::vector<uint8_t> CacheData(DataSize);
+	if (vkGetPipelineCacheData(LogicalDevice, PipelineCache, &DataSize, CacheData.data()) != VK_SUCCESS)
+	{
+		return;
+	}
+	CacheData.resize(DataSize);
+
+	if (!std::filesystem::exists(GPipelineCachePath))
+	{
+		std::filesystem::create_directories(GPipelineCachePath);
+	}
+
+	UHPipelineCacheHeader Header = GetPipelineCacheHeader(PhysicalDevice);
+	Header.DataSize = CacheData.size();
+	Header.DataHash = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(CacheData.data()), CacheData.size()));
+
+	std::ofstream FileOut(GPipelineCachePath + GPipelineCacheName + GPipelineCacheExtension, std::ios::out | std::ios::binary);
+	FileOut.write(reinterpret_cast<const char*>(&Header), sizeof(UHPipelineCacheHeader));
+	FileOut.write(reinterpret_cast<const char*>(CacheData.data()), CacheData.size());
+	FileOut.close();
 }
\ No newline at end of file
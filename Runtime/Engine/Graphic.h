@@ -18,6 +18,7 @@
 #include "../CoreGlobals.h"
 #include "../Classes/AccelerationStructure.h"
 #include "../Classes/GPUMemory.h"
+#include "ResourcePool.h"
 
 // queue family structure
 struct UHQueueFamily
@@ -99,6 +100,7 @@ struct UHTransitionInfo
 
 class UHEngine;
 class UHPreviewScene;
+class UHJobSystem;
 
 // Unheard engine graphics class, mainly for device creation
 class UHGraphic
@@ -109,6 +111,13 @@ public:
 	// function to init graphics
 	bool InitGraphics(HWND Hwnd);
 
+#if WITH_EDITOR
+	// init without a device for headless CPU benchmarks, render buffers are kept in host memory and nothing is submitted
+	// device features are given by caller so the renderer can take either path, ray tracing is always off
+	// indirect count draws come with the indirect first instance flag, both are required by the GPU-driven path
+	bool InitNullBackend(bool bInSupportMeshShader, bool bInSupportDrawIndirectFirstInstance);
+#endif
+
 	// function to release graphics
 	void Release();
 
@@ -171,7 +180,7 @@ public:
 		}
 
 #if WITH_EDITOR
-		if (InElementCount > 0)
+		if (InElementCount > 0 && !bIsNullBackend)
 		{
 			SetDebugUtilsObjectName(VK_OBJECT_TYPE_BUFFER, (uint64_t)NewBuffer->GetBuffer(), InName);
 		}
@@ -191,11 +200,21 @@ public:
 		, UHMaterialCompileData InData, std::vector<std::string> InMacro = std::vector<std::string>());
 	void RequestReleaseShader(uint32_t InShaderID);
 
-	// request graphic/RT state
-	UHGraphicState* RequestGraphicState(UHRenderPassInfo InInfo);
-	void RequestReleaseGraphicState(UHGraphicState* InState);
-	UHGraphicState* RequestRTState(UHRayTracingInfo InInfo);
-	UHComputeState* RequestComputeState(UHComputePassInfo InInfo);
+	// request graphic/RT state, the returned handle is resolved with GetGraphicState()
+	// an invalid or released handle resolves to nullptr, so a stale handle never reaches a reused slot
+	UHResourceHandle RequestGraphicState(UHRenderPassInfo InInfo);
+	void RequestReleaseGraphicState(UHResourceHandle InHandle);
+	UHResourceHandle RequestRTState(UHRayTracingInfo InInfo);
+	UHResourceHandle RequestComputeState(UHComputePassInfo InInfo);
+
+	// states are only added or removed while the render thread is idle, so the lookup doesn't lock
+	UHGraphicState* GetGraphicState(UHResourceHandle InHandle) const;
+
+	// batched graphic state creation, the states requested between begin and end are returned without pipelines
+	// and their pipelines are created in parallel when the outermost batch ends.
+	// states failed to create are released, their handles resolve to nullptr like a failed non-batch request
+	void BeginPipelineBatch();
+	void EndPipelineBatch(UHJobSystem* InJobSystem);
 
 	// request a texture sampler
 	UHSampler* RequestTextureSampler(UHSamplerInfo InInfo);
@@ -212,6 +231,9 @@ public:
 	// get queue family
 	UHQueueFamily GetQueueFamily() const;
 
+	// get pipeline cache
+	VkPipelineCache GetPipelineCache() const;
+
 	// get swap chain
 	VkSwapchainKHR GetSwapChain() const;
 
@@ -242,12 +264,22 @@ public:
 	// get gpu time stamp period
 	float GetGPUTimeStampPeriod() const;
 
+	// valid bits of timestamps written on a queue family, 0 means timestamps aren't supported on it
+	uint32_t GetTimestampValidBits(uint32_t InQueueFamily) const;
+
+	// sample the device clock and QPC at the same moment, the deviation is in nanoseconds
+	bool GetCalibratedTimestamp(uint64_t& OutGPUTick, int64_t& OutCPUTime, uint64_t& OutMaxDeviation) const;
+
 	bool IsDepthPrePassEnabled() const;
 	bool IsRayTracingEnabled() const;
 	bool IsDebugLayerEnabled() const;
 	bool IsHDRAvailable() const;
 	bool Is24BitDepthSupported() const;
 	bool IsMeshShaderSupported() const;
+	bool IsDrawIndirectFirstInstanceSupported() const;
+	bool IsDrawIndirectCountSupported() const;
+	bool IsCalibratedTimestampSupported() const;
+	bool IsNullBackend() const;
 
 	// get all samplers
 	std::vector<UHSampler*> GetSamplers() const;
@@ -316,6 +348,10 @@ private:
 	// get memory type indices (internal use)
 	std::vector<uint32_t> GetMemoryTypeIndices(VkMemoryPropertyFlags InFlags) const;
 
+	// create pipeline cache from the disk cache, and save it back before the device is destroyed
+	bool CreatePipelineCache();
+	void SavePipelineCache();
+
 
 	/** ====================================================== Variables ====================================================== **/
 
@@ -358,6 +394,13 @@ private:
 	// render pass is an object which contains frame buffer attachment info, similar to the resource transition part of D3D12
 	VkRenderPass SwapChainRenderPass;
 
+	// pipeline cache shared by all states, it's serialized to disk and only reused on the same device and driver
+	VkPipelineCache PipelineCache;
+
+	// graphic states waiting for pipeline creation in the current batch
+	std::vector<UHGraphicState*> PendingStates;
+	int32_t PipelineBatchDepth;
+
 	// if to use debug validation layer 
 	bool bUseValidationLayers;
 
@@ -389,18 +432,23 @@ private:
 	bool bSupportHDR;
 	bool bSupport24BitDepth;
 	bool bSupportMeshShader;
+	bool bSupportDrawIndirectFirstInstance;
+	bool bSupportDrawIndirectCount;
+	bool bSupportCalibratedTimestamps;
+	bool bIsNullBackend;
+	std::vector<uint32_t> QueueTimestampValidBits;
 	std::mutex Mutex;
 
 protected:
-	// system managed pools
-	std::vector<UniquePtr<UHShader>> ShaderPools;
-	std::vector<UniquePtr<UHGraphicState>> StatePools;
-	std::vector<UniquePtr<UHRenderTexture>> RTPools;
-	std::vector<UniquePtr<UHSampler>> SamplerPools;
-	std::vector<UniquePtr<UHTexture2D>> Texture2DPools;
-	std::vector<UniquePtr<UHTextureCube>> TextureCubePools;
-	std::vector<UniquePtr<UHMaterial>> MaterialPools;
-	std::vector<UniquePtr<UHGPUQuery>> QueryPools;
+	// system managed pools, the cached ones are looked up by their descriptor hash
+	UHResourcePool<UHShader> ShaderPools;
+	UHResourcePool<UHGraphicState> StatePools;
+	UHResourcePool<UHRenderTexture> RTPools;
+	UHResourcePool<UHSampler> SamplerPools;
+	UHResourcePool<UHTexture2D> Texture2DPools;
+	UHResourcePool<UHTextureCube> TextureCubePools;
+	UHResourcePool<UHMaterial> MaterialPools;
+	UHResourcePool<UHGPUQuery> QueryPools;
 
 	// shared GPU memory
 	UniquePtr<UHGPUMemory> MeshBufferSharedMemory;
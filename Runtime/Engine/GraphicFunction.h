@@ -25,4 +25,6 @@ inline PFN_vkSetHdrMetadataEXT GVkSetHdrMetadataEXT;
 inline PFN_vkCmdPushDescriptorSetKHR GVkCmdPushDescriptorSetKHR;
 inline PFN_vkCmdBeginConditionalRenderingEXT GVkCmdBeginConditionalRenderingEXT;
 inline PFN_vkCmdEndConditionalRenderingEXT GVkCmdEndConditionalRenderingEXT;
-inline PFN_vkCmdDrawMeshTasksEXT GVkCmdDrawMeshTasksEXT;
\ No newline at end of file
+inline PFN_vkCmdDrawMeshTasksEXT GVkCmdDrawMeshTasksEXT;
+inline PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT GVkGetPhysicalDeviceCalibrateableTimeDomainsEXT;
+inline PFN_vkGetCalibratedTimestampsEXT GVkGetCalibratedTimestampsEXT;
\ No newline at end of file
@@ -0,0 +1,221 @@
+#pragma once
+#include "../../UnheardEngine.h"
+#include <vector>
+#include <unordered_map>
+
+// handle of a pooled resource, the generation of a slot is increased whenever it's freed
+// so a stale handle never resolves to the object that reuses the slot
+struct UHResourceHandle
+{
+	UHResourceHandle()
+		: Index(UHINDEXNONE)
+		, Generation(0)
+	{
+
+	}
+
+	UHResourceHandle(int32_t InIndex, uint32_t InGeneration)
+		: Index(InIndex)
+		, Generation(InGeneration)
+	{
+
+	}
+
+	bool IsValid() const
+	{
+		return Index != UHINDEXNONE;
+	}
+
+	int32_t Index;
+	uint32_t Generation;
+};
+
+// pool of render resources owned by UHGraphic
+// objects are found by a descriptor hash and confirmed with their operator==, and removed through a pointer lookup
+// freed slots are recycled with a free list, so removal doesn't shift the other objects
+template <typename T>
+class UHResourcePool
+{
+public:
+	UHResourcePool()
+		: NumObjects(0)
+	{
+
+	}
+
+	void Reserve(size_t InCount)
+	{
+		Slots.reserve(InCount);
+		SlotsByHash.reserve(InCount);
+		SlotByObject.reserve(InCount);
+	}
+
+	// find the pooled object equal to the key, the hash only narrows down the candidates
+	T* Find(size_t InHash, const T& InKey) const
+	{
+		const auto Range = SlotsByHash.equal_range(InHash);
+		for (auto It = Range.first; It != Range.second; It++)
+		{
+			T* Candidate = Slots[It->second].Object.get();
+			if (*Candidate == InKey)
+			{
+				return Candidate;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// add an object which can be found by the hash
+	UHResourceHandle Add(UniquePtr<T>& InObject, size_t InHash)
+	{
+		const UHResourceHandle Handle = Add(InObject);
+		Slots[Handle.Index].Hash = InHash;
+		Slots[Handle.Index].bIsHashed = true;
+		SlotsByHash.emplace(InHash, Handle.Index);
+
+		return Handle;
+	}
+
+	// add an object without the hash, it can only be reached by the pointer or handle
+	UHResourceHandle Add(UniquePtr<T>& InObject)
+	{
+		int32_t SlotIdx;
+		if (!FreeSlots.empty())
+		{
+			SlotIdx = FreeSlots.back();
+			FreeSlots.pop_back();
+		}
+		else
+		{
+			SlotIdx = static_cast<int32_t>(Slots.size());
+			Slots.push_back(UHPoolSlot());
+		}
+
+		UHPoolSlot& Slot = Slots[SlotIdx];
+		Slot.Object = std::move(InObject);
+		Slot.bIsHashed = false;
+		SlotByObject[Slot.Object.get()] = SlotIdx;
+		NumObjects++;
+
+		return UHResourceHandle(SlotIdx, Slot.Generation);
+	}
+
+	T* Get(const UHResourceHandle& InHandle) const
+	{
+		if (!InHandle.IsValid() || InHandle.Index >= static_cast<int32_t>(Slots.size()))
+		{
+			return nullptr;
+		}
+
+		const UHPoolSlot& Slot = Slots[InHandle.Index];
+		return (Slot.Generation == InHandle.Generation) ? Slot.Object.get() : nullptr;
+	}
+
+	UHResourceHandle GetHandle(const T* InObject) const
+	{
+		const auto It = SlotByObject.find(InObject);
+		if (It == SlotByObject.end())
+		{
+			return UHResourceHandle();
+		}
+
+		return UHResourceHandle(It->second, Slots[It->second].Generation);
+	}
+
+	// remove the object from the pool and return its ownership, nullptr if it's not pooled
+	// caller decides how to release it
+	UniquePtr<T> Remove(const T* InObject)
+	{
+		const auto It = SlotByObject.find(InObject);
+		if (It == SlotByObject.end())
+		{
+			return nullptr;
+		}
+
+		const int32_t SlotIdx = It->second;
+		SlotByObject.erase(It);
+
+		UHPoolSlot& Slot = Slots[SlotIdx];
+		if (Slot.bIsHashed)
+		{
+			const auto Range = SlotsByHash.equal_range(Slot.Hash);
+			for (auto HashIt = Range.first; HashIt != Range.second; HashIt++)
+			{
+				if (HashIt->second == SlotIdx)
+				{
+					SlotsByHash.erase(HashIt);
+					break;
+				}
+			}
+		}
+
+		UniquePtr<T> Removed = std::move(Slot.Object);
+		Slot.Generation++;
+		Slot.bIsHashed = false;
+		FreeSlots.push_back(SlotIdx);
+		NumObjects--;
+
+		return Removed;
+	}
+
+	// visit the pooled objects in slot order
+	template <typename Func>
+	void ForEach(Func InFunc) const
+	{
+		for (const UHPoolSlot& Slot : Slots)
+		{
+			if (Slot.Object != nullptr)
+			{
+				InFunc(Slot.Object.get());
+			}
+		}
+	}
+
+	// release the GPU resources of all objects and clear the pool
+	void ReleaseAll()
+	{
+		for (UHPoolSlot& Slot : Slots)
+		{
+			UH_SAFE_RELEASE(Slot.Object);
+		}
+		Clear();
+	}
+
+	void Clear()
+	{
+		Slots.clear();
+		FreeSlots.clear();
+		SlotsByHash.clear();
+		SlotByObject.clear();
+		NumObjects = 0;
+	}
+
+	size_t Size() const
+	{
+		return NumObjects;
+	}
+
+private:
+	struct UHPoolSlot
+	{
+		UHPoolSlot()
+			: Hash(0)
+			, Generation(0)
+			, bIsHashed(false)
+		{
+
+		}
+
+		UniquePtr<T> Object;
+		size_t Hash;
+		uint32_t Generation;
+		bool bIsHashed;
+	};
+
+	std::vector<UHPoolSlot> Slots;
+	std::vector<int32_t> FreeSlots;
+	std::unordered_multimap<size_t, int32_t> SlotsByHash;
+	std::unordered_map<const T*, int32_t> SlotByObject;
+	size_t NumObjects;
+};
\ No newline at end of file
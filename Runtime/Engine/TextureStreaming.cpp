@@ -0,0 +1,509 @@
+#include "TextureStreaming.h"
+#include "Asset.h"
+#include "Graphic.h"
+#include "../Classes/MaterialLayout.h"
+#include "../Components/MeshRenderer.h"
+#include "../Components/Camera.h"
+#include "../Renderer/RenderBuilder.h"
+#include "../Renderer/ShaderClass/TextureSamplerTable.h"
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+// UHTextureResidencyPolicy
+UHTextureResidencyPolicy::UHTextureResidencyPolicy(uint64_t InBudgetBytes)
+	: BudgetBytes(InBudgetBytes)
+{
+
+}
+
+int32_t UHTextureResidencyPolicy::AddTexture(uint32_t Width, uint32_t Height, const std::vector<uint64_t>& InMipSizes, uint32_t InTailMip, uint32_t InResidentMip)
+{
+	UHStreamingTextureState NewTexture;
+	NewTexture.MaxSize = (std::max)(Width, Height);
+	NewTexture.MipSizes = InMipSizes;
+	NewTexture.TailMip = (std::min)(InTailMip, static_cast<uint32_t>(InMipSizes.size()) - 1);
+	NewTexture.ResidentMip = (std::min)(InResidentMip, NewTexture.TailMip);
+	NewTexture.RequestedMip = NewTexture.TailMip;
+	NewTexture.TargetMip = NewTexture.ResidentMip;
+	NewTexture.PendingMip = NewTexture.ResidentMip;
+
+	Textures.push_back(NewTexture);
+	return static_cast<int32_t>(Textures.size()) - 1;
+}
+
+void UHTextureResidencyPolicy::SetBudget(uint64_t InBudgetBytes)
+{
+	BudgetBytes = InBudgetBytes;
+}
+
+void UHTextureResidencyPolicy::RequestTexture(int32_t InTextureIdx, float InScreenSize)
+{
+	UHStreamingTextureState& Texture = Textures[InTextureIdx];
+	Texture.ScreenSize = (std::max)(Texture.ScreenSize, InScreenSize);
+}
+
+void UHTextureResidencyPolicy::Update(uint64_t InFrame)
+{
+	Report = UHTextureStreamingReport();
+	Report.BudgetBytes = BudgetBytes;
+	Report.NumTextures = static_cast<uint32_t>(Textures.size());
+
+	// step 1: the requested mip is the smallest one which still has a texel per pixel, textures out of view fall back to the tail
+	uint64_t TotalBytes = 0;
+	for (UHStreamingTextureState& Texture : Textures)
+	{
+		if (Texture.ScreenSize > 0.0f)
+		{
+			Texture.LastScreenSize = Texture.ScreenSize;
+			Texture.LastRequestFrame = InFrame;
+		}
+		else if (InFrame - Texture.LastRequestFrame > KeepRequestFrames)
+		{
+			Texture.LastScreenSize = 0.0f;
+		}
+
+		Texture.RequestedMip = Texture.TailMip;
+		if (Texture.LastScreenSize > 0.0f)
+		{
+			const float MipLevel = std::floor(std::log2(static_cast<float>(Texture.MaxSize) / Texture.LastScreenSize));
+			Texture.RequestedMip = static_cast<uint32_t>(std::clamp(MipLevel, static_cast<float>(Texture.MinMip), static_cast<float>(Texture.TailMip)));
+			Report.NumRequestedTextures++;
+		}
+
+		// mips which aren't requested anymore stay for a while, so a texture won't thrash around the boundary of two mips
+		Texture.CoarserFrames = (Texture.RequestedMip > Texture.ResidentMip) ? Texture.CoarserFrames + 1 : 0;
+		Texture.TargetMip = (Texture.RequestedMip > Texture.ResidentMip && Texture.CoarserFrames < EvictDelayFrames)
+			? Texture.ResidentMip : Texture.RequestedMip;
+
+		Report.RequestedBytes += GetMipRangeSize(Texture, Texture.RequestedMip);
+		Report.TailBytes += GetMipRangeSize(Texture, Texture.TailMip);
+		TotalBytes += GetMipRangeSize(Texture, Texture.TargetMip);
+		Texture.ScreenSize = 0.0f;
+	}
+
+	// step 2: fit the budget, the top mip with the least pixels per texel is dropped first, and the larger one for a tie
+	if (TotalBytes > BudgetBytes)
+	{
+		typedef std::tuple<float, int64_t, int32_t> UHDropCandidate;
+		std::priority_queue<UHDropCandidate, std::vector<UHDropCandidate>, std::greater<UHDropCandidate>> Candidates;
+
+		for (int32_t Idx = 0; Idx < static_cast<int32_t>(Textures.size()); Idx++)
+		{
+			const UHStreamingTextureState& Texture = Textures[Idx];
+			if (Texture.TargetMip < Texture.TailMip)
+			{
+				Candidates.push(UHDropCandidate(GetPixelsPerTexel(Texture, Texture.TargetMip), -static_cast<int64_t>(Texture.MipSizes[Texture.TargetMip]), Idx));
+			}
+		}
+
+		while (TotalBytes > BudgetBytes && !Candidates.empty())
+		{
+			const int32_t Idx = std::get<2>(Candidates.top());
+			Candidates.pop();
+
+			UHStreamingTextureState& Texture = Textures[Idx];
+			TotalBytes -= Texture.MipSizes[Texture.TargetMip];
+			Texture.TargetMip++;
+
+			if (Texture.TargetMip < Texture.TailMip)
+			{
+				Candidates.push(UHDropCandidate(GetPixelsPerTexel(Texture, Texture.TargetMip), -static_cast<int64_t>(Texture.MipSizes[Texture.TargetMip]), Idx));
+			}
+		}
+	}
+
+	for (const UHStreamingTextureState& Texture : Textures)
+	{
+		Report.TargetBytes += GetMipRangeSize(Texture, Texture.TargetMip);
+		Report.ResidentBytes += GetMipRangeSize(Texture, Texture.ResidentMip);
+		Report.NumBudgetLimitedTextures += (Texture.TargetMip > Texture.RequestedMip) ? 1 : 0;
+		Report.NumPendingChanges += (Texture.bIsChanging) ? 1 : 0;
+	}
+}
+
+void UHTextureResidencyPolicy::CollectChanges(uint32_t InMaxChanges, std::vector<UHTextureStreamingChange>& OutChanges)
+{
+	OutChanges.clear();
+
+	// memory once the pending changes are done
+	int64_t ProjectedBytes = static_cast<int64_t>(Report.ResidentBytes);
+	std::vector<int32_t> Loads;
+	for (int32_t Idx = 0; Idx < static_cast<int32_t>(Textures.size()); Idx++)
+	{
+		const UHStreamingTextureState& Texture = Textures[Idx];
+		if (Texture.bIsChanging)
+		{
+			ProjectedBytes += static_cast<int64_t>(GetMipRangeSize(Texture, Texture.PendingMip)) - static_cast<int64_t>(GetMipRangeSize(Texture, Texture.ResidentMip));
+		}
+		else if (Texture.TargetMip > Texture.ResidentMip && OutChanges.size() < InMaxChanges)
+		{
+			ProjectedBytes -= static_cast<int64_t>(GetMipRangeSize(Texture, Texture.ResidentMip) - GetMipRangeSize(Texture, Texture.TargetMip));
+			OutChanges.push_back({ Idx, Texture.TargetMip });
+		}
+		else if (Texture.TargetMip < Texture.ResidentMip)
+		{
+			Loads.push_back(Idx);
+		}
+	}
+
+	// the most under-sampled textures load first
+	std::sort(Loads.begin(), Loads.end(), [this](int32_t A, int32_t B)
+		{
+			return GetPixelsPerTexel(Textures[A], Textures[A].ResidentMip) > GetPixelsPerTexel(Textures[B], Textures[B].ResidentMip);
+		});
+
+	for (const int32_t Idx : Loads)
+	{
+		if (OutChanges.size() >= InMaxChanges)
+		{
+			break;
+		}
+
+		const UHStreamingTextureState& Texture = Textures[Idx];
+		const int64_t GrowBytes = static_cast<int64_t>(GetMipRangeSize(Texture, Texture.TargetMip) - GetMipRangeSize(Texture, Texture.ResidentMip));
+		if (ProjectedBytes + GrowBytes > static_cast<int64_t>(BudgetBytes))
+		{
+			continue;
+		}
+
+		ProjectedBytes += GrowBytes;
+		OutChanges.push_back({ Idx, Texture.TargetMip });
+	}
+
+	for (const UHTextureStreamingChange& Change : OutChanges)
+	{
+		Textures[Change.TextureIndex].bIsChanging = true;
+		Textures[Change.TextureIndex].PendingMip = Change.NewResidentMip;
+	}
+}
+
+void UHTextureResidencyPolicy::FinishChange(int32_t InTextureIdx, uint32_t InResidentMip, bool bSucceeded)
+{
+	UHStreamingTextureState& Texture = Textures[InTextureIdx];
+
+	// the target and the report of this frame were decided before the change finished, keep them in sync with the new mips,
+	// otherwise CollectChanges() would start the opposite change right away or count the budget with the old size
+	Report.ResidentBytes = Report.ResidentBytes + GetMipRangeSize(Texture, InResidentMip) - GetMipRangeSize(Texture, Texture.ResidentMip);
+	Texture.ResidentMip = InResidentMip;
+	Texture.TargetMip = InResidentMip;
+	Texture.PendingMip = InResidentMip;
+	Texture.bIsChanging = false;
+	Texture.CoarserFrames = 0;
+
+	if (!bSucceeded)
+	{
+		Texture.MinMip = InResidentMip;
+		Texture.TailMip = InResidentMip;
+	}
+}
+
+const UHTextureStreamingReport& UHTextureResidencyPolicy::GetReport() const
+{
+	return Report;
+}
+
+const UHStreamingTextureState& UHTextureResidencyPolicy::GetTexture(int32_t InTextureIdx) const
+{
+	return Textures[InTextureIdx];
+}
+
+int32_t UHTextureResidencyPolicy::GetTextureCount() const
+{
+	return static_cast<int32_t>(Textures.size());
+}
+
+float UHTextureResidencyPolicy::GetProjectedSize(float InWorldSize, float InDistance, float InProjectionScale)
+{
+	return InWorldSize * InProjectionScale / (std::max)(InDistance, 0.001f);
+}
+
+uint64_t UHTextureResidencyPolicy::GetMipRangeSize(const UHStreamingTextureState& InTexture, uint32_t InFirstMip) const
+{
+	uint64_t Size = 0;
+	for (size_t MipIdx = InFirstMip; MipIdx < InTexture.MipSizes.size(); MipIdx++)
+	{
+		Size += InTexture.MipSizes[MipIdx];
+	}
+
+	return Size;
+}
+
+float UHTextureResidencyPolicy::GetPixelsPerTexel(const UHStreamingTextureState& InTexture, uint32_t InMip) const
+{
+	return InTexture.LastScreenSize / static_cast<float>((std::max)(InTexture.MaxSize >> InMip, 1u));
+}
+
+// UHTextureMipReadTask
+UHTextureMipReadTask::UHTextureMipReadTask(UHTexture2D* InTexture, int32_t InTextureIdx, uint32_t InFirstMip)
+	: Texture(InTexture)
+	, TextureIndex(InTextureIdx)
+	, FirstMip(InFirstMip)
+	, bSucceeded(false)
+{
+
+}
+
+void UHTextureMipReadTask::DoTask(const int32_t ThreadIndex)
+{
+	bSucceeded = Texture->ReadMipChunks(FirstMip, Data);
+}
+
+// UHTextureStreamer
+UHTextureStreamer::UHTextureStreamer(UHGraphic* InGfx, UHAssetManager* InAssetMgr, uint64_t InBudgetBytes)
+	: GfxCache(InGfx)
+	, AssetMgr(InAssetMgr)
+	, Policy(InBudgetBytes)
+	, NumSyncedTextures(0)
+	, FrameCount(0)
+{
+	StreamingJobSystem = MakeUnique<UHJobSystem>();
+	StreamingJobSystem->Initialize(NumStreamingWorkers);
+}
+
+void UHTextureStreamer::Release()
+{
+	for (const UniquePtr<UHTextureMipReadTask>& Read : PendingReads)
+	{
+		StreamingJobSystem->Wait(&Read->Counter);
+	}
+	PendingReads.clear();
+
+	// GPU is idle at release, the retired objects can go now
+	ReleaseRetiredObjects(UINT64_MAX);
+	PendingUploads.clear();
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		PendingSlotUpdates[Idx].clear();
+	}
+
+	StreamingJobSystem->Release();
+	StreamingJobSystem.reset();
+}
+
+void UHTextureStreamer::RequestTextures(const std::vector<UHMeshRendererComponent*>& InRenderers, const UHCameraComponent* InCamera, float InViewHeight)
+{
+	SyncTextures();
+	if (InCamera == nullptr)
+	{
+		return;
+	}
+
+	// the projected size of the renderer bound, assuming the UV range [0,1] spans over the bound
+	const XMFLOAT3 CameraPosition = InCamera->GetPosition();
+	const XMVECTOR CameraPos = XMLoadFloat3(&CameraPosition);
+	const float ProjectionScale = InCamera->GetProjectionMatrixNonJittered()._22 * InViewHeight * 0.5f;
+
+	for (UHMeshRendererComponent* Renderer : InRenderers)
+	{
+		const std::vector<int32_t>& Textures = GetMaterialTextures(Renderer->GetMaterial());
+		if (Textures.empty())
+		{
+			continue;
+		}
+
+		const BoundingBox Bound = Renderer->GetRendererBound();
+		const float Radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&Bound.Extents)));
+		const float Distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&Bound.Center) - CameraPos)) - Radius;
+		const float ScreenSize = UHTextureResidencyPolicy::GetProjectedSize(Radius * 2.0f, (std::max)(Distance, InCamera->GetNearPlane()), ProjectionScale);
+
+		for (const int32_t TextureIdx : Textures)
+		{
+			Policy.RequestTexture(TextureIdx, ScreenSize);
+		}
+	}
+}
+
+void UHTextureStreamer::Update(UHTextureTable* InTextureTable, uint32_t InFrameIdx)
+{
+	SyncTextures();
+	Policy.Update(FrameCount++);
+	ReleaseRetiredObjects(FrameCount);
+	ApplyFinishedReads();
+	UpdateTextureSlots(InTextureTable, InFrameIdx);
+
+	// dispatch new reads
+	Policy.CollectChanges(MaxInFlightReads - static_cast<uint32_t>(PendingReads.size()), Changes);
+	for (const UHTextureStreamingChange& Change : Changes)
+	{
+		UniquePtr<UHTextureMipReadTask> Read = MakeUnique<UHTextureMipReadTask>(StreamedTextures[Change.TextureIndex], Change.TextureIndex, Change.NewResidentMip);
+		StreamingJobSystem->Schedule(Read.get(), &Read->Counter);
+		PendingReads.push_back(std::move(Read));
+	}
+}
+
+void UHTextureStreamer::RecordUploads(UHRenderBuilder& InRenderBuilder)
+{
+	if (PendingUploads.empty())
+	{
+		return;
+	}
+
+	// the swapped images are uploaded before anything samples them in this frame
+	GfxCache->BeginCmdDebug(InRenderBuilder.GetCmdList(), "Upload streamed textures");
+	for (UHTexture2D* Texture : PendingUploads)
+	{
+		Texture->UploadToGPU(GfxCache, InRenderBuilder);
+	}
+	GfxCache->EndCmdDebug(InRenderBuilder.GetCmdList());
+}
+
+const UHTextureStreamingReport& UHTextureStreamer::GetReport() const
+{
+	return Policy.GetReport();
+}
+
+void UHTextureStreamer::SyncTextures()
+{
+	// referenced textures are only appended, track the new ones
+	const std::vector<UHTexture2D*>& ReferencedTextures = AssetMgr->GetReferencedTexture2Ds();
+	if (NumSyncedTextures == ReferencedTextures.size())
+	{
+		return;
+	}
+
+	for (size_t Idx = NumSyncedTextures; Idx < ReferencedTextures.size(); Idx++)
+	{
+		UHTexture2D* Texture = ReferencedTextures[Idx];
+		if (!Texture->IsStreamed() || TextureIndices.find(Texture) != TextureIndices.end())
+		{
+			continue;
+		}
+
+		const VkExtent2D Extent = Texture->GetExtent();
+		TextureIndices[Texture] = Policy.AddTexture(Extent.width, Extent.height, Texture->GetMipDataSizes(), Texture->GetMipTailIndex(), Texture->GetResidentMip());
+		StreamedTextures.push_back(Texture);
+	}
+
+	NumSyncedTextures = ReferencedTextures.size();
+	MaterialTextures.clear();
+}
+
+const std::vector<int32_t>& UHTextureStreamer::GetMaterialTextures(UHMaterial* InMat)
+{
+	const auto It = MaterialTextures.find(InMat);
+	if (It != MaterialTextures.end())
+	{
+		return It->second;
+	}
+
+	std::vector<int32_t>& Textures = MaterialTextures[InMat];
+	for (const std::string& RegisteredTexture : InMat->GetRegisteredTextureNames())
+	{
+		UHTexture2D* Texture = AssetMgr->GetTexture2D(RegisteredTexture);
+		const auto IndexIt = TextureIndices.find(Texture);
+		if (IndexIt != TextureIndices.end())
+		{
+			Textures.push_back(IndexIt->second);
+		}
+	}
+
+	return Textures;
+}
+
+void UHTextureStreamer::ApplyFinishedReads()
+{
+	// take the finished reads in order until the upload limit of a frame
+	std::vector<UniquePtr<UHTextureMipReadTask>> FinishedReads;
+	uint64_t UploadBytes = 0;
+	for (size_t Idx = 0; Idx < PendingReads.size();)
+	{
+		if (!PendingReads[Idx]->Counter.IsDone() || UploadBytes >= MaxUploadBytesPerFrame)
+		{
+			Idx++;
+			continue;
+		}
+
+		UploadBytes += PendingReads[Idx]->Data.size();
+		FinishedReads.push_back(std::move(PendingReads[Idx]));
+		PendingReads.erase(PendingReads.begin() + Idx);
+	}
+
+	if (FinishedReads.empty())
+	{
+		return;
+	}
+
+	// the old images and staging buffers could be still in use by the frames in flight, they're retired instead of released
+	for (const UniquePtr<UHTextureMipReadTask>& Read : FinishedReads)
+	{
+		UHTexture2D* Texture = Read->Texture;
+		if (Read->bSucceeded)
+		{
+			UHRetiredTextureObjects Retired;
+			Retired.StageBuffers = Texture->DetachStageBuffers();
+			Retired.GPUObjects = Texture->ApplyStreamedMips(Read->FirstMip, std::move(Read->Data));
+			Retired.ReleaseFrame = FrameCount + GMaxFrameInFlight;
+			RetiredObjects.push_back(std::move(Retired));
+
+			if (std::find(PendingUploads.begin(), PendingUploads.end(), Texture) == PendingUploads.end())
+			{
+				PendingUploads.push_back(Texture);
+			}
+
+			for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+			{
+				std::vector<UHTexture2D*>& SlotUpdates = PendingSlotUpdates[Idx];
+				if (std::find(SlotUpdates.begin(), SlotUpdates.end(), Texture) == SlotUpdates.end())
+				{
+					SlotUpdates.push_back(Texture);
+				}
+			}
+		}
+
+		Policy.FinishChange(Read->TextureIndex, Texture->GetResidentMip(), Read->bSucceeded);
+	}
+}
+
+void UHTextureStreamer::UpdateTextureSlots(UHTextureTable* InTextureTable, uint32_t InFrameIdx)
+{
+	// the descriptor set of this frame isn't used by GPU at this point, the other frames keep the old images until their turn
+	std::vector<UHTexture2D*>& SlotUpdates = PendingSlotUpdates[InFrameIdx];
+	if (InTextureTable != nullptr)
+	{
+		for (UHTexture2D* Texture : SlotUpdates)
+		{
+			const int32_t ReferencedIdx = AssetMgr->GetReferencedTextureIndex(Texture);
+			if (ReferencedIdx != UHINDEXNONE)
+			{
+				InTextureTable->UpdateTexture(Texture, GSystemPreservedTextureSlots + ReferencedIdx, InFrameIdx);
+			}
+		}
+	}
+	SlotUpdates.clear();
+}
+
+void UHTextureStreamer::ReleaseRetiredObjects(uint64_t InFrame)
+{
+	// the uploads recorded by the last frame don't need the CPU data anymore, retire their staging buffers
+	for (size_t Idx = 0; Idx < PendingUploads.size();)
+	{
+		UHTexture2D* Texture = PendingUploads[Idx];
+		if (!Texture->HasUploadedToGPU())
+		{
+			Idx++;
+			continue;
+		}
+
+		UHRetiredTextureObjects Retired;
+		Retired.StageBuffers = Texture->DetachStageBuffers();
+		Retired.ReleaseFrame = FrameCount + GMaxFrameInFlight;
+		RetiredObjects.push_back(std::move(Retired));
+		Texture->ReleaseCPUTextureData();
+		PendingUploads.erase(PendingUploads.begin() + Idx);
+	}
+
+	// objects are retired in frame order, release the ones the frames in flight are done with
+	size_t NumReleased = 0;
+	while (NumReleased < RetiredObjects.size() && RetiredObjects[NumReleased].ReleaseFrame <= InFrame)
+	{
+		UHRetiredTextureObjects& Retired = RetiredObjects[NumReleased];
+		UHTexture::ReleaseGPUObjects(GfxCache->GetLogicalDevice(), Retired.GPUObjects);
+		for (UHRenderBuffer<uint8_t>& Buffer : Retired.StageBuffers)
+		{
+			Buffer.Release();
+		}
+		NumReleased++;
+	}
+	RetiredObjects.erase(RetiredObjects.begin(), RetiredObjects.begin() + NumReleased);
+}
\ No newline at end of file
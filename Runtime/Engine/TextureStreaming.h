@@ -0,0 +1,230 @@
+#pragma once
+#include "../../UnheardEngine.h"
+#include "../Classes/AsyncTask.h"
+#include "../Classes/JobSystem.h"
+#include "../Classes/Texture2D.h"
+#include "../Renderer/RenderingTypes.h"
+#include <unordered_map>
+#include <vector>
+
+class UHGraphic;
+class UHAssetManager;
+class UHMaterial;
+class UHMeshRendererComponent;
+class UHCameraComponent;
+class UHTextureTable;
+class UHRenderBuilder;
+
+// budget vs. requested memory of the streamed textures, sizes are in bytes
+struct UHTextureStreamingReport
+{
+	UHTextureStreamingReport()
+		: BudgetBytes(0)
+		, RequestedBytes(0)
+		, TargetBytes(0)
+		, ResidentBytes(0)
+		, TailBytes(0)
+		, NumTextures(0)
+		, NumRequestedTextures(0)
+		, NumBudgetLimitedTextures(0)
+		, NumPendingChanges(0)
+	{
+
+	}
+
+	uint64_t BudgetBytes;
+
+	// the mips the view asks for regardless of the budget
+	uint64_t RequestedBytes;
+
+	// the mips after fitting the requests into the budget
+	uint64_t TargetBytes;
+	uint64_t ResidentBytes;
+
+	// mip tails are always resident, they're part of the resident bytes
+	uint64_t TailBytes;
+
+	uint32_t NumTextures;
+	uint32_t NumRequestedTextures;
+
+	// textures whose target mip is coarser than the requested one because of the budget
+	uint32_t NumBudgetLimitedTextures;
+	uint32_t NumPendingChanges;
+};
+
+// residency state of a texture in the policy, mip 0 is the largest one
+struct UHStreamingTextureState
+{
+	UHStreamingTextureState()
+		: MaxSize(0)
+		, MinMip(0)
+		, TailMip(0)
+		, ResidentMip(0)
+		, RequestedMip(0)
+		, TargetMip(0)
+		, PendingMip(0)
+		, ScreenSize(0.0f)
+		, LastScreenSize(0.0f)
+		, LastRequestFrame(0)
+		, CoarserFrames(0)
+		, bIsChanging(false)
+	{
+
+	}
+
+	// larger side of mip 0 in texels
+	uint32_t MaxSize;
+
+	// the range of mips that can be resident, mips from TailMip are never evicted
+	uint32_t MinMip;
+	uint32_t TailMip;
+	std::vector<uint64_t> MipSizes;
+
+	uint32_t ResidentMip;
+	uint32_t RequestedMip;
+	uint32_t TargetMip;
+	uint32_t PendingMip;
+
+	// projected size in pixels, ScreenSize is the largest request of this frame
+	float ScreenSize;
+	float LastScreenSize;
+	uint64_t LastRequestFrame;
+	uint32_t CoarserFrames;
+	bool bIsChanging;
+};
+
+// a resident mip change decided by the policy, FinishChange() must be called once the mips are in place
+struct UHTextureStreamingChange
+{
+	int32_t TextureIndex;
+	uint32_t NewResidentMip;
+};
+
+// residency policy of texture streaming, it only deals with sizes so it can be run and tested without a graphic device
+// each frame the view requests textures with their projected size in pixels, the policy picks the mip whose size covers those pixels,
+// then drops the top mips with the least pixels per texel until the total fits the budget
+class UHTextureResidencyPolicy
+{
+public:
+	UHTextureResidencyPolicy(uint64_t InBudgetBytes);
+
+	int32_t AddTexture(uint32_t Width, uint32_t Height, const std::vector<uint64_t>& InMipSizes, uint32_t InTailMip, uint32_t InResidentMip);
+	void SetBudget(uint64_t InBudgetBytes);
+
+	// request a texture with its projected size, the largest request of the frame is used
+	void RequestTexture(int32_t InTextureIdx, float InScreenSize);
+
+	// decide the target mip of all textures and consume the requests of this frame
+	void Update(uint64_t InFrame);
+
+	// collect the changes to apply, evictions go first since they free memory for the loads
+	// loads are sorted by how much they're under-sampled and they're only started if they fit the budget with the pending ones
+	void CollectChanges(uint32_t InMaxChanges, std::vector<UHTextureStreamingChange>& OutChanges);
+
+	// a failed change pins the texture at its resident mips so it won't be retried every frame
+	void FinishChange(int32_t InTextureIdx, uint32_t InResidentMip, bool bSucceeded);
+
+	const UHTextureStreamingReport& GetReport() const;
+	const UHStreamingTextureState& GetTexture(int32_t InTextureIdx) const;
+	int32_t GetTextureCount() const;
+
+	// pixels covered by a world size at a distance, the projection scale is cot(FovY / 2) * ViewHeight / 2
+	static float GetProjectedSize(float InWorldSize, float InDistance, float InProjectionScale);
+
+	// a texture stays requested for a while after it goes out of view, and the mips which aren't needed are kept for a while before dropping
+	static const uint32_t KeepRequestFrames = 30;
+	static const uint32_t EvictDelayFrames = 120;
+
+private:
+	uint64_t GetMipRangeSize(const UHStreamingTextureState& InTexture, uint32_t InFirstMip) const;
+	float GetPixelsPerTexel(const UHStreamingTextureState& InTexture, uint32_t InMip) const;
+
+	std::vector<UHStreamingTextureState> Textures;
+	uint64_t BudgetBytes;
+	UHTextureStreamingReport Report;
+};
+
+// reads a mip range of a texture on the streaming workers
+class UHTextureMipReadTask : public UHAsyncTask
+{
+public:
+	UHTextureMipReadTask(UHTexture2D* InTexture, int32_t InTextureIdx, uint32_t InFirstMip);
+	virtual void DoTask(const int32_t ThreadIndex) override;
+
+	UHTexture2D* Texture;
+	int32_t TextureIndex;
+	uint32_t FirstMip;
+	std::vector<uint8_t> Data;
+	bool bSucceeded;
+	UHJobCounter Counter;
+};
+
+// GPU objects replaced by a swap, they're released once the frames in flight are done with them
+struct UHRetiredTextureObjects
+{
+	UHRetiredTextureObjects()
+		: ReleaseFrame(0)
+	{
+
+	}
+
+	UHTextureGPUObjects GPUObjects;
+	std::vector<UHRenderBuffer<uint8_t>> StageBuffers;
+	uint64_t ReleaseFrame;
+};
+
+// texture streamer, feeds the residency policy with the visible renderers, reads mips asynchronously and swaps the images
+// a swap recreates the image with the new mip range in shared image memory, the upload is recorded in the frame's command buffer
+// and the texture slot in the bindless table is rewritten for each frame when the frame comes around, nothing waits for GPU.
+// evictions read the smaller mip range from file too, as the image can't shrink in place
+class UHTextureStreamer
+{
+public:
+	UHTextureStreamer(UHGraphic* InGfx, UHAssetManager* InAssetMgr, uint64_t InBudgetBytes);
+	void Release();
+
+	// request the textures of renderers with the projected size of their bounds, it can be called several times a frame
+	void RequestTextures(const std::vector<UHMeshRendererComponent*>& InRenderers, const UHCameraComponent* InCamera, float InViewHeight);
+
+	// must be called while the render thread is idle, the finished reads swap the images here
+	// and the texture slots of the frame InFrameIdx are rewritten
+	void Update(UHTextureTable* InTextureTable, uint32_t InFrameIdx);
+
+	// called by the render thread before the scene rendering, records the uploads of the images swapped in Update()
+	void RecordUploads(UHRenderBuilder& InRenderBuilder);
+
+	const UHTextureStreamingReport& GetReport() const;
+
+	static const uint32_t NumStreamingWorkers = 2;
+	static const uint32_t MaxInFlightReads = 8;
+	static const uint64_t MaxUploadBytesPerFrame = 64ull * 1048576;
+
+private:
+	void SyncTextures();
+	const std::vector<int32_t>& GetMaterialTextures(UHMaterial* InMat);
+	void ApplyFinishedReads();
+	void UpdateTextureSlots(UHTextureTable* InTextureTable, uint32_t InFrameIdx);
+	void ReleaseRetiredObjects(uint64_t InFrame);
+
+	UHGraphic* GfxCache;
+	UHAssetManager* AssetMgr;
+	UHTextureResidencyPolicy Policy;
+	UniquePtr<UHJobSystem> StreamingJobSystem;
+
+	// streamed textures in policy order, only the referenced textures are tracked
+	std::vector<UHTexture2D*> StreamedTextures;
+	std::unordered_map<UHTexture2D*, int32_t> TextureIndices;
+	size_t NumSyncedTextures;
+
+	// policy indices of the streamed textures used by a material
+	std::unordered_map<UHMaterial*, std::vector<int32_t>> MaterialTextures;
+
+	std::vector<UniquePtr<UHTextureMipReadTask>> PendingReads;
+	std::vector<UHTextureStreamingChange> Changes;
+	uint64_t FrameCount;
+
+	// swapped textures until their uploads are recorded, and the swapped textures whose slot isn't rewritten for a frame yet
+	std::vector<UHTexture2D*> PendingUploads;
+	std::vector<UHTexture2D*> PendingSlotUpdates[GMaxFrameInFlight];
+	std::vector<UHRetiredTextureObjects> RetiredObjects;
+};
\ No newline at end of file
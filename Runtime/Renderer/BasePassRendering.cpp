@@ -1,22 +1,5 @@
 #include "DeferredShadingRenderer.h"
 
-class UHBasePassAsyncTask : public UHAsyncTask
-{
-public:
-	void Init(UHDeferredShadingRenderer* InRenderer)
-	{
-		SceneRenderer = InRenderer;
-	}
-
-	virtual void DoTask(const int32_t ThreadIdx) override
-	{
-		SceneRenderer->BasePassTask(ThreadIdx);
-	}
-
-private:
-	UHDeferredShadingRenderer* SceneRenderer = nullptr;
-};
-
 // implementation of RenderBasePass(), this pass is a deferred rendering with GBuffers and depth buffer
 void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 {
@@ -26,7 +9,7 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 		return;
 	}
 
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::BasePass)], "BasePass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "BasePass");
 
 	// setup clear value
 	std::vector<VkClearValue> ClearValues;
@@ -64,7 +47,7 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 					, MeshletTable->GetDescriptorSet(CurrentFrameRT)
 					, PositionTable->GetDescriptorSet(CurrentFrameRT)
 					, UV0Table->GetDescriptorSet(CurrentFrameRT)
-					, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+					, MeshletIndexTable->GetDescriptorSet(CurrentFrameRT)
 					, NormalTable->GetDescriptorSet(CurrentFrameRT)
 					, TangentTable->GetDescriptorSet(CurrentFrameRT)
 				};
@@ -87,8 +70,8 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 				RenderBuilder.BindGraphicState(BaseMS->GetState());
 				RenderBuilder.BindDescriptorSet(BaseMS->GetPipelineLayout(), BaseMS->GetDescriptorSet(CurrentFrameRT));
 
-				// Dispatch meshlets
-				RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+				// dispatch meshlets, they will be culled in amplification shader
+				DispatchMeshlets(RenderBuilder, BaseMS, VisibleMeshlets, GetShadingOcclusionPhase());
 
 				GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 			}
@@ -98,35 +81,18 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 			// begin render pass
 			RenderBuilder.BeginRenderPass(BasePassObj, RenderResolution, ClearValues, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
+			for (int32_t I = 0; I < NumParallelBundles; I++)
 			{
-				ThreadDrawCalls[I] = 0;
-				ThreadOccludedCalls[I] = 0;
+				BundleDrawCalls[I] = 0;
 			}
-#endif
 
-			// wake all worker threads
-			static UHBasePassAsyncTask Tasks[GMaxWorkerThreads];
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
-			{
-				Tasks[I].Init(this);
-				WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-				WorkerThreads[I]->WakeThread();
-			}
-
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
-			{
-				WorkerThreads[I]->WaitTask();
-			}
+			// record all bundles with job system
+			RecordParallelBundles(&UHDeferredShadingRenderer::BasePassTask);
 
-#if WITH_EDITOR
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
+			for (int32_t I = 0; I < NumParallelBundles; I++)
 			{
-				RenderBuilder.DrawCalls += ThreadDrawCalls[I];
-				RenderBuilder.OccludedCalls += ThreadOccludedCalls[I];
+				RenderBuilder.DrawCalls += BundleDrawCalls[I];
 			}
-#endif
 
 			// execute all recorded batches
 			RenderBuilder.ExecuteBundles(BaseParallelSubmitter);
@@ -143,21 +109,21 @@ void UHDeferredShadingRenderer::RenderBasePass(UHRenderBuilder& RenderBuilder)
 }
 
 // base pass task, called by worker thread
-void UHDeferredShadingRenderer::BasePassTask(int32_t ThreadIdx)
+void UHDeferredShadingRenderer::BasePassTask(int32_t BundleIdx)
 {
-	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(OpaquesToRender.size());
-	const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
-	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
-	const int32_t EndIdx = (ThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
+	// simply separate batch recording into N bundles, GPU-driven rendering records indirect draw buckets instead
+	const std::vector<UHIndirectDrawBucket>& IndirectBuckets = IndirectDrawBuilder.GetBuckets();
+	const int32_t MaxCount = static_cast<int32_t>(bEnableGPUDrivenRT ? IndirectBuckets.size() : OpaqueBatches.size());
+	const int32_t BatchCount = (MaxCount + NumParallelBundles) / NumParallelBundles;
+	const int32_t StartIdx = std::min(BatchCount * BundleIdx, MaxCount);
+	const int32_t EndIdx = (BundleIdx == NumParallelBundles - 1) ? MaxCount : std::min(StartIdx + BatchCount, MaxCount);
 
 	VkCommandBufferInheritanceInfo InheritanceInfo{};
 	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
 	InheritanceInfo.renderPass = BasePassObj.RenderPass;
 	InheritanceInfo.framebuffer = BasePassObj.FrameBuffer;
-	InheritanceInfo.occlusionQueryEnable = bEnableHWOcclusionRT;
 
-	UHRenderBuilder RenderBuilder(GraphicInterface, BaseParallelSubmitter.WorkerCommandBuffers[ThreadIdx * GMaxFrameInFlight + CurrentFrameRT]);
+	UHRenderBuilder RenderBuilder(GraphicInterface, BaseParallelSubmitter.WorkerCommandBuffers[BundleIdx * GMaxFrameInFlight + CurrentFrameRT]);
 	if (StartIdx >= EndIdx)
 	{
 		RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
@@ -177,46 +143,62 @@ void UHDeferredShadingRenderer::BasePassTask(int32_t ThreadIdx)
 		RenderBuilder.BindDescriptorSet(BasePassShaders.begin()->second->GetPipelineLayout(), TextureTableSets, GTextureTableSpace);
 	}
 
-	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
+	if (bEnableGPUDrivenRT)
+	{
+		// renderers of a bucket share the material and meshes are fetched from the geometry pool
+		// the visible renderers and the draw count are resolved by GPU culling, so it's one draw per material
+		RenderBuilder.BindIndexBuffer(MeshGeometryPool.GetIndexBuffer());
+		for (int32_t I = StartIdx; I < EndIdx; I++)
+		{
+			const UHIndirectDrawBucket& Bucket = IndirectBuckets[I];
+			const auto Shader = BaseIndirectShaders.find(Bucket.Material->GetBufferDataIndex());
+			if (Shader == BaseIndirectShaders.end())
+			{
+				continue;
+			}
+
+			GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Bucket.Material->GetName() + " (Indirect, Max: "
+				+ std::to_string(Bucket.Capacity) + ")");
+
+			const UHBasePassShader* BaseShader = Shader->second.get();
+			RenderBuilder.BindGraphicState(BaseShader->GetState());
+			RenderBuilder.BindDescriptorSet(BaseShader->GetPipelineLayout(), BaseShader->GetDescriptorSet(CurrentFrameRT));
+			RenderBuilder.DrawIndexedIndirectCount(GIndirectDrawBuffer[CurrentFrameRT]->GetBuffer(), Bucket.FirstCommand
+				, GIndirectCountBuffer[CurrentFrameRT]->GetBuffer(), static_cast<uint32_t>(I), Bucket.Capacity);
+
+			GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+		}
+
+		RenderBuilder.EndCommandBuffer();
+
+		BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
+		return;
+	}
+
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		const UHMeshRendererComponent* Renderer = OpaquesToRender[I];
-		const UHMaterial* Mat = Renderer->GetMaterial();
+		// renderers in a batch share the mesh and material, so the descriptors of the first renderer work for all instances
+		const UHInstanceBatch& Batch = OpaqueBatches[I];
+		const UHMeshRendererComponent* Renderer = OpaquesToRender[Batch.FirstItem];
 		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
 		UHMesh* Mesh = Renderer->GetMesh();
 		const int32_t TriCount = Mesh->GetIndicesCount() / 3;
 
 		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Mesh->GetName() + " (Tris: " +
-			std::to_string(TriCount) + ")");
-
-		// occlusion test for big meshes
-		const bool bOcclusionTest = bEnableHWOcclusionRT && TriCount >= OcclusionThresholdRT && !Renderer->IsCameraInsideThisRenderer();
-		if (bOcclusionTest)
-		{
-			RenderBuilder.BeginPredication(RendererIdx, GOcclusionResult[PrevFrame]->GetBuffer());
-		}
+			std::to_string(TriCount) + ", Instances: " + std::to_string(Batch.InstanceCount) + ")");
 
 		// draw mesh
 		const UHBasePassShader* BaseShader = BasePassShaders[RendererIdx].get();
 		RenderBuilder.BindGraphicState(BaseShader->GetState());
-		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(BaseShader->GetPipelineLayout(), BaseShader->GetDescriptorSet(CurrentFrameRT));
 
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
-
-		if (bOcclusionTest)
-		{
-			RenderBuilder.EndPredication();
-		}
+		RenderBuilder.DrawIndexedInstanced(Mesh->GetIndicesCount(), Batch.InstanceCount, Batch.FirstInstance);
 
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 	}
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
-	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-	ThreadOccludedCalls[ThreadIdx] += RenderBuilder.OccludedCalls;
-#endif
+	BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "DeferredShadingRenderer.h"
+#include <algorithm>
 
 UHScene* UHDeferredShadingRenderer::GetCurrentScene() const
 {
@@ -59,10 +60,130 @@ void UHDeferredShadingRenderer::Update()
 		return;
 	}
 
+	UpdateFeatureToggles();
 	FrustumCulling();
+	SoftwareOcclusionCulling();
 	UploadDataBuffers();
+	UpdateLightClusters();
 	CollectVisibleRenderer();
 	CollectMeshShaderInstance();
+	UpdateTextureStreaming();
+}
+
+void UHDeferredShadingRenderer::UpdateFeatureToggles()
+{
+	// buckets are rebuilt when GPU-driven rendering is toggled
+	const bool bEnableGPUDriven = IsGPUDrivenSupported() && ConfigInterface->RenderingSetting().bEnableGPUDrivenRendering;
+	if (bEnableGPUDrivenGT != bEnableGPUDriven)
+	{
+		bEnableGPUDrivenGT = bEnableGPUDriven;
+		bIndirectDrawsDirty = true;
+	}
+
+	// lights are assigned to clusters by CPU when GPU clustering is disabled
+	bEnableGPULightClusteringGT = ConfigInterface->RenderingSetting().bEnableGPULightClustering;
+
+	// occlusion result buffers are created in editor or when it's enabled at launch
+	bEnableOcclusionGT = ConfigInterface->RenderingSetting().bEnableOcclusionCulling && GOcclusionResult[CurrentFrameGT] != nullptr;
+}
+
+#if WITH_EDITOR
+void UHDeferredShadingRenderer::RunUpdateStage(UHRendererUpdateStage InStage)
+{
+	if (!CurrentScene)
+	{
+		UHE_LOG(L"Scene is not set!\n");
+		return;
+	}
+
+	switch (InStage)
+	{
+	case UHRendererUpdateStage::FrustumCulling:
+		// toggles are refreshed at the beginning of a frame, the same as Update()
+		UpdateFeatureToggles();
+		FrustumCulling();
+		break;
+	case UHRendererUpdateStage::SoftwareOcclusionCulling:
+		SoftwareOcclusionCulling();
+		break;
+	case UHRendererUpdateStage::UploadDataBuffers:
+		UploadDataBuffers();
+		break;
+	case UHRendererUpdateStage::LightClustering:
+		UpdateLightClusters();
+		break;
+	case UHRendererUpdateStage::CollectVisibleRenderer:
+		CollectVisibleRenderer();
+		break;
+	case UHRendererUpdateStage::CollectMeshShaderInstance:
+		CollectMeshShaderInstance();
+		break;
+	case UHRendererUpdateStage::UpdateTextureStreaming:
+		UpdateTextureStreaming();
+		break;
+	default:
+		break;
+	}
+}
+
+void UHDeferredShadingRenderer::AdvanceFrameHeadless()
+{
+	// the same as NotifyRenderThread() but there is no render thread to wake up
+	CurrentFrameGT = (CurrentFrameGT + 1) % GMaxFrameInFlight;
+}
+
+const char* UHDeferredShadingRenderer::GetUpdateStageName(UHRendererUpdateStage InStage)
+{
+	switch (InStage)
+	{
+	case UHRendererUpdateStage::FrustumCulling:
+		return "FrustumCulling";
+	case UHRendererUpdateStage::SoftwareOcclusionCulling:
+		return "SoftwareOcclusionCulling";
+	case UHRendererUpdateStage::UploadDataBuffers:
+		return "UploadDataBuffers";
+	case UHRendererUpdateStage::LightClustering:
+		return "LightClustering";
+	case UHRendererUpdateStage::CollectVisibleRenderer:
+		return "CollectVisibleRenderer";
+	case UHRendererUpdateStage::CollectMeshShaderInstance:
+		return "CollectMeshShaderInstance";
+	case UHRendererUpdateStage::UpdateTextureStreaming:
+		return "UpdateTextureStreaming";
+	default:
+		break;
+	}
+
+	return "Unknown";
+}
+
+size_t UHDeferredShadingRenderer::GetNumRenderersToDraw() const
+{
+	return OpaquesToRender.size() + TranslucentsToRender.size();
+}
+#endif
+
+void UHDeferredShadingRenderer::UpdateTextureStreaming()
+{
+	if (TextureStreamer == nullptr)
+	{
+		return;
+	}
+
+	const float ViewHeight = static_cast<float>(RenderResolution.height);
+	TextureStreamer->RequestTextures(OpaquesToRender, CurrentScene->GetMainCamera(), ViewHeight);
+	TextureStreamer->RequestTextures(TranslucentsToRender, CurrentScene->GetMainCamera(), ViewHeight);
+	TextureStreamer->Update(TextureTable.get(), CurrentFrameGT);
+}
+
+const UHTextureStreamingReport* UHDeferredShadingRenderer::GetTextureStreamingReport() const
+{
+	return (TextureStreamer != nullptr) ? &TextureStreamer->GetReport() : nullptr;
+}
+
+const UHGPUTimeline& UHDeferredShadingRenderer::GetGPUTimeline() const
+{
+	return GPUTimeline;
 }
 
 void UHDeferredShadingRenderer::NotifyRenderThread()
@@ -86,14 +207,15 @@ void UHDeferredShadingRenderer::NotifyRenderThread()
 	bIsSkyLightEnabledRT = GetCurrentSkyCube() != nullptr;
 	bHasRefractionMaterialRT = bHasRefractionMaterialGT;
 	bHDREnabledRT = GraphicInterface->IsHDRAvailable();
-	RTCullingDistanceRT = RenderingSettings.RTCullingRadius;
 	RTReflectionQualityRT = RenderingSettings.RTReflectionQuality;
 
 	// at least make it 'toggleable' partially
 	bIsRaytracingEnableRT = RenderingSettings.bEnableRayTracing && GraphicInterface->IsRayTracingEnabled();
 
-	bEnableHWOcclusionRT = RenderingSettings.bEnableHardwareOcclusion;
-	OcclusionThresholdRT = RenderingSettings.OcclusionTriangleThreshold;
+	bEnableOcclusionRT = bEnableOcclusionGT;
+	bEnableGPUDrivenRT = bEnableGPUDrivenGT && IndirectDrawBuilder.GetBuckets().size() > 0;
+	bEnableGPULightClusteringRT = bEnableGPULightClusteringGT;
+	CullingDistanceRT = CurrentScene->GetMainCamera() ? CurrentScene->GetMainCamera()->GetCullingDistance() : 0.0f;
 	bEnableDepthPrepassRT = GraphicInterface->IsDepthPrePassEnabled();
 	bTemporalAART = RenderingSettings.bTemporalAA;
 	bDenoiseReflectionRT = RenderingSettings.bDenoiseRTReflection;
@@ -177,6 +299,11 @@ int32_t UHDeferredShadingRenderer::GetOccludedCallCount() const
 	return OccludedCalls;
 }
 
+const UHTopLevelInstanceStats& UHDeferredShadingRenderer::GetTopLevelInstanceStats() const
+{
+	return TopLevelInstanceStats;
+}
+
 #endif
 
 void UHDeferredShadingRenderer::UploadDataBuffers()
@@ -216,11 +343,17 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 	SystemConstantsCPU.GNumDirLights = static_cast<uint32_t>(CurrentScene->GetDirLightCount());
 	SystemConstantsCPU.GNumPointLights = static_cast<uint32_t>(CurrentScene->GetPointLightCount());
 	SystemConstantsCPU.GNumSpotLights = static_cast<uint32_t>(CurrentScene->GetSpotLightCount());
-	SystemConstantsCPU.GMaxPointLightPerTile = MaxPointLightPerTile;
-	SystemConstantsCPU.GMaxSpotLightPerTile = MaxSpotLightPerTile;
 
-	uint32_t Dummy;
-	GetLightCullingTileCount(SystemConstantsCPU.GLightTileCountX, Dummy);
+	// light clusters follow the non-jittered projection, the jitter is covered by a pixel margin
+	LightClusterView = UHLightClustering::BuildView(RenderResolution.width, RenderResolution.height, CurrentCamera->GetViewMatrix()
+		, CurrentCamera->GetProjectionMatrixNonJittered(), CurrentCamera->GetNearPlane(), CurrentCamera->GetCullingDistance());
+	SystemConstantsCPU.GLightClusterCountX = LightClusterView.CountX;
+	SystemConstantsCPU.GLightClusterCountY = LightClusterView.CountY;
+	SystemConstantsCPU.GLightClusterIndexCapacity = LightClusterIndexCapacity;
+	SystemConstantsCPU.GLightClusterSliceScale = LightClusterView.SliceScale;
+	SystemConstantsCPU.GLightClusterSliceBias = LightClusterView.SliceBias;
+	SystemConstantsCPU.GLightClusterProjScaleX = LightClusterView.ProjScaleX;
+	SystemConstantsCPU.GLightClusterProjScaleY = LightClusterView.ProjScaleY;
 
 	if (RenderingSettings.bTemporalAA)
 	{
@@ -285,6 +418,27 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 		int32_t MinDirtyObjIndex = static_cast<int32_t>(Renderers.size());
 		int32_t MaxDirtyObjIndex = 0;
 
+		if (bEnableGPUDrivenGT && IndirectDrawItems.size() != Renderers.size())
+		{
+			IndirectDrawItems.resize(Renderers.size(), UHIndirectDrawItem{ nullptr, 0, 0, 0, false });
+			bIndirectDrawsDirty = true;
+		}
+
+		// top level AS instances of this frame follow the same dirty flags as object constants
+		// all instances are refreshed after ray tracing is enabled again, as the flags were consumed when it was off
+		UHAccelerationStructure* TopLevelAS = nullptr;
+		bool bRefreshTopLevelAS = false;
+		if (RenderingSettings.bEnableRayTracing && GraphicInterface->IsRayTracingEnabled() && RTInstanceCount > 0)
+		{
+			TopLevelAS = GTopLevelAS[CurrentFrameGT].get();
+			bRefreshTopLevelAS = TopLevelASRefreshFrames > 0;
+			TopLevelASRefreshFrames = bRefreshTopLevelAS ? TopLevelASRefreshFrames - 1 : 0;
+		}
+		else
+		{
+			TopLevelASRefreshFrames = GMaxFrameInFlight;
+		}
+
 		for (size_t Idx = 0; Idx < Renderers.size(); Idx++)
 		{
 			// update CPU constants when the frame is dirty
@@ -292,18 +446,13 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 			UHMeshRendererComponent* Renderer = Renderers[Idx];
 			const int32_t RendererIdx = Renderer->GetBufferDataIndex();
 
+			// GPU culling needs the constants of culled renderers as well
 			UHObjectConstants Constant = Renderer->GetConstants();
-			if (Renderer->IsRenderDirty(CurrentFrameGT) && Renderer->IsVisible())
+			const bool bIsRenderDirty = Renderer->IsRenderDirty(CurrentFrameGT);
+			if (bIsRenderDirty && (Renderer->IsVisible() || bEnableGPUDrivenGT))
 			{
 				ObjectConstantsCPU[RendererIdx] = Constant;
 
-				// setup occlusion data if necessary
-				if (RenderingSettings.bEnableHardwareOcclusion)
-				{
-					Constant.GWorld = Renderer->GetWorldBoundMatrix();
-					OcclusionConstantsCPU[RendererIdx] = Constant;
-				}
-
 				// record min/max dirty index to reduce buffer copy range
 				MinDirtyObjIndex = std::min(MinDirtyObjIndex, RendererIdx);
 				MaxDirtyObjIndex = std::max(MaxDirtyObjIndex, RendererIdx);
@@ -311,12 +460,53 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 				Renderer->SetRenderDirty(false, CurrentFrameGT);
 			}
 
+			// the instance is only marked dirty when it's really changed
+			if (TopLevelAS != nullptr)
+			{
+				if (bIsRenderDirty || bRefreshTopLevelAS)
+				{
+					TopLevelAS->UpdateInstance(Renderer);
+				}
+				TopLevelAS->UpdateInstanceActive(Renderer, RenderingSettings.RTCullingRadius);
+			}
+
 			// copy material data only when it's dirty
 			UHMaterial* Mat = Renderer->GetMaterial();
 			if (Mat->IsRenderDirty(CurrentFrameGT))
 			{
 				Mat->UploadMaterialData(CurrentFrameGT);
 				Mat->SetRenderDirty(false, CurrentFrameGT);
+
+				// cull mode and blend mode are instance flags, refresh all renderers of the material
+				if (TopLevelAS != nullptr)
+				{
+					for (UHObject* Obj : Mat->GetReferenceObjects())
+					{
+						if (const UHMeshRendererComponent* MatRenderer = CastObject<UHMeshRendererComponent>(Obj))
+						{
+							TopLevelAS->UpdateInstance(MatRenderer);
+						}
+					}
+				}
+			}
+
+			// track the mesh range and material of renderers for indirect draws, translucent renderers are still drawn by CPU
+			// the range is looked up every frame, so items follow the geometry pool after it's rebuilt
+			if (bEnableGPUDrivenGT)
+			{
+				const UHMesh* Mesh = Renderer->GetMesh();
+				UHMeshGeometryRange Range;
+				bool bDrawable = Mesh != nullptr && Mat->IsOpaque() && Renderer->IsEnabled() && MeshGeometryPool.GetRange(Mesh, Range);
+#if WITH_EDITOR
+				bDrawable = bDrawable && Renderer->IsVisibleInEditor();
+#endif
+				const UHIndirectDrawItem Item = bDrawable ? UHIndirectDrawItem{ Mat, Range.IndexCount, Range.FirstIndex, Range.VertexOffset, true }
+					: UHIndirectDrawItem{ Mat, 0, 0, 0, false };
+				if (IndirectDrawItems[RendererIdx] != Item)
+				{
+					IndirectDrawItems[RendererIdx] = Item;
+					bIndirectDrawsDirty = true;
+				}
 			}
 		}
 
@@ -324,13 +514,17 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 		{
 			size_t CopySize = (MaxDirtyObjIndex - MinDirtyObjIndex + 1) * GObjectConstantBuffer[CurrentFrameGT]->GetBufferStride();
 			GObjectConstantBuffer[CurrentFrameGT]->UploadData(&ObjectConstantsCPU[MinDirtyObjIndex], MinDirtyObjIndex, CopySize);
+		}
 
-			if (RenderingSettings.bEnableHardwareOcclusion)
-			{
-				CopySize = (MaxDirtyObjIndex - MinDirtyObjIndex + 1) * GOcclusionConstantBuffer[CurrentFrameGT]->GetBufferStride();
-				GOcclusionConstantBuffer[CurrentFrameGT]->UploadData(&OcclusionConstantsCPU[MinDirtyObjIndex], MinDirtyObjIndex, CopySize);
-			}
+		if (TopLevelAS != nullptr)
+		{
+			TopLevelAS->UploadInstances();
+#if WITH_EDITOR
+			TopLevelInstanceStats = TopLevelAS->GetInstanceStats();
+#endif
 		}
+
+		UploadIndirectDraws();
 	}
 
 	// upload directional light data
@@ -385,11 +579,19 @@ void UHDeferredShadingRenderer::UploadDataBuffers()
 	UHSphericalHarmonicConstants SH9Constant{};
 	SH9Constant.MipLevel = 4;
 	SH9Constant.Weight = 4.0f * G_PI / 64.0f;
-	SH9Shader->GetSH9Constants(CurrentFrameGT)->UploadData(&SH9Constant, 0);
+
+	// shaders aren't created in headless mode
+	if (SH9Shader != nullptr)
+	{
+		SH9Shader->GetSH9Constants(CurrentFrameGT)->UploadData(&SH9Constant, 0);
+	}
 
 	// upload tonemap data
-	UHToneMapData ToneMapData(RenderingSettings.GammaCorrection, RenderingSettings.HDRWhitePaperNits, RenderingSettings.HDRContrast);
-	ToneMapShader->UploadToneMapData(ToneMapData, CurrentFrameGT);
+	if (ToneMapShader != nullptr)
+	{
+		UHToneMapData ToneMapData(RenderingSettings.GammaCorrection, RenderingSettings.HDRWhitePaperNits, RenderingSettings.HDRContrast);
+		ToneMapShader->UploadToneMapData(ToneMapData, CurrentFrameGT);
+	}
 }
 
 void UHDeferredShadingRenderer::FrustumCulling()
@@ -407,61 +609,170 @@ void UHDeferredShadingRenderer::FrustumCulling()
 		return;
 	}
 
-	// async frustum culling task
-	class UHFrustumCullingAsyncTask : public UHAsyncTask
+	const UHCullingPlanes Planes = UHFrustumCulling::BuildPlanes(CurrentCamera->GetBoundingFrustum());
+	const XMFLOAT3 CameraPos = CurrentCamera->GetPosition();
+	const float RTCullingRadius = ConfigInterface->RenderingSetting().RTCullingRadius;
+	const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetRenderersByBufferIndex();
+	UHCullingBounds& Bounds = CurrentScene->GetRendererBounds();
+
+	// large scenes query the BVHs first, so only the visible or in-range renderers are visited later
+	// the in-range test is also done here as the RT culling radius needs the distance of invisible renderers
+	const bool bUseBVHCulling = static_cast<int32_t>(Bounds.GetCount()) >= BVHCullingThreshold;
+	if (bUseBVHCulling)
+	{
+		UHFrustumCulling::BeginQuery(Bounds);
+		CurrentScene->QueryFrustum(Planes, Bounds.VisibleBits);
+		CurrentScene->QuerySphere(CameraPos, RTCullingRadius, Bounds.InRangeBits);
+	}
+
+	// resolve or cull the packed bounds with job system, each job works on whole words of bits so no bit is shared between jobs
+	// then write the result back to renderers which are visible, in range, or were visible or in range last time
+	JobSystem->ParallelFor(Bounds.GetWordCount(), 8, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
 	{
-	public:
-		void Init(UHScene* InScene, const int32_t InNumWorkerThreads)
+		if (bUseBVHCulling)
 		{
-			CurrentScene = InScene;
-			NumWorkerThreads = InNumWorkerThreads;
+			UHFrustumCulling::ResolveQuery(CameraPos, RTCullingRadius, Bounds, Begin, End);
 		}
-
-		virtual void DoTask(const int32_t ThreadIdx) override
+		else
 		{
-			const UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
-			const BoundingFrustum& CameraFrustum = CurrentCamera->GetBoundingFrustum();
-			const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetAllRenderers();
-			const XMFLOAT3 CameraPos = CurrentCamera->GetPosition();
-
-			const int32_t MaxCount = static_cast<int32_t>(Renderers.size());
-			const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
-			const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
-			const int32_t EndIdx = (ThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
+			UHFrustumCulling::CullBounds(Planes, CameraPos, RTCullingRadius, Bounds, Begin, End);
+		}
 
-			for (int32_t Idx = StartIdx; Idx < EndIdx; Idx++)
+		for (int32_t WordIdx = Begin; WordIdx < End; WordIdx++)
+		{
+			uint32_t Bits = Bounds.VisibleBits[WordIdx] | Bounds.InRangeBits[WordIdx] | Bounds.PreviousBits[WordIdx];
+			while (Bits != 0)
 			{
+				const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + MathHelpers::CountTrailingZeros(Bits);
+				Bits &= Bits - 1;
+
 				UHMeshRendererComponent* Renderer = Renderers[Idx];
+				Renderer->SetVisible(Bounds.IsVisible(Idx));
+				Renderer->SetSquareDistanceToMainCam(Bounds.GetSquareDistance(Idx), Bounds.IsCameraInside(Idx));
+			}
+		}
+	});
+}
 
-				const BoundingBox& RendererBound = Renderer->GetRendererBound();
-				const bool bVisible = (CameraFrustum.Contains(RendererBound) != DirectX::DISJOINT);
-				Renderer->SetVisible(bVisible);
+const UHOccluderMesh* UHDeferredShadingRenderer::GetOccluderMesh(const UHMesh* InMesh)
+{
+	const auto Cached = OccluderCache.find(InMesh);
+	if (Cached != OccluderCache.end())
+	{
+		return Cached->second.IsValid() ? &Cached->second : nullptr;
+	}
 
-				if (bVisible)
-				{
-					// also calculate the square distance to current camera for later use if it's visible
-					Renderer->CalculateSquareDistanceToCamera(CameraPos);
-				}
+	// an empty entry is still cached, so meshes which can't be occluders aren't copied again
+	// dense meshes cost more to rasterize than they save, they're skipped as well
+	UHOccluderMesh& Occluder = OccluderCache[InMesh];
+	const int32_t TriangleLimit = ConfigInterface->RenderingSetting().OccluderTriangleLimit;
+	if (static_cast<int32_t>(InMesh->GetIndicesCount() / 3) <= TriangleLimit)
+	{
+		if (!InMesh->GetCPUGeometry(Occluder.Positions, Occluder.Indices))
+		{
+			Occluder = UHOccluderMesh();
+		}
+	}
+
+	return Occluder.IsValid() ? &Occluder : nullptr;
+}
+
+void UHDeferredShadingRenderer::SoftwareOcclusionCulling()
+{
+	UHGameTimerScope Scope("SoftwareOcclusionCulling", false);
+
+	// mesh shader path tests the occlusion with Hi-Z on GPU instead
+	const UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
+	if (!bEnableOcclusionGT || GraphicInterface->IsMeshShaderSupported() || !CurrentCamera || !CurrentCamera->IsEnabled())
+	{
+		return;
+	}
+
+	const UHRenderingSettings& RenderingSettings = ConfigInterface->RenderingSetting();
+	const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetRenderersByBufferIndex();
+	const UHCullingBounds& Bounds = CurrentScene->GetRendererBounds();
+	const int32_t RendererCount = static_cast<int32_t>(Bounds.GetCount());
+	SoftwareOcclusionResult.resize(RendererCount, 1);
+
+	// the occlusion buffer is a fraction of the render resolution with the same aspect ratio
+	const uint32_t OcclusionWidth = 256;
+	const uint32_t OcclusionHeight = (std::max)(OcclusionWidth * RenderResolution.height / (std::max)(RenderResolution.width, 1u), 1u);
+	if (SoftwareOcclusion.GetWidth() != OcclusionWidth || SoftwareOcclusion.GetHeight() != OcclusionHeight)
+	{
+		SoftwareOcclusion.Resize(OcclusionWidth, OcclusionHeight);
+	}
+
+	// pick the occluders which cover the most of the screen, estimated by the square of bound radius over distance
+	// the opaque renderers occluded last frame are unlikely good occluders, masked ones have holes so they're skipped too
+	OccluderCandidates.clear();
+	for (int32_t WordIdx = 0; WordIdx < Bounds.GetWordCount(); WordIdx++)
+	{
+		uint32_t Bits = Bounds.VisibleBits[WordIdx];
+		while (Bits != 0)
+		{
+			const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + MathHelpers::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
+
+			const UHMeshRendererComponent* Renderer = Renderers[Idx];
+			const UHMaterial* Mat = Renderer->GetMaterial();
+			if (!Renderer->IsVisible() || SoftwareOcclusionResult[Idx] == 0 || !Mat->IsOpaque() || Mat->GetBlendMode() == UHBlendMode::Masked)
+			{
+				continue;
 			}
+
+			if (GetOccluderMesh(Renderer->GetMesh()) == nullptr)
+			{
+				continue;
+			}
+
+			const XMFLOAT3 Extent(Bounds.ExtentX[Idx], Bounds.ExtentY[Idx], Bounds.ExtentZ[Idx]);
+			const float SquareRadius = Extent.x * Extent.x + Extent.y * Extent.y + Extent.z * Extent.z;
+			OccluderCandidates.push_back(std::make_pair(SquareRadius / (std::max)(Bounds.GetSquareDistance(Idx), 0.0001f), Idx));
 		}
+	}
 
-	private:
-		UHScene* CurrentScene = nullptr;
-		int32_t NumWorkerThreads = 0;
-	};
-	static UHFrustumCullingAsyncTask Tasks[GMaxWorkerThreads];
+	const size_t OccluderCount = (std::min)(OccluderCandidates.size(), static_cast<size_t>((std::max)(RenderingSettings.MaxSoftwareOccluders, 0)));
+	std::partial_sort(OccluderCandidates.begin(), OccluderCandidates.begin() + OccluderCount, OccluderCandidates.end()
+		, [](const std::pair<float, int32_t>& A, const std::pair<float, int32_t>& B)
+		{
+			return A.first > B.first;
+		});
 
-	// init and wake frustum culling task
-	for (int32_t I = 0; I < NumWorkerThreads; I++)
+	// use the non-jittered matrix, so the result doesn't flicker with temporal AA
+	SoftwareOcclusion.BeginFrame(CurrentCamera->GetViewProjMatrixNonJittered());
+	for (size_t Idx = 0; Idx < OccluderCount; Idx++)
 	{
-		Tasks[I].Init(CurrentScene, NumWorkerThreads);
-		WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-		WorkerThreads[I]->WakeThread();
+		const UHMeshRendererComponent* Renderer = Renderers[OccluderCandidates[Idx].second];
+		SoftwareOcclusion.RasterizeOccluder(*GetOccluderMesh(Renderer->GetMesh()), Renderer->GetWorldMatrix());
 	}
 
-	for (int32_t I = 0; I < NumWorkerThreads; I++)
+	// test the visible renderers in parallel, each job works on whole words of bits, the invisible ones are reset to visible
+	// the occlusion box of a renderer containing the camera is always visible
+	JobSystem->ParallelFor(Bounds.GetWordCount(), 8, [&](int32_t Begin, int32_t End, int32_t WorkerIdx)
 	{
-		WorkerThreads[I]->WaitTask();
+		const int32_t EndIdx = (std::min)(End * UHCullingBounds::BoxesPerWord, RendererCount);
+		for (int32_t Idx = Begin * UHCullingBounds::BoxesPerWord; Idx < EndIdx; Idx++)
+		{
+			bool bVisible = true;
+			if (Bounds.IsVisible(Idx) && !Bounds.IsCameraInside(Idx))
+			{
+				const XMFLOAT3 Center(Bounds.CenterX[Idx], Bounds.CenterY[Idx], Bounds.CenterZ[Idx]);
+				const XMFLOAT3 Extent(Bounds.ExtentX[Idx], Bounds.ExtentY[Idx], Bounds.ExtentZ[Idx]);
+				bVisible = SoftwareOcclusion.IsBoxVisible(Center, Extent);
+			}
+
+			SoftwareOcclusionResult[Idx] = bVisible ? 1 : 0;
+		}
+	});
+
+#if WITH_EDITOR
+	OccludedCalls = static_cast<int32_t>(std::count(SoftwareOcclusionResult.begin(), SoftwareOcclusionResult.end(), 0u));
+#endif
+
+	// GPU culling reads the result of the current frame
+	if (bEnableGPUDrivenGT && RendererCount > 0)
+	{
+		GOcclusionResult[CurrentFrameGT]->UploadAllData(SoftwareOcclusionResult.data());
 	}
 }
 
@@ -484,7 +795,6 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 	OpaquesToRender.clear();
 	MotionOpaquesToRender.clear();
 	TranslucentsToRender.clear();
-	OcclusionRenderers.clear();
 
 	// reset counting counter
 	for (int32_t Idx = 0; Idx < MaxCountingElement; Idx++)
@@ -492,18 +802,30 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 		CountingRenderers[Idx].clear();
 	}
 
+	// only visit the visible renderers from the culling bits, and skip the ones occluded by software occlusion
+	const bool bSoftwareOcclusion = bEnableOcclusionGT && !GraphicInterface->IsMeshShaderSupported();
 	const float CullingDistance = CurrentCamera->GetCullingDistance();
-	for (UHMeshRendererComponent* Renderer : CurrentScene->GetAllRenderers())
+	const std::vector<UHMeshRendererComponent*>& Renderers = CurrentScene->GetRenderersByBufferIndex();
+	const UHCullingBounds& Bounds = CurrentScene->GetRendererBounds();
+	for (int32_t WordIdx = 0; WordIdx < Bounds.GetWordCount(); WordIdx++)
 	{
-		if (!Renderer->IsVisible())
+		uint32_t Bits = Bounds.VisibleBits[WordIdx];
+		while (Bits != 0)
 		{
-			continue;
-		}
+			const int32_t Idx = WordIdx * UHCullingBounds::BoxesPerWord + MathHelpers::CountTrailingZeros(Bits);
+			Bits &= Bits - 1;
 
-		// convert distance to counting index
-		int32_t CountingIndex = static_cast<int32_t>(Renderer->GetSquareDistanceToMainCam() / (CullingDistance * CullingDistance) * MaxCountingElement);
-		CountingIndex = std::min(CountingIndex, MaxCountingElement - 1);
-		CountingRenderers[CountingIndex].push_back(Renderer);
+			UHMeshRendererComponent* Renderer = Renderers[Idx];
+			if (!Renderer->IsVisible() || (bSoftwareOcclusion && SoftwareOcclusionResult[Idx] == 0))
+			{
+				continue;
+			}
+
+			// convert distance to counting index
+			int32_t CountingIndex = static_cast<int32_t>(Bounds.GetSquareDistance(Idx) / (CullingDistance * CullingDistance) * MaxCountingElement);
+			CountingIndex = std::min(CountingIndex, MaxCountingElement - 1);
+			CountingRenderers[CountingIndex].push_back(Renderer);
+		}
 	}
 
 	// collect renderers from counting sort result, front-to-back for opaque
@@ -513,10 +835,6 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 		{
 			UHMeshRendererComponent* Renderer = CountingRenderers[CountIdx][Idx];
 			const UHMaterial* Mat = CountingRenderers[CountIdx][Idx]->GetMaterial();
-			const UHMesh* Mesh = Renderer->GetMesh();
-			const int32_t TriCount = Mesh->GetIndicesCount() / 3;
-			const bool bOcclusionTest = bEnableHWOcclusionRT && TriCount >= OcclusionThresholdRT;
-
 			if (Mat->IsOpaque())
 			{
 				OpaquesToRender.push_back(Renderer);
@@ -526,11 +844,6 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 					Renderer->SetMotionDirty(false, CurrentFrameGT);
 				}
 			}
-
-			if (bOcclusionTest)
-			{
-				OcclusionRenderers.push_back(Renderer);
-			}
 		}
 	}
 
@@ -551,6 +864,115 @@ void UHDeferredShadingRenderer::CollectVisibleRenderer()
 			}
 		}
 	}
+
+	BuildInstanceBatches();
+}
+
+size_t UHDeferredShadingRenderer::GetInstanceIndexCapacity(size_t InRendererCount)
+{
+	// opaque and motion opaque instances are both subsets of all renderers, and motion translucent instances are never more than the rest
+	// GPU culled instances are a subset of all renderers too
+	return (std::max)(InRendererCount * 3, static_cast<size_t>(1));
+}
+
+size_t UHDeferredShadingRenderer::GetGPUInstanceOffset(size_t InRendererCount)
+{
+	return InRendererCount * 2;
+}
+
+bool UHDeferredShadingRenderer::IsGPUDrivenSupported() const
+{
+	return !GraphicInterface->IsMeshShaderSupported() && GraphicInterface->IsDrawIndirectFirstInstanceSupported()
+		&& GraphicInterface->IsDrawIndirectCountSupported();
+}
+
+bool UHDeferredShadingRenderer::IsHiZOcclusionSupported() const
+{
+	// the resources are created in editor or when it's enabled at launch
+	return GraphicInterface->IsMeshShaderSupported() && (GIsEditor || ConfigInterface->RenderingSetting().bEnableOcclusionCulling);
+}
+
+UHOcclusionPhase UHDeferredShadingRenderer::GetShadingOcclusionPhase() const
+{
+	if (!bEnableOcclusionRT)
+	{
+		return UHOcclusionPhase::None;
+	}
+
+	return bEnableDepthPrepassRT ? UHOcclusionPhase::Current : UHOcclusionPhase::Previous;
+}
+
+void UHDeferredShadingRenderer::UploadIndirectDraws()
+{
+	if (!bEnableGPUDrivenGT)
+	{
+		return;
+	}
+
+	UHGameTimerScope Scope("UploadIndirectDraws", false);
+
+	if (bIndirectDrawsDirty)
+	{
+		IndirectDrawBuilder.Build(IndirectDrawItems, static_cast<uint32_t>(GetGPUInstanceOffset(CurrentScene->GetAllRendererCount())));
+		IndirectCullDataUploads = GMaxFrameInFlight;
+		bIndirectDrawsDirty = false;
+	}
+
+	const std::vector<UHIndirectCullData>& CullData = IndirectDrawBuilder.GetCullData();
+	if (IndirectCullDataUploads > 0 && CullData.size() > 0)
+	{
+		GIndirectCullDataBuffer[CurrentFrameGT]->UploadAllData(CullData.data(), CullData.size() * sizeof(UHIndirectCullData));
+		IndirectCullDataUploads--;
+	}
+
+	// commands are written by GPU culling entirely, nothing else is uploaded per frame
+}
+
+void UHDeferredShadingRenderer::BuildInstanceBatches()
+{
+	UHGameTimerScope Scope("BuildInstanceBatches", false);
+
+	OpaqueBatches.clear();
+	MotionOpaqueBatches.clear();
+	MotionTranslucentBatches.clear();
+	InstanceRendererIndices.clear();
+
+	// mesh shader path collects its own instances
+	if (GraphicInterface->IsMeshShaderSupported())
+	{
+		return;
+	}
+
+	const auto BuildBatches = [this](const std::vector<UHMeshRendererComponent*>& InRenderers, const bool bAllowBatching
+		, std::vector<UHInstanceBatch>& OutBatches)
+	{
+		InstanceBatchItems.resize(InRenderers.size());
+		for (size_t Idx = 0; Idx < InRenderers.size(); Idx++)
+		{
+			const UHMeshRendererComponent* Renderer = InRenderers[Idx];
+
+			UHInstanceBatchItem& Item = InstanceBatchItems[Idx];
+			Item.Mesh = Renderer->GetMesh();
+			Item.Material = Renderer->GetMaterial();
+			Item.RendererIndex = static_cast<uint32_t>(Renderer->GetBufferDataIndex());
+			Item.bCanBatch = bAllowBatching;
+		}
+
+		InstanceBatcher.Build(InstanceBatchItems, OutBatches, InstanceRendererIndices);
+	};
+
+	// opaque renderers are culled and drawn by GPU in GPU-driven rendering
+	if (!bEnableGPUDrivenGT)
+	{
+		BuildBatches(OpaquesToRender, true, OpaqueBatches);
+	}
+	BuildBatches(MotionOpaquesToRender, true, MotionOpaqueBatches);
+	BuildBatches(TranslucentsToRender, false, MotionTranslucentBatches);
+
+	if (InstanceRendererIndices.size() > 0)
+	{
+		GInstanceIndexBuffer[CurrentFrameGT]->UploadAllData(InstanceRendererIndices.data(), InstanceRendererIndices.size() * sizeof(uint32_t));
+	}
 }
 
 void UHDeferredShadingRenderer::CollectMeshShaderInstance()
@@ -582,7 +1004,6 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 	for (UHMeshRendererComponent* Renderer : OpaquesToRender)
 	{
 		const UHMesh* Mesh = Renderer->GetMesh();
-		const bool bOcclusionTest = bEnableHWOcclusionRT && ((int32_t)Mesh->GetIndicesCount() / 3) >= OcclusionThresholdRT;
 
 		// set the instance to the corresponding material and it's current rendering index
 		const uint32_t MatDataIndex = Renderer->GetMaterial()->GetBufferDataIndex();
@@ -597,7 +1018,7 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 
 		UHMeshShaderData Data;
 		Data.RendererIndex = Renderer->GetBufferDataIndex();
-		Data.bDoOcclusionTest = bOcclusionTest && !Renderer->IsCameraInsideThisRenderer() ? 1 : 0;
+		Data.bDoOcclusionTest = bEnableOcclusionGT && !Renderer->IsCameraInsideThisRenderer() ? 1 : 0;
 		bool bClearMotionDirty = false;
 
 		for (uint32_t MeshletIdx = 0; MeshletIdx < Mesh->GetMeshletCount(); MeshletIdx++)
@@ -624,7 +1045,6 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 	{
 		UHMeshRendererComponent* Renderer = TranslucentsToRender[Idx];
 		const UHMesh* Mesh = Renderer->GetMesh();
-		const bool bOcclusionTest = bEnableHWOcclusionRT && ((int32_t)Mesh->GetIndicesCount() / 3) >= OcclusionThresholdRT;
 
 		const uint32_t MatDataIndex = Renderer->GetMaterial()->GetBufferDataIndex();
 		const int32_t NewIndex = MeshShaderInstancesCounter[MatDataIndex]++;
@@ -636,7 +1056,7 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 
 		UHMeshShaderData Data;
 		Data.RendererIndex = Renderer->GetBufferDataIndex();
-		Data.bDoOcclusionTest = bOcclusionTest && !Renderer->IsCameraInsideThisRenderer() ? 1 : 0;
+		Data.bDoOcclusionTest = bEnableOcclusionGT && !Renderer->IsCameraInsideThisRenderer() ? 1 : 0;
 
 		// translucent always output motion for now
 		for (uint32_t MeshletIdx = 0; MeshletIdx < Mesh->GetMeshletCount(); MeshletIdx++)
@@ -669,11 +1089,71 @@ void UHDeferredShadingRenderer::CollectMeshShaderInstance()
 	}
 }
 
-void UHDeferredShadingRenderer::GetLightCullingTileCount(uint32_t& TileCountX, uint32_t& TileCountY)
+void UHDeferredShadingRenderer::UpdateLightClusters()
 {
-	// safely round up the tile counts, doing culling at half resolution
-	TileCountX = ((RenderResolution.width >> 1) + LightCullingTileSize) / LightCullingTileSize;
-	TileCountY = ((RenderResolution.height >> 1) + LightCullingTileSize) / LightCullingTileSize;
+	UHGameTimerScope Scope("UpdateLightClusters", false);
+
+	UHCameraComponent* CurrentCamera = CurrentScene->GetMainCamera();
+	const uint32_t NumPointLights = static_cast<uint32_t>(CurrentScene->GetPointLightCount());
+	const uint32_t NumSpotLights = static_cast<uint32_t>(CurrentScene->GetSpotLightCount());
+
+	// cluster buffers aren't created in headless mode, lights are still assigned for profiling
+	const bool bHasClusterBuffers = GLightClusterGridBuffer[CurrentFrameGT] != nullptr;
+
+	// the grid of a frame without lights is cleared in DispatchLightClustering()
+	// GPU clustering is fully done on the render thread, it drops the indices beyond the capacity instead of reading the counter back
+	if (!CurrentCamera || !CurrentCamera->IsEnabled() || NumPointLights + NumSpotLights == 0 || bEnableGPULightClusteringGT)
+	{
+		return;
+	}
+
+	// CPU clustering, disabled lights have zero radius and are never assigned
+	LightClusterSpheres.Resize(NumPointLights, NumSpotLights);
+	for (uint32_t Idx = 0; Idx < NumPointLights; Idx++)
+	{
+		const UHPointLightConstants& Light = PointLightConstantsCPU[Idx];
+		LightClusterSpheres.SetSphere(Idx, Light.Position, Light.IsEnabled ? Light.Radius : 0.0f);
+	}
+
+	for (uint32_t Idx = 0; Idx < NumSpotLights; Idx++)
+	{
+		const UHSpotLightConstants& Light = SpotLightConstantsCPU[Idx];
+		const XMFLOAT4 Bound = UHLightClustering::GetSpotLightBound(Light.Position, Light.Dir, Light.Radius, Light.Angle);
+		LightClusterSpheres.SetSphere(NumPointLights + Idx, XMFLOAT3(Bound.x, Bound.y, Bound.z), Light.IsEnabled ? Bound.w : 0.0f);
+	}
+
+	// ranges are computed with job system, each job works on whole batches so no light is shared between jobs
+	const uint32_t NumBatches = LightClusterSpheres.GetPaddedCount() / UHLightClusterSpheres::LightsPerBatch;
+	JobSystem->ParallelFor(static_cast<int32_t>(NumBatches), 8, [this](int32_t Begin, int32_t End, int32_t WorkerIdx)
+	{
+		UHLightClustering::ComputeRanges(LightClusterView, LightClusterSpheres, Begin, End);
+	});
+	const uint32_t NumIndices = UHLightClustering::BuildLists(LightClusterView, LightClusterSpheres, LightClusterEntries, LightClusterIndices);
+
+	if (!bHasClusterBuffers)
+	{
+		return;
+	}
+
+	// grow the index list when it isn't enough, the capacity is kept when switching to GPU clustering
+	if (NumIndices > LightClusterIndexCapacity)
+	{
+		GraphicInterface->WaitGPU();
+		ResizeLightClusterBuffers(NumIndices);
+		UpdateDescriptors();
+
+		SystemConstantsCPU.GLightClusterIndexCapacity = LightClusterIndexCapacity;
+		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			GSystemConstantBuffer[Idx]->UploadAllData(&SystemConstantsCPU);
+		}
+	}
+
+	GLightClusterGridBuffer[CurrentFrameGT]->UploadAllData(LightClusterEntries.data(), LightClusterEntries.size() * sizeof(UHLightClusterEntry));
+	if (NumIndices > 0)
+	{
+		GLightClusterIndexBuffer[CurrentFrameGT]->UploadAllData(LightClusterIndices.data(), NumIndices * sizeof(uint32_t));
+	}
 }
 
 UHTextureCube* UHDeferredShadingRenderer::GetCurrentSkyCube() const
@@ -709,6 +1189,7 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 	UHGameTimer RTTimer;
 	UHProfiler RenderThreadProfile(&RTTimer);
 	bool bIsPresentedPreviously = false;
+	UHCPUProfiler::SetThreadName("Render Thread");
 
 	while (true)
 	{
@@ -719,24 +1200,31 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 		{
 			break;
 		}
+		UHCPUProfiler::MarkThreadFrame();
 
 		// prepare graphic builder
 		UHRenderBuilder SceneRenderBuilder(GraphicInterface, SceneRenderQueue.CommandBuffers[CurrentFrameRT]);
 		uint32_t PresentIndex;
 		{
 			UHProfilerScope Profiler(&RenderThreadProfile);
+			UHGameTimerScope Scope("RenderThreadFrame", false);
 
 			// collect worker bundle for this frame
 			if (bIsRenderingEnabledRT)
 			{
 				DepthParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
-				OcclusionParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
 				BaseParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
 				MotionOpaqueParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
 				MotionTranslucentParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
 				TranslucentParallelSubmitter.CollectCurrentFrameRTBundle(CurrentFrameRT);
 			}
 
+			// GPU timeline follows the CPU profiler, so both show up in the same trace
+			bool bEnableGPUTimeline = UHCPUProfiler::IsEnabled();
+		#if WITH_EDITOR
+			bEnableGPUTimeline &= GEnableGPUTiming;
+		#endif
+
 			if (bEnableAsyncComputeRT)
 			{
 				// ****************************** start async compute queue
@@ -748,6 +1236,9 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 				AsyncComputeBuilder.WaitFence(AsyncComputeQueue.Fences[CurrentFrameRT]);
 				AsyncComputeBuilder.ResetFence(AsyncComputeQueue.Fences[CurrentFrameRT]);
 				AsyncComputeBuilder.BeginCommandBuffer();
+				AsyncComputeTimelineRecorder.BeginFrame(AsyncComputeBuilder.GetCmdList(), CurrentFrameRT, bEnableGPUTimeline);
+				AsyncComputeBuilder.SetGPUTimelineRecorder(&AsyncComputeTimelineRecorder);
+				AsyncComputeTimelineRecorder.BeginScope(AsyncComputeBuilder.GetCmdList(), "AsyncCompute");
 				GraphicInterface->BeginCmdDebug(AsyncComputeBuilder.GetCmdList(), "Executing Async Compute");
 
 				if (bIsRenderingEnabledRT)
@@ -758,7 +1249,9 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 				}
 
 				GraphicInterface->EndCmdDebug(AsyncComputeBuilder.GetCmdList());
+				AsyncComputeTimelineRecorder.EndScope(AsyncComputeBuilder.GetCmdList());
 				AsyncComputeBuilder.EndCommandBuffer();
+				AsyncComputeTimelineRecorder.EndFrame();
 				AsyncComputeBuilder.ExecuteCmd(AsyncComputeQueue.Queue, AsyncComputeQueue.Fences[CurrentFrameRT], nullptr, AsyncComputeQueue.FinishedSemaphores[CurrentFrameRT]);
 				// ****************************** end async compute queue
 			}
@@ -770,8 +1263,17 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 
 			// begin command buffer, it will reset command buffer inline
 			SceneRenderBuilder.BeginCommandBuffer();
+			GraphicsTimelineRecorder.BeginFrame(SceneRenderBuilder.GetCmdList(), CurrentFrameRT, bEnableGPUTimeline);
+			SceneRenderBuilder.SetGPUTimelineRecorder(&GraphicsTimelineRecorder);
+			GraphicsTimelineRecorder.BeginScope(SceneRenderBuilder.GetCmdList(), "SceneRendering");
 			GraphicInterface->BeginCmdDebug(SceneRenderBuilder.GetCmdList(), "Drawing UHDeferredShadingRenderer");
 
+			// images swapped by texture streaming are uploaded before any pass samples them
+			if (TextureStreamer != nullptr)
+			{
+				TextureStreamer->RecordUploads(SceneRenderBuilder);
+			}
+
 			if (bIsRenderingEnabledRT)
 			{
 				// first-chance resource barriers and resets
@@ -780,14 +1282,26 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 					SceneRenderBuilder.ResourceBarrier(GOpaqueSceneResult, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 				}
 
-				if (bIsPresentedPreviously)
+				// Hi-Z occlusion of mesh shader path, the Hi-Z is built once the depth of last frame's visible renderers is ready
+				// with depth prepass, renderers are re-tested and the disoccluded ones are drawn before shading
+				// without it, the result is for the next frame
+				const bool bHiZOcclusion = bEnableOcclusionRT && GHiZBuffer != nullptr;
+				DispatchGPUCulling(SceneRenderBuilder);
+				RenderDepthPrePass(SceneRenderBuilder);
+				if (bHiZOcclusion && bEnableDepthPrepassRT)
 				{
-					ResolveOcclusionResult(SceneRenderBuilder);
+					BuildHiZ(SceneRenderBuilder);
+					DispatchOcclusionTest(SceneRenderBuilder);
+					RenderOcclusionPass(SceneRenderBuilder);
 				}
-				RenderDepthPrePass(SceneRenderBuilder);
+
 				RenderBasePass(SceneRenderBuilder);
-				RenderOcclusionPass(SceneRenderBuilder);
 				RenderMotionPass(SceneRenderBuilder);
+				if (bHiZOcclusion && !bEnableDepthPrepassRT)
+				{
+					BuildHiZ(SceneRenderBuilder);
+					DispatchOcclusionTest(SceneRenderBuilder);
+				}
 
 				if (!bEnableAsyncComputeRT)
 				{
@@ -796,7 +1310,7 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 					GenerateSH9Pass(SceneRenderBuilder);
 				}
 
-				DispatchLightCulling(SceneRenderBuilder);
+				DispatchLightClustering(SceneRenderBuilder);
 				DispatchRayShadowPass(SceneRenderBuilder);
 
 				RenderLightPass(SceneRenderBuilder);
@@ -814,16 +1328,10 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 			// blit scene to swap chain
 			PresentIndex = RenderSceneToSwapChain(SceneRenderBuilder);
 
-		#if WITH_EDITOR
-			// get GPU times
-			for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHRenderPassTypes::UHRenderPassMax); Idx++)
-			{
-				GPUTimeQueries[Idx]->ResolveTimeStamp(SceneRenderBuilder.GetCmdList());
-			}
-		#endif
-
 			GraphicInterface->EndCmdDebug(SceneRenderBuilder.GetCmdList());
+			GraphicsTimelineRecorder.EndScope(SceneRenderBuilder.GetCmdList());
 			SceneRenderBuilder.EndCommandBuffer();
+			GraphicsTimelineRecorder.EndFrame();
 
 			// wait the previous async queue is done (that means async compute queue always advanced one frame more than graphic)
 			// also needs to wait the swap chain is ready
@@ -842,11 +1350,12 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 			// ****************************** end scene rendering
 		}
 
+		DrawCalls = SceneRenderBuilder.DrawCalls;
+		UHCPUProfiler::AddCounter("DrawCalls", DrawCalls);
+
 	#if WITH_EDITOR
 		// profile ends before Present() call, since it contains vsync time
 		RenderThreadTime = RenderThreadProfile.GetDiff() * 1000.0f;
-		DrawCalls = SceneRenderBuilder.DrawCalls;
-		OccludedCalls = SceneRenderBuilder.OccludedCalls;
 	#endif
 
 		// wait until the previous presentation is done, to prevent glitches on some hardwares
@@ -864,23 +1373,28 @@ void UHDeferredShadingRenderer::RenderThreadLoop()
 	}
 }
 
-void UHDeferredShadingRenderer::WorkerThreadLoop(int32_t ThreadIdx)
+void UHDeferredShadingRenderer::RecordParallelBundles(void (UHDeferredShadingRenderer::*InTask)(int32_t))
 {
-	/** Worker steps **/
-	// Specify the task id before wake it
-	// doing the task
-	// notify finished
-
-	while (true)
+	// bundles are more than workers so the idle workers can steal from the busy ones
+	// each bundle still records a contiguous range, the execution order of bundles is untouched
+	JobSystem->ParallelFor(NumParallelBundles, 1, [this, InTask](int32_t Begin, int32_t End, int32_t WorkerIdx)
 	{
-		WorkerThreads[ThreadIdx]->WaitNotify();
-
-		if (WorkerThreads[ThreadIdx]->IsTermindate())
+		for (int32_t BundleIdx = Begin; BundleIdx < End; BundleIdx++)
 		{
-			break;
+			(this->*InTask)(BundleIdx);
 		}
+	});
+}
 
-		WorkerThreads[ThreadIdx]->DoTask(ThreadIdx);
-		WorkerThreads[ThreadIdx]->NotifyTaskDone();
-	}
+void UHDeferredShadingRenderer::DispatchMeshlets(UHRenderBuilder& RenderBuilder, const UHShaderClass* InShader, const uint32_t InMeshletCount
+	, const UHOcclusionPhase InPhase)
+{
+	// cone culling is only valid when back faces are culled
+	UHMeshShaderConstants Constants;
+	Constants.NumMeshShaderData = InMeshletCount;
+	Constants.bEnableConeCulling = (InShader->GetMaterialCache()->GetCullMode() == UHCullMode::CullBack) ? 1 : 0;
+	Constants.OcclusionPhase = UH_ENUM_VALUE_U(InPhase);
+
+	vkCmdPushConstants(RenderBuilder.GetCmdList(), InShader->GetPipelineLayout(), VK_SHADER_STAGE_TASK_BIT_EXT, 0, sizeof(UHMeshShaderConstants), &Constants);
+	RenderBuilder.DispatchMesh(MathHelpers::RoundUpDivide(InMeshletCount, GMeshShaderGroupSize), 1, 1);
 }
\ No newline at end of file
@@ -4,12 +4,18 @@
 #include "../Engine/Graphic.h"
 #include "../Engine/Asset.h"
 #include "../Engine/Config.h"
+#include "../Engine/TextureStreaming.h"
 #include "../Classes/Shader.h"
 #include "../Classes/Scene.h"
 #include "../Classes/GraphicState.h"
 #include "../Classes/Sampler.h"
 #include "../Classes/GPUQuery.h"
 #include "../Classes/Thread.h"
+#include "../Classes/JobSystem.h"
+#include "../Classes/InstanceBatcher.h"
+#include "../Classes/IndirectDrawBuilder.h"
+#include "../Classes/MeshGeometryPool.h"
+#include "../Classes/SoftwareOcclusion.h"
 #include "RenderingTypes.h"
 #include "RendererShared.h"
 #include "RenderBuilder.h"
@@ -21,7 +27,8 @@
 // shader includes
 #include "ShaderClass/DepthPassShader.h"
 #include "ShaderClass/BasePassShader.h"
-#include "ShaderClass/LightCullingShader.h"
+#include "ShaderClass/LightClusteringShader.h"
+#include "ShaderClass/GPUCullingShader.h"
 #include "ShaderClass/LightPassShader.h"
 #include "ShaderClass/SkyPassShader.h"
 #include "ShaderClass/MotionPassShader.h"
@@ -41,7 +48,8 @@
 #include "ShaderClass/ReflectionPassShader.h"
 #include "ShaderClass/RayTracing/RTReflectionMipmap.h"
 #include "ShaderClass/RayTracing/RTMeshInstanceTable.h"
-#include "ShaderClass/OcclusionPassShader.h"
+#include "ShaderClass/OcclusionTestShader.h"
+#include "ShaderClass/DownsampleDepthShader.h"
 #include "ShaderClass/RayTracing/CollectLightShader.h"
 #include "ShaderClass/RayTracing/RTSmoothReflectShader.h"
 
@@ -79,6 +87,12 @@ public:
 	void RebuildTextureTable();
 	void RebuildSamplerTable();
 
+	// nullptr if texture streaming is disabled
+	const UHTextureStreamingReport* GetTextureStreamingReport() const;
+
+	// GPU scopes of all queues, they're recorded while the CPU profiler is enabled
+	const UHGPUTimeline& GetGPUTimeline() const;
+
 #if WITH_EDITOR
 	void SetDebugViewIndex(int32_t Idx);
 	void SetEditorDelta(uint32_t InWidthDelta, uint32_t InHeightDelta);
@@ -86,20 +100,32 @@ public:
 	float GetRenderThreadTime() const;
 	int32_t GetDrawCallCount() const;
 	int32_t GetOccludedCallCount() const;
+	const UHTopLevelInstanceStats& GetTopLevelInstanceStats() const;
 
 	static UHDeferredShadingRenderer* GetRendererEditorOnly();
 	void RefreshSkyLight(bool bNeedRecompile);
 	void RefreshMaterialShaders(UHMaterial* InMat, bool bNeedReassignRendererGroup, bool bDelayRTShaderCreation);
+	double BenchmarkRefreshMaterialShaders();
 	void OnRendererMaterialChanged(UHMeshRendererComponent* InRenderer, UHMaterial* OldMat, UHMaterial* NewMat);
 
 	void ResetMaterialShaders(UHMeshRendererComponent* InMeshRenderer, UHMaterialCompileFlag CompileFlag, bool bIsOpaque, bool bNeedReassignRendererGroup);
 	void AppendMeshRenderers(const std::vector<UHMeshRendererComponent*> InRenderers);
 
 	void ToggleDepthPrepass();
+
+	// headless mode for CPU benchmarks on the null graphics backend, there are no render passes, shaders or render thread
+	// data buffers are in host memory and the stages of Update() can run one by one, the frame is advanced by caller
+	bool InitializeHeadless(UHScene* InScene);
+	void ReleaseHeadless();
+	void RunUpdateStage(UHRendererUpdateStage InStage);
+	void AdvanceFrameHeadless();
+	static const char* GetUpdateStageName(UHRendererUpdateStage InStage);
+	size_t GetNumRenderersToDraw() const;
 #endif
 	void RecreateMeshTables();
 	void RecreateMaterialShaders(UHMeshRendererComponent* InMeshRenderer, UHMaterial* InMat);
 	void RecreateMeshShaders(UHMaterial* InMat);
+	void RecreateIndirectShaders(UHMaterial* InMat);
 	void RecreateMeshShaderData(UHMaterial* InMat);
 	void UploadRendererInstances();
 	void RecreateRTShaders(std::vector<UHMaterial*> InMats, bool bRecreateTable);
@@ -109,27 +135,33 @@ public:
 		, UHTexture* Input, UHRenderTexture* Output
 		, const UHGaussianFilterConstants& Constants);
 
-	// occlusion query
-	void CreateOcclusionQuery();
-	void ReleaseOcclusionQuery();
+	// occlusion result buffers, they're visible by default
+	void CreateOcclusionResult();
+	void ReleaseOcclusionResult();
 
 	// async compute queue
 	bool CreateAsyncComputeQueue();
 	void ReleaseAsyncComputeQueue();
 
 	/************************************************ parallel task functions ************************************************/
-	// based on the scatter and gather method
-	void DepthPassTask(int32_t ThreadIdx);
-	void OcclusionPassTask(int32_t ThreadIdx);
-	void BasePassTask(int32_t ThreadIdx);
-	void MotionOpaqueTask(int32_t ThreadIdx);
-	void MotionTranslucentTask(int32_t ThreadIdx);
-	void TranslucentPassTask(int32_t ThreadIdx);
+	// based on the scatter and gather method, each task records a bundle and it's scheduled by the job system
+	void DepthPassTask(int32_t BundleIdx);
+	void BasePassTask(int32_t BundleIdx);
+	void MotionOpaqueTask(int32_t BundleIdx);
+	void MotionTranslucentTask(int32_t BundleIdx);
+	void TranslucentPassTask(int32_t BundleIdx);
 
 private:
 	/************************************************ functions ************************************************/
 	void RenderThreadLoop();
-	void WorkerThreadLoop(int32_t ThreadIdx);
+
+	// record parallel bundles with the job system, the task function is called once per bundle
+	void RecordParallelBundles(void (UHDeferredShadingRenderer::*InTask)(int32_t));
+
+	// dispatch amplification shader for the mesh shader data of a material group, the meshlets are culled there
+	// the occlusion phase decides which occlusion result the renderers are tested with
+	void DispatchMeshlets(UHRenderBuilder& RenderBuilder, const UHShaderClass* InShader, const uint32_t InMeshletCount
+		, const UHOcclusionPhase InPhase);
 
 	// prepare meshes
 	void PrepareMeshes();
@@ -169,23 +201,65 @@ private:
 	// create thread objects
 	void CreateThreadObjects();
 
+	// reserve the render lists for all renderers of the scene
+	void ReserveRenderLists();
+
+	// resize mesh shader data and counters for all material groups
+	void ResizeMeshShaderData();
+
 	// release constant buffers
 	void ReleaseDataBuffers();
 
+	// refresh the feature toggles of this frame, it's called before the update stages
+	void UpdateFeatureToggles();
+
 	// upload data buffers
 	void UploadDataBuffers();
 
 	// frustum culling
 	void FrustumCulling();
 
+	// rasterize the largest visible occluders on CPU and test the visible renderers against them, for the path without mesh shader
+	void SoftwareOcclusionCulling();
+
+	// occluder geometry of a mesh, it's copied when the mesh still has its CPU data, nullptr if the mesh can't be an occluder
+	const UHOccluderMesh* GetOccluderMesh(const UHMesh* InMesh);
+
+	// Hi-Z occlusion culling is done in the mesh shader path, the software occlusion is used otherwise
+	bool IsHiZOcclusionSupported() const;
+
+	// the occlusion phase of base and motion pass, they draw the re-tested result when the depth of both phases is ready
+	// otherwise they draw last frame's visible renderers and the Hi-Z is built after them for the next frame
+	UHOcclusionPhase GetShadingOcclusionPhase() const;
+
 	// collect visible renderer
 	void CollectVisibleRenderer();
 
+	// build instanced batches of visible renderers and upload their renderer indices
+	void BuildInstanceBatches();
+
+	// instance index buffer holds the opaque, motion opaque and motion translucent instances at most
+	// plus the instances compacted by GPU culling, which start from GetGPUInstanceOffset()
+	static size_t GetInstanceIndexCapacity(size_t InRendererCount);
+	static size_t GetGPUInstanceOffset(size_t InRendererCount);
+
+	// GPU-driven rendering is the indirect draw path for the devices without mesh shader
+	bool IsGPUDrivenSupported() const;
+
+	// rebuild indirect draw buckets if renderers changed, and upload the cull data of the rebuilt buckets
+	void UploadIndirectDraws();
+
 	// collect mesh shader instance
 	void CollectMeshShaderInstance();
 
-	// get light culling tile count
-	void GetLightCullingTileCount(uint32_t& TileCountX, uint32_t& TileCountY);
+	// request textures of visible renderers and apply the streamed mips
+	void UpdateTextureStreaming();
+
+	// assign lights to clusters by CPU when GPU clustering is disabled, the index list is grown when it isn't enough
+	void UpdateLightClusters();
+
+	// recreate the cluster buffers of all frames, the index capacity is at least InNumIndices
+	void ResizeLightClusterBuffers(uint32_t InNumIndices);
 
 	// get current skycube
 	UHTextureCube* GetCurrentSkyCube() const;
@@ -196,11 +270,13 @@ private:
 	/************************************************ rendering functions ************************************************/
 	void BuildTopLevelAS(UHRenderBuilder& RenderBuilder);
 	void CollectLightPass(UHRenderBuilder& RenderBuilder);
-	void ResolveOcclusionResult(UHRenderBuilder& RenderBuilder);
+	void DispatchGPUCulling(UHRenderBuilder& RenderBuilder);
 	void RenderDepthPrePass(UHRenderBuilder& RenderBuilder);
+	void BuildHiZ(UHRenderBuilder& RenderBuilder);
+	void DispatchOcclusionTest(UHRenderBuilder& RenderBuilder);
 	void RenderOcclusionPass(UHRenderBuilder& RenderBuilder);
 	void RenderBasePass(UHRenderBuilder& RenderBuilder);
-	void DispatchLightCulling(UHRenderBuilder& RenderBuilder);
+	void DispatchLightClustering(UHRenderBuilder& RenderBuilder);
 	void DispatchRayShadowPass(UHRenderBuilder& RenderBuilder);
 	void DispatchSmoothReflectVectorPass(UHRenderBuilder& RenderBuilder);
 	void DispatchRayReflectionPass(UHRenderBuilder& RenderBuilder);
@@ -236,9 +312,13 @@ private:
 	UHQueueSubmitter AsyncComputeQueue;
 	UHQueueSubmitter SceneRenderQueue;
 
+	// GPU timeline and its recorder of each queue
+	UHGPUTimeline GPUTimeline;
+	UHGPUTimelineRecorder GraphicsTimelineRecorder;
+	UHGPUTimelineRecorder AsyncComputeTimelineRecorder;
+
 	// parallel submitters
 	UHParallelSubmitter DepthParallelSubmitter;
-	UHParallelSubmitter OcclusionParallelSubmitter;
 	UHParallelSubmitter BaseParallelSubmitter;
 	UHParallelSubmitter MotionOpaqueParallelSubmitter;
 	UHParallelSubmitter MotionTranslucentParallelSubmitter;
@@ -249,10 +329,13 @@ private:
 	uint32_t CurrentFrameRT;
 	uint32_t FrameNumberRT;
 
-	// Render thread defines, UH engine will always use a thread for rendering, and doing parallel submission with worker threads
+	// Render thread defines, UH engine will always use a thread for rendering, and doing parallel submission with the job system
+	// the renderers are split into more bundles than workers, so the workers can steal bundles from each other
 	UniquePtr<UHThread> RenderThread;
 	int32_t NumWorkerThreads;
-	std::vector<UniquePtr<UHThread>> WorkerThreads;
+	int32_t NumParallelBundles;
+	static const int32_t BundlesPerWorker = 4;
+	UniquePtr<UHJobSystem> JobSystem;
 	bool bIsResetNeededShared;
 	bool bVsyncRT;
 	bool bIsSwapChainResetGT;
@@ -263,10 +346,14 @@ private:
 	bool bHasRefractionMaterialGT;
 	bool bHasRefractionMaterialRT;
 	bool bHDREnabledRT;
-	bool bEnableHWOcclusionRT;
+	bool bEnableOcclusionGT;
+	bool bEnableOcclusionRT;
 	bool bEnableDepthPrepassRT;
-	int32_t OcclusionThresholdRT;
-	float RTCullingDistanceRT;
+	bool bEnableGPUDrivenGT;
+	bool bEnableGPUDrivenRT;
+	bool bEnableGPULightClusteringGT;
+	bool bEnableGPULightClusteringRT;
+	float CullingDistanceRT;
 	int32_t RTReflectionQualityRT;
 	bool bTemporalAART;
 	bool bDenoiseReflectionRT;
@@ -279,7 +366,6 @@ private:
 
 	// object & material constants, I'll create constant buffer which are big enough for all renderers
 	std::vector<UHObjectConstants> ObjectConstantsCPU;
-	std::vector<UHObjectConstants> OcclusionConstantsCPU;
 
 	// light buffers, this will be used as structure buffer instead of constant
 	std::vector<UHDirectionalLightConstants> DirLightConstantsCPU;
@@ -297,6 +383,9 @@ private:
 	UniquePtr<UHTextureTable> TextureTable;
 	UniquePtr<UHSamplerTable> SamplerTable;
 
+	// texture streaming
+	UniquePtr<UHTextureStreamer> TextureStreamer;
+
 
 	/************************************************ Render Pass stuffs ************************************************/
 
@@ -309,11 +398,16 @@ private:
 	std::unordered_map<int32_t, UniquePtr<UHBasePassShader>> BasePassShaders;
 	UHRenderPassObject BasePassObj;
 
-	// -------------------------------------------- Light and Light Culling Pass -------------------------------------------- //
-	const uint32_t LightCullingTileSize;
-	const uint32_t MaxPointLightPerTile;
-	const uint32_t MaxSpotLightPerTile;
-	UniquePtr<UHLightCullingShader> LightCullingShader;
+	// -------------------------------------------- Light and Light Clustering Pass -------------------------------------------- //
+	// GPU clustering is done in 3 passes: count lights per cluster, allocate the index list and fill the indices
+	UHLightClusterView LightClusterView;
+	UHLightClusterSpheres LightClusterSpheres;
+	std::vector<UHLightClusterEntry> LightClusterEntries;
+	std::vector<uint32_t> LightClusterIndices;
+	uint32_t LightClusterIndexCapacity;
+	UniquePtr<UHLightClusteringShader> LightClusterCountShader;
+	UniquePtr<UHLightClusteringShader> LightClusterAllocateShader;
+	UniquePtr<UHLightClusteringShader> LightClusterFillShader;
 	UniquePtr<UHLightPassShader> LightPassShader;
 	UniquePtr<UHReflectionPassShader> ReflectionPassShader;
 	UniquePtr<UHRTReflectionMipmap> RTReflectionMipmapShader;
@@ -359,6 +453,11 @@ private:
 	// renderer instances
 	std::vector<UHRendererInstance> RendererInstances;
 
+	// draw call counters
+	int32_t DrawCalls;
+	int32_t OccludedCalls;
+	std::vector<int32_t> BundleDrawCalls;
+
 #if WITH_EDITOR
 	// debug view shader
 	UniquePtr<UHDebugViewShader> DebugViewShader;
@@ -369,10 +468,7 @@ private:
 
 	// profiles
 	float RenderThreadTime;
-	int32_t DrawCalls;
-	int32_t OccludedCalls;
-	std::vector<int32_t> ThreadDrawCalls;
-	std::vector<int32_t> ThreadOccludedCalls;
+	UHTopLevelInstanceStats TopLevelInstanceStats;
 
 	// GUI
 	uint32_t EditorWidthDelta;
@@ -381,7 +477,6 @@ private:
 	static UHDeferredShadingRenderer* SceneRendererEditorOnly;
 	bool bDrawDebugViewRT;
 #endif
-	UHGPUQuery* GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::UHRenderPassMax)];
 
 	// -------------------------------------------- Ray tracing related -------------------------------------------- //
 	UniquePtr<UHRTDefaultHitGroupShader> RTDefaultHitGroupShader;
@@ -402,21 +497,60 @@ private:
 	uint32_t RTInstanceCount;
 	bool bIsRaytracingEnableRT;
 
+	// number of frames that need to refresh all top level AS instances, one frame for each AS
+	uint32_t TopLevelASRefreshFrames;
+
 	// -------------------------------------------- Culling & sorting related -------------------------------------------- //
 	std::vector<UHMeshRendererComponent*> OpaquesToRender;
 	std::vector<UHMeshRendererComponent*> MotionOpaquesToRender;
 	std::vector<UHMeshRendererComponent*> TranslucentsToRender;
-	std::vector<UHMeshRendererComponent*> OcclusionRenderers;
+
+	// instanced batches of the lists above, FirstItem of a batch indexes the list it's built from
+	// depth and base pass share the opaque batches, translucent renderers aren't batched to keep back-to-front order
+	UHInstanceBatcher InstanceBatcher;
+	std::vector<UHInstanceBatchItem> InstanceBatchItems;
+	std::vector<UHInstanceBatch> OpaqueBatches;
+	std::vector<UHInstanceBatch> MotionOpaqueBatches;
+	std::vector<UHInstanceBatch> MotionTranslucentBatches;
+	std::vector<uint32_t> InstanceRendererIndices;
+
+	// -------------------------------------------- GPU-driven rendering -------------------------------------------- //
+	// opaque renderers are culled by compute and drawn with one indirect count draw per material
+	// meshes are packed into the geometry pool, so the indirect shaders are per material and the id is material data index
+	// items are indexed by renderer data index, the buckets are rebuilt only when an item changes
+	UniquePtr<UHGPUCullingShader> GPUCullingShader;
+	UHMeshGeometryPool MeshGeometryPool;
+	std::unordered_map<int32_t, UniquePtr<UHDepthPassShader>> DepthIndirectShaders;
+	std::unordered_map<int32_t, UniquePtr<UHBasePassShader>> BaseIndirectShaders;
+	UHIndirectDrawBuilder IndirectDrawBuilder;
+	std::vector<UHIndirectDrawItem> IndirectDrawItems;
+	bool bIndirectDrawsDirty;
+
+	// cull data is uploaded to every frame buffer after a rebuild
+	uint32_t IndirectCullDataUploads;
 
 	// max element setting for counting sort, higher number = better result for GPU time but longer CPU time
 	// lower = better CPU time but longer GPU time, need to trade off between these.
 	static const int32_t MaxCountingElement = 4096;
 	std::vector<UHMeshRendererComponent*> CountingRenderers[MaxCountingElement];
 
-	UHGPUQuery* OcclusionQuery[GMaxFrameInFlight];
-	std::vector<UniquePtr<UHOcclusionPassShader>> OcclusionPassShaders;
+	// renderer count to switch from the linear SIMD culling to the BVH culling, linear culling is faster for small scenes
+	static const int32_t BVHCullingThreshold = 8192;
+
+	// -------------------------------------------- Occlusion culling related -------------------------------------------- //
+	// mesh shader path, the depth of last frame's visible renderers is drawn first and the Hi-Z is built from it
+	// then all renderers are re-tested, and the disoccluded ones are drawn in the occlusion pass before the base pass
+	UniquePtr<UHDownsampleDepthShader> HiZFromDepthShader;
+	UniquePtr<UHDownsampleDepthShader> HiZDownsampleShader;
+	UniquePtr<UHOcclusionTestShader> OcclusionTestShader;
 	UHRenderPassObject OcclusionPassObj;
 
+	// software path, the result is indexed by renderer data index and it's uploaded for GPU culling
+	UHSoftwareOcclusion SoftwareOcclusion;
+	std::unordered_map<const UHMesh*, UHOccluderMesh> OccluderCache;
+	std::vector<std::pair<float, int32_t>> OccluderCandidates;
+	std::vector<uint32_t> SoftwareOcclusionResult;
+
 	// -------------------------------------------- Mesh shader related -------------------------------------------- //
 	UniquePtr<UHMeshTable> PositionTable;
 	UniquePtr<UHMeshTable> UV0Table;
@@ -424,6 +558,7 @@ private:
 	UniquePtr<UHMeshTable> TangentTable;
 	UniquePtr<UHMeshTable> IndicesTable;
 	UniquePtr<UHMeshTable> MeshletTable;
+	UniquePtr<UHMeshTable> MeshletIndexTable;
 
 	uint32_t MeshInstanceCount;
 	std::vector<UHMesh*> MeshInUse;
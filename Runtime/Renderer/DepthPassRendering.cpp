@@ -1,26 +1,9 @@
 #include "DeferredShadingRenderer.h"
 
-class UHDepthPassAsyncTask : public UHAsyncTask
-{
-public:
-	void Init(UHDeferredShadingRenderer* InRenderer)
-	{
-		SceneRenderer = InRenderer;
-	}
-
-	virtual void DoTask(const int32_t ThreadIdx) override
-	{
-		SceneRenderer->DepthPassTask(ThreadIdx);
-	}
-
-private:
-	UHDeferredShadingRenderer* SceneRenderer = nullptr;
-};
-
 void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderDepthPrePass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::DepthPrePass)], "DepthPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "DepthPass");
 	if (CurrentScene == nullptr || !bEnableDepthPrepassRT)
 	{
 		return;
@@ -48,7 +31,7 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 					, MeshletTable->GetDescriptorSet(CurrentFrameRT) 
 					, PositionTable->GetDescriptorSet(CurrentFrameRT)
 					, UV0Table->GetDescriptorSet(CurrentFrameRT)
-					, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+					, MeshletIndexTable->GetDescriptorSet(CurrentFrameRT)
 				};
 				RenderBuilder.BindDescriptorSet(DepthMeshShaders[SortedMeshShaderGroupIndex[0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
 			}
@@ -69,8 +52,9 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 				RenderBuilder.BindGraphicState(DepthMS->GetState());
 				RenderBuilder.BindDescriptorSet(DepthMS->GetPipelineLayout(), DepthMS->GetDescriptorSet(CurrentFrameRT));
 
-				// Dispatch meshlets
-				RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+				// dispatch meshlets, they will be culled in amplification shader
+				// only the renderers visible last frame are drawn here, the Hi-Z is built from them
+				DispatchMeshlets(RenderBuilder, DepthMS, VisibleMeshlets, bEnableOcclusionRT ? UHOcclusionPhase::Previous : UHOcclusionPhase::None);
 
 				GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 			}
@@ -80,34 +64,19 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 			// begin render pass
 			RenderBuilder.BeginRenderPass(DepthPassObj, RenderResolution, DepthClearValue, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
+			for (int32_t I = 0; I < NumParallelBundles; I++)
 			{
-				ThreadDrawCalls[I] = 0;
+				BundleDrawCalls[I] = 0;
 			}
-#endif
 
-			// init and wake all tasks
-			static UHDepthPassAsyncTask Tasks[GMaxWorkerThreads];
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
-			{
-				Tasks[I].Init(this);
-				WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-				WorkerThreads[I]->WakeThread();
-			}
+			// record all bundles with job system
+			RecordParallelBundles(&UHDeferredShadingRenderer::DepthPassTask);
 
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
+			for (int32_t I = 0; I < NumParallelBundles; I++)
 			{
-				WorkerThreads[I]->WaitTask();
+				RenderBuilder.DrawCalls += BundleDrawCalls[I];
 			}
 
-#if WITH_EDITOR
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
-			{
-				RenderBuilder.DrawCalls += ThreadDrawCalls[I];
-			}
-#endif
-
 			// execute all recorded batches
 			RenderBuilder.ExecuteBundles(DepthParallelSubmitter);
 		}
@@ -118,20 +87,21 @@ void UHDeferredShadingRenderer::RenderDepthPrePass(UHRenderBuilder& RenderBuilde
 }
 
 // depth pass task, called by worker thread
-void UHDeferredShadingRenderer::DepthPassTask(int32_t ThreadIdx)
+void UHDeferredShadingRenderer::DepthPassTask(int32_t BundleIdx)
 {
-	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(OpaquesToRender.size());
-	const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
-	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
-	const int32_t EndIdx = (ThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
+	// simply separate batch recording into N bundles, GPU-driven rendering records indirect draw buckets instead
+	const std::vector<UHIndirectDrawBucket>& IndirectBuckets = IndirectDrawBuilder.GetBuckets();
+	const int32_t MaxCount = static_cast<int32_t>(bEnableGPUDrivenRT ? IndirectBuckets.size() : OpaqueBatches.size());
+	const int32_t BatchCount = (MaxCount + NumParallelBundles) / NumParallelBundles;
+	const int32_t StartIdx = std::min(BatchCount * BundleIdx, MaxCount);
+	const int32_t EndIdx = (BundleIdx == NumParallelBundles - 1) ? MaxCount : std::min(StartIdx + BatchCount, MaxCount);
 
 	VkCommandBufferInheritanceInfo InheritanceInfo{};
 	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
 	InheritanceInfo.renderPass = DepthPassObj.RenderPass;
 	InheritanceInfo.framebuffer = DepthPassObj.FrameBuffer;
 
-	UHRenderBuilder RenderBuilder(GraphicInterface, DepthParallelSubmitter.WorkerCommandBuffers[ThreadIdx * GMaxFrameInFlight + CurrentFrameRT]);
+	UHRenderBuilder RenderBuilder(GraphicInterface, DepthParallelSubmitter.WorkerCommandBuffers[BundleIdx * GMaxFrameInFlight + CurrentFrameRT]);
 	if (StartIdx >= EndIdx)
 	{
 		RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
@@ -151,33 +121,61 @@ void UHDeferredShadingRenderer::DepthPassTask(int32_t ThreadIdx)
 		RenderBuilder.BindDescriptorSet(DepthPassShaders.begin()->second->GetPipelineLayout(), TextureTableSets, GTextureTableSpace);
 	}
 
+	if (bEnableGPUDrivenRT)
+	{
+		// the same as base pass, one indirect count draw per material from the geometry pool
+		RenderBuilder.BindIndexBuffer(MeshGeometryPool.GetIndexBuffer());
+		for (int32_t I = StartIdx; I < EndIdx; I++)
+		{
+			const UHIndirectDrawBucket& Bucket = IndirectBuckets[I];
+			const auto Shader = DepthIndirectShaders.find(Bucket.Material->GetBufferDataIndex());
+			if (Shader == DepthIndirectShaders.end())
+			{
+				continue;
+			}
+
+			GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Bucket.Material->GetName() + " (Indirect, Max: "
+				+ std::to_string(Bucket.Capacity) + ")");
+
+			const UHDepthPassShader* DepthShader = Shader->second.get();
+			RenderBuilder.BindGraphicState(DepthShader->GetState());
+			RenderBuilder.BindDescriptorSet(DepthShader->GetPipelineLayout(), DepthShader->GetDescriptorSet(CurrentFrameRT));
+			RenderBuilder.DrawIndexedIndirectCount(GIndirectDrawBuffer[CurrentFrameRT]->GetBuffer(), Bucket.FirstCommand
+				, GIndirectCountBuffer[CurrentFrameRT]->GetBuffer(), static_cast<uint32_t>(I), Bucket.Capacity);
+
+			GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+		}
+
+		RenderBuilder.EndCommandBuffer();
+
+		BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
+		return;
+	}
+
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		const UHMeshRendererComponent* Renderer = OpaquesToRender[I];
-		const UHMaterial* Mat = Renderer->GetMaterial();
+		const UHInstanceBatch& Batch = OpaqueBatches[I];
+		const UHMeshRendererComponent* Renderer = OpaquesToRender[Batch.FirstItem];
 		UHMesh* Mesh = Renderer->GetMesh();
 		int32_t RendererIdx = Renderer->GetBufferDataIndex();
 
 		const UHDepthPassShader* DepthShader = DepthPassShaders[RendererIdx].get();
 
 		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Mesh->GetName() + " (Tris: " +
-			std::to_string(Mesh->GetIndicesCount() / 3) + ")");
+			std::to_string(Mesh->GetIndicesCount() / 3) + ", Instances: " + std::to_string(Batch.InstanceCount) + ")");
 
 		// bind pipelines
 		RenderBuilder.BindGraphicState(DepthShader->GetState());
-		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(DepthShader->GetPipelineLayout(), DepthShader->GetDescriptorSet(CurrentFrameRT));
 
 		// draw call
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
+		RenderBuilder.DrawIndexedInstanced(Mesh->GetIndicesCount(), Batch.InstanceCount, Batch.FirstInstance);
 
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 	}
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
-	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
+	BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
 }
\ No newline at end of file
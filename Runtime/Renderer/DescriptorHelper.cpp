@@ -55,6 +55,25 @@ void UHDescriptorHelper::WriteImage(const std::vector<UHTexture*>& InTextures, u
 	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
 }
 
+// write a single element of descriptor array
+void UHDescriptorHelper::WriteImageArrayElement(const UHTexture* InTexture, uint32_t InDstBinding, uint32_t InArrayElement)
+{
+	VkDescriptorImageInfo NewInfo{};
+	NewInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	NewInfo.imageView = (InTexture != nullptr) ? InTexture->GetImageView() : nullptr;
+
+	VkWriteDescriptorSet DescriptorWrite{};
+	DescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	DescriptorWrite.dstSet = DescriptorSetToWrite;
+	DescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	DescriptorWrite.dstBinding = InDstBinding;
+	DescriptorWrite.dstArrayElement = InArrayElement;
+	DescriptorWrite.descriptorCount = 1;
+	DescriptorWrite.pImageInfo = &NewInfo;
+
+	vkUpdateDescriptorSets(LogicalDevice, 1, &DescriptorWrite, 0, nullptr);
+}
+
 void UHDescriptorHelper::WriteSampler(const UHSampler* InSampler, uint32_t InDstBinding)
 {
 	VkDescriptorImageInfo NewInfo{};
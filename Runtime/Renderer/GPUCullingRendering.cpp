@@ -0,0 +1,52 @@
+#include "DeferredShadingRenderer.h"
+
+void UHDeferredShadingRenderer::DispatchGPUCulling(UHRenderBuilder& RenderBuilder)
+{
+	UHGameTimerScope Scope("DispatchGPUCulling", false);
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "GPUCulling");
+	if (CurrentScene == nullptr || !bEnableGPUDrivenRT)
+	{
+		return;
+	}
+
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch GPU Culling");
+	{
+		// occlusion result of this frame is uploaded from software occlusion culling, no barrier is needed for host writes before submission
+		const bool bOcclusionTest = bEnableOcclusionRT && GOcclusionResult[CurrentFrameRT] != nullptr;
+
+		// draw counts are appended by atomics, clear them in the command list as they're never written by CPU
+		const UHRenderBuffer<uint32_t>* CountBuffer = GIndirectCountBuffer[CurrentFrameRT].get();
+		RenderBuilder.ClearUAVBuffer(CountBuffer->GetBuffer(), 0);
+		RenderBuilder.ResourceBarrier(CountBuffer->GetBuffer(), CountBuffer->GetBufferSize()
+			, VK_ACCESS_TRANSFER_WRITE_BIT, static_cast<VkAccessFlagBits>(VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT)
+			, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		// bind state
+		UHComputeState* State = GPUCullingShader->GetComputeState();
+		RenderBuilder.BindComputeState(State);
+
+		// bind sets
+		RenderBuilder.BindDescriptorSetCompute(GPUCullingShader->GetPipelineLayout(), GPUCullingShader->GetDescriptorSet(CurrentFrameRT));
+
+		UHGPUCullingConstants Constants{};
+		Constants.NumRenderers = static_cast<uint32_t>(IndirectDrawBuilder.GetCullData().size());
+		Constants.bEnableOcclusion = bOcclusionTest ? 1 : 0;
+		Constants.CullingDistance = CullingDistanceRT;
+		Constants.FirstInstance = IndirectDrawBuilder.GetFirstInstance();
+		vkCmdPushConstants(RenderBuilder.GetCmdList(), GPUCullingShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Constants), &Constants);
+
+		// one thread per renderer
+		RenderBuilder.Dispatch(MathHelpers::RoundUpDivide(Constants.NumRenderers, GThreadGroup1D), 1, 1);
+
+		// commands and draw counts are consumed by indirect count draws, and instances are read by vertex shaders
+		const UHRenderBuffer<UHDrawIndexedIndirectCommand>* DrawBuffer = GIndirectDrawBuffer[CurrentFrameRT].get();
+		const UHRenderBuffer<uint32_t>* InstanceBuffer = GInstanceIndexBuffer[CurrentFrameRT].get();
+		RenderBuilder.ResourceBarrier(DrawBuffer->GetBuffer(), DrawBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+		RenderBuilder.ResourceBarrier(CountBuffer->GetBuffer(), CountBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+		RenderBuilder.ResourceBarrier(InstanceBuffer->GetBuffer(), InstanceBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+	}
+	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+}
\ No newline at end of file
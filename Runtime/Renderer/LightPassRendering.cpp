@@ -1,33 +1,72 @@
 #include "DeferredShadingRenderer.h"
 
-void UHDeferredShadingRenderer::DispatchLightCulling(UHRenderBuilder& RenderBuilder)
+void UHDeferredShadingRenderer::DispatchLightClustering(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("DispatchLightCulling", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::LightCulling)], "LightCulling");
-	if (CurrentScene == nullptr || (CurrentScene->GetPointLightCount() == 0 && CurrentScene->GetSpotLightCount() == 0))
+	UHGameTimerScope Scope("DispatchLightClustering", false);
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "LightClustering");
+	if (CurrentScene == nullptr)
 	{
 		return;
 	}
 
-	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Light Culling");
+	// without lights, clear the grid in this frame slot so it won't keep the lists of removed lights
+	const UHRenderBuffer<UHLightClusterEntry>* GridBuffer = GLightClusterGridBuffer[CurrentFrameRT].get();
+	if (CurrentScene->GetPointLightCount() == 0 && CurrentScene->GetSpotLightCount() == 0)
 	{
-		// clear the point light/spot light list buffer
-		RenderBuilder.ClearUAVBuffer(GPointLightListBuffer->GetBuffer(), 0);
-		RenderBuilder.ClearUAVBuffer(GPointLightListTransBuffer->GetBuffer(), 0);
-		RenderBuilder.ClearUAVBuffer(GSpotLightListBuffer->GetBuffer(), 0);
-		RenderBuilder.ClearUAVBuffer(GSpotLightListTransBuffer->GetBuffer(), 0);
+		RenderBuilder.ClearUAVBuffer(GridBuffer->GetBuffer(), 0);
+		RenderBuilder.ResourceBarrier(GridBuffer->GetBuffer(), GridBuffer->GetBufferSize()
+			, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		return;
+	}
 
-		// bind state
-		UHComputeState* State = LightCullingShader->GetComputeState();
-		RenderBuilder.BindComputeState(State);
+	// the clusters are uploaded by CPU in UpdateLightClusters() when GPU clustering is disabled
+	if (!bEnableGPULightClusteringRT)
+	{
+		return;
+	}
 
-		// bind sets
-		RenderBuilder.BindDescriptorSetCompute(LightCullingShader->GetPipelineLayout(), LightCullingShader->GetDescriptorSet(CurrentFrameRT));
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Light Clustering");
+	{
+		const UHRenderBuffer<uint32_t>* IndexBuffer = GLightClusterIndexBuffer[CurrentFrameRT].get();
+		const UHRenderBuffer<uint32_t>* CounterBuffer = GLightClusterCounterBuffer[CurrentFrameRT].get();
+		const uint32_t NumLights = static_cast<uint32_t>(CurrentScene->GetPointLightCount() + CurrentScene->GetSpotLightCount());
+		const uint32_t NumEntries = static_cast<uint32_t>(GridBuffer->GetElementCount());
+
+		// clear the grid and the counter in the command list, they're never written by CPU
+		RenderBuilder.ClearUAVBuffer(GridBuffer->GetBuffer(), 0);
+		RenderBuilder.ClearUAVBuffer(CounterBuffer->GetBuffer(), 0);
+		RenderBuilder.ResourceBarrier(GridBuffer->GetBuffer(), GridBuffer->GetBufferSize()
+			, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		RenderBuilder.ResourceBarrier(CounterBuffer->GetBuffer(), CounterBuffer->GetBufferSize()
+			, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		// the grid is read and written by atomics in all passes
+		const VkAccessFlagBits GridAccess = static_cast<VkAccessFlagBits>(VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+		// pass 1: count lights per cluster, one thread per light
+		RenderBuilder.BindComputeState(LightClusterCountShader->GetComputeState());
+		RenderBuilder.BindDescriptorSetCompute(LightClusterCountShader->GetPipelineLayout(), LightClusterCountShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.Dispatch(MathHelpers::RoundUpDivide(NumLights, GThreadGroup1D), 1, 1);
+		RenderBuilder.ResourceBarrier(GridBuffer->GetBuffer(), GridBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, GridAccess, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		// pass 2: allocate the index list, one thread per entry
+		RenderBuilder.BindComputeState(LightClusterAllocateShader->GetComputeState());
+		RenderBuilder.BindDescriptorSetCompute(LightClusterAllocateShader->GetPipelineLayout(), LightClusterAllocateShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.Dispatch(MathHelpers::RoundUpDivide(NumEntries, GThreadGroup1D), 1, 1);
+		RenderBuilder.ResourceBarrier(GridBuffer->GetBuffer(), GridBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, GridAccess, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		// pass 3: fill the indices, one thread per light
+		RenderBuilder.BindComputeState(LightClusterFillShader->GetComputeState());
+		RenderBuilder.BindDescriptorSetCompute(LightClusterFillShader->GetPipelineLayout(), LightClusterFillShader->GetDescriptorSet(CurrentFrameRT));
+		RenderBuilder.Dispatch(MathHelpers::RoundUpDivide(NumLights, GThreadGroup1D), 1, 1);
 
-		// dispatch light culliong
-		uint32_t TileCountX, TileCountY;
-		GetLightCullingTileCount(TileCountX, TileCountY);
-		RenderBuilder.Dispatch(TileCountX, TileCountY, 1);
+		// the lists are read by light pass, ray tracing and translucent pass
+		RenderBuilder.ResourceBarrier(GridBuffer->GetBuffer(), GridBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		RenderBuilder.ResourceBarrier(IndexBuffer->GetBuffer(), IndexBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
 	}
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
@@ -35,7 +74,7 @@ void UHDeferredShadingRenderer::DispatchLightCulling(UHRenderBuilder& RenderBuil
 void UHDeferredShadingRenderer::RenderLightPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderLightPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::LightPass)], "LightPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "LightPass");
 	if (CurrentScene == nullptr || (CurrentScene->GetDirLightCount() == 0 && CurrentScene->GetPointLightCount() && CurrentScene->GetSpotLightCount()))
 	{
 		return;
@@ -1,31 +1,5 @@
 #include "DeferredShadingRenderer.h"
 
-class UHMotionPassAsyncTask : public UHAsyncTask
-{
-public:
-	void Init(UHDeferredShadingRenderer* InRenderer, const bool bInIsOpaque)
-	{
-		SceneRenderer = InRenderer;
-		bIsOpaque = bInIsOpaque;
-	}
-
-	virtual void DoTask(const int32_t ThreadIdx) override
-	{
-		if (bIsOpaque)
-		{
-			SceneRenderer->MotionOpaqueTask(ThreadIdx);
-		}
-		else
-		{
-			SceneRenderer->MotionTranslucentTask(ThreadIdx);
-		}
-	}
-
-private:
-	UHDeferredShadingRenderer* SceneRenderer = nullptr;
-	bool bIsOpaque = true;
-};
-
 void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderMotionPass", false);
@@ -33,7 +7,7 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 	{
 		return;
 	}
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::MotionPass)], "MotionPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "MotionPass");
 
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing Motion Pass");
 	{
@@ -69,7 +43,6 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 
 		// -------------------- after motion camera pass is done, draw per-object motions, opaque first then the translucent -------------------- //
 		// opaque motion will only render the dynamic objects (motion is dirty), static objects are already calculated in camera motion
-		static UHMotionPassAsyncTask Tasks[GMaxWorkerThreads];
 		{
 			if (GraphicInterface->IsMeshShaderSupported())
 			{
@@ -83,7 +56,7 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 						, MeshletTable->GetDescriptorSet(CurrentFrameRT)
 						, PositionTable->GetDescriptorSet(CurrentFrameRT)
 						, UV0Table->GetDescriptorSet(CurrentFrameRT)
-						, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+						, MeshletIndexTable->GetDescriptorSet(CurrentFrameRT)
 						, NormalTable->GetDescriptorSet(CurrentFrameRT)
 						, TangentTable->GetDescriptorSet(CurrentFrameRT)
 					};
@@ -111,8 +84,8 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 					RenderBuilder.BindGraphicState(MotionMS->GetState());
 					RenderBuilder.BindDescriptorSet(MotionMS->GetPipelineLayout(), MotionMS->GetDescriptorSet(CurrentFrameRT));
 
-					// Dispatch meshlets
-					RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+					// dispatch meshlets, they will be culled in amplification shader
+					DispatchMeshlets(RenderBuilder, MotionMS, VisibleMeshlets, GetShadingOcclusionPhase());
 
 					GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 				}
@@ -122,32 +95,18 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 				// begin for secondary cmd
 				RenderBuilder.BeginRenderPass(MotionOpaquePassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
+				for (int32_t I = 0; I < NumParallelBundles; I++)
 				{
-					ThreadDrawCalls[I] = 0;
+					BundleDrawCalls[I] = 0;
 				}
-#endif
 
-				// init and wake all tasks
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
-				{
-					Tasks[I].Init(this, true);
-					WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-					WorkerThreads[I]->WakeThread();
-				}
-
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
-				{
-					WorkerThreads[I]->WaitTask();
-				}
+				// record all bundles with job system
+				RecordParallelBundles(&UHDeferredShadingRenderer::MotionOpaqueTask);
 
-#if WITH_EDITOR
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
+				for (int32_t I = 0; I < NumParallelBundles; I++)
 				{
-					RenderBuilder.DrawCalls += ThreadDrawCalls[I];
+					RenderBuilder.DrawCalls += BundleDrawCalls[I];
 				}
-#endif
 
 				// execute all recorded batches
 				RenderBuilder.ExecuteBundles(MotionOpaqueParallelSubmitter);
@@ -184,7 +143,7 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 						, MeshletTable->GetDescriptorSet(CurrentFrameRT)
 						, PositionTable->GetDescriptorSet(CurrentFrameRT)
 						, UV0Table->GetDescriptorSet(CurrentFrameRT)
-						, IndicesTable->GetDescriptorSet(CurrentFrameRT)
+						, MeshletIndexTable->GetDescriptorSet(CurrentFrameRT)
 						, NormalTable->GetDescriptorSet(CurrentFrameRT)
 						, TangentTable->GetDescriptorSet(CurrentFrameRT)
 					};
@@ -212,8 +171,8 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 					RenderBuilder.BindGraphicState(MotionMS->GetState());
 					RenderBuilder.BindDescriptorSet(MotionMS->GetPipelineLayout(), MotionMS->GetDescriptorSet(CurrentFrameRT));
 
-					// Dispatch meshlets
-					RenderBuilder.DispatchMesh(VisibleMeshlets, 1, 1);
+					// dispatch meshlets, they will be culled in amplification shader
+					DispatchMeshlets(RenderBuilder, MotionMS, VisibleMeshlets, GetShadingOcclusionPhase());
 
 					GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 				}
@@ -223,32 +182,18 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 
 				RenderBuilder.BeginRenderPass(MotionTranslucentPassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-#if WITH_EDITOR
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
-				{
-					ThreadDrawCalls[I] = 0;
-				}
-#endif
-
-				// wake all worker threads
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
+				for (int32_t I = 0; I < NumParallelBundles; I++)
 				{
-					Tasks[I].Init(this, false);
-					WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-					WorkerThreads[I]->WakeThread();
+					BundleDrawCalls[I] = 0;
 				}
 
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
-				{
-					WorkerThreads[I]->WaitTask();
-				}
+				// record all bundles with job system
+				RecordParallelBundles(&UHDeferredShadingRenderer::MotionTranslucentTask);
 
-#if WITH_EDITOR
-				for (int32_t I = 0; I < NumWorkerThreads; I++)
+				for (int32_t I = 0; I < NumParallelBundles; I++)
 				{
-					RenderBuilder.DrawCalls += ThreadDrawCalls[I];
+					RenderBuilder.DrawCalls += BundleDrawCalls[I];
 				}
-#endif
 
 				// execute all recorded batches
 				RenderBuilder.ExecuteBundles(MotionTranslucentParallelSubmitter);
@@ -271,20 +216,20 @@ void UHDeferredShadingRenderer::RenderMotionPass(UHRenderBuilder& RenderBuilder)
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
 
-void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
+void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t BundleIdx)
 {
-	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(MotionOpaquesToRender.size());
-	const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
-	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
-	const int32_t EndIdx = (ThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
+	// simply separate batch recording into N bundles
+	const int32_t MaxCount = static_cast<int32_t>(MotionOpaqueBatches.size());
+	const int32_t BatchCount = (MaxCount + NumParallelBundles) / NumParallelBundles;
+	const int32_t StartIdx = std::min(BatchCount * BundleIdx, MaxCount);
+	const int32_t EndIdx = (BundleIdx == NumParallelBundles - 1) ? MaxCount : std::min(StartIdx + BatchCount, MaxCount);
 
 	VkCommandBufferInheritanceInfo InheritanceInfo{};
 	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
 	InheritanceInfo.renderPass = MotionOpaquePassObj.RenderPass;
 	InheritanceInfo.framebuffer = MotionOpaquePassObj.FrameBuffer;
 
-	UHRenderBuilder RenderBuilder(GraphicInterface, MotionOpaqueParallelSubmitter.WorkerCommandBuffers[ThreadIdx * GMaxFrameInFlight + CurrentFrameRT]);
+	UHRenderBuilder RenderBuilder(GraphicInterface, MotionOpaqueParallelSubmitter.WorkerCommandBuffers[BundleIdx * GMaxFrameInFlight + CurrentFrameRT]);
 	if (StartIdx >= EndIdx)
 	{
 		RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
@@ -304,11 +249,10 @@ void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
 		RenderBuilder.BindDescriptorSet(MotionOpaqueShaders.begin()->second->GetPipelineLayout(), TextureTableSets, GTextureTableSpace);
 	}
 
-	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
-		UHMeshRendererComponent* Renderer = MotionOpaquesToRender[I];
-		const UHMaterial* Mat = Renderer->GetMaterial();
+		const UHInstanceBatch& Batch = MotionOpaqueBatches[I];
+		UHMeshRendererComponent* Renderer = MotionOpaquesToRender[Batch.FirstItem];
 
 		UHMesh* Mesh = Renderer->GetMesh();
 		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
@@ -317,54 +261,41 @@ void UHDeferredShadingRenderer::MotionOpaqueTask(int32_t ThreadIdx)
 		const UHMotionObjectPassShader* MotionShader = MotionOpaqueShaders[RendererIdx].get();
 
 		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Mesh->GetName() + " (Tris: " +
-			std::to_string(TriCount) + ")");
-
-		const bool bOcclusionTest = bEnableHWOcclusionRT && TriCount >= OcclusionThresholdRT && !Renderer->IsCameraInsideThisRenderer();
-		if (bOcclusionTest)
-		{
-			RenderBuilder.BeginPredication(RendererIdx, GOcclusionResult[PrevFrame]->GetBuffer());
-		}
+			std::to_string(TriCount) + ", Instances: " + std::to_string(Batch.InstanceCount) + ")");
 
 		// bind pipelines
 		RenderBuilder.BindGraphicState(MotionShader->GetState());
-		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(MotionShader->GetPipelineLayout(), MotionShader->GetDescriptorSet(CurrentFrameRT));
 
 		// draw call
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
-		if (bOcclusionTest)
-		{
-			RenderBuilder.EndPredication();
-		}
+		RenderBuilder.DrawIndexedInstanced(Mesh->GetIndicesCount(), Batch.InstanceCount, Batch.FirstInstance);
 
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 	}
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
-	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
+	BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
 }
 
-void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
+void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t BundleIdx)
 {
-	// simply separate buffer recording into N threads
+	// simply separate buffer recording into N bundles
 	const int32_t MaxCount = static_cast<int32_t>(TranslucentsToRender.size());
-	const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
+	const int32_t RendererCount = (MaxCount + NumParallelBundles) / NumParallelBundles;
 
 	// to collect batch reversely
-	const int32_t ReversedThreadIdx = NumWorkerThreads - ThreadIdx - 1;
-	const int32_t StartIdx = std::min(RendererCount * ReversedThreadIdx, MaxCount);
-	const int32_t EndIdx = (ReversedThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
+	const int32_t ReversedBundleIdx = NumParallelBundles - BundleIdx - 1;
+	const int32_t StartIdx = std::min(RendererCount * ReversedBundleIdx, MaxCount);
+	const int32_t EndIdx = (ReversedBundleIdx == NumParallelBundles - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
 
 	VkCommandBufferInheritanceInfo InheritanceInfo{};
 	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
 	InheritanceInfo.renderPass = MotionTranslucentPassObj.RenderPass;
 	InheritanceInfo.framebuffer = MotionTranslucentPassObj.FrameBuffer;
 
-	UHRenderBuilder RenderBuilder(GraphicInterface, MotionTranslucentParallelSubmitter.WorkerCommandBuffers[ThreadIdx * GMaxFrameInFlight + CurrentFrameRT]);
+	UHRenderBuilder RenderBuilder(GraphicInterface, MotionTranslucentParallelSubmitter.WorkerCommandBuffers[BundleIdx * GMaxFrameInFlight + CurrentFrameRT]);
 	if (StartIdx >= EndIdx)
 	{
 		RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
@@ -386,11 +317,11 @@ void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
 
 	// draw reversely since translucents are sort back-to-front
 	// I want front-to-back order in motion pass for translucents
-	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = EndIdx - 1; I >= StartIdx; I--)
 	{
-		UHMeshRendererComponent* Renderer = TranslucentsToRender[I];
-		const UHMaterial* Mat = Renderer->GetMaterial();
+		// translucents aren't batched, each batch is a single renderer in the same order
+		const UHInstanceBatch& Batch = MotionTranslucentBatches[I];
+		UHMeshRendererComponent* Renderer = TranslucentsToRender[Batch.FirstItem];
 
 		UHMesh* Mesh = Renderer->GetMesh();
 		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
@@ -399,33 +330,20 @@ void UHDeferredShadingRenderer::MotionTranslucentTask(int32_t ThreadIdx)
 		const UHMotionObjectPassShader* MotionShader = MotionTranslucentShaders[RendererIdx].get();
 
 		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Mesh->GetName() + " (Tris: " +
-			std::to_string(TriCount) + ")");
-
-		const bool bOcclusionTest = bEnableHWOcclusionRT && TriCount >= OcclusionThresholdRT && !Renderer->IsCameraInsideThisRenderer();
-		if (bOcclusionTest)
-		{
-			RenderBuilder.BeginPredication(RendererIdx, GOcclusionResult[PrevFrame]->GetBuffer());
-		}
+			std::to_string(TriCount) + ", Instances: " + std::to_string(Batch.InstanceCount) + ")");
 
 		// bind pipelines
 		RenderBuilder.BindGraphicState(MotionShader->GetState());
-		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(MotionShader->GetPipelineLayout(), MotionShader->GetDescriptorSet(CurrentFrameRT));
 
 		// draw call
-		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
-		if (bOcclusionTest)
-		{
-			RenderBuilder.EndPredication();
-		}
+		RenderBuilder.DrawIndexedInstanced(Mesh->GetIndicesCount(), Batch.InstanceCount, Batch.FirstInstance);
 
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 	}
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
-	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
+	BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
 }
\ No newline at end of file
@@ -1,149 +1,152 @@
 #include "DeferredShadingRenderer.h"
 
-class UHOcclusionPassAsyncTask : public UHAsyncTask
+void UHDeferredShadingRenderer::BuildHiZ(UHRenderBuilder& RenderBuilder)
 {
-public:
-	void Init(UHDeferredShadingRenderer* InRenderer)
+	UHGameTimerScope Scope("BuildHiZ", false);
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "BuildHiZ");
+	if (CurrentScene == nullptr || GHiZBuffer == nullptr)
 	{
-		SceneRenderer = InRenderer;
+		return;
 	}
 
-	virtual void DoTask(const int32_t ThreadIdx) override
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Building Hi-Z");
 	{
-		SceneRenderer->OcclusionPassTask(ThreadIdx);
-	}
+		// the depth layout is restored after building, as the passes after this expect it
+		const VkImageLayout DepthLayout = GSceneDepth->GetImageLayout();
+		RenderBuilder.PushResourceBarrier(UHImageBarrier(GSceneDepth, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+		RenderBuilder.FlushResourceBarrier();
+
+		// the first mip reads the scene depth, and the others read the previous mip
+		// mips are kept in general layout during building, so the barrier between mips waits the previous dispatch
+		uint32_t InputWidth = RenderResolution.width;
+		uint32_t InputHeight = RenderResolution.height;
+		for (uint32_t Mdx = 0; Mdx < GHiZBuffer->GetMipMapCount(); Mdx++)
+		{
+			UHHiZConstants Constants;
+			Constants.InputSize[0] = InputWidth;
+			Constants.InputSize[1] = InputHeight;
+			Constants.OutputSize[0] = (std::max)(InputWidth >> 1, 1u);
+			Constants.OutputSize[1] = (std::max)(InputHeight >> 1, 1u);
+
+			const UHDownsampleDepthShader* Shader = (Mdx == 0) ? HiZFromDepthShader.get() : HiZDownsampleShader.get();
+			RenderBuilder.BindComputeState(Shader->GetComputeState());
+			if (Mdx > 0)
+			{
+				RenderBuilder.ResourceBarrier(GHiZBuffer, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, Mdx - 1);
+			}
+			RenderBuilder.ResourceBarrier(GHiZBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, Mdx);
+
+			// push constant and descriptor in fly
+			vkCmdPushConstants(RenderBuilder.GetCmdList(), Shader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(UHHiZConstants), &Constants);
+			if (Mdx == 0)
+			{
+				HiZFromDepthShader->BindTextures(RenderBuilder, GSceneDepth, GHiZBuffer, Mdx);
+			}
+			else
+			{
+				HiZDownsampleShader->BindTextures(RenderBuilder, GHiZBuffer, GHiZBuffer, Mdx);
+			}
+
+			RenderBuilder.Dispatch(MathHelpers::RoundUpDivide(Constants.OutputSize[0], GThreadGroup2D_X)
+				, MathHelpers::RoundUpDivide(Constants.OutputSize[1], GThreadGroup2D_Y), 1);
+
+			InputWidth = Constants.OutputSize[0];
+			InputHeight = Constants.OutputSize[1];
+		}
 
-private:
-	UHDeferredShadingRenderer* SceneRenderer = nullptr;
-};
+		for (uint32_t Mdx = 0; Mdx < GHiZBuffer->GetMipMapCount(); Mdx++)
+		{
+			RenderBuilder.PushResourceBarrier(UHImageBarrier(GHiZBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, Mdx));
+		}
+		RenderBuilder.PushResourceBarrier(UHImageBarrier(GSceneDepth, DepthLayout));
+		RenderBuilder.FlushResourceBarrier();
+	}
+	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
+}
 
-void UHDeferredShadingRenderer::ResolveOcclusionResult(UHRenderBuilder& RenderBuilder)
+void UHDeferredShadingRenderer::DispatchOcclusionTest(UHRenderBuilder& RenderBuilder)
 {
-	UHGameTimerScope Scope("ResolveOcclusionResult", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::OcclusionResolve)], "ResolveOcclusionResult");
-
-	// Resolve the previous frame result to the buffer. 
-	// Allow partial update so it won't stuck for the individuals that don't have Begin/EndQuery() called.
-	// If this still failed to get the proper results, consider copying the result individually with parallel tasks and setting
-	// VK_QUERY_RESULT_WAIT_BIT flag for each query.
-
-	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Resolve Occlusion Result");
-
-	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
-	vkCmdCopyQueryPoolResults(RenderBuilder.GetCmdList()
-		, OcclusionQuery[PrevFrame]->GetQueryPool()
-		, 0
-		, OcclusionQuery[PrevFrame]->GetQueryCount()
-		, GOcclusionResult[PrevFrame]->GetBuffer()
-		, 0
-		, sizeof(uint32_t)
-		, VK_QUERY_RESULT_PARTIAL_BIT);
+	UHGameTimerScope Scope("DispatchOcclusionTest", false);
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "OcclusionTest");
+	if (CurrentScene == nullptr || GOcclusionResult[CurrentFrameRT] == nullptr)
+	{
+		return;
+	}
 
+	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatch Occlusion Test");
+	{
+		RenderBuilder.BindComputeState(OcclusionTestShader->GetComputeState());
+		RenderBuilder.BindDescriptorSetCompute(OcclusionTestShader->GetPipelineLayout(), OcclusionTestShader->GetDescriptorSet(CurrentFrameRT));
+
+		UHOcclusionTestConstants Constants{};
+		Constants.NumRenderers = static_cast<uint32_t>(CurrentScene->GetAllRendererCount());
+		Constants.HiZMipCount = GHiZBuffer->GetMipMapCount();
+		Constants.HiZSize[0] = GHiZBuffer->GetExtent().width;
+		Constants.HiZSize[1] = GHiZBuffer->GetExtent().height;
+		vkCmdPushConstants(RenderBuilder.GetCmdList(), OcclusionTestShader->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Constants), &Constants);
+
+		// one thread per renderer
+		RenderBuilder.Dispatch(MathHelpers::RoundUpDivide(Constants.NumRenderers, GThreadGroup1D), 1, 1);
+
+		// the result is read by amplification shaders of this frame and the next frame
+		const UHRenderBuffer<uint32_t>* ResultBuffer = GOcclusionResult[CurrentFrameRT].get();
+		RenderBuilder.ResourceBarrier(ResultBuffer->GetBuffer(), ResultBuffer->GetBufferSize()
+			, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT);
+	}
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
 
 void UHDeferredShadingRenderer::RenderOcclusionPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderOcclusionPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::OcclusionPass)], "OcclusionPass");
-	if (CurrentScene == nullptr || !bEnableHWOcclusionRT)
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "OcclusionPass");
+	if (CurrentScene == nullptr || !bEnableDepthPrepassRT || DepthMeshShaders.size() == 0)
 	{
 		return;
 	}
 
+	// the second phase of occlusion culling, draw the depth of renderers that were occluded last frame but visible now
+	// depth mesh shaders are compatible with this pass, as it only differs from the depth pass by loading depth
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing Occlusion Pass");
 	{
-		// reset occlusion query for the current frame
-		RenderBuilder.ResetGPUQuery(OcclusionQuery[CurrentFrameRT]);
-		RenderBuilder.BeginRenderPass(OcclusionPassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		RenderBuilder.SetViewport(RenderResolution);
+		RenderBuilder.SetScissor(RenderResolution);
+		RenderBuilder.BeginRenderPass(OcclusionPassObj, RenderResolution);
 
-#if WITH_EDITOR
-		for (int32_t I = 0; I < NumWorkerThreads; I++)
+		// bindless table, they should only be bound once
+		if (SortedMeshShaderGroupIndex.size() > 0)
 		{
-			ThreadOccludedCalls[I] = 0;
+			std::vector<VkDescriptorSet> BindlessTableSets = { TextureTable->GetDescriptorSet(CurrentFrameRT)
+				, SamplerTable->GetDescriptorSet(CurrentFrameRT)
+				, MeshletTable->GetDescriptorSet(CurrentFrameRT)
+				, PositionTable->GetDescriptorSet(CurrentFrameRT)
+				, UV0Table->GetDescriptorSet(CurrentFrameRT)
+				, MeshletIndexTable->GetDescriptorSet(CurrentFrameRT)
+			};
+			RenderBuilder.BindDescriptorSet(DepthMeshShaders[SortedMeshShaderGroupIndex[0]]->GetPipelineLayout(), BindlessTableSets, GTextureTableSpace);
 		}
-#endif
 
-		// init and wake all tasks
-		static UHOcclusionPassAsyncTask Tasks[GMaxWorkerThreads];
-		for (int32_t I = 0; I < NumWorkerThreads; I++)
+		for (size_t Idx = 0; Idx < SortedMeshShaderGroupIndex.size(); Idx++)
 		{
-			Tasks[I].Init(this);
-			WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-			WorkerThreads[I]->WakeThread();
-		}
+			const int32_t GroupIndex = SortedMeshShaderGroupIndex[Idx];
+			const uint32_t VisibleMeshlets = static_cast<uint32_t>(VisibleMeshShaderData[GroupIndex].size());
+			if (VisibleMeshlets == 0)
+			{
+				continue;
+			}
 
-		for (int32_t I = 0; I < NumWorkerThreads; I++)
-		{
-			WorkerThreads[I]->WaitTask();
-		}
+			const UHDepthMeshShader* DepthMS = DepthMeshShaders[GroupIndex].get();
 
-#if WITH_EDITOR
-		for (int32_t I = 0; I < NumWorkerThreads; I++)
-		{
-			RenderBuilder.OccludedCalls += ThreadOccludedCalls[I];
+			GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Dispatching occlusion pass " + DepthMS->GetMaterialCache()->GetName());
+
+			RenderBuilder.BindGraphicState(DepthMS->GetState());
+			RenderBuilder.BindDescriptorSet(DepthMS->GetPipelineLayout(), DepthMS->GetDescriptorSet(CurrentFrameRT));
+			DispatchMeshlets(RenderBuilder, DepthMS, VisibleMeshlets, UHOcclusionPhase::Disoccluded);
+
+			GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 		}
-#endif
 
-		// execute all recorded batches
-		RenderBuilder.ExecuteBundles(OcclusionParallelSubmitter);
 		RenderBuilder.EndRenderPass();
 	}
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
-}
-
-void UHDeferredShadingRenderer::OcclusionPassTask(int32_t ThreadIdx)
-{
-	// simply separate buffer recording into N threads
-	const int32_t MaxCount = static_cast<int32_t>(OcclusionRenderers.size());
-	const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
-	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
-	const int32_t EndIdx = (ThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
-
-	VkCommandBufferInheritanceInfo InheritanceInfo{};
-	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
-	InheritanceInfo.renderPass = OcclusionPassObj.RenderPass;
-	InheritanceInfo.framebuffer = OcclusionPassObj.FrameBuffer;
-	InheritanceInfo.occlusionQueryEnable = bEnableHWOcclusionRT;
-
-	UHRenderBuilder RenderBuilder(GraphicInterface, OcclusionParallelSubmitter.WorkerCommandBuffers[ThreadIdx * GMaxFrameInFlight + CurrentFrameRT]);
-	if (StartIdx >= EndIdx)
-	{
-		RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
-		RenderBuilder.EndCommandBuffer();
-		return;
-	}
-
-	RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
-	RenderBuilder.SetViewport(RenderResolution);
-	RenderBuilder.SetScissor(RenderResolution);
-
-	for (int32_t I = StartIdx; I < EndIdx; I++)
-	{
-		const UHMeshRendererComponent* Renderer = OcclusionRenderers[I];
-		const int32_t RendererIdx = Renderer->GetBufferDataIndex();
-		const UHOcclusionPassShader* OcclusionShader = OcclusionPassShaders[RendererIdx].get();
-
-		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing Occlusion Box");
-
-		// bind pipelines
-		RenderBuilder.BeginOcclusionQuery(OcclusionQuery[CurrentFrameRT], RendererIdx);
-
-		RenderBuilder.BindGraphicState(UHOcclusionPassShader::GetOcclusionState());
-		RenderBuilder.BindVertexBuffer(CubeMesh->GetPositionBuffer()->GetBuffer());
-		RenderBuilder.BindIndexBuffer(CubeMesh);
-		RenderBuilder.BindDescriptorSet(OcclusionShader->GetPipelineLayout(), OcclusionShader->GetDescriptorSet(CurrentFrameRT));
-
-		// draw call
-		RenderBuilder.DrawIndexed(CubeMesh->GetIndicesCount());
-		RenderBuilder.EndOcclusionQuery(OcclusionQuery[CurrentFrameRT], RendererIdx);
-
-		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
-	}
-
-	RenderBuilder.EndCommandBuffer();
-
-#if WITH_EDITOR
-	ThreadOccludedCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-#endif
 }
\ No newline at end of file
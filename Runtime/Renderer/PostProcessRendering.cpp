@@ -57,6 +57,7 @@ void UHDeferredShadingRenderer::Dispatch2DEffect(UHShaderClass* InShader, UHRend
 void UHDeferredShadingRenderer::RenderPostProcessing(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderPostProcessing", false);
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "PostProcessing");
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Postprocessing Passes");
 	// post process RT starts from undefined, transition it first
 	RenderBuilder.ResourceBarrier(GPostProcessRT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
@@ -68,14 +69,14 @@ void UHDeferredShadingRenderer::RenderPostProcessing(UHRenderBuilder& RenderBuil
 
 	// -------------------------- Tone Mapping --------------------------//
 	{
-		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::ToneMappingPass)], "ToneMappingPass");
+		UHGPUTimeQueryScope SubTimeScope(RenderBuilder, "ToneMappingPass");
 		ToneMapShader->BindInputImage(PostProcessResults[1 - CurrentPostProcessRTIndex], CurrentFrameRT);
 		RenderEffect(ToneMapShader.get(), RenderBuilder, CurrentPostProcessRTIndex, "Tone mapping");
 	}
 	
 	// -------------------------- Temporal AA --------------------------//
 	{
-		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::TemporalAAPass)], "TemporalAAPass");
+		UHGPUTimeQueryScope SubTimeScope(RenderBuilder, "TemporalAAPass");
 		if (bTemporalAART)
 		{
 			RenderBuilder.ResourceBarrier(GPreviousSceneResult, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
@@ -93,7 +94,7 @@ void UHDeferredShadingRenderer::RenderPostProcessing(UHRenderBuilder& RenderBuil
 
 	// -------------------------- History Result Passes --------------------------//
 	{
-		UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::HistoryCopyingPass)], "HistoryCopyingPass");
+		UHGPUTimeQueryScope SubTimeScope(RenderBuilder, "HistoryCopyingPass");
 		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "History Result Copy");
 
 		// blit to scene history
@@ -127,7 +128,7 @@ void UHDeferredShadingRenderer::RenderPostProcessing(UHRenderBuilder& RenderBuil
 uint32_t UHDeferredShadingRenderer::RenderSceneToSwapChain(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderSceneToSwapChain", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::PresentToSwapChain)], "PresentToSwapChain");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "PresentToSwapChain");
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Scene to SwapChain Pass");
 
 	uint32_t ImageIndex;
@@ -78,7 +78,7 @@ void UHDeferredShadingRenderer::ResizeRayTracingBuffers(bool bInitOnly)
 void UHDeferredShadingRenderer::BuildTopLevelAS(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("BuildTopLevelAS", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::UpdateTopLevelAS)], "UpdateTopLevelAS");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "UpdateTopLevelAS");
 	if (!bIsRaytracingEnableRT || RTInstanceCount == 0)
 	{
 		return;
@@ -89,7 +89,8 @@ void UHDeferredShadingRenderer::BuildTopLevelAS(UHRenderBuilder& RenderBuilder)
 	// https://microsoft.github.io/DirectX-Specs/d3d/Raytracing.html#general-tips-for-building-acceleration-structures
 	// From Microsoft tips: Rebuild top-level acceleration structure every frame
 	// but I still choose to update AS instead of rebuilding, FPS is higher with updating
-	GTopLevelAS[CurrentFrameRT]->UpdateTopAS(RenderBuilder.GetCmdList(), CurrentFrameRT, RTCullingDistanceRT);
+	// instances are uploaded by game thread already, it's rebuilt only when instances are added/removed or refitting degrades it too much
+	GTopLevelAS[CurrentFrameRT]->UpdateTopAS(RenderBuilder.GetCmdList());
 
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
@@ -97,7 +98,7 @@ void UHDeferredShadingRenderer::BuildTopLevelAS(UHRenderBuilder& RenderBuilder)
 void UHDeferredShadingRenderer::CollectLightPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("CollectLightPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::CollectLightPass)], "CollectLightPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "CollectLightPass");
 	if (!bIsRaytracingEnableRT || RTInstanceCount == 0)
 	{
 		return;
@@ -146,7 +147,7 @@ void UHDeferredShadingRenderer::CollectLightPass(UHRenderBuilder& RenderBuilder)
 void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("DispatchRayShadowPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingShadow)], "RayTracingShadow");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "RayTracingShadow");
 	if (!bIsRaytracingEnableRT || RTInstanceCount == 0)
 	{
 		if (GRTShadowResult != nullptr)
@@ -191,7 +192,7 @@ void UHDeferredShadingRenderer::DispatchRayShadowPass(UHRenderBuilder& RenderBui
 void UHDeferredShadingRenderer::DispatchSmoothReflectVectorPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("SmoothReflectVectorPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::SmoothReflectVectorPass)], "SmoothReflectVectorPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "SmoothReflectVectorPass");
 
 	if (!bIsRaytracingEnableRT || !bDenoiseReflectionRT)
 	{
@@ -223,7 +224,7 @@ void UHDeferredShadingRenderer::DispatchSmoothReflectVectorPass(UHRenderBuilder&
 void UHDeferredShadingRenderer::DispatchRayReflectionPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("DispatchRayReflectionPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::RayTracingReflection)], "RayTracingReflection");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "RayTracingReflection");
 
 	if (!bIsRaytracingEnableRT || RTInstanceCount == 0)
 	{
@@ -14,10 +14,9 @@ UHRenderBuilder::UHRenderBuilder(UHGraphic* InGraphic, VkCommandBuffer InCommand
 	, PrevComputeState(nullptr)
 	, PrevVertexBuffer(nullptr)
 	, PrevIndexBufferSource(nullptr)
-#if WITH_EDITOR
+	, GPUTimelineRecorder(nullptr)
 	, DrawCalls(0)
 	, OccludedCalls(0)
-#endif
 	, bNeedSetViewport(false)
 	, bNeedSetScissorRect(false)
 {
@@ -52,6 +51,16 @@ VkCommandBuffer UHRenderBuilder::GetCmdList()
 	return CmdList;
 }
 
+void UHRenderBuilder::SetGPUTimelineRecorder(UHGPUTimelineRecorder* InRecorder)
+{
+	GPUTimelineRecorder = InRecorder;
+}
+
+UHGPUTimelineRecorder* UHRenderBuilder::GetGPUTimelineRecorder() const
+{
+	return GPUTimelineRecorder;
+}
+
 void UHRenderBuilder::WaitFence(VkFence InFence)
 {
 	vkWaitForFences(LogicalDevice, 1, &InFence, VK_TRUE, UINT64_MAX);
@@ -349,13 +358,19 @@ void UHRenderBuilder::BindIndexBuffer(UHMesh* InMesh)
 	PrevIndexBufferSource = InMesh;
 }
 
+void UHRenderBuilder::BindIndexBuffer(const UHRenderBuffer<uint32_t>* InBuffer)
+{
+	vkCmdBindIndexBuffer(CmdList, InBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+	// the mesh binding is replaced, so the next mesh must be bound again
+	PrevIndexBufferSource = nullptr;
+}
+
 void UHRenderBuilder::DrawVertex(uint32_t VertexCount)
 {
 	vkCmdDraw(CmdList, VertexCount, 1, 0, 0);
 
-#if WITH_EDITOR
 	DrawCalls++;
-#endif
 }
 
 // draw indexed
@@ -363,7 +378,6 @@ void UHRenderBuilder::DrawIndexed(uint32_t IndicesCount, bool bOcclusionTest)
 {
 	vkCmdDrawIndexed(CmdList, IndicesCount, 1, 0, 0, 0);
 
-#if WITH_EDITOR
 	if (bOcclusionTest)
 	{
 		OccludedCalls++;
@@ -372,7 +386,22 @@ void UHRenderBuilder::DrawIndexed(uint32_t IndicesCount, bool bOcclusionTest)
 	{
 		DrawCalls++;
 	}
-#endif
+}
+
+void UHRenderBuilder::DrawIndexedInstanced(uint32_t IndicesCount, uint32_t InstanceCount, uint32_t FirstInstance)
+{
+	vkCmdDrawIndexed(CmdList, IndicesCount, InstanceCount, 0, 0, FirstInstance);
+
+	DrawCalls++;
+}
+
+void UHRenderBuilder::DrawIndexedIndirectCount(VkBuffer InBuffer, uint32_t InFirstCommand, VkBuffer InCountBuffer, uint32_t InCountIndex, uint32_t InMaxDrawCount)
+{
+	// the draw count can be zero, one call is counted as the commands are unknown to CPU
+	vkCmdDrawIndexedIndirectCount(CmdList, InBuffer, InFirstCommand * sizeof(VkDrawIndexedIndirectCommand)
+		, InCountBuffer, InCountIndex * sizeof(uint32_t), InMaxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+
+	DrawCalls++;
 }
 
 void UHRenderBuilder::BindDescriptorSet(VkPipelineLayout InLayout, VkDescriptorSet InSet)
@@ -592,10 +621,8 @@ void UHRenderBuilder::Blit(UHTexture* SrcImage, UHTexture* DstImage, VkExtent2D
 	vkCmdBlitImage(CmdList, SrcImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, DstImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
 		, 1, &BlitInfo, InFilter);
 
-#if WITH_EDITOR
 	// vkCmdBlitImage should be a kind of draw call, add to profile 
 	DrawCalls++;
-#endif
 }
 
 // blit with custom extent
@@ -647,10 +674,8 @@ void UHRenderBuilder::Blit(UHTexture* SrcImage, UHTexture* DstImage, VkExtent2D
 	vkCmdBlitImage(CmdList, SrcImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, DstImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
 		, 1, &BlitInfo, InFilter);
 
-#if WITH_EDITOR
 	// vkCmdBlitImage should be a kind of draw call, add to profile 
 	DrawCalls++;
-#endif
 }
 
 void UHRenderBuilder::CopyTexture(UHTexture* SrcImage, UHTexture* DstImage, uint32_t MipLevel, uint32_t DstArray, uint32_t SrcArray)
@@ -700,9 +725,7 @@ void UHRenderBuilder::DrawFullScreenQuad()
 	// simply draw 6 vertices, post process shader will setup with SV_VertexID
 	vkCmdDraw(CmdList, 6, 1, 0, 0);
 
-#if WITH_EDITOR
 	DrawCalls++;
-#endif
 }
 
 VkDeviceAddress GetDeviceAddress(VkDevice InDevice, VkBuffer InBuffer)
@@ -782,9 +805,7 @@ void UHRenderBuilder::Dispatch(uint32_t Gx, uint32_t Gy, uint32_t Gz)
 void UHRenderBuilder::DispatchMesh(uint32_t Gx, uint32_t Gy, uint32_t Gz)
 {
 	GVkCmdDrawMeshTasksEXT(CmdList, Gx, Gy, Gz);
-#if WITH_EDITOR
 	DrawCalls++;
-#endif
 }
 
 // occlusion query functions
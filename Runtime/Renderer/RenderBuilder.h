@@ -27,6 +27,10 @@ public:
 
 	VkCommandBuffer GetCmdList();
 
+	// GPU timeline scopes of this builder are recorded by the recorder, nullptr disables them
+	void SetGPUTimelineRecorder(UHGPUTimelineRecorder* InRecorder);
+	UHGPUTimelineRecorder* GetGPUTimelineRecorder() const;
+
 	// wait a single fence
 	void WaitFence(VkFence InFence);
 
@@ -84,8 +88,9 @@ public:
 	// bind vertex buffer
 	void BindVertexBuffer(VkBuffer InBuffer);
 
-	// bind index buffer
+	// bind index buffer, the buffer version is for 32-bit indices shared by meshes
 	void BindIndexBuffer(UHMesh* InMesh);
+	void BindIndexBuffer(const UHRenderBuffer<uint32_t>* InBuffer);
 
 	// draw
 	void DrawVertex(uint32_t VertexCount);
@@ -93,6 +98,12 @@ public:
 	// draw index
 	void DrawIndexed(uint32_t IndicesCount, bool bOcclusionTest = false);
 
+	// draw index with instances, FirstInstance is added to SV_InstanceID in shader
+	void DrawIndexedInstanced(uint32_t IndicesCount, uint32_t InstanceCount, uint32_t FirstInstance);
+
+	// draw commands from InFirstCommand, the draw count is read from InCountBuffer and clamped by InMaxDrawCount
+	void DrawIndexedIndirectCount(VkBuffer InBuffer, uint32_t InFirstCommand, VkBuffer InCountBuffer, uint32_t InCountIndex, uint32_t InMaxDrawCount);
+
 	// bind descriptors
 	void BindDescriptorSet(VkPipelineLayout InLayout, VkDescriptorSet InSet);
 	void BindDescriptorSet(VkPipelineLayout InLayout, const std::vector<VkDescriptorSet>& InSets, uint32_t FirstSet = 0);
@@ -151,10 +162,9 @@ public:
 
 	void ResetGPUQuery(UHGPUQuery* InQuery);
 
-#if WITH_EDITOR
+	// draw counters, reported to the CPU profiler in all builds
 	int32_t DrawCalls;
 	int32_t OccludedCalls;
-#endif
 
 private:
 	UHGraphic* Gfx;
@@ -176,4 +186,5 @@ private:
 	UHComputeState* PrevComputeState;
 	VkBuffer PrevVertexBuffer;
 	UHMesh* PrevIndexBufferSource;
+	UHGPUTimelineRecorder* GPUTimelineRecorder;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "DeferredShadingRenderer.h"
 #include "DescriptorHelper.h"
 #include <unordered_set>
+#include <chrono>
 #include "../Engine/Engine.h"
 
 // all init/create/release implementations of DeferredShadingRenderer are put here
@@ -32,6 +33,8 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 	, bIsTemporalReset(true)
 	, RTInstanceCount(0)
 	, NumWorkerThreads(0)
+	, NumParallelBundles(0)
+	, JobSystem(nullptr)
 	, RenderThread(nullptr)
 	, bVsyncRT(false)
 	, bIsSwapChainResetGT(false)
@@ -39,14 +42,12 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 	, bIsRenderingEnabledRT(true)
 	, bIsSkyLightEnabledRT(true)
 	, bNeedGenerateSH9RT(true)
-	, LightCullingTileSize(16)
-	, MaxPointLightPerTile(32)
-	, MaxSpotLightPerTile(32)
+	, LightClusterIndexCapacity(0)
+	, DrawCalls(0)
+	, OccludedCalls(0)
 #if WITH_EDITOR
 	, DebugViewIndex(0)
 	, RenderThreadTime(0)
-	, DrawCalls(0)
-	, OccludedCalls(0)
 	, EditorWidthDelta(0)
 	, EditorHeightDelta(0)
 	, bDrawDebugViewRT(true)
@@ -54,12 +55,19 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 	, bHasRefractionMaterialGT(false)
 	, bHasRefractionMaterialRT(false)
 	, bHDREnabledRT(false)
-	, RTCullingDistanceRT(0.0f)
 	, RTReflectionQualityRT(0)
 	, bIsRaytracingEnableRT(false)
-	, bEnableHWOcclusionRT(false)
+	, TopLevelASRefreshFrames(0)
+	, bEnableOcclusionGT(false)
+	, bEnableOcclusionRT(false)
 	, bEnableDepthPrepassRT(false)
-	, OcclusionThresholdRT(0)
+	, bEnableGPUDrivenGT(false)
+	, bEnableGPUDrivenRT(false)
+	, bEnableGPULightClusteringGT(true)
+	, bEnableGPULightClusteringRT(true)
+	, CullingDistanceRT(0.0f)
+	, bIndirectDrawsDirty(true)
+	, IndirectCullDataUploads(0)
 	, MeshInstanceCount(0)
 {
 	for (int32_t Idx = 0; Idx < NumOfPostProcessRT; Idx++)
@@ -67,16 +75,6 @@ UHDeferredShadingRenderer::UHDeferredShadingRenderer(UHEngine* InEngine)
 		PostProcessResults[Idx] = nullptr;
 	}
 
-	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHRenderPassTypes::UHRenderPassMax); Idx++)
-	{
-		GPUTimeQueries[Idx] = nullptr;
-	}
-
-	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
-	{
-		OcclusionQuery[Idx] = nullptr;
-	}
-
 #if WITH_EDITOR
 	SceneRendererEditorOnly = this;
 #endif
@@ -89,6 +87,7 @@ bool UHDeferredShadingRenderer::Initialize(UHScene* InScene)
 
 	// config setup
 	NumWorkerThreads = ConfigInterface->RenderingSetting().ParallelThreads;
+	NumParallelBundles = std::max(NumWorkerThreads, 1) * BundlesPerWorker;
 
 	const bool bIsRendererSuccess = InitQueueSubmitters();
 	if (bIsRendererSuccess)
@@ -100,22 +99,97 @@ bool UHDeferredShadingRenderer::Initialize(UHScene* InScene)
 
 		// create thread objects
 		CreateThreadObjects();
+		ReserveRenderLists();
+	}
 
-		// reserve enough space for renderers, save the allocation time
-		OpaquesToRender.reserve(CurrentScene->GetOpaqueRenderers().size());
-		MotionOpaquesToRender.reserve(CurrentScene->GetOpaqueRenderers().size());
-		TranslucentsToRender.reserve(CurrentScene->GetTranslucentRenderers().size());
-		OcclusionRenderers.reserve(CurrentScene->GetAllRendererCount());
+	return bIsRendererSuccess;
+}
 
-		for (int32_t Idx = 0; Idx < MaxCountingElement; Idx++)
+void UHDeferredShadingRenderer::ReserveRenderLists()
+{
+	// reserve enough space for renderers, save the allocation time
+	OpaquesToRender.reserve(CurrentScene->GetOpaqueRenderers().size());
+	MotionOpaquesToRender.reserve(CurrentScene->GetOpaqueRenderers().size());
+	TranslucentsToRender.reserve(CurrentScene->GetTranslucentRenderers().size());
+
+	for (int32_t Idx = 0; Idx < MaxCountingElement; Idx++)
+	{
+		CountingRenderers[Idx].reserve(1024);
+	}
+}
+
+#if WITH_EDITOR
+bool UHDeferredShadingRenderer::InitializeHeadless(UHScene* InScene)
+{
+	if (!GraphicInterface->IsNullBackend())
+	{
+		UHE_LOG(L"Headless renderer needs the null graphics backend!\n");
+		return false;
+	}
+
+	CurrentScene = InScene;
+	NumWorkerThreads = ConfigInterface->RenderingSetting().ParallelThreads;
+	NumParallelBundles = std::max(NumWorkerThreads, 1) * BundlesPerWorker;
+	RenderResolution.width = ConfigInterface->RenderingSetting().RenderWidth;
+	RenderResolution.height = ConfigInterface->RenderingSetting().RenderHeight;
+
+	// mesh buffers are in host memory, and there are no mesh tables or acceleration structures
+	std::unordered_set<uint32_t> MeshTable;
+	MeshInstanceCount = 0;
+	MeshInUse.clear();
+
+	for (const UHMeshRendererComponent* Renderer : CurrentScene->GetAllRenderers())
+	{
+		UHMesh* Mesh = Renderer->GetMesh();
+		Mesh->CreateGPUBuffers(GraphicInterface);
+
+		if (MeshTable.find(Mesh->GetId()) == MeshTable.end())
 		{
-			CountingRenderers[Idx].reserve(1024);
+			MeshTable.insert(Mesh->GetId());
+			Mesh->SetBufferDataIndex(MeshInstanceCount++);
+			MeshInUse.push_back(Mesh);
 		}
 	}
 
-	return bIsRendererSuccess;
+	CreateDataBuffers();
+	if (IsGPUDrivenSupported())
+	{
+		MeshGeometryPool.Build(GraphicInterface, MeshInUse);
+	}
+
+	if (GraphicInterface->IsMeshShaderSupported())
+	{
+		ResizeMeshShaderData();
+		for (UHMaterial* Mat : CurrentScene->GetMaterials())
+		{
+			RecreateMeshShaderData(Mat);
+		}
+	}
+
+	// only the job system is needed, stages are called by the caller on its thread
+	JobSystem = MakeUnique<UHJobSystem>();
+	JobSystem->Initialize(NumWorkerThreads);
+	ReserveRenderLists();
+
+	return true;
 }
 
+void UHDeferredShadingRenderer::ReleaseHeadless()
+{
+	if (JobSystem != nullptr)
+	{
+		JobSystem->Release();
+		JobSystem.reset();
+	}
+
+	ReleaseDataBuffers();
+	ReleaseOcclusionResult();
+	IndirectDrawItems.clear();
+	MeshInUse.clear();
+	CurrentScene = nullptr;
+}
+#endif
+
 void UHDeferredShadingRenderer::InitRenderingResources()
 {
 	PrepareMeshes();
@@ -133,6 +207,13 @@ void UHDeferredShadingRenderer::InitRenderingResources()
 
 	// update descriptor binding
 	UpdateDescriptors();
+
+	// start streaming after the texture table is built, textures are uploaded with their mip tail at this point
+	if (GEnableTextureStreaming)
+	{
+		const uint64_t BudgetBytes = static_cast<uint64_t>(ConfigInterface->EngineSetting().TextureStreamingBudgetMB * 1048576.0);
+		TextureStreamer = MakeUnique<UHTextureStreamer>(GraphicInterface, AssetManagerInterface, BudgetBytes);
+	}
 }
 
 void UHDeferredShadingRenderer::Release()
@@ -145,11 +226,14 @@ void UHDeferredShadingRenderer::Release()
 	// end threads
 	RenderThread->WaitTask();
 	RenderThread->EndThread();
-	for (auto& WorkerThread : WorkerThreads)
+	JobSystem->Release();
+	JobSystem.reset();
+
+	if (TextureStreamer != nullptr)
 	{
-		WorkerThread->EndThread();
+		TextureStreamer->Release();
+		TextureStreamer.reset();
 	}
-	WorkerThreads.clear();
 
 	RelaseRenderingBuffers();
 	ReleaseDataBuffers();
@@ -157,6 +241,7 @@ void UHDeferredShadingRenderer::Release()
 	ReleaseShaders();
 
 	SceneRenderQueue.Release();
+	GraphicsTimelineRecorder.Release();
 	TranslucentParallelSubmitter.Release();
 
 	if (GIsEditor || (ConfigInterface->RenderingSetting().bEnableDepthPrePass && !GraphicInterface->IsMeshShaderSupported()))
@@ -171,10 +256,9 @@ void UHDeferredShadingRenderer::Release()
 		MotionTranslucentParallelSubmitter.Release();
 	}
 
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
+	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableOcclusionCulling)
 	{
-		ReleaseOcclusionQuery();
-		OcclusionParallelSubmitter.Release();
+		ReleaseOcclusionResult();
 	}
 
 	if (ConfigInterface->RenderingSetting().bEnableAsyncCompute)
@@ -182,7 +266,6 @@ void UHDeferredShadingRenderer::Release()
 		ReleaseAsyncComputeQueue();
 	}
 
-	UHOcclusionPassShader::ResetOcclusionState();
 	UHShaderClass::ClearGlobalLayoutCache(GraphicInterface);
 }
 
@@ -247,11 +330,23 @@ void UHDeferredShadingRenderer::PrepareMeshes()
 	// create mesh tables
 	RecreateMeshTables();
 
+	// pack meshes for GPU-driven draws, it's rebuilt as a whole since mesh data indices are reassigned above
+	if (IsGPUDrivenSupported())
+	{
+		MeshGeometryPool.Build(GraphicInterface, MeshInUse);
+	}
+
 	// release CPU copy of meshes for shipping
+	// software occlusion keeps its own copy of occluders, so copy them before releasing
 	if (GIsShipping)
 	{
+		const bool bSoftwareOcclusion = !GraphicInterface->IsMeshShaderSupported() && ConfigInterface->RenderingSetting().bEnableOcclusionCulling;
 		for (UHMesh* Mesh : AssetManagerInterface->GetUHMeshes())
 		{
+			if (bSoftwareOcclusion)
+			{
+				GetOccluderMesh(Mesh);
+			}
 			Mesh->ReleaseCPUMeshData();
 		}
 	}
@@ -391,6 +486,11 @@ void UHDeferredShadingRenderer::PrepareSamplers()
 
 void UHDeferredShadingRenderer::PrepareRenderingShaders()
 {
+	UHGameTimerScope Scope("PrepareRenderingShaders", true);
+
+	// graphic states are collected during shader creation and their pipelines are created in parallel at the end
+	GraphicInterface->BeginPipelineBatch();
+
 	// bindless table
 	const std::vector<VkDescriptorSetLayout> BindlessLayouts = { TextureTable->GetDescriptorSetLayout(), SamplerTable->GetDescriptorSetLayout()};
 	const std::vector<UHMeshRendererComponent*> AllRenderers = CurrentScene->GetAllRenderers();
@@ -417,36 +517,18 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 		}
 	}
 
-	// create occlusion shaders if enabled
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
+	// Hi-Z building and occlusion test shaders, the occlusion pass reuses depth mesh shaders
+	if (IsHiZOcclusionSupported())
 	{
-		OcclusionPassShaders.resize(CurrentScene->GetAllRendererCount());
-		for (size_t Idx = 0; Idx < AllRenderers.size(); Idx++)
-		{
-			UHMaterial* Mat = AllRenderers[Idx]->GetMaterial();
-			if (Mat)
-			{
-				OcclusionPassShaders[Idx] = MakeUnique<UHOcclusionPassShader>(GraphicInterface, "OcclusionPassShader", OcclusionPassObj.RenderPass);
-			}
-		}
+		HiZFromDepthShader = MakeUnique<UHDownsampleDepthShader>(GraphicInterface, "HiZFromDepthShader", true);
+		HiZDownsampleShader = MakeUnique<UHDownsampleDepthShader>(GraphicInterface, "HiZDownsampleShader", false);
+		OcclusionTestShader = MakeUnique<UHOcclusionTestShader>(GraphicInterface, "OcclusionTestShader");
 	}
 
 	// create mesh shaders if supported
 	if (GraphicInterface->IsMeshShaderSupported())
 	{
-		MeshShaderInstancesCounter.resize(CurrentScene->GetMaterialCount());
-		SortedMeshShaderGroupIndex.resize(CurrentScene->GetMaterialCount());
-		VisibleMeshShaderData.resize(CurrentScene->GetMaterialCount());
-		MotionOpaqueMeshShaderData.resize(CurrentScene->GetMaterialCount());
-		MotionTranslucentMeshShaderData.resize(CurrentScene->GetMaterialCount());
-
-		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
-		{
-			GMeshShaderData[Idx].resize(CurrentScene->GetMaterialCount());
-			GMotionOpaqueShaderData[Idx].resize(CurrentScene->GetMaterialCount());
-			GMotionTranslucentShaderData[Idx].resize(CurrentScene->GetMaterialCount());
-		}
-
+		ResizeMeshShaderData();
 		DepthMeshShaders.resize(CurrentScene->GetMaterialCount());
 		BaseMeshShaders.resize(CurrentScene->GetMaterialCount());
 		MotionMeshShaders.resize(CurrentScene->GetMaterialCount());
@@ -457,8 +539,20 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 		}
 	}
 
-	// light culling and pass shaders
-	LightCullingShader = MakeUnique<UHLightCullingShader>(GraphicInterface, "LightCullingShader");
+	// GPU culling and per material shaders for indirect draws
+	if (IsGPUDrivenSupported())
+	{
+		GPUCullingShader = MakeUnique<UHGPUCullingShader>(GraphicInterface, "GPUCullingShader");
+		for (UHMaterial* Mat : CurrentScene->GetMaterials())
+		{
+			RecreateIndirectShaders(Mat);
+		}
+	}
+
+	// light clustering and pass shaders
+	LightClusterCountShader = MakeUnique<UHLightClusteringShader>(GraphicInterface, "LightClusterCountShader", "LightClusterCountCS");
+	LightClusterAllocateShader = MakeUnique<UHLightClusteringShader>(GraphicInterface, "LightClusterAllocateShader", "LightClusterAllocateCS");
+	LightClusterFillShader = MakeUnique<UHLightClusteringShader>(GraphicInterface, "LightClusterFillShader", "LightClusterFillCS");
 	LightPassShader = MakeUnique<UHLightPassShader>(GraphicInterface, "LightPassShader");
 	ReflectionPassShader = MakeUnique<UHReflectionPassShader>(GraphicInterface, "ReflectionPassShader");
 	RTReflectionMipmapShader = MakeUnique<UHRTReflectionMipmap>(GraphicInterface, "RTReflectionMipmapShader");
@@ -492,6 +586,8 @@ void UHDeferredShadingRenderer::PrepareRenderingShaders()
 	DebugViewShader = MakeUnique<UHDebugViewShader>(GraphicInterface, "DebugViewShader", PostProcessPassObj[0].RenderPass);
 	DebugBoundShader = MakeUnique<UHDebugBoundShader>(GraphicInterface, "DebugBoundShader", PostProcessPassObj[0].RenderPass);
 #endif
+
+	GraphicInterface->EndPipelineBatch(JobSystem.get());
 }
 
 bool UHDeferredShadingRenderer::InitQueueSubmitters()
@@ -505,8 +601,13 @@ bool UHDeferredShadingRenderer::InitQueueSubmitters()
 		bAsyncInitSucceed &= CreateAsyncComputeQueue();
 	}
 
-	return bAsyncInitSucceed && SceneRenderQueue.Initialize(GraphicInterface, QueueFamily.GraphicsFamily.value(), 0
-		, "GraphicQueue");
+	if (!bAsyncInitSucceed || !SceneRenderQueue.Initialize(GraphicInterface, QueueFamily.GraphicsFamily.value(), 0, "GraphicQueue"))
+	{
+		return false;
+	}
+
+	GraphicsTimelineRecorder.Initialize(GraphicInterface, &GPUTimeline, "GPU Graphics Queue", QueueFamily.GraphicsFamily.value());
+	return true;
 }
 
 void UHDeferredShadingRenderer::UpdateDescriptors()
@@ -555,22 +656,39 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 			assert(BasePassShaders.find(Renderer->GetBufferDataIndex()) != BasePassShaders.end());
 			BasePassShaders[Renderer->GetBufferDataIndex()]->BindParameters(Renderer);
 		}
-	}
 
-	// ------------------------------------------------ Occlusion shader descriptor update
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
-	{
-		for (const UHMeshRendererComponent* Renderer : CurrentScene->GetAllRenderers())
+		// ------------------------------------------------ Indirect draw descriptor update
+		// meshes are fetched from the geometry pool, which is empty if there is nothing to pack
+		if (MeshGeometryPool.GetIndexBuffer() != nullptr)
 		{
-			if (OcclusionPassShaders[Renderer->GetBufferDataIndex()] != nullptr)
+			for (auto& Shader : DepthIndirectShaders)
 			{
-				OcclusionPassShaders[Renderer->GetBufferDataIndex()]->BindParameters(Renderer);
+				Shader.second->BindParameters(&MeshGeometryPool);
+			}
+
+			for (auto& Shader : BaseIndirectShaders)
+			{
+				Shader.second->BindParameters(&MeshGeometryPool);
 			}
 		}
 	}
 
-	// ------------------------------------------------ Lighting culling descriptor update
-	LightCullingShader->BindParameters();
+	// ------------------------------------------------ Occlusion test descriptor update
+	if (OcclusionTestShader != nullptr)
+	{
+		OcclusionTestShader->BindParameters();
+	}
+
+	// ------------------------------------------------ GPU culling descriptor update
+	if (GPUCullingShader != nullptr)
+	{
+		GPUCullingShader->BindParameters();
+	}
+
+	// ------------------------------------------------ Lighting clustering descriptor update
+	LightClusterCountShader->BindParameters();
+	LightClusterAllocateShader->BindParameters();
+	LightClusterFillShader->BindParameters();
 
 	// ------------------------------------------------ Lighting pass descriptor update
 	LightPassShader->BindParameters(bEnableRayTracing);
@@ -660,12 +778,13 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 		|| (GraphicInterface->IsMeshShaderSupported() && MeshInstanceCount > 0))
 	{
 		// bind VB/IB table for RT or mesh shader use
-		std::vector<UHRenderBuffer<XMFLOAT3>*> Positions;
-		std::vector<UHRenderBuffer<XMFLOAT2>*> UVs;
-		std::vector<UHRenderBuffer<XMFLOAT3>*> Normals;
-		std::vector<UHRenderBuffer<XMFLOAT4>*> Tangents;
+		std::vector<UHRenderBuffer<uint32_t>*> Positions;
+		std::vector<UHRenderBuffer<uint32_t>*> UVs;
+		std::vector<UHRenderBuffer<uint32_t>*> Normals;
+		std::vector<UHRenderBuffer<uint32_t>*> Tangents;
 		std::vector<VkDescriptorBufferInfo> IndicesInfo;
 		std::vector<UHRenderBuffer<UHMeshlet>*> Meshlets;
+		std::vector<UHRenderBuffer<uint32_t>*> MeshletIndices;
 
 		// setup mesh data array to bind
 		for (uint32_t Idx = 0; Idx < MeshInstanceCount; Idx++)
@@ -676,6 +795,7 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 			Normals.push_back(Mesh->GetNormalBuffer());
 			Tangents.push_back(Mesh->GetTangentBuffer());
 			Meshlets.push_back(Mesh->GetMeshletBuffer());
+			MeshletIndices.push_back(Mesh->GetMeshletIndexBuffer());
 
 			// collect index buffer info based on index type
 			VkDescriptorBufferInfo NewInfo{};
@@ -698,6 +818,7 @@ void UHDeferredShadingRenderer::UpdateDescriptors()
 		TangentTable->BindStorage(Tangents, 0);
 		IndicesTable->BindStorage(IndicesInfo, 0);
 		MeshletTable->BindStorage(Meshlets, 0);
+		MeshletIndexTable->BindStorage(MeshletIndices, 0);
 	}
 
 	// ------------------------------------------------ debug passes descriptor update
@@ -720,13 +841,20 @@ void UHDeferredShadingRenderer::ReleaseShaders()
 
 	ClearContainer(BasePassShaders);
 	ClearContainer(BaseMeshShaders);
+	ClearContainer(DepthIndirectShaders);
+	ClearContainer(BaseIndirectShaders);
 	ClearContainer(MotionOpaqueShaders);
 	ClearContainer(MotionTranslucentShaders);
 	ClearContainer(MotionMeshShaders);
 	ClearContainer(TranslucentPassShaders);
-	ClearContainer(OcclusionPassShaders);
 
-	UH_SAFE_RELEASE(LightCullingShader);
+	UH_SAFE_RELEASE(GPUCullingShader);
+	UH_SAFE_RELEASE(HiZFromDepthShader);
+	UH_SAFE_RELEASE(HiZDownsampleShader);
+	UH_SAFE_RELEASE(OcclusionTestShader);
+	UH_SAFE_RELEASE(LightClusterCountShader);
+	UH_SAFE_RELEASE(LightClusterAllocateShader);
+	UH_SAFE_RELEASE(LightClusterFillShader);
 	UH_SAFE_RELEASE(LightPassShader);
 	UH_SAFE_RELEASE(ReflectionPassShader);
 	UH_SAFE_RELEASE(RTReflectionMipmapShader);
@@ -746,6 +874,7 @@ void UHDeferredShadingRenderer::ReleaseShaders()
 		UH_SAFE_RELEASE(TangentTable);
 		UH_SAFE_RELEASE(IndicesTable);
 		UH_SAFE_RELEASE(MeshletTable);
+		UH_SAFE_RELEASE(MeshletIndexTable);
 	}
 
 	if (GraphicInterface->IsRayTracingEnabled())
@@ -813,24 +942,54 @@ void UHDeferredShadingRenderer::CreateRenderingBuffers()
 	// motion vector buffer
 	GMotionVectorRT = GraphicInterface->RequestRenderTexture("MotionVectorRT", RenderResolution, MotionFormat);
 
+	// Hi-Z buffer with full mip chain, the first mip is half resolution and keeps the farthest depth of 2x2 depth pixels
+	if (IsHiZOcclusionSupported())
+	{
+		const VkExtent2D HiZResolution{ (std::max)(RenderResolution.width >> 1, 1u), (std::max)(RenderResolution.height >> 1, 1u) };
+		GHiZBuffer = GraphicInterface->RequestRenderTexture("HiZBuffer", HiZResolution, UHTextureFormat::UH_FORMAT_R32F, true, true);
+	}
+
 	// rt shadows buffer
 	ResizeRayTracingBuffers(true);
 
-	// create light culling tile buffer
-	uint32_t TileCountX, TileCountY;
-	GetLightCullingTileCount(TileCountX, TileCountY);
-
-	// data size per tile: (MaxPointLightPerTile + 1), the extra one is for the number of lights in this tile
-	// so it's TileCountX * TileCountY * (MaxPointLightPerTile + 1) in total
-	GPointLightListBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxPointLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "PointLightList");
-	GPointLightListTransBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxPointLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "PointLightListTrans");
-
-	GSpotLightListBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxSpotLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "SpotLightList");
-	GSpotLightListTransBuffer = GraphicInterface->RequestRenderBuffer<uint32_t>(TileCountX * TileCountY * (MaxSpotLightPerTile + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-		, "SpotLightListTrans");
+	// create light cluster buffers, the index list keeps its capacity after resizing
+	ResizeLightClusterBuffers(LightClusterIndexCapacity);
+}
+
+void UHDeferredShadingRenderer::ResizeLightClusterBuffers(uint32_t InNumIndices)
+{
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		UH_SAFE_RELEASE(GLightClusterGridBuffer[Idx]);
+		UH_SAFE_RELEASE(GLightClusterIndexBuffer[Idx]);
+		UH_SAFE_RELEASE(GLightClusterCounterBuffer[Idx]);
+	}
+
+	// the grid size follows the render resolution, and the index list starts with 8 lights per entry on average
+	// CPU clustering grows it with 50% headroom so a few more lights won't recreate it again, GPU clustering drops the indices beyond it
+	const uint32_t TileSize = UHLightClusterView::TileSize;
+	const uint32_t CountX = (std::max)((RenderResolution.width + TileSize - 1) / TileSize, 1u);
+	const uint32_t CountY = (std::max)((RenderResolution.height + TileSize - 1) / TileSize, 1u);
+	const uint32_t EntryCount = CountX * CountY * UHLightClusterView::NumSlices * UHLightClusterView::NumLightTypes;
+	LightClusterIndexCapacity = (std::max)(LightClusterIndexCapacity, EntryCount * 8);
+	if (InNumIndices > LightClusterIndexCapacity)
+	{
+		LightClusterIndexCapacity = InNumIndices + InNumIndices / 2;
+	}
+
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		GLightClusterGridBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHLightClusterEntry>(EntryCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, "LightClusterGrid");
+		GLightClusterIndexBuffer[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(LightClusterIndexCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, "LightClusterIndices");
+		GLightClusterCounterBuffer[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, "LightClusterCounter");
+
+		// an empty grid until the lights are assigned
+		const std::vector<UHLightClusterEntry> EmptyEntries(EntryCount, UHLightClusterEntry{ 0, 0 });
+		GLightClusterGridBuffer[Idx]->UploadAllData(EmptyEntries.data());
+	}
 }
 
 void UHDeferredShadingRenderer::RelaseRenderingBuffers()
@@ -850,13 +1009,21 @@ void UHDeferredShadingRenderer::RelaseRenderingBuffers()
 	GraphicInterface->RequestReleaseRT(GTranslucentBump);
 	GraphicInterface->RequestReleaseRT(GTranslucentSmoothness);
 
+	if (GHiZBuffer != nullptr)
+	{
+		GraphicInterface->RequestReleaseRT(GHiZBuffer);
+		GHiZBuffer = nullptr;
+	}
+
 	ReleaseRayTracingBuffers();
 
-	// point light list needs to be resized, so release it here instead in ReleaseDataBuffers()
-	UH_SAFE_RELEASE(GPointLightListBuffer);
-	UH_SAFE_RELEASE(GPointLightListTransBuffer);
-	UH_SAFE_RELEASE(GSpotLightListBuffer);
-	UH_SAFE_RELEASE(GSpotLightListTransBuffer);
+	// light cluster grid needs to be resized, so release it here instead in ReleaseDataBuffers()
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		UH_SAFE_RELEASE(GLightClusterGridBuffer[Idx]);
+		UH_SAFE_RELEASE(GLightClusterIndexBuffer[Idx]);
+		UH_SAFE_RELEASE(GLightClusterCounterBuffer[Idx]);
+	}
 
 	// cleanup gaussian constant
 	RayTracingGaussianConsts.Release(GraphicInterface);
@@ -873,7 +1040,7 @@ void UHDeferredShadingRenderer::CreateRenderPasses()
 		DepthPassObj = GraphicInterface->CreateRenderPass(UHTransitionInfo(), GSceneDepth);
 	}
 
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
+	if (IsHiZOcclusionSupported())
 	{
 		// occlusion only needs depth load
 		OcclusionPassObj = GraphicInterface->CreateRenderPass(UHTransitionInfo(VK_ATTACHMENT_LOAD_OP_LOAD), GSceneDepth);
@@ -926,7 +1093,7 @@ void UHDeferredShadingRenderer::CreateRenderFrameBuffers()
 		DepthPassObj.FrameBuffer = GraphicInterface->CreateFrameBuffer(GSceneDepth, DepthPassObj.RenderPass, RenderResolution);
 	}
 
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
+	if (IsHiZOcclusionSupported())
 	{
 		OcclusionPassObj.FrameBuffer = GraphicInterface->CreateFrameBuffer(GSceneDepth, OcclusionPassObj.RenderPass, RenderResolution);
 	}
@@ -966,7 +1133,7 @@ void UHDeferredShadingRenderer::ReleaseRenderPassObjects()
 		DepthPassObj.Release(LogicalDevice);
 	}
 
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
+	if (IsHiZOcclusionSupported())
 	{
 		OcclusionPassObj.Release(LogicalDevice);
 	}
@@ -1001,6 +1168,8 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 			, "SystemConstant");
 		GObjectConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHObjectConstants>(RendererCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "ObjectConstant");
+		GInstanceIndexBuffer[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(GetInstanceIndexCapacity(RendererCount), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, "InstanceIndex");
 		GDirectionalLightBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHDirectionalLightConstants>(CurrentScene->GetDirLightCount(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			, "DirectionalLight");
 		GPointLightBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHPointLightConstants>(CurrentScene->GetPointLightCount(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
@@ -1009,6 +1178,22 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 			, "SpotLight");
 	}
 
+	// indirect commands, draw counts and cull data of GPU-driven rendering, a bucket has one renderer at least
+	if (IsGPUDrivenSupported())
+	{
+		const size_t IndirectCount = (std::max)(RendererCount, static_cast<size_t>(1));
+		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+		{
+			GIndirectDrawBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHDrawIndexedIndirectCommand>(IndirectCount
+				, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "IndirectDraw");
+			GIndirectCountBuffer[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(IndirectCount
+				, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "IndirectDrawCount");
+			GIndirectCullDataBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHIndirectCullData>(IndirectCount
+				, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "IndirectCullData");
+		}
+		bIndirectDrawsDirty = true;
+	}
+
 	ObjectConstantsCPU.resize(RendererCount);
 	DirLightConstantsCPU.resize(CurrentScene->GetDirLightCount());
 	PointLightConstantsCPU.resize(CurrentScene->GetPointLightCount());
@@ -1045,6 +1230,8 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 			UHRendererInstance RendererInstance;
 			RendererInstance.MeshIndex = Mesh->GetBufferDataIndex();
 			RendererInstance.IndiceType = Mesh->IsIndexBufer32Bit() ? 1 : 0;
+			RendererInstance.VertexFormat = UH_ENUM_VALUE_U(Mesh->GetVertexFormat());
+			RendererInstance.MaterialIndex = Mat->GetBufferDataIndex();
 			RendererInstances[Renderers[Idx]->GetBufferDataIndex()] = RendererInstance;
 		}
 
@@ -1061,57 +1248,43 @@ void UHDeferredShadingRenderer::CreateDataBuffers()
 		}
 	}
 
-	// create occlusion query anyway in editor build
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
+	// create occlusion result anyway in editor build
+	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableOcclusionCulling)
 	{
-		CreateOcclusionQuery();
+		CreateOcclusionResult();
 	}
 }
 
-void UHDeferredShadingRenderer::CreateOcclusionQuery()
+void UHDeferredShadingRenderer::CreateOcclusionResult()
 {
 	const uint32_t Count = static_cast<uint32_t>(CurrentScene->GetAllRendererCount());
 	if (Count > 0)
 	{
+		// written by the Hi-Z occlusion test with mesh shaders, or uploaded from software occlusion otherwise
 		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 		{
-			// will do predication rendering on GPU instead of traditional readback
-			OcclusionQuery[Idx] = GraphicInterface->RequestGPUQuery(Count, VK_QUERY_TYPE_OCCLUSION);
-			GOcclusionResult[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(Count
-				, VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
-				, "OcclusionResult");
-		}
-
-		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
-		{
-			GOcclusionConstantBuffer[Idx] = GraphicInterface->RequestRenderBuffer<UHObjectConstants>(Count, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
-				, "OcclusionConstant");
+			GOcclusionResult[Idx] = GraphicInterface->RequestRenderBuffer<uint32_t>(Count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, "OcclusionResult");
 		}
-		OcclusionConstantsCPU.resize(Count);
 
-		std::vector<uint32_t> InitialVisibility(Count, 0);
+		// everything is visible before the first test
+		std::vector<uint32_t> InitialVisibility(Count, 1);
 		for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 		{
 			GOcclusionResult[Idx]->UploadAllData(InitialVisibility.data());
 		}
+		SoftwareOcclusionResult = std::move(InitialVisibility);
 	}
 }
 
-void UHDeferredShadingRenderer::ReleaseOcclusionQuery()
+void UHDeferredShadingRenderer::ReleaseOcclusionResult()
 {
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
-		if (OcclusionQuery[Idx] != nullptr)
-		{
-			GraphicInterface->RequestReleaseGPUQuery(OcclusionQuery[Idx]);
-			OcclusionQuery[Idx] = nullptr;
-		}
-
-		UH_SAFE_RELEASE(GOcclusionConstantBuffer[Idx]);
 		UH_SAFE_RELEASE(GOcclusionResult[Idx]);
 	}
 
-	OcclusionConstantsCPU.clear();
+	OccluderCache.clear();
+	SoftwareOcclusionResult.clear();
 }
 
 bool UHDeferredShadingRenderer::CreateAsyncComputeQueue()
@@ -1119,61 +1292,52 @@ bool UHDeferredShadingRenderer::CreateAsyncComputeQueue()
 	VkDevice LogicalDevice = GraphicInterface->GetLogicalDevice();
 	const UHQueueFamily& QueueFamily = GraphicInterface->GetQueueFamily();
 
-	return AsyncComputeQueue.Initialize(GraphicInterface, QueueFamily.ComputesFamily.value(), 0, "AsyncComputeQueue");
+	if (!AsyncComputeQueue.Initialize(GraphicInterface, QueueFamily.ComputesFamily.value(), 0, "AsyncComputeQueue"))
+	{
+		return false;
+	}
+
+	AsyncComputeTimelineRecorder.Initialize(GraphicInterface, &GPUTimeline, "GPU Async Compute Queue", QueueFamily.ComputesFamily.value());
+	return true;
 }
 
 void UHDeferredShadingRenderer::ReleaseAsyncComputeQueue()
 {
 	AsyncComputeQueue.Release();
+	AsyncComputeTimelineRecorder.Release();
 }
 
 void UHDeferredShadingRenderer::CreateThreadObjects()
 {
-#if WITH_EDITOR
-	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHRenderPassTypes::UHRenderPassMax); Idx++)
-	{
-		GPUTimeQueries[Idx] = GraphicInterface->RequestGPUQuery(2, VK_QUERY_TYPE_TIMESTAMP);
-	}
-	ThreadDrawCalls.resize(NumWorkerThreads);
-	ThreadOccludedCalls.resize(NumWorkerThreads);
-#endif
+	BundleDrawCalls.resize(NumParallelBundles);
 
 	// create parallel submitter
 	if (GIsEditor || (ConfigInterface->RenderingSetting().bEnableDepthPrePass && !GraphicInterface->IsMeshShaderSupported()))
 	{
-		DepthParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumWorkerThreads
+		DepthParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumParallelBundles
 			, "DepthPass");
 	}
 
 	if (!GraphicInterface->IsMeshShaderSupported())
 	{
-		BaseParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumWorkerThreads
+		BaseParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumParallelBundles
 			, "BasePass");
-		MotionOpaqueParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumWorkerThreads
+		MotionOpaqueParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumParallelBundles
 			, "MotionOpaquePass");
-		MotionTranslucentParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumWorkerThreads
+		MotionTranslucentParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumParallelBundles
 			, "MotionTranslucentPass");
 	}
 
-	TranslucentParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumWorkerThreads
+	TranslucentParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumParallelBundles
 		, "TranslucentPass");
 
-	if (GIsEditor || ConfigInterface->RenderingSetting().bEnableHardwareOcclusion)
-	{
-		OcclusionParallelSubmitter.Initialize(GraphicInterface, GraphicInterface->GetQueueFamily(), NumWorkerThreads
-			, "OcclusionPass");
-	}
-
 	// init threads, it will wait at the beginning
 	RenderThread = MakeUnique<UHThread>();
 	RenderThread->BeginThread(std::thread(&UHDeferredShadingRenderer::RenderThreadLoop, this), GRenderThreadAffinity);
-	WorkerThreads.resize(NumWorkerThreads);
 
-	for (int32_t Idx = 0; Idx < NumWorkerThreads; Idx++)
-	{
-		WorkerThreads[Idx] = MakeUnique<UHThread>();
-		WorkerThreads[Idx]->BeginThread(std::thread(&UHDeferredShadingRenderer::WorkerThreadLoop, this, Idx), GWorkerThreadAffinity + Idx);
-	}
+	// init job system, render thread also joins the work when it waits for the jobs
+	JobSystem = MakeUnique<UHJobSystem>();
+	JobSystem->Initialize(NumWorkerThreads, GWorkerThreadAffinity);
 }
 
 void UHDeferredShadingRenderer::ReleaseDataBuffers()
@@ -1183,6 +1347,10 @@ void UHDeferredShadingRenderer::ReleaseDataBuffers()
 	{
 		UH_SAFE_RELEASE(GSystemConstantBuffer[Idx]);
 		UH_SAFE_RELEASE(GObjectConstantBuffer[Idx]);
+		UH_SAFE_RELEASE(GInstanceIndexBuffer[Idx]);
+		UH_SAFE_RELEASE(GIndirectDrawBuffer[Idx]);
+		UH_SAFE_RELEASE(GIndirectCountBuffer[Idx]);
+		UH_SAFE_RELEASE(GIndirectCullDataBuffer[Idx]);
 		UH_SAFE_RELEASE(GDirectionalLightBuffer[Idx]);
 		UH_SAFE_RELEASE(GPointLightBuffer[Idx]);
 		UH_SAFE_RELEASE(GSpotLightBuffer[Idx]);
@@ -1205,6 +1373,8 @@ void UHDeferredShadingRenderer::ReleaseDataBuffers()
 	VisibleMeshShaderData.clear();
 	MotionOpaqueMeshShaderData.clear();
 	MotionTranslucentMeshShaderData.clear();
+
+	MeshGeometryPool.Release();
 }
 
 void UHDeferredShadingRenderer::RebuildTextureTable()
@@ -1279,8 +1449,10 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 		return;
 	}
 
+	UHGameTimerScope Scope("RefreshMaterialShaders", true);
 	GraphicInterface->WaitGPU();
 	CheckTextureReference(std::vector<UHMaterial*>{ Mat });
+	GraphicInterface->BeginPipelineBatch();
 
 	const bool bIsOpaque = Mat->IsOpaque();
 	const int32_t MatIndex = Mat->GetBufferDataIndex();
@@ -1344,11 +1516,15 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 			}
 		}
 
-		// mesh shader update if support
+		// mesh shader update if support, otherwise the indirect shaders of GPU-driven rendering
 		if (GraphicInterface->IsMeshShaderSupported())
 		{
 			RecreateMeshShaders(Mat);
 		}
+		else
+		{
+			RecreateIndirectShaders(Mat);
+		}
 	}
 
 	// update hit group shader as well
@@ -1366,6 +1542,7 @@ void UHDeferredShadingRenderer::RefreshMaterialShaders(UHMaterial* Mat, bool bNe
 	// mark render dirties for re-uploading constant and updating TLAS
 	Mat->SetRenderDirties(true);
 
+	GraphicInterface->EndPipelineBatch(JobSystem.get());
 	UpdateDescriptors();
 }
 
@@ -1430,6 +1607,20 @@ void UHDeferredShadingRenderer::OnRendererMaterialChanged(UHMeshRendererComponen
 	}
 	NewMat->AddReferenceObject(InRenderer);
 
+	// the new material may not be drawn indirectly yet
+	if (!bUseMeshShader && BaseIndirectShaders.find(NewMat->GetBufferDataIndex()) == BaseIndirectShaders.end())
+	{
+		RecreateIndirectShaders(NewMat);
+	}
+
+	// hit shaders lookup the material with renderer instance, and top level AS instances need the new material states
+	if (RendererBufferIndex < static_cast<int32_t>(RendererInstances.size()))
+	{
+		RendererInstances[RendererBufferIndex].MaterialIndex = NewMat->GetBufferDataIndex();
+		UploadRendererInstances();
+	}
+	InRenderer->SetRenderDirties(true);
+
 	if (bUseMeshShader)
 	{
 		// both old & new mesh shader needs a update
@@ -1526,21 +1717,40 @@ void UHDeferredShadingRenderer::AppendMeshRenderers(const std::vector<UHMeshRend
 		{
 			UH_SAFE_RELEASE(GObjectConstantBuffer[Idx]);
 			GObjectConstantBuffer[Idx]->CreateBuffer(RendererCount, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+			UH_SAFE_RELEASE(GInstanceIndexBuffer[Idx]);
+			GInstanceIndexBuffer[Idx]->CreateBuffer(GetInstanceIndexCapacity(RendererCount), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+			if (IsGPUDrivenSupported())
+			{
+				UH_SAFE_RELEASE(GIndirectDrawBuffer[Idx]);
+				GIndirectDrawBuffer[Idx]->CreateBuffer(RendererCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+				UH_SAFE_RELEASE(GIndirectCountBuffer[Idx]);
+				GIndirectCountBuffer[Idx]->CreateBuffer(RendererCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+				UH_SAFE_RELEASE(GIndirectCullDataBuffer[Idx]);
+				GIndirectCullDataBuffer[Idx]->CreateBuffer(RendererCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+			}
 		}
+		bIndirectDrawsDirty = true;
 	}
 
 	// do the same as initialization
 	PrepareMeshes();
 	PrepareTextures();
 
+	GraphicInterface->BeginPipelineBatch();
 	for (UHMeshRendererComponent* Renderer : InRenderers)
 	{
 		UHMaterial* Mat = Renderer->GetMaterial();
 		if (Mat)
 		{
 			RecreateMaterialShaders(Renderer, Mat);
+			if (BaseIndirectShaders.find(Mat->GetBufferDataIndex()) == BaseIndirectShaders.end())
+			{
+				RecreateIndirectShaders(Mat);
+			}
 		}
 	}
+	GraphicInterface->EndPipelineBatch(JobSystem.get());
 
 	if (GraphicInterface->IsRayTracingEnabled())
 	{
@@ -1568,6 +1778,7 @@ void UHDeferredShadingRenderer::ToggleDepthPrepass()
 	BasePassObj.FrameBuffer = GraphicInterface->CreateFrameBuffer(GBuffers, BasePassObj.RenderPass, RenderResolution);
 
 	// recompile (trigger state recreation for shaders involved prepass flag)
+	GraphicInterface->BeginPipelineBatch();
 	if (GraphicInterface->IsMeshShaderSupported())
 	{
 		for (auto& Shader : BaseMeshShaders)
@@ -1596,15 +1807,45 @@ void UHDeferredShadingRenderer::ToggleDepthPrepass()
 			Shader.second->OnCompile();
 		}
 
+		for (auto& Shader : BaseIndirectShaders)
+		{
+			Shader.second->SetNewRenderPass(BasePassObj.RenderPass);
+			Shader.second->OnCompile();
+		}
+
 		for (auto& Shader : MotionOpaqueShaders)
 		{
 			Shader.second->SetNewRenderPass(MotionOpaquePassObj.RenderPass);
 			Shader.second->OnCompile();
 		}
 	}
+	GraphicInterface->EndPipelineBatch(JobSystem.get());
 	UpdateDescriptors();
 }
 
+// refresh shaders of all scene materials as if they were reassigned, which requests every material shader and state again
+// return the elapsed time in ms
+double UHDeferredShadingRenderer::BenchmarkRefreshMaterialShaders()
+{
+	if (CurrentScene == nullptr)
+	{
+		UHE_LOG(L"Scene is not set!\n");
+		return 0.0;
+	}
+
+	const std::vector<UHMaterial*>& Materials = CurrentScene->GetMaterials();
+	const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+	for (UHMaterial* Mat : Materials)
+	{
+		Mat->SetCompileFlag(UHMaterialCompileFlag::RendererMaterialChanged);
+		RefreshMaterialShaders(Mat, true, true);
+	}
+	const double ElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+
+	UHE_LOG(L"Refreshed shaders of " + std::to_wstring(Materials.size()) + L" materials in " + std::to_wstring(ElapsedMs) + L" ms\n");
+	return ElapsedMs;
+}
+
 #endif
 
 void UHDeferredShadingRenderer::RecreateMeshTables()
@@ -1617,6 +1858,7 @@ void UHDeferredShadingRenderer::RecreateMeshTables()
 		UH_SAFE_RELEASE(TangentTable);
 		UH_SAFE_RELEASE(IndicesTable);
 		UH_SAFE_RELEASE(MeshletTable);
+		UH_SAFE_RELEASE(MeshletIndexTable);
 
 		PositionTable = MakeUnique<UHMeshTable>(GraphicInterface, "PositionTable", MeshInstanceCount);
 		UV0Table = MakeUnique<UHMeshTable>(GraphicInterface, "UV0Table", MeshInstanceCount);
@@ -1624,6 +1866,7 @@ void UHDeferredShadingRenderer::RecreateMeshTables()
 		TangentTable = MakeUnique<UHMeshTable>(GraphicInterface, "TangentTable", MeshInstanceCount);
 		IndicesTable = MakeUnique<UHMeshTable>(GraphicInterface, "IndicesTable", MeshInstanceCount);
 		MeshletTable = MakeUnique<UHMeshTable>(GraphicInterface, "MeshletTable", MeshInstanceCount);
+		MeshletIndexTable = MakeUnique<UHMeshTable>(GraphicInterface, "MeshletIndexTable", MeshInstanceCount);
 	}
 }
 
@@ -1674,7 +1917,7 @@ void UHDeferredShadingRenderer::RecreateMeshShaders(UHMaterial* InMat)
 		, MeshletTable->GetDescriptorSetLayout()
 		, PositionTable->GetDescriptorSetLayout()
 		, UV0Table->GetDescriptorSetLayout()
-		, IndicesTable->GetDescriptorSetLayout()
+		, MeshletIndexTable->GetDescriptorSetLayout()
 	};
 
 	const uint32_t MatDataIndex = InMat->GetBufferDataIndex();
@@ -1712,6 +1955,51 @@ void UHDeferredShadingRenderer::RecreateMeshShaders(UHMaterial* InMat)
 	RecreateMeshShaderData(InMat);
 }
 
+void UHDeferredShadingRenderer::RecreateIndirectShaders(UHMaterial* InMat)
+{
+	// only create for GPU-driven rendering, translucent renderers are still drawn with their own shaders
+	if (!IsGPUDrivenSupported())
+	{
+		return;
+	}
+
+	const int32_t MatDataIndex = InMat->GetBufferDataIndex();
+	SafeReleaseShaderPtr(DepthIndirectShaders, MatDataIndex, false);
+	SafeReleaseShaderPtr(BaseIndirectShaders, MatDataIndex, false);
+	if (!InMat->IsOpaque())
+	{
+		DepthIndirectShaders.erase(MatDataIndex);
+		BaseIndirectShaders.erase(MatDataIndex);
+		return;
+	}
+
+	// the states are the same as per renderer shaders of the material, so they're usually found in the state pool
+	const std::vector<VkDescriptorSetLayout> BindlessLayouts = { TextureTable->GetDescriptorSetLayout(), SamplerTable->GetDescriptorSetLayout() };
+	if (GIsEditor || GraphicInterface->IsDepthPrePassEnabled())
+	{
+		DepthIndirectShaders[MatDataIndex] = MakeUnique<UHDepthPassShader>(GraphicInterface, "DepthIndirectShader", DepthPassObj.RenderPass, InMat, BindlessLayouts);
+	}
+
+	BaseIndirectShaders[MatDataIndex] = MakeUnique<UHBasePassShader>(GraphicInterface, "BaseIndirectShader", BasePassObj.RenderPass, InMat, BindlessLayouts);
+}
+
+void UHDeferredShadingRenderer::ResizeMeshShaderData()
+{
+	const size_t MaterialCount = CurrentScene->GetMaterialCount();
+	MeshShaderInstancesCounter.resize(MaterialCount);
+	SortedMeshShaderGroupIndex.resize(MaterialCount);
+	VisibleMeshShaderData.resize(MaterialCount);
+	MotionOpaqueMeshShaderData.resize(MaterialCount);
+	MotionTranslucentMeshShaderData.resize(MaterialCount);
+
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		GMeshShaderData[Idx].resize(MaterialCount);
+		GMotionOpaqueShaderData[Idx].resize(MaterialCount);
+		GMotionTranslucentShaderData[Idx].resize(MaterialCount);
+	}
+}
+
 void UHDeferredShadingRenderer::RecreateMeshShaderData(UHMaterial* InMat)
 {
 	GraphicInterface->WaitGPU();
@@ -1744,6 +2032,8 @@ void UHDeferredShadingRenderer::RecreateMeshShaderData(UHMaterial* InMat)
 			UHRendererInstance RendererInstance;
 			RendererInstance.MeshIndex = Mesh->GetBufferDataIndex();
 			RendererInstance.IndiceType = Mesh->IsIndexBufer32Bit() ? 1 : 0;
+			RendererInstance.VertexFormat = UH_ENUM_VALUE_U(Mesh->GetVertexFormat());
+			RendererInstance.MaterialIndex = Mat->GetBufferDataIndex();
 			RendererInstances[Renderer->GetBufferDataIndex()] = RendererInstance;
 		}
 	}
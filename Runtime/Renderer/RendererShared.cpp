@@ -3,15 +3,13 @@
 
 UniquePtr<UHRenderBuffer<UHSystemConstants>> GSystemConstantBuffer[GMaxFrameInFlight];
 UniquePtr<UHRenderBuffer<UHObjectConstants>> GObjectConstantBuffer[GMaxFrameInFlight];
-UniquePtr<UHRenderBuffer<UHObjectConstants>> GOcclusionConstantBuffer[GMaxFrameInFlight];
 UniquePtr<UHRenderBuffer<UHDirectionalLightConstants>> GDirectionalLightBuffer[GMaxFrameInFlight];
 UniquePtr<UHRenderBuffer<UHPointLightConstants>> GPointLightBuffer[GMaxFrameInFlight];
 UniquePtr<UHRenderBuffer<UHSpotLightConstants>> GSpotLightBuffer[GMaxFrameInFlight];
 
-UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListBuffer;
-UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListTransBuffer;
-UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListBuffer;
-UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListTransBuffer;
+UniquePtr<UHRenderBuffer<UHLightClusterEntry>> GLightClusterGridBuffer[GMaxFrameInFlight];
+UniquePtr<UHRenderBuffer<uint32_t>> GLightClusterIndexBuffer[GMaxFrameInFlight];
+UniquePtr<UHRenderBuffer<uint32_t>> GLightClusterCounterBuffer[GMaxFrameInFlight];
 
 UHRenderTexture* GSceneDiffuse;
 UHRenderTexture* GSceneNormal;
@@ -55,6 +53,14 @@ UHTextureCube* GBlackCube;
 
 // occlusion data
 UniquePtr<UHRenderBuffer<uint32_t>> GOcclusionResult[GMaxFrameInFlight];
+// Hi-Z pyramid of scene depth for occlusion test, it's half resolution and each texel keeps the farthest depth
+UHRenderTexture* GHiZBuffer;
+// renderer indices of instanced draws
+UniquePtr<UHRenderBuffer<uint32_t>> GInstanceIndexBuffer[GMaxFrameInFlight];
+// GPU-driven draws
+UniquePtr<UHRenderBuffer<UHDrawIndexedIndirectCommand>> GIndirectDrawBuffer[GMaxFrameInFlight];
+UniquePtr<UHRenderBuffer<uint32_t>> GIndirectCountBuffer[GMaxFrameInFlight];
+UniquePtr<UHRenderBuffer<UHIndirectCullData>> GIndirectCullDataBuffer[GMaxFrameInFlight];
 // instance lights buffer
 UniquePtr<UHRenderBuffer<UHInstanceLights>> GInstanceLightsBuffer[GMaxFrameInFlight];
 
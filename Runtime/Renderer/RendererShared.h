@@ -5,20 +5,21 @@
 #include "../Classes/Sampler.h"
 #include "../Classes/TextureCube.h"
 #include "../Classes/AccelerationStructure.h"
+#include "../Classes/IndirectDrawBuilder.h"
+#include "../Classes/LightClustering.h"
 
 // define shared resource in renderer, the goal is to reduce parameter sending between renderer and shader
 extern UniquePtr<UHRenderBuffer<UHSystemConstants>> GSystemConstantBuffer[GMaxFrameInFlight];
 extern UniquePtr<UHRenderBuffer<UHObjectConstants>> GObjectConstantBuffer[GMaxFrameInFlight];
-extern UniquePtr<UHRenderBuffer<UHObjectConstants>> GOcclusionConstantBuffer[GMaxFrameInFlight];
 extern UniquePtr<UHRenderBuffer<UHDirectionalLightConstants>> GDirectionalLightBuffer[GMaxFrameInFlight];
 extern UniquePtr<UHRenderBuffer<UHPointLightConstants>> GPointLightBuffer[GMaxFrameInFlight];
 extern UniquePtr<UHRenderBuffer<UHSpotLightConstants>> GSpotLightBuffer[GMaxFrameInFlight];
 
-// light culling
-extern UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListBuffer;
-extern UniquePtr<UHRenderBuffer<uint32_t>> GPointLightListTransBuffer;
-extern UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListBuffer;
-extern UniquePtr<UHRenderBuffer<uint32_t>> GSpotLightListTransBuffer;
+// light clustering, the grid has an entry per cluster and light type pointing into the compact index list
+// the counter is the number of indices requested by GPU clustering, it's read back to grow the index list
+extern UniquePtr<UHRenderBuffer<UHLightClusterEntry>> GLightClusterGridBuffer[GMaxFrameInFlight];
+extern UniquePtr<UHRenderBuffer<uint32_t>> GLightClusterIndexBuffer[GMaxFrameInFlight];
+extern UniquePtr<UHRenderBuffer<uint32_t>> GLightClusterCounterBuffer[GMaxFrameInFlight];
 
 // render textures
 extern UHRenderTexture* GSceneDiffuse;
@@ -59,8 +60,17 @@ extern UHTexture2D* GBlackTexture;
 extern UHTexture2D* GWhiteTexture;
 extern UHTextureCube* GBlackCube;
 
-// occlusion data
+// occlusion data, a visible flag per renderer and the Hi-Z pyramid of scene depth
 extern UniquePtr<UHRenderBuffer<uint32_t>> GOcclusionResult[GMaxFrameInFlight];
+extern UHRenderTexture* GHiZBuffer;
+
+// renderer indices of instanced draws, indexed by SV_InstanceID
+extern UniquePtr<UHRenderBuffer<uint32_t>> GInstanceIndexBuffer[GMaxFrameInFlight];
+
+// GPU-driven draws, indirect commands per visible renderer, draw counts per bucket and cull data per renderer
+extern UniquePtr<UHRenderBuffer<UHDrawIndexedIndirectCommand>> GIndirectDrawBuffer[GMaxFrameInFlight];
+extern UniquePtr<UHRenderBuffer<uint32_t>> GIndirectCountBuffer[GMaxFrameInFlight];
+extern UniquePtr<UHRenderBuffer<UHIndirectCullData>> GIndirectCullDataBuffer[GMaxFrameInFlight];
 
 // instance lights buffer
 extern UniquePtr<UHRenderBuffer<UHInstanceLights>> GInstanceLightsBuffer[GMaxFrameInFlight];
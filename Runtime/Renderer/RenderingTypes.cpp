@@ -70,6 +70,26 @@ bool UHRenderPassInfo::operator==(const UHRenderPassInfo& InInfo)
 		&& InInfo.bEnableColorWrite == bEnableColorWrite;
 }
 
+size_t UHRenderPassInfo::GetHash() const
+{
+	size_t Hash = 0;
+	UHUtilities::HashCombine(Hash, CullMode);
+	UHUtilities::HashCombine(Hash, BlendMode);
+	UHUtilities::HashCombine(Hash, RenderPass);
+	UHUtilities::HashCombine(Hash, VS);
+	UHUtilities::HashCombine(Hash, PS);
+	UHUtilities::HashCombine(Hash, GS);
+	UHUtilities::HashCombine(Hash, MS);
+	UHUtilities::HashCombine(Hash, RTCount);
+	UHUtilities::HashCombine(Hash, PipelineLayout);
+	UHUtilities::HashCombine(Hash, bDrawLine);
+	UHUtilities::HashCombine(Hash, bDrawWireFrame);
+	UHUtilities::HashCombine(Hash, bForceBlendOff);
+	UHUtilities::HashCombine(Hash, bEnableColorWrite);
+
+	return Hash;
+}
+
 
 // ---------------------------------------------------- UHComputePassInfo
 UHComputePassInfo::UHComputePassInfo()
@@ -94,6 +114,15 @@ bool UHComputePassInfo::operator==(const UHComputePassInfo& InInfo)
 	return bCSEqual && InInfo.PipelineLayout == PipelineLayout;
 }
 
+size_t UHComputePassInfo::GetHash() const
+{
+	size_t Hash = 0;
+	UHUtilities::HashCombine(Hash, CS);
+	UHUtilities::HashCombine(Hash, PipelineLayout);
+
+	return Hash;
+}
+
 
 // ---------------------------------------------------- UHRayTracingInfo
 UHRayTracingInfo::UHRayTracingInfo()
@@ -155,6 +184,29 @@ bool UHRayTracingInfo::operator==(const UHRayTracingInfo& InInfo)
 		&& InInfo.AttributeSize == AttributeSize;
 }
 
+size_t UHRayTracingInfo::GetHash() const
+{
+	size_t Hash = 0;
+	UHUtilities::HashCombine(Hash, RayGenShader);
+	for (const uint32_t Shader : ClosestHitShaders)
+	{
+		UHUtilities::HashCombine(Hash, Shader);
+	}
+
+	for (const uint32_t Shader : AnyHitShaders)
+	{
+		UHUtilities::HashCombine(Hash, Shader);
+	}
+
+	UHUtilities::HashCombine(Hash, MissShader);
+	UHUtilities::HashCombine(Hash, PipelineLayout);
+	UHUtilities::HashCombine(Hash, MaxRecursionDepth);
+	UHUtilities::HashCombine(Hash, PayloadSize);
+	UHUtilities::HashCombine(Hash, AttributeSize);
+
+	return Hash;
+}
+
 
 // ---------------------------------------------------- UHRenderPassObject
 UHRenderPassObject::UHRenderPassObject()
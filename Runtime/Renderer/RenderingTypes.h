@@ -58,11 +58,11 @@ struct UHSystemConstants
 	float GJitterScaleMin;
 	float GJitterScaleFactor;
 	uint32_t GNumPointLights;
-	uint32_t GLightTileCountX;
+	uint32_t GLightClusterCountX;
 
-	uint32_t GMaxPointLightPerTile;
+	uint32_t GLightClusterCountY;
 	uint32_t GNumSpotLights;
-	uint32_t GMaxSpotLightPerTile;
+	uint32_t GLightClusterIndexCapacity;
 	uint32_t GFrameNumber;
 	
 	// the feature shall be able to store up to 32 flag bits without issues
@@ -90,6 +90,11 @@ struct UHSystemConstants
 	float GPCSSBlockerDistScale;
 	uint32_t GMaxReflectionRecursion;
 	float GScreenMipCount;
+
+	float GLightClusterSliceScale;
+	float GLightClusterSliceBias;
+	float GLightClusterProjScaleX;
+	float GLightClusterProjScaleY;
 };
 
 struct UHObjectConstants
@@ -100,9 +105,14 @@ struct UHObjectConstants
 	uint32_t InstanceIndex;
 	XMFLOAT3 WorldPos;
 	XMFLOAT3 BoundExtent;
-	
+	uint32_t VertexFormat;
+	// mesh bound that compressed positions are relative to, the padding keeps float3 in the same 16-byte row as HLSL cbuffer
+	XMFLOAT3 MeshBoundCenter;
+	float MeshBoundPadding;
+	XMFLOAT3 MeshBoundExtent;
+
 	// align to 256 bytes
-	float CPUPadding[9];
+	float CPUPadding;
 };
 
 struct UHDirectionalLightConstants
@@ -152,32 +162,6 @@ struct UHSphericalHarmonicConstants
 	float Weight; // this should be set as 4.0f * PI / SampleCount in C++ side
 };
 
-enum class UHRenderPassTypes
-{
-	OcclusionResolve = 0,
-	DepthPrePass,
-	OcclusionPass,
-	BasePass,
-	UpdateTopLevelAS,
-	CollectLightPass,
-	GenerateSH9,
-	RayTracingShadow,
-	SmoothReflectVectorPass,
-	RayTracingReflection,
-	LightCulling,
-	LightPass,
-	SkyPass,
-	MotionPass,
-	PreReflectionPass,
-	ReflectionPass,
-	TranslucentPass,
-	ToneMappingPass,
-	TemporalAAPass,
-	HistoryCopyingPass,
-	PresentToSwapChain,
-	UHRenderPassMax
-};
-
 struct UHDepthInfo
 {
 	bool bEnableDepthTest;
@@ -206,6 +190,9 @@ struct UHRenderPassInfo
 
 	bool operator==(const UHRenderPassInfo& InInfo);
 
+	// hash of the members compared in operator==
+	size_t GetHash() const;
+
 	UHCullMode CullMode;
 	UHBlendMode BlendMode;
 	VkRenderPass RenderPass;
@@ -231,6 +218,7 @@ struct UHComputePassInfo
 	UHComputePassInfo(VkPipelineLayout InPipelineLayout);
 
 	bool operator==(const UHComputePassInfo& InInfo);
+	size_t GetHash() const;
 
 	uint32_t CS;
 	VkPipelineLayout PipelineLayout;
@@ -242,6 +230,7 @@ struct UHRayTracingInfo
 	UHRayTracingInfo();
 
 	bool operator==(const UHRayTracingInfo& InInfo);
+	size_t GetHash() const;
 
 	VkPipelineLayout PipelineLayout;
 	uint32_t MaxRecursionDepth;
@@ -346,6 +335,8 @@ struct UHRendererInstance
 {
 	uint32_t MeshIndex;
 	uint32_t IndiceType;
+	uint32_t VertexFormat;
+	uint32_t MaterialIndex;
 };
 
 // mesh shader data
@@ -356,6 +347,69 @@ struct UHMeshShaderData
 	uint32_t bDoOcclusionTest;
 };
 
+// push constants of amplification shader, NumMeshShaderData is the number of mesh shader data to dispatch
+// the amplification shader is dispatched as RoundUpDivide(NumMeshShaderData, GMeshShaderGroupSize)
+// group size needs to sync with MESHSHADER_GROUP_SIZE in UHMeshShaderCommon.hlsli
+const uint32_t GMeshShaderGroupSize = 126;
+struct UHMeshShaderConstants
+{
+	uint32_t NumMeshShaderData;
+	uint32_t bEnableConeCulling;
+	uint32_t OcclusionPhase;
+};
+
+// two-phase occlusion culling of amplification shader, needs to sync with UH_OCCLUSION_PHASE_* in UHMeshShaderCommon.hlsli
+// renderers visible in the previous result are drawn first, then the others are tested against the Hi-Z of them
+// and the disoccluded ones are drawn, the renderers that skip occlusion test are always drawn except in the disoccluded phase
+enum class UHOcclusionPhase : uint32_t
+{
+	// draw all renderers
+	None = 0,
+	// draw renderers visible in the previous result
+	Previous,
+	// draw renderers invisible in the previous result but visible in the current one
+	Disoccluded,
+	// draw renderers visible in the current result
+	Current
+};
+
+// CPU stages of UHDeferredShadingRenderer::Update() in the order they run
+enum class UHRendererUpdateStage : int32_t
+{
+	FrustumCulling = 0,
+	SoftwareOcclusionCulling,
+	UploadDataBuffers,
+	LightClustering,
+	CollectVisibleRenderer,
+	CollectMeshShaderInstance,
+	UpdateTextureStreaming,
+	UpdateStageMax
+};
+
+// push constants of GPU culling, one thread per renderer
+struct UHGPUCullingConstants
+{
+	uint32_t NumRenderers;
+	uint32_t bEnableOcclusion;
+	float CullingDistance;
+	uint32_t FirstInstance;
+};
+
+// push constants of Hi-Z building, one thread per output texel
+struct UHHiZConstants
+{
+	uint32_t InputSize[2];
+	uint32_t OutputSize[2];
+};
+
+// push constants of Hi-Z occlusion test, one thread per renderer
+struct UHOcclusionTestConstants
+{
+	uint32_t NumRenderers;
+	uint32_t HiZMipCount;
+	uint32_t HiZSize[2];
+};
+
 // UHInstanceLights to store light indices per-instance
 // the workflow will do intersection test in compute shader
 const uint32_t GMaxPointSpotLightPerInstance = 16;
@@ -1,5 +1,6 @@
 #include "BasePassShader.h"
 #include "../../Components/MeshRenderer.h"
+#include "../../Classes/MeshGeometryPool.h"
 #include "../RendererShared.h"
 
 UHBasePassShader::UHBasePassShader(UHGraphic* InGfx, std::string Name, VkRenderPass InRenderPass, UHMaterial* InMat, const std::vector<VkDescriptorSetLayout>& ExtraLayouts)
@@ -8,7 +9,12 @@ UHBasePassShader::UHBasePassShader(UHGraphic* InGfx, std::string Name, VkRenderP
 	// DeferredPass: Bind all constants, visiable in VS/PS only
 	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
+		{
+			// object constants are fetched per instance
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		}
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
 			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
@@ -23,6 +29,12 @@ UHBasePassShader::UHBasePassShader(UHGraphic* InGfx, std::string Name, VkRenderP
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
+	// bind instance index buffer
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// bind position buffer, positions are fetched with vertex index as the layout depends on vertex format
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	// textures and samplers will be bound on fly instead, since I go with bindless rendering
 	CreateLayoutAndDescriptor(ExtraLayouts);
 	OnCompile();
@@ -41,7 +53,7 @@ void UHBasePassShader::OnCompile()
 		return;
 	}
 
-	ShaderVS = Gfx->RequestShader("BaseVertexShader", "Shaders/BaseVertexShader.hlsl", "BaseVS", "vs_6_0", MaterialCache->GetShaderDefines());
+	ShaderVS = Gfx->RequestShader("BaseVertexShader", "Shaders/BaseVertexShader.hlsl", "BaseVS", "vs_6_0", GetInstancingDefines());
 	UHMaterialCompileData Data{};
 	Data.MaterialCache = MaterialCache;
 	ShaderPS = Gfx->RequestMaterialShader("BasePixelShader", "Shaders/BasePixelShader.hlsl", "BasePS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
@@ -63,31 +75,52 @@ void UHBasePassShader::OnCompile()
 void UHBasePassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
 
 	UHMesh* Mesh = InRenderer->GetMesh();
 	BindStorage(Mesh->GetUV0Buffer(), 3, 0, true);
 	BindStorage(Mesh->GetNormalBuffer(), 4, 0, true);
 	BindStorage(Mesh->GetTangentBuffer(), 5, 0, true);
+	BindStorage(GInstanceIndexBuffer, 6, 0, true);
+	BindStorage(Mesh->GetPositionBuffer(), 7, 0, true);
+}
+
+void UHBasePassShader::BindParameters(const UHMeshGeometryPool* InPool)
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
+	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
+
+	BindStorage(InPool->GetUV0Buffer(), 3, 0, true);
+	BindStorage(InPool->GetNormalBuffer(), 4, 0, true);
+	BindStorage(InPool->GetTangentBuffer(), 5, 0, true);
+	BindStorage(GInstanceIndexBuffer, 6, 0, true);
+	BindStorage(InPool->GetPositionBuffer(), 7, 0, true);
 }
 
 UHBaseMeshShader::UHBaseMeshShader(UHGraphic* InGfx, std::string Name, VkRenderPass InRenderPass, UHMaterial* InMat, const std::vector<VkDescriptorSetLayout>& ExtraLayouts)
 	: UHShaderClass(InGfx, Name, typeid(UHBaseMeshShader), InMat, InRenderPass)
 {
 	// system
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 	// object constant
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 	// material
 	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
-	// current mesh shader data and renderer instances
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// current mesh shader data, occlusion results of the previous and the current frame and renderer instances
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// amplification shader constants
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(UHMeshShaderConstants);
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
 
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -101,12 +134,14 @@ void UHBaseMeshShader::OnCompile()
 	{
 		// restore cached value
 		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderAS = PassInfo.AS;
 		ShaderMS = PassInfo.MS;
 		ShaderPS = PassInfo.PS;
 		MaterialPassInfo = PassInfo;
 		return;
 	}
 
+	ShaderAS = Gfx->RequestShader("BaseAmplificationShader", "Shaders/BaseAmplificationShader.hlsl", "BaseAS", "as_6_5");
 	ShaderMS = Gfx->RequestShader("BaseMeshShader", "Shaders/BaseMeshShader.hlsl", "BaseMS", "ms_6_5", MaterialCache->GetShaderDefines());
 	UHMaterialCompileData Data{};
 	Data.MaterialCache = MaterialCache;
@@ -122,6 +157,7 @@ void UHBaseMeshShader::OnCompile()
 		, ShaderPS
 		, GNumOfGBuffers
 		, PipelineLayout);
+	MaterialPassInfo.AS = ShaderAS;
 	MaterialPassInfo.MS = ShaderMS;
 
 	RecreateMaterialState();
@@ -137,13 +173,18 @@ void UHBaseMeshShader::BindParameters()
 	{
 		BindStorage(GMeshShaderData[Idx][MaterialCache->GetBufferDataIndex()].get(), 3, 0, true, Idx);
 
-		// use the occlusion result from the previous frame
+		// the previous result is for the first occlusion phase, the current result is tested against Hi-Z in this frame
 		const uint32_t PrevFrame = (Idx - 1) % GMaxFrameInFlight;
 		if (GOcclusionResult[PrevFrame] != nullptr)
 		{
-			BindStorage(GOcclusionResult[PrevFrame].get(), 4, 0, true);
+			BindStorage(GOcclusionResult[PrevFrame].get(), 4, 0, true, Idx);
+		}
+
+		if (GOcclusionResult[Idx] != nullptr)
+		{
+			BindStorage(GOcclusionResult[Idx].get(), 5, 0, true, Idx);
 		}
 	}
 
-	BindStorage(GRendererInstanceBuffer.get(), 5, 0, true);
+	BindStorage(GRendererInstanceBuffer.get(), 6, 0, true);
 }
\ No newline at end of file
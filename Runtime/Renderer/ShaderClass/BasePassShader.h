@@ -1,6 +1,7 @@
 #pragma once
 #include "ShaderClass.h"
 
+class UHMeshGeometryPool;
 class UHBasePassShader : public UHShaderClass
 {
 public:
@@ -9,6 +10,9 @@ public:
 	virtual void OnCompile() override;
 
 	void BindParameters(const UHMeshRendererComponent* InRenderer);
+
+	// for indirect draws of a material, meshes are fetched from the geometry pool
+	void BindParameters(const UHMeshGeometryPool* InPool);
 };
 
 class UHBaseMeshShader : public UHShaderClass
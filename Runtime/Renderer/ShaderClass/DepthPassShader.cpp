@@ -1,5 +1,6 @@
 #include "DepthPassShader.h"
 #include "../../Components/MeshRenderer.h"
+#include "../../Classes/MeshGeometryPool.h"
 #include "../RendererShared.h"
 
 // -------------------------------------------------------------- UHDepthPassShader
@@ -9,7 +10,12 @@ UHDepthPassShader::UHDepthPassShader(UHGraphic* InGfx, std::string Name, VkRende
 	// Depth pass: Bind all constants, visiable in VS/PS only
 	for (int32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
+		{
+			// object constants are fetched per instance
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		}
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
 			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
@@ -22,6 +28,12 @@ UHDepthPassShader::UHDepthPassShader(UHGraphic* InGfx, std::string Name, VkRende
 	// bind UV0 Buffer
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
+	// bind instance index buffer
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// bind position buffer
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	// textures and samplers will be bound on fly instead, since I go with bindless rendering
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -48,7 +60,7 @@ void UHDepthPassShader::OnCompile()
 		ShaderPS = Gfx->RequestMaterialShader("DepthPassPS", "Shaders/DepthPixelShader.hlsl", "DepthPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
 	}
 
-	ShaderVS = Gfx->RequestShader("DepthPassVS", "Shaders/DepthVertexShader.hlsl", "DepthVS", "vs_6_0", MaterialCache->GetShaderDefines());
+	ShaderVS = Gfx->RequestShader("DepthPassVS", "Shaders/DepthVertexShader.hlsl", "DepthVS", "vs_6_0", GetInstancingDefines());
 
 	// states
 	MaterialPassInfo = UHRenderPassInfo(RenderPassCache, UHDepthInfo(true, true, VK_COMPARE_OP_GREATER)
@@ -65,11 +77,24 @@ void UHDepthPassShader::OnCompile()
 void UHDepthPassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
 
 	UHMesh* Mesh = InRenderer->GetMesh();
 	BindStorage(Mesh->GetUV0Buffer(), 3, 0, true);
+	BindStorage(GInstanceIndexBuffer, 4, 0, true);
+	BindStorage(Mesh->GetPositionBuffer(), 5, 0, true);
+}
+
+void UHDepthPassShader::BindParameters(const UHMeshGeometryPool* InPool)
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
+	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
+
+	BindStorage(InPool->GetUV0Buffer(), 3, 0, true);
+	BindStorage(GInstanceIndexBuffer, 4, 0, true);
+	BindStorage(InPool->GetPositionBuffer(), 5, 0, true);
 }
 
 // -------------------------------------------------------------- UHDepthMeshShader
@@ -77,17 +102,24 @@ UHDepthMeshShader::UHDepthMeshShader(UHGraphic* InGfx, std::string Name, VkRende
 	: UHShaderClass(InGfx, Name, typeid(UHDepthMeshShader), InMat, InRenderPass)
 {
 	// system
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 	// object constant
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 	// material
 	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
-	// current mesh shader data and renderer instances
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// current mesh shader data, occlusion results of the previous and the current frame and renderer instances
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// amplification shader constants
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(UHMeshShaderConstants);
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
 
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -101,6 +133,7 @@ void UHDepthMeshShader::OnCompile()
 	{
 		// restore cached value
 		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderAS = PassInfo.AS;
 		ShaderMS = PassInfo.MS;
 		ShaderPS = PassInfo.PS;
 		MaterialPassInfo = PassInfo;
@@ -114,6 +147,7 @@ void UHDepthMeshShader::OnCompile()
 		ShaderPS = Gfx->RequestMaterialShader("DepthPassPS", "Shaders/DepthPixelShader.hlsl", "DepthPS", "ps_6_0", Data, MaterialCache->GetShaderDefines());
 	}
 
+	ShaderAS = Gfx->RequestShader("BaseAmplificationShader", "Shaders/BaseAmplificationShader.hlsl", "BaseAS", "as_6_5");
 	ShaderMS = Gfx->RequestShader("DepthMeshShader", "Shaders/DepthMeshShader.hlsl", "DepthMS", "ms_6_5", MaterialCache->GetShaderDefines());
 
 	// states
@@ -124,6 +158,7 @@ void UHDepthMeshShader::OnCompile()
 		, ShaderPS
 		, 1
 		, PipelineLayout);
+	MaterialPassInfo.AS = ShaderAS;
 	MaterialPassInfo.MS = ShaderMS;
 
 	RecreateMaterialState();
@@ -138,7 +173,19 @@ void UHDepthMeshShader::BindParameters()
 	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
 	{
 		BindStorage(GMeshShaderData[Idx][MaterialCache->GetBufferDataIndex()].get(), 3, 0, true, Idx);
+
+		// the previous result is for the first occlusion phase, the current result is tested against Hi-Z in this frame
+		const uint32_t PrevFrame = (Idx - 1) % GMaxFrameInFlight;
+		if (GOcclusionResult[PrevFrame] != nullptr)
+		{
+			BindStorage(GOcclusionResult[PrevFrame].get(), 4, 0, true, Idx);
+		}
+
+		if (GOcclusionResult[Idx] != nullptr)
+		{
+			BindStorage(GOcclusionResult[Idx].get(), 5, 0, true, Idx);
+		}
 	}
 
-	BindStorage(GRendererInstanceBuffer.get(), 4, 0, true);
+	BindStorage(GRendererInstanceBuffer.get(), 6, 0, true);
 }
\ No newline at end of file
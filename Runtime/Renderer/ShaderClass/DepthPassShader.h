@@ -2,6 +2,7 @@
 #include "ShaderClass.h"
 
 class UHMeshRendererComponent;
+class UHMeshGeometryPool;
 class UHDepthPassShader : public UHShaderClass
 {
 public:
@@ -10,6 +11,9 @@ public:
 	virtual void OnCompile() override;
 
 	void BindParameters(const UHMeshRendererComponent* InRenderer);
+
+	// for indirect draws of a material, meshes are fetched from the geometry pool
+	void BindParameters(const UHMeshGeometryPool* InPool);
 };
 
 class UHDepthMeshShader : public UHShaderClass
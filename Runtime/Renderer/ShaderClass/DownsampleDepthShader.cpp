@@ -1,14 +1,19 @@
 #include "DownsampleDepthShader.h"
-#include "../RendererShared.h"
+#include "../RenderBuilder.h"
 
-UHDownsampleDepthShader::UHDownsampleDepthShader(UHGraphic* InGfx, std::string Name)
+UHDownsampleDepthShader::UHDownsampleDepthShader(UHGraphic* InGfx, std::string Name, bool bInFromDepth)
 	: UHShaderClass(InGfx, Name, typeid(UHDownsampleDepthShader))
+	, bFromDepth(bInFromDepth)
 {
-	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	// scene depth, input mip and output mip, each variant only uses one of the inputs
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
 	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
 	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
-	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
-	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+
+	PushConstantRange.offset = 0;
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	PushConstantRange.size = sizeof(UHHiZConstants);
+	bPushDescriptor = true;
 
 	CreateLayoutAndDescriptor();
 	OnCompile();
@@ -16,7 +21,15 @@ UHDownsampleDepthShader::UHDownsampleDepthShader(UHGraphic* InGfx, std::string N
 
 void UHDownsampleDepthShader::OnCompile()
 {
-	ShaderCS = Gfx->RequestShader("HalfDownsampleDepthShader", "Shaders/DownsampleDepth.hlsl", "HalfDownsampleDepthCS", "cs_6_0");
+	if (bFromDepth)
+	{
+		ShaderCS = Gfx->RequestShader("HiZFromDepthShader", "Shaders/DownsampleDepth.hlsl", "DownsampleDepthCS", "cs_6_0"
+			, std::vector<std::string>{ "HIZ_FROM_DEPTH=1" });
+	}
+	else
+	{
+		ShaderCS = Gfx->RequestShader("HiZDownsampleShader", "Shaders/DownsampleDepth.hlsl", "DownsampleDepthCS", "cs_6_0");
+	}
 
 	// state
 	UHComputePassInfo Info(PipelineLayout);
@@ -25,12 +38,18 @@ void UHDownsampleDepthShader::OnCompile()
 	CreateComputeState(Info);
 }
 
-void UHDownsampleDepthShader::BindParameters()
+void UHDownsampleDepthShader::BindTextures(UHRenderBuilder& RenderBuilder, UHTexture* Input, UHTexture* Output, const uint32_t OutputMipIdx)
 {
-	// @TODO: Consider removing this? It's unused at the moment.
-	BindConstant(GSystemConstantBuffer, 0, 0);
-	//BindRWImage(GHalfDepth, 1);
-	//BindRWImage(GHalfTranslucentDepth, 2);
-	BindImage(GSceneDepth, 3);
-	BindImage(GSceneTranslucentDepth, 4);
+	// textures are keep changing, need to push it instead
+	if (bFromDepth)
+	{
+		PushImage(Input, 0, false, UHINDEXNONE);
+	}
+	else
+	{
+		PushImage(Input, 1, true, OutputMipIdx - 1);
+	}
+
+	PushImage(Output, 2, true, OutputMipIdx);
+	FlushPushDescriptor(RenderBuilder.GetCmdList());
 }
\ No newline at end of file
@@ -1,10 +1,17 @@
 #pragma once
 #include "ShaderClass.h"
 
+class UHRenderBuilder;
+
+// builds the Hi-Z pyramid, the variant from depth reads the scene depth and the other reads the previous mip
 class UHDownsampleDepthShader : public UHShaderClass
 {
 public:
-	UHDownsampleDepthShader(UHGraphic* InGfx, std::string Name);
+	UHDownsampleDepthShader(UHGraphic* InGfx, std::string Name, bool bInFromDepth);
 	virtual void OnCompile() override;
-	void BindParameters();
+
+	void BindTextures(UHRenderBuilder& RenderBuilder, UHTexture* Input, UHTexture* Output, const uint32_t OutputMipIdx);
+
+private:
+	bool bFromDepth;
 };
\ No newline at end of file
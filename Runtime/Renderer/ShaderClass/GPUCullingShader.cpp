@@ -0,0 +1,57 @@
+#include "GPUCullingShader.h"
+#include "../RendererShared.h"
+
+UHGPUCullingShader::UHGPUCullingShader(UHGraphic* InGfx, std::string Name)
+	: UHShaderClass(InGfx, Name, typeid(UHGPUCullingShader), nullptr)
+{
+	// bind system constants, object constants, cull data, occlusion result, output commands, instances and draw counts
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(UHGPUCullingConstants);
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHGPUCullingShader::OnCompile()
+{
+	ShaderCS = Gfx->RequestShader("GPUCullingComputeShader", "Shaders/GPUCullingComputeShader.hlsl", "GPUCullingCS", "cs_6_0");
+
+	// state
+	UHComputePassInfo Info(PipelineLayout);
+	Info.CS = ShaderCS;
+
+	CreateComputeState(Info);
+}
+
+void UHGPUCullingShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
+	BindStorage(GIndirectCullDataBuffer, 2, 0, true);
+
+	for (uint32_t Idx = 0; Idx < GMaxFrameInFlight; Idx++)
+	{
+		// use the software occlusion result of the same frame, occlusion is disabled by constants if there is no result buffer
+		if (GOcclusionResult[Idx] != nullptr)
+		{
+			BindStorage(GOcclusionResult[Idx].get(), 3, 0, true, Idx);
+		}
+		else
+		{
+			BindStorage(GIndirectCullDataBuffer[Idx].get(), 3, 0, true, Idx);
+		}
+	}
+
+	BindStorage(GIndirectDrawBuffer, 4, 0, true);
+	BindStorage(GInstanceIndexBuffer, 5, 0, true);
+	BindStorage(GIndirectCountBuffer, 6, 0, true);
+}
\ No newline at end of file
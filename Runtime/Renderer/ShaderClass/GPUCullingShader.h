@@ -0,0 +1,13 @@
+#pragma once
+#include "ShaderClass.h"
+
+// culls renderers and writes an indirect draw command per visible one, commands are compacted per bucket with its draw count
+class UHGPUCullingShader : public UHShaderClass
+{
+public:
+	UHGPUCullingShader(UHGraphic* InGfx, std::string Name);
+
+	virtual void OnCompile() override;
+
+	void BindParameters();
+};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "LightClusteringShader.h"
+#include "../RendererShared.h"
+
+UHLightClusteringShader::UHLightClusteringShader(UHGraphic* InGfx, std::string Name, std::string InEntry)
+	: UHShaderClass(InGfx, Name, typeid(UHLightClusteringShader), nullptr)
+	, EntryFunction(InEntry)
+{
+	// bind system constants, light buffers, and output cluster grid/indices/counter
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHLightClusteringShader::OnCompile()
+{
+	// entry function can vary
+	std::vector<std::string> Macro = { "USE_" + EntryFunction };
+	ShaderCS = Gfx->RequestShader("LightClusteringComputeShader", "Shaders/LightClusteringComputeShader.hlsl", EntryFunction, "cs_6_0", Macro);
+
+	// state
+	UHComputePassInfo Info(PipelineLayout);
+	Info.CS = ShaderCS;
+
+	CreateComputeState(Info);
+}
+
+void UHLightClusteringShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindStorage(GPointLightBuffer, 1, 0, true);
+	BindStorage(GSpotLightBuffer, 2, 0, true);
+	BindStorage(GLightClusterGridBuffer, 3, 0, true);
+	BindStorage(GLightClusterIndexBuffer, 4, 0, true);
+	BindStorage(GLightClusterCounterBuffer, 5, 0, true);
+}
\ No newline at end of file
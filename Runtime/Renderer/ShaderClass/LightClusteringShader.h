@@ -0,0 +1,16 @@
+#pragma once
+#include "ShaderClass.h"
+
+// light clustering passes share the same layout, the entry function decides the pass
+class UHLightClusteringShader : public UHShaderClass
+{
+public:
+	UHLightClusteringShader(UHGraphic* InGfx, std::string Name, std::string InEntry);
+
+	virtual void OnCompile() override;
+
+	void BindParameters();
+
+private:
+	std::string EntryFunction;
+};
\ No newline at end of file
@@ -57,8 +57,8 @@ void UHLightPassShader::BindParameters(const bool bIsRaytracingEnableRT)
 		BindImage(GWhiteTexture, 6);
 	}
 
-	BindStorage(GPointLightListBuffer.get(), 7, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 8, 0, true);
+	BindStorage(GLightClusterGridBuffer, 7, 0, true);
+	BindStorage(GLightClusterIndexBuffer, 8, 0, true);
 	BindStorage(GSH9Data.get(), 9, 0, true);
 	BindSampler(GPointClampedSampler, 10);
 	BindSampler(GLinearClampedSampler, 11);
@@ -6,6 +6,7 @@ UHMeshPreviewShader::UHMeshPreviewShader(UHGraphic* InGfx, std::string Name, VkR
 	: UHShaderClass(InGfx, Name, typeid(UHMeshPreviewShader), nullptr, InRenderPass)
 {
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 	CreateLayoutAndDescriptor();
 	OnCompile();
@@ -3,6 +3,15 @@
 
 #if WITH_EDITOR
 
+// positions are fetched from the raw position buffer, so the preview works with any vertex format
+struct UHMeshPreviewConstants
+{
+	XMFLOAT4X4 ViewProj;
+	XMFLOAT3 MeshBoundCenter;
+	uint32_t VertexFormat;
+	XMFLOAT3 MeshBoundExtent;
+};
+
 class UHMeshPreviewShader : public UHShaderClass
 {
 public:
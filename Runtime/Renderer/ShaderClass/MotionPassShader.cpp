@@ -44,7 +44,12 @@ UHMotionObjectPassShader::UHMotionObjectPassShader(UHGraphic* InGfx, std::string
 	// Motion pass: constants + opacity image for cutoff (if there is any)
 	for (uint32_t Idx = 0; Idx < UH_ENUM_VALUE(UHConstantTypes::ConstantTypeMax); Idx++)
 	{
-		if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
+		if (Idx == UH_ENUM_VALUE(UHConstantTypes::Object))
+		{
+			// object constants are fetched per instance
+			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		}
+		else if (Idx != UH_ENUM_VALUE(UHConstantTypes::Material))
 		{
 			AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 		}
@@ -59,6 +64,12 @@ UHMotionObjectPassShader::UHMotionObjectPassShader(UHGraphic* InGfx, std::string
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
+	// instance index buffer
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// position buffer
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	CreateLayoutAndDescriptor(ExtraLayouts);
 	OnCompile();
 }
@@ -79,7 +90,7 @@ void UHMotionObjectPassShader::OnCompile()
 		return;
 	}
 
-	ShaderVS = Gfx->RequestShader("MotionVertexShader", "Shaders/MotionVertexShader.hlsl", "MotionObjectVS", "vs_6_0", MaterialCache->GetShaderDefines());
+	ShaderVS = Gfx->RequestShader("MotionVertexShader", "Shaders/MotionVertexShader.hlsl", "MotionObjectVS", "vs_6_0", GetInstancingDefines());
 
 	UHMaterialCompileData Data;
 	Data.MaterialCache = MaterialCache;
@@ -107,12 +118,14 @@ void UHMotionObjectPassShader::OnCompile()
 void UHMotionObjectPassShader::BindParameters(const UHMeshRendererComponent* InRenderer)
 {
 	BindConstant(GSystemConstantBuffer, 0, 0);
-	BindConstant(GObjectConstantBuffer, 1, InRenderer->GetBufferDataIndex());
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
 	BindConstant(MaterialCache->GetMaterialConst(), 2, 0);
 
 	BindStorage(InRenderer->GetMesh()->GetUV0Buffer(), 3, 0, true);
 	BindStorage(InRenderer->GetMesh()->GetNormalBuffer(), 4, 0, true);
 	BindStorage(InRenderer->GetMesh()->GetTangentBuffer(), 5, 0, true);
+	BindStorage(GInstanceIndexBuffer, 6, 0, true);
+	BindStorage(InRenderer->GetMesh()->GetPositionBuffer(), 7, 0, true);
 }
 
 // motion mesh shader
@@ -120,18 +133,24 @@ UHMotionMeshShader::UHMotionMeshShader(UHGraphic* InGfx, std::string Name, VkRen
 	: UHShaderClass(InGfx, Name, typeid(UHMotionMeshShader), InMat, InRenderPass)
 {
 	// system
-	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
 	// object constant
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 	// material
 	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 
-	// current mesh shader data and renderer instances
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// current mesh shader data, occlusion results of the previous and the current frame and renderer instances
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	// amplification shader constants
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(UHMeshShaderConstants);
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
 
 	CreateLayoutAndDescriptor(ExtraLayouts);
 
@@ -148,12 +167,14 @@ void UHMotionMeshShader::OnCompile()
 	{
 		// restore cached value
 		const UHRenderPassInfo& PassInfo = GetState()->GetRenderPassInfo();
+		ShaderAS = PassInfo.AS;
 		ShaderMS = PassInfo.MS;
 		ShaderPS = PassInfo.PS;
 		MaterialPassInfo = PassInfo;
 		return;
 	}
 
+	ShaderAS = Gfx->RequestShader("BaseAmplificationShader", "Shaders/BaseAmplificationShader.hlsl", "BaseAS", "as_6_5");
 	ShaderMS = Gfx->RequestShader("MotionMeshShader", "Shaders/MotionMeshShader.hlsl", "MotionMS", "ms_6_5", MaterialCache->GetShaderDefines());
 
 	UHMaterialCompileData Data;
@@ -169,6 +190,7 @@ void UHMotionMeshShader::OnCompile()
 		, ShaderPS
 		, bIsTranslucent ? GNumOfGBuffersTrans : 1
 		, PipelineLayout);
+	MaterialPassInfo.AS = ShaderAS;
 	MaterialPassInfo.MS = ShaderMS;
 
 	// disable blending intentionally if it's translucent
@@ -197,13 +219,18 @@ void UHMotionMeshShader::BindParameters()
 			BindStorage(GMotionTranslucentShaderData[Idx][MaterialCache->GetBufferDataIndex()].get(), 3, 0, true, Idx);
 		}
 
-		// use the occlusion result from the previous frame
+		// the previous result is for the first occlusion phase, the current result is tested against Hi-Z in this frame
 		const uint32_t PrevFrame = (Idx - 1) % GMaxFrameInFlight;
 		if (GOcclusionResult[PrevFrame] != nullptr)
 		{
-			BindStorage(GOcclusionResult[PrevFrame].get(), 4, 0, true);
+			BindStorage(GOcclusionResult[PrevFrame].get(), 4, 0, true, Idx);
+		}
+
+		if (GOcclusionResult[Idx] != nullptr)
+		{
+			BindStorage(GOcclusionResult[Idx].get(), 5, 0, true, Idx);
 		}
 	}
 
-	BindStorage(GRendererInstanceBuffer.get(), 5, 0, true);
+	BindStorage(GRendererInstanceBuffer.get(), 6, 0, true);
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "OcclusionTestShader.h"
+#include "../RendererShared.h"
+
+UHOcclusionTestShader::UHOcclusionTestShader(UHGraphic* InGfx, std::string Name)
+	: UHShaderClass(InGfx, Name, typeid(UHOcclusionTestShader), nullptr)
+{
+	// bind system constants, object constants, Hi-Z and the occlusion result
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+	AddLayoutBinding(1, VK_SHADER_STAGE_COMPUTE_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+	PushConstantRange.offset = 0;
+	PushConstantRange.size = sizeof(UHOcclusionTestConstants);
+	PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	CreateLayoutAndDescriptor();
+	OnCompile();
+}
+
+void UHOcclusionTestShader::OnCompile()
+{
+	ShaderCS = Gfx->RequestShader("OcclusionTestComputeShader", "Shaders/OcclusionTestComputeShader.hlsl", "OcclusionTestCS", "cs_6_0");
+
+	// state
+	UHComputePassInfo Info(PipelineLayout);
+	Info.CS = ShaderCS;
+
+	CreateComputeState(Info);
+}
+
+void UHOcclusionTestShader::BindParameters()
+{
+	BindConstant(GSystemConstantBuffer, 0, 0);
+	BindStorage(GObjectConstantBuffer, 1, 0, true);
+	BindImage(GHiZBuffer, 2);
+
+	// each frame writes its own result, the amplification shader reads the current and the previous one
+	BindStorage(GOcclusionResult, 3, 0, true);
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+#include "ShaderClass.h"
+
+// tests the bound of each renderer against the Hi-Z pyramid, used when mesh shader is supported
+class UHOcclusionTestShader : public UHShaderClass
+{
+public:
+	UHOcclusionTestShader(UHGraphic* InGfx, std::string Name);
+
+	virtual void OnCompile() override;
+
+	void BindParameters();
+};
\ No newline at end of file
@@ -98,8 +98,8 @@ void UHRTReflectionShader::BindParameters()
 
 	// shadow mask and lighting list
 	BindStorage(GInstanceLightsBuffer, 14, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 15, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 16, 0, true);
+	BindStorage(GLightClusterGridBuffer, 15, 0, true);
+	BindStorage(GLightClusterIndexBuffer, 16, 0, true);
 	BindSkyCube();
 
 	BindSampler(GPointClampedSampler, 18);
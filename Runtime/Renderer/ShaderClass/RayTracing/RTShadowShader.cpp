@@ -14,9 +14,7 @@ UHRTShadowShader::UHRTShadowShader(UHGraphic* InGfx, std::string Name
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
 
-	// dir light/point light/spot light/point light culling list (opaque + translucent)/spot light culling list (O+T)
-	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	// dir light/point light/spot light/light cluster grid/light cluster indices
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	AddLayoutBinding(1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
@@ -72,15 +70,13 @@ void UHRTShadowShader::BindParameters()
 	BindStorage(GDirectionalLightBuffer, 3, 0, true);
 	BindStorage(GPointLightBuffer, 4, 0, true);
 	BindStorage(GSpotLightBuffer, 5, 0, true);
-	BindStorage(GPointLightListBuffer.get(), 6, 0, true);
-	BindStorage(GPointLightListTransBuffer.get(), 7, 0, true);
-	BindStorage(GSpotLightListBuffer.get(), 8, 0, true);
-	BindStorage(GSpotLightListTransBuffer.get(), 9, 0, true);
+	BindStorage(GLightClusterGridBuffer, 6, 0, true);
+	BindStorage(GLightClusterIndexBuffer, 7, 0, true);
 
 	// translucent buffers and samplers
-	BindImage(GSceneMip, 10);
-	BindImage(GSceneTranslucentDepth, 11);
-	BindImage(GSceneVertexNormal, 12);
-	BindSampler(GPointClampedSampler, 13);
-	BindSampler(GLinearClampedSampler, 14);
+	BindImage(GSceneMip, 8);
+	BindImage(GSceneTranslucentDepth, 9);
+	BindImage(GSceneVertexNormal, 10);
+	BindSampler(GPointClampedSampler, 11);
+	BindSampler(GLinearClampedSampler, 12);
 }
\ No newline at end of file
@@ -6,9 +6,9 @@ std::unordered_map<std::type_index, VkDescriptorSetLayout> UHShaderClass::Descri
 std::unordered_map<std::type_index, VkPipelineLayout> UHShaderClass::PipelineLayoutTable;
 
 // graphic state table, the material is a bit more complicated since it could be involded in different passes
-std::unordered_map<uint32_t, UHGraphicState*> UHShaderClass::GraphicStateTable;
-std::unordered_map<uint32_t, std::unordered_map<std::type_index, UHGraphicState*>> UHShaderClass::MaterialStateTable;
-std::unordered_map<uint32_t, UHComputeState*> UHShaderClass::ComputeStateTable;
+std::unordered_map<uint32_t, UHResourceHandle> UHShaderClass::GraphicStateTable;
+std::unordered_map<uint32_t, std::unordered_map<std::type_index, UHResourceHandle>> UHShaderClass::MaterialStateTable;
+std::unordered_map<uint32_t, UHResourceHandle> UHShaderClass::ComputeStateTable;
 
 #define CLEAR_EMPTY_MAPENTRY(x, y) if (x[y].size() == 0) x.erase(y);
 
@@ -47,7 +47,7 @@ UHShaderClass::UHShaderClass(UHGraphic* InGfx, std::string InName, std::type_ind
 	, MissShader(UHINDEXNONE)
 	, ShaderAS(UHINDEXNONE)
 	, ShaderMS(UHINDEXNONE)
-	, RTState(nullptr)
+	, RTState(UHResourceHandle())
 	, RayGenTable(nullptr)
 	, HitGroupTable(nullptr)
 	, RenderPassCache(InRenderPass)
@@ -104,10 +104,10 @@ void UHShaderClass::Release()
 		}
 	}
 
-	if (RTState != nullptr)
+	if (RTState.IsValid())
 	{
 		Gfx->RequestReleaseGraphicState(RTState);
-		RTState = nullptr;
+		RTState = UHResourceHandle();
 	}
 
 	UH_SAFE_RELEASE(RayGenTable);
@@ -312,6 +312,13 @@ void UHShaderClass::RecreateMaterialState()
 	CreateMaterialState(MaterialPassInfo);
 }
 
+std::vector<std::string> UHShaderClass::GetInstancingDefines() const
+{
+	std::vector<std::string> Defines = MaterialCache->GetShaderDefines();
+	Defines.push_back("UH_INSTANCING");
+	return Defines;
+}
+
 void UHShaderClass::SetNewMaterialCache(UHMaterial* InMat)
 {
 	MaterialCache = InMat;
@@ -351,24 +358,24 @@ UHGraphicState* UHShaderClass::GetState() const
 		{
 			if (MaterialStateTable[MatId].find(TypeIndexCache) != MaterialStateTable[MatId].end())
 			{
-				return MaterialStateTable[MaterialCache->GetId()][TypeIndexCache];
+				return Gfx->GetGraphicState(MaterialStateTable[MaterialCache->GetId()][TypeIndexCache]);
 			}
 		}
 
 		return nullptr;
 	}
 
-	return GraphicStateTable[GetId()];
+	return Gfx->GetGraphicState(GraphicStateTable[GetId()]);
 }
 
 UHGraphicState* UHShaderClass::GetRTState() const
 {
-	return RTState;
+	return Gfx->GetGraphicState(RTState);
 }
 
 UHComputeState* UHShaderClass::GetComputeState() const
 {
-	return ComputeStateTable[GetId()];
+	return Gfx->GetGraphicState(ComputeStateTable[GetId()]);
 }
 
 UHMaterial* UHShaderClass::GetMaterialCache() const
@@ -571,7 +578,7 @@ void UHShaderClass::CreateComputeState(UHComputePassInfo InInfo)
 void UHShaderClass::InitRayGenTable()
 {
 	std::vector<BYTE> TempData(Gfx->GetShaderRecordSize());
-	if (GVkGetRayTracingShaderGroupHandlesKHR(Gfx->GetLogicalDevice(), RTState->GetRTPipeline(), GRayGenTableSlot, 1, Gfx->GetShaderRecordSize(), TempData.data()) != VK_SUCCESS)
+	if (GVkGetRayTracingShaderGroupHandlesKHR(Gfx->GetLogicalDevice(), GetRTState()->GetRTPipeline(), GRayGenTableSlot, 1, Gfx->GetShaderRecordSize(), TempData.data()) != VK_SUCCESS)
 	{
 		UHE_LOG(L"Failed to get ray gen group handle!\n");
 	}
@@ -586,7 +593,7 @@ void UHShaderClass::InitMissTable()
 	std::vector<BYTE> TempData(Gfx->GetShaderRecordSize());
 
 	// get data for HG as well
-	if (GVkGetRayTracingShaderGroupHandlesKHR(Gfx->GetLogicalDevice(), RTState->GetRTPipeline(), GMissTableSlot, 1, Gfx->GetShaderRecordSize(), TempData.data()) != VK_SUCCESS)
+	if (GVkGetRayTracingShaderGroupHandlesKHR(Gfx->GetLogicalDevice(), GetRTState()->GetRTPipeline(), GMissTableSlot, 1, Gfx->GetShaderRecordSize(), TempData.data()) != VK_SUCCESS)
 	{
 		UHE_LOG(L"Failed to get hit group handle!\n");
 	}
@@ -609,7 +616,7 @@ void UHShaderClass::InitHitGroupTable(size_t NumMaterials)
 	for (size_t Idx = 0; Idx < NumMaterials; Idx++)
 	{
 		// copy hit group
-		if (GVkGetRayTracingShaderGroupHandlesKHR(Gfx->GetLogicalDevice(), RTState->GetRTPipeline(), GHitGroupTableSlot + static_cast<uint32_t>(Idx), 1, Gfx->GetShaderRecordSize(), TempData.data()) != VK_SUCCESS)
+		if (GVkGetRayTracingShaderGroupHandlesKHR(Gfx->GetLogicalDevice(), GetRTState()->GetRTPipeline(), GHitGroupTableSlot + static_cast<uint32_t>(Idx), 1, Gfx->GetShaderRecordSize(), TempData.data()) != VK_SUCCESS)
 		{
 			UHE_LOG(L"Failed to get hit group handle!\n");
 			continue;
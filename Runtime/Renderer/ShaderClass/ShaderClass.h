@@ -205,6 +205,9 @@ protected:
 	void CreateMaterialState(UHRenderPassInfo InInfo);
 	void CreateComputeState(UHComputePassInfo InInfo);
 
+	// material defines for vertex shaders drawn with instanced batches, they fetch object constants by SV_InstanceID
+	std::vector<std::string> GetInstancingDefines() const;
+
 	// ray tracing functions
 	void InitRayGenTable();
 	void InitMissTable();
@@ -232,7 +235,7 @@ protected:
 	uint32_t ShaderAS;
 	uint32_t ShaderMS;
 
-	UHGraphicState* RTState;
+	UHResourceHandle RTState;
 
 	// shader table
 	UniquePtr<UHRenderBuffer<UHShaderRecord>> RayGenTable;
@@ -252,7 +255,8 @@ private:
 	static std::unordered_map<std::type_index, VkPipelineLayout> PipelineLayoutTable;
 
 	// graphic state table, the material is a bit more complicated since it could be involded in different passes
-	static std::unordered_map<uint32_t, UHGraphicState*> GraphicStateTable;
-	static std::unordered_map<uint32_t, std::unordered_map<std::type_index, UHGraphicState*>> MaterialStateTable;
-	static std::unordered_map<uint32_t, UHComputeState*> ComputeStateTable;
+	// the tables store pool handles, a state released by the pool resolves to nullptr in the getters
+	static std::unordered_map<uint32_t, UHResourceHandle> GraphicStateTable;
+	static std::unordered_map<uint32_t, std::unordered_map<std::type_index, UHResourceHandle>> MaterialStateTable;
+	static std::unordered_map<uint32_t, UHResourceHandle> ComputeStateTable;
 };
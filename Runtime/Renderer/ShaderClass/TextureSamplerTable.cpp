@@ -16,6 +16,12 @@ uint32_t UHTextureTable::GetNumTexes() const
 	return NumTexes;
 }
 
+void UHTextureTable::UpdateTexture(const UHTexture* InTexture, uint32_t InSlot, uint32_t InFrameIdx)
+{
+	UHDescriptorHelper Helper(Gfx->GetLogicalDevice(), DescriptorSets[InFrameIdx]);
+	Helper.WriteImageArrayElement(InTexture, 0, InSlot);
+}
+
 // UHSamplerTable
 UHSamplerTable::UHSamplerTable(UHGraphic* InGfx, std::string Name, uint32_t NumSamplers)
 	: UHShaderClass(InGfx, Name, typeid(UHSamplerTable), nullptr)
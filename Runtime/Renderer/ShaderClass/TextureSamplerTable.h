@@ -12,6 +12,9 @@ public:
 	virtual void OnCompile() override {}
 
 	uint32_t GetNumTexes() const;
+
+	// rewrite a single slot of a frame, the caller makes sure the descriptor set of that frame isn't in use by GPU
+	void UpdateTexture(const UHTexture* InTexture, uint32_t InSlot, uint32_t InFrameIdx);
 	static uint32_t MaxNumTexes;
 private:
 	uint32_t NumTexes;
@@ -39,6 +39,9 @@ UHTranslucentPassShader::UHTranslucentPassShader(UHGraphic* InGfx, std::string N
 	// Bind envcube and sampler
 	AddLayoutBinding(1, VK_SHADER_STAGE_FRAGMENT_BIT, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
 
+	// bind position buffer, it's after the fragment resources as they share the base vertex shader
+	AddLayoutBinding(1, VK_SHADER_STAGE_VERTEX_BIT, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
 	// textures and samplers will be bound on fly instead, since I go with bindless rendering
 	CreateLayoutAndDescriptor(ExtraLayouts);
 	OnCompile();
@@ -86,6 +89,7 @@ void UHTranslucentPassShader::BindParameters(const UHMeshRendererComponent* InRe
 	BindStorage(Mesh->GetUV0Buffer(), 3, 0, true);
 	BindStorage(Mesh->GetNormalBuffer(), 4, 0, true);
 	BindStorage(Mesh->GetTangentBuffer(), 5, 0, true);
+	BindStorage(Mesh->GetPositionBuffer(), 15, 0, true);
 
 	// bind light const
 	BindStorage(GDirectionalLightBuffer, 6, 0, true);
@@ -103,8 +107,8 @@ void UHTranslucentPassShader::BindParameters(const UHMeshRendererComponent* InRe
 		BindImage(GBlackTexture, 10);
 	}
 
-	BindStorage(GPointLightListTransBuffer.get(), 11, 0, true);
-	BindStorage(GSpotLightListTransBuffer.get(), 12, 0, true);
+	BindStorage(GLightClusterGridBuffer, 11, 0, true);
+	BindStorage(GLightClusterIndexBuffer, 12, 0, true);
 	BindStorage(GSH9Data.get(), 13, 0, true);
 	BindSkyCube();
 }
@@ -52,7 +52,7 @@ void UHDeferredShadingRenderer::GenerateSH9Pass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("GenerateSH9Pass", false);
 	// generate SH9, this doesn't need to be called every frame
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::GenerateSH9)], "GenerateSH9");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "GenerateSH9");
 	if (!bIsSkyLightEnabledRT || !bNeedGenerateSH9RT)
 	{
 		return;
@@ -71,7 +71,7 @@ void UHDeferredShadingRenderer::GenerateSH9Pass(UHRenderBuilder& RenderBuilder)
 void UHDeferredShadingRenderer::RenderSkyPass(UHRenderBuilder& RenderBuilder)
 {
 	UHGameTimerScope Scope("RenderSkyPass", false);
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::SkyPass)], "SkyPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "SkyPass");
 	if (!bIsSkyLightEnabledRT)
 	{
 		return;
@@ -91,7 +91,7 @@ void UHDeferredShadingRenderer::RenderSkyPass(UHRenderBuilder& RenderBuilder)
 		// bind sets
 		RenderBuilder.BindDescriptorSet(SkyPassShader->GetPipelineLayout(), SkyPassShader->GetDescriptorSet(CurrentFrameRT));
 
-		// draw skybox renderer
+		// draw skybox renderer, the builtin cube stays in full format as the sky shader reads float3 positions from the vertex input
 		RenderBuilder.BindVertexBuffer(CubeMesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(CubeMesh);
 		RenderBuilder.DrawIndexed(CubeMesh->GetIndicesCount());
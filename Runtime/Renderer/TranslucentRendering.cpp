@@ -1,22 +1,5 @@
 #include "DeferredShadingRenderer.h"
 
-class UHTranslucentPassAsyncTask : public UHAsyncTask
-{
-public:
-	void Init(UHDeferredShadingRenderer* InRenderer)
-	{
-		SceneRenderer = InRenderer;
-	}
-
-	virtual void DoTask(const int32_t ThreadIdx) override
-	{
-		SceneRenderer->TranslucentPassTask(ThreadIdx);
-	}
-
-private:
-	UHDeferredShadingRenderer* SceneRenderer = nullptr;
-};
-
 void UHDeferredShadingRenderer::ScreenshotForRefraction(std::string PassName, UHRenderBuilder& RenderBuilder)
 {
 	// blit the scene result to opaque scene result
@@ -39,7 +22,7 @@ void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBui
 	{
 		return;
 	}
-	UHGPUTimeQueryScope TimeScope(RenderBuilder.GetCmdList(), GPUTimeQueries[UH_ENUM_VALUE(UHRenderPassTypes::TranslucentPass)], "TranslucentPass");
+	UHGPUTimeQueryScope TimeScope(RenderBuilder, "TranslucentPass");
 
 	// this pass doesn't need a RT clear, will draw on scene result directly
 	GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing Translucent Pass");
@@ -53,35 +36,18 @@ void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBui
 		// Draw the translucent background
 		{
 			RenderBuilder.BeginRenderPass(TranslucentPassObj, RenderResolution, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
-#if WITH_EDITOR
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
+			for (int32_t I = 0; I < NumParallelBundles; I++)
 			{
-				ThreadDrawCalls[I] = 0;
-				ThreadOccludedCalls[I] = 0;
+				BundleDrawCalls[I] = 0;
 			}
-#endif
 
-			// init and wake tasks
-			static UHTranslucentPassAsyncTask Tasks[GMaxWorkerThreads];
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
-			{
-				Tasks[I].Init(this);
-				WorkerThreads[I]->ScheduleTask(&Tasks[I]);
-				WorkerThreads[I]->WakeThread();
-			}
+			// record all bundles with job system
+			RecordParallelBundles(&UHDeferredShadingRenderer::TranslucentPassTask);
 
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
+			for (int32_t I = 0; I < NumParallelBundles; I++)
 			{
-				WorkerThreads[I]->WaitTask();
+				RenderBuilder.DrawCalls += BundleDrawCalls[I];
 			}
-
-#if WITH_EDITOR
-			for (int32_t I = 0; I < NumWorkerThreads; I++)
-			{
-				RenderBuilder.DrawCalls += ThreadDrawCalls[I];
-				RenderBuilder.OccludedCalls += ThreadOccludedCalls[I];
-			}
-#endif
 			// execute all recorded batches
 			RenderBuilder.ExecuteBundles(TranslucentParallelSubmitter);
 			RenderBuilder.EndRenderPass();
@@ -92,21 +58,20 @@ void UHDeferredShadingRenderer::RenderTranslucentPass(UHRenderBuilder& RenderBui
 	GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 }
 
-void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
+void UHDeferredShadingRenderer::TranslucentPassTask(int32_t BundleIdx)
 {
-	// simply separate buffer recording into N threads
+	// simply separate buffer recording into N bundles
 	const int32_t MaxCount = static_cast<int32_t>(TranslucentsToRender.size());
-	const int32_t RendererCount = (MaxCount + NumWorkerThreads) / NumWorkerThreads;
-	const int32_t StartIdx = std::min(RendererCount * ThreadIdx, MaxCount);
-	const int32_t EndIdx = (ThreadIdx == NumWorkerThreads - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
+	const int32_t RendererCount = (MaxCount + NumParallelBundles) / NumParallelBundles;
+	const int32_t StartIdx = std::min(RendererCount * BundleIdx, MaxCount);
+	const int32_t EndIdx = (BundleIdx == NumParallelBundles - 1) ? MaxCount : std::min(StartIdx + RendererCount, MaxCount);
 
 	VkCommandBufferInheritanceInfo InheritanceInfo{};
 	InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
 	InheritanceInfo.renderPass = TranslucentPassObj.RenderPass;
 	InheritanceInfo.framebuffer = TranslucentPassObj.FrameBuffer;
-	InheritanceInfo.occlusionQueryEnable = bEnableHWOcclusionRT;
 
-	UHRenderBuilder RenderBuilder(GraphicInterface, TranslucentParallelSubmitter.WorkerCommandBuffers[ThreadIdx * GMaxFrameInFlight + CurrentFrameRT]);
+	UHRenderBuilder RenderBuilder(GraphicInterface, TranslucentParallelSubmitter.WorkerCommandBuffers[BundleIdx * GMaxFrameInFlight + CurrentFrameRT]);
 	if (StartIdx >= EndIdx)
 	{
 		RenderBuilder.BeginCommandBuffer(&InheritanceInfo);
@@ -126,7 +91,6 @@ void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
 		RenderBuilder.BindDescriptorSet(TranslucentPassShaders.begin()->second->GetPipelineLayout(), TextureTableSets, GTextureTableSpace);
 	}
 
-	const uint32_t PrevFrame = (CurrentFrameRT - 1) % GMaxFrameInFlight;
 	for (int32_t I = StartIdx; I < EndIdx; I++)
 	{
 		const UHMeshRendererComponent* Renderer = TranslucentsToRender[I];
@@ -138,34 +102,18 @@ void UHDeferredShadingRenderer::TranslucentPassTask(int32_t ThreadIdx)
 		GraphicInterface->BeginCmdDebug(RenderBuilder.GetCmdList(), "Drawing " + Mesh->GetName() + " (Tris: " +
 			std::to_string(TriCount) + ")");
 
-		// occlusion test for big meshes
-		const bool bOcclusionTest = bEnableHWOcclusionRT && TriCount >= OcclusionThresholdRT && !Renderer->IsCameraInsideThisRenderer();
-		if (bOcclusionTest)
-		{
-			RenderBuilder.BeginPredication(RendererIdx, GOcclusionResult[PrevFrame]->GetBuffer());
-		}
-
 		// draw mesh
 		const UHTranslucentPassShader* TranslucentShader = TranslucentPassShaders[RendererIdx].get();
 		RenderBuilder.BindGraphicState(TranslucentShader->GetState());
-		RenderBuilder.BindVertexBuffer(Mesh->GetPositionBuffer()->GetBuffer());
 		RenderBuilder.BindIndexBuffer(Mesh);
 		RenderBuilder.BindDescriptorSet(TranslucentShader->GetPipelineLayout(), TranslucentShader->GetDescriptorSet(CurrentFrameRT));
 
 		RenderBuilder.DrawIndexed(Mesh->GetIndicesCount());
 
-		if (bOcclusionTest)
-		{
-			RenderBuilder.EndPredication();
-		}
-
 		GraphicInterface->EndCmdDebug(RenderBuilder.GetCmdList());
 	}
 
 	RenderBuilder.EndCommandBuffer();
 
-#if WITH_EDITOR
-	ThreadDrawCalls[ThreadIdx] += RenderBuilder.DrawCalls;
-	ThreadOccludedCalls[ThreadIdx] += RenderBuilder.OccludedCalls;
-#endif
+	BundleDrawCalls[BundleIdx] += RenderBuilder.DrawCalls;
 }
\ No newline at end of file
@@ -3,33 +3,124 @@
 #include "../Shaders/UHCommon.hlsli"
 #include "../Shaders/UHMeshShaderCommon.hlsli"
 
-// for occlusion test in AS
+// object constants
+StructuredBuffer<ObjectConstants> RendererConstants : register(t1);
+
+// for occlusion test in AS, the results of the previous and the current frame
 StructuredBuffer<UHMeshShaderData> MeshShaderData : register(t3);
-ByteAddressBuffer OcclusionResult : register(t4);
+ByteAddressBuffer PrevOcclusionResult : register(t4);
+ByteAddressBuffer OcclusionResult : register(t5);
+StructuredBuffer<UHRendererInstance> RendererInstances : register(t6);
+
+StructuredBuffer<UHMeshlet> Meshlets[] : register(t0, space3);
+
+[[vk::push_constant]] UHMeshShaderConstants MeshShaderConstants;
 
 groupshared uint GVisibleCount;
 groupshared UHMeshPayload Payload;
 
-// C++ side: Dispatch as (TotalMeshlets / MESHSHADER_GROUP_SIZE)
+bool IsRendererVisible(UHMeshShaderData InData)
+{
+    UHBRANCH
+    if (MeshShaderConstants.OcclusionPhase == UH_OCCLUSION_PHASE_NONE)
+    {
+        return true;
+    }
+
+    bool bPrevVisible = InData.bDoOcclusionTest == 0 || PrevOcclusionResult.Load(InData.RendererIndex * 4) > 0;
+    if (MeshShaderConstants.OcclusionPhase == UH_OCCLUSION_PHASE_PREVIOUS)
+    {
+        return bPrevVisible;
+    }
+
+    bool bVisible = InData.bDoOcclusionTest == 0 || OcclusionResult.Load(InData.RendererIndex * 4) > 0;
+    if (MeshShaderConstants.OcclusionPhase == UH_OCCLUSION_PHASE_DISOCCLUDED)
+    {
+        // the renderers drawn in the previous phase are skipped
+        return !bPrevVisible && bVisible;
+    }
+
+    return bVisible;
+}
+
+bool IsMeshletVisible(UHMeshlet InMeshlet, ObjectConstants InConstant)
+{
+    // bounding sphere to world space, scaled by the largest axis
+    float3 Center = mul(float4(InMeshlet.BoundCenter, 1.0f), InConstant.GWorld).xyz;
+    float3 AxisScale = float3(length(InConstant.GWorld[0].xyz), length(InConstant.GWorld[1].xyz), length(InConstant.GWorld[2].xyz));
+    float MaxScale = max(AxisScale.x, max(AxisScale.y, AxisScale.z));
+    float Radius = InMeshlet.BoundRadius * MaxScale;
+
+    // frustum test against the side planes, planes are extracted from the columns of view projection
+    float4x4 ViewProjT = transpose(GViewProj_NonJittered);
+    float4 Planes[4] =
+    {
+        ViewProjT[3] + ViewProjT[0],
+        ViewProjT[3] - ViewProjT[0],
+        ViewProjT[3] + ViewProjT[1],
+        ViewProjT[3] - ViewProjT[1]
+    };
+
+    UHUNROLL
+    for (uint Idx = 0; Idx < 4; Idx++)
+    {
+        if (dot(Planes[Idx], float4(Center, 1.0f)) < -Radius * length(Planes[Idx].xyz))
+        {
+            return false;
+        }
+    }
+
+    // normal cone test, the cone is only valid for uniform scale without mirroring
+    float MinScale = min(AxisScale.x, min(AxisScale.y, AxisScale.z));
+    bool bValidCone = MeshShaderConstants.bEnableConeCulling == 1 && InMeshlet.ConeCutoff < 1.0f
+        && MaxScale < MinScale * 1.01f && determinant((float3x3)InConstant.GWorld) > 0;
+
+    if (bValidCone)
+    {
+        float3 ConeAxis = normalize(mul(InMeshlet.ConeAxis, (float3x3)InConstant.GWorld));
+        float3 ViewDir = Center - GCameraPos;
+        if (dot(ViewDir, ConeAxis) >= InMeshlet.ConeCutoff * length(ViewDir) + Radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// C++ side: Dispatch as RoundUpDivide(TotalMeshlets, MESHSHADER_GROUP_SIZE)
 [NumThreads(MESHSHADER_GROUP_SIZE, 1, 1)]
 void BaseAS(uint DTid : SV_DispatchThreadID, uint GTid : SV_GroupThreadID)
-{    
+{
     if (GTid == 0)
     {
         GVisibleCount = 0;
     }
     GroupMemoryBarrierWithGroupSync();
-    
-    // @TODO: Check if DTid exceeds MeshShaderData count.
-    
-    // count unoccluded meshlets to dispatch
-    UHMeshShaderData ShaderData = MeshShaderData[DTid];
-    if (ShaderData.bDoOcclusionTest == 0 || OcclusionResult.Load(ShaderData.RendererIndex * 4) > 0)
+
+    bool bVisible = false;
+    if (DTid < MeshShaderConstants.NumMeshShaderData)
+    {
+        // object occlusion test first, then the meshlet culling
+        UHMeshShaderData ShaderData = MeshShaderData[DTid];
+        bVisible = IsRendererVisible(ShaderData);
+
+        if (bVisible)
+        {
+            UHRendererInstance InInstance = RendererInstances[ShaderData.RendererIndex];
+            UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][ShaderData.MeshletIndex];
+            bVisible = IsMeshletVisible(Meshlet, RendererConstants[ShaderData.RendererIndex]);
+        }
+    }
+
+    // count visible meshlets to dispatch
+    if (bVisible)
     {
         uint StoreIdx = 0;
         InterlockedAdd(GVisibleCount, 1, StoreIdx);
         Payload.ShaderDataIndices[StoreIdx] = DTid;
     }
-    
+    GroupMemoryBarrierWithGroupSync();
+
     DispatchMesh(GVisibleCount, 1, 1, Payload);
 }
\ No newline at end of file
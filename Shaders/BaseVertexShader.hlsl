@@ -1,14 +1,25 @@
 #include "UHInputs.hlsli"
 #include "UHCommon.hlsli"
 
-StructuredBuffer<float2> UV0Buffer : register(t3);
-StructuredBuffer<float3> NormalBuffer : register(t4);
-StructuredBuffer<float4> TangentBuffer : register(t5);
+// the position buffer follows the fragment resources in translucent pass, and follows the instance index buffer in base pass
+#if TRANSLUCENT
+#define UHPOSITION_BIND t15
+#else
+#define UHPOSITION_BIND t7
+#endif
 
-VertexOutput BaseVS(float3 Position : POSITION, uint Vid : SV_VertexID)
+// vertex streams, decoded with GVertexFormat
+ByteAddressBuffer UV0Buffer : register(t3);
+ByteAddressBuffer NormalBuffer : register(t4);
+ByteAddressBuffer TangentBuffer : register(t5);
+ByteAddressBuffer PositionBuffer : register(UHPOSITION_BIND);
+
+VertexOutput BaseVS(uint Vid : SV_VertexID, uint InstanceID : SV_InstanceID)
 {
 	VertexOutput Vout = (VertexOutput)0;
+	LoadInstanceConstants(InstanceID);
 
+	float3 Position = LoadVertexPosition(PositionBuffer, Vid, GVertexFormat, GMeshBoundCenter, GMeshBoundExtent);
 	float3 WorldPos = mul(float4(Position, 1.0f), GWorld).xyz;
 
 	// calculate jitter
@@ -17,15 +28,15 @@ VertexOutput BaseVS(float3 Position : POSITION, uint Vid : SV_VertexID)
 	// pass through the vertex data
 	Vout.Position = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
 	Vout.Position = mul(Vout.Position, JitterMatrix);
-	Vout.UV0 = UV0Buffer[Vid];
+	Vout.UV0 = LoadVertexUV0(UV0Buffer, Vid, GVertexFormat);
+
+	// transform normal by world IT
+    Vout.Normal = LocalToWorldNormal(LoadVertexNormal(NormalBuffer, Vid, GVertexFormat));
 
 #if TANGENT_SPACE
 	// calculate world TBN if normal map is used
-    Vout.WorldTBN = CreateTBN(LocalToWorldNormal(NormalBuffer[Vid]), TangentBuffer[Vid]);
+    Vout.WorldTBN = CreateTBN(Vout.Normal, LoadVertexTangent(TangentBuffer, Vid, GVertexFormat));
 #endif
-
-	// transform normal by world IT
-    Vout.Normal = LocalToWorldNormal(NormalBuffer[Vid]);
 #if TRANSLUCENT
 	Vout.WorldPos = WorldPos;
 #endif
@@ -7,7 +7,7 @@
 StructuredBuffer<ObjectConstants> RendererConstants : register(t1);
 
 // mesh shader data to lookup renderer index & meshlet index
-// this should be accessed via Gid, since C++ side is dispatching (TotalMeshlets,1,1)
+// this should be accessed via the payload from amplification shader, which stores the indices of unculled data
 StructuredBuffer<UHMeshShaderData> MeshShaderData : register(t3);
 
 // renderer instances
@@ -15,9 +15,9 @@ StructuredBuffer<UHRendererInstance> RendererInstances : register(t4);
 
 // all mesh data, fetched by mesh index first
 StructuredBuffer<UHMeshlet> Meshlets[] : register(t0, space3);
-StructuredBuffer<float3> PositionBuffer[] : register(t0, space4);
-StructuredBuffer<float2> UV0Buffer[] : register(t0, space5);
-ByteAddressBuffer IndicesBuffer[] : register(t0, space6);
+ByteAddressBuffer PositionBuffer[] : register(t0, space4);
+ByteAddressBuffer UV0Buffer[] : register(t0, space5);
+ByteAddressBuffer MeshletIndices[] : register(t0, space6);
 
 // entry point for mesh shader
 // each group should process all verts and prims of a meshlet, up to MESHSHADER_MAX_VERTEX & MESHSHADER_MAX_PRIMITIVE
@@ -26,12 +26,13 @@ ByteAddressBuffer IndicesBuffer[] : register(t0, space6);
 void DepthMS(
     uint Gid : SV_GroupID,
     uint GTid : SV_GroupThreadID,
+    in payload UHMeshPayload Payload,
     out vertices DepthVertexOutput OutVerts[MESHSHADER_MAX_VERTEX],
     out indices uint3 OutTris[MESHSHADER_MAX_PRIMITIVE]
 )
 {
     // fetch data and set mesh outputs
-    UHMeshShaderData ShaderData = MeshShaderData[Gid];
+    UHMeshShaderData ShaderData = MeshShaderData[Payload.ShaderDataIndices[Gid]];
     UHRendererInstance InInstance = RendererInstances[ShaderData.RendererIndex];
     UHMeshlet Meshlet = Meshlets[InInstance.MeshIndex][ShaderData.MeshletIndex];
     
@@ -40,27 +41,26 @@ void DepthMS(
     // output triangles first
     if (GTid < Meshlet.PrimitiveCount)
     {
-        // output triangle indices in order, the vertex output below will get the correct unique vertex to output
-        // so I don't need to mess around here
-        OutTris[GTid] = uint3(GTid * 3 + 0, GTid * 3 + 1, GTid * 3 + 2);
+        // output local indices of the triangle, they index to the unique vertices output below
+        OutTris[GTid] = GetMeshletPrimitive(MeshletIndices[InInstance.MeshIndex], Meshlet, GTid);
     }
     
     // output vertrex next
     if (GTid < Meshlet.VertexCount)
     {
         // convert local index to vertex index, and lookup the corresponding vertex
-        // it's like outputting the "IndicesData" in UHMesh class, which holds the unique vertex indices
-        uint VertexIndex = GetVertexIndex(IndicesBuffer[InInstance.MeshIndex], GTid + Meshlet.VertexOffset, InInstance.IndiceType);
+        uint VertexIndex = GetMeshletVertexIndex(MeshletIndices[InInstance.MeshIndex], Meshlet, GTid);
         
         // fetch vertex data and output
         DepthVertexOutput Output = (DepthVertexOutput)0;
-        Output.Position.xyz = PositionBuffer[InInstance.MeshIndex][VertexIndex];
+        ObjectConstants Constant = RendererConstants[ShaderData.RendererIndex];
+        Output.Position.xyz = LoadVertexPosition(PositionBuffer[InInstance.MeshIndex], VertexIndex, InInstance.VertexFormat
+            , Constant.GMeshBoundCenter, Constant.GMeshBoundExtent);
 #if MASKED
-        Output.UV0 = UV0Buffer[InInstance.MeshIndex][VertexIndex];
+        Output.UV0 = LoadVertexUV0(UV0Buffer[InInstance.MeshIndex], VertexIndex, InInstance.VertexFormat);
 #endif
         
         // transformation
-        ObjectConstants Constant = RendererConstants[ShaderData.RendererIndex];
         float3 WorldPos = mul(float4(Output.Position.xyz, 1.0f), Constant.GWorld).xyz;
 
         float4x4 JitterMatrix = GetDistanceScaledJitterMatrix(length(WorldPos - GCameraPos));
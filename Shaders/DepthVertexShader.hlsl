@@ -1,12 +1,17 @@
+// the instance index buffer follows UV0 buffer in depth pass
+#define UHINSTANCE_BIND t4
 #include "../Shaders/UHInputs.hlsli"
 #include "../Shaders/UHCommon.hlsli"
 
-StructuredBuffer<float2> UV0Buffer : register(t3);
+ByteAddressBuffer UV0Buffer : register(t3);
+ByteAddressBuffer PositionBuffer : register(t5);
 
-DepthVertexOutput DepthVS(float3 Position : POSITION, uint Vid : SV_VertexID)
+DepthVertexOutput DepthVS(uint Vid : SV_VertexID, uint InstanceID : SV_InstanceID)
 {
 	DepthVertexOutput Vout = (DepthVertexOutput)0;
+	LoadInstanceConstants(InstanceID);
 
+	float3 Position = LoadVertexPosition(PositionBuffer, Vid, GVertexFormat, GMeshBoundCenter, GMeshBoundExtent);
 	float3 WorldPos = mul(float4(Position, 1.0f), GWorld).xyz;
 
 	// calculate jitter
@@ -16,7 +21,7 @@ DepthVertexOutput DepthVS(float3 Position : POSITION, uint Vid : SV_VertexID)
 	Vout.Position = mul(float4(WorldPos, 1.0f), GViewProj_NonJittered);
 	Vout.Position = mul(Vout.Position, JitterMatrix);
 #if MASKED
-	Vout.UV0 = UV0Buffer[Vid];
+	Vout.UV0 = LoadVertexUV0(UV0Buffer, Vid, GVertexFormat);
 #endif
 
 	return Vout;
@@ -1,48 +1,57 @@
 #include "UHInputs.hlsli"
 
-// shader for downsampling depth buffer properly
-RWTexture2D<float> Result : register(u1);
-RWTexture2D<float> TranslucentResult : register(u2);
-Texture2D InDepth : register(t3);
-Texture2D InTranslucentDepth : register(t4);
+// shader for building the Hi-Z pyramid of occlusion culling
+// a texel keeps the farthest depth of its footprint, which is the min value with reversed-z
+// the first level reads the scene depth, the others read the previous level as storage image
+#ifndef HIZ_FROM_DEPTH
+#define HIZ_FROM_DEPTH 0
+#endif
+
+Texture2D InDepth : register(t0);
+RWTexture2D<float> InputMip : register(u1);
+RWTexture2D<float> OutputMip : register(u2);
+
+// push constants, must be the same as UHHiZConstants
+struct UHHiZConstants
+{
+    uint2 InputSize;
+    uint2 OutputSize;
+};
+[[vk::push_constant]] UHHiZConstants HiZConstants;
 
-static const uint DownsampleFactor = 2;
+float LoadInputDepth(uint2 Pos)
+{
+#if HIZ_FROM_DEPTH
+    return InDepth[Pos].r;
+#else
+    return InputMip[Pos];
+#endif
+}
 
 [numthreads(UHTHREAD_GROUP2D_X, UHTHREAD_GROUP2D_Y, 1)]
-void HalfDownsampleDepthCS(uint3 DTid : SV_DispatchThreadID)
+void DownsampleDepthCS(uint3 DTid : SV_DispatchThreadID)
 {
-    if (DTid.x * DownsampleFactor >= GResolution.x || DTid.y * DownsampleFactor >= GResolution.y)
+    if (DTid.x >= HiZConstants.OutputSize.x || DTid.y >= HiZConstants.OutputSize.y)
     {
         return;
     }
 
-    // find the max depth in a 2x2 box
-    float OutDepth = 0.0f;
-
-    for (int I = 0; I <= 1; I++)
-    {
-        for (int J = 0; J <= 1; J++)
-        {
-            int2 DepthPos = DTid.xy * DownsampleFactor + int2(I, J);
-            DepthPos = min(DepthPos, GResolution.xy - 1);
-            OutDepth = max(OutDepth, InDepth[DepthPos].r);
-        }
-    }
-
-    Result[DTid.xy] = OutDepth;
-
-    // translucent depth
-    float OutTranslucentDepth = 0.0f;
+    // the footprint is 2x2, the last row and column also cover the remainder of odd sizes
+    // so the farthest depth of the edges is never lost
+    uint2 LastInput = HiZConstants.InputSize - 1;
+    uint2 Start = min(DTid.xy * 2, LastInput);
+    uint2 End = min(Start + 1, LastInput);
+    End.x = (DTid.x == HiZConstants.OutputSize.x - 1) ? LastInput.x : End.x;
+    End.y = (DTid.y == HiZConstants.OutputSize.y - 1) ? LastInput.y : End.y;
 
-    for (I = 0; I <= 1; I++)
+    float OutDepth = 1.0f;
+    for (uint Y = Start.y; Y <= End.y; Y++)
     {
-        for (int J = 0; J <= 1; J++)
+        for (uint X = Start.x; X <= End.x; X++)
         {
-            int2 DepthPos = DTid.xy * DownsampleFactor + int2(I, J);
-            DepthPos = min(DepthPos, GResolution.xy - 1);
-            OutTranslucentDepth = max(OutTranslucentDepth, InTranslucentDepth[DepthPos].r);
+            OutDepth = min(OutDepth, LoadInputDepth(uint2(X, Y)));
         }
     }
 
-    TranslucentResult[DTid.xy] = OutTranslucentDepth;
+    OutputMip[DTid.xy] = OutDepth;
 }
\ No newline at end of file
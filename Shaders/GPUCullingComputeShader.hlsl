@@ -0,0 +1,103 @@
+// GPU culling for indirect draws in UHE, used when mesh shader isn't supported
+#include "../Shaders/UHInputs.hlsli"
+#include "../Shaders/UHCommon.hlsli"
+#include "../Shaders/UHMeshShaderCommon.hlsli"
+
+// per renderer cull data, BucketIndex is -1 for renderers not drawn indirectly, must be the same as UHIndirectCullData
+struct UHIndirectCullData
+{
+    int BucketIndex;
+    uint FirstCommand;
+    uint IndexCount;
+    uint FirstIndex;
+    int VertexOffset;
+};
+
+// push constants, must be the same as UHGPUCullingConstants
+struct UHGPUCullingConstants
+{
+    uint NumRenderers;
+    uint bEnableOcclusion;
+    float CullingDistance;
+    uint FirstInstance;
+};
+
+StructuredBuffer<ObjectConstants> RendererConstants : register(t1);
+StructuredBuffer<UHIndirectCullData> CullData : register(t2);
+ByteAddressBuffer OcclusionResult : register(t3);
+
+// a VkDrawIndexedIndirectCommand per visible renderer, appended to the command range of its bucket
+// draw counts are per bucket and cleared before this shader, indirect count draws consume both
+RWByteAddressBuffer OutDrawCommands : register(u4);
+RWByteAddressBuffer OutInstances : register(u5);
+RWByteAddressBuffer OutDrawCounts : register(u6);
+
+[[vk::push_constant]] UHGPUCullingConstants CullingConstants;
+
+#define UH_INDIRECT_COMMAND_SIZE 20
+
+bool IsBoxVisible(float3 Center, float3 Extent)
+{
+    // side planes and the near plane of reversed-z from the columns of view projection, far plane is infinite
+    float4x4 ViewProjT = transpose(GViewProj_NonJittered);
+    float4 Planes[5] =
+    {
+        ViewProjT[3] + ViewProjT[0],
+        ViewProjT[3] - ViewProjT[0],
+        ViewProjT[3] + ViewProjT[1],
+        ViewProjT[3] - ViewProjT[1],
+        ViewProjT[3] - ViewProjT[2]
+    };
+
+    UHUNROLL
+    for (uint Idx = 0; Idx < 5; Idx++)
+    {
+        if (dot(Planes[Idx], float4(Center, 1.0f)) < -dot(abs(Planes[Idx].xyz), Extent))
+        {
+            return false;
+        }
+    }
+
+    // culling distance works as the far plane, the same as CPU culling
+    float FarDist = CullingConstants.CullingDistance - dot(GCameraDir, Center - GCameraPos);
+    return FarDist >= -dot(abs(GCameraDir), Extent);
+}
+
+[numthreads(UHTHREAD_GROUP1D, 1, 1)]
+void GPUCullingCS(uint DTid : SV_DispatchThreadID)
+{
+    if (DTid >= CullingConstants.NumRenderers)
+    {
+        return;
+    }
+
+    UHIndirectCullData Data = CullData[DTid];
+    if (Data.BucketIndex < 0)
+    {
+        return;
+    }
+
+    ObjectConstants Constant = RendererConstants[DTid];
+    if (!IsBoxVisible(Constant.GWorldPos, Constant.GBoundExtent))
+    {
+        return;
+    }
+
+    // the occlusion result is from software occlusion culling of this frame, Hi-Z isn't built for the indirect path
+    // renderers are never occluded when the camera is inside their bound, so the result can be used as it is
+    if (CullingConstants.bEnableOcclusion && OcclusionResult.Load(DTid * 4) == 0)
+    {
+        return;
+    }
+
+    // append to the bucket, the command range of a bucket is as large as its renderer count so it never overflows
+    uint Slot = 0;
+    OutDrawCounts.InterlockedAdd(Data.BucketIndex * 4, 1, Slot);
+
+    uint CommandIdx = Data.FirstCommand + Slot;
+    uint InstanceIdx = CullingConstants.FirstInstance + CommandIdx;
+    uint CommandOffset = CommandIdx * UH_INDIRECT_COMMAND_SIZE;
+    OutDrawCommands.Store4(CommandOffset, uint4(Data.IndexCount, 1, Data.FirstIndex, asuint(Data.VertexOffset)));
+    OutDrawCommands.Store(CommandOffset + 16, InstanceIdx);
+    OutInstances.Store(InstanceIdx * 4, DTid);
+}
\ No newline at end of file
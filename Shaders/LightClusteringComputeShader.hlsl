@@ -0,0 +1,191 @@
+#define UHPOINTLIGHT_BIND t1
+#define UHSPOTLIGHT_BIND t2
+#include "UHInputs.hlsli"
+#include "UHCommon.hlsli"
+#include "UHLightCommon.hlsli"
+
+// light cluster outputs, the grid stores (offset, count) per cluster and light type, and the indices are compact lists of all clusters
+// the counter is the number of indices requested by all clusters, CPU reads it back and grows the index list when it's not enough
+// the grid and the counter will be reset every frame before the count pass
+RWByteAddressBuffer OutLightClusterGrid : register(u3);
+RWByteAddressBuffer OutLightClusterIndices : register(u4);
+RWByteAddressBuffer OutLightClusterCounter : register(u5);
+
+// the bounding sphere of a light, lights are indexed as point lights first and spot lights second
+bool GetLightSphere(uint InIndex, out uint OutLightType, out uint OutLightIndex, out float4 OutSphere)
+{
+    OutLightType = UHLIGHTCLUSTER_POINTLIGHT;
+    OutLightIndex = InIndex;
+    OutSphere = 0;
+
+    if (InIndex < GNumPointLights)
+    {
+        UHPointLight PointLight = UHPointLights[InIndex];
+        OutSphere = float4(PointLight.Position, PointLight.Radius);
+        return PointLight.bIsEnabled;
+    }
+
+    OutLightType = UHLIGHTCLUSTER_SPOTLIGHT;
+    OutLightIndex = InIndex - GNumPointLights;
+    if (OutLightIndex >= GNumSpotLights)
+    {
+        return false;
+    }
+
+    // the lit region of a spot light is a spherical sector, use the sphere through the apex and the rim for narrow cones
+    // and the sphere centered at the rim for wide cones, the same as UHLightClustering::GetSpotLightBound()
+    UHSpotLight SpotLight = UHSpotLights[OutLightIndex];
+    if (SpotLight.Angle >= UH_PI * 0.5f)
+    {
+        OutSphere = float4(SpotLight.Position, SpotLight.Radius);
+    }
+    else
+    {
+        float CosAngle = cos(SpotLight.Angle);
+        bool bWideCone = SpotLight.Angle > UH_PI * 0.25f;
+        float Offset = bWideCone ? SpotLight.Radius * CosAngle : SpotLight.Radius / (2.0f * CosAngle);
+        float Radius = bWideCone ? SpotLight.Radius * sin(SpotLight.Angle) : Offset;
+        OutSphere = float4(SpotLight.Position + SpotLight.Dir * Offset, Radius);
+    }
+
+    return SpotLight.bIsEnabled;
+}
+
+// project the tangent lines of a view space sphere on an axis, return the pixel range
+float2 GetSpherePixelRange(float InAxis, float InZ, float InRadius, float InScale, float InHalfSize)
+{
+    float T = sqrt(InAxis * InAxis + InZ * InZ - InRadius * InRadius);
+    float SlopeMin = (InAxis * T - InRadius * InZ) / (InZ * T + InRadius * InAxis);
+    float SlopeMax = (InAxis * T + InRadius * InZ) / (InZ * T - InRadius * InAxis);
+    float A = SlopeMin * InScale + InHalfSize;
+    float B = SlopeMax * InScale + InHalfSize;
+    return float2(min(A, B), max(A, B));
+}
+
+// conservative cluster range of a sphere, the same as UHLightClustering::ComputeRanges() except the slices are calculated with log2
+// lights intersecting the near plane cover the whole screen, and the range is expanded by a pixel for the jitter
+bool GetLightClusterBound(float4 InSphere, out uint3 OutMinCluster, out uint3 OutMaxCluster)
+{
+    OutMinCluster = 0;
+    OutMaxCluster = 0;
+
+    float3 ViewPos = WorldToViewPos(InSphere.xyz);
+    float Radius = InSphere.w;
+    float ZMin = ViewPos.z - Radius;
+    float ZMax = ViewPos.z + Radius;
+    if (Radius <= 0.0f || ZMax < GNearPlane)
+    {
+        return false;
+    }
+
+    float2 PixelRangeX = float2(0, GResolution.x);
+    float2 PixelRangeY = float2(0, GResolution.y);
+    if (ZMin >= GNearPlane)
+    {
+        PixelRangeX = GetSpherePixelRange(ViewPos.x, ViewPos.z, Radius, GLightClusterProjScaleX * GResolution.x * 0.5f, GResolution.x * 0.5f);
+        PixelRangeY = GetSpherePixelRange(ViewPos.y, ViewPos.z, Radius, GLightClusterProjScaleY * GResolution.y * 0.5f, GResolution.y * 0.5f);
+    }
+
+    float2 TileRangeX = (PixelRangeX + float2(-1, 1)) / UHLIGHTCLUSTER_TILESIZE;
+    float2 TileRangeY = (PixelRangeY + float2(-1, 1)) / UHLIGHTCLUSTER_TILESIZE;
+    if (TileRangeX.y < 0.0f || TileRangeX.x >= GLightClusterCountX || TileRangeY.y < 0.0f || TileRangeY.x >= GLightClusterCountY)
+    {
+        return false;
+    }
+
+    OutMinCluster.x = (uint)max(TileRangeX.x, 0.0f);
+    OutMaxCluster.x = (uint)min(TileRangeX.y, GLightClusterCountX - 1.0f);
+    OutMinCluster.y = (uint)max(TileRangeY.x, 0.0f);
+    OutMaxCluster.y = (uint)min(TileRangeY.y, GLightClusterCountY - 1.0f);
+    OutMinCluster.z = GetLightClusterSlice(ZMin);
+    OutMaxCluster.z = GetLightClusterSlice(ZMax);
+
+    return true;
+}
+
+uint GetLightClusterEntry(uint3 InCluster, uint InLightType)
+{
+    uint ClusterIndex = InCluster.x + (InCluster.y + InCluster.z * GLightClusterCountY) * GLightClusterCountX;
+    return ClusterIndex * 2 + InLightType;
+}
+
+// pass 1: one thread per light, count the lights of each cluster
+[numthreads(UHTHREAD_GROUP1D, 1, 1)]
+void LightClusterCountCS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint LightType;
+    uint LightIndex;
+    float4 Sphere;
+    uint3 MinCluster;
+    uint3 MaxCluster;
+    if (!GetLightSphere(DTid.x, LightType, LightIndex, Sphere) || !GetLightClusterBound(Sphere, MinCluster, MaxCluster))
+    {
+        return;
+    }
+
+    for (uint Z = MinCluster.z; Z <= MaxCluster.z; Z++)
+    {
+        for (uint Y = MinCluster.y; Y <= MaxCluster.y; Y++)
+        {
+            for (uint X = MinCluster.x; X <= MaxCluster.x; X++)
+            {
+                uint Entry = GetLightClusterEntry(uint3(X, Y, Z), LightType);
+                OutLightClusterGrid.InterlockedAdd(Entry * 8 + 4, 1);
+            }
+        }
+    }
+}
+
+// pass 2: one thread per entry, allocate the offset in the index list, the count is reset and accumulated again in the fill pass
+[numthreads(UHTHREAD_GROUP1D, 1, 1)]
+void LightClusterAllocateCS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint NumEntries = GLightClusterCountX * GLightClusterCountY * UHLIGHTCLUSTER_SLICES * 2;
+    if (DTid.x >= NumEntries)
+    {
+        return;
+    }
+
+    uint Count = OutLightClusterGrid.Load(DTid.x * 8 + 4);
+    uint Offset = 0;
+    if (Count > 0)
+    {
+        OutLightClusterCounter.InterlockedAdd(0, Count, Offset);
+    }
+
+    OutLightClusterGrid.Store2(DTid.x * 8, uint2(Offset, 0));
+}
+
+// pass 3: one thread per light, fill the light index to the clusters, indices beyond the capacity are dropped until the list is grown
+[numthreads(UHTHREAD_GROUP1D, 1, 1)]
+void LightClusterFillCS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint LightType;
+    uint LightIndex;
+    float4 Sphere;
+    uint3 MinCluster;
+    uint3 MaxCluster;
+    if (!GetLightSphere(DTid.x, LightType, LightIndex, Sphere) || !GetLightClusterBound(Sphere, MinCluster, MaxCluster))
+    {
+        return;
+    }
+
+    for (uint Z = MinCluster.z; Z <= MaxCluster.z; Z++)
+    {
+        for (uint Y = MinCluster.y; Y <= MaxCluster.y; Y++)
+        {
+            for (uint X = MinCluster.x; X <= MaxCluster.x; X++)
+            {
+                uint Entry = GetLightClusterEntry(uint3(X, Y, Z), LightType);
+                uint Slot;
+                OutLightClusterGrid.InterlockedAdd(Entry * 8 + 4, 1, Slot);
+
+                uint Offset = OutLightClusterGrid.Load(Entry * 8) + Slot;
+                if (Offset < GLightClusterIndexCapacity)
+                {
+                    OutLightClusterIndices.Store(Offset * 4, LightIndex);
+                }
+            }
+        }
+    }
+}
@@ -12,8 +12,8 @@
 
 RWTexture2D<float4> SceneResult : register(u5);
 Texture2D ScreenShadowTexture : register(t6);
-ByteAddressBuffer PointLightList : register(t7);
-ByteAddressBuffer SpotLightList : register(t8);
+ByteAddressBuffer LightClusterGrid : register(t7);
+ByteAddressBuffer LightClusterIndices : register(t8);
 SamplerState PointClampped : register(s10);
 SamplerState LinearClampped : register(s11);
 
@@ -73,19 +73,14 @@ void LightCS(uint3 DTid : SV_DispatchThreadID, uint3 GTid : SV_GroupThreadID)
     }
 	
     // ------------------------------------------------------------------------------------------ point lights accumulation
-	// point lights accumulation, fetch the tile index here, note that the system culls at half resolution
-    uint TileX = CoordToTileX(DTid.x);
-    uint TileY = CoordToTileY(DTid.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightList.Load(TileOffset);
-    TileOffset += 4;
+	// point lights accumulation, fetch the light cluster of this pixel here
+    uint ClusterIndex = GetLightClusterIndex(DTid.xy, WorldPos);
+    uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_POINTLIGHT);
     
     UHLOOP
-    for (Ldx = 0; Ldx < PointLightCount; Ldx++)
+    for (Ldx = 0; Ldx < LightRange.y; Ldx++)
     {
-        uint PointLightIdx = PointLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
        
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         Result += CalculatePointLight(PointLight, LightInfo);
@@ -93,15 +88,12 @@ void LightCS(uint3 DTid : SV_DispatchThreadID, uint3 GTid : SV_GroupThreadID)
     
     // ------------------------------------------------------------------------------------------ spot lights accumulation
     // similar as the point light but giving it angle attenuation as well
-    TileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightList.Load(TileOffset);
-    TileOffset += 4;
+    LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_SPOTLIGHT);
     
     UHLOOP
-    for (Ldx = 0; Ldx < SpotLightCount; Ldx++)
+    for (Ldx = 0; Ldx < LightRange.y; Ldx++)
     {
-        uint SpotLightIdx = SpotLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
         
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         Result += CalculateSpotLight(SpotLight, LightInfo);
@@ -9,11 +9,17 @@ struct VertexOut
 cbuffer MeshPreviewConstant : register(b0)
 {
 	float4x4 ViewProj;
+	float3 MeshBoundCenter;
+	uint VertexFormat;
+	float3 MeshBoundExtent;
 };
 
-VertexOut MeshPreviewVS(float3 Position : POSITION)
+ByteAddressBuffer PositionBuffer : register(t1);
+
+VertexOut MeshPreviewVS(uint Vid : SV_VertexID)
 {
 	VertexOut Vout = (VertexOut)0;
+	float3 Position = LoadVertexPosition(PositionBuffer, Vid, VertexFormat, MeshBoundCenter, MeshBoundExtent);
 	Vout.Position = mul(float4(Position, 1.0f), ViewProj);
 
 	return Vout;
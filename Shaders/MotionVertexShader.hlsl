@@ -1,14 +1,18 @@
 #include "UHInputs.hlsli"
 #include "UHCommon.hlsli"
 
-StructuredBuffer<float2> UV0Buffer : register(t3);
-StructuredBuffer<float3> NormalBuffer : register(t4);
-StructuredBuffer<float4> TangentBuffer : register(t5);
+// vertex streams, decoded with GVertexFormat
+ByteAddressBuffer UV0Buffer : register(t3);
+ByteAddressBuffer NormalBuffer : register(t4);
+ByteAddressBuffer TangentBuffer : register(t5);
+ByteAddressBuffer PositionBuffer : register(t7);
 
-MotionVertexOutput MotionObjectVS(float3 Position : POSITION, uint Vid : SV_VertexID)
+MotionVertexOutput MotionObjectVS(uint Vid : SV_VertexID, uint InstanceID : SV_InstanceID)
 {
 	MotionVertexOutput Vout = (MotionVertexOutput)0;
+	LoadInstanceConstants(InstanceID);
 
+	float3 Position = LoadVertexPosition(PositionBuffer, Vid, GVertexFormat, GMeshBoundCenter, GMeshBoundExtent);
 	float3 WorldPos = mul(float4(Position, 1.0f), GWorld).xyz;
 	float3 PrevWorldPos = mul(float4(Position, 1.0f), GPrevWorld).xyz;
 
@@ -21,15 +25,15 @@ MotionVertexOutput MotionObjectVS(float3 Position : POSITION, uint Vid : SV_Vert
 	Vout.PrevPos = mul(float4(PrevWorldPos, 1.0f), GPrevViewProj_NonJittered);
 
 	Vout.Position = mul(Vout.Position, JitterMatrix);
-	Vout.UV0 = UV0Buffer[Vid];
+	Vout.UV0 = LoadVertexUV0(UV0Buffer, Vid, GVertexFormat);
 	
 #if TRANSLUCENT
-	Vout.Normal = LocalToWorldNormal(NormalBuffer[Vid]);
+	Vout.Normal = LocalToWorldNormal(LoadVertexNormal(NormalBuffer, Vid, GVertexFormat));
 #endif
 	
 #if TANGENT_SPACE && TRANSLUCENT
 	// calculate world TBN if normal map is used
-    Vout.WorldTBN = CreateTBN(Vout.Normal, TangentBuffer[Vid]);
+    Vout.WorldTBN = CreateTBN(Vout.Normal, LoadVertexTangent(TangentBuffer, Vid, GVertexFormat));
 #endif
 
 	return Vout;
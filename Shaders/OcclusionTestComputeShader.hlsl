@@ -0,0 +1,91 @@
+// Hi-Z occlusion test in UHE, one thread per renderer
+// the result is read by the amplification shader, for the re-test of the current frame and the first phase of the next frame
+#include "../Shaders/UHInputs.hlsli"
+#include "../Shaders/UHCommon.hlsli"
+#include "../Shaders/UHMeshShaderCommon.hlsli"
+
+// push constants, must be the same as UHOcclusionTestConstants
+struct UHOcclusionTestConstants
+{
+    uint NumRenderers;
+    uint HiZMipCount;
+    uint2 HiZSize;
+};
+
+StructuredBuffer<ObjectConstants> RendererConstants : register(t1);
+Texture2D HiZTexture : register(t2);
+RWByteAddressBuffer OutOcclusionResult : register(u3);
+
+[[vk::push_constant]] UHOcclusionTestConstants OcclusionConstants;
+
+bool IsBoxVisible(float3 Center, float3 Extent)
+{
+    float2 MinUV = 1e8f;
+    float2 MaxUV = -1e8f;
+    float NearestDepth = 0.0f;
+
+    UHUNROLL
+    for (uint Idx = 0; Idx < 8; Idx++)
+    {
+        float3 Corner = Center + Extent * float3((Idx & 1) ? 1.0f : -1.0f, (Idx & 2) ? 1.0f : -1.0f, (Idx & 4) ? 1.0f : -1.0f);
+        float4 ClipPos = mul(float4(Corner, 1.0f), GViewProj);
+
+        // boxes crossing the near plane are always visible
+        if (ClipPos.w <= 0.0f || ClipPos.z > ClipPos.w)
+        {
+            return true;
+        }
+
+        float3 NDCPos = ClipPos.xyz / ClipPos.w;
+        float2 UV = NDCPos.xy * 0.5f + 0.5f;
+        MinUV = min(MinUV, UV);
+        MaxUV = max(MaxUV, UV);
+        NearestDepth = max(NearestDepth, NDCPos.z);
+    }
+
+    // the rest is left to frustum culling
+    if (any(MaxUV < 0.0f) || any(MinUV > 1.0f))
+    {
+        return true;
+    }
+
+    // texels of the scene depth, then the level where the rect covers 2x2 texels at most
+    // level 0 is the scene depth itself and Hi-Z mip 0 is level 1
+    int2 DepthSize = int2(GResolution.xy);
+    int2 MinTexel = clamp(int2(saturate(MinUV) * DepthSize), 0, DepthSize - 1);
+    int2 MaxTexel = clamp(int2(saturate(MaxUV) * DepthSize), 0, DepthSize - 1);
+    int MaxSpan = max(max(MaxTexel.x - MinTexel.x, MaxTexel.y - MinTexel.y), 1);
+    uint Level = max((uint)ceil(log2((float)MaxSpan)), 1);
+    uint Mip = min(Level - 1, OcclusionConstants.HiZMipCount - 1);
+
+    // the last texel of a level covers the remainder of odd sizes, so texels are clamped instead of scaled
+    int2 MipSize = max(int2(OcclusionConstants.HiZSize >> Mip), 1);
+    MinTexel = min(MinTexel >> (Mip + 1), MipSize - 1);
+    MaxTexel = min(MaxTexel >> (Mip + 1), MipSize - 1);
+
+    float FarthestDepth = 1.0f;
+    UHLOOP
+    for (int Y = MinTexel.y; Y <= MaxTexel.y; Y++)
+    {
+        UHLOOP
+        for (int X = MinTexel.x; X <= MaxTexel.x; X++)
+        {
+            FarthestDepth = min(FarthestDepth, HiZTexture.Load(int3(X, Y, Mip)).r);
+        }
+    }
+
+    // visible when the nearest point of the box isn't behind the farthest depth, reversed-z
+    return NearestDepth >= FarthestDepth;
+}
+
+[numthreads(UHTHREAD_GROUP1D, 1, 1)]
+void OcclusionTestCS(uint DTid : SV_DispatchThreadID)
+{
+    if (DTid >= OcclusionConstants.NumRenderers)
+    {
+        return;
+    }
+
+    ObjectConstants Constant = RendererConstants[DTid];
+    OutOcclusionResult.Store(DTid * 4, IsBoxVisible(Constant.GWorldPos, Constant.GBoundExtent) ? 1 : 0);
+}
\ No newline at end of file
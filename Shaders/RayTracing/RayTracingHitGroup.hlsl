@@ -11,17 +11,19 @@ RaytracingAccelerationStructure TLAS : register(t1);
 Texture2D UHTextureTable[] : register(t0, space1);
 SamplerState UHSamplerTable[] : register(t0, space2);
 
-// mesh instance data, access it with InstanceIndex() first, then use the info stored for other indexing or condition
+// mesh instance data, access it with InstanceID() first, then use the info stored for other indexing or condition
+// InstanceID() is the renderer index, as instances of TLAS are compacted and InstanceIndex() changes when instances are culled
 StructuredBuffer<UHRendererInstance> UHRendererInstances : register(t0, space3);
 
 // VB & IB data, access them with UHRendererInstance.MeshIndex
-StructuredBuffer<float2> UHUV0Table[] : register(t0, space4);
-StructuredBuffer<float3> UHNormalTable[] : register(t0, space5);
-StructuredBuffer<float4> UHTangentTable[] : register(t0, space6);
+// vertex streams are decoded with UHRendererInstance.VertexFormat
+ByteAddressBuffer UHUV0Table[] : register(t0, space4);
+ByteAddressBuffer UHNormalTable[] : register(t0, space5);
+ByteAddressBuffer UHTangentTable[] : register(t0, space6);
 ByteAddressBuffer UHIndicesTable[] : register(t0, space7);
 
 // another descriptor array for matching, since Vulkan doesn't implement local descriptor yet, I need this to fetch data
-// access via InstanceID()[0] first, the data will be filled by the systtem on C++ side
+// access via UHRendererInstance.MaterialIndex first, the data will be filled by the systtem on C++ side
 // max number of data member: 128 scalars for now
 struct MaterialData
 {
@@ -58,7 +60,7 @@ void UnpackMaterialData(MaterialData MatData, inout MaterialUsage Usages)
 // get material input, the simple version that has opacity only
 UHMaterialInputs GetMaterialOpacity(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[InstanceID()][0];
+    MaterialData MatData = UHMaterialDataTable[UHRendererInstances[InstanceID()].MaterialIndex][0];
     UnpackMaterialData(MatData, Usages);
 	
 	// TextureIndexStart in TextureNode.cpp decides where the first index of texture will start in MaterialData.Data[]
@@ -70,7 +72,7 @@ UHMaterialInputs GetMaterialOpacity(float2 UV0, float MipLevel, out MaterialUsag
 // get only the bump normal from the material
 UHMaterialInputs GetMaterialBumpNormal(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[InstanceID()][0];
+    MaterialData MatData = UHMaterialDataTable[UHRendererInstances[InstanceID()].MaterialIndex][0];
     UnpackMaterialData(MatData, Usages);
     
     // material input code will be generated in C++ side
@@ -80,7 +82,7 @@ UHMaterialInputs GetMaterialBumpNormal(float2 UV0, float MipLevel, out MaterialU
 // get only the emissive from the material
 UHMaterialInputs GetMaterialEmissive(float2 UV0, float MipLevel)
 {
-    MaterialData MatData = UHMaterialDataTable[InstanceID()][0];
+    MaterialData MatData = UHMaterialDataTable[UHRendererInstances[InstanceID()].MaterialIndex][0];
     
     // material input code will be generated in C++ side
 	//%UHS_INPUT_EmissiveOnly
@@ -89,7 +91,7 @@ UHMaterialInputs GetMaterialEmissive(float2 UV0, float MipLevel)
 // get material input fully
 UHMaterialInputs GetMaterialInput(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[InstanceID()][0];
+    MaterialData MatData = UHMaterialDataTable[UHRendererInstances[InstanceID()].MaterialIndex][0];
     UnpackMaterialData(MatData, Usages);
     
     // material input code will be generated in C++ side
@@ -98,7 +100,7 @@ UHMaterialInputs GetMaterialInput(float2 UV0, float MipLevel, out MaterialUsage
 
 UHMaterialInputs GetMaterialSmoothness(float2 UV0, float MipLevel, out MaterialUsage Usages)
 {
-    MaterialData MatData = UHMaterialDataTable[InstanceID()][0];
+    MaterialData MatData = UHMaterialDataTable[UHRendererInstances[InstanceID()].MaterialIndex][0];
     UnpackMaterialData(MatData, Usages);
     
     // material input code will be generated in C++ side
@@ -107,7 +109,7 @@ UHMaterialInputs GetMaterialSmoothness(float2 UV0, float MipLevel, out MaterialU
 
 uint3 GetIndex(in uint PrimIndex)
 {
-    UHRendererInstance RendererInstances = UHRendererInstances[InstanceIndex()];
+    UHRendererInstance RendererInstances = UHRendererInstances[InstanceID()];
     ByteAddressBuffer Indices = UHIndicesTable[RendererInstances.MeshIndex];
 	
     // get index data based on indice type, it can be 16 or 32 bit
@@ -147,43 +149,61 @@ uint3 GetIndex(in uint PrimIndex)
 
 float2 GetHitUV0(uint PrimIndex, Attribute Attr)
 {
-    UHRendererInstance RendererInstances = UHRendererInstances[InstanceIndex()];
+    UHRendererInstance RendererInstances = UHRendererInstances[InstanceID()];
     uint3 Index = GetIndex(PrimIndex);
 
-    StructuredBuffer<float2> UV0 = UHUV0Table[RendererInstances.MeshIndex];
+    ByteAddressBuffer UV0Buffer = UHUV0Table[RendererInstances.MeshIndex];
+    float2 UV0[3];
+    UHUNROLL
+    for (uint Idx = 0; Idx < 3; Idx++)
+    {
+        UV0[Idx] = LoadVertexUV0(UV0Buffer, Index[Idx], RendererInstances.VertexFormat);
+    }
 	float2 OutUV = 0;
 
 	// interpolate data according to barycentric coordinate
-	OutUV = UV0[Index[0]] + Attr.Bary.x * (UV0[Index[1]] - UV0[Index[0]])
-		+ Attr.Bary.y * (UV0[Index[2]] - UV0[Index[0]]);
+	OutUV = UV0[0] + Attr.Bary.x * (UV0[1] - UV0[0])
+		+ Attr.Bary.y * (UV0[2] - UV0[0]);
 
 	return OutUV;
 }
 
 float3 GetHitNormal(uint PrimIndex, Attribute Attr)
 {
-    UHRendererInstance RendererInstances = UHRendererInstances[InstanceIndex()];
+    UHRendererInstance RendererInstances = UHRendererInstances[InstanceID()];
     uint3 Index = GetIndex(PrimIndex);
     
-    StructuredBuffer<float3> Normal = UHNormalTable[RendererInstances.MeshIndex];
+    ByteAddressBuffer NormalBuffer = UHNormalTable[RendererInstances.MeshIndex];
+    float3 Normal[3];
+    UHUNROLL
+    for (uint Idx = 0; Idx < 3; Idx++)
+    {
+        Normal[Idx] = LoadVertexNormal(NormalBuffer, Index[Idx], RendererInstances.VertexFormat);
+    }
     float3 OutNormal = float3(0, 0, 1);
     
-    OutNormal = Normal[Index[0]] + Attr.Bary.x * (Normal[Index[1]] - Normal[Index[0]])
-		+ Attr.Bary.y * (Normal[Index[2]] - Normal[Index[0]]);
+    OutNormal = Normal[0] + Attr.Bary.x * (Normal[1] - Normal[0])
+		+ Attr.Bary.y * (Normal[2] - Normal[0]);
     
     return OutNormal;
 }
 
 float4 GetHitTangent(uint PrimIndex, Attribute Attr)
 {
-    UHRendererInstance RendererInstances = UHRendererInstances[InstanceIndex()];
+    UHRendererInstance RendererInstances = UHRendererInstances[InstanceID()];
     uint3 Index = GetIndex(PrimIndex);
     
-    StructuredBuffer<float4> Tangent = UHTangentTable[RendererInstances.MeshIndex];
+    ByteAddressBuffer TangentBuffer = UHTangentTable[RendererInstances.MeshIndex];
+    float4 Tangent[3];
+    UHUNROLL
+    for (uint Idx = 0; Idx < 3; Idx++)
+    {
+        Tangent[Idx] = LoadVertexTangent(TangentBuffer, Index[Idx], RendererInstances.VertexFormat);
+    }
     float4 OutTangent = float4(1, 0, 0, 1);
     
-    OutTangent = Tangent[Index[0]] + Attr.Bary.x * (Tangent[Index[1]] - Tangent[Index[0]])
-		+ Attr.Bary.y * (Tangent[Index[2]] - Tangent[Index[0]]);
+    OutTangent = Tangent[0] + Attr.Bary.x * (Tangent[1] - Tangent[0])
+		+ Attr.Bary.y * (Tangent[2] - Tangent[0]);
     
     return OutTangent;
 }
@@ -208,7 +228,7 @@ float3 CalculateBumpNormal(float3 InBump, float3 VertexNormal, in Attribute Attr
 
 void CalculateReflectionMaterial(inout UHDefaultPayload Payload, float3 WorldPos, in Attribute Attr)
 {
-    MaterialData MatData = UHMaterialDataTable[InstanceID()][0];
+    MaterialData MatData = UHMaterialDataTable[UHRendererInstances[InstanceID()].MaterialIndex][0];
     bool bIsOpaque = MatData.Data[1] <= UH_ISMASKED;
     
     float4 ClipPos = mul(float4(WorldPos, 1.0f), GViewProj);
@@ -328,7 +348,7 @@ void RTDefaultClosestHit(inout UHDefaultPayload Payload, in Attribute Attr)
     // closest hit shader, only opaque objects will reach here
     float PrevHitT = Payload.HitT;
 	Payload.HitT = RayTCurrent();
-    Payload.HitInstanceIndex = InstanceIndex();
+    Payload.HitInstanceIndex = InstanceID();
 
 	// set alpha to 1 and cancel the flag of hit translucent if it's behind this opaque object
     Payload.HitAlpha = 1.0f;
@@ -456,7 +476,7 @@ void RTDefaultAnyHit(inout UHDefaultPayload Payload, in Attribute Attr)
                 Payload.HitWorldPosTrans = WorldPos;
                 Payload.HitRefractOffset = TransPayload.HitRefractOffset;
                 Payload.IsInsideScreen = TransPayload.IsInsideScreen;
-                Payload.HitInstanceIndex = InstanceIndex();
+                Payload.HitInstanceIndex = InstanceID();
                 Payload.PackedData0 = TransPayload.PackedData0;
                 Payload.RayDir = TransPayload.RayDir;
                 
@@ -26,8 +26,8 @@ Texture2D SmoothReflectVecTexture : register(t13);
 
 // lighting parameters
 StructuredBuffer<UHInstanceLights> InstanceLights : register(t14);
-ByteAddressBuffer PointLightListTrans : register(t15);
-ByteAddressBuffer SpotLightListTrans : register(t16);
+ByteAddressBuffer LightClusterGrid : register(t15);
+ByteAddressBuffer LightClusterIndices : register(t16);
 TextureCube EnvCube : register(t17);
 
 // samplers
@@ -37,20 +37,16 @@ SamplerState EnvSampler : register(s20);
 
 static const int GMaxDirLight = 2;
 
-void ConditionalCalculatePointLight(uint TileIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo, inout float3 Result)
+void ConditionalCalculatePointLight(uint ClusterIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo, inout float3 Result)
 {
-    // fetch tiled point light
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightListTrans.Load(TileOffset);
-    TileOffset += 4;
-    
+    // fetch clustered point light, the cluster is found with the hit position so an empty cluster means no light reaches it
     UHBRANCH
-    if (Payload.IsInsideScreen && PointLightCount > 0)
+    if (Payload.IsInsideScreen)
     {
-        for (uint Ldx = 0; Ldx < PointLightCount; Ldx++)
+        uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_POINTLIGHT);
+        for (uint Ldx = 0; Ldx < LightRange.y; Ldx++)
         {
-            uint PointLightIdx = PointLightListTrans.Load(TileOffset);
-            TileOffset += 4;
+            uint PointLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
        
             UHPointLight PointLight = UHPointLights[PointLightIdx];
             Result += CalculatePointLight(PointLight, LightInfo);
@@ -73,20 +69,16 @@ void ConditionalCalculatePointLight(uint TileIndex, in UHDefaultPayload Payload,
     }
 }
 
-void ConditionalCalculateSpotLight(uint TileIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo, inout float3 Result)
+void ConditionalCalculateSpotLight(uint ClusterIndex, in UHDefaultPayload Payload, UHLightInfo LightInfo, inout float3 Result)
 {
-    // fetch tiled spot light
-    uint TileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightListTrans.Load(TileOffset);
-    TileOffset += 4;
-    
+    // fetch clustered spot light
     UHBRANCH
-    if (Payload.IsInsideScreen && SpotLightCount > 0)
-    {        
-        for (uint Ldx = 0; Ldx < SpotLightCount; Ldx++)
+    if (Payload.IsInsideScreen)
+    {
+        uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_SPOTLIGHT);
+        for (uint Ldx = 0; Ldx < LightRange.y; Ldx++)
         {
-            uint SpotLightIdx = SpotLightListTrans.Load(TileOffset);
-            TileOffset += 4;
+            uint SpotLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
         
             UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
             Result += CalculateSpotLight(SpotLight, LightInfo);
@@ -123,7 +115,7 @@ float AccumulateShadowAtten(float InAtten, float NdotL, in UHDefaultPayload Refl
     return InAtten;
 }
 
-float TraceShadowInReflection(float3 HitWorldPos, uint TileIndex, in UHDefaultPayload Payload, float MipLevel)
+float TraceShadowInReflection(float3 HitWorldPos, uint ClusterIndex, in UHDefaultPayload Payload, float MipLevel)
 {
     float Atten = 0.0f;
     float3 HitWorldNormal = Payload.HitWorldNormal;
@@ -148,18 +140,15 @@ float TraceShadowInReflection(float3 HitWorldPos, uint TileIndex, in UHDefaultPa
         }
     }
     
-    // point light shadows, reuse tile light information if hit pos is inside screen, otherwise fetch from instance data
+    // point light shadows, reuse cluster light information if hit pos is inside screen, otherwise fetch from instance data
     UHInstanceLights Lights = InstanceLights[Payload.HitInstanceIndex];
     
-    uint PointTileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightListTrans.Load(PointTileOffset);
-    if (Payload.IsInsideScreen && PointLightCount > 0)
+    if (Payload.IsInsideScreen)
     {
-        PointTileOffset += 4;
-        for (uint Ldx = 0; Ldx < PointLightCount; Ldx++)
+        uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_POINTLIGHT);
+        for (uint Ldx = 0; Ldx < LightRange.y; Ldx++)
         {
-            uint PointLightIdx = PointLightListTrans.Load(PointTileOffset);
-            PointTileOffset += 4;
+            uint PointLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
             
             UHPointLight PointLight = UHPointLights[PointLightIdx];
             TracePointShadow(TLAS, PointLight, HitWorldPos, HitWorldNormal, Gap, MipLevel, Atten, Dummy);
@@ -180,16 +169,13 @@ float TraceShadowInReflection(float3 HitWorldPos, uint TileIndex, in UHDefaultPa
         }
     }
     
-    // spot light shadow, reuse tile light information if hit pos is inside screen, otherwise fetch from instance data
-    uint SpotTileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightListTrans.Load(SpotTileOffset);
-    if (Payload.IsInsideScreen && SpotLightCount > 0)
+    // spot light shadow, reuse cluster light information if hit pos is inside screen, otherwise fetch from instance data
+    if (Payload.IsInsideScreen)
     {
-        SpotTileOffset += 4;
-        for (uint Ldx = 0; Ldx < SpotLightCount; Ldx++)
+        uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_SPOTLIGHT);
+        for (uint Ldx = 0; Ldx < LightRange.y; Ldx++)
         {
-            uint LightIdx = SpotLightListTrans.Load(SpotTileOffset);
-            SpotTileOffset += 4;
+            uint LightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
             
             UHSpotLight SpotLight = UHSpotLights[LightIdx];
             TraceSpotShadow(TLAS, SpotLight, HitWorldPos, HitWorldNormal, Gap, MipLevel, Atten, Dummy);
@@ -286,15 +272,13 @@ float4 CalculateReflectionLighting(in UHDefaultPayload Payload
         }
     }
     
-    // for point lights and spot lights, fetch from tile-based light if it's inside screen
+    // for point lights and spot lights, fetch from clustered lights if it's inside screen
     // otherwise, fetch from the closest lights to current camera for now
     uint2 PixelCoord = uint2(ScreenUV * GResolution.xy);
-    uint TileX = CoordToTileX(PixelCoord.x);
-    uint TileY = CoordToTileY(PixelCoord.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
+    uint ClusterIndex = GetLightClusterIndex(PixelCoord, LightInfo.WorldPos);
     
     // trace shadow in reflection
-    LightInfo.ShadowMask = TraceShadowInReflection(LightInfo.WorldPos, TileIndex, Payload, MipLevel);
+    LightInfo.ShadowMask = TraceShadowInReflection(LightInfo.WorldPos, ClusterIndex, Payload, MipLevel);
     LightInfo.AttenNoise = GetAttenuationNoise(PixelCoord.xy) * 0.1f;
     LightInfo.SpecularNoise = LightInfo.AttenNoise * lerp(0.5f, 0.02f, LightInfo.Specular.a);
     
@@ -310,13 +294,13 @@ float4 CalculateReflectionLighting(in UHDefaultPayload Payload
     // point lights
     if (GNumPointLights > 0)
     {
-        ConditionalCalculatePointLight(TileIndex, Payload, LightInfo, Result);
+        ConditionalCalculatePointLight(ClusterIndex, Payload, LightInfo, Result);
     }
     
     // spot lights
     if (GNumSpotLights > 0)
     {
-        ConditionalCalculateSpotLight(TileIndex, Payload, LightInfo, Result);
+        ConditionalCalculateSpotLight(ClusterIndex, Payload, LightInfo, Result);
     }
     
     // indirect light and emissive
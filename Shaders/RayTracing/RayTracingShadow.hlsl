@@ -11,16 +11,14 @@ RaytracingAccelerationStructure TLAS : register(t1);
 // in soften pass, it will output to corresponding RT shadow targets
 RWTexture2D<float2> OutShadowResult : register(u2);
 
-ByteAddressBuffer PointLightList : register(t6);
-ByteAddressBuffer PointLightListTrans : register(t7);
-ByteAddressBuffer SpotLightList : register(t8);
-ByteAddressBuffer SpotLightListTrans : register(t9);
+ByteAddressBuffer LightClusterGrid : register(t6);
+ByteAddressBuffer LightClusterIndices : register(t7);
 
-Texture2D MixedMipTexture : register(t10);
-Texture2D MixedDepthTexture : register(t11);
-Texture2D MixedVertexNormalTexture : register(t12);
-SamplerState PointSampler : register(s13);
-SamplerState LinearSampler : register(s14);
+Texture2D MixedMipTexture : register(t8);
+Texture2D MixedDepthTexture : register(t9);
+Texture2D MixedVertexNormalTexture : register(t10);
+SamplerState PointSampler : register(s11);
+SamplerState LinearSampler : register(s12);
 
 // both opaque and translucent shadow are traced in this function
 void TraceShadow(uint2 PixelCoord, float2 ScreenUV, float MipRate, float MipLevel)
@@ -59,38 +57,27 @@ void TraceShadow(uint2 PixelCoord, float2 ScreenUV, float MipRate, float MipLeve
         TraceDiretionalShadow(TLAS, DirLight, WorldPos, WorldNormal, Gap, MipLevel, Atten, MaxDist);
     }
     
-    // evaluate if it's translucent or not from VertexNormalData.w
-    bool bIsTranslucent = VertexNormalData.w > 0;
-    
 	// ------------------------------------------------------------------------------------------ Point Light Tracing
-    uint2 TileCoordinate = PixelCoord.xy;
-    uint TileX = CoordToTileX(TileCoordinate.x);
-    uint TileY = CoordToTileY(TileCoordinate.y);
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint LightCount = (bIsTranslucent) ? PointLightListTrans.Load(TileOffset) : PointLightList.Load(TileOffset);
-    TileOffset += 4;
+    // clusters are looked up with the world position, so both opaque and translucent pixels use the same lists
+    uint ClusterIndex = GetLightClusterIndex(PixelCoord, WorldPos);
+    uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_POINTLIGHT);
 	
     float3 LightToWorld;
 	
-    for (Ldx = 0; Ldx < LightCount; Ldx++)
+    for (Ldx = 0; Ldx < LightRange.y; Ldx++)
     {
-        uint PointLightIdx = (bIsTranslucent) ? PointLightListTrans.Load(TileOffset) : PointLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
 		
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         TracePointShadow(TLAS, PointLight, WorldPos, WorldNormal, Gap, MipLevel, Atten, MaxDist);
     }
 	
 	// ------------------------------------------------------------------------------------------ Spot Light Tracing
-    TileOffset = GetSpotLightOffset(TileIndex);
-    LightCount = (bIsTranslucent) ? SpotLightListTrans.Load(TileOffset) : SpotLightList.Load(TileOffset);
-    TileOffset += 4;
+    LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_SPOTLIGHT);
 	
-    for (Ldx = 0; Ldx < LightCount; Ldx++)
+    for (Ldx = 0; Ldx < LightRange.y; Ldx++)
     {
-        uint SpotLightIdx = (bIsTranslucent) ? SpotLightListTrans.Load(TileOffset) : SpotLightList.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
 		
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         TraceSpotShadow(TLAS, SpotLight, WorldPos, WorldNormal, Gap, MipLevel, Atten, MaxDist);
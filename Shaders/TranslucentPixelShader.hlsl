@@ -11,8 +11,8 @@
 
 Texture2D ScreenShadowTexture : register(t9);
 Texture2D ScreenReflectionTexture : register(t10);
-ByteAddressBuffer PointLightListTrans : register(t11);
-ByteAddressBuffer SpotLightListTrans : register(t12);
+ByteAddressBuffer LightClusterGrid : register(t11);
+ByteAddressBuffer LightClusterIndices : register(t12);
 TextureCube EnvCube : register(t14);
 
 // texture/sampler tables for bindless rendering
@@ -164,18 +164,14 @@ float4 TranslucentPS(VertexOutput Vin, bool bIsFrontFace : SV_IsFrontFace) : SV_
     }
 	
 	// ------------------------------------------------------------------------------------------ point lights accumulation
-	// point lights accumulation, fetch the tile index here, note that the system culls at half resolution
-    uint TileX = CoordToTileX(uint(Vin.Position.x + 0.5f));
-    uint TileY = CoordToTileY(uint(Vin.Position.y + 0.5f));
-    uint TileIndex = TileX + TileY * GLightTileCountX;
-    uint TileOffset = GetPointLightOffset(TileIndex);
-    uint PointLightCount = PointLightListTrans.Load(TileOffset);
-    TileOffset += 4;
-    
-    for (Ldx = 0; Ldx < PointLightCount; Ldx++)
+	// point lights accumulation, fetch the light cluster of this pixel here, clusters don't depend on the depth buffer
+	// so translucent objects share the same lists as opaque objects
+    uint ClusterIndex = GetLightClusterIndex(uint2(Vin.Position.xy), WorldPos);
+    uint2 LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_POINTLIGHT);
+    
+    for (Ldx = 0; Ldx < LightRange.y; Ldx++)
     {
-        uint PointLightIdx = PointLightListTrans.Load(TileOffset);
-        TileOffset += 4;
+        uint PointLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
        
         UHPointLight PointLight = UHPointLights[PointLightIdx];
         Result += CalculatePointLight(PointLight, LightInfo);
@@ -183,15 +179,12 @@ float4 TranslucentPS(VertexOutput Vin, bool bIsFrontFace : SV_IsFrontFace) : SV_
 	
 	// ------------------------------------------------------------------------------------------ spot lights accumulation
 	// similar as the point light but giving it angle attenuation as well
-    TileOffset = GetSpotLightOffset(TileIndex);
-    uint SpotLightCount = SpotLightListTrans.Load(TileOffset);
-    TileOffset += 4;
+    LightRange = GetLightClusterRange(LightClusterGrid, ClusterIndex, UHLIGHTCLUSTER_SPOTLIGHT);
     
     UHLOOP
-    for (Ldx = 0; Ldx < SpotLightCount; Ldx++)
+    for (Ldx = 0; Ldx < LightRange.y; Ldx++)
     {
-        uint SpotLightIdx = SpotLightListTrans.Load(TileOffset);
-        TileOffset += 4;
+        uint SpotLightIdx = LightClusterIndices.Load((LightRange.x + Ldx) * 4);
         
         UHSpotLight SpotLight = UHSpotLights[SpotLightIdx];
         Result += CalculateSpotLight(SpotLight, LightInfo);
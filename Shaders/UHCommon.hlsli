@@ -13,8 +13,80 @@ struct UHRendererInstance
     uint MeshIndex;
     // indice type
     uint IndiceType;
+    // vertex format of UV0/Normal/Tangent streams
+    uint VertexFormat;
+    // material index to lookup material data
+    uint MaterialIndex;
 };
 
+// vertex format, this needs to sync with UHVertexFormat in C++ side
+// full format stores float data, compressed format stores 4x16-bit snorm position relative to the mesh bound
+// , half2 UV0 and octahedral normal/tangent in a uint per vertex
+#define UH_VERTEX_FORMAT_FULL 0
+#define UH_VERTEX_FORMAT_COMPRESSED 1
+
+float3 DecodeOctahedron(float2 E)
+{
+    float3 N = float3(E, 1.0f - abs(E.x) - abs(E.y));
+    float T = saturate(-N.z);
+    N.xy += (N.xy >= 0.0f) ? -T : T;
+    return normalize(N);
+}
+
+float3 LoadVertexPosition(ByteAddressBuffer InBuffer, uint InVertexIndex, uint InFormat, float3 InBoundCenter, float3 InBoundExtent)
+{
+    UHBRANCH
+    if (InFormat == UH_VERTEX_FORMAT_COMPRESSED)
+    {
+        // 3x16-bit snorm in two uints, the last 16 bits are unused
+        uint2 Packed = InBuffer.Load2(InVertexIndex * 8);
+        float3 E = float3(int(Packed.x << 16) >> 16, int(Packed.x) >> 16, int(Packed.y << 16) >> 16) / 32767.0f;
+        return max(E, -1.0f) * InBoundExtent + InBoundCenter;
+    }
+
+    return asfloat(InBuffer.Load3(InVertexIndex * 12));
+}
+
+float2 LoadVertexUV0(ByteAddressBuffer InBuffer, uint InVertexIndex, uint InFormat)
+{
+    UHBRANCH
+    if (InFormat == UH_VERTEX_FORMAT_COMPRESSED)
+    {
+        uint Packed = InBuffer.Load(InVertexIndex * 4);
+        return f16tof32(uint2(Packed, Packed >> 16));
+    }
+
+    return asfloat(InBuffer.Load2(InVertexIndex * 8));
+}
+
+float3 LoadVertexNormal(ByteAddressBuffer InBuffer, uint InVertexIndex, uint InFormat)
+{
+    UHBRANCH
+    if (InFormat == UH_VERTEX_FORMAT_COMPRESSED)
+    {
+        // 2x16-bit snorm, sign extend with shifts
+        uint Packed = InBuffer.Load(InVertexIndex * 4);
+        float2 E = float2(int(Packed << 16) >> 16, int(Packed) >> 16) / 32767.0f;
+        return DecodeOctahedron(max(E, -1.0f));
+    }
+
+    return asfloat(InBuffer.Load3(InVertexIndex * 12));
+}
+
+float4 LoadVertexTangent(ByteAddressBuffer InBuffer, uint InVertexIndex, uint InFormat)
+{
+    UHBRANCH
+    if (InFormat == UH_VERTEX_FORMAT_COMPRESSED)
+    {
+        // 16-bit and 15-bit snorm, the highest bit is the sign of bitangent
+        uint Packed = InBuffer.Load(InVertexIndex * 4);
+        float2 E = float2(int(Packed << 16) >> 16, int(Packed << 1) >> 17) / float2(32767.0f, 16383.0f);
+        return float4(DecodeOctahedron(max(E, -1.0f)), (Packed >> 31) ? -1.0f : 1.0f);
+    }
+
+    return asfloat(InBuffer.Load4(InVertexIndex * 16));
+}
+
 static const float4 GBoxOffset[8] =
 {
     float4(-1.0f, -1.0f, 1.0f, 0.0f),
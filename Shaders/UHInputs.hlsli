@@ -20,6 +20,15 @@
 #define UHGBUFFER_BIND t3
 #endif
 
+// object constants and instance indices for instanced draws
+#ifndef UHOBJ_INSTANCE_BIND
+#define UHOBJ_INSTANCE_BIND t1
+#endif
+
+#ifndef UHINSTANCE_BIND
+#define UHINSTANCE_BIND t6
+#endif
+
 #define UHBRANCH [branch]
 #define UHFLATTEN [flatten]
 #define UHUNROLL [unroll]
@@ -115,11 +124,11 @@ cbuffer SystemConstants : register(UHSYSTEM_BIND)
 	float GJitterScaleMin;	// minimum jitter scale
 	float GJitterScaleFactor;	// jitter scale factorto multiply with
     uint GNumPointLights;
-    uint GLightTileCountX;
+    uint GLightClusterCountX;
 	
-    uint GMaxPointLightPerTile;
+    uint GLightClusterCountY;
     uint GNumSpotLights;
-    uint GMaxSpotLightPerTile;
+    uint GLightClusterIndexCapacity;
 	uint GFrameNumber;
 	
     uint GSystemRenderFeature;
@@ -147,9 +156,61 @@ cbuffer SystemConstants : register(UHSYSTEM_BIND)
     float GPCSSBlockerDistScale;
     uint GMaxReflectionRecursion;
     float GScreenMipCount;
+	
+    float GLightClusterSliceScale;
+    float GLightClusterSliceBias;
+    float GLightClusterProjScaleX;
+    float GLightClusterProjScaleY;
 }
 
 // IT means inverse-transposed
+#if UH_INSTANCING
+// instanced draws fetch object constants with the renderer index of each instance
+// SV_InstanceID includes the first instance of the draw in Vulkan, so it indexes the whole instance buffer directly
+struct UHInstanceObjectConstants
+{
+	float4x4 GWorld;
+	float4x4 GWorldIT;
+	float4x4 GPrevWorld;
+	uint GInstanceIndex;
+    float3 GWorldPos;
+    float3 GBoundExtent;
+    uint GVertexFormat;
+    float3 GMeshBoundCenter;
+    float GMeshBoundPadding;
+    float3 GMeshBoundExtent;
+
+	// align to 256 bytes, the structure must be the same as c++ define
+	float CPUPadding;
+};
+StructuredBuffer<UHInstanceObjectConstants> UHObjectConstantsBuffer : register(UHOBJ_INSTANCE_BIND);
+StructuredBuffer<uint> UHInstanceRendererIndices : register(UHINSTANCE_BIND);
+
+static float4x4 GWorld;
+static float4x4 GWorldIT;
+static float4x4 GPrevWorld;
+static uint GInstanceIndex;
+static float3 GWorldPos;
+static float3 GBoundExtent;
+static uint GVertexFormat;
+static float3 GMeshBoundCenter;
+static float3 GMeshBoundExtent;
+
+// call this at the beginning of vertex shader, the object constants above are valid after it
+void LoadInstanceConstants(uint InstanceID)
+{
+	UHInstanceObjectConstants Constant = UHObjectConstantsBuffer[UHInstanceRendererIndices[InstanceID]];
+	GWorld = Constant.GWorld;
+	GWorldIT = Constant.GWorldIT;
+	GPrevWorld = Constant.GPrevWorld;
+	GInstanceIndex = Constant.GInstanceIndex;
+	GWorldPos = Constant.GWorldPos;
+	GBoundExtent = Constant.GBoundExtent;
+	GVertexFormat = Constant.GVertexFormat;
+	GMeshBoundCenter = Constant.GMeshBoundCenter;
+	GMeshBoundExtent = Constant.GMeshBoundExtent;
+}
+#else
 cbuffer ObjectConstants : register(UHOBJ_BIND)
 {
 	float4x4 GWorld;
@@ -158,8 +219,18 @@ cbuffer ObjectConstants : register(UHOBJ_BIND)
 	uint GInstanceIndex;
     float3 GWorldPos;
     float3 GBoundExtent;
+    uint GVertexFormat;
+    float3 GMeshBoundCenter;
+    float GMeshBoundPadding;
+    float3 GMeshBoundExtent;
 }
 
+void LoadInstanceConstants(uint InstanceID)
+{
+	// object constants are bound per draw without instancing
+}
+#endif
+
 // 0: Color + AO
 // 1: Normal
 // 2: Specular + Smoothness
@@ -1,9 +1,11 @@
 #ifndef UHLIGHTCOMMON_H
 #define UHLIGHTCOMMON_H
 
-#define UHLIGHTCULLING_TILEX 16
-#define UHLIGHTCULLING_TILEY 16
-#define UHLIGHTCULLING_UPSCALE 2
+// light clusters, must match UHLightClusterView in C++
+#define UHLIGHTCLUSTER_TILESIZE 64
+#define UHLIGHTCLUSTER_SLICES 32
+#define UHLIGHTCLUSTER_POINTLIGHT 0
+#define UHLIGHTCLUSTER_SPOTLIGHT 1
 
 #include "UHInputs.hlsli"
 #ifndef UHDIRLIGHT_BIND
@@ -110,39 +112,34 @@ float3 LightBRDF(UHLightInfo LightInfo)
     return LightInfo.Diffuse * LightDiffuse + LightSpecular;
 }
 
-uint GetPointLightOffset(uint InIndex)
-{
-    return InIndex * (GMaxPointLightPerTile * 4 + 4);
-}
-
-uint GetSpotLightOffset(uint InIndex)
-{
-    return InIndex * (GMaxSpotLightPerTile * 4 + 4);
-}
-
 bool HasLighting()
 {
     return GNumDirLights > 0 || GNumPointLights > 0 || GNumSpotLights > 0;
 }
 
-uint CoordToTileX(uint InX)
-{
-    return InX / UHLIGHTCULLING_TILEX / UHLIGHTCULLING_UPSCALE;
-}
-
-uint CoordToTileY(uint InY)
+// depth slice of a view space z, slices are exponential and the last one extends to infinity
+uint GetLightClusterSlice(float ViewZ)
 {
-    return InY / UHLIGHTCULLING_TILEY / UHLIGHTCULLING_UPSCALE;
+    float Slice = floor(log2(max(ViewZ, UH_FLOAT_EPSILON)) * GLightClusterSliceScale + GLightClusterSliceBias);
+    return (uint)clamp(Slice, 0.0f, UHLIGHTCLUSTER_SLICES - 1);
 }
 
-float TileToCoordX(uint InX)
+uint GetLightClusterIndex(uint2 PixelCoord, float3 WorldPos)
 {
-    return InX * UHLIGHTCULLING_TILEX;
+    uint TileX = min(PixelCoord.x / UHLIGHTCLUSTER_TILESIZE, GLightClusterCountX - 1);
+    uint TileY = min(PixelCoord.y / UHLIGHTCLUSTER_TILESIZE, GLightClusterCountY - 1);
+    uint Slice = GetLightClusterSlice(WorldToViewPos(WorldPos).z);
+    return TileX + (TileY + Slice * GLightClusterCountY) * GLightClusterCountX;
 }
 
-float TileToCoordY(uint InY)
+// offset and count of a light type in the index list, the grid stores (offset, count) per cluster and light type
+// indices beyond the capacity are dropped until the list is grown, so the count is clamped to the capacity
+uint2 GetLightClusterRange(ByteAddressBuffer InGrid, uint InClusterIndex, uint InLightType)
 {
-    return InY * UHLIGHTCULLING_TILEY;
+    uint2 Range = InGrid.Load2((InClusterIndex * 2 + InLightType) * 8);
+    Range.x = min(Range.x, GLightClusterIndexCapacity);
+    Range.y = min(Range.y, GLightClusterIndexCapacity - Range.x);
+    return Range;
 }
 
 float3 CalculateDirLight(UHDirectionalLight DirLight, UHLightInfo LightInfo)
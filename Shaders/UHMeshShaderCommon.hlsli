@@ -1,11 +1,11 @@
 #ifndef UHMESHSHADERCOMMAND_H
 #define UHMESHSHADERCOMMAND_H
 
+// group size should cover both the max vertex and primitive count, so each thread outputs at most one vertex and one primitive
+// 64 vertices and 126 primitives are the limits of meshlet builder, which must be the same as C++ side
 #define MESHSHADER_GROUP_SIZE 126
-// 126: closest multplt of three to 128
-// 42: vertex count / 3
-#define MESHSHADER_MAX_VERTEX 126
-#define MESHSHADER_MAX_PRIMITIVE 42
+#define MESHSHADER_MAX_VERTEX 64
+#define MESHSHADER_MAX_PRIMITIVE 126
 
 // on the C++ side, it will count total number of meshlets to dispatch for each material group
 // and this is the list to store the shader to meshlet and renderer data
@@ -16,14 +16,33 @@ struct UHMeshShaderData
     uint bDoOcclusionTest;
 };
 
-// meshlet data
+// meshlet data, the offsets are in uint to the meshlet index buffer
 struct UHMeshlet
 {
     uint VertexCount;
     uint VertexOffset;
     uint PrimitiveCount;
+    uint PrimitiveOffset;
+    float3 BoundCenter;
+    float BoundRadius;
+    float3 ConeAxis;
+    float ConeCutoff;
 };
 
+// push constants for amplification shader
+struct UHMeshShaderConstants
+{
+    uint NumMeshShaderData;
+    uint bEnableConeCulling;
+    uint OcclusionPhase;
+};
+
+// two-phase occlusion culling, must be the same as UHOcclusionPhase
+#define UH_OCCLUSION_PHASE_NONE 0
+#define UH_OCCLUSION_PHASE_PREVIOUS 1
+#define UH_OCCLUSION_PHASE_DISOCCLUDED 2
+#define UH_OCCLUSION_PHASE_CURRENT 3
+
 struct ObjectConstants
 {
     float4x4 GWorld;
@@ -32,9 +51,13 @@ struct ObjectConstants
     uint GInstanceIndex;
     float3 GWorldPos;
     float3 GBoundExtent;
+    uint GVertexFormat;
+    float3 GMeshBoundCenter;
+    float GMeshBoundPadding;
+    float3 GMeshBoundExtent;
     
     // align to 256 bytes, the buffer is used as storage in mesh shader, the structure must be the same as c++ define
-    float CPUPadding[9];
+    float CPUPadding;
 };
 
 struct UHMeshPayload
@@ -80,27 +103,17 @@ uint3 GetIndices(ByteAddressBuffer InBuffer, uint InPrimIndex, uint InIndiceType
     return Indices;
 }
 
-uint GetVertexIndex(ByteAddressBuffer InBuffer, uint InIndex, uint InIndiceType)
+uint GetMeshletVertexIndex(ByteAddressBuffer InBuffer, UHMeshlet InMeshlet, uint InLocalIndex)
 {
-    uint IbStride = 4;
-    uint Index = 0;
-    
-    if (InIndiceType == 1)
-    {
-        Index = InBuffer.Load(InIndex * IbStride);
-    }
-    else
-    {
-        // similar calculation as GetIndices(), but only return one index
-        uint WorldOffset = (InIndex & 1);
-        uint ByteOffset = (InIndex / 2) * IbStride;
+    // the unique vertex list of meshlet, it maps local vertex index to the vertex index of mesh
+    return InBuffer.Load((InMeshlet.VertexOffset + InLocalIndex) * 4);
+}
 
-        // Grab a pair of 16-bit indices, and mask out proper 16-bits.
-        const uint Two16BitIndices = InBuffer.Load(ByteOffset);
-        Index = (Two16BitIndices >> (WorldOffset * 16)) & 0xffff;
-    }
-    
-    return Index;
+uint3 GetMeshletPrimitive(ByteAddressBuffer InBuffer, UHMeshlet InMeshlet, uint InPrimIndex)
+{
+    // local vertex indices are packed in 8-bit each
+    uint Packed = InBuffer.Load((InMeshlet.PrimitiveOffset + InPrimIndex) * 4);
+    return uint3(Packed & 0xff, (Packed >> 8) & 0xff, (Packed >> 16) & 0xff);
 }
 
 float3 LocalToWorldNormalMS(float3 Normal, float3x3 WorldIT)
@@ -7,6 +7,7 @@
 #include "Runtime/Engine/Engine.h"
 #include "Runtime/Engine/Input.h"
 #include "Editor/Dialog/StatusDialog.h"
+#include "Editor/Tools/CommandLineTools.h"
 
 #define MAX_LOADSTRING 100
 
@@ -37,7 +38,17 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     }
 
     UNREFERENCED_PARAMETER(hPrevInstance);
+
+#if WITH_EDITOR
+    // command line tools run without creating the engine
+    int32_t ToolExitCode = 0;
+    if (RunCommandLine(lpCmdLine, ToolExitCode))
+    {
+        return ToolExitCode;
+    }
+#else
     UNREFERENCED_PARAMETER(lpCmdLine);
+#endif
 
     // Initialize global strings
     LoadStringW(hInstance, IDS_APP_TITLE, szTitle, MAX_LOADSTRING);
@@ -70,6 +81,18 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         }
     }
 
+#if WITH_EDITOR
+    // command line tools which need an initialized engine
+    int32_t EngineToolExitCode = 0;
+    if (RunEngineCommandLine(lpCmdLine, GUnheardEngine.get(), EngineToolExitCode))
+    {
+        GUnheardEngine->ReleaseEngine();
+        GUnheardEngine.reset();
+        CoUninitialize();
+        return EngineToolExitCode;
+    }
+#endif
+
     HACCEL hAccelTable = LoadAccelerators(hInstance, MAKEINTRESOURCE(IDC_UNHEARDENGINE));
 
     MSG msg = {};